@@ -61,6 +61,41 @@ static const char g_pcSuffixHttp10[] = " HTTP/1.0\r\n\r\n";
 static const char g_pcSuffixHttp11[] = " HTTP/1.1\r\n\r\n";
 #endif
 
+//*****************************************************************************
+//
+// The request type strings used by HTTPRequestStart(), indexed by the
+// HTTP_MESSAGE_* request type.
+//
+//*****************************************************************************
+static const char * const g_ppcHttpTypes[] =
+{
+    g_pcHttpConnect,
+    g_pcHttpGet,
+    g_pcHttpPost,
+    g_pcHttpPut,
+    g_pcHttpDelete,
+    g_pcHttpHead,
+    g_pcHttpTrace,
+    g_pcHttpOptions,
+    g_pcHttpPatch
+};
+
+//*****************************************************************************
+//
+// The states of the incremental response parser.
+//
+//*****************************************************************************
+#define HTTP_STATE_STATUS       0
+#define HTTP_STATE_HEADER       1
+#define HTTP_STATE_BODY         2
+#define HTTP_STATE_BODY_CLOSE   3
+#define HTTP_STATE_CHUNK_SIZE   4
+#define HTTP_STATE_CHUNK_DATA   5
+#define HTTP_STATE_CHUNK_END    6
+#define HTTP_STATE_TRAILER      7
+#define HTTP_STATE_DONE         8
+#define HTTP_STATE_ERROR        9
+
 //*****************************************************************************
 //
 //! Extract the portion of a string up to a specified character.
@@ -585,3 +620,551 @@ HTTPResponseBodyExtract(char *pcData, char *pcDest)
         }
     }
 }
+
+//*****************************************************************************
+//
+//! Append a string to the requests in a request builder.
+//!
+//! \param psRequest is a pointer to the request builder.
+//! \param pcStr is a pointer to the string to append.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RequestAppend(tHTTPRequest *psRequest, const char *pcStr)
+{
+    while(*pcStr)
+    {
+        //
+        // Leave room for the terminating NULL.
+        //
+        if((psRequest->ui32Len + 1) >= psRequest->ui32Size)
+        {
+            psRequest->bOverflow = true;
+            break;
+        }
+
+        psRequest->pcBuf[psRequest->ui32Len++] = *pcStr++;
+    }
+
+    psRequest->pcBuf[psRequest->ui32Len] = 0;
+}
+
+//*****************************************************************************
+//
+//! Initialize a request builder.
+//!
+//! \param psRequest is a pointer to the request builder.
+//! \param pcBuf is a pointer to the buffer that will hold the requests.
+//! \param ui32Size is the size of \e pcBuf in bytes.
+//!
+//! This function prepares a buffer to hold one or more HTTP/1.1 requests.
+//! Unlike HTTPMessageTypeSet() and HTTPMessageHeaderAdd(), the request builder
+//! tracks the length of the requests so the buffer is never rescanned, and it
+//! never writes past the end of the buffer.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HTTPRequestInit(tHTTPRequest *psRequest, char *pcBuf, uint32_t ui32Size)
+{
+    psRequest->pcBuf = pcBuf;
+    psRequest->ui32Size = ui32Size;
+    psRequest->ui32Len = 0;
+    psRequest->bOverflow = (ui32Size == 0);
+
+    if(ui32Size)
+    {
+        pcBuf[0] = 0;
+    }
+}
+
+//*****************************************************************************
+//
+//! Start a new request in a request builder.
+//!
+//! \param psRequest is a pointer to the request builder.
+//! \param ui8Type is the HTTP request type.  Macros such as HTTP_MESSAGE_GET
+//! are defined in http.h.
+//! \param pcResource is a pointer to a string containing the resource to
+//! request.
+//!
+//! This function appends the request line of a new HTTP/1.1 request to the
+//! buffer.  Headers are then added with HTTPRequestHeaderAdd() and the request
+//! is completed with HTTPRequestEnd().  Further requests may then be started
+//! in the same buffer, allowing several requests to be sent at once on a
+//! persistent connection.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HTTPRequestStart(tHTTPRequest *psRequest, uint8_t ui8Type,
+                 const char *pcResource)
+{
+    if(ui8Type >= (sizeof(g_ppcHttpTypes) / sizeof(g_ppcHttpTypes[0])))
+    {
+        psRequest->bOverflow = true;
+        return;
+    }
+
+    RequestAppend(psRequest, g_ppcHttpTypes[ui8Type]);
+    RequestAppend(psRequest, pcResource);
+    RequestAppend(psRequest, " HTTP/1.1\r\n");
+}
+
+//*****************************************************************************
+//
+//! Add a header to the current request in a request builder.
+//!
+//! \param psRequest is a pointer to the request builder.
+//! \param pcHeaderName is a pointer to a string containing the header name.
+//! \param pcHeaderValue is a pointer to a string containing the header data.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HTTPRequestHeaderAdd(tHTTPRequest *psRequest, const char *pcHeaderName,
+                     const char *pcHeaderValue)
+{
+    RequestAppend(psRequest, pcHeaderName);
+    RequestAppend(psRequest, ": ");
+    RequestAppend(psRequest, pcHeaderValue);
+    RequestAppend(psRequest, "\r\n");
+}
+
+//*****************************************************************************
+//
+//! Complete the current request in a request builder.
+//!
+//! \param psRequest is a pointer to the request builder.
+//!
+//! This function adds the blank line that ends the headers of the current
+//! request.
+//!
+//! \return Returns the total number of bytes of all of the requests in the
+//! buffer, or 0 if the buffer was too small to hold them.
+//
+//*****************************************************************************
+uint32_t
+HTTPRequestEnd(tHTTPRequest *psRequest)
+{
+    RequestAppend(psRequest, "\r\n");
+
+    if(psRequest->bOverflow)
+    {
+        return(0);
+    }
+
+    return(psRequest->ui32Len);
+}
+
+//*****************************************************************************
+//
+//! Initialize an incremental HTTP response parser.
+//!
+//! \param psParser is a pointer to the parser state.
+//! \param pfnBody is the function called with each piece of the body of the
+//! response.
+//! \param pvCBData is the data pointer passed to \e pfnBody.
+//! \param bNoBody is \b true if the response has no body, as is the case for
+//! the response to a HEAD request.
+//!
+//! This function prepares a parser to read a single HTTP response.  The
+//! response is passed to the parser, in pieces of any size, with
+//! HTTPResponseParserData().  The status line and headers are parsed a byte at
+//! a time as they arrive, so the response is never buffered.  The body is
+//! passed to \e pfnBody with any chunked transfer coding removed.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+HTTPResponseParserInit(tHTTPResponseParser *psParser,
+                       tHTTPBodyCallback pfnBody, void *pvCBData,
+                       bool bNoBody)
+{
+    psParser->pfnBody = pfnBody;
+    psParser->pvCBData = pvCBData;
+    psParser->ui8State = HTTP_STATE_STATUS;
+    psParser->bNoBody = bNoBody;
+    psParser->bChunked = false;
+    psParser->bLength = false;
+    psParser->bKeepAlive = false;
+    psParser->ui32Status = 0;
+    psParser->ui32Remaining = 0;
+    psParser->ui32LineLen = 0;
+}
+
+//*****************************************************************************
+//
+//! Add a character to the current line of a response.
+//!
+//! \param psParser is a pointer to the parser state.
+//! \param cChar is the character to add.
+//!
+//! Carriage returns are discarded and lines that are too long for the line
+//! buffer are truncated.
+//!
+//! \return Returns \b true if the character completed a line.
+//
+//*****************************************************************************
+static bool
+ParserLineAdd(tHTTPResponseParser *psParser, char cChar)
+{
+    if(cChar == '\n')
+    {
+        psParser->pcLine[psParser->ui32LineLen] = 0;
+        psParser->ui32LineLen = 0;
+        return(true);
+    }
+
+    if((cChar != '\r') && (psParser->ui32LineLen < (HTTP_MAX_LINE - 1)))
+    {
+        psParser->pcLine[psParser->ui32LineLen++] = cChar;
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+//! Return a pointer to the value of a header if the header has a given name.
+//!
+//! \param pcLine is a pointer to the header line.
+//! \param pcName is a pointer to the header name, including the ':'.
+//!
+//! \return Returns a pointer to the header value with leading white space
+//! removed, or 0 if the header does not have the given name.
+//
+//*****************************************************************************
+static const char *
+HeaderValueGet(const char *pcLine, const char *pcName)
+{
+    uint32_t ui32Len;
+
+    ui32Len = ustrlen(pcName);
+
+    if(ustrncasecmp(pcLine, pcName, ui32Len) != 0)
+    {
+        return(0);
+    }
+
+    pcLine += ui32Len;
+    while((*pcLine == ' ') || (*pcLine == '\t'))
+    {
+        pcLine++;
+    }
+
+    return(pcLine);
+}
+
+//*****************************************************************************
+//
+//! Choose how the body of a response is read once its headers are complete.
+//!
+//! \param psParser is a pointer to the parser state.
+//!
+//! \return Returns the next parser state.
+//
+//*****************************************************************************
+static uint8_t
+ParserBodyStart(tHTTPResponseParser *psParser)
+{
+    //
+    // An interim response, such as 100 Continue, is followed by the real
+    // response.
+    //
+    if((psParser->ui32Status >= 100) && (psParser->ui32Status < 200))
+    {
+        psParser->bChunked = false;
+        psParser->bLength = false;
+        return(HTTP_STATE_STATUS);
+    }
+
+    if(psParser->bNoBody || (psParser->ui32Status == 204) ||
+       (psParser->ui32Status == 304))
+    {
+        return(HTTP_STATE_DONE);
+    }
+
+    if(psParser->bChunked)
+    {
+        return(HTTP_STATE_CHUNK_SIZE);
+    }
+
+    if(psParser->bLength)
+    {
+        return(psParser->ui32Remaining ? HTTP_STATE_BODY : HTTP_STATE_DONE);
+    }
+
+    //
+    // Without a length the body ends when the server closes the connection.
+    //
+    psParser->bKeepAlive = false;
+
+    return(HTTP_STATE_BODY_CLOSE);
+}
+
+//*****************************************************************************
+//
+//! Process a complete status, header or chunk line of a response.
+//!
+//! \param psParser is a pointer to the parser state.
+//!
+//! \return Returns the next parser state.
+//
+//*****************************************************************************
+static uint8_t
+ParserLineProcess(tHTTPResponseParser *psParser)
+{
+    const char *pcLine, *pcValue;
+    char cDigit;
+
+    pcLine = psParser->pcLine;
+
+    switch(psParser->ui8State)
+    {
+        case HTTP_STATE_STATUS:
+        {
+            if(ustrncmp(pcLine, "HTTP/1.", 7) != 0)
+            {
+                return(HTTP_STATE_ERROR);
+            }
+
+            //
+            // Connections persist by default from HTTP/1.1 onward.
+            //
+            psParser->bKeepAlive = (pcLine[7] != '0');
+            psParser->ui32Status = ustrtoul(pcLine + 8, 0, 10);
+
+            return(HTTP_STATE_HEADER);
+        }
+
+        case HTTP_STATE_HEADER:
+        {
+            if(pcLine[0] == 0)
+            {
+                return(ParserBodyStart(psParser));
+            }
+
+            if((pcValue = HeaderValueGet(pcLine, "Content-Length:")) != 0)
+            {
+                psParser->ui32Remaining = ustrtoul(pcValue, 0, 10);
+                psParser->bLength = true;
+            }
+            else if((pcValue = HeaderValueGet(pcLine,
+                                              "Transfer-Encoding:")) != 0)
+            {
+                psParser->bChunked = (ustrstr(pcValue, "chunked") != 0);
+            }
+            else if((pcValue = HeaderValueGet(pcLine, "Connection:")) != 0)
+            {
+                if(ustrncasecmp(pcValue, "close", 5) == 0)
+                {
+                    psParser->bKeepAlive = false;
+                }
+                else if(ustrncasecmp(pcValue, "keep-alive", 10) == 0)
+                {
+                    psParser->bKeepAlive = true;
+                }
+            }
+
+            return(HTTP_STATE_HEADER);
+        }
+
+        case HTTP_STATE_CHUNK_SIZE:
+        {
+            //
+            // The size is in hex and may be followed by chunk extensions,
+            // which are ignored.
+            //
+            cDigit = pcLine[0];
+            if(!(((cDigit >= '0') && (cDigit <= '9')) ||
+                 ((cDigit >= 'a') && (cDigit <= 'f')) ||
+                 ((cDigit >= 'A') && (cDigit <= 'F'))))
+            {
+                return(HTTP_STATE_ERROR);
+            }
+
+            psParser->ui32Remaining = ustrtoul(pcLine, 0, 16);
+
+            //
+            // A zero length chunk ends the body.
+            //
+            return(psParser->ui32Remaining ? HTTP_STATE_CHUNK_DATA :
+                                             HTTP_STATE_TRAILER);
+        }
+
+        case HTTP_STATE_CHUNK_END:
+        {
+            return((pcLine[0] == 0) ? HTTP_STATE_CHUNK_SIZE :
+                                      HTTP_STATE_ERROR);
+        }
+
+        case HTTP_STATE_TRAILER:
+        {
+            return((pcLine[0] == 0) ? HTTP_STATE_DONE : HTTP_STATE_TRAILER);
+        }
+
+        default:
+        {
+            return(HTTP_STATE_ERROR);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Pass the next piece of a response to an incremental response parser.
+//!
+//! \param psParser is a pointer to the parser state.
+//! \param pui8Data is a pointer to the data.
+//! \param ui32Size is the number of bytes of data.
+//! \param pui32Used is a pointer to a variable that receives the number of
+//! bytes used by this response.
+//!
+//! This function parses the next piece of a response, passing any body data
+//! to the body callback function.  When a response completes part way through
+//! the data, the remaining bytes belong to the next response on the
+//! connection; their offset is returned in \e pui32Used so that the caller
+//! can pass them to a freshly initialized parser when requests have been
+//! pipelined.
+//!
+//! \return Returns \b HTTP_PARSE_MORE if the response is not yet complete,
+//! \b HTTP_PARSE_DONE if the response is complete, or \b HTTP_PARSE_ERROR
+//! if the response is malformed.
+//
+//*****************************************************************************
+int32_t
+HTTPResponseParserData(tHTTPResponseParser *psParser, const uint8_t *pui8Data,
+                       uint32_t ui32Size, uint32_t *pui32Used)
+{
+    uint32_t ui32Idx, ui32Count;
+    uint8_t ui8State;
+
+    ui8State = psParser->ui8State;
+    ui32Idx = 0;
+
+    while((ui32Idx < ui32Size) && (ui8State != HTTP_STATE_DONE) &&
+          (ui8State != HTTP_STATE_ERROR))
+    {
+        if((ui8State == HTTP_STATE_BODY) ||
+           (ui8State == HTTP_STATE_CHUNK_DATA))
+        {
+            //
+            // Pass as much of the body or chunk as is available.
+            //
+            ui32Count = ui32Size - ui32Idx;
+            if(ui32Count > psParser->ui32Remaining)
+            {
+                ui32Count = psParser->ui32Remaining;
+            }
+
+            psParser->pfnBody(psParser->pvCBData, pui8Data + ui32Idx,
+                              ui32Count);
+            ui32Idx += ui32Count;
+            psParser->ui32Remaining -= ui32Count;
+
+            if(psParser->ui32Remaining == 0)
+            {
+                ui8State = (ui8State == HTTP_STATE_BODY) ?
+                           HTTP_STATE_DONE : HTTP_STATE_CHUNK_END;
+            }
+        }
+        else if(ui8State == HTTP_STATE_BODY_CLOSE)
+        {
+            //
+            // Everything up to the close of the connection is body.
+            //
+            psParser->pfnBody(psParser->pvCBData, pui8Data + ui32Idx,
+                              ui32Size - ui32Idx);
+            ui32Idx = ui32Size;
+        }
+        else if(ParserLineAdd(psParser, (char)pui8Data[ui32Idx++]))
+        {
+            psParser->ui8State = ui8State;
+            ui8State = ParserLineProcess(psParser);
+        }
+
+        psParser->ui8State = ui8State;
+    }
+
+    if(pui32Used)
+    {
+        *pui32Used = ui32Idx;
+    }
+
+    if(ui8State == HTTP_STATE_DONE)
+    {
+        return(HTTP_PARSE_DONE);
+    }
+    if(ui8State == HTTP_STATE_ERROR)
+    {
+        return(HTTP_PARSE_ERROR);
+    }
+    return(HTTP_PARSE_MORE);
+}
+
+//*****************************************************************************
+//
+//! Tell an incremental response parser that the connection has closed.
+//!
+//! \param psParser is a pointer to the parser state.
+//!
+//! A response without a Content-Length header or chunked transfer coding ends
+//! when the server closes the connection, so this function must be called
+//! when the connection closes.
+//!
+//! \return Returns \b HTTP_PARSE_DONE if the response is complete or
+//! \b HTTP_PARSE_ERROR if the connection closed part way through it.
+//
+//*****************************************************************************
+int32_t
+HTTPResponseParserClose(tHTTPResponseParser *psParser)
+{
+    if((psParser->ui8State == HTTP_STATE_BODY_CLOSE) ||
+       (psParser->ui8State == HTTP_STATE_DONE))
+    {
+        psParser->ui8State = HTTP_STATE_DONE;
+        return(HTTP_PARSE_DONE);
+    }
+
+    psParser->ui8State = HTTP_STATE_ERROR;
+    return(HTTP_PARSE_ERROR);
+}
+
+//*****************************************************************************
+//
+//! Return the status code of a response.
+//!
+//! \param psParser is a pointer to the parser state.
+//!
+//! \return Returns the HTTP status code, or 0 if the status line has not yet
+//! been received.
+//
+//*****************************************************************************
+uint32_t
+HTTPResponseStatusGet(tHTTPResponseParser *psParser)
+{
+    return(psParser->ui32Status);
+}
+
+//*****************************************************************************
+//
+//! Determine whether a connection may be reused after a response.
+//!
+//! \param psParser is a pointer to the parser state.
+//!
+//! \return Returns \b true if the server allows further requests on the
+//! connection once this response is complete.
+//
+//*****************************************************************************
+bool
+HTTPResponseKeepAlive(tHTTPResponseParser *psParser)
+{
+    return(psParser->bKeepAlive);
+}
@@ -50,6 +50,123 @@ extern "C"
 #define HTTP_MESSAGE_OPTIONS    0x7
 #define HTTP_MESSAGE_PATCH      0x8
 
+//*****************************************************************************
+//
+// The size of the line buffer used by the incremental response parser.  Any
+// status, header or chunk size line longer than this is truncated, which is
+// harmless for the headers that the parser interprets.
+//
+//*****************************************************************************
+#ifndef HTTP_MAX_LINE
+#define HTTP_MAX_LINE           64
+#endif
+
+//*****************************************************************************
+//
+// Values returned by HTTPResponseParserData() and HTTPResponseParserClose().
+//
+//*****************************************************************************
+#define HTTP_PARSE_MORE         0
+#define HTTP_PARSE_DONE         1
+#define HTTP_PARSE_ERROR        -1
+
+//*****************************************************************************
+//
+// A request builder.  Requests are appended to the buffer one after another,
+// so several requests may be built into the same buffer and sent back to back
+// on a persistent connection.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The buffer that holds the requests.
+    //
+    char *pcBuf;
+
+    //
+    // The size of the buffer in bytes.
+    //
+    uint32_t ui32Size;
+
+    //
+    // The number of bytes used in the buffer.
+    //
+    uint32_t ui32Len;
+
+    //
+    // Indicates that the buffer was too small for the requests.
+    //
+    bool bOverflow;
+}
+tHTTPRequest;
+
+//*****************************************************************************
+//
+// The function called by the response parser with each piece of the body of
+// a response.  Chunked transfer coding has already been removed.
+//
+//*****************************************************************************
+typedef void (*tHTTPBodyCallback)(void *pvCBData, const uint8_t *pui8Data,
+                                  uint32_t ui32Size);
+
+//*****************************************************************************
+//
+// The state of the incremental response parser.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The function called with the body data and its data pointer.
+    //
+    tHTTPBodyCallback pfnBody;
+    void *pvCBData;
+
+    //
+    // The current parser state.
+    //
+    uint8_t ui8State;
+
+    //
+    // Indicates that the response has no body, as for a HEAD request.
+    //
+    bool bNoBody;
+
+    //
+    // Indicates that the body uses chunked transfer coding.
+    //
+    bool bChunked;
+
+    //
+    // Indicates that a Content-Length header was received.
+    //
+    bool bLength;
+
+    //
+    // Indicates that the connection may be used for another request once
+    // this response is complete.
+    //
+    bool bKeepAlive;
+
+    //
+    // The response status code.
+    //
+    uint32_t ui32Status;
+
+    //
+    // The number of body bytes remaining in the body or current chunk.
+    //
+    uint32_t ui32Remaining;
+
+    //
+    // The line currently being read.
+    //
+    char pcLine[HTTP_MAX_LINE];
+    uint32_t ui32LineLen;
+}
+tHTTPResponseParser;
+
 //*****************************************************************************
 //
 // Exported function prototypes.
@@ -68,6 +185,25 @@ extern void HTTPResponseHeaderExtract(char *pcData, uint32_t ui32HeaderIdx,
 
 extern void HTTPResponseBodyExtract(char *pcData, char *pcDest);
 
+extern void HTTPRequestInit(tHTTPRequest *psRequest, char *pcBuf,
+                            uint32_t ui32Size);
+extern void HTTPRequestStart(tHTTPRequest *psRequest, uint8_t ui8Type,
+                             const char *pcResource);
+extern void HTTPRequestHeaderAdd(tHTTPRequest *psRequest,
+                                 const char *pcHeaderName,
+                                 const char *pcHeaderValue);
+extern uint32_t HTTPRequestEnd(tHTTPRequest *psRequest);
+
+extern void HTTPResponseParserInit(tHTTPResponseParser *psParser,
+                                   tHTTPBodyCallback pfnBody, void *pvCBData,
+                                   bool bNoBody);
+extern int32_t HTTPResponseParserData(tHTTPResponseParser *psParser,
+                                      const uint8_t *pui8Data,
+                                      uint32_t ui32Size, uint32_t *pui32Used);
+extern int32_t HTTPResponseParserClose(tHTTPResponseParser *psParser);
+extern uint32_t HTTPResponseStatusGet(tHTTPResponseParser *psParser);
+extern bool HTTPResponseKeepAlive(tHTTPResponseParser *psParser);
+
 #ifdef __cplusplus
 }
 #endif
@@ -378,12 +378,13 @@
 // ---------- checksum options ----------
 //
 //*****************************************************************************
-//#define CHECKSUM_GEN_IP                 1
-//#define CHECKSUM_GEN_UDP                1
-//#define CHECKSUM_GEN_TCP                1
-//#define CHECKSUM_CHECK_IP               1
-//#define CHECKSUM_CHECK_UDP              1
-//#define CHECKSUM_CHECK_TCP              1
+#define CHECKSUM_GEN_IP                 0           // default is 1
+#define CHECKSUM_GEN_ICMP               0           // default is 1
+#define CHECKSUM_GEN_UDP                0           // default is 1
+#define CHECKSUM_GEN_TCP                0           // default is 1
+#define CHECKSUM_CHECK_IP               0           // default is 1
+#define CHECKSUM_CHECK_UDP              0           // default is 1
+#define CHECKSUM_CHECK_TCP              0           // default is 1
 
 //*****************************************************************************
 //
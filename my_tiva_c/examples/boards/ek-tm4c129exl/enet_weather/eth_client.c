@@ -32,6 +32,7 @@
 #include "driverlib/systick.h"
 #include "utils/lwiplib.h"
 #include "lwip/dns.h"
+#include "drivers/http.h"
 #include "eth_client.h"
 #include "json.h"
 
@@ -45,6 +46,7 @@
 #define FLAG_TIMER_TCP_EN       2
 #define FLAG_DHCP_STARTED       3
 #define FLAG_DNS_ADDRFOUND      4
+#define FLAG_TCP_CONNECTED      5
 
 //*****************************************************************************
 //
@@ -110,10 +112,11 @@ g_sEnet;
 
 //*****************************************************************************
 //
-// Maximum size of an weather request.
+// Maximum size of an weather request and of the resource that it requests.
 //
 //*****************************************************************************
-#define MAX_REQUEST             256
+#define MAX_REQUEST             320
+#define MAX_RESOURCE            256
 
 extern uint32_t g_ui32SysClock;
 
@@ -122,16 +125,17 @@ extern uint32_t g_ui32SysClock;
 // Various strings used to access weather information on the web.
 //
 //*****************************************************************************
+static const char g_cWeatherHost[] = "api.openweathermap.org";
+
 static const char g_cWeatherRequest[] =
-    "GET http://api.openweathermap.org/data/2.5/weather?q=";
+    "http://api.openweathermap.org/data/2.5/weather?q=";
 
 static const char g_cWeatherRequestForecast[] =
-    "GET http://api.openweathermap.org/data/2.5/forecast/daily?q=";
+    "http://api.openweathermap.org/data/2.5/forecast/daily?q=";
 static const char g_cMode[] = "&mode=json&units=metric";
 
 static char g_cAPPIDOpenWeather[] =
     "&APPID=afc5370fef1dfec1666a5676346b163b";
-static char g_cHTTP11[] = " HTTP/1.0\r\n\r\n";
 
 //*****************************************************************************
 //
@@ -164,6 +168,12 @@ struct
     //
     tWeatherReport *psWeatherReport;
 
+    //
+    // The local buffer used to build the resource for the current weather
+    // request.
+    //
+    char pcResource[MAX_RESOURCE];
+
     //
     // The local buffer used to store the current weather request.
     //
@@ -173,6 +183,28 @@ struct
     // The number of valid bytes in the request.
     //
     uint32_t ui32RequestSize;
+
+    //
+    // The number of bytes of the response body that have been passed to the
+    // parser.
+    //
+    uint32_t ui32ResponseSize;
+
+    //
+    // The HTTP response parser for the current request.
+    //
+    tHTTPResponseParser sResponse;
+
+    //
+    // Indicates that a response to the current request is expected.
+    //
+    bool bResponse;
+
+    //
+    // Indicates that the response could not be parsed, so the connection is
+    // closed once the data received with it has been handled.
+    //
+    bool bAbort;
 }
 g_sWeather;
 
@@ -193,6 +225,8 @@ EthClientReset(void)
     // Reset the flags to just enable the lwIP timer.
     //
     g_sEnet.ui32Flags = (1 << FLAG_TIMER_DHCP_EN);
+    g_sWeather.bResponse = false;
+    g_sWeather.bAbort = false;
 
     //
     // Reset the addresses.
@@ -236,6 +270,140 @@ EthClientReset(void)
 static void
 TCPError(void *vPArg, err_t iErr)
 {
+    //
+    // lwIP has already freed the connection, so it must not be used again.
+    //
+    g_sEnet.psTCP = 0;
+    HWREGBITW(&g_sEnet.ui32Flags, FLAG_TCP_CONNECTED) = 0;
+    g_sWeather.bResponse = false;
+    g_sWeather.bAbort = false;
+}
+
+//*****************************************************************************
+//
+// Sends a weather event to the application for the current request.
+//
+//*****************************************************************************
+static void
+WeatherEventSend(uint32_t ui32Event)
+{
+    if(g_sWeather.pfnEvent)
+    {
+        if(ui32Event == ETH_EVENT_RECEIVE)
+        {
+            g_sWeather.pfnEvent(ETH_EVENT_RECEIVE,
+                                (void *)g_sWeather.psWeatherReport, 0);
+        }
+        else
+        {
+            g_sWeather.pfnEvent(ui32Event, 0, 0);
+        }
+
+        //
+        // Return to the idle state.
+        //
+        g_sEnet.eState = iEthIdle;
+    }
+}
+
+//*****************************************************************************
+//
+// Called by the HTTP response parser with each piece of the response body.
+//
+//*****************************************************************************
+static void
+WeatherBody(void *pvCBData, const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    int32_t i32Items;
+
+    //
+    // Ignore the rest of the body once the report has been sent.
+    //
+    if(g_sEnet.eState != iEthQueryWait)
+    {
+        return;
+    }
+
+    //
+    // Read items from the buffer.
+    //
+    if(g_sEnet.ulRequest == WEATHER_CURRENT)
+    {
+        i32Items = JSONParseCurrent(g_sWeather.ui32ResponseSize,
+                                    g_sWeather.psWeatherReport, pui8Data,
+                                    ui32Size);
+    }
+    else
+    {
+        i32Items = JSONParseForecast(g_sWeather.ui32ResponseSize,
+                                     g_sWeather.psWeatherReport, pui8Data,
+                                     ui32Size);
+    }
+
+    g_sWeather.ui32ResponseSize += ui32Size;
+
+    //
+    // Make sure some items were found.
+    //
+    if(i32Items > 0)
+    {
+        WeatherEventSend(ETH_EVENT_RECEIVE);
+    }
+    else if(i32Items < 0)
+    {
+        //
+        // This was not a valid request.
+        //
+        WeatherEventSend(ETH_EVENT_INVALID_REQ);
+    }
+}
+
+//*****************************************************************************
+//
+// Handles the end of a response to a weather request.
+//
+//*****************************************************************************
+static void
+WeatherResponseEnd(int32_t i32Status)
+{
+    g_sWeather.bResponse = false;
+
+    //
+    // Only reuse the connection if the server allows it.  Otherwise the next
+    // request opens a new connection.
+    //
+    if((i32Status != HTTP_PARSE_DONE) ||
+       !HTTPResponseKeepAlive(&g_sWeather.sResponse))
+    {
+        HWREGBITW(&g_sEnet.ui32Flags, FLAG_TCP_CONNECTED) = 0;
+    }
+
+    //
+    // A malformed response is reported at once.  The connection is closed,
+    // since the rest of the response cannot be found in the data that
+    // follows, and the application may make another request.
+    //
+    if(i32Status != HTTP_PARSE_DONE)
+    {
+        WeatherEventSend(ETH_EVENT_INVALID_REQ);
+        g_sWeather.pfnEvent = 0;
+        g_sWeather.bAbort = true;
+        return;
+    }
+
+    //
+    // The response did not contain a complete report.
+    //
+    if(g_sEnet.eState == iEthQueryWait)
+    {
+        WeatherEventSend(ETH_EVENT_INVALID_REQ);
+    }
+
+    //
+    // The request is complete, so allow the application to make another one
+    // on this connection.
+    //
+    g_sWeather.pfnEvent = 0;
 }
 
 //*****************************************************************************
@@ -258,10 +426,20 @@ static err_t
 TCPReceive(void *pvArg, struct tcp_pcb *psPcb, struct pbuf *psBuf, err_t iErr)
 {
     struct pbuf *psBufCur;
-    int32_t i32Items;
+    int32_t i32Status;
 
     if(psBuf == 0)
     {
+        //
+        // A response without a length ends when the connection closes.
+        //
+        if(g_sWeather.bResponse)
+        {
+            WeatherResponseEnd(
+                HTTPResponseParserClose(&g_sWeather.sResponse));
+        }
+        g_sWeather.bAbort = false;
+
         //
         // Tell the application that the connection was closed.
         //
@@ -279,6 +457,7 @@ TCPReceive(void *pvArg, struct tcp_pcb *psPcb, struct pbuf *psBuf, err_t iErr)
         if(psPcb == g_sEnet.psTCP)
         {
             g_sEnet.psTCP = 0;
+            HWREGBITW(&g_sEnet.ui32Flags, FLAG_TCP_CONNECTED) = 0;
         }
 
         g_sEnet.eState = iEthIdle;
@@ -286,91 +465,23 @@ TCPReceive(void *pvArg, struct tcp_pcb *psPcb, struct pbuf *psBuf, err_t iErr)
         return(ERR_OK);
     }
 
-    if(g_sEnet.eState == iEthQueryWait)
+    //
+    // Pass each buffer in the chain to the response parser.  Only one request
+    // is outstanding at a time, so anything received after the end of its
+    // response is discarded.
+    //
+    for(psBufCur = psBuf; psBufCur && g_sWeather.bResponse;
+        psBufCur = psBufCur->next)
     {
-        if(g_sEnet.ulRequest == WEATHER_CURRENT)
-        {
-            //
-            // Read items from the buffer.
-            //
-            i32Items = JSONParseCurrent(0, g_sWeather.psWeatherReport, psBuf);
+        i32Status = HTTPResponseParserData(&g_sWeather.sResponse,
+                                           psBufCur->payload, psBufCur->len,
+                                           0);
 
-            //
-            // Make sure some items were found.
-            //
-            if(i32Items > 0)
-            {
-                if(g_sWeather.pfnEvent)
-                {
-                    g_sWeather.pfnEvent(ETH_EVENT_RECEIVE,
-                                        (void *)g_sWeather.psWeatherReport, 0);
-
-                    //
-                    // Clear the event function and return to the idle state.
-                    //
-                    g_sEnet.eState = iEthIdle;
-                }
-            }
-            else if(i32Items < 0)
-            {
-                if(g_sWeather.pfnEvent)
-                {
-                    //
-                    // This was not a valid request.
-                    //
-                    g_sWeather.pfnEvent(ETH_EVENT_INVALID_REQ, 0, 0);
-
-                    //
-                    // Clear the event function and return to the idle state.
-                    //
-                    g_sEnet.eState = iEthIdle;
-                }
-            }
-        }
-        else if(g_sEnet.ulRequest == WEATHER_FORECAST)
+        if(i32Status != HTTP_PARSE_MORE)
         {
-            //
-            // Read items from the buffer.
-            //
-            i32Items = JSONParseForecast(0, g_sWeather.psWeatherReport, psBuf);
-
-            if(i32Items > 0)
-            {
-                if(g_sWeather.pfnEvent)
-                {
-                    g_sWeather.pfnEvent(ETH_EVENT_RECEIVE,
-                                        (void *)g_sWeather.psWeatherReport, 0);
-
-                    //
-                    // Clear the event function and return to the idle state.
-                    //
-                    g_sEnet.eState = iEthIdle;
-                }
-            }
-            else if(i32Items < 0)
-            {
-                if(g_sWeather.pfnEvent)
-                {
-                    //
-                    // This was not a valid request.
-                    //
-                    g_sWeather.pfnEvent(ETH_EVENT_INVALID_REQ, 0, 0);
-
-                    //
-                    // Clear the event function and return to the idle state.
-                    //
-                    g_sEnet.eState = iEthIdle;
-                }
-            }
+            WeatherResponseEnd(i32Status);
         }
     }
-    else
-    {
-        //
-        // Go to idle state.
-        //
-        g_sEnet.eState = iEthIdle;
-    }
 
     //
     // Initialize the linked list pointer to parse.
@@ -406,6 +517,24 @@ TCPReceive(void *pvArg, struct tcp_pcb *psPcb, struct pbuf *psBuf, err_t iErr)
     //
     pbuf_free(psBuf);
 
+    //
+    // Close the connection if the response could not be parsed.
+    //
+    if(g_sWeather.bAbort)
+    {
+        g_sWeather.bAbort = false;
+
+        tcp_sent(psPcb, NULL);
+        tcp_recv(psPcb, NULL);
+        tcp_err(psPcb, NULL);
+        tcp_close(psPcb);
+
+        if(psPcb == g_sEnet.psTCP)
+        {
+            g_sEnet.psTCP = 0;
+        }
+    }
+
     //
     // Return.
     //
@@ -498,6 +627,7 @@ TCPConnected(void *pvArg, struct tcp_pcb *psPcb, err_t iErr)
     //
     // Connection is complete.
     //
+    HWREGBITW(&g_sEnet.ui32Flags, FLAG_TCP_CONNECTED) = 1;
     g_sEnet.eState = iEthTCPConnectComplete;
 
     //
@@ -524,6 +654,7 @@ EthClientTCPConnect(uint32_t ui32Port)
     // Enable the TCP timer function calls.
     //
     HWREGBITW(&g_sEnet.ui32Flags, FLAG_TIMER_TCP_EN) = 1;
+    HWREGBITW(&g_sEnet.ui32Flags, FLAG_TCP_CONNECTED) = 0;
 
     if(g_sEnet.psTCP)
     {
@@ -584,6 +715,15 @@ EthClientTCPDisconnect(void)
     // No longer have a link.
     //
     g_sEnet.eState = iEthNoConnection;
+    HWREGBITW(&g_sEnet.ui32Flags, FLAG_TCP_CONNECTED) = 0;
+    g_sWeather.bResponse = false;
+    g_sWeather.bAbort = false;
+
+    //
+    // Abandon any outstanding request so that the application may make
+    // another one.
+    //
+    g_sWeather.pfnEvent = 0;
 
     //
     // Deallocate the TCP structure if it was already allocated.
@@ -1017,7 +1157,7 @@ EthClientTick(uint32_t ui32TickMS)
             //
             // Resolve the host by name.
             //
-            i32Ret = EthClientDNSResolve("api.openweathermap.org");
+            i32Ret = EthClientDNSResolve(g_cWeatherHost);
         }
         else
         {
@@ -1084,6 +1224,10 @@ EthClientTick(uint32_t ui32TickMS)
             //
             // Waiting on a query response.
             //
+            HTTPResponseParserInit(&g_sWeather.sResponse, WeatherBody, 0,
+                                   false);
+            g_sWeather.ui32ResponseSize = 0;
+            g_sWeather.bResponse = true;
             g_sEnet.eState = iEthQueryWait;
         }
         else
@@ -1126,20 +1270,20 @@ MergeRequest(int32_t i32Offset, const char *pcSrc, int32_t i32Size,
     {
         if((pcSrc[i32Idx] == ' ') && (bReplaceSpace))
         {
-            if((i32Offset + 3) >= sizeof(g_sWeather.pcRequest))
+            if((i32Offset + 3) >= sizeof(g_sWeather.pcResource))
             {
                 break;
             }
-            g_sWeather.pcRequest[i32Offset++] = '%';
-            g_sWeather.pcRequest[i32Offset++] = '2';
-            g_sWeather.pcRequest[i32Offset] = '0';
+            g_sWeather.pcResource[i32Offset++] = '%';
+            g_sWeather.pcResource[i32Offset++] = '2';
+            g_sWeather.pcResource[i32Offset] = '0';
         }
         else
         {
-            g_sWeather.pcRequest[i32Offset] = pcSrc[i32Idx];
+            g_sWeather.pcResource[i32Offset] = pcSrc[i32Idx];
         }
 
-        if((i32Offset >= sizeof(g_sWeather.pcRequest)) ||
+        if((i32Offset >= sizeof(g_sWeather.pcResource)) ||
            (pcSrc[i32Idx] == 0))
         {
             break;
@@ -1151,6 +1295,62 @@ MergeRequest(int32_t i32Offset, const char *pcSrc, int32_t i32Size,
     return(i32Offset);
 }
 
+//*****************************************************************************
+//
+// Builds the HTTP request for the resource in g_sWeather.pcResource and sends
+// it, reusing the connection to the server if it is still open.
+//
+//*****************************************************************************
+static int32_t
+WeatherRequestSend(unsigned long ulRequest)
+{
+    tHTTPRequest sRequest;
+
+    //
+    // Build an HTTP/1.1 request, which leaves the connection open after the
+    // response.
+    //
+    HTTPRequestInit(&sRequest, g_sWeather.pcRequest,
+                    sizeof(g_sWeather.pcRequest));
+    HTTPRequestStart(&sRequest, HTTP_MESSAGE_GET, g_sWeather.pcResource);
+    HTTPRequestHeaderAdd(&sRequest, "Host", g_cWeatherHost);
+
+    //
+    // Save the size of this request.
+    //
+    g_sWeather.ui32RequestSize = HTTPRequestEnd(&sRequest);
+
+    if(g_sWeather.ui32RequestSize == 0)
+    {
+        return(-1);
+    }
+
+    g_sEnet.ulRequest = ulRequest;
+
+    //
+    // If the previous response left the connection open then send the
+    // request on it without a new TCP handshake.
+    //
+    if(HWREGBITW(&g_sEnet.ui32Flags, FLAG_TCP_CONNECTED) && g_sEnet.psTCP)
+    {
+        g_sEnet.eState = iEthTCPConnectComplete;
+
+        return(0);
+    }
+
+    //
+    // Connect or reconnect to port 80.
+    //
+    g_sEnet.eState = iEthTCPConnectWait;
+
+    if(EthClientTCPConnect(80) != ERR_OK)
+    {
+        return(-1);
+    }
+
+    return(0);
+}
+
 //*****************************************************************************
 //
 // Gets the daily forecast for a given city.
@@ -1175,11 +1375,6 @@ WeatherForecast(tWeatherSource eWeatherSource, const char *pcQuery,
     g_sWeather.pfnEvent = pfnEvent;
     g_sWeather.psWeatherReport = psWeatherReport;
 
-    //
-    // Connect or reconnect to port 80.
-    //
-    g_sEnet.eState = iEthTCPConnectWait;
-
     //
     // Copy the base forecast request to the buffer.
     //
@@ -1189,7 +1384,7 @@ WeatherForecast(tWeatherSource eWeatherSource, const char *pcQuery,
     //
     // Append the request.
     //
-    i32Idx = MergeRequest(i32Idx, pcQuery, sizeof(g_sWeather.pcRequest),
+    i32Idx = MergeRequest(i32Idx, pcQuery, sizeof(g_sWeather.pcResource),
                           true);
 
     //
@@ -1205,30 +1400,13 @@ WeatherForecast(tWeatherSource eWeatherSource, const char *pcQuery,
     //
     // Append the App ID.
     //
-    i32Idx = MergeRequest(i32Idx, g_cAPPIDOpenWeather,
-                          sizeof(g_cAPPIDOpenWeather), false);
-
-    //
-    // Append the "HTTP:/1.1" string.
-    //
-    i32Idx = MergeRequest(i32Idx, g_cHTTP11, sizeof(g_cHTTP11), false);
+    MergeRequest(i32Idx, g_cAPPIDOpenWeather, sizeof(g_cAPPIDOpenWeather),
+                 false);
 
     //
     // Forcast weather report request.
     //
-    g_sEnet.ulRequest = WEATHER_FORECAST;
-
-    if(EthClientTCPConnect(80) != ERR_OK)
-    {
-        return(-1);
-    }
-
-    //
-    // Save the size of the request.
-    //
-    g_sWeather.ui32RequestSize = i32Idx;
-
-    return(0);
+    return(WeatherRequestSend(WEATHER_FORECAST));
 }
 
 //*****************************************************************************
@@ -1263,7 +1441,8 @@ WeatherCurrent(tWeatherSource eWeatherSource, const char *pcQuery,
     //
     // Append the request.
     //
-    i32Idx = MergeRequest(i32Idx, pcQuery, sizeof(g_sWeather.pcRequest), true);
+    i32Idx = MergeRequest(i32Idx, pcQuery, sizeof(g_sWeather.pcResource),
+                          true);
 
     //
     // Append the request mode.
@@ -1273,37 +1452,12 @@ WeatherCurrent(tWeatherSource eWeatherSource, const char *pcQuery,
     //
     // Append the App ID.
     //
-    i32Idx = MergeRequest(i32Idx, g_cAPPIDOpenWeather,
-                          sizeof(g_cAPPIDOpenWeather), false);
-
-    //
-    // Append the "HTTP:/1.1" string.
-    //
-    i32Idx = MergeRequest(i32Idx, g_cHTTP11, sizeof(g_cHTTP11), false);
-
-    //
-    // Save the size of this request.
-    //
-    g_sWeather.ui32RequestSize = i32Idx;
-
-    //
-    // Connect or reconnect to port 80.
-    //
-    g_sEnet.eState = iEthTCPConnectWait;
+    MergeRequest(i32Idx, g_cAPPIDOpenWeather, sizeof(g_cAPPIDOpenWeather),
+                 false);
 
     //
     // Current weather report request.
     //
-    g_sEnet.ulRequest = WEATHER_CURRENT;
-
-    //
-    // Connect to server
-    //
-    if(EthClientTCPConnect(80) != ERR_OK)
-    {
-        return(-1);
-    }
-
-    return(0);
+    return(WeatherRequestSend(WEATHER_CURRENT));
 }
 
@@ -21,81 +21,79 @@
 // This is part of revision 2.1.4.178 of the EK-TM4C129EXL Firmware Package.
 //
 //*****************************************************************************
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include "utils/ustdlib.h"
 #include "utils/lwiplib.h"
+#include "utils/jsonparse.h"
 #include "eth_client.h"
 #include "json.h"
 #include "images.h"
 
-//****************************************************************************
-//
-// The locally defined lwIP buffer parsing pointer.
-//
-//****************************************************************************
-typedef struct
-{
-    //
-    // A pbuf pointer from lwIP.
-    //
-    struct pbuf *psBuf;
-
-    //
-    // The current index into the pbuf pointer.
-    //
-    uint32_t ui32Idx;
-}
-tBufPtr;
-
-//****************************************************************************
+//*****************************************************************************
 //
-// Initialize a buffer parsing pointer.
+// The indexes of the values of interest in the current weather response.
+// These must match the order of g_psCurrentHandlers.
 //
-//****************************************************************************
-static void
-BufPtrInit(tBufPtr *psBufPtr, struct pbuf *psBuf)
-{
-    psBufPtr->psBuf = psBuf;
-    psBufPtr->ui32Idx = 0;
-}
+//*****************************************************************************
+#define CURRENT_COD             0
+#define CURRENT_ICON            1
+#define CURRENT_SUNRISE         2
+#define CURRENT_SUNSET          3
+#define CURRENT_TIME            4
+#define CURRENT_HUMIDITY        5
+#define CURRENT_TEMP            6
+#define CURRENT_PRESSURE        7
 
-//****************************************************************************
+//*****************************************************************************
 //
-// Get a single byte from a parsing pointer.
+// The indexes of the values of interest in the forecast response.  These must
+// match the order of g_psForecastHandlers.
 //
-//****************************************************************************
-static uint8_t
-BufData8Get(tBufPtr *psBufPtr)
-{
-    return(((uint8_t *)psBufPtr->psBuf->payload)[psBufPtr->ui32Idx]);
-}
+//*****************************************************************************
+#define FORECAST_COD            0
+#define FORECAST_HUMIDITY       1
+#define FORECAST_PRESSURE       2
+#define FORECAST_TEMP           3
+#define FORECAST_TEMP_LOW       4
+#define FORECAST_TEMP_HIGH      5
+#define FORECAST_TIME           6
 
 //*****************************************************************************
 //
-// Increment a parsing pointer by a given value.
+// The state of the response currently being parsed.  The response body
+// arrives in several pieces, each of which is passed to the streaming parser
+// once as it is received.
 //
 //*****************************************************************************
-uint32_t
-BufPtrInc(tBufPtr *psBufPtr, uint32_t ui32Inc)
+static struct
 {
-    psBufPtr->ui32Idx += ui32Inc;
+    //
+    // The streaming JSON parser state.
+    //
+    tJSONParser sParser;
 
-    if(psBufPtr->ui32Idx >= psBufPtr->psBuf->len)
-    {
-        psBufPtr->ui32Idx = 0;
+    //
+    // A bit mask of the handler indexes whose values have already been found.
+    // Only the first value found for each path is used, which for forecasts
+    // is the value for the first day in the list.
+    //
+    uint32_t ui32Found;
 
-        psBufPtr->psBuf = psBufPtr->psBuf->next;
+    //
+    // The number of values that have been found.
+    //
+    int32_t i32Items;
 
-        if(psBufPtr->psBuf == 0)
-        {
-            ui32Inc = 0;
-        }
-    }
-    return(ui32Inc);
+    //
+    // Indicates that the server returned a 404 not found code.
+    //
+    bool bNotFound;
 }
+g_sJSONResponse;
 
 //*****************************************************************************
 //
@@ -174,670 +172,345 @@ GetImage(char *pcIcon, const uint8_t **ppui8Image, const char **ppcDescription)
 
 //*****************************************************************************
 //
-// Compare a string at the current location of a parsing pointer.
+// Returns true the first time that a value is found for a given handler
+// index and counts it as a found item.
 //
 //*****************************************************************************
-uint32_t
-CompareString(tBufPtr *psBufPtr, const char *pcField, uint32_t ui32Size)
+static bool
+FirstValue(uint32_t ui32Index)
 {
-    uint32_t ui32Idx;
-
-    for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+    if(g_sJSONResponse.ui32Found & (1 << ui32Index))
     {
-        if(BufData8Get(psBufPtr) == pcField[ui32Idx])
-        {
-            if(BufPtrInc(psBufPtr, 1) != 1)
-            {
-                break;
-            }
-        }
-        else
-        {
-            break;
-        }
+        return(false);
     }
 
-    if(ui32Idx == ui32Size)
-    {
-        return(0);
-    }
+    g_sJSONResponse.ui32Found |= (1 << ui32Index);
 
-    return(1);
+    return(true);
 }
 
 //*****************************************************************************
 //
-// This function searches for a field from the JSON data.  The field should be
-// quoted in the data and immediately follow a '{' character.  This can be used
-// to also search for sub data in another field if the pointer to the data for
-// the parent field.
+// Convert a JSON value to an integer.  Fractional parts are discarded.
 //
 //*****************************************************************************
-static uint32_t
-GetField(char *pcField, tBufPtr *psBufPtr)
+static int32_t
+ValueInt(uint32_t ui32Type, const char *pcValue)
 {
-    uint32_t ui32Curly, ui32Quote;
-    int32_t i32NewItem;
+    const char *pcEnd;
 
-    ui32Curly = 0;
-    i32NewItem = 0;
-    ui32Quote = 0;
-
-    while(1)
+    if(ui32Type != JSON_TYPE_NUMBER)
     {
-        if(BufData8Get(psBufPtr) == '{')
-        {
-            ui32Curly++;
-        }
-        else if(BufData8Get(psBufPtr) == '}')
-        {
-            ui32Curly--;
-
-            if(ui32Curly == 1)
-            {
-                ui32Quote = 0;
-            }
-        }
-        else if(BufData8Get(psBufPtr) == ',')
-        {
-            if((ui32Curly == 1) && ((ui32Quote & 1) == 0))
-            {
-                ui32Quote = 0;
-            }
-        }
-        else if(BufData8Get(psBufPtr) == '"')
-        {
-            if((ui32Curly == 1) && (ui32Quote == 0))
-            {
-                i32NewItem = 1;
-            }
-            ui32Quote++;
-        }
-
-        if(BufPtrInc(psBufPtr, 1) != 1)
-        {
-            break;
-        }
-
-        if(i32NewItem)
-        {
-            i32NewItem = 0;
-            if(CompareString(psBufPtr, pcField, ustrlen(pcField)) == 0)
-            {
-                while(1)
-                {
-                    if(BufData8Get(psBufPtr) == ':')
-                    {
-                        if(BufPtrInc(psBufPtr, 1) != 1)
-                        {
-                            break;
-                        }
-                        return(1);
-                    }
-
-                    if(BufPtrInc(psBufPtr, 1) != 1)
-                    {
-                        break;
-                    }
-                }
-                return(0);
-            }
-        }
+        return(INVALID_INT);
     }
-    return(0);
+
+    return((int32_t)ustrtoul(pcValue, &pcEnd, 10));
 }
 
 //*****************************************************************************
 //
-// This function searches for a value in a JSON item as an integer.  These are
-// non-quoted values so if the number is a quoted integer this function returns
-// -1.  If the value is found then it is returned by this function.
+// Check the "cod" value of a response for a 404 not found error.  The code is
+// returned either as a number or as a quoted string.
 //
 //*****************************************************************************
-int32_t
-GetFieldValueInt(tBufPtr *psBufPtr)
+static void
+CheckCode(uint32_t ui32Type, const char *pcValue)
 {
-    int32_t i32Idx;
-    char pcTemp[20];
-    const char *pEnd;
-
-    i32Idx = 0;
-
-    while(1)
+    if(((ui32Type == JSON_TYPE_NUMBER) ||
+        (ui32Type == JSON_TYPE_STRING)) &&
+       (ustrncmp(pcValue, "404", 4) == 0))
     {
-        //
-        // Find the end of this item.
-        //
-        if((BufData8Get(psBufPtr) == '}') || (BufData8Get(psBufPtr) == ','))
-        {
-            //
-            // null terminate the string and get the value from the string in
-            // decimal.
-            //
-            pcTemp[i32Idx] = 0;
-            return(ustrtoul(pcTemp, &pEnd, 10));
-        }
-
-        //
-        // Should not hit a " char or something went wrong.
-        //
-        if(BufData8Get(psBufPtr) == '"')
-        {
-            break;
-        }
-
-        //
-        // Copy the string to the local variable.
-        //
-        pcTemp[i32Idx] = BufData8Get(psBufPtr);
-
-        if((pcTemp[i32Idx] == '\r') || (pcTemp[i32Idx] == '\n'))
-        {
-            pcTemp[i32Idx] = 0;
-        }
-        else
-        {
-            i32Idx++;
-        }
-
-        if(BufPtrInc(psBufPtr, 1) != 1)
-        {
-            break;
-        }
-
-        //
-        // Number was too large to represent.
-        //
-        if(i32Idx >= sizeof(pcTemp))
-        {
-            break;
-        }
+        g_sJSONResponse.bNotFound = true;
     }
-    return(INVALID_INT);
 }
 
 //*****************************************************************************
 //
-// This function searches for a value in a JSON item as quoted value.  These
-// values are quoted values so if the number is not a quoted value this
-// function returns -1.  If the quoted value is found then it is returned in
-// the pcDataDest array.
+// Called by the JSON parser for each value of interest in the current weather
+// response.
 //
 //*****************************************************************************
-int32_t
-GetFieldValueString(tBufPtr *psBufPtr, char *pcDataDest, uint32_t ui32SizeDest)
+static void
+CurrentValue(void *pvCBData, uint32_t ui32Index, uint32_t ui32Type,
+             const char *pcValue)
 {
-    int32_t i32OutIdx;
+    tWeatherReport *psWeatherReport;
 
-    //
-    // The value should always start with a " char or something went wrong.
-    //
-    if(BufData8Get(psBufPtr) != '"')
-    {
-        return(-1);
-    }
+    psWeatherReport = (tWeatherReport *)pvCBData;
 
-    //
-    // Skip the initial " char.
-    //
-    if(BufPtrInc(psBufPtr, 1) != 1)
+    if(!FirstValue(ui32Index))
     {
-        return(-1);
+        return;
     }
 
-    for(i32OutIdx = 0; i32OutIdx < ui32SizeDest;)
+    switch(ui32Index)
     {
-        //
-        // Either a '}', ',', or '"' ends an item.
-        //
-        if((BufData8Get(psBufPtr) == '}') ||
-           (BufData8Get(psBufPtr) == ',') ||
-           (BufData8Get(psBufPtr) == '"'))
+        case CURRENT_COD:
         {
+            CheckCode(ui32Type, pcValue);
+            return;
+        }
+        case CURRENT_ICON:
+        {
+            if((ui32Type != JSON_TYPE_STRING) || (ustrlen(pcValue) < 2))
+            {
+                //
+                // No image was found.
+                //
+                psWeatherReport->pui8Image = 0;
+                return;
+            }
+
             //
-            // Null terminate the string and return.
+            // Save the image pointer.
             //
-            pcDataDest[i32OutIdx] = 0;
-            return(i32OutIdx);
+            GetImage((char *)pcValue, &psWeatherReport->pui8Image,
+                     &psWeatherReport->pcDescription);
+            break;
         }
-
-        //
-        // Continue coping chars into the destination buffer.
-        //
-        pcDataDest[i32OutIdx] = BufData8Get(psBufPtr);
-
-        //
-        // These can occur in the response string and need to be ignored.
-        //
-        if((pcDataDest[i32OutIdx] == '\r') || (pcDataDest[i32OutIdx] == '\n'))
+        case CURRENT_SUNRISE:
         {
-            pcDataDest[i32OutIdx] = 0;
+            psWeatherReport->ui32SunRise = ValueInt(ui32Type, pcValue);
+            break;
         }
-        else
+        case CURRENT_SUNSET:
         {
-            i32OutIdx++;
+            psWeatherReport->ui32SunSet = ValueInt(ui32Type, pcValue);
+            break;
         }
-
-        if(BufPtrInc(psBufPtr, 1) != 1)
+        case CURRENT_TIME:
         {
+            psWeatherReport->ui32Time = ValueInt(ui32Type, pcValue);
             break;
         }
+        case CURRENT_HUMIDITY:
+        {
+            psWeatherReport->i32Humidity = ValueInt(ui32Type, pcValue);
+            break;
+        }
+        case CURRENT_TEMP:
+        {
+            psWeatherReport->i32Temp = ValueInt(ui32Type, pcValue);
+            break;
+        }
+        case CURRENT_PRESSURE:
+        {
+            psWeatherReport->i32Pressure = ValueInt(ui32Type, pcValue);
+            break;
+        }
+        default:
+        {
+            return;
+        }
     }
 
-    //
-    // Make sure to null terminate inside the current string.
-    //
-    if(i32OutIdx == ui32SizeDest)
-    {
-        pcDataDest[i32OutIdx-1] = 0;
-        return(i32OutIdx - 1);
-    }
-    return(-1);
+    g_sJSONResponse.i32Items++;
 }
 
 //*****************************************************************************
 //
-// Fill out the psWeatherReport structure from data returned from the JSON
-// query.
+// Called by the JSON parser for each value of interest in the forecast
+// response.
 //
 //*****************************************************************************
-int32_t
-JSONParseForecast(uint32_t ui32Index, tWeatherReport *psWeatherReport,
-                  struct pbuf *psBuf)
+static void
+ForecastValue(void *pvCBData, uint32_t ui32Index, uint32_t ui32Type,
+              const char *pcValue)
 {
-    tBufPtr sBufPtr, sBufList, sBufTemp;
-    char pcCode[4];
-    int32_t i32Items,i32Code;
+    tWeatherReport *psWeatherReport;
 
+    psWeatherReport = (tWeatherReport *)pvCBData;
 
-    //
-    // Reset the pointers.
-    //
-    BufPtrInit(&sBufPtr, psBuf);
-
-    //
-    // Check and see if the request was valid.
-    //
-    if(GetField("cod", &sBufPtr) != 0)
+    if(!FirstValue(ui32Index))
     {
-        //
-        // Check for a 404 not found error.
-        //
-        sBufTemp = sBufPtr;
-
-        //
-        // Check for a 404 not found error.
-        //
-        i32Code = GetFieldValueInt(&sBufTemp);
-
-        sBufTemp = sBufPtr;
-
-        if(i32Code != INVALID_INT)
-        {
-            if(i32Code == 404)
-            {
-                return(-1);
-            }
-        }
-        else if(GetFieldValueString(&sBufTemp, pcCode, sizeof(pcCode)) >= 0)
-        {
-            //
-            // Check for a 404 not found error.
-            //
-            if(ustrncmp(pcCode, "404", 3) == 0)
-            {
-                return(-1);
-            }
-        }
+        return;
     }
 
-    //
-    // Reset the pointers.
-    //
-    BufPtrInit(&sBufPtr, psBuf);
-
-    //
-    // Initialize the number of items found.
-    //
-    i32Items = 0;
-
-    if(GetField("list", &sBufPtr) != 0)
+    switch(ui32Index)
     {
-        //
-        // Save the list pointer.
-        //
-        sBufList = sBufPtr;
-
-        //
-        // Get the humidity.
-        //
-        if(GetField("humidity", &sBufPtr) != 0)
-        {
-            psWeatherReport->i32Humidity = GetFieldValueInt(&sBufPtr);
-            i32Items++;
-        }
-        else
+        case FORECAST_COD:
         {
-            psWeatherReport->i32Humidity = INVALID_INT;
+            CheckCode(ui32Type, pcValue);
+            return;
         }
-
-        //
-        // Reset the pointer to the start of the list values.
-        //
-        sBufPtr = sBufList;
-
-        //
-        // Get the average daily pressure.
-        //
-        if(GetField("pressure", &sBufPtr) != 0)
+        case FORECAST_HUMIDITY:
         {
-            psWeatherReport->i32Pressure = GetFieldValueInt(&sBufPtr);
-            i32Items++;
+            psWeatherReport->i32Humidity = ValueInt(ui32Type, pcValue);
+            break;
         }
-        else
+        case FORECAST_PRESSURE:
         {
-            psWeatherReport->i32Pressure = INVALID_INT;
+            psWeatherReport->i32Pressure = ValueInt(ui32Type, pcValue);
+            break;
         }
-
-        //
-        // Reset the pointer to the start of the list values.
-        //
-        sBufPtr = sBufList;
-
-        //
-        // Get the average daily temperature.
-        //
-        if(GetField("temp", &sBufPtr) != 0)
+        case FORECAST_TEMP:
         {
-            if(GetField("day", &sBufPtr) != 0)
-            {
-                psWeatherReport->i32Temp = GetFieldValueInt(&sBufPtr);
-                i32Items++;
-            }
-            else
-            {
-                psWeatherReport->i32Temp = INVALID_INT;
-            }
+            psWeatherReport->i32Temp = ValueInt(ui32Type, pcValue);
+            break;
         }
-
-        //
-        // Reset the pointer to the start of the list values.
-        //
-        sBufPtr = sBufList;
-
-        //
-        // Get the low temperature.
-        //
-        if(GetField("temp", &sBufPtr) != 0)
+        case FORECAST_TEMP_LOW:
         {
-            if(GetField("min", &sBufPtr) != 0)
-            {
-                psWeatherReport->i32TempLow = GetFieldValueInt(&sBufPtr);
-                i32Items++;
-            }
-            else
-            {
-                psWeatherReport->i32TempLow = INVALID_INT;
-            }
+            psWeatherReport->i32TempLow = ValueInt(ui32Type, pcValue);
+            break;
         }
-
-        //
-        // Reset the pointer to the start of the list values.
-        //
-        sBufPtr = sBufList;
-
-        //
-        // Get the high temperature.
-        //
-        if(GetField("temp", &sBufPtr) != 0)
+        case FORECAST_TEMP_HIGH:
         {
-            if(GetField("max", &sBufPtr) != 0)
-            {
-                psWeatherReport->i32TempHigh = GetFieldValueInt(&sBufPtr);
-                i32Items++;
-            }
-            else
-            {
-                psWeatherReport->i32TempHigh = INVALID_INT;
-            }
+            psWeatherReport->i32TempHigh = ValueInt(ui32Type, pcValue);
+            break;
         }
-        //
-        // Reset the pointer to the start of the list values.
-        //
-        sBufPtr = sBufList;
-
-        if(GetField("dt", &sBufPtr) != 0)
+        case FORECAST_TIME:
         {
-            psWeatherReport->ui32Time = GetFieldValueInt(&sBufPtr);
-            i32Items++;
+            psWeatherReport->ui32Time = ValueInt(ui32Type, pcValue);
+            break;
         }
-        else
+        default:
         {
-            psWeatherReport->ui32Time = 0;
+            return;
         }
     }
 
-    return(i32Items);
+    g_sJSONResponse.i32Items++;
 }
 
 //*****************************************************************************
 //
-// Fill out the psWeatherReport structure from data returned from the JSON
-// query.
+// The paths of the values used from the current weather response.
 //
 //*****************************************************************************
-int32_t
-JSONParseCurrent(uint32_t ui32Index, tWeatherReport *psWeatherReport,
-                 struct pbuf *psBuf)
+static const tJSONPathHandler g_psCurrentHandlers[] =
 {
-    tBufPtr sBufPtr, sBufMain, sBufTemp;
-    char pcIcon[3];
-    char pcCode[4];
-    int32_t i32Items, i32Code;
-
-    //
-    // Reset the pointers.
-    //
-    BufPtrInit(&sBufPtr, psBuf);
-
-    //
-    // Check and see if the request was valid.
-    //
-    if(GetField("cod", &sBufPtr) != 0)
-    {
-        sBufTemp = sBufPtr;
-
-        //
-        // Check for a 404 not found error.
-        //
-        i32Code = GetFieldValueInt(&sBufTemp);
+    { "cod", CurrentValue },
+    { "weather.icon", CurrentValue },
+    { "sys.sunrise", CurrentValue },
+    { "sys.sunset", CurrentValue },
+    { "dt", CurrentValue },
+    { "main.humidity", CurrentValue },
+    { "main.temp", CurrentValue },
+    { "main.pressure", CurrentValue },
+};
 
-        sBufTemp = sBufPtr;
-
-        if(i32Code != INVALID_INT)
-        {
-            if(i32Code == 404)
-            {
-                return(-1);
-            }
-        }
-        else if(GetFieldValueString(&sBufTemp, pcCode, sizeof(pcCode)) >= 0)
-        {
-            //
-            // Check for a 404 not found error.
-            //
-            if(ustrncmp(pcCode, "404", 3) == 0)
-            {
-                return(-1);
-            }
-        }
-    }
+//*****************************************************************************
+//
+// The paths of the values used from the forecast response.  The list array
+// holds one entry per day.
+//
+//*****************************************************************************
+static const tJSONPathHandler g_psForecastHandlers[] =
+{
+    { "cod", ForecastValue },
+    { "list.humidity", ForecastValue },
+    { "list.pressure", ForecastValue },
+    { "list.temp.day", ForecastValue },
+    { "list.temp.min", ForecastValue },
+    { "list.temp.max", ForecastValue },
+    { "list.dt", ForecastValue },
+};
 
-    //
-    // Initialize the number of items that have been found.
-    //
-    i32Items = 0;
+//*****************************************************************************
+//
+// Pass the next piece of a response to the parser and return the result in
+// the form expected by the weather client.
+//
+//*****************************************************************************
+static int32_t
+JSONParseResponse(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    int32_t i32Status;
 
-    //
-    // Reset the pointers.
-    //
-    BufPtrInit(&sBufPtr, psBuf);
+    i32Status = JSONParserData(&g_sJSONResponse.sParser, pui8Data, ui32Size);
 
     //
-    // Find the basic weather description(weather.description).
+    // Check for a 404 not found error or a malformed response.
     //
-    if(GetField("weather", &sBufPtr) != 0)
+    if(g_sJSONResponse.bNotFound || (i32Status == JSON_PARSE_ERROR))
     {
-        if(GetField("icon", &sBufPtr) != 0)
-        {
-            if(GetFieldValueString(&sBufPtr, pcIcon, sizeof(pcIcon)) > 0)
-            {
-                //
-                // Save the image pointer.
-                //
-                GetImage(pcIcon, &psWeatherReport->pui8Image,
-                         &psWeatherReport->pcDescription);
-
-                i32Items++;
-            }
-            else
-            {
-                //
-                // No image was found.
-                //
-                psWeatherReport->pui8Image = 0;
-            }
-        }
+        return(-1);
     }
 
     //
-    // Reset the pointers.
-    //
-    BufPtrInit(&sBufPtr, psBuf);
-
-    //
-    // Find the humidity value(main.humidity).
+    // Wait until the whole response has been parsed before reporting the
+    // number of items found.
     //
-    if(GetField("sys", &sBufPtr) != 0)
+    if(i32Status == JSON_PARSE_MORE)
     {
-        //
-        // Save the pointer to the data.
-        //
-        sBufMain = sBufPtr;
-
-        //
-        // Get the sunrise time.
-        //
-        if(GetField("sunrise", &sBufPtr) != 0)
-        {
-            psWeatherReport->ui32SunRise = GetFieldValueInt(&sBufPtr);
-
-            i32Items++;
-        }
-        else
-        {
-            psWeatherReport->ui32SunRise = 0;
-        }
-
-        //
-        // Restore the pointer to the data.
-        //
-        sBufPtr = sBufMain;
-
-        //
-        // Get the sunset time.
-        //
-        if(GetField("sunset", &sBufPtr) != 0)
-        {
-            psWeatherReport->ui32SunSet = GetFieldValueInt(&sBufPtr);
-
-            i32Items++;
-        }
-        else
-        {
-            psWeatherReport->ui32SunSet = 0;
-        }
+        return(0);
     }
 
-    //
-    // Reset the pointers.
-    //
-    BufPtrInit(&sBufPtr, psBuf);
+    return(g_sJSONResponse.i32Items);
+}
 
-    //
-    // Get the last update time.
-    //
-    if(GetField("dt", &sBufPtr) != 0)
-    {
-        psWeatherReport->ui32Time = GetFieldValueInt(&sBufPtr);
+//*****************************************************************************
+//
+// Start parsing a new response.
+//
+//*****************************************************************************
+static void
+JSONResponseInit(tWeatherReport *psWeatherReport,
+                 const tJSONPathHandler *psHandlers, uint32_t ui32NumHandlers)
+{
+    JSONParserInit(&g_sJSONResponse.sParser, psHandlers, ui32NumHandlers,
+                   psWeatherReport);
+    g_sJSONResponse.ui32Found = 0;
+    g_sJSONResponse.i32Items = 0;
+    g_sJSONResponse.bNotFound = false;
+}
 
-        i32Items++;
-    }
-    else
+//*****************************************************************************
+//
+// Fill out the psWeatherReport structure from data returned from the JSON
+// query.  ui32Index is the offset of the data in the response body, with 0
+// indicating the start of a new response.  Returns the number of items found
+// once the response is complete, 0 if more of the response is needed, or -1
+// if the request was not valid.
+//
+//*****************************************************************************
+int32_t
+JSONParseForecast(uint32_t ui32Index, tWeatherReport *psWeatherReport,
+                  const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    if(ui32Index == 0)
     {
+        JSONResponseInit(psWeatherReport, g_psForecastHandlers,
+                         sizeof(g_psForecastHandlers) /
+                         sizeof(g_psForecastHandlers[0]));
+
+        psWeatherReport->i32Humidity = INVALID_INT;
+        psWeatherReport->i32Pressure = INVALID_INT;
+        psWeatherReport->i32Temp = INVALID_INT;
+        psWeatherReport->i32TempLow = INVALID_INT;
+        psWeatherReport->i32TempHigh = INVALID_INT;
         psWeatherReport->ui32Time = 0;
     }
 
-    //
-    // Reset the pointers.
-    //
-    BufPtrInit(&sBufPtr, psBuf);
+    return(JSONParseResponse(pui8Data, ui32Size));
+}
 
-    //
-    // Find the humidity value(main.humidity).
-    //
-    if(GetField("main", &sBufPtr) != 0)
+//*****************************************************************************
+//
+// Fill out the psWeatherReport structure from data returned from the JSON
+// query.  ui32Index is the offset of the data in the response body, with 0
+// indicating the start of a new response.  Returns the number of items found
+// once the response is complete, 0 if more of the response is needed, or -1
+// if the request was not valid.
+//
+//*****************************************************************************
+int32_t
+JSONParseCurrent(uint32_t ui32Index, tWeatherReport *psWeatherReport,
+                 const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    if(ui32Index == 0)
     {
-        //
-        // Save the pointer to the main data.
-        //
-        sBufMain = sBufPtr;
-
-        if(GetField("humidity", &sBufPtr) != 0)
-        {
-            psWeatherReport->i32Humidity = GetFieldValueInt(&sBufPtr);
-            i32Items++;
-        }
-        else
-        {
-            psWeatherReport->i32Humidity = INVALID_INT;
-        }
-
-        //
-        // Reset the buffer pointer to main.
-        //
-        sBufPtr = sBufMain;
-
-        //
-        // Find the current temperature value.
-        //
-        if(GetField("temp", &sBufPtr) != 0)
-        {
-            psWeatherReport->i32Temp = GetFieldValueInt(&sBufPtr);
-            i32Items++;
-        }
-        else
-        {
-            psWeatherReport->i32Temp = INVALID_INT;
-        }
+        JSONResponseInit(psWeatherReport, g_psCurrentHandlers,
+                         sizeof(g_psCurrentHandlers) /
+                         sizeof(g_psCurrentHandlers[0]));
 
-        //
-        // Reset the buffer pointer to main.
-        //
-        sBufPtr = sBufMain;
-
-        //
-        // Find the current atmospheric pressure.
-        //
-        if(GetField("pressure", &sBufPtr) != 0)
-        {
-            psWeatherReport->i32Pressure = GetFieldValueInt(&sBufPtr);
-            i32Items++;
-        }
-        else
-        {
-            psWeatherReport->i32Pressure = INVALID_INT;
-        }
+        psWeatherReport->ui32SunRise = 0;
+        psWeatherReport->ui32SunSet = 0;
+        psWeatherReport->ui32Time = 0;
+        psWeatherReport->i32Humidity = INVALID_INT;
+        psWeatherReport->i32Temp = INVALID_INT;
+        psWeatherReport->i32Pressure = INVALID_INT;
     }
-    return(i32Items);
+
+    return(JSONParseResponse(pui8Data, ui32Size));
 }
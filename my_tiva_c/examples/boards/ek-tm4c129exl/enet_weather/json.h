@@ -32,10 +32,10 @@
 
 extern int32_t JSONParseCurrent(uint32_t ui32Index,
                                 tWeatherReport *psWeatherReport,
-                                struct pbuf *psBuf);
+                                const uint8_t *pui8Data, uint32_t ui32Size);
 extern int32_t JSONParseForecast(uint32_t ui32Index,
                                  tWeatherReport *psWeatherReport,
-                                 struct pbuf *psBuf);
+                                 const uint8_t *pui8Data, uint32_t ui32Size);
 #endif
 
 #endif
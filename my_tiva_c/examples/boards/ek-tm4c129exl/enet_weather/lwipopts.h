@@ -61,7 +61,7 @@
 #define PHY_PHYS_ADDR      1
 //#define EEE_SUPPORT        1
 #endif
-#define NUM_TX_DESCRIPTORS 8
+#define NUM_TX_DESCRIPTORS 24
 #define NUM_RX_DESCRIPTORS 8
 
 //*****************************************************************************
@@ -380,12 +380,13 @@
 // ---------- checksum options ----------
 //
 //*****************************************************************************
-//#define CHECKSUM_GEN_IP                 1
-//#define CHECKSUM_GEN_UDP                1
-//#define CHECKSUM_GEN_TCP                1
-//#define CHECKSUM_CHECK_IP               1
-//#define CHECKSUM_CHECK_UDP              1
-//#define CHECKSUM_CHECK_TCP              1
+#define CHECKSUM_GEN_IP                 0           // default is 1
+#define CHECKSUM_GEN_ICMP               0           // default is 1
+#define CHECKSUM_GEN_UDP                0           // default is 1
+#define CHECKSUM_GEN_TCP                0           // default is 1
+#define CHECKSUM_CHECK_IP               0           // default is 1
+#define CHECKSUM_CHECK_UDP              0           // default is 1
+#define CHECKSUM_CHECK_TCP              0           // default is 1
 
 //*****************************************************************************
 //
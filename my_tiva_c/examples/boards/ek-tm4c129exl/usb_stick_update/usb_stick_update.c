@@ -219,6 +219,16 @@ uint8_t g_pHCDPool[HCD_MEMORY_SIZE];
 //*****************************************************************************
 static uint8_t g_ui8SectorBuf[512];
 
+//*****************************************************************************
+//
+// The block cache used by the MSC driver to read ahead while the firmware
+// image is read sequentially from the storage device.  This is word aligned
+// so that the driver can fill it using uDMA.
+//
+//*****************************************************************************
+#define MSC_CACHE_SIZE          4096
+static uint32_t g_pui32MSCCache[MSC_CACHE_SIZE / 4];
+
 //*****************************************************************************
 //
 // Global to hold the clock rate. Set once read many.
@@ -668,6 +678,13 @@ ConfigureUSBInterface(void)
     //
     g_psMSCInstance = USBHMSCDriveOpen(0, MSCCallback);
 
+    //
+    // Give the driver a cache so that the image is read several sectors at a
+    // time.
+    //
+    USBHMSCCacheConfig(g_psMSCInstance, (uint8_t *)g_pui32MSCCache,
+                       MSC_CACHE_SIZE);
+
     //
     // Initialize the power configuration. This sets the power enable signal
     // to be active high and does not enable the power fault.
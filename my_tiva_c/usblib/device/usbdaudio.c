@@ -66,6 +66,7 @@
 //
 //*****************************************************************************
 #define ISOC_OUT_ENDPOINT       USB_EP_1
+#define FEEDBACK_IN_ENDPOINT    USB_EP_1
 
 //*****************************************************************************
 //
@@ -74,6 +75,16 @@
 //*****************************************************************************
 #define ISOC_OUT_EP_MAX_SIZE    ((48000*4)/1000)
 
+//*****************************************************************************
+//
+// Offsets of the fields in the audio streaming interface descriptors that are
+// patched at run time to match the sample format selected by the client.
+//
+//*****************************************************************************
+#define STREAM_FORMAT_OFFSET    25
+#define STREAM_DATA_EP_OFFSET   36
+#define STREAM_FEEDBACK_OFFSET  52
+
 //*****************************************************************************
 //
 // Device Descriptor.  This is stored in RAM to allow several fields to be
@@ -254,8 +265,11 @@ const uint8_t g_pui8AudioControlInterface[CONTROLINTERFACE_SIZE] =
 // by host operating systems to put the device in idle mode, while the second
 // is used when the audio device is active.
 //
+// Note that this structure is located in RAM since the sample format and
+// maximum packet size are patched in based on client requirements.
+//
 //*****************************************************************************
-const uint8_t g_pui8AudioStreamInterface[STREAMINTERFACE_SIZE] =
+uint8_t g_pui8AudioStreamInterface[STREAMINTERFACE_SIZE] =
 {
     //
     // Vendor-specific Interface Descriptor.
@@ -337,6 +351,114 @@ const uint8_t g_pui8AudioStreamInterface[STREAMINTERFACE_SIZE] =
     USBShort(0),                    // No lock delay.
 };
 
+//*****************************************************************************
+//
+// The audio streaming interface descriptor used when USBD_AUDIO_FLAG_ASYNC
+// is set.  This matches g_pui8AudioStreamInterface except that the active
+// interface has an asynchronous isochronous OUT endpoint along with the
+// isochronous IN endpoint used to feed the codec sample rate back to the
+// host.
+//
+//*****************************************************************************
+uint8_t g_pui8AudioStreamInterfaceAsync[STREAMINTERFACE_ASYNC_SIZE] =
+{
+    //
+    // Vendor-specific Interface Descriptor.
+    //
+    9,                          // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE,        // Type of this descriptor.
+    AUDIO_INTERFACE_OUTPUT,     // The index for this interface.
+    0,                          // The alternate setting for this interface.
+    0,                          // The number of endpoints used by this
+                                // interface.
+    USB_CLASS_AUDIO,            // The interface class
+    USB_ASC_AUDIO_STREAMING,    // The interface sub-class.
+    0,                          // Unused must be 0.
+    0,                          // The string index for this interface.
+
+    //
+    // Vendor-specific Interface Descriptor.
+    //
+    9,                          // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE,        // Type of this descriptor.
+    1,                          // The index for this interface.
+    1,                          // The alternate setting for this interface.
+    2,                          // The number of endpoints used by this
+                                // interface.
+    USB_CLASS_AUDIO,            // The interface class
+    USB_ASC_AUDIO_STREAMING,    // The interface sub-class.
+    0,                          // Unused must be 0.
+    0,                          // The string index for this interface.
+
+    //
+    // Class specific Audio Streaming Interface descriptor.
+    //
+    7,                          // Size of the interface descriptor.
+    USB_DTYPE_CS_INTERFACE,     // Interface descriptor is class specific.
+    USB_ASDSTYPE_GENERAL,       // General information.
+    AUDIO_IN_TERMINAL_ID,       // ID of the terminal to which this streaming
+                                // interface is connected.
+    1,                          // One frame delay.
+    USBShort(USB_ADF_PCM),      //
+
+    //
+    // Format type Audio Streaming descriptor.
+    //
+    11,                         // Size of the interface descriptor.
+    USB_DTYPE_CS_INTERFACE,     // Interface descriptor is class specific.
+    USB_ASDSTYPE_FORMAT_TYPE,   // Audio Streaming format type.
+    USB_AF_TYPE_TYPE_I,         // Type I audio format type.
+    2,                          // Two audio channels.
+    2,                          // Two bytes per audio sub-frame.
+    16,                         // 16 bits per sample.
+    1,                          // One sample rate provided.
+    USB3Byte(48000),            // Only 48000 sample rate supported.
+
+    //
+    // Endpoint Descriptor
+    //
+    9,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+                                    // OUT endpoint with address
+                                    // ISOC_OUT_ENDPOINT.
+    USB_EP_DESC_OUT | USBEPToIndex(ISOC_OUT_ENDPOINT),
+    USB_EP_ATTR_ISOC |              // Endpoint is an asynchronous isochronous
+    USB_EP_ATTR_ISOC_ASYNC |        //  data endpoint.
+    USB_EP_ATTR_USAGE_DATA,
+    USBShort(ISOC_OUT_EP_MAX_SIZE), // The maximum packet size.
+    1,                              // The polling interval for this endpoint.
+    0,                              // Refresh is unused.
+                                    // Synch endpoint address.
+    USB_EP_DESC_IN | USBEPToIndex(FEEDBACK_IN_ENDPOINT),
+
+    //
+    // Audio Streaming Isochronous Audio Data Endpoint Descriptor
+    //
+    7,                              // The size of the descriptor.
+    USB_ACSDT_ENDPOINT,             // Audio Class Specific Endpoint
+                                    // Descriptor.
+    USB_ASDSTYPE_GENERAL,           // This is a general descriptor.
+    USB_EP_ATTR_ACG_SAMPLING,       // Sampling frequency is supported.
+    USB_EP_LOCKDELAY_UNDEF,         // Undefined lock delay units.
+    USBShort(0),                    // No lock delay.
+
+    //
+    // Feedback Endpoint Descriptor
+    //
+    9,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+                                    // IN endpoint with address
+                                    // FEEDBACK_IN_ENDPOINT.
+    USB_EP_DESC_IN | USBEPToIndex(FEEDBACK_IN_ENDPOINT),
+    USB_EP_ATTR_ISOC |              // Endpoint is an isochronous feedback
+    USB_EP_ATTR_ISOC_NOSYNC |       //  endpoint.
+    USB_EP_ATTR_USAGE_FEEDBACK,
+    USBShort(3),                    // The maximum packet size.
+    1,                              // The polling interval for this endpoint.
+    USBD_AUDIO_FEEDBACK_REFRESH,    // The feedback refresh interval.
+    0,                              // Synch endpoint address.
+};
+
 //*****************************************************************************
 //
 // The audio device configuration descriptor is defined as three sections,
@@ -357,6 +479,12 @@ const tConfigSection g_sAudioStreamInterfaceSection =
     g_pui8AudioStreamInterface
 };
 
+const tConfigSection g_sAudioStreamInterfaceAsyncSection =
+{
+    sizeof(g_pui8AudioStreamInterfaceAsync),
+    g_pui8AudioStreamInterfaceAsync
+};
+
 const tConfigSection g_sAudioControlInterfaceSection =
 {
     sizeof(g_pui8AudioControlInterface),
@@ -377,6 +505,14 @@ const tConfigSection *g_psAudioSections[] =
     &g_sAudioStreamInterfaceSection
 };
 
+const tConfigSection *g_psAudioAsyncSections[] =
+{
+    &g_sAudioConfigSection,
+    &g_sIADAudioConfigSection,
+    &g_sAudioControlInterfaceSection,
+    &g_sAudioStreamInterfaceAsyncSection
+};
+
 #define NUM_AUDIO_SECTIONS      (sizeof(g_psAudioSections) /                  \
                                  sizeof(g_psAudioSections[0]))
 
@@ -393,6 +529,12 @@ const tConfigHeader g_sAudioConfigHeader =
     g_psAudioSections
 };
 
+const tConfigHeader g_sAudioAsyncConfigHeader =
+{
+    NUM_AUDIO_SECTIONS,
+    g_psAudioAsyncSections
+};
+
 //*****************************************************************************
 //
 // Configuration Descriptor.
@@ -403,6 +545,11 @@ const tConfigHeader * const g_ppAudioConfigDescriptors[] =
     &g_sAudioConfigHeader
 };
 
+const tConfigHeader * const g_ppAudioAsyncConfigDescriptors[] =
+{
+    &g_sAudioAsyncConfigHeader
+};
+
 //*****************************************************************************
 //
 // Various internal handlers needed by this class.
@@ -543,6 +690,190 @@ DataReceived(void *pvAudioDevice, uint32_t ui32Info)
     }
 }
 
+//*****************************************************************************
+//
+// Returns the number of bytes of audio data waiting to be read from the ring.
+//
+//*****************************************************************************
+static uint32_t
+RingUsed(tAudioInstance *psInst)
+{
+    uint32_t ui32Write, ui32Read;
+
+    ui32Write = psInst->sRing.ui32Write;
+    ui32Read = psInst->sRing.ui32Read;
+
+    if(ui32Write >= ui32Read)
+    {
+        return(ui32Write - ui32Read);
+    }
+
+    return(psInst->sRing.ui32Size - ui32Read + ui32Write);
+}
+
+//*****************************************************************************
+//
+// This function is called once a packet has been written to the ring at the
+// current write offset.  It moves the write offset on and reports each period
+// of data received to the client.
+//
+//*****************************************************************************
+static void
+RingWritten(tAudioInstance *psInst, uint32_t ui32Size)
+{
+    uint32_t ui32Write, ui32Idx;
+
+    ui32Write = psInst->sRing.ui32Write + ui32Size;
+
+    //
+    // A packet which crossed the end of the ring was written contiguously
+    // into the space past the end so copy that part back to the start.
+    //
+    if(ui32Write >= psInst->sRing.ui32Size)
+    {
+        ui32Write -= psInst->sRing.ui32Size;
+
+        for(ui32Idx = 0; ui32Idx < ui32Write; ui32Idx++)
+        {
+            psInst->sRing.pui8Data[ui32Idx] =
+                    psInst->sRing.pui8Data[psInst->sRing.ui32Size + ui32Idx];
+        }
+    }
+
+    psInst->sRing.ui32Write = ui32Write;
+
+    //
+    // Tell the client about each period of data received.
+    //
+    psInst->sRing.ui32PeriodFill += ui32Size;
+
+    while(psInst->sRing.ui32PeriodFill >= psInst->sRing.ui32Period)
+    {
+        psInst->sRing.ui32PeriodFill -= psInst->sRing.ui32Period;
+
+        if(psInst->sRing.pfnCallback)
+        {
+            psInst->sRing.pfnCallback(psInst->sRing.pui8Data,
+                                      RingUsed(psInst),
+                                      USBD_AUDIO_EVENT_PERIOD);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// This function is called when a packet has been received on the isochronous
+// OUT endpoint while a ring provided by USBAudioRingOut() is in use.
+//
+//*****************************************************************************
+static void
+RingReceive(tAudioInstance *psInst, uint32_t ui32Size)
+{
+    uint8_t *pui8Data;
+
+    //
+    // Drop the packet if there is no room for it in the ring.  One byte is
+    // always left free so that a full ring can be told from an empty one.
+    //
+    if(ui32Size >= (psInst->sRing.ui32Size - RingUsed(psInst)))
+    {
+        psInst->sRing.ui32Overruns++;
+        MAP_USBDevEndpointDataAck(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                                  false);
+        return;
+    }
+
+    pui8Data = psInst->sRing.pui8Data + psInst->sRing.ui32Write;
+
+    //
+    // Use uDMA to read the packet if the channel will accept it, otherwise
+    // read the packet directly.  uDMA is not used for short packets or when
+    // the write offset is not word aligned.  The packet is already in the
+    // FIFO, so the endpoint's DMA and the channel are enabled here.
+    //
+    if(USBLibDMATransfer(psInst->psDMAInstance, psInst->ui8OUTDMA, pui8Data,
+                         ui32Size) != 0)
+    {
+        psInst->sRing.ui32DMASize = ui32Size;
+
+        MAP_USBEndpointDMAEnable(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                                 USB_EP_DEV_OUT);
+        USBLibDMAChannelEnable(psInst->psDMAInstance, psInst->ui8OUTDMA);
+    }
+    else
+    {
+        MAP_USBEndpointDataGet(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                               pui8Data, &ui32Size);
+        MAP_USBDevEndpointDataAck(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                                  false);
+        RingWritten(psInst, ui32Size);
+    }
+}
+
+//*****************************************************************************
+//
+// Loads the current feedback value into the feedback endpoint FIFO unless
+// the previous value is still waiting to be sent.
+//
+//*****************************************************************************
+static void
+FeedbackSend(tAudioInstance *psInst)
+{
+    uint8_t pui8Value[3];
+
+    if(MAP_USBEndpointStatus(psInst->ui32USBBase,
+                             psInst->ui8FeedbackEndpoint) &
+       USB_DEV_TX_TXPKTRDY)
+    {
+        return;
+    }
+
+    //
+    // The value is sent as a 10.14 number of samples per frame in three
+    // bytes, least significant byte first.
+    //
+    pui8Value[0] = (uint8_t)psInst->sFeedback.ui32Value;
+    pui8Value[1] = (uint8_t)(psInst->sFeedback.ui32Value >> 8);
+    pui8Value[2] = (uint8_t)(psInst->sFeedback.ui32Value >> 16);
+
+    MAP_USBEndpointDataPut(psInst->ui32USBBase, psInst->ui8FeedbackEndpoint,
+                           pui8Value, 3);
+    MAP_USBEndpointDataSend(psInst->ui32USBBase, psInst->ui8FeedbackEndpoint,
+                            USB_TRANS_IN);
+}
+
+//*****************************************************************************
+//
+// Patches the sample format and maximum packet size into an audio streaming
+// interface descriptor.
+//
+//*****************************************************************************
+static void
+StreamDescriptorPatch(uint8_t *pui8Desc, uint32_t ui32SampleRate,
+                      uint32_t ui32SampleBits, uint32_t ui32MaxPacketSize)
+{
+    uint8_t *pui8Format, *pui8Endpoint;
+
+    pui8Format = pui8Desc + STREAM_FORMAT_OFFSET;
+    pui8Endpoint = pui8Desc + STREAM_DATA_EP_OFFSET;
+
+    //
+    // Fill in the sub-frame size, bit resolution and the single sample rate
+    // in the format type descriptor.
+    //
+    pui8Format[5] = (uint8_t)(ui32SampleBits / 8);
+    pui8Format[6] = (uint8_t)ui32SampleBits;
+    pui8Format[8] = (uint8_t)ui32SampleRate;
+    pui8Format[9] = (uint8_t)(ui32SampleRate >> 8);
+    pui8Format[10] = (uint8_t)(ui32SampleRate >> 16);
+
+    //
+    // Fill in the maximum packet size of the data endpoint.
+    //
+    pui8Endpoint[4] = (uint8_t)ui32MaxPacketSize;
+    pui8Endpoint[5] = (uint8_t)(ui32MaxPacketSize >> 8);
+}
+
 //*****************************************************************************
 //
 // This function is called to handle the interrupts on the isochronous endpoint
@@ -569,6 +900,20 @@ HandleEndpoints(void *pvAudioDevice, uint32_t ui32Status)
     //
     psInst = &psAudioDevice->sPrivateData;
 
+    //
+    // If the last feedback value has been sent, queue the current one.
+    //
+    if((psInst->ui8Flags & USBD_AUDIO_FLAG_ASYNC) &&
+       (ui32Status & (1 << USBEPToIndex(psInst->ui8FeedbackEndpoint))))
+    {
+        ui32EPStatus = MAP_USBEndpointStatus(psInst->ui32USBBase,
+                                             psInst->ui8FeedbackEndpoint);
+        MAP_USBDevEndpointStatusClear(psInst->ui32USBBase,
+                                      psInst->ui8FeedbackEndpoint,
+                                      ui32EPStatus);
+        FeedbackSend(psInst);
+    }
+
     //
     // Read out the current endpoint status.
     //
@@ -591,12 +936,41 @@ HandleEndpoints(void *pvAudioDevice, uint32_t ui32Status)
         MAP_USBDevEndpointStatusClear(USB0_BASE, psInst->ui8OUTEndpoint,
                                       ui32EPStatus);
 
+        //
+        // Read the packet into the ring if one is in use.
+        //
+        if(psInst->sRing.pui8Data)
+        {
+            RingReceive(psInst, ui32Size);
+            return;
+        }
+
         //
         // Configure the next DMA transfer.
         //
         USBLibDMATransfer(psInst->psDMAInstance, psInst->ui8OUTDMA,
                           psInst->sBuffer.pvData, ui32Size);
     }
+    else if(psInst->sRing.pui8Data)
+    {
+        //
+        // If a uDMA transfer into the ring has completed then the packet
+        // has been written.
+        //
+        if(psInst->sRing.ui32DMASize &&
+           (USBLibDMAChannelStatus(psInst->psDMAInstance,
+                                   psInst->ui8OUTDMA) ==
+            USBLIBSTATUS_DMA_COMPLETE))
+        {
+            USBEndpointDMADisable(USB0_BASE,
+                                  psInst->ui8OUTEndpoint, USB_EP_DEV_OUT);
+            MAP_USBDevEndpointDataAck(USB0_BASE, psInst->ui8OUTEndpoint, 0);
+
+            ui32Size = psInst->sRing.ui32DMASize;
+            psInst->sRing.ui32DMASize = 0;
+            RingWritten(psInst, ui32Size);
+        }
+    }
     else if((USBLibDMAChannelStatus(psInst->psDMAInstance,
                                     psInst->ui8OUTDMA) ==
             USBLIBSTATUS_DMA_COMPLETE))
@@ -676,7 +1050,15 @@ HandleDevice(void *pvAudioDevice, uint32_t ui32Request, void *pvRequestData)
             //
             // Determine if this is an IN or OUT endpoint that has changed.
             //
-            if((pui8Data[0] & USB_EP_DESC_IN) == 0)
+            if(pui8Data[0] & USB_EP_DESC_IN)
+            {
+                //
+                // The only IN endpoint is the feedback endpoint.
+                //
+                psInst->ui8FeedbackEndpoint =
+                                            IndexToUSBEP(pui8Data[1] & 0x7f);
+            }
+            else
             {
                 //
                 // Extract the new endpoint number without the DIR bit.
@@ -699,7 +1081,7 @@ HandleDevice(void *pvAudioDevice, uint32_t ui32Request, void *pvRequestData)
                 psInst->ui8OUTDMA =
                     USBLibDMAChannelAllocate(psInst->psDMAInstance,
                                              psInst->ui8OUTEndpoint,
-                                             ISOC_OUT_EP_MAX_SIZE,
+                                             psInst->ui16MaxPacketSize,
                                              (USB_DMA_EP_RX |
                                               USB_DMA_EP_TYPE_ISOC |
                                               USB_DMA_EP_DEVICE));
@@ -732,6 +1114,17 @@ HandleDevice(void *pvAudioDevice, uint32_t ui32Request, void *pvRequestData)
             //
             pui8Data[2] = psInst->ui8InterfaceControl;
 
+            //
+            // The data endpoint refers to the feedback endpoint, whose
+            // number may have been changed by the composite class.
+            //
+            if(psInst->ui8Flags & USBD_AUDIO_FLAG_ASYNC)
+            {
+                pui8Data[AUDIODESCRIPTOR_SIZE + CONTROLINTERFACE_SIZE +
+                         STREAM_DATA_EP_OFFSET + 8] =
+                    USB_EP_DESC_IN | USBEPToIndex(psInst->ui8FeedbackEndpoint);
+            }
+
             break;
         }
         case USB_EVENT_LPM_RESUME:
@@ -814,14 +1207,39 @@ static void
 InterfaceChange(void *pvAudioDevice, uint8_t ui8Interface,
                 uint8_t ui8AlternateSetting)
 {
-    const tUSBDAudioDevice *psAudioDevice;
+    tUSBDAudioDevice *psAudioDevice;
+    tAudioInstance *psInst;
 
     ASSERT(pvAudioDevice != 0);
 
     //
     // The audio device structure pointer.
     //
-    psAudioDevice = (const tUSBDAudioDevice *)pvAudioDevice;
+    psAudioDevice = (tUSBDAudioDevice *)pvAudioDevice;
+    psInst = &psAudioDevice->sPrivateData;
+
+    //
+    // When the streaming interface becomes active, restart the ring and the
+    // feedback measurement and queue the nominal feedback value.
+    //
+    if((ui8AlternateSetting != 0) &&
+       (ui8Interface == psInst->ui8InterfaceAudio))
+    {
+        psInst->sRing.ui32Write = 0;
+        psInst->sRing.ui32Read = 0;
+        psInst->sRing.ui32PeriodFill = 0;
+        psInst->sRing.ui32DMASize = 0;
+
+        if(psInst->ui8Flags & USBD_AUDIO_FLAG_ASYNC)
+        {
+            psInst->sFeedback.ui32Value = psInst->sFeedback.ui32Nominal;
+            psInst->sFeedback.ui32Samples = 0;
+            psInst->sFeedback.ui32Frames = 0;
+            psInst->sFeedback.ui32LastFrame =
+                                MAP_USBFrameNumberGet(psInst->ui32USBBase);
+            FeedbackSend(psInst);
+        }
+    }
 
     //
     // Check which interface to change into.
@@ -950,7 +1368,7 @@ USBDAudioInit(uint32_t ui32Index, tUSBDAudioDevice *psAudioDevice)
     psAudioDevice->sPrivateData.ui8OUTDMA =
         USBLibDMAChannelAllocate(psAudioDevice->sPrivateData.psDMAInstance,
                                  psAudioDevice->sPrivateData.ui8OUTEndpoint,
-                                 ISOC_OUT_EP_MAX_SIZE,
+                                 psAudioDevice->sPrivateData.ui16MaxPacketSize,
                                  USB_DMA_EP_RX | USB_DMA_EP_TYPE_ISOC |
                                  USB_DMA_EP_DEVICE);
 
@@ -1001,6 +1419,8 @@ USBDAudioCompositeInit(uint32_t ui32Index, tUSBDAudioDevice *psAudioDevice,
                        tCompositeEntry *psCompEntry)
 {
     tAudioInstance *psInst;
+    uint32_t ui32SampleRate, ui32SampleBits;
+    uint8_t *pui8StreamDesc;
 
     //
     // Check parameter validity.
@@ -1008,6 +1428,10 @@ USBDAudioCompositeInit(uint32_t ui32Index, tUSBDAudioDevice *psAudioDevice,
     ASSERT(ui32Index == 0);
     ASSERT(psAudioDevice);
     ASSERT(psAudioDevice->ppui8StringDescriptors);
+    ASSERT(psAudioDevice->ui32SampleRate <= 96000);
+    ASSERT((psAudioDevice->ui8SampleBits == 0) ||
+           (psAudioDevice->ui8SampleBits == 16) ||
+           (psAudioDevice->ui8SampleBits == 24));
 
     //
     // Initialize the workspace in the passed instance structure.
@@ -1015,6 +1439,50 @@ USBDAudioCompositeInit(uint32_t ui32Index, tUSBDAudioDevice *psAudioDevice,
     psInst = &psAudioDevice->sPrivateData;
     psInst->ui32USBBase = USB0_BASE;
 
+    //
+    // Determine the sample format, defaulting to 48kHz 16-bit stereo.
+    //
+    ui32SampleRate = psAudioDevice->ui32SampleRate ?
+                     psAudioDevice->ui32SampleRate : 48000;
+    ui32SampleBits = psAudioDevice->ui8SampleBits ?
+                     psAudioDevice->ui8SampleBits : 16;
+
+    psInst->ui8Flags = psAudioDevice->ui8Flags;
+    psInst->ui32SampleRate = ui32SampleRate;
+    psInst->ui8FrameSize = (uint8_t)((ui32SampleBits / 8) * 2);
+
+    //
+    // The maximum packet size must hold one frame's worth of samples,
+    // rounded up.  In asynchronous mode the host may send one extra sample
+    // per frame when following the feedback value.
+    //
+    psInst->ui16MaxPacketSize =
+        (uint16_t)((((ui32SampleRate + 999) / 1000) +
+                    ((psInst->ui8Flags & USBD_AUDIO_FLAG_ASYNC) ? 1 : 0)) *
+                   psInst->ui8FrameSize);
+
+    //
+    // The nominal feedback value is the number of samples per frame in 10.14
+    // format.
+    //
+    psInst->sFeedback.ui32Nominal = (ui32SampleRate << 11) / 125;
+    psInst->sFeedback.ui32Value = psInst->sFeedback.ui32Nominal;
+
+    //
+    // Patch the format into the streaming interface descriptor in use.
+    //
+    if(psInst->ui8Flags & USBD_AUDIO_FLAG_ASYNC)
+    {
+        pui8StreamDesc = g_pui8AudioStreamInterfaceAsync;
+    }
+    else
+    {
+        pui8StreamDesc = g_pui8AudioStreamInterface;
+    }
+
+    StreamDescriptorPatch(pui8StreamDesc, ui32SampleRate, ui32SampleBits,
+                          psInst->ui16MaxPacketSize);
+
     //
     // Initialize the composite entry that is used by the composite device
     // class.
@@ -1030,7 +1498,11 @@ USBDAudioCompositeInit(uint32_t ui32Index, tUSBDAudioDevice *psAudioDevice,
     //
     psInst->sDevInfo.psCallbacks = &g_sAudioHandlers;
     psInst->sDevInfo.pui8DeviceDescriptor = g_pui8AudioDeviceDescriptor;
-    psInst->sDevInfo.ppsConfigDescriptors = g_ppAudioConfigDescriptors;
+    psInst->sDevInfo.ppsConfigDescriptors =
+                        (psInst->ui8Flags & USBD_AUDIO_FLAG_ASYNC) ?
+                        g_ppAudioAsyncConfigDescriptors :
+                        g_ppAudioConfigDescriptors;
+    psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
     psInst->sDevInfo.ppui8StringDescriptors = 0;
     psInst->sDevInfo.ui32NumStringDescriptors = 0;
 
@@ -1056,9 +1528,15 @@ USBDAudioCompositeInit(uint32_t ui32Index, tUSBDAudioDevice *psAudioDevice,
     psInst->ui8OUTDMA = 0;
 
     //
-    // Set the initial buffer to null.
+    // Set the default feedback IN endpoint.
+    //
+    psInst->ui8FeedbackEndpoint = FEEDBACK_IN_ENDPOINT;
+
+    //
+    // Set the initial buffer and ring to null.
     //
     psInst->sBuffer.pvData = 0;
+    psInst->sRing.pui8Data = 0;
 
     //
     // Save the volume settings.
@@ -1448,8 +1926,9 @@ HandleRequests(void *pvAudioDevice, tUSBRequest *psUSBRequest)
 //!
 //! This function fills the buffer pointed to by the \e pvBuffer parameter with
 //! at most \e ui32Size one packet of data from the host controller.  The
-//! \e ui32Size has a minimum value of \b ISOC_OUT_EP_MAX_SIZE since each USB
-//! packet can be at most \b ISOC_OUT_EP_MAX_SIZE bytes in size.  Since the
+//! \e ui32Size has a minimum value of the maximum packet size of the
+//! isochronous OUT endpoint, which is \b ISOC_OUT_EP_MAX_SIZE for the default
+//! 48kHz 16-bit stereo format.  Since the
 //! audio data may not be received in amounts that evenly fit in the buffer
 //! provided, the buffer may not be completely filled.  The \e pfnCallback
 //! function will provide the amount of valid data that was actually stored in
@@ -1474,10 +1953,6 @@ USBAudioBufferOut(void *pvAudioDevice, void *pvBuffer, uint32_t ui32Size,
     ASSERT(pvAudioDevice != 0);
     ASSERT(pvBuffer != 0);
 
-    //
-    // Buffer must be at least one packet in size.
-    //
-    ASSERT(ui32Size >= ISOC_OUT_EP_MAX_SIZE);
     ASSERT(pfnCallback);
 
     //
@@ -1490,6 +1965,16 @@ USBAudioBufferOut(void *pvAudioDevice, void *pvBuffer, uint32_t ui32Size,
     //
     psInst = &psAudioDevice->sPrivateData;
 
+    //
+    // Buffer must be at least one packet in size.
+    //
+    ASSERT(ui32Size >= psInst->ui16MaxPacketSize);
+
+    //
+    // Stop using any ring provided by USBAudioRingOut().
+    //
+    psInst->sRing.pui8Data = 0;
+
     //
     // Initialize the buffer instance.
     //
@@ -1501,6 +1986,268 @@ USBAudioBufferOut(void *pvAudioDevice, void *pvBuffer, uint32_t ui32Size,
     return(0);
 }
 
+//*****************************************************************************
+//
+//! This function is used to supply a ring buffer to the audio class to be
+//! filled continuously with audio data from the USB host.
+//!
+//! \param pvAudioDevice is the pointer to the device instance structure as
+//! returned by USBDAudioInit() or USBDAudioCompositeInit().
+//! \param pvRing is a pointer to a word aligned buffer to hold the ring.
+//! \param ui32Size is the size in bytes of the buffer pointed to by the
+//! \e pvRing parameter.
+//! \param ui32Period is the number of bytes received between each
+//! \b USBD_AUDIO_EVENT_PERIOD event.
+//! \param pfnCallback is a callback that will be called with
+//! \b USBD_AUDIO_EVENT_PERIOD each time another \e ui32Period bytes have been
+//! written to the ring.
+//!
+//! This function replaces the single buffer supplied by USBAudioBufferOut()
+//! with a ring which every packet received from the host is written to.
+//! Packets are read from the endpoint using uDMA whenever possible so the
+//! CPU only handles the endpoint interrupts.  The last maximum packet size
+//! bytes of the buffer are used to let a packet be written contiguously
+//! across the end of the ring so the ring holds \e ui32Size less the
+//! maximum packet size bytes of audio data.  The application, usually
+//! through the uDMA channel feeding the codec, reads audio data from the ring
+//! using USBAudioRingRead() and USBAudioRingAdvance().  If the ring is full,
+//! packets from the host are dropped.
+//!
+//! When \b USBD_AUDIO_FLAG_ASYNC is in use, the level of the ring is used to
+//! steer the feedback value sent to the host so that the ring remains about
+//! half full.
+//!
+//! \return Returns 0 to indicate success any other value indicates that the
+//! ring will not be filled.
+//
+//*****************************************************************************
+int32_t
+USBAudioRingOut(void *pvAudioDevice, void *pvRing, uint32_t ui32Size,
+                uint32_t ui32Period, tUSBAudioBufferCallback pfnCallback)
+{
+    tAudioInstance *psInst;
+    tUSBDAudioDevice *psAudioDevice;
+
+    //
+    // Make sure we were not passed NULL pointers.
+    //
+    ASSERT(pvAudioDevice != 0);
+    ASSERT(pvRing != 0);
+    ASSERT(((uint32_t)pvRing & 3) == 0);
+    ASSERT(ui32Period != 0);
+
+    //
+    // The audio device structure pointer.
+    //
+    psAudioDevice = (tUSBDAudioDevice *)pvAudioDevice;
+
+    //
+    // Create a pointer to the audio instance data.
+    //
+    psInst = &psAudioDevice->sPrivateData;
+
+    //
+    // The ring must hold at least one packet past the space reserved at the
+    // end of the buffer.
+    //
+    if(ui32Size <= (2 * (uint32_t)psInst->ui16MaxPacketSize))
+    {
+        return(-1);
+    }
+
+    //
+    // Initialize the ring.  The data pointer is set last since it enables
+    // the use of the ring by the interrupt handler.
+    //
+    psInst->sRing.pui8Data = 0;
+    psInst->sRing.ui32Size = ui32Size - psInst->ui16MaxPacketSize;
+    psInst->sRing.ui32Write = 0;
+    psInst->sRing.ui32Read = 0;
+    psInst->sRing.ui32Period = ui32Period;
+    psInst->sRing.ui32PeriodFill = 0;
+    psInst->sRing.ui32DMASize = 0;
+    psInst->sRing.ui32Overruns = 0;
+    psInst->sRing.pfnCallback = pfnCallback;
+    psInst->sRing.pui8Data = (uint8_t *)pvRing;
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Returns the audio data waiting to be read from the ring.
+//!
+//! \param pvAudioDevice is the pointer to the device instance structure as
+//! returned by USBDAudioInit() or USBDAudioCompositeInit().
+//! \param ppui8Data points to storage which is written with a pointer to the
+//! next byte of audio data to be read from the ring.
+//!
+//! This function returns the number of bytes of audio data that can be read
+//! contiguously from the ring provided by USBAudioRingOut().  Once the data
+//! has been read, the application calls USBAudioRingAdvance() to free the
+//! space in the ring.
+//!
+//! \return Returns the number of contiguous bytes that can be read starting at
+//! \e *ppui8Data.
+//
+//*****************************************************************************
+uint32_t
+USBAudioRingRead(void *pvAudioDevice, uint8_t **ppui8Data)
+{
+    tAudioInstance *psInst;
+    uint32_t ui32Write, ui32Read;
+
+    ASSERT(pvAudioDevice != 0);
+    ASSERT(ppui8Data != 0);
+
+    psInst = &((tUSBDAudioDevice *)pvAudioDevice)->sPrivateData;
+
+    ui32Write = psInst->sRing.ui32Write;
+    ui32Read = psInst->sRing.ui32Read;
+
+    *ppui8Data = psInst->sRing.pui8Data + ui32Read;
+
+    if(ui32Write >= ui32Read)
+    {
+        return(ui32Write - ui32Read);
+    }
+
+    return(psInst->sRing.ui32Size - ui32Read);
+}
+
+//*****************************************************************************
+//
+//! Frees audio data which has been read from the ring.
+//!
+//! \param pvAudioDevice is the pointer to the device instance structure as
+//! returned by USBDAudioInit() or USBDAudioCompositeInit().
+//! \param ui32Size is the number of bytes that have been read.
+//!
+//! This function moves the read position of the ring provided by
+//! USBAudioRingOut() on by \e ui32Size bytes, which must not be more than the
+//! number of bytes waiting in the ring.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBAudioRingAdvance(void *pvAudioDevice, uint32_t ui32Size)
+{
+    tAudioInstance *psInst;
+    uint32_t ui32Read;
+
+    ASSERT(pvAudioDevice != 0);
+
+    psInst = &((tUSBDAudioDevice *)pvAudioDevice)->sPrivateData;
+
+    ASSERT(ui32Size <= RingUsed(psInst));
+
+    ui32Read = psInst->sRing.ui32Read + ui32Size;
+
+    if(ui32Read >= psInst->sRing.ui32Size)
+    {
+        ui32Read -= psInst->sRing.ui32Size;
+    }
+
+    psInst->sRing.ui32Read = ui32Read;
+}
+
+//*****************************************************************************
+//
+//! Reports the rate of the codec clock used to calculate the feedback value.
+//!
+//! \param pvAudioDevice is the pointer to the device instance structure as
+//! returned by USBDAudioInit() or USBDAudioCompositeInit().
+//! \param ui32Samples is the number of samples played by the codec since the
+//! last call to this function.
+//!
+//! When \b USBD_AUDIO_FLAG_ASYNC is in use, the application measures the
+//! codec sample clock, typically by counting the codec frame clock with a
+//! timer, and calls this function at least every few hundred milliseconds
+//! with the number of samples counted since the previous call.  The audio
+//! class measures the same interval in USB frames and, once at least one
+//! feedback refresh interval has passed, calculates the number of samples
+//! per frame sent to the host on the feedback endpoint.  If a ring is in use,
+//! the value is corrected by the difference between the ring level and half
+//! full so that small measurement errors do not accumulate.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBAudioFeedbackUpdate(void *pvAudioDevice, uint32_t ui32Samples)
+{
+    tAudioInstance *psInst;
+    uint32_t ui32Frame;
+    int32_t i32Value, i32Error;
+
+    ASSERT(pvAudioDevice != 0);
+
+    psInst = &((tUSBDAudioDevice *)pvAudioDevice)->sPrivateData;
+
+    if(!(psInst->ui8Flags & USBD_AUDIO_FLAG_ASYNC))
+    {
+        return;
+    }
+
+    //
+    // Accumulate the samples and the USB frames that have passed since the
+    // last call.  The frame number is 11 bits wide.
+    //
+    ui32Frame = MAP_USBFrameNumberGet(psInst->ui32USBBase);
+    psInst->sFeedback.ui32Samples += ui32Samples;
+    psInst->sFeedback.ui32Frames +=
+                        (ui32Frame - psInst->sFeedback.ui32LastFrame) & 0x7ff;
+    psInst->sFeedback.ui32LastFrame = ui32Frame;
+
+    //
+    // Wait until at least one refresh interval has been measured.
+    //
+    if(psInst->sFeedback.ui32Frames < (1 << USBD_AUDIO_FEEDBACK_REFRESH))
+    {
+        return;
+    }
+
+    //
+    // Calculate the number of samples per frame in 10.14 format, provided
+    // that the count is small enough not to overflow.
+    //
+    if(psInst->sFeedback.ui32Samples < (1 << 18))
+    {
+        i32Value = (int32_t)((psInst->sFeedback.ui32Samples << 14) /
+                             psInst->sFeedback.ui32Frames);
+
+        //
+        // Steer the ring level towards half full.
+        //
+        if(psInst->sRing.pui8Data)
+        {
+            i32Error = (int32_t)(psInst->sRing.ui32Size / 2) -
+                       (int32_t)RingUsed(psInst);
+            i32Error /= (int32_t)psInst->ui8FrameSize;
+            i32Value += (i32Error * (1 << 14)) / USBD_AUDIO_FEEDBACK_GAIN;
+        }
+
+        //
+        // Keep the value within one sample per frame of the nominal rate.
+        //
+        if(i32Value > (int32_t)(psInst->sFeedback.ui32Nominal + (1 << 14)))
+        {
+            i32Value = psInst->sFeedback.ui32Nominal + (1 << 14);
+        }
+        else if(i32Value <
+                (int32_t)(psInst->sFeedback.ui32Nominal - (1 << 14)))
+        {
+            i32Value = psInst->sFeedback.ui32Nominal - (1 << 14);
+        }
+
+        psInst->sFeedback.ui32Value = (uint32_t)i32Value;
+    }
+
+    psInst->sFeedback.ui32Samples = 0;
+    psInst->sFeedback.ui32Frames = 0;
+}
+
 //*****************************************************************************
 //
 // Close the Doxygen group.
@@ -162,6 +162,94 @@ typedef struct
     // A copy of the DMA instance data used with calls to USBLibDMA functions.
     //
     tUSBDMAInstance *psDMAInstance;
+
+    //
+    // The USBD_AUDIO_FLAG_* options in use by this instance.
+    //
+    uint8_t ui8Flags;
+
+    //
+    // The number of bytes in one sample for all channels.
+    //
+    uint8_t ui8FrameSize;
+
+    //
+    // The maximum packet size of the isochronous OUT endpoint.
+    //
+    uint16_t ui16MaxPacketSize;
+
+    //
+    // The feedback IN endpoint in use by this instance.
+    //
+    uint8_t ui8FeedbackEndpoint;
+
+    struct
+    {
+        //
+        // Pointer to the ring buffer provided by the caller or 0 if
+        // USBAudioBufferOut() is in use.
+        //
+        uint8_t *pui8Data;
+
+        //
+        // The usable size of the ring in bytes.  The buffer provided extends
+        // ui16MaxPacketSize bytes past this to allow a packet to be written
+        // contiguously across the end of the ring.
+        //
+        uint32_t ui32Size;
+
+        //
+        // The offsets of the next byte to write and to read.
+        //
+        volatile uint32_t ui32Write;
+        volatile uint32_t ui32Read;
+
+        //
+        // The size of a period in bytes and the number of bytes received
+        // since the last period was reported.
+        //
+        uint32_t ui32Period;
+        uint32_t ui32PeriodFill;
+
+        //
+        // The number of bytes being transferred by uDMA or 0 if no transfer
+        // is in progress.
+        //
+        uint32_t ui32DMASize;
+
+        //
+        // The number of packets dropped because the ring was full.
+        //
+        uint32_t ui32Overruns;
+
+        //
+        // The callback used to report each period.
+        //
+        tUSBAudioBufferCallback pfnCallback;
+    }
+    sRing;
+
+    struct
+    {
+        //
+        // The nominal and current feedback values in 10.14 samples per frame.
+        //
+        uint32_t ui32Nominal;
+        uint32_t ui32Value;
+
+        //
+        // The number of codec samples and USB frames measured since the
+        // feedback value was last calculated.
+        //
+        uint32_t ui32Samples;
+        uint32_t ui32Frames;
+
+        //
+        // The USB frame number when the codec samples were last reported.
+        //
+        uint32_t ui32LastFrame;
+    }
+    sFeedback;
 }
 tAudioInstance;
 
@@ -186,6 +274,14 @@ tAudioInstance;
 //*****************************************************************************
 #define STREAMINTERFACE_SIZE    (52)
 
+//*****************************************************************************
+//
+// This is the size of the g_pui8AudioStreamInterfaceAsync array in bytes.
+//
+//*****************************************************************************
+#define STREAMINTERFACE_ASYNC_SIZE                                            \
+                                (STREAMINTERFACE_SIZE + 9)
+
 //*****************************************************************************
 //
 //! The size of the memory that should be allocated to create a configuration
@@ -197,6 +293,49 @@ tAudioInstance;
 #define COMPOSITE_DAUDIO_SIZE   (AUDIODESCRIPTOR_SIZE +                       \
                                  CONTROLINTERFACE_SIZE + STREAMINTERFACE_SIZE)
 
+//*****************************************************************************
+//
+//! The size of the memory that should be allocated to create a configuration
+//! descriptor for a single instance of the USB Audio Device when the
+//! \b USBD_AUDIO_FLAG_ASYNC flag is set.
+//
+//*****************************************************************************
+#define COMPOSITE_DAUDIO_ASYNC_SIZE                                           \
+                                (AUDIODESCRIPTOR_SIZE +                       \
+                                 CONTROLINTERFACE_SIZE +                      \
+                                 STREAMINTERFACE_ASYNC_SIZE)
+
+//*****************************************************************************
+//
+//! This flag, passed in the \e ui8Flags field of tUSBDAudioDevice, selects an
+//! asynchronous isochronous OUT endpoint with an explicit feedback IN
+//! endpoint.  The application reports the rate of the codec clock using
+//! USBAudioFeedbackUpdate() and the host adjusts the amount of audio data it
+//! sends to match.
+//
+//*****************************************************************************
+#define USBD_AUDIO_FLAG_ASYNC   0x01
+
+//*****************************************************************************
+//
+//! The feedback endpoint refresh interval is 2 to the power of this value in
+//! milliseconds.
+//
+//*****************************************************************************
+#ifndef USBD_AUDIO_FEEDBACK_REFRESH
+#define USBD_AUDIO_FEEDBACK_REFRESH     5
+#endif
+
+//*****************************************************************************
+//
+//! The feedback value is corrected by one 2^-14 of a sample per frame for each
+//! of this many samples by which the ring level differs from half full.
+//
+//*****************************************************************************
+#ifndef USBD_AUDIO_FEEDBACK_GAIN
+#define USBD_AUDIO_FEEDBACK_GAIN        1024
+#endif
+
 //*****************************************************************************
 //
 //! The structure used by the application to define operating parameters for
@@ -286,6 +425,22 @@ typedef struct
     //
     const int16_t i16VolumeStep;
 
+    //
+    //! The sample rate in Hz, up to 96000, or 0 for 48000.
+    //
+    const uint32_t ui32SampleRate;
+
+    //
+    //! The number of bits in each sample, 16 or 24, or 0 for 16.
+    //
+    const uint8_t ui8SampleBits;
+
+    //
+    //! The USBD_AUDIO_FLAG_* options for the device or 0 for an adaptive
+    //! isochronous OUT endpoint without feedback.
+    //
+    const uint8_t ui8Flags;
+
     //
     //! The private instance data for the audio device.
     //
@@ -347,6 +502,16 @@ tUSBDAudioDevice;
 //*****************************************************************************
 #define USBD_AUDIO_EVENT_MUTE   (USBD_AUDIO_EVENT_BASE + 5)
 
+//*****************************************************************************
+//
+//! This USB audio event indicates that another period of audio data has been
+//! written to the ring provided by USBAudioRingOut().  The \e pvBuffer
+//! parameter holds the pointer to the ring and the \e ui32Param value holds
+//! the number of bytes of audio data waiting to be read from the ring.
+//
+//*****************************************************************************
+#define USBD_AUDIO_EVENT_PERIOD (USBD_AUDIO_EVENT_BASE + 6)
+
 //*****************************************************************************
 //
 // API Function Prototypes
@@ -361,6 +526,12 @@ extern void USBDAudioTerm(void *pvAudioDevice);
 extern int32_t USBAudioBufferOut(void *pvAudioDevice, void *pvBuffer,
                                  uint32_t ui32Size,
                                  tUSBAudioBufferCallback pfnCallback);
+extern int32_t USBAudioRingOut(void *pvAudioDevice, void *pvRing,
+                               uint32_t ui32Size, uint32_t ui32Period,
+                               tUSBAudioBufferCallback pfnCallback);
+extern uint32_t USBAudioRingRead(void *pvAudioDevice, uint8_t **ppui8Data);
+extern void USBAudioRingAdvance(void *pvAudioDevice, uint32_t ui32Size);
+extern void USBAudioFeedbackUpdate(void *pvAudioDevice, uint32_t ui32Samples);
 
 //*****************************************************************************
 //
@@ -27,6 +27,7 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/rom.h"
 #include "driverlib/rom_map.h"
 #include "driverlib/usb.h"
@@ -65,6 +66,18 @@
 //*****************************************************************************
 #define BULK_DO_PACKET_RX       5
 
+//*****************************************************************************
+//
+// Flags that may appear in ui32XferFlags to track the transfer-level
+// operations started by USBDBulkTransferWrite() and USBDBulkTransferRead().
+//
+//*****************************************************************************
+#define BULK_XFER_TX            0x00000001
+#define BULK_XFER_TX_DMA        0x00000002
+#define BULK_XFER_TX_ZLP        0x00000004
+#define BULK_XFER_RX            0x00000008
+#define BULK_XFER_RX_DMA        0x00000010
+
 //*****************************************************************************
 //
 // Endpoints to use for each of the required endpoints in the driver.'
@@ -420,6 +433,222 @@ SetDeferredOpFlag(volatile uint16_t *pui16DeferredOp, uint16_t ui16Bit,
     HWREGBITH(pui16DeferredOp, ui16Bit) = bSet ? 1 : 0;
 }
 
+//*****************************************************************************
+//
+// Moves the transmit transfer in progress on to its next step.
+//
+// \param psBulkDevice is the device instance whose transfer is to be
+// continued.
+//
+// This function is called to start a transmit transfer and then each time
+// that the previous step of the transfer has completed.  Whole packets are
+// sent by DMA if a channel is available and the data is word aligned, and
+// any remaining short packet is written to the FIFO.  A zero-length packet
+// ends a transfer whose length is a multiple of the maximum packet size, so
+// that the host does not wait for more data.  Once all of the data has been
+// acknowledged, the client is sent a single \b USB_EVENT_TX_COMPLETE event.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+TxTransferNext(tUSBDBulkDevice *psBulkDevice)
+{
+    tBulkInstance *psInst;
+    const uint8_t *pui8Data;
+    uint32_t ui32Size;
+
+    //
+    // Get a pointer to the bulk device instance data pointer
+    //
+    psInst = &psBulkDevice->sPrivateData;
+
+    //
+    // Wait for the last packet written by the DMA to be sent.
+    //
+    if(MAP_USBEndpointStatus(psInst->ui32USBBase, psInst->ui8INEndpoint) &
+       USB_DEV_TX_TXPKTRDY)
+    {
+        return;
+    }
+
+    pui8Data = psInst->pui8TxXfer;
+    ui32Size = psInst->ui32TxXferRemaining;
+
+    //
+    // Send as many whole packets as possible by DMA.
+    //
+    if(psInst->ui8INDMA && !((uint32_t)pui8Data & 3) &&
+       (ui32Size >= (2 * g_ui16MaxPacketSize)))
+    {
+        ui32Size -= ui32Size % g_ui16MaxPacketSize;
+
+        if(USBLibDMATransfer(psInst->psDMAInstance, psInst->ui8INDMA,
+                             (void *)pui8Data, ui32Size) != 0)
+        {
+            psInst->pui8TxXfer += ui32Size;
+            psInst->ui32TxXferRemaining -= ui32Size;
+            psInst->ui32XferFlags |= BULK_XFER_TX_DMA;
+
+            USBLibDMAChannelEnable(psInst->psDMAInstance, psInst->ui8INDMA);
+            return;
+        }
+
+        ui32Size = psInst->ui32TxXferRemaining;
+    }
+
+    //
+    // Otherwise send the next packet from the FIFO.
+    //
+    if(ui32Size)
+    {
+        if(ui32Size > g_ui16MaxPacketSize)
+        {
+            ui32Size = g_ui16MaxPacketSize;
+        }
+
+        psInst->pui8TxXfer += ui32Size;
+        psInst->ui32TxXferRemaining -= ui32Size;
+
+        MAP_USBEndpointDataPut(psInst->ui32USBBase, psInst->ui8INEndpoint,
+                               (uint8_t *)pui8Data, ui32Size);
+        MAP_USBEndpointDataSend(psInst->ui32USBBase, psInst->ui8INEndpoint,
+                                USB_TRANS_IN);
+        return;
+    }
+
+    //
+    // End the transfer with a zero-length packet if it is needed.
+    //
+    if(psInst->ui32XferFlags & BULK_XFER_TX_ZLP)
+    {
+        psInst->ui32XferFlags &= ~BULK_XFER_TX_ZLP;
+
+        MAP_USBEndpointDataSend(psInst->ui32USBBase, psInst->ui8INEndpoint,
+                                USB_TRANS_IN);
+        return;
+    }
+
+    //
+    // The transfer is complete so let the client know.
+    //
+    psInst->ui32XferFlags &= ~BULK_XFER_TX;
+    psInst->iBulkTxState = eBulkStateIdle;
+
+    psBulkDevice->pfnTxCallback(psBulkDevice->pvTxCBData,
+                                USB_EVENT_TX_COMPLETE, psInst->ui32TxXferSize,
+                                (void *)0);
+}
+
+//*****************************************************************************
+//
+// Accounts for a packet read into the receive transfer in progress.
+//
+// \param psBulkDevice is the device instance whose transfer is to be
+// continued.
+// \param ui32Size is the size of the packet.
+//
+// A short packet or a full buffer ends the transfer, and the client is then
+// sent a single \b USB_EVENT_RX_AVAILABLE event with a pointer to the
+// buffer.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+RxTransferDone(tUSBDBulkDevice *psBulkDevice, uint32_t ui32Size)
+{
+    tBulkInstance *psInst;
+
+    psInst = &psBulkDevice->sPrivateData;
+
+    psInst->ui32RxXferCount += ui32Size;
+
+    if((ui32Size < g_ui16MaxPacketSize) ||
+       (psInst->ui32RxXferCount == psInst->ui32RxXferSize))
+    {
+        psInst->ui32XferFlags &= ~BULK_XFER_RX;
+
+        psBulkDevice->pfnRxCallback(psBulkDevice->pvRxCBData,
+                                    USB_EVENT_RX_AVAILABLE,
+                                    psInst->ui32RxXferCount,
+                                    psInst->pui8RxXfer);
+    }
+}
+
+//*****************************************************************************
+//
+// Reads a received packet into the receive transfer in progress.
+//
+// \param psBulkDevice is the device instance whose transfer is to be
+// continued.
+//
+// This function reads the packet waiting in the OUT endpoint FIFO, if there
+// is one, into the transfer buffer.  A full packet is read by DMA if a
+// channel is available and the buffer is word aligned, in which case the
+// endpoint acknowledges the packet once it has been unloaded and the transfer
+// is continued when the DMA completes.  Any other packet is read from the
+// FIFO and acknowledged here.  The transfer completes when a short packet is
+// received or the buffer is full, at which point the client is sent a single
+// \b USB_EVENT_RX_AVAILABLE event with a pointer to the buffer.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+RxTransferNext(tUSBDBulkDevice *psBulkDevice)
+{
+    tBulkInstance *psInst;
+    uint8_t *pui8Data;
+    uint32_t ui32Size;
+
+    //
+    // Get a pointer to the bulk device instance data pointer
+    //
+    psInst = &psBulkDevice->sPrivateData;
+
+    //
+    // Wait for the packet being read by DMA, if any, to be unloaded.
+    //
+    if((psInst->ui32XferFlags & BULK_XFER_RX_DMA) ||
+       !(MAP_USBEndpointStatus(psInst->ui32USBBase, psInst->ui8OUTEndpoint) &
+         USB_DEV_RX_PKT_RDY))
+    {
+        return;
+    }
+
+    ui32Size = MAP_USBEndpointDataAvail(psInst->ui32USBBase,
+                                        psInst->ui8OUTEndpoint);
+    pui8Data = psInst->pui8RxXfer + psInst->ui32RxXferCount;
+    SetDeferredOpFlag(&psInst->ui16DeferredOpFlags, BULK_DO_PACKET_RX, false);
+
+    //
+    // Read a full packet by DMA if possible.
+    //
+    if(psInst->ui8OUTDMA && (ui32Size == g_ui16MaxPacketSize) &&
+       (USBLibDMATransfer(psInst->psDMAInstance, psInst->ui8OUTDMA,
+                          pui8Data, ui32Size) != 0))
+    {
+        psInst->ui32XferFlags |= BULK_XFER_RX_DMA;
+
+        MAP_USBEndpointDMAEnable(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                                 USB_EP_DEV_OUT);
+        USBLibDMAChannelEnable(psInst->psDMAInstance, psInst->ui8OUTDMA);
+        return;
+    }
+
+    //
+    // Otherwise read the packet.  The buffer size is a multiple of the
+    // maximum packet size so the packet always fits.
+    //
+    MAP_USBEndpointDataGet(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                           pui8Data, &ui32Size);
+    MAP_USBDevEndpointDataAck(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                              true);
+
+    RxTransferDone(psBulkDevice, ui32Size);
+}
+
 //*****************************************************************************
 //
 // Receives notifications related to data received from the host.
@@ -461,11 +690,44 @@ ProcessDataFromHost(tUSBDBulkDevice *psBulkDevice, uint32_t ui32Status)
     MAP_USBDevEndpointStatusClear(USB0_BASE, psInst->ui8OUTEndpoint,
                                   ui32EPStatus);
 
+    //
+    // If a packet of a receive transfer is being read by DMA, wait for the
+    // DMA to complete and account for the packet.  The next packet may
+    // already have arrived, so the endpoint status is read again.
+    //
+    if(psInst->ui32XferFlags & BULK_XFER_RX_DMA)
+    {
+        if(!(USBLibDMAChannelStatus(psInst->psDMAInstance,
+                                    psInst->ui8OUTDMA) &
+             USBLIBSTATUS_DMA_COMPLETE))
+        {
+            return(true);
+        }
+
+        psInst->ui32XferFlags &= ~BULK_XFER_RX_DMA;
+        MAP_USBEndpointDMADisable(psInst->ui32USBBase,
+                                  psInst->ui8OUTEndpoint, USB_EP_DEV_OUT);
+
+        RxTransferDone(psBulkDevice, g_ui16MaxPacketSize);
+
+        ui32EPStatus = MAP_USBEndpointStatus(psInst->ui32USBBase,
+                                             psInst->ui8OUTEndpoint);
+    }
+
     //
     // Has a packet been received?
     //
     if(ui32EPStatus & USB_DEV_RX_PKT_RDY)
     {
+        //
+        // If a receive transfer is in progress, read the packet into it.
+        //
+        if(psInst->ui32XferFlags & BULK_XFER_RX)
+        {
+            RxTransferNext(psBulkDevice);
+            return(true);
+        }
+
         //
         // Set the flag we use to indicate that a packet read is pending.  This
         // will be cleared if the packet is read.  If the client does not read
@@ -553,6 +815,30 @@ ProcessDataToHost(tUSBDBulkDevice *psBulkDevice, uint32_t ui32Status)
     MAP_USBDevEndpointStatusClear(psInst->ui32USBBase, psInst->ui8INEndpoint,
                                   ui32EPStatus);
 
+    //
+    // If a transmit transfer is in progress, move it on once any DMA that
+    // it started has completed.
+    //
+    if(psInst->ui32XferFlags & BULK_XFER_TX)
+    {
+        if(psInst->ui32XferFlags & BULK_XFER_TX_DMA)
+        {
+            if(!(USBLibDMAChannelStatus(psInst->psDMAInstance,
+                                        psInst->ui8INDMA) &
+                 USBLIBSTATUS_DMA_COMPLETE))
+            {
+                return(true);
+            }
+
+            psInst->ui32XferFlags &= ~BULK_XFER_TX_DMA;
+            MAP_USBEndpointDMADisable(psInst->ui32USBBase,
+                                      psInst->ui8INEndpoint, USB_EP_DEV_IN);
+        }
+
+        TxTransferNext(psBulkDevice);
+        return(true);
+    }
+
     //
     // Our last transmission completed.  Clear our state back to idle and
     // see if we need to send any more data.
@@ -597,9 +883,13 @@ HandleEndpoints(void *pvBulkDevice, uint32_t ui32Status)
     psInst = &psBulkDevice->sPrivateData;
 
     //
-    // Handler for the bulk OUT data endpoint.
+    // Handler for the bulk OUT data endpoint, or for the completion of a DMA
+    // transfer on it.
     //
-    if(ui32Status & (0x10000 << USBEPToIndex(psInst->ui8OUTEndpoint)))
+    if((ui32Status & (0x10000 << USBEPToIndex(psInst->ui8OUTEndpoint))) ||
+       ((psInst->ui32XferFlags & BULK_XFER_RX_DMA) &&
+        (USBLibDMAChannelStatus(psInst->psDMAInstance, psInst->ui8OUTDMA) &
+         USBLIBSTATUS_DMA_COMPLETE)))
     {
         //
         // Data is being sent to us from the host.
@@ -608,9 +898,13 @@ HandleEndpoints(void *pvBulkDevice, uint32_t ui32Status)
     }
 
     //
-    // Handler for the bulk IN data endpoint.
+    // Handler for the bulk IN data endpoint, or for the completion of a DMA
+    // transfer on it.
     //
-    if(ui32Status & (1 << USBEPToIndex(psInst->ui8INEndpoint)))
+    if((ui32Status & (1 << USBEPToIndex(psInst->ui8INEndpoint))) ||
+       ((psInst->ui32XferFlags & BULK_XFER_TX_DMA) &&
+        (USBLibDMAChannelStatus(psInst->psDMAInstance, psInst->ui8INDMA) &
+         USBLIBSTATUS_DMA_COMPLETE)))
     {
         ProcessDataToHost(psBulkDevice, ui32Status);
     }
@@ -626,6 +920,7 @@ HandleConfigChange(void *pvBulkDevice, uint32_t ui32Info)
 {
     tBulkInstance *psInst;
     tUSBDBulkDevice *psBulkDevice;
+    uint16_t ui16MaxPacketSize;
 
     ASSERT(pvBulkDevice != 0);
 
@@ -639,11 +934,38 @@ HandleConfigChange(void *pvBulkDevice, uint32_t ui32Info)
     //
     psInst = &psBulkDevice->sPrivateData;
 
+    //
+    // The host may have configured the device at a speed other than the one
+    // chosen when the class was initialized, so take the packet size from the
+    // configuration in use.  A DMA channel set up for the other packet size
+    // is released and allocated again by the next transfer.
+    //
+    ui16MaxPacketSize = (psInst->sDevInfo.ppsConfigDescriptors ==
+                         g_ppBulkConfigDescriptorsHS) ?
+                        DATA_IN_EP_MAX_SIZE_HS : DATA_IN_EP_MAX_SIZE;
+
+    if(ui16MaxPacketSize != g_ui16MaxPacketSize)
+    {
+        g_ui16MaxPacketSize = ui16MaxPacketSize;
+
+        if(psInst->ui8INDMA != 0)
+        {
+            USBLibDMAChannelRelease(psInst->psDMAInstance, psInst->ui8INDMA);
+            psInst->ui8INDMA = 0;
+        }
+        if(psInst->ui8OUTDMA != 0)
+        {
+            USBLibDMAChannelRelease(psInst->psDMAInstance, psInst->ui8OUTDMA);
+            psInst->ui8OUTDMA = 0;
+        }
+    }
+
     //
     // Set all our endpoints to idle state.
     //
     psInst->iBulkRxState = eBulkStateIdle;
     psInst->iBulkTxState = eBulkStateIdle;
+    psInst->ui32XferFlags = 0;
 
     //
     // If we have a control callback, let the client know we are open for
@@ -714,6 +1036,17 @@ HandleDevice(void *pvBulkDevice, uint32_t ui32Request, void *pvRequestData)
             if(pui8Data[0] & USB_EP_DESC_IN)
             {
                 psInst->ui8INEndpoint = IndexToUSBEP((pui8Data[1] & 0x7f));
+
+                //
+                // Release any DMA channel allocated to the old endpoint.  A
+                // channel is allocated again when it is first needed.
+                //
+                if(psInst->ui8INDMA != 0)
+                {
+                    USBLibDMAChannelRelease(psInst->psDMAInstance,
+                                            psInst->ui8INDMA);
+                    psInst->ui8INDMA = 0;
+                }
             }
             else
             {
@@ -721,6 +1054,13 @@ HandleDevice(void *pvBulkDevice, uint32_t ui32Request, void *pvRequestData)
                 // Extract the new endpoint number.
                 //
                 psInst->ui8OUTEndpoint = IndexToUSBEP(pui8Data[1] & 0x7f);
+
+                if(psInst->ui8OUTDMA != 0)
+                {
+                    USBLibDMAChannelRelease(psInst->psDMAInstance,
+                                            psInst->ui8OUTDMA);
+                    psInst->ui8OUTDMA = 0;
+                }
             }
             break;
         }
@@ -806,9 +1146,11 @@ HandleDisconnect(void *pvBulkDevice)
     }
 
     //
-    // Remember that we are no longer connected.
+    // Remember that we are no longer connected.  Any transfers in progress
+    // are abandoned.
     //
     psInst->bConnected = false;
+    psInst->ui32XferFlags = 0;
 }
 
 //*****************************************************************************
@@ -896,7 +1238,8 @@ BulkTickHandler(void *pvBulkDevice, uint32_t ui32TimemS)
     //
     // Do we have a deferred receive waiting
     //
-    if(psInst->ui16DeferredOpFlags & (1 << BULK_DO_PACKET_RX))
+    if((psInst->ui16DeferredOpFlags & (1 << BULK_DO_PACKET_RX)) &&
+       !(psInst->ui32XferFlags & BULK_XFER_RX))
     {
         //
         // Yes - how big is the waiting packet?
@@ -1075,9 +1418,11 @@ USBDBulkCompositeInit(uint32_t ui32Index, tUSBDBulkDevice *psBulkDevice,
     psInst->sDevInfo.psCallbacks = &g_sBulkHandlers;
     psInst->sDevInfo.pui8DeviceDescriptor = g_pui8BulkDeviceDescriptor;
     psInst->sDevInfo.ppsConfigDescriptors = g_ppBulkConfigDescriptors;
+    psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
     if (USBLIB_FEATURE_ULPI_HS == ui32ulpiFeature)
     {
         psInst->sDevInfo.ppsConfigDescriptors = g_ppBulkConfigDescriptorsHS;
+        psInst->sDevInfo.ppsOtherSpeedDescriptors = g_ppBulkConfigDescriptors;
         g_ui16MaxPacketSize = USBFIFOSizeToBytes(USB_FIFO_SZ_512);
     }
     psInst->sDevInfo.ppui8StringDescriptors = 0;
@@ -1091,6 +1436,10 @@ USBDBulkCompositeInit(uint32_t ui32Index, tUSBDBulkDevice *psBulkDevice,
     psInst->iBulkTxState = eBulkStateUnconfigured;
     psInst->ui16DeferredOpFlags = 0;
     psInst->bConnected = false;
+    psInst->ui32XferFlags = 0;
+    psInst->psDMAInstance = USBLibDMAInit(0);
+    psInst->ui8INDMA = 0;
+    psInst->ui8OUTDMA = 0;
 
     //
     // Initialize the device info structure for the Bulk device.
@@ -1576,6 +1925,181 @@ USBDBulkRxPacketAvailable(void *pvBulkDevice)
         return(0);
     }
 }
+//*****************************************************************************
+//
+//! Transmits a buffer of any length to the USB host via the bulk data
+//! interface.
+//!
+//! \param pvBulkDevice is the pointer to the device instance structure as
+//! returned by USBDBulkInit().
+//! \param pui8Data points to the first byte of data which is to be
+//! transmitted.  The data must remain valid until the transfer completes.
+//! \param ui32Length is the number of bytes of data to transmit.
+//!
+//! This function schedules the whole buffer for transmission as a single USB
+//! transfer.  The data is split into packets from the USB interrupt, using
+//! DMA for whole packets if the buffer is word aligned, and a zero-length
+//! packet is sent after the data only if \e ui32Length is a multiple of the
+//! maximum packet size.  A single \b USB_EVENT_TX_COMPLETE event, with the
+//! length of the transfer as its \e ui32MsgValue, is sent to the transmit
+//! channel callback when the host has acknowledged all of the data.  The
+//! callback may start the next transfer.
+//!
+//! A transfer may only be started when no packet or transfer transmission
+//! is outstanding, and USBDBulkPacketWrite() must not be called until it
+//! completes.
+//!
+//! \return Returns \e ui32Length if the transfer was started, or 0 if a
+//! transmission is already in progress.
+//
+//*****************************************************************************
+uint32_t
+USBDBulkTransferWrite(void *pvBulkDevice, const uint8_t *pui8Data,
+                      uint32_t ui32Length)
+{
+    tUSBDBulkDevice *psBulkDevice;
+    tBulkInstance *psInst;
+    bool bIntsOff;
+
+    ASSERT(pvBulkDevice);
+    ASSERT(pui8Data || !ui32Length);
+
+    psBulkDevice = (tUSBDBulkDevice *)pvBulkDevice;
+    psInst = &psBulkDevice->sPrivateData;
+
+    if(psInst->iBulkTxState != eBulkStateIdle)
+    {
+        return(0);
+    }
+
+    //
+    // Allocate a DMA channel to the IN endpoint the first time that it is
+    // needed.  If none is available, the transfer is sent from the FIFO.
+    //
+    if(psInst->ui8INDMA == 0)
+    {
+        psInst->ui8INDMA = USBLibDMAChannelAllocate(psInst->psDMAInstance,
+                                                    psInst->ui8INEndpoint,
+                                                    g_ui16MaxPacketSize,
+                                                    USB_DMA_EP_TX |
+                                                    USB_DMA_EP_DEVICE);
+        if(psInst->ui8INDMA != 0)
+        {
+            USBLibDMAUnitSizeSet(psInst->psDMAInstance, psInst->ui8INDMA, 32);
+            USBLibDMAArbSizeSet(psInst->psDMAInstance, psInst->ui8INDMA, 16);
+        }
+    }
+
+    psInst->pui8TxXfer = pui8Data;
+    psInst->ui32TxXferRemaining = ui32Length;
+    psInst->ui32TxXferSize = ui32Length;
+    psInst->iBulkTxState = eBulkStateWaitData;
+
+    //
+    // Start the transfer with the USB interrupt masked, since the interrupt
+    // continues it.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    psInst->ui32XferFlags |= BULK_XFER_TX;
+    if((ui32Length % g_ui16MaxPacketSize) == 0)
+    {
+        psInst->ui32XferFlags |= BULK_XFER_TX_ZLP;
+    }
+    TxTransferNext(psBulkDevice);
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+
+    return(ui32Length);
+}
+
+//*****************************************************************************
+//
+//! Receives a transfer of any length from the USB host via the bulk data
+//! interface.
+//!
+//! \param pvBulkDevice is the pointer to the device instance structure as
+//! returned by USBDBulkInit().
+//! \param pui8Data points to the buffer into which the data is received.
+//! \param ui32Length is the size of the buffer, which must be a non-zero
+//! multiple of the maximum packet size.
+//!
+//! This function provides a buffer into which packets from the host are
+//! read from the USB interrupt, without the client being called for each
+//! packet.  Full packets are read by DMA if the buffer is word aligned.  The
+//! transfer completes when the host sends a short packet or the buffer is
+//! full, at which point a single \b USB_EVENT_RX_AVAILABLE event is sent to
+//! the receive channel callback with \e pvMsgData pointing to the buffer and
+//! \e ui32MsgValue holding the number of bytes received.  The callback may
+//! provide the next buffer.
+//!
+//! \return Returns \e ui32Length if the transfer was started, or 0 if a
+//! receive transfer is already in progress or the buffer size is not valid.
+//
+//*****************************************************************************
+uint32_t
+USBDBulkTransferRead(void *pvBulkDevice, uint8_t *pui8Data,
+                     uint32_t ui32Length)
+{
+    tUSBDBulkDevice *psBulkDevice;
+    tBulkInstance *psInst;
+    bool bIntsOff;
+
+    ASSERT(pvBulkDevice);
+    ASSERT(pui8Data);
+
+    psBulkDevice = (tUSBDBulkDevice *)pvBulkDevice;
+    psInst = &psBulkDevice->sPrivateData;
+
+    if((psInst->ui32XferFlags & BULK_XFER_RX) || (ui32Length == 0) ||
+       (ui32Length % g_ui16MaxPacketSize))
+    {
+        return(0);
+    }
+
+    //
+    // Allocate a DMA channel to the OUT endpoint the first time that it is
+    // needed.  If none is available, the transfer is read from the FIFO.
+    //
+    if(psInst->ui8OUTDMA == 0)
+    {
+        psInst->ui8OUTDMA = USBLibDMAChannelAllocate(psInst->psDMAInstance,
+                                                     psInst->ui8OUTEndpoint,
+                                                     g_ui16MaxPacketSize,
+                                                     USB_DMA_EP_RX |
+                                                     USB_DMA_EP_DEVICE);
+        if(psInst->ui8OUTDMA != 0)
+        {
+            USBLibDMAUnitSizeSet(psInst->psDMAInstance, psInst->ui8OUTDMA,
+                                 32);
+            USBLibDMAArbSizeSet(psInst->psDMAInstance, psInst->ui8OUTDMA, 16);
+        }
+    }
+
+    psInst->pui8RxXfer = pui8Data;
+    psInst->ui32RxXferSize = ui32Length;
+    psInst->ui32RxXferCount = 0;
+
+    //
+    // Start the transfer, reading any packet that is already waiting, with
+    // the USB interrupt masked.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    psInst->ui32XferFlags |= BULK_XFER_RX;
+    RxTransferNext(psBulkDevice);
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+
+    return(ui32Length);
+}
+
 #ifndef DEPRECATED
 
 //*****************************************************************************
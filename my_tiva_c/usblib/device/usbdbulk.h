@@ -147,6 +147,35 @@ typedef struct
     // The bulk class interface number, this is modified in composite devices.
     //
     uint8_t ui8Interface;
+
+    //
+    // The state of the transfer-level transmit and receive operations.
+    //
+    volatile uint32_t ui32XferFlags;
+
+    //
+    // The next byte to send, the number of bytes remaining and the size of
+    // the transfer in progress on the IN endpoint.
+    //
+    const uint8_t *pui8TxXfer;
+    uint32_t ui32TxXferRemaining;
+    uint32_t ui32TxXferSize;
+
+    //
+    // The buffer, its size and the number of bytes received so far for the
+    // transfer in progress on the OUT endpoint.
+    //
+    uint8_t *pui8RxXfer;
+    uint32_t ui32RxXferSize;
+    uint32_t ui32RxXferCount;
+
+    //
+    // The DMA instance and the DMA channels used for the IN and OUT
+    // endpoints, or 0 if no channel has been allocated yet.
+    //
+    tUSBDMAInstance *psDMAInstance;
+    uint8_t ui8INDMA;
+    uint8_t ui8OUTDMA;
 }
 tBulkInstance;
 
@@ -270,6 +299,11 @@ extern uint32_t USBDBulkPacketRead(void *pvBulkInstance, uint8_t *pi8Data,
                                    uint32_t ui32Length, bool bLast);
 extern uint32_t USBDBulkTxPacketAvailable(void *pvBulkInstance);
 extern uint32_t USBDBulkRxPacketAvailable(void *pvBulkInstance);
+extern uint32_t USBDBulkTransferWrite(void *pvBulkInstance,
+                                      const uint8_t *pui8Data,
+                                      uint32_t ui32Length);
+extern uint32_t USBDBulkTransferRead(void *pvBulkInstance, uint8_t *pui8Data,
+                                     uint32_t ui32Length);
 extern bool USBDBulkRemoteWakeupRequest(void *pvBulkInstance);
 
 //*****************************************************************************
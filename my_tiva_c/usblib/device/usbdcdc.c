@@ -27,6 +27,7 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/rom.h"
 #include "driverlib/rom_map.h"
 #include "driverlib/usb.h"
@@ -111,6 +112,18 @@
                                 4
 #define CDC_DO_PACKET_RX        5
 
+//*****************************************************************************
+//
+// Flags that may appear in ui32XferFlags to track the transfer-level
+// operations started by USBDCDCTransferWrite() and USBDCDCTransferRead().
+//
+//*****************************************************************************
+#define CDC_XFER_TX             0x00000001
+#define CDC_XFER_TX_DMA         0x00000002
+#define CDC_XFER_TX_ZLP         0x00000004
+#define CDC_XFER_RX             0x00000008
+#define CDC_XFER_RX_DMA         0x00000010
+
 //*****************************************************************************
 //
 // The subset of deferred operations which result in the receive channel
@@ -1061,6 +1074,226 @@ SendSerialState(tUSBDCDCDevice *psCDCDevice)
     }
 }
 
+//*****************************************************************************
+//
+// Moves the transmit transfer in progress on to its next step.
+//
+// \param psCDCDevice is the device instance whose transfer is to be
+// continued.
+//
+// This function is called to start a transmit transfer and then each time
+// that the previous step of the transfer has completed.  Whole packets are
+// sent by DMA if a channel is available and the data is word aligned, and
+// any remaining short packet is written to the FIFO.  A zero-length packet
+// ends a transfer whose length is a multiple of the maximum packet size, so
+// that the host does not wait for more data.  Once all of the data has been
+// acknowledged, the client is sent a single \b USB_EVENT_TX_COMPLETE event.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+TxTransferNext(tUSBDCDCDevice *psCDCDevice)
+{
+    tCDCSerInstance *psInst;
+    const uint8_t *pui8Data;
+    uint32_t ui32Size;
+
+    //
+    // Get a pointer to the CDC device instance data pointer
+    //
+    psInst = &psCDCDevice->sPrivateData;
+
+    //
+    // Wait for the last packet written by the DMA to be sent.
+    //
+    if(MAP_USBEndpointStatus(psInst->ui32USBBase, psInst->ui8BulkINEndpoint) &
+       USB_DEV_TX_TXPKTRDY)
+    {
+        return;
+    }
+
+    pui8Data = psInst->pui8TxXfer;
+    ui32Size = psInst->ui32TxXferRemaining;
+
+    //
+    // Send as many whole packets as possible by DMA.
+    //
+    if(psInst->ui8INDMA && !((uint32_t)pui8Data & 3) &&
+       (ui32Size >= (2 * g_ui16MaxPacketSize)))
+    {
+        ui32Size -= ui32Size % g_ui16MaxPacketSize;
+
+        if(USBLibDMATransfer(psInst->psDMAInstance, psInst->ui8INDMA,
+                             (void *)pui8Data, ui32Size) != 0)
+        {
+            psInst->pui8TxXfer += ui32Size;
+            psInst->ui32TxXferRemaining -= ui32Size;
+            psInst->ui32XferFlags |= CDC_XFER_TX_DMA;
+
+            USBLibDMAChannelEnable(psInst->psDMAInstance, psInst->ui8INDMA);
+            return;
+        }
+
+        ui32Size = psInst->ui32TxXferRemaining;
+    }
+
+    //
+    // Otherwise send the next packet from the FIFO.
+    //
+    if(ui32Size)
+    {
+        if(ui32Size > g_ui16MaxPacketSize)
+        {
+            ui32Size = g_ui16MaxPacketSize;
+        }
+
+        psInst->pui8TxXfer += ui32Size;
+        psInst->ui32TxXferRemaining -= ui32Size;
+
+        MAP_USBEndpointDataPut(psInst->ui32USBBase, psInst->ui8BulkINEndpoint,
+                               (uint8_t *)pui8Data, ui32Size);
+        MAP_USBEndpointDataSend(psInst->ui32USBBase, psInst->ui8BulkINEndpoint,
+                                USB_TRANS_IN);
+        return;
+    }
+
+    //
+    // End the transfer with a zero-length packet if it is needed.
+    //
+    if(psInst->ui32XferFlags & CDC_XFER_TX_ZLP)
+    {
+        psInst->ui32XferFlags &= ~CDC_XFER_TX_ZLP;
+
+        MAP_USBEndpointDataSend(psInst->ui32USBBase, psInst->ui8BulkINEndpoint,
+                                USB_TRANS_IN);
+        return;
+    }
+
+    //
+    // The transfer is complete so let the client know.
+    //
+    psInst->ui32XferFlags &= ~CDC_XFER_TX;
+    psInst->iCDCTxState = eCDCStateIdle;
+
+    psCDCDevice->pfnTxCallback(psCDCDevice->pvTxCBData,
+                                USB_EVENT_TX_COMPLETE, psInst->ui32TxXferSize,
+                                (void *)0);
+}
+
+//*****************************************************************************
+//
+// Accounts for a packet read into the receive transfer in progress.
+//
+// \param psCDCDevice is the device instance whose transfer is to be
+// continued.
+// \param ui32Size is the size of the packet.
+//
+// A short packet or a full buffer ends the transfer, and the client is then
+// sent a single \b USB_EVENT_RX_AVAILABLE event with a pointer to the
+// buffer.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+RxTransferDone(tUSBDCDCDevice *psCDCDevice, uint32_t ui32Size)
+{
+    tCDCSerInstance *psInst;
+
+    psInst = &psCDCDevice->sPrivateData;
+
+    psInst->ui32RxXferCount += ui32Size;
+
+    if((ui32Size < g_ui16MaxPacketSize) ||
+       (psInst->ui32RxXferCount == psInst->ui32RxXferSize))
+    {
+        psInst->ui32XferFlags &= ~CDC_XFER_RX;
+
+        psCDCDevice->pfnRxCallback(psCDCDevice->pvRxCBData,
+                                    USB_EVENT_RX_AVAILABLE,
+                                    psInst->ui32RxXferCount,
+                                    psInst->pui8RxXfer);
+    }
+}
+
+//*****************************************************************************
+//
+// Reads a received packet into the receive transfer in progress.
+//
+// \param psCDCDevice is the device instance whose transfer is to be
+// continued.
+//
+// This function reads the packet waiting in the OUT endpoint FIFO, if there
+// is one, into the transfer buffer.  A full packet is read by DMA if a
+// channel is available and the buffer is word aligned, in which case the
+// endpoint acknowledges the packet once it has been unloaded and the transfer
+// is continued when the DMA completes.  Any other packet is read from the
+// FIFO and acknowledged here.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+RxTransferNext(tUSBDCDCDevice *psCDCDevice)
+{
+    tCDCSerInstance *psInst;
+    uint8_t *pui8Data;
+    uint32_t ui32Size;
+
+    //
+    // Get a pointer to the CDC device instance data pointer
+    //
+    psInst = &psCDCDevice->sPrivateData;
+
+    //
+    // Leave the packet in the FIFO while the receive channel is blocked or
+    // the previous packet is being read by DMA.
+    //
+    if(psInst->bControlBlocked || psInst->bRxBlocked ||
+       (psInst->ui32XferFlags & CDC_XFER_RX_DMA))
+    {
+        return;
+    }
+
+    if(!(MAP_USBEndpointStatus(psInst->ui32USBBase, psInst->ui8BulkOUTEndpoint) &
+         USB_DEV_RX_PKT_RDY))
+    {
+        return;
+    }
+
+    ui32Size = MAP_USBEndpointDataAvail(psInst->ui32USBBase,
+                                        psInst->ui8BulkOUTEndpoint);
+    pui8Data = psInst->pui8RxXfer + psInst->ui32RxXferCount;
+    SetDeferredOpFlag(&psInst->ui16DeferredOpFlags, CDC_DO_PACKET_RX, false);
+
+    //
+    // Read a full packet by DMA if possible.
+    //
+    if(psInst->ui8OUTDMA && (ui32Size == g_ui16MaxPacketSize) &&
+       (USBLibDMATransfer(psInst->psDMAInstance, psInst->ui8OUTDMA,
+                          pui8Data, ui32Size) != 0))
+    {
+        psInst->ui32XferFlags |= CDC_XFER_RX_DMA;
+
+        MAP_USBEndpointDMAEnable(psInst->ui32USBBase,
+                                 psInst->ui8BulkOUTEndpoint, USB_EP_DEV_OUT);
+        USBLibDMAChannelEnable(psInst->psDMAInstance, psInst->ui8OUTDMA);
+        return;
+    }
+
+    //
+    // Otherwise read the packet.  The buffer size is a multiple of the
+    // maximum packet size so the packet always fits.
+    //
+    MAP_USBEndpointDataGet(psInst->ui32USBBase, psInst->ui8BulkOUTEndpoint,
+                           pui8Data, &ui32Size);
+    MAP_USBDevEndpointDataAck(psInst->ui32USBBase, psInst->ui8BulkOUTEndpoint,
+                              true);
+
+    RxTransferDone(psCDCDevice, ui32Size);
+}
+
 //*****************************************************************************
 //
 // Receives notifications related to data received from the host.
@@ -1102,11 +1335,48 @@ ProcessDataFromHost(tUSBDCDCDevice *psCDCDevice, uint32_t ui32Status)
                                   psInst->ui8BulkOUTEndpoint,
                                   ui32EPStatus);
 
+    //
+    // If a packet of a receive transfer is being read by DMA, wait for the
+    // DMA to complete and account for the packet.  The next packet may
+    // already have arrived, so the endpoint status is read again.
+    //
+    if(psInst->ui32XferFlags & CDC_XFER_RX_DMA)
+    {
+        if(!(USBLibDMAChannelStatus(psInst->psDMAInstance,
+                                    psInst->ui8OUTDMA) &
+             USBLIBSTATUS_DMA_COMPLETE))
+        {
+            return(true);
+        }
+
+        psInst->ui32XferFlags &= ~CDC_XFER_RX_DMA;
+        MAP_USBEndpointDMADisable(psInst->ui32USBBase,
+                                  psInst->ui8BulkOUTEndpoint, USB_EP_DEV_OUT);
+
+        RxTransferDone(psCDCDevice, g_ui16MaxPacketSize);
+
+        ui32EPStatus = MAP_USBEndpointStatus(psInst->ui32USBBase,
+                                             psInst->ui8BulkOUTEndpoint);
+    }
+
     //
     // Has a packet been received?
     //
     if(ui32EPStatus & USB_DEV_RX_PKT_RDY)
     {
+        //
+        // If a receive transfer is in progress, read the packet into it
+        // unless the receive channel is blocked, in which case the packet is
+        // read during tick processing.
+        //
+        if(psInst->ui32XferFlags & CDC_XFER_RX)
+        {
+            SetDeferredOpFlag(&psInst->ui16DeferredOpFlags, CDC_DO_PACKET_RX,
+                              true);
+            RxTransferNext(psCDCDevice);
+            return(true);
+        }
+
         //
         // Set the flag we use to indicate that a packet read is pending.  This
         // will be cleared if the packet is read.  If the client doesn't read
@@ -1270,6 +1540,31 @@ ProcessDataToHost(tUSBDCDCDevice *psCDCDevice, uint32_t ui32Status)
     MAP_USBDevEndpointStatusClear(psInst->ui32USBBase,
                                   psInst->ui8BulkINEndpoint, ui32EPStatus);
 
+    //
+    // If a transmit transfer is in progress, move it on once any DMA that
+    // it started has completed.
+    //
+    if(psInst->ui32XferFlags & CDC_XFER_TX)
+    {
+        if(psInst->ui32XferFlags & CDC_XFER_TX_DMA)
+        {
+            if(!(USBLibDMAChannelStatus(psInst->psDMAInstance,
+                                        psInst->ui8INDMA) &
+                 USBLIBSTATUS_DMA_COMPLETE))
+            {
+                return(true);
+            }
+
+            psInst->ui32XferFlags &= ~CDC_XFER_TX_DMA;
+            MAP_USBEndpointDMADisable(psInst->ui32USBBase,
+                                      psInst->ui8BulkINEndpoint,
+                                      USB_EP_DEV_IN);
+        }
+
+        TxTransferNext(psCDCDevice);
+        return(true);
+    }
+
     //
     // Our last transmission completed.  Clear our state back to idle and
     // see if we need to send any more data.
@@ -1357,9 +1652,13 @@ HandleEndpoints(void *pvCDCDevice, uint32_t ui32Status)
     }
 
     //
-    // Handler for the bulk OUT data endpoint.
+    // Handler for the bulk OUT data endpoint, or for the completion of a DMA
+    // transfer on it.
     //
-    if(ui32Status & (0x10000 << USBEPToIndex(psInst->ui8BulkOUTEndpoint)))
+    if((ui32Status & (0x10000 << USBEPToIndex(psInst->ui8BulkOUTEndpoint))) ||
+       ((psInst->ui32XferFlags & CDC_XFER_RX_DMA) &&
+        (USBLibDMAChannelStatus(psInst->psDMAInstance, psInst->ui8OUTDMA) &
+         USBLIBSTATUS_DMA_COMPLETE)))
     {
         //
         // Data is being sent to us from the host.
@@ -1368,9 +1667,13 @@ HandleEndpoints(void *pvCDCDevice, uint32_t ui32Status)
     }
 
     //
-    // Handler for the bulk IN data endpoint.
+    // Handler for the bulk IN data endpoint, or for the completion of a DMA
+    // transfer on it.
     //
-    if(ui32Status & (1 << USBEPToIndex(psInst->ui8BulkINEndpoint)))
+    if((ui32Status & (1 << USBEPToIndex(psInst->ui8BulkINEndpoint))) ||
+       ((psInst->ui32XferFlags & CDC_XFER_TX_DMA) &&
+        (USBLibDMAChannelStatus(psInst->psDMAInstance, psInst->ui8INDMA) &
+         USBLIBSTATUS_DMA_COMPLETE)))
     {
         ProcessDataToHost(psCDCDeviceInst, ui32Status);
     }
@@ -1386,6 +1689,7 @@ HandleConfigChange(void *pvCDCDevice, uint32_t ui32Info)
 {
     tCDCSerInstance *psInst;
     tUSBDCDCDevice *psCDCDevice;
+    uint16_t ui16MaxPacketSize;
 
     ASSERT(pvCDCDevice != 0);
 
@@ -1399,6 +1703,34 @@ HandleConfigChange(void *pvCDCDevice, uint32_t ui32Info)
     //
     psInst = &psCDCDevice->sPrivateData;
 
+    //
+    // The host may have configured the device at a speed other than the one
+    // chosen when the class was initialized, so take the packet size from the
+    // configuration in use.  A DMA channel set up for the other packet size
+    // is released and allocated again by the next transfer.
+    //
+    ui16MaxPacketSize = ((psInst->sDevInfo.ppsConfigDescriptors ==
+                          g_ppCDCSerConfigDescriptorsHS) ||
+                         (psInst->sDevInfo.ppsConfigDescriptors ==
+                          g_pCDCCompSerConfigDescriptorsHS)) ?
+                        DATA_IN_EP_MAX_SIZE_HS : DATA_IN_EP_MAX_SIZE;
+
+    if(ui16MaxPacketSize != g_ui16MaxPacketSize)
+    {
+        g_ui16MaxPacketSize = ui16MaxPacketSize;
+
+        if(psInst->ui8INDMA != 0)
+        {
+            USBLibDMAChannelRelease(psInst->psDMAInstance, psInst->ui8INDMA);
+            psInst->ui8INDMA = 0;
+        }
+        if(psInst->ui8OUTDMA != 0)
+        {
+            USBLibDMAChannelRelease(psInst->psDMAInstance, psInst->ui8OUTDMA);
+            psInst->ui8OUTDMA = 0;
+        }
+    }
+
     //
     // Set all our endpoints to idle state.
     //
@@ -1406,6 +1738,7 @@ HandleConfigChange(void *pvCDCDevice, uint32_t ui32Info)
     psInst->iCDCRequestState = eCDCStateIdle;
     psInst->iCDCRxState = eCDCStateIdle;
     psInst->iCDCTxState = eCDCStateIdle;
+    psInst->ui32XferFlags = 0;
 
     //
     // If we are not currently connected so let the client know we are open
@@ -1603,6 +1936,17 @@ HandleDevice(void *pvCDCDevice, uint32_t ui32Request, void *pvRequestData)
                 {
                     psInst->ui8BulkINEndpoint =
                         IndexToUSBEP((pui8Data[1] & 0x7f));
+
+                    //
+                    // Release any DMA channel allocated to the old endpoint.
+                    // A channel is allocated again when it is first needed.
+                    //
+                    if(psInst->ui8INDMA != 0)
+                    {
+                        USBLibDMAChannelRelease(psInst->psDMAInstance,
+                                                psInst->ui8INDMA);
+                        psInst->ui8INDMA = 0;
+                    }
                 }
             }
             else
@@ -1612,6 +1956,13 @@ HandleDevice(void *pvCDCDevice, uint32_t ui32Request, void *pvRequestData)
                 //
                 psInst->ui8BulkOUTEndpoint =
                     IndexToUSBEP(pui8Data[1] & 0x7f);
+
+                if(psInst->ui8OUTDMA != 0)
+                {
+                    USBLibDMAChannelRelease(psInst->psDMAInstance,
+                                            psInst->ui8OUTDMA);
+                    psInst->ui8OUTDMA = 0;
+                }
             }
             break;
         }
@@ -2009,9 +2360,11 @@ HandleDisconnect(void *pvCDCDevice)
     }
 
     //
-    // Remember that we are no longer connected.
+    // Remember that we are no longer connected.  Any transfers in progress
+    // are abandoned.
     //
     psInst->bConnected = false;
+    psInst->ui32XferFlags = 0;
 }
 
 //*****************************************************************************
@@ -2194,10 +2547,19 @@ CDCTickHandler(void *pvCDCDevice, uint32_t ui32TimemS)
         //
         if(!psInst->bRxBlocked)
         {
+            //
+            // Do we have a deferred receive waiting for a receive transfer?
+            //
+            if((psInst->ui16DeferredOpFlags & (1 << CDC_DO_PACKET_RX)) &&
+               (psInst->ui32XferFlags & CDC_XFER_RX))
+            {
+                RxTransferNext(psCDCDevice);
+            }
+
             //
             // Do we have a deferred receive waiting
             //
-            if(psInst->ui16DeferredOpFlags & (1 << CDC_DO_PACKET_RX))
+            else if(psInst->ui16DeferredOpFlags & (1 << CDC_DO_PACKET_RX))
             {
                 //
                 // Yes - how big is the waiting packet?
@@ -2289,16 +2651,20 @@ USBDCDCCompositeInit(uint32_t ui32Index, tUSBDCDCDevice *psCDCDevice,
     if(psCompEntry == 0)
     {
         psInst->sDevInfo.ppsConfigDescriptors = g_ppCDCSerConfigDescriptors;
+        psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
 
         if(USBLIB_FEATURE_ULPI_HS == ui32ulpiFeature)
         {
             psInst->sDevInfo.ppsConfigDescriptors = g_ppCDCSerConfigDescriptorsHS;
+            psInst->sDevInfo.ppsOtherSpeedDescriptors =
+                                                g_ppCDCSerConfigDescriptors;
             g_ui16MaxPacketSize = USBFIFOSizeToBytes(USB_FIFO_SZ_512);
         }
     }
     else
     {
         psInst->sDevInfo.ppsConfigDescriptors = g_pCDCCompSerConfigDescriptors;
+        psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
         if(USBLIB_FEATURE_ULPI_HS == ui32ulpiFeature)
         {
             psInst->sDevInfo.ppsConfigDescriptors = g_pCDCCompSerConfigDescriptorsHS;
@@ -2338,6 +2704,10 @@ USBDCDCCompositeInit(uint32_t ui32Index, tUSBDCDCDevice *psCDCDevice,
     psInst->bRxBlocked = false;
     psInst->bControlBlocked = false;
     psInst->bConnected = false;
+    psInst->ui32XferFlags = 0;
+    psInst->psDMAInstance = USBLibDMAInit(0);
+    psInst->ui8INDMA = 0;
+    psInst->ui8OUTDMA = 0;
 
     //
     // Initialize the device info structure for the serial device.
@@ -2459,12 +2829,6 @@ USBDCDCInit(uint32_t ui32Index, tUSBDCDCDevice *psCDCDevice)
         //
         psInst->ui8ControlEndpoint = CONTROL_ENDPOINT;
 
-        //
-        // Use the configuration descriptor with the interrupt control
-        // endpoint.
-        //
-        psInst->sDevInfo.ppsConfigDescriptors = g_ppCDCSerConfigDescriptors;
-
         //
         // All is well so now pass the descriptors to the lower layer and put
         // the CDC device on the bus.
@@ -3001,6 +3365,181 @@ USBDCDCRxPacketAvailable(void *pvCDCDevice)
     }
 }
 
+//*****************************************************************************
+//
+//! Transmits a buffer of any length to the USB host via the CDC data
+//! interface.
+//!
+//! \param pvCDCDevice is the pointer to the device instance structure as
+//! returned by USBDCDCInit().
+//! \param pui8Data points to the first byte of data which is to be
+//! transmitted.  The data must remain valid until the transfer completes.
+//! \param ui32Length is the number of bytes of data to transmit.
+//!
+//! This function schedules the whole buffer for transmission as a single USB
+//! transfer.  The data is split into packets from the USB interrupt, using
+//! DMA for whole packets if the buffer is word aligned, and a zero-length
+//! packet is sent after the data only if \e ui32Length is a multiple of the
+//! maximum packet size.  A single \b USB_EVENT_TX_COMPLETE event, with the
+//! length of the transfer as its \e ui32MsgValue, is sent to the transmit
+//! channel callback when the host has acknowledged all of the data.  The
+//! callback may start the next transfer.
+//!
+//! A transfer may only be started when no packet or transfer transmission
+//! is outstanding, and USBDCDCPacketWrite() must not be called until it
+//! completes.
+//!
+//! \return Returns \e ui32Length if the transfer was started, or 0 if a
+//! transmission is already in progress.
+//
+//*****************************************************************************
+uint32_t
+USBDCDCTransferWrite(void *pvCDCDevice, const uint8_t *pui8Data,
+                      uint32_t ui32Length)
+{
+    tUSBDCDCDevice *psCDCDevice;
+    tCDCSerInstance *psInst;
+    bool bIntsOff;
+
+    ASSERT(pvCDCDevice);
+    ASSERT(pui8Data || !ui32Length);
+
+    psCDCDevice = (tUSBDCDCDevice *)pvCDCDevice;
+    psInst = &psCDCDevice->sPrivateData;
+
+    if(psInst->iCDCTxState != eCDCStateIdle)
+    {
+        return(0);
+    }
+
+    //
+    // Allocate a DMA channel to the IN endpoint the first time that it is
+    // needed.  If none is available, the transfer is sent from the FIFO.
+    //
+    if(psInst->ui8INDMA == 0)
+    {
+        psInst->ui8INDMA = USBLibDMAChannelAllocate(psInst->psDMAInstance,
+                                                    psInst->ui8BulkINEndpoint,
+                                                    g_ui16MaxPacketSize,
+                                                    USB_DMA_EP_TX |
+                                                    USB_DMA_EP_DEVICE);
+        if(psInst->ui8INDMA != 0)
+        {
+            USBLibDMAUnitSizeSet(psInst->psDMAInstance, psInst->ui8INDMA, 32);
+            USBLibDMAArbSizeSet(psInst->psDMAInstance, psInst->ui8INDMA, 16);
+        }
+    }
+
+    psInst->pui8TxXfer = pui8Data;
+    psInst->ui32TxXferRemaining = ui32Length;
+    psInst->ui32TxXferSize = ui32Length;
+    psInst->iCDCTxState = eCDCStateWaitData;
+
+    //
+    // Start the transfer with the USB interrupt masked, since the interrupt
+    // continues it.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    psInst->ui32XferFlags |= CDC_XFER_TX;
+    if((ui32Length % g_ui16MaxPacketSize) == 0)
+    {
+        psInst->ui32XferFlags |= CDC_XFER_TX_ZLP;
+    }
+    TxTransferNext(psCDCDevice);
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+
+    return(ui32Length);
+}
+
+//*****************************************************************************
+//
+//! Receives a transfer of any length from the USB host via the CDC data
+//! interface.
+//!
+//! \param pvCDCDevice is the pointer to the device instance structure as
+//! returned by USBDCDCInit().
+//! \param pui8Data points to the buffer into which the data is received.
+//! \param ui32Length is the size of the buffer, which must be a non-zero
+//! multiple of the maximum packet size.
+//!
+//! This function provides a buffer into which packets from the host are
+//! read from the USB interrupt, without the client being called for each
+//! packet.  Full packets are read by DMA if the buffer is word aligned.  The
+//! transfer completes when the host sends a short packet or the buffer is
+//! full, at which point a single \b USB_EVENT_RX_AVAILABLE event is sent to
+//! the receive channel callback with \e pvMsgData pointing to the buffer and
+//! \e ui32MsgValue holding the number of bytes received.  The callback may
+//! provide the next buffer.
+//!
+//! \return Returns \e ui32Length if the transfer was started, or 0 if a
+//! receive transfer is already in progress or the buffer size is not valid.
+//
+//*****************************************************************************
+uint32_t
+USBDCDCTransferRead(void *pvCDCDevice, uint8_t *pui8Data,
+                     uint32_t ui32Length)
+{
+    tUSBDCDCDevice *psCDCDevice;
+    tCDCSerInstance *psInst;
+    bool bIntsOff;
+
+    ASSERT(pvCDCDevice);
+    ASSERT(pui8Data);
+
+    psCDCDevice = (tUSBDCDCDevice *)pvCDCDevice;
+    psInst = &psCDCDevice->sPrivateData;
+
+    if((psInst->ui32XferFlags & CDC_XFER_RX) || (ui32Length == 0) ||
+       (ui32Length % g_ui16MaxPacketSize))
+    {
+        return(0);
+    }
+
+    //
+    // Allocate a DMA channel to the bulk OUT endpoint the first time that it
+    // is needed.  If none is available, the transfer is read from the FIFO.
+    //
+    if(psInst->ui8OUTDMA == 0)
+    {
+        psInst->ui8OUTDMA =
+            USBLibDMAChannelAllocate(psInst->psDMAInstance,
+                                     psInst->ui8BulkOUTEndpoint,
+                                     g_ui16MaxPacketSize,
+                                     USB_DMA_EP_RX | USB_DMA_EP_DEVICE);
+        if(psInst->ui8OUTDMA != 0)
+        {
+            USBLibDMAUnitSizeSet(psInst->psDMAInstance, psInst->ui8OUTDMA,
+                                 32);
+            USBLibDMAArbSizeSet(psInst->psDMAInstance, psInst->ui8OUTDMA, 16);
+        }
+    }
+
+    psInst->pui8RxXfer = pui8Data;
+    psInst->ui32RxXferSize = ui32Length;
+    psInst->ui32RxXferCount = 0;
+
+    //
+    // Start the transfer, reading any packet that is already waiting, with
+    // the USB interrupt masked.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    psInst->ui32XferFlags |= CDC_XFER_RX;
+    RxTransferNext(psCDCDevice);
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+
+    return(ui32Length);
+}
+
 //*****************************************************************************
 //
 //! Informs the CDC module of changes in the serial control line states or
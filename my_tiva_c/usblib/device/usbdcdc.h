@@ -203,6 +203,35 @@ typedef struct
     // composite devices.
     //
     uint8_t ui8InterfaceData;
+
+    //
+    // The state of the transfer-level transmit and receive operations.
+    //
+    volatile uint32_t ui32XferFlags;
+
+    //
+    // The next byte to send, the number of bytes remaining and the size of
+    // the transfer in progress on the bulk IN endpoint.
+    //
+    const uint8_t *pui8TxXfer;
+    uint32_t ui32TxXferRemaining;
+    uint32_t ui32TxXferSize;
+
+    //
+    // The buffer, its size and the number of bytes received so far for the
+    // transfer in progress on the bulk OUT endpoint.
+    //
+    uint8_t *pui8RxXfer;
+    uint32_t ui32RxXferSize;
+    uint32_t ui32RxXferCount;
+
+    //
+    // The DMA instance and the DMA channels used for the bulk IN and OUT
+    // endpoints, or 0 if no channel has been allocated yet.
+    //
+    tUSBDMAInstance *psDMAInstance;
+    uint8_t ui8INDMA;
+    uint8_t ui8OUTDMA;
 }
 tCDCSerInstance;
 
@@ -411,6 +440,11 @@ extern uint32_t USBDCDCPacketRead(void *pvCDCDevice, uint8_t *pi8Data,
                                   uint32_t ui32Length, bool bLast);
 extern uint32_t USBDCDCTxPacketAvailable(void *pvCDCDevice);
 extern uint32_t USBDCDCRxPacketAvailable(void *pvCDCDevice);
+extern uint32_t USBDCDCTransferWrite(void *pvCDCDevice,
+                                     const uint8_t *pui8Data,
+                                     uint32_t ui32Length);
+extern uint32_t USBDCDCTransferRead(void *pvCDCDevice, uint8_t *pui8Data,
+                                    uint32_t ui32Length);
 extern void USBDCDCSerialStateChange(void *pvCDCDevice, uint16_t ui16State);
 extern bool USBDCDCRemoteWakeupRequest(void *pvCDCDevice);
 
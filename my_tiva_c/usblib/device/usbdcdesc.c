@@ -116,6 +116,43 @@ NextConfigDescGet(const tConfigHeader *psConfig, uint32_t *pui32Sec,
     return(psDesc);
 }
 
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Finds the compiled cache registered for a configuration descriptor.
+//!
+//! \param psConfig points to the header structure for the configuration
+//! descriptor whose cache is to be found.
+//!
+//! This function searches the list of caches registered using
+//! USBDCDConfigCacheInit() for one built from \e psConfig.
+//!
+//! \return Returns a pointer to the cache or NULL if no cache has been
+//! registered for the configuration descriptor.
+//
+//*****************************************************************************
+const tConfigCache *
+USBDCDConfigCacheFind(const tConfigHeader *psConfig)
+{
+    const tConfigCache *psCache;
+
+    //
+    // Walk the list of registered caches looking for one built from this
+    // configuration descriptor.
+    //
+    for(psCache = g_psDCDInst[0].psConfigCache; psCache;
+        psCache = psCache->psNext)
+    {
+        if(psCache->psConfig == psConfig)
+        {
+            break;
+        }
+    }
+
+    return(psCache);
+}
+
 //*****************************************************************************
 //
 //! \internal
@@ -146,6 +183,7 @@ ConfigAlternateInterfaceGet(const tConfigHeader *psConfig,
                             uint32_t *pui32Section)
 {
     tDescriptorHeader *psDescCheck;
+    const tConfigCache *psCache;
     uint32_t ui32Count, ui32Sec;
 
     //
@@ -155,6 +193,35 @@ ConfigAlternateInterfaceGet(const tConfigHeader *psConfig,
     ui32Count = 0;
     ui32Sec = 0;
 
+    //
+    // If this configuration has been compiled, only the interface
+    // descriptors need to be checked.
+    //
+    psCache = USBDCDConfigCacheFind(psConfig);
+
+    if(psCache)
+    {
+        for(ui32Sec = 0; ui32Sec < psCache->ui8NumInterfaces; ui32Sec++)
+        {
+            psDescCheck =
+                (tDescriptorHeader *)psCache->psInterfaces[ui32Sec].psDesc;
+
+            if(((tInterfaceDescriptor *)psDescCheck)->bInterfaceNumber ==
+               ui8InterfaceNumber)
+            {
+                if(ui32Count == ui32Index)
+                {
+                    *pui32Section = psCache->psInterfaces[ui32Sec].ui8Section;
+                    return((tInterfaceDescriptor *)psDescCheck);
+                }
+
+                ui32Count++;
+            }
+        }
+
+        return((tInterfaceDescriptor *)0);
+    }
+
     //
     // Keep looking through the supplied data until we reach the end.
     //
@@ -220,8 +287,19 @@ ConfigAlternateInterfaceGet(const tConfigHeader *psConfig,
 uint32_t
 USBDCDConfigDescGetSize(const tConfigHeader *psConfig)
 {
+    const tConfigCache *psCache;
     uint32_t ui32Loop, ui32Len;
 
+    //
+    // If this configuration has been compiled, the size is already known.
+    //
+    psCache = USBDCDConfigCacheFind(psConfig);
+
+    if(psCache)
+    {
+        return(psCache->ui16Size);
+    }
+
     ui32Len = 0;
 
     //
@@ -267,8 +345,27 @@ USBDCDConfigDescGetSize(const tConfigHeader *psConfig)
 uint32_t
 USBDCDConfigDescGetNum(const tConfigHeader *psConfig, uint32_t ui32Type)
 {
+    const tConfigCache *psCache;
     uint32_t ui32Section, ui32NumDescs;
 
+    //
+    // If this configuration has been compiled, the number of interface and
+    // endpoint descriptors is already known.
+    //
+    psCache = USBDCDConfigCacheFind(psConfig);
+
+    if(psCache)
+    {
+        if(ui32Type == USB_DTYPE_INTERFACE)
+        {
+            return(psCache->ui8NumInterfaces);
+        }
+        else if(ui32Type == USB_DTYPE_ENDPOINT)
+        {
+            return(psCache->ui8NumEndpoints);
+        }
+    }
+
     //
     // Initialize our counts.
     //
@@ -324,8 +421,39 @@ tDescriptorHeader *
 USBDCDConfigDescGet(const tConfigHeader *psConfig, uint32_t ui32Type,
                     uint32_t ui32Index, uint32_t *pui32Section)
 {
+    const tConfigCacheEntry *psEntry;
+    const tConfigCache *psCache;
     uint32_t ui32Section, ui32TotalDescs, ui32NumDescs;
 
+    //
+    // If this configuration has been compiled, interface and endpoint
+    // descriptors can be found directly from the cache index.
+    //
+    psCache = USBDCDConfigCacheFind(psConfig);
+
+    if(psCache && ((ui32Type == USB_DTYPE_INTERFACE) ||
+                   (ui32Type == USB_DTYPE_ENDPOINT)))
+    {
+        if(ui32Type == USB_DTYPE_INTERFACE)
+        {
+            psEntry = psCache->psInterfaces;
+            ui32NumDescs = psCache->ui8NumInterfaces;
+        }
+        else
+        {
+            psEntry = psCache->psEndpoints;
+            ui32NumDescs = psCache->ui8NumEndpoints;
+        }
+
+        if(ui32Index >= ui32NumDescs)
+        {
+            return((tDescriptorHeader *)0);
+        }
+
+        *pui32Section = psEntry[ui32Index].ui8Section;
+        return((tDescriptorHeader *)psEntry[ui32Index].psDesc);
+    }
+
     //
     // Initialize our counts.
     //
@@ -412,6 +540,7 @@ USBDCDConfigGetNumAlternateInterfaces(const tConfigHeader *psConfig,
                                       uint8_t ui8InterfaceNumber)
 {
     tDescriptorHeader *psDescCheck;
+    const tConfigCache *psCache;
     uint32_t ui32Count, ui32Sec;
 
     //
@@ -421,6 +550,27 @@ USBDCDConfigGetNumAlternateInterfaces(const tConfigHeader *psConfig,
     ui32Sec = 0;
     ui32Count = 0;
 
+    //
+    // If this configuration has been compiled, only the interface
+    // descriptors need to be checked.
+    //
+    psCache = USBDCDConfigCacheFind(psConfig);
+
+    if(psCache)
+    {
+        for(ui32Sec = 0; ui32Sec < psCache->ui8NumInterfaces; ui32Sec++)
+        {
+            if(((tInterfaceDescriptor *)
+                psCache->psInterfaces[ui32Sec].psDesc)->bInterfaceNumber ==
+               ui8InterfaceNumber)
+            {
+                ui32Count++;
+            }
+        }
+
+        return(ui32Count);
+    }
+
     //
     // Keep looking through the supplied data until we reach the end.
     //
@@ -563,8 +713,53 @@ USBDCDConfigGetInterfaceEndpoint(const tConfigHeader *psConfig,
 {
     tInterfaceDescriptor *psInterface;
     tDescriptorHeader *psEndpoint;
+    const tConfigCache *psCache;
     uint32_t ui32Section, ui32Count;
 
+    //
+    // If this configuration has been compiled, the endpoints of each
+    // interface are found directly from the cache index.
+    //
+    psCache = USBDCDConfigCacheFind(psConfig);
+
+    if(psCache)
+    {
+        ui32Count = 0;
+
+        for(ui32Section = 0; ui32Section < psCache->ui8NumInterfaces;
+            ui32Section++)
+        {
+            psInterface = (tInterfaceDescriptor *)
+                                psCache->psInterfaces[ui32Section].psDesc;
+
+            if(psInterface->bInterfaceNumber != ui32InterfaceNumber)
+            {
+                continue;
+            }
+
+            //
+            // Is this the requested alternate setting for the interface?
+            //
+            if(ui32Count++ == ui32AltCfg)
+            {
+                ui32Count =
+                    psCache->psInterfaces[ui32Section].ui8FirstEndpoint +
+                    ui32Index;
+
+                if((ui32Index >= psInterface->bNumEndpoints) ||
+                   (ui32Count >= psCache->ui8NumEndpoints))
+                {
+                    break;
+                }
+
+                return((tEndpointDescriptor *)
+                       psCache->psEndpoints[ui32Count].psDesc);
+            }
+        }
+
+        return((tEndpointDescriptor *)0);
+    }
+
     //
     // Find the requested interface descriptor.
     //
@@ -635,6 +830,188 @@ USBDCDConfigGetInterfaceEndpoint(const tConfigHeader *psConfig,
 
 }
 
+//*****************************************************************************
+//
+//! Determines the size of the workspace needed to compile a configuration
+//! descriptor.
+//!
+//! \param psConfig points to the header structure for the configuration
+//! descriptor which is to be compiled.
+//!
+//! This function returns the number of bytes of workspace that must be
+//! passed to USBDCDConfigCacheInit() in order to compile the configuration
+//! descriptor described by \e psConfig.
+//!
+//! \return Returns the number of bytes of workspace required.
+//
+//*****************************************************************************
+uint32_t
+USBDCDConfigCacheSize(const tConfigHeader *psConfig)
+{
+    uint32_t ui32Size;
+
+    //
+    // The descriptor data is rounded up to a whole number of words and is
+    // followed by one index entry for each interface and endpoint descriptor.
+    //
+    ui32Size = (USBDCDConfigDescGetSize(psConfig) + 3) & ~3;
+    ui32Size += (USBDCDConfigDescGetNum(psConfig, USB_DTYPE_INTERFACE) +
+                 USBDCDConfigDescGetNum(psConfig, USB_DTYPE_ENDPOINT)) *
+                sizeof(tConfigCacheEntry);
+
+    return(ui32Size);
+}
+
+//*****************************************************************************
+//
+//! Compiles a configuration descriptor and registers it with the USB library.
+//!
+//! \param ui32Index is the index of the USB controller which publishes the
+//! configuration descriptor.
+//! \param psConfig points to the header structure for the configuration
+//! descriptor which is to be compiled.
+//! \param psCache points to the structure that holds the compiled
+//! configuration descriptor.
+//! \param pui8Workspace points to a word aligned block of RAM which holds
+//! the compiled descriptor data and its index.
+//! \param ui32Size is the size of the block pointed to by \e pui8Workspace.
+//! This must be at least the value returned by USBDCDConfigCacheSize().
+//!
+//! This function concatenates the sections making up a configuration
+//! descriptor into a single block of descriptor data and builds an index of
+//! the interface and endpoint descriptors it contains.  Once registered, the
+//! USB library sends the compiled descriptor in response to GET_DESCRIPTOR
+//! requests and uses the index when configuring endpoints for
+//! SET_CONFIGURATION and SET_INTERFACE requests rather than walking the
+//! configuration descriptor sections each time.
+//!
+//! The function may be called for each configuration in the
+//! <tt>ppsConfigDescriptors</tt> array for the device, typically after the
+//! device class has been initialized.  The configuration descriptor, \e
+//! psCache and \e pui8Workspace must remain unchanged until USBDCDTerm() is
+//! called, which discards all registered caches.
+//!
+//! \return Returns \b true if the configuration descriptor was compiled and
+//! registered or \b false if the workspace is too small, the configuration
+//! descriptor contains too many interfaces or endpoints or a cache has
+//! already been registered for it.
+//
+//*****************************************************************************
+bool
+USBDCDConfigCacheInit(uint32_t ui32Index, const tConfigHeader *psConfig,
+                      tConfigCache *psCache, uint8_t *pui8Workspace,
+                      uint32_t ui32Size)
+{
+    tDescriptorHeader *psDesc;
+    tConfigCacheEntry *psInterfaces, *psEndpoints;
+    uint32_t ui32Sec, ui32Idx, ui32Len, ui32NumInterfaces, ui32NumEndpoints;
+
+    ASSERT(ui32Index == 0);
+    ASSERT(psConfig != 0);
+    ASSERT(psCache != 0);
+    ASSERT(((uint32_t)pui8Workspace & 3) == 0);
+
+    //
+    // Only one cache may be registered for each configuration descriptor.
+    //
+    if(USBDCDConfigCacheFind(psConfig))
+    {
+        return(false);
+    }
+
+    //
+    // Make sure that the workspace is large enough and that the number of
+    // descriptors fits in the index.
+    //
+    ui32Len = USBDCDConfigDescGetSize(psConfig);
+    ui32NumInterfaces = USBDCDConfigDescGetNum(psConfig, USB_DTYPE_INTERFACE);
+    ui32NumEndpoints = USBDCDConfigDescGetNum(psConfig, USB_DTYPE_ENDPOINT);
+
+    if((ui32Size < USBDCDConfigCacheSize(psConfig)) || (ui32Len > 0xFFFF) ||
+       (ui32NumInterfaces > 0xFF) || (ui32NumEndpoints > 0xFF))
+    {
+        return(false);
+    }
+
+    //
+    // The index follows the descriptor data in the workspace.
+    //
+    psInterfaces = (tConfigCacheEntry *)(pui8Workspace + ((ui32Len + 3) & ~3));
+    psEndpoints = psInterfaces + ui32NumInterfaces;
+
+    //
+    // Concatenate the sections into the workspace.
+    //
+    ui32Len = 0;
+
+    for(ui32Sec = 0; ui32Sec < psConfig->ui8NumSections; ui32Sec++)
+    {
+        for(ui32Idx = 0; ui32Idx < psConfig->psSections[ui32Sec]->ui16Size;
+            ui32Idx++)
+        {
+            pui8Workspace[ui32Len++] =
+                            psConfig->psSections[ui32Sec]->pui8Data[ui32Idx];
+        }
+    }
+
+    //
+    // Fix up the total length of the configuration descriptor, which is
+    // otherwise done each time the descriptor is sent.
+    //
+    ((tConfigDescriptor *)pui8Workspace)->wTotalLength = (uint16_t)ui32Len;
+
+    //
+    // Walk the configuration descriptor once to build the index of interface
+    // and endpoint descriptors.
+    //
+    psDesc = (tDescriptorHeader *)psConfig->psSections[0]->pui8Data;
+    ui32NumInterfaces = 0;
+    ui32NumEndpoints = 0;
+    ui32Sec = 0;
+
+    while(psDesc)
+    {
+        if(psDesc->bDescriptorType == USB_DTYPE_INTERFACE)
+        {
+            psInterfaces[ui32NumInterfaces].psDesc = psDesc;
+            psInterfaces[ui32NumInterfaces].ui8Section = (uint8_t)ui32Sec;
+            psInterfaces[ui32NumInterfaces].ui8FirstEndpoint =
+                                                    (uint8_t)ui32NumEndpoints;
+            ui32NumInterfaces++;
+        }
+        else if(psDesc->bDescriptorType == USB_DTYPE_ENDPOINT)
+        {
+            psEndpoints[ui32NumEndpoints].psDesc = psDesc;
+            psEndpoints[ui32NumEndpoints].ui8Section = (uint8_t)ui32Sec;
+            psEndpoints[ui32NumEndpoints].ui8FirstEndpoint = 0;
+            ui32NumEndpoints++;
+        }
+
+        psDesc = NextConfigDescGet(psConfig, &ui32Sec, psDesc);
+    }
+
+    //
+    // Fill in the cache structure.
+    //
+    psCache->psConfig = psConfig;
+    psCache->pui8Desc = pui8Workspace;
+    psCache->ui16Size = (uint16_t)ui32Len;
+    psCache->ui8NumInterfaces = (uint8_t)ui32NumInterfaces;
+    psCache->ui8NumEndpoints = (uint8_t)ui32NumEndpoints;
+    psCache->psInterfaces = psInterfaces;
+    psCache->psEndpoints = psEndpoints;
+
+    //
+    // Add the cache to the head of the list.  The cache is complete before
+    // the list head is written so the interrupt handler never sees a
+    // partially built cache.
+    //
+    psCache->psNext = g_psDCDInst[0].psConfigCache;
+    g_psDCDInst[0].psConfigCache = psCache;
+
+    return(true);
+}
+
 //*****************************************************************************
 //
 // Close the Doxygen group.
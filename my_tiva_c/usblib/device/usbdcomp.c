@@ -27,6 +27,7 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/rom.h"
 #include "driverlib/rom_map.h"
@@ -36,6 +37,7 @@
 #include "usblib/usb-ids.h"
 #include "usblib/usbcdc.h"
 #include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdevicepriv.h"
 #include "usblib/device/usbdcdc.h"
 #include "usblib/device/usbdcomp.h"
 
@@ -106,20 +108,15 @@ static const uint8_t g_pui8CompConfigDescriptor[] =
 
 //****************************************************************************
 //
-// Byte offsets used to access various fields in our index/interface/endpoint
-// lookup table (tUSBDCompositeDevice.pui32DeviceWorkspace).  This workspace
-// contains one 4 byte entry per device. The LSB is the device index, next byte
-// is the number of the first interface not within this device, next byte is
-// the number of the first IN endpoint not within this device and the final
-// byte is the number of the first OUT endpoint not within this device.  Using
-// this simple table we can reasonably quickly cross-reference index with
-// interface and endpoint numbers.
+// The per-device workspace (tCompositeEntry.ui32DeviceWorkspace) holds the
+// endpoint interrupt status bits, in the format returned by
+// USBIntStatusEndpoint(), of all the endpoints owned by the device.  IN
+// endpoint n uses bit n and OUT endpoint n uses bit n + 16.  This allows an
+// endpoint event to be passed only to the devices which need to service it.
 //
 //****************************************************************************
-#define LOOKUP_INDEX_BYTE       0
-#define LOOKUP_INTERFACE_BYTE   1
-#define LOOKUP_IN_END_BYTE      2
-#define LOOKUP_OUT_END_BYTE     3
+#define EP_MASK_IN(ui32EP)      (1 << (ui32EP))
+#define EP_MASK_OUT(ui32EP)     (1 << ((ui32EP) + 16))
 
 //****************************************************************************
 //
@@ -128,6 +125,14 @@ static const uint8_t g_pui8CompConfigDescriptor[] =
 //****************************************************************************
 #define INVALID_DEVICE_INDEX    0xFFFFFFFF
 
+//****************************************************************************
+//
+// The marker used in the interface and endpoint lookup tables for numbers
+// which are not owned by any device.
+//
+//****************************************************************************
+#define INVALID_MAP_ENTRY       0xFF
+
 //****************************************************************************
 //
 // Various internal handlers needed by this class.
@@ -225,9 +230,9 @@ const tCustomHandlers g_sCompHandlers =
 
 //****************************************************************************
 //
-// Use the lookup table from the field pui32DeviceWorkspace in the
-// tUSBDCompositeDevice structure to determine which device to call given a
-// particular composite device interface number.
+// Use the interface lookup table built by BuildCompositeDescriptor() to
+// determine which device to call given a particular composite device
+// interface number.
 //
 // The returned value is the index into psDevice->tCompositeEntry indicating
 // the device which contains this interface or INVALID_DEVICE_INDEX if no
@@ -237,43 +242,32 @@ const tCustomHandlers g_sCompHandlers =
 static uint32_t
 InterfaceToIndex(tUSBDCompositeDevice *psDevice, uint32_t ui32Interface)
 {
-    uint32_t ui32Loop;
     uint32_t ui32Lookup;
 
     //
-    // Check each lookup entry in turn.
+    // Interface numbers beyond the end of the table are not owned by any
+    // device.
     //
-    for(ui32Loop = 0; ui32Loop < psDevice->ui32NumDevices; ui32Loop++)
+    if(ui32Interface >= COMPOSITE_MAX_INTERFACES)
     {
-        //
-        // Get the look up value from the device.
-        //
-        ui32Lookup = psDevice->psDevices[ui32Loop].ui32DeviceWorkspace;
-        ui32Lookup = (ui32Lookup >> (8 * LOOKUP_INTERFACE_BYTE)) & 0xff;
+        return(INVALID_DEVICE_INDEX);
+    }
 
-        //
-        // If the desired interface number is lower than the value in the
-        // current lookup table entry, we have found the desired device so
-        // return its index.
-        //
-        if(ui32Interface < ui32Lookup)
-        {
-            return(ui32Loop);
-        }
+    ui32Lookup = psDevice->sPrivateData.pui8InterfaceMap[ui32Interface];
+
+    if(ui32Lookup == INVALID_MAP_ENTRY)
+    {
+        return(INVALID_DEVICE_INDEX);
     }
 
-    //
-    // If we get here, an invalid interface number was passed so return a
-    // marker to indicate this.
-    //
-    return(INVALID_DEVICE_INDEX);
+    return(ui32Lookup);
 }
 
 //****************************************************************************
 //
-// Use the lookup table from the field pui32DeviceWorkspace in the
-// tUSBDCompositeDevice structure to determine which device to call given a
-// particular composite device endpoint number.
+// Use the endpoint lookup tables built by BuildCompositeDescriptor() to
+// determine which device to call given a particular composite device
+// endpoint number.
 //
 // The returned value is the index into psDevice->tCompositeEntry indicating
 // the device which contains this endpoint or INVALID_DEVICE_INDEX if no
@@ -284,40 +278,77 @@ static uint32_t
 EndpointToIndex(tUSBDCompositeDevice *psDevice, uint32_t ui32Endpoint,
                 bool bInEndpoint)
 {
-    uint32_t ui32Loop, ui32EndpointByte, ui32Lookup;
+    uint32_t ui32Lookup;
 
     //
-    // Are we considering an IN or OUT endpoint?
+    // Endpoint numbers are only 4 bits so this should never happen.
     //
-    ui32EndpointByte = bInEndpoint ? LOOKUP_IN_END_BYTE : LOOKUP_OUT_END_BYTE;
+    if(ui32Endpoint >= COMPOSITE_MAX_ENDPOINTS)
+    {
+        return(INVALID_DEVICE_INDEX);
+    }
 
     //
-    // Check each lookup entry in turn.
+    // Are we considering an IN or OUT endpoint?
     //
-    for(ui32Loop = 0; ui32Loop < psDevice->ui32NumDevices; ui32Loop++)
+    if(bInEndpoint)
     {
-        //
-        // Get the look up byte from the device.
-        //
-        ui32Lookup = psDevice->psDevices[ui32Loop].ui32DeviceWorkspace;
-        ui32Lookup = (ui32Lookup >> (ui32EndpointByte * 8)) & 0xff;
+        ui32Lookup = psDevice->sPrivateData.pui8INEndpointMap[ui32Endpoint];
+    }
+    else
+    {
+        ui32Lookup = psDevice->sPrivateData.pui8OUTEndpointMap[ui32Endpoint];
+    }
+
+    if(ui32Lookup == INVALID_MAP_ENTRY)
+    {
+        return(INVALID_DEVICE_INDEX);
+    }
+
+    return(ui32Lookup);
+}
+
+//****************************************************************************
+//
+// Returns the endpoint interrupt status bits, in the format returned by
+// USBIntStatusEndpoint(), of the endpoints whose DMA transfers completed in
+// the interrupt being handled.  The completed status of a DMA channel is
+// kept until its next transfer starts, so only the channels reported by
+// this interrupt are used.  The direction of the DMA channel is not checked
+// so both the IN and OUT bits are set for each endpoint.
+//
+//****************************************************************************
+static uint32_t
+DMAEndpointMask(void)
+{
+    tUSBDMAInstance *psDMAInst;
+    uint32_t ui32Active, ui32Channel, ui32EP, ui32Mask;
+
+    ui32Mask = 0;
+    psDMAInst = g_psDCDInst[0].psDMAInstance;
 
+    if(psDMAInst == 0)
+    {
+        return(0);
+    }
+
+    ui32Active = g_psDCDInst[0].ui32DMAIntStatus;
+
+    for(ui32Channel = 0; ui32Active != 0; ui32Channel++)
+    {
         //
-        // If the desired endpoint number is lower than the value in the
-        // current lookup table entry, we have found the desired device so
-        // return its index.
+        // A non-zero endpoint indicates that the channel is allocated.
         //
-        if(ui32Endpoint < ui32Lookup)
+        if((ui32Active & 1) && psDMAInst->pui8Endpoint[ui32Channel])
         {
-            return(ui32Loop);
+            ui32EP = USBEPToIndex(psDMAInst->pui8Endpoint[ui32Channel]);
+            ui32Mask |= EP_MASK_IN(ui32EP) | EP_MASK_OUT(ui32EP);
         }
+
+        ui32Active >>= 1;
     }
 
-    //
-    // If we get here, an invalid endpoint number was passed so return a
-    // marker to indicate this.
-    //
-    return(INVALID_DEVICE_INDEX);
+    return(ui32Mask);
 }
 
 
@@ -399,6 +430,7 @@ GetDescriptor(void *pvCompositeInstance, tUSBRequest *psUSBRequest)
             // data notification callbacks to it.
             //
             psCompDevice->sPrivateData.ui32EP0Owner = ui32Idx;
+            psCompDevice->psDevices[ui32Idx].sStats.ui32Requests++;
 
             //
             // Call the device to retrieve the descriptor.
@@ -583,6 +615,7 @@ DataSent(void *pvCompositeInstance, uint32_t ui32Info)
 
         if(psDeviceInfo->psCallbacks->pfnDataSent)
         {
+            psCompDevice->psDevices[ui32Idx].sStats.ui32EP0Events++;
             psDeviceInfo->psCallbacks->pfnDataSent(
                 psCompDevice->psDevices[ui32Idx].pvInstance, ui32Info);
         }
@@ -619,6 +652,7 @@ DataReceived(void *pvCompositeInstance, uint32_t ui32Info)
 
         if(psDeviceInfo->psCallbacks->pfnDataReceived)
         {
+            psCompDevice->psDevices[ui32Idx].sStats.ui32EP0Events++;
             psDeviceInfo->psCallbacks->pfnDataReceived(
                 psCompDevice->psDevices[ui32Idx].pvInstance, ui32Info);
         }
@@ -634,9 +668,10 @@ DataReceived(void *pvCompositeInstance, uint32_t ui32Info)
 static void
 HandleEndpoints(void *pvCompositeInstance, uint32_t ui32Status)
 {
-    uint32_t ui32Idx;
+    uint32_t ui32Idx, ui32Service;
     const tDeviceInfo *psDeviceInfo;
     tUSBDCompositeDevice *psCompDevice;
+    tCompositeEntry *psEntry;
 
     ASSERT(pvCompositeInstance != 0);
 
@@ -646,20 +681,31 @@ HandleEndpoints(void *pvCompositeInstance, uint32_t ui32Status)
     psCompDevice = (tUSBDCompositeDevice *)pvCompositeInstance;
 
     //
-    // Call each of the endpoint handlers.  This may seem odd since we should
-    // only call the handler whose endpoint needs service.  Unfortunately, if
-    // the device class driver is using uDMA, we have no way of knowing which
-    // handler to call (since ui32Status will be 0).  Since the handlers are
-    // set up to ignore any callback that is not for them, this is safe.
+    // Only call the handlers of the devices owning an endpoint which needs
+    // service.  If a device class driver is using DMA, ui32Status does not
+    // indicate which endpoint completed a transfer so any endpoint whose DMA
+    // transfer completed in this interrupt also needs service.  Since
+    // the handlers are set up to ignore any callback that is not for them,
+    // calling a handler that has nothing to do is still safe.
     //
+    ui32Service = ui32Status | DMAEndpointMask();
+
     for(ui32Idx = 0; ui32Idx < psCompDevice->ui32NumDevices; ui32Idx++)
     {
-        psDeviceInfo = psCompDevice->psDevices[ui32Idx].psDevInfo;
+        psEntry = &psCompDevice->psDevices[ui32Idx];
+        psDeviceInfo = psEntry->psDevInfo;
 
         if(psDeviceInfo->psCallbacks->pfnEndpointHandler)
         {
-            psDeviceInfo->psCallbacks->pfnEndpointHandler(
-                psCompDevice->psDevices[ui32Idx].pvInstance, ui32Status);
+            if((psEntry->ui32DeviceWorkspace & ui32Service) == 0)
+            {
+                psEntry->sStats.ui32EndpointSkipped++;
+                continue;
+            }
+
+            psEntry->sStats.ui32EndpointEvents++;
+            psDeviceInfo->psCallbacks->pfnEndpointHandler(psEntry->pvInstance,
+                                                          ui32Status);
         }
     }
 }
@@ -797,7 +843,14 @@ InterfaceChange(void *pvCompositeInstance, uint8_t ui8InterfaceNum,
     // Create the device instance pointer.
     //
     psCompDevice = (tUSBDCompositeDevice *)pvCompositeInstance;
-    for(ui32Idx = 0; ui32Idx < psCompDevice->ui32NumDevices; ui32Idx++)
+
+    //
+    // Only the device which owns the interface needs to be told about the
+    // change.
+    //
+    ui32Idx = InterfaceToIndex(psCompDevice, ui8InterfaceNum);
+
+    if(ui32Idx != INVALID_DEVICE_INDEX)
     {
         psDeviceInfo = psCompDevice->psDevices[ui32Idx].psDevInfo;
 
@@ -939,6 +992,7 @@ HandleRequests(void *pvCompositeInstance, tUSBRequest *psUSBRequest)
             // data notification callbacks to it.
             //
             psCompDevice->sPrivateData.ui32EP0Owner = ui32Idx;
+            psCompDevice->psDevices[ui32Idx].sStats.ui32Requests++;
 
             //
             // Yes - call the device to retrieve the descriptor.
@@ -1059,6 +1113,23 @@ BuildCompositeDescriptor(tUSBDCompositeDevice *psCompDevice)
     ui32Offset = 0;
     ui32FixINT = 0;
 
+    //
+    // Start with no interface or endpoint owned by any device.
+    //
+    for(ui32Idx = 0; ui32Idx < COMPOSITE_MAX_INTERFACES; ui32Idx++)
+    {
+        psCompDevice->sPrivateData.pui8InterfaceMap[ui32Idx] =
+                                                        INVALID_MAP_ENTRY;
+    }
+
+    for(ui32Idx = 0; ui32Idx < COMPOSITE_MAX_ENDPOINTS; ui32Idx++)
+    {
+        psCompDevice->sPrivateData.pui8INEndpointMap[ui32Idx] =
+                                                        INVALID_MAP_ENTRY;
+        psCompDevice->sPrivateData.pui8OUTEndpointMap[ui32Idx] =
+                                                        INVALID_MAP_ENTRY;
+    }
+
     //
     // This puts the first section pointer in the first entry in the list
     // of sections.
@@ -1114,6 +1185,11 @@ BuildCompositeDescriptor(tUSBDCompositeDevice *psCompDevice)
         //
         pui8Config = pui8Data + ui32Offset;
 
+        //
+        // This device does not own any endpoints yet.
+        //
+        psCompDevice->psDevices[ui32Dev].ui32DeviceWorkspace = 0;
+
         //
         // Create a local pointer to the configuration header.
         //
@@ -1230,6 +1306,15 @@ BuildCompositeDescriptor(tUSBDCompositeDevice *psCompDevice)
                         //
                         psInterface->bInterfaceNumber = ui8Interface;
 
+                        //
+                        // Record which device owns this interface.
+                        //
+                        if(ui8Interface < COMPOSITE_MAX_INTERFACES)
+                        {
+                            psCompDevice->sPrivateData.pui8InterfaceMap[
+                                            ui8Interface] = (uint8_t)ui32Dev;
+                        }
+
                         //
                         // No strings allowed on interface descriptors for
                         // composite devices.
@@ -1280,6 +1365,21 @@ BuildCompositeDescriptor(tUSBDCompositeDevice *psCompDevice)
 
                             psEndpoint->bEndpointAddress = ui32FixINT |
                                                            USB_RTYPE_DIR_IN;
+
+                            //
+                            // The fixed interrupt endpoint is shared so
+                            // requests for it go to the first device using
+                            // it.
+                            //
+                            if(psCompDevice->sPrivateData.pui8INEndpointMap[
+                                        ui32FixINT] == INVALID_MAP_ENTRY)
+                            {
+                                psCompDevice->sPrivateData.pui8INEndpointMap[
+                                        ui32FixINT] = (uint8_t)ui32Dev;
+                            }
+
+                            psCompDevice->psDevices[ui32Dev].
+                                ui32DeviceWorkspace |= EP_MASK_IN(ui32FixINT);
                         }
                         else
                         {
@@ -1292,8 +1392,22 @@ BuildCompositeDescriptor(tUSBDCompositeDevice *psCompDevice)
                                         psEndpoint->bEndpointAddress,
                                         ui8INEndpoint);
 
-                            psEndpoint->bEndpointAddress = ui8INEndpoint++ |
+                            psEndpoint->bEndpointAddress = ui8INEndpoint |
                                                            USB_RTYPE_DIR_IN;
+
+                            //
+                            // Record which device owns this endpoint.
+                            //
+                            if(ui8INEndpoint < COMPOSITE_MAX_ENDPOINTS)
+                            {
+                                psCompDevice->sPrivateData.pui8INEndpointMap[
+                                        ui8INEndpoint] = (uint8_t)ui32Dev;
+                                psCompDevice->psDevices[ui32Dev].
+                                    ui32DeviceWorkspace |=
+                                                EP_MASK_IN(ui8INEndpoint);
+                            }
+
+                            ui8INEndpoint++;
                         }
                     }
                     else
@@ -1305,7 +1419,21 @@ BuildCompositeDescriptor(tUSBDCompositeDevice *psCompDevice)
                         CompositeEPChange(&psCompDevice->psDevices[ui32Dev],
                                           psEndpoint->bEndpointAddress,
                                           ui8OUTEndpoint);
-                        psEndpoint->bEndpointAddress = ui8OUTEndpoint++;
+                        psEndpoint->bEndpointAddress = ui8OUTEndpoint;
+
+                        //
+                        // Record which device owns this endpoint.
+                        //
+                        if(ui8OUTEndpoint < COMPOSITE_MAX_ENDPOINTS)
+                        {
+                            psCompDevice->sPrivateData.pui8OUTEndpointMap[
+                                        ui8OUTEndpoint] = (uint8_t)ui32Dev;
+                            psCompDevice->psDevices[ui32Dev].
+                                ui32DeviceWorkspace |=
+                                                EP_MASK_OUT(ui8OUTEndpoint);
+                        }
+
+                        ui8OUTEndpoint++;
                     }
                 }
 
@@ -1328,16 +1456,6 @@ BuildCompositeDescriptor(tUSBDCompositeDevice *psCompDevice)
                 psCompDevice->psDevices[ui32Dev].pvInstance,
                 USB_EVENT_COMP_CONFIG, (void *)pui8Config);
 
-        //
-        // Add an entry into the device workspace array to allow us to quickly
-        // map interface and endpoint numbers to device instances later.
-        //
-        psCompDevice->psDevices[ui32Dev].ui32DeviceWorkspace =
-            (ui32Dev << (LOOKUP_INDEX_BYTE * 8)) |
-            (ui8Interface << (LOOKUP_INTERFACE_BYTE * 8)) |
-            (ui8OUTEndpoint << (LOOKUP_OUT_END_BYTE * 8)) |
-            (ui8INEndpoint << (LOOKUP_IN_END_BYTE * 8));
-
         //
         // Move on to the next device.
         //
@@ -1425,6 +1543,11 @@ USBDCompositeInit(uint32_t ui32Index, tUSBDCompositeDevice *psDevice,
     //
     psInst->ui32EP0Owner = INVALID_DEVICE_INDEX;
 
+    //
+    // Start with no events counted for any of the devices.
+    //
+    USBDCompositeStatsClear((void *)psDevice);
+
     //
     // Initialize the device information structure.
     //
@@ -1432,6 +1555,7 @@ USBDCompositeInit(uint32_t ui32Index, tUSBDCompositeDevice *psDevice,
     psInst->sDevInfo.pui8DeviceDescriptor = g_pui8CompDeviceDescriptor;
     psInst->sDevInfo.ppsConfigDescriptors =
                     (const tConfigHeader * const *)g_ppCompConfigDescriptors;
+    psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
     psInst->sDevInfo.ppui8StringDescriptors = 0;
     psInst->sDevInfo.ui32NumStringDescriptors = 0;
 
@@ -1544,6 +1668,108 @@ USBDCompositeTerm(void *pvCompositeInstance)
 
 }
 
+//****************************************************************************
+//
+//! Returns the event dispatch statistics for one device in a composite
+//! device.
+//!
+//! \param pvCompositeInstance is the pointer to the device instance structure
+//! as returned by USBDCompositeInit().
+//! \param ui32Device is the index of the device in the \e psDevices array of
+//! the tUSBDCompositeDevice structure.
+//! \param psStats points to the structure which will be filled with the
+//! statistics for the device.
+//!
+//! The composite device routes each request and endpoint event to the device
+//! which owns the interface or endpoint involved using lookup tables built
+//! by USBDCompositeInit().  This function allows an application to see how
+//! many events were passed to each device and how many endpoint events each
+//! device was spared.
+//!
+//! \return Returns \b true if the statistics were returned or \b false if
+//! \e ui32Device is not a valid device index.
+//
+//****************************************************************************
+bool
+USBDCompositeStatsGet(void *pvCompositeInstance, uint32_t ui32Device,
+                      tCompositeStats *psStats)
+{
+    tUSBDCompositeDevice *psCompDevice;
+    tCompositeStats *psDevStats;
+    bool bIntsOff;
+
+    ASSERT(pvCompositeInstance != 0);
+    ASSERT(psStats != 0);
+
+    psCompDevice = (tUSBDCompositeDevice *)pvCompositeInstance;
+
+    if(ui32Device >= psCompDevice->ui32NumDevices)
+    {
+        return(false);
+    }
+
+    psDevStats = &psCompDevice->psDevices[ui32Device].sStats;
+
+    //
+    // The statistics are updated in interrupt context so take a consistent
+    // snapshot of them.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    psStats->ui32EndpointEvents = psDevStats->ui32EndpointEvents;
+    psStats->ui32EndpointSkipped = psDevStats->ui32EndpointSkipped;
+    psStats->ui32Requests = psDevStats->ui32Requests;
+    psStats->ui32EP0Events = psDevStats->ui32EP0Events;
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+
+    return(true);
+}
+
+//****************************************************************************
+//
+//! Clears the event dispatch statistics for all devices in a composite
+//! device.
+//!
+//! \param pvCompositeInstance is the pointer to the device instance structure
+//! as returned by USBDCompositeInit().
+//!
+//! \return None.
+//
+//****************************************************************************
+void
+USBDCompositeStatsClear(void *pvCompositeInstance)
+{
+    tUSBDCompositeDevice *psCompDevice;
+    tCompositeStats *psDevStats;
+    uint32_t ui32Idx;
+    bool bIntsOff;
+
+    ASSERT(pvCompositeInstance != 0);
+
+    psCompDevice = (tUSBDCompositeDevice *)pvCompositeInstance;
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    for(ui32Idx = 0; ui32Idx < psCompDevice->ui32NumDevices; ui32Idx++)
+    {
+        psDevStats = &psCompDevice->psDevices[ui32Idx].sStats;
+
+        psDevStats->ui32EndpointEvents = 0;
+        psDevStats->ui32EndpointSkipped = 0;
+        psDevStats->ui32Requests = 0;
+        psDevStats->ui32EP0Events = 0;
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
 //****************************************************************************
 //
 // Close the Doxygen group.
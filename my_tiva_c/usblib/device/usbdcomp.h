@@ -76,6 +76,16 @@ typedef struct
 }
 tUSBDCompositeEntry;
 
+//*****************************************************************************
+//
+// The number of interface and endpoint numbers covered by the lookup tables
+// used to route requests and endpoint events to the devices in a composite
+// device.
+//
+//*****************************************************************************
+#define COMPOSITE_MAX_INTERFACES 32
+#define COMPOSITE_MAX_ENDPOINTS  16
+
 //*****************************************************************************
 //
 // PRIVATE
@@ -133,6 +143,15 @@ typedef struct
     // class which is currently transferring data on EP0.
     //
     uint32_t ui32EP0Owner;
+
+    //
+    // Lookup tables built when the composite descriptor is created which
+    // hold the index of the device owning each interface, IN endpoint and
+    // OUT endpoint number, or 0xFF if no device owns the number.
+    //
+    uint8_t pui8InterfaceMap[COMPOSITE_MAX_INTERFACES];
+    uint8_t pui8INEndpointMap[COMPOSITE_MAX_ENDPOINTS];
+    uint8_t pui8OUTEndpointMap[COMPOSITE_MAX_ENDPOINTS];
 }
 tCompositeInstance;
 
@@ -240,6 +259,10 @@ extern void *USBDCompositeInit(uint32_t ui32Index,
                                tUSBDCompositeDevice *psCompDevice,
                                uint32_t ui32Size, uint8_t *pui8Data);
 extern void USBDCompositeTerm(void *pvInstance);
+extern bool USBDCompositeStatsGet(void *pvCompositeInstance,
+                                  uint32_t ui32Device,
+                                  tCompositeStats *psStats);
+extern void USBDCompositeStatsClear(void *pvCompositeInstance);
 
 //*****************************************************************************
 //
@@ -26,6 +26,7 @@
 #include <stdint.h>
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
+#include "inc/hw_usb.h"
 #include "driverlib/debug.h"
 #include "driverlib/usb.h"
 #include "usblib/usblib.h"
@@ -49,6 +50,8 @@
 typedef struct
 {
     uint32_t pui32Size[2];
+    bool pbBulk[2];
+    bool pbDouble[2];
 }
 tUSBEndpointInfo;
 
@@ -60,6 +63,13 @@ tUSBEndpointInfo;
 #define EP_INFO_IN              0
 #define EP_INFO_OUT             1
 
+//*****************************************************************************
+//
+// The size of the USB FIFO RAM on parts that support a high-speed ULPI PHY.
+//
+//*****************************************************************************
+#define USB_FIFO_RAM_SIZE_HS    4096
+
 //*****************************************************************************
 //
 // Given a maximum packet size and the user's FIFO scaling requirements,
@@ -107,6 +117,64 @@ GetEndpointFIFOSize(uint32_t ui32MaxPktSize, uint32_t *pupBytesUsed)
     return(USB_FIFO_SZ_8);
 }
 
+//*****************************************************************************
+//
+// Mark the bulk endpoint FIFOs that can be double buffered.
+//
+// At high speed a bulk endpoint with a single packet buffer NAKs the host
+// while the application or DMA is still handling the previous packet.  With
+// a second buffer the next 512 byte packet can be transferred in the
+// meantime.  Bulk endpoints are double buffered in endpoint order for as
+// long as the FIFO RAM has room, after all endpoints have been given a
+// single buffer.
+//
+//*****************************************************************************
+static void
+FIFODoubleBufferSet(tUSBEndpointInfo *psEPInfo)
+{
+    uint32_t ui32Loop, ui32Dir, ui32Total, ui32BytesUsed;
+
+    //
+    // Find the FIFO space needed with a single buffer for each endpoint.
+    //
+    ui32Total = MAX_PACKET_SIZE_EP0;
+
+    for(ui32Loop = 0; ui32Loop < (NUM_USB_EP - 1); ui32Loop++)
+    {
+        for(ui32Dir = EP_INFO_IN; ui32Dir <= EP_INFO_OUT; ui32Dir++)
+        {
+            if(psEPInfo[ui32Loop].pui32Size[ui32Dir])
+            {
+                GetEndpointFIFOSize(psEPInfo[ui32Loop].pui32Size[ui32Dir],
+                                    &ui32BytesUsed);
+                ui32Total += ui32BytesUsed;
+            }
+        }
+    }
+
+    //
+    // Add a second buffer to each bulk endpoint that still fits.
+    //
+    for(ui32Loop = 0; ui32Loop < (NUM_USB_EP - 1); ui32Loop++)
+    {
+        for(ui32Dir = EP_INFO_IN; ui32Dir <= EP_INFO_OUT; ui32Dir++)
+        {
+            if(psEPInfo[ui32Loop].pui32Size[ui32Dir] &&
+               psEPInfo[ui32Loop].pbBulk[ui32Dir])
+            {
+                GetEndpointFIFOSize(psEPInfo[ui32Loop].pui32Size[ui32Dir],
+                                    &ui32BytesUsed);
+
+                if((ui32Total + ui32BytesUsed) <= USB_FIFO_RAM_SIZE_HS)
+                {
+                    psEPInfo[ui32Loop].pbDouble[ui32Dir] = true;
+                    ui32Total += ui32BytesUsed;
+                }
+            }
+        }
+    }
+}
+
 //*****************************************************************************
 //
 // Translate a USB endpoint descriptor into the values we need to pass to the
@@ -189,7 +257,7 @@ USBDeviceConfig(tDCDInstance *psDevInst, const tConfigHeader *psConfig)
 {
     uint32_t ui32Loop, ui32Count, ui32NumInterfaces, ui32EpIndex, ui32EpType,
              ui32MaxPkt, ui32NumEndpoints, ui32Flags, ui32BytesUsed,
-             ui32Section;
+             ui32Section, ui32ULPI;
     tInterfaceDescriptor *psInterface;
     tEndpointDescriptor *psEndpoint;
     tUSBEndpointInfo psEPInfo[NUM_USB_EP - 1];
@@ -211,6 +279,10 @@ USBDeviceConfig(tDCDInstance *psDevInst, const tConfigHeader *psConfig)
     {
         psEPInfo[ui32Loop].pui32Size[EP_INFO_IN] = 0;
         psEPInfo[ui32Loop].pui32Size[EP_INFO_OUT] = 0;
+        psEPInfo[ui32Loop].pbBulk[EP_INFO_IN] = false;
+        psEPInfo[ui32Loop].pbBulk[EP_INFO_OUT] = false;
+        psEPInfo[ui32Loop].pbDouble[EP_INFO_IN] = false;
+        psEPInfo[ui32Loop].pbDouble[EP_INFO_OUT] = false;
     }
 
     //
@@ -270,6 +342,15 @@ USBDeviceConfig(tDCDInstance *psDevInst, const tConfigHeader *psConfig)
             psEPInfo[ui32EpIndex - 1].pui32Size[ui32EpType] =
                 psEndpoint->wMaxPacketSize;
         }
+
+        //
+        // Remember bulk endpoints since they may be double buffered.
+        //
+        if((psEndpoint->bmAttributes & USB_EP_ATTR_TYPE_M) ==
+           USB_EP_ATTR_BULK)
+        {
+            psEPInfo[ui32EpIndex - 1].pbBulk[ui32EpType] = true;
+        }
     }
 
     //
@@ -348,7 +429,17 @@ USBDeviceConfig(tDCDInstance *psDevInst, const tConfigHeader *psConfig)
     // partition the FIFO based on the maximum packet size information we
     // extracted earlier.  Endpoint 0 is automatically configured to use the
     // first MAX_PACKET_SIZE_EP0 bytes of the FIFO so we start from there.
+    // At high speed, bulk endpoints get a second packet buffer where there
+    // is room.
     //
+    ui32ULPI = USBLIB_FEATURE_ULPI_NONE;
+    USBDCDFeatureGet(0, USBLIB_FEATURE_USBULPI, &ui32ULPI);
+
+    if(ui32ULPI == USBLIB_FEATURE_ULPI_HS)
+    {
+        FIFODoubleBufferSet(psEPInfo);
+    }
+
     ui32Count = MAX_PACKET_SIZE_EP0;
     for(ui32Loop = 1; ui32Loop < NUM_USB_EP; ui32Loop++)
     {
@@ -373,6 +464,15 @@ USBDeviceConfig(tDCDInstance *psDevInst, const tConfigHeader *psConfig)
                 return(false);
             }
 
+            //
+            // Double buffered FIFOs take twice the space.
+            //
+            if(psEPInfo[ui32Loop - 1].pbDouble[EP_INFO_IN])
+            {
+                ui32MaxPkt |= USB_TXFIFOSZ_DPB;
+                ui32BytesUsed *= 2;
+            }
+
             //
             // Now actually configure the FIFO for this endpoint.
             //
@@ -401,6 +501,15 @@ USBDeviceConfig(tDCDInstance *psDevInst, const tConfigHeader *psConfig)
                 return(false);
             }
 
+            //
+            // Double buffered FIFOs take twice the space.
+            //
+            if(psEPInfo[ui32Loop - 1].pbDouble[EP_INFO_OUT])
+            {
+                ui32MaxPkt |= USB_RXFIFOSZ_DPB;
+                ui32BytesUsed *= 2;
+            }
+
             //
             // Now actually configure the FIFO for this endpoint.
             //
@@ -522,6 +522,7 @@ USBDDFUCompositeInit(uint32_t ui32Index, tUSBDDFUDevice *psDFUDevice,
     psInst->sDevInfo.psCallbacks = &g_sDFUHandlers;
     psInst->sDevInfo.pui8DeviceDescriptor = g_pui8DFUDeviceDescriptor;
     psInst->sDevInfo.ppsConfigDescriptors = g_ppsDFUConfigDescriptors;
+    psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
     psInst->sDevInfo.ppui8StringDescriptors = 0;
     psInst->sDevInfo.ui32NumStringDescriptors = 0;
 
@@ -163,6 +163,13 @@ static uint32_t g_ui32PLLDiv = 8;
 //*****************************************************************************
 static uint32_t g_ui32ULPISupport;
 
+//*****************************************************************************
+//
+// The device qualifier descriptor returned by a high speed capable device.
+//
+//*****************************************************************************
+static tDeviceQualifierDescriptor g_sDeviceQualifier;
+
 //*****************************************************************************
 //
 // This is the instance data for the USB controller itself and not a USB
@@ -331,6 +338,13 @@ USBDCDInit(uint32_t ui32Index, tDeviceInfo *psDevice, void *pvDCDCBData)
     g_ppsDevInfo[0] = psDevice;
     g_psDCDInst[0].pvCBData = pvDCDCBData;
 
+    //
+    // A device class that supports high speed starts with its high speed
+    // configurations if the ULPI PHY is allowed to run at high speed.
+    //
+    g_psDCDInst[0].bHighSpeedConfig =
+                (g_ui32ULPISupport & USBLIB_FEATURE_ULPI_HS) ? true : false;
+
     //
     // Initialize the Device Info structure for a USB device instance.
     //
@@ -554,6 +568,11 @@ USBDCDTerm(uint32_t ui32Index)
     //
     g_ppsDevInfo[0] = 0;
 
+    //
+    // Discard any compiled configuration descriptors.
+    //
+    g_psDCDInst[0].psConfigCache = 0;
+
     MAP_USBIntDisableControl(USB0_BASE, USB_INTCTRL_ALL);
     MAP_USBIntDisableEndpoint(USB0_BASE, USB_INTEP_ALL);
 
@@ -738,6 +757,7 @@ USBDCDStallEP0(uint32_t ui32Index)
     // Stall the endpoint in question.
     //
     MAP_USBDevEndpointStall(USB0_BASE, USB_EP_0, USB_EP_DEV_OUT);
+    g_psDCDInst[0].sStats.ui32Stalls++;
 
     //
     // Enter the stalled state.
@@ -961,6 +981,84 @@ USBDCDRemoteWakeLPM(uint32_t ui32Index)
     return(false);
 }
 
+//*****************************************************************************
+//
+//! Returns the enumeration statistics for a USB device controller.
+//!
+//! \param ui32Index is the index of the USB controller whose statistics are
+//! to be returned.
+//! \param psStats points to the structure which is written with the
+//! statistics.
+//!
+//! This function returns the counts and times gathered by the USB library
+//! while handling bus resets and standard requests on endpoint zero.  These
+//! allow the cost of enumeration to be measured on the target, for example
+//! when comparing descriptor layouts or the effect of registering a
+//! configuration descriptor cache using USBDCDConfigCacheInit().  The
+//! enumeration times are only measured while the USB library tick is running.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBDCDStatsGet(uint32_t ui32Index, tUSBDCDStats *psStats)
+{
+    bool bIntsOff;
+
+    ASSERT(ui32Index == 0);
+    ASSERT(psStats != 0);
+
+    //
+    // Take a consistent copy of the statistics.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+    *psStats = g_psDCDInst[0].sStats;
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Clears the enumeration statistics for a USB device controller.
+//!
+//! \param ui32Index is the index of the USB controller whose statistics are
+//! to be cleared.
+//!
+//! This function resets all counts and times returned by USBDCDStatsGet() to
+//! zero.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBDCDStatsClear(uint32_t ui32Index)
+{
+    tUSBDCDStats *psStats;
+    bool bIntsOff;
+
+    ASSERT(ui32Index == 0);
+
+    psStats = &g_psDCDInst[0].sStats;
+
+    bIntsOff = MAP_IntMasterDisable();
+    psStats->ui32Resets = 0;
+    psStats->ui32Requests = 0;
+    psStats->ui32DescriptorRequests = 0;
+    psStats->ui32Stalls = 0;
+    psStats->ui32EP0TxBytes = 0;
+    psStats->ui32Configurations = 0;
+    psStats->ui32EnumTime = 0;
+    psStats->ui32MaxEnumTime = 0;
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
 //*****************************************************************************
 //
 //! Requests a remote wake up to resume communication when in suspended state.
@@ -1117,6 +1215,8 @@ USBDReadAndDispatchRequest(uint32_t ui32Index)
         return;
     }
 
+    g_psDCDInst[0].sStats.ui32Requests++;
+
     //
     // See if this is a standard request or not.
     //
@@ -1435,6 +1535,9 @@ void
 USBDeviceEnumResetHandler(tDCDInstance *pDevInstance)
 {
     uint32_t ui32Loop;
+    bool bHighSpeed;
+    tDeviceInfo *psDevice;
+    const tConfigHeader * const *ppsConfig;
 
     //
     // Disable remote wake up signaling (as per USB 2.0 spec 9.1.1.6).
@@ -1442,6 +1545,33 @@ USBDeviceEnumResetHandler(tDCDInstance *pDevInstance)
     pDevInstance->ui8Status &= ~USB_STATUS_REMOTE_WAKE;
     pDevInstance->bRemoteWakeup = false;
 
+    //
+    // Remember when the reset occurred so that the time taken to enumerate
+    // can be measured.
+    //
+    pDevInstance->sStats.ui32Resets++;
+    pDevInstance->ui32ResetTime = InternalUSBGetTime();
+
+    //
+    // If the device has configurations for both full and high speed, make
+    // those for the speed selected by this reset the current configurations.
+    //
+    psDevice = g_ppsDevInfo[0];
+
+    if(psDevice->ppsOtherSpeedDescriptors)
+    {
+        bHighSpeed = (MAP_USBDevSpeedGet(USB0_BASE) == USB_HIGH_SPEED);
+
+        if(bHighSpeed != pDevInstance->bHighSpeedConfig)
+        {
+            ppsConfig = psDevice->ppsConfigDescriptors;
+            psDevice->ppsConfigDescriptors =
+                                        psDevice->ppsOtherSpeedDescriptors;
+            psDevice->ppsOtherSpeedDescriptors = ppsConfig;
+            pDevInstance->bHighSpeedConfig = bHighSpeed;
+        }
+    }
+
     //
     // Call the device dependent code to indicate a bus reset has occurred.
     //
@@ -1909,6 +2039,34 @@ USBDSetAddress(void *pvInstance, tUSBRequest *psUSBRequest)
     psUSBControl->iEP0State = eUSBStateStatus;
 }
 
+//*****************************************************************************
+//
+// This function returns the configuration that a GET_DESCRIPTOR request is
+// sending to the host.
+//
+// \param psUSBControl is the USB device controller instance data.
+// \param psDevice is the device information structure.
+// \param ui8Index is the index of the configuration.
+//
+// The configuration is taken from the other speed configurations if the
+// request is for an other speed configuration descriptor and the device has
+// separate configurations for the other speed.
+//
+// \return Returns a pointer to the configuration header.
+//
+//*****************************************************************************
+static const tConfigHeader *
+USBDConfigDescGet(tDCDInstance *psUSBControl, tDeviceInfo *psDevice,
+                  uint8_t ui8Index)
+{
+    if(psUSBControl->bOtherSpeedConfig && psDevice->ppsOtherSpeedDescriptors)
+    {
+        return(psDevice->ppsOtherSpeedDescriptors[ui8Index]);
+    }
+
+    return(psDevice->ppsConfigDescriptors[ui8Index]);
+}
+
 //*****************************************************************************
 //
 // This function handles the GET_DESCRIPTOR standard USB request.
@@ -1923,12 +2081,14 @@ USBDSetAddress(void *pvInstance, tUSBRequest *psUSBRequest)
 // descriptor is made, then the appropriate descriptor from the \e
 // g_pConfigDescriptors will be returned.  When a request for a string
 // descriptor is made, the appropriate string from the
-// \e pvInstance->psInfo->pStringDescriptors will be returned.  If the
+// \e pvInstance->psInfo->pStringDescriptors will be returned.  A device that
+// can operate at high speed also returns a device qualifier descriptor and
+// the other speed configuration descriptors.  If the
 // \e pvInstance->psInfo->psCallbacks->GetDescriptor is specified it will be
 // called to handle the request.  In this case it must call the
 // USBDCDSendDataEP0() function to send the data to the host controller.  If
-// the callback is not specified, and the descriptor request is not for a
-// device, configuration, or string descriptor then this function will stall
+// the callback is not specified, and the descriptor request is not for one
+// of these descriptors then this function will stall
 // the request to indicate that the request was not supported by the device.
 //
 // \return None.
@@ -1941,6 +2101,7 @@ USBDGetDescriptor(void *pvInstance, tUSBRequest *psUSBRequest)
     tDCDInstance *psUSBControl;
     tDeviceInfo *psDevice;
     const tConfigHeader *psConfig;
+    const tConfigCache *psCache;
     const tDeviceDescriptor *psDeviceDesc;
     uint8_t ui8Index;
     int32_t i32Index;
@@ -1960,6 +2121,8 @@ USBDGetDescriptor(void *pvInstance, tUSBRequest *psUSBRequest)
     //
     MAP_USBDevEndpointDataAck(USB0_BASE, USB_EP_0, false);
 
+    psUSBControl->sStats.ui32DescriptorRequests++;
+
     //
     // Assume we are not sending the configuration descriptor until we
     // determine otherwise.
@@ -1992,9 +2155,56 @@ USBDGetDescriptor(void *pvInstance, tUSBRequest *psUSBRequest)
         }
 
         //
-        // This request was for a configuration descriptor.
+        // This request was for a device qualifier descriptor, which is only
+        // returned by a device that can operate at high speed.
+        //
+        case USB_DTYPE_DEVICE_QUAL:
+        {
+            if(!(g_ui32ULPISupport & USBLIB_FEATURE_ULPI_HS))
+            {
+                USBDCDStallEP0(0);
+                psUSBControl->pui8EP0Data = 0;
+                psUSBControl->ui32EP0DataRemain = 0;
+                break;
+            }
+
+            //
+            // The device qualifier holds the fields of the device descriptor
+            // that may differ at the other speed.  The device descriptor and
+            // the number of configurations are the same at both speeds.
+            //
+            psDeviceDesc =
+                (const tDeviceDescriptor *)psDevice->pui8DeviceDescriptor;
+
+            g_sDeviceQualifier.bLength = sizeof(tDeviceQualifierDescriptor);
+            g_sDeviceQualifier.bDescriptorType = USB_DTYPE_DEVICE_QUAL;
+            g_sDeviceQualifier.bcdUSB = psDeviceDesc->bcdUSB;
+            g_sDeviceQualifier.bDeviceClass = psDeviceDesc->bDeviceClass;
+            g_sDeviceQualifier.bDeviceSubClass =
+                                            psDeviceDesc->bDeviceSubClass;
+            g_sDeviceQualifier.bDeviceProtocol =
+                                            psDeviceDesc->bDeviceProtocol;
+            g_sDeviceQualifier.bMaxPacketSize0 =
+                                            psDeviceDesc->bMaxPacketSize0;
+            g_sDeviceQualifier.bNumConfigurations =
+                                            psDeviceDesc->bNumConfigurations;
+            g_sDeviceQualifier.bReserved = 0;
+
+            psUSBControl->pui8EP0Data = (uint8_t *)&g_sDeviceQualifier;
+            psUSBControl->ui32EP0DataRemain =
+                                            sizeof(tDeviceQualifierDescriptor);
+
+            break;
+        }
+
+        //
+        // This request was for a configuration descriptor or, from a device
+        // that can operate at high speed, an other speed configuration
+        // descriptor.  A device without separate configurations for the
+        // other speed uses the same configurations at both speeds.
         //
         case USB_DTYPE_CONFIGURATION:
+        case USB_DTYPE_OSPEED_CONF:
         {
             //
             // Which configuration are we being asked for?
@@ -2007,7 +2217,12 @@ USBDGetDescriptor(void *pvInstance, tUSBRequest *psUSBRequest)
             psDeviceDesc =
                 (const tDeviceDescriptor *)psDevice->pui8DeviceDescriptor;
 
-            if(ui8Index >= psDeviceDesc->bNumConfigurations)
+            psUSBControl->bOtherSpeedConfig =
+                        ((psUSBRequest->wValue >> 8) == USB_DTYPE_OSPEED_CONF);
+
+            if((ui8Index >= psDeviceDesc->bNumConfigurations) ||
+               (psUSBControl->bOtherSpeedConfig &&
+                !(g_ui32ULPISupport & USBLIB_FEATURE_ULPI_HS)))
             {
                 //
                 // This is an invalid configuration index.  Stall EP0 to
@@ -2022,7 +2237,28 @@ USBDGetDescriptor(void *pvInstance, tUSBRequest *psUSBRequest)
                 //
                 // Return the externally specified configuration descriptor.
                 //
-                psConfig = psDevice->ppsConfigDescriptors[ui8Index];
+                psConfig = USBDConfigDescGet(psUSBControl, psDevice, ui8Index);
+
+                //
+                // Remember which descriptor we need to send.
+                //
+                psUSBControl->ui8ConfigIndex = ui8Index;
+
+                //
+                // If this configuration has been compiled, send it as a
+                // single block of descriptor data.  The compiled block holds
+                // a configuration descriptor, so an other speed configuration
+                // is always sent section by section.
+                //
+                psCache = psUSBControl->bOtherSpeedConfig ? 0 :
+                          USBDCDConfigCacheFind(psConfig);
+
+                if(psCache)
+                {
+                    psUSBControl->pui8EP0Data = (uint8_t *)psCache->pui8Desc;
+                    psUSBControl->ui32EP0DataRemain = psCache->ui16Size;
+                    break;
+                }
 
                 //
                 // Start by sending data from the beginning of the first
@@ -2042,10 +2278,8 @@ USBDGetDescriptor(void *pvInstance, tUSBRequest *psUSBRequest)
 
                 //
                 // Remember that we need to send the configuration descriptor
-                // and which descriptor we need to send.
+                // section by section.
                 //
-                psUSBControl->ui8ConfigIndex = ui8Index;
-
                 bConfig = true;
             }
             break;
@@ -2407,6 +2641,20 @@ USBDSetConfiguration(void *pvInstance, tUSBRequest *psUSBRequest)
         //
         if(psUSBControl->ui32Configuration)
         {
+            //
+            // Record the time taken to enumerate since the last bus reset.
+            //
+            psUSBControl->sStats.ui32Configurations++;
+            psUSBControl->sStats.ui32EnumTime =
+                            InternalUSBGetTime() - psUSBControl->ui32ResetTime;
+
+            if(psUSBControl->sStats.ui32EnumTime >
+               psUSBControl->sStats.ui32MaxEnumTime)
+            {
+                psUSBControl->sStats.ui32MaxEnumTime =
+                                            psUSBControl->sStats.ui32EnumTime;
+            }
+
             //
             // Get a pointer to the configuration descriptor.  This will always
             // be the first section in the current configuration.
@@ -2725,6 +2973,7 @@ USBDEP0StateTx(uint32_t ui32Index)
     //
     g_psDCDInst[0].ui32EP0DataRemain -= ui32NumBytes;
     g_psDCDInst[0].pui8EP0Data += ui32NumBytes;
+    g_psDCDInst[0].sStats.ui32EP0TxBytes += ui32NumBytes;
 
     //
     // Put the data in the correct FIFO.
@@ -2805,8 +3054,8 @@ USBDEP0StateTxConfig(uint32_t ui32Index)
     //
     // Find the current configuration descriptor definition.
     //
-    psConfig = g_ppsDevInfo[0]->ppsConfigDescriptors[
-                                            g_psDCDInst[0].ui8ConfigIndex];
+    psConfig = USBDConfigDescGet(&g_psDCDInst[0], g_ppsDevInfo[0],
+                                 g_psDCDInst[0].ui8ConfigIndex);
 
     //
     // Set the number of bytes to send this iteration.
@@ -2821,6 +3070,8 @@ USBDEP0StateTxConfig(uint32_t ui32Index)
         ui32NumBytes = EP0_MAX_PACKET_SIZE;
     }
 
+    g_psDCDInst[0].sStats.ui32EP0TxBytes += ui32NumBytes;
+
     //
     // If this is the first call, we need to fix up the total length of the
     // configuration descriptor.  This has already been determined and set in
@@ -2840,6 +3091,14 @@ USBDEP0StateTxConfig(uint32_t ui32Index)
         //
         sConfDesc.wTotalLength = (uint16_t)USBDCDConfigDescGetSize(psConfig);
 
+        //
+        // The other speed configuration descriptor differs only in its type.
+        //
+        if(g_psDCDInst[0].bOtherSpeedConfig)
+        {
+            sConfDesc.bDescriptorType = USB_DTYPE_OSPEED_CONF;
+        }
+
         //
         // Write the descriptor to the USB FIFO.
         //
@@ -3219,6 +3478,12 @@ USBDeviceIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
     //
     ui32DMAIntStatus = USBLibDMAIntStatus(g_psDCDInst[0].psDMAInstance);
 
+    //
+    // Keep the completed channels for the endpoint handler, which is given
+    // no other way of telling which endpoints they belong to.
+    //
+    g_psDCDInst[0].ui32DMAIntStatus = ui32DMAIntStatus;
+
     if(ui32DMAIntStatus)
     {
         //
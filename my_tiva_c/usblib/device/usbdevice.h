@@ -54,6 +54,61 @@ extern "C"
 //*****************************************************************************
 #define USB_MAX_INTERFACES_PER_DEVICE 8
 
+//*****************************************************************************
+//
+//! This structure holds the enumeration statistics gathered by the USB
+//! library device control driver and is returned by USBDCDStatsGet().  Times
+//! are measured in milliseconds using the USB library tick so have the same
+//! granularity as the tick handlers.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of bus resets seen.
+    //
+    uint32_t ui32Resets;
+
+    //
+    //! The number of SETUP packets received on endpoint zero.
+    //
+    uint32_t ui32Requests;
+
+    //
+    //! The number of GET_DESCRIPTOR requests received.
+    //
+    uint32_t ui32DescriptorRequests;
+
+    //
+    //! The number of times endpoint zero has been stalled.
+    //
+    uint32_t ui32Stalls;
+
+    //
+    //! The number of bytes sent to the host on endpoint zero.
+    //
+    uint32_t ui32EP0TxBytes;
+
+    //
+    //! The number of SET_CONFIGURATION requests which selected a
+    //! configuration.
+    //
+    uint32_t ui32Configurations;
+
+    //
+    //! The time taken from the last bus reset to the last SET_CONFIGURATION
+    //! request which selected a configuration.
+    //
+    uint32_t ui32EnumTime;
+
+    //
+    //! The longest time taken from a bus reset to a SET_CONFIGURATION
+    //! request which selected a configuration.
+    //
+    uint32_t ui32MaxEnumTime;
+}
+tUSBDCDStats;
+
 #include "usbdevicepriv.h"
 
 //*****************************************************************************
@@ -122,8 +177,138 @@ struct tDeviceInfo
     //! array.
     //
     uint32_t ui32NumStringDescriptors;
+
+    //
+    //! A pointer to an array of configuration descriptor pointers describing
+    //! the device when it operates at the speed other than the one described
+    //! by \e ppsConfigDescriptors, or 0 if the device has a single set of
+    //! configurations.  A device class that supports high speed operation
+    //! provides its full speed configurations here.  The USB library returns
+    //! these as other speed configuration descriptors and exchanges the two
+    //! arrays when a bus reset selects the other speed.
+    //
+    const tConfigHeader * const *ppsOtherSpeedDescriptors;
+};
+
+//*****************************************************************************
+//
+//! This structure describes one entry in the interface or endpoint index held
+//! by a configuration descriptor cache.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! A pointer to the descriptor within the section data of the original
+    //! configuration descriptor.
+    //
+    const tDescriptorHeader *psDesc;
+
+    //
+    //! The index of the configuration descriptor section containing the
+    //! descriptor.
+    //
+    uint8_t ui8Section;
+
+    //
+    //! For an interface descriptor, the index within the endpoint index of
+    //! the first endpoint descriptor following the interface descriptor.
+    //! This field is unused for endpoint descriptors.
+    //
+    uint8_t ui8FirstEndpoint;
+}
+tConfigCacheEntry;
+
+//*****************************************************************************
+//
+//! This structure holds a configuration descriptor that has been compiled
+//! into a single block of descriptor data by USBDCDConfigCacheInit() along
+//! with an index of its interface and endpoint descriptors.  The USB library
+//! uses the cache, when one has been registered for a configuration, to
+//! answer GET_DESCRIPTOR requests and to look up interfaces and endpoints
+//! without walking the configuration descriptor sections.  The structure is
+//! filled in by USBDCDConfigCacheInit() and must not be modified by the
+//! application.
+//
+//*****************************************************************************
+struct tConfigCache
+{
+    //
+    //! The next cache in the list of caches registered with the USB library.
+    //
+    tConfigCache *psNext;
+
+    //
+    //! The configuration descriptor which was compiled into this cache.
+    //
+    const tConfigHeader *psConfig;
+
+    //
+    //! The complete configuration descriptor, with \e wTotalLength set.
+    //
+    const uint8_t *pui8Desc;
+
+    //
+    //! The total size of the configuration descriptor in bytes.
+    //
+    uint16_t ui16Size;
+
+    //
+    //! The number of interface descriptors, including alternate settings.
+    //
+    uint8_t ui8NumInterfaces;
+
+    //
+    //! The number of endpoint descriptors.
+    //
+    uint8_t ui8NumEndpoints;
+
+    //
+    //! The index of interface descriptors in the order they appear in the
+    //! configuration descriptor.
+    //
+    const tConfigCacheEntry *psInterfaces;
+
+    //
+    //! The index of endpoint descriptors in the order they appear in the
+    //! configuration descriptor.
+    //
+    const tConfigCacheEntry *psEndpoints;
 };
 
+//*****************************************************************************
+//
+//! This structure holds the event dispatch statistics kept by the composite
+//! device class for each device in a composite device.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of endpoint events passed to the device.
+    //
+    uint32_t ui32EndpointEvents;
+
+    //
+    //! The number of endpoint events that were not passed to the device
+    //! because none of its endpoints needed service.
+    //
+    uint32_t ui32EndpointSkipped;
+
+    //
+    //! The number of standard, class and vendor requests passed to the
+    //! device.
+    //
+    uint32_t ui32Requests;
+
+    //
+    //! The number of endpoint 0 data sent and data received events passed
+    //! to the device.
+    //
+    uint32_t ui32EP0Events;
+}
+tCompositeStats;
+
 //*****************************************************************************
 //
 //! This type is used by an application to describe and instance of a device
@@ -150,6 +335,12 @@ typedef struct
     //! A per-device workspace used by the composite device.
     //
     uint32_t ui32DeviceWorkspace;
+
+    //
+    //! The event dispatch statistics for this device, maintained by the
+    //! composite device.
+    //
+    tCompositeStats sStats;
 }
 tCompositeEntry;
 
@@ -194,12 +385,19 @@ extern tEndpointDescriptor *
                                         uint32_t ui32InterfaceNumber,
                                         uint32_t ui32AltCfg,
                                         uint32_t ui32Index);
+extern uint32_t USBDCDConfigCacheSize(const tConfigHeader *psConfig);
+extern bool USBDCDConfigCacheInit(uint32_t ui32Index,
+                                  const tConfigHeader *psConfig,
+                                  tConfigCache *psCache,
+                                  uint8_t *pui8Workspace, uint32_t ui32Size);
 extern bool USBDCDRemoteWakeupRequest(uint32_t ui32Index);
 extern bool USBDCDFeatureSet(uint32_t ui32Index, uint32_t ui32Feature,
                              void *pvFeature);
 extern bool USBDCDFeatureGet(uint32_t ui32Index, uint32_t ui32Feature,
                              void *pvFeature);
 extern bool USBDCDRemoteWakeLPM(uint32_t ui32Index);
+extern void USBDCDStatsGet(uint32_t ui32Index, tUSBDCDStats *psStats);
+extern void USBDCDStatsClear(uint32_t ui32Index);
 
 //*****************************************************************************
 //
@@ -85,6 +85,7 @@ typedef enum
 tEP0State;
 
 typedef struct tDeviceInfo tDeviceInfo;
+typedef struct tConfigCache tConfigCache;
 
 //*****************************************************************************
 //
@@ -165,6 +166,18 @@ typedef struct
     //
     uint8_t ui8ConfigIndex;
 
+    //
+    // This flag is set while the configuration being sent to the host is an
+    // other speed configuration descriptor.
+    //
+    bool bOtherSpeedConfig;
+
+    //
+    // This flag is set if the configurations in the device information
+    // structure are those for high speed operation.
+    //
+    bool bHighSpeedConfig;
+
     //
     // This flag is set to true if the client has called USBDPowerStatusSet()
     // and tells the USB library not to try to determine the current power
@@ -189,6 +202,12 @@ typedef struct
     //
     tUSBDMAInstance *psDMAInstance;
 
+    //
+    // The DMA channels, in the format returned by USBLibDMAIntStatus(), whose
+    // transfers completed in the interrupt being handled.
+    //
+    uint32_t ui32DMAIntStatus;
+
     //
     // The interrupt number for this instance.
     //
@@ -208,6 +227,18 @@ typedef struct
     // Device feature flags.
     //
     uint32_t ui32Features;
+
+    //
+    // The list of compiled configuration descriptors registered using
+    // USBDCDConfigCacheInit().
+    //
+    tConfigCache *psConfigCache;
+
+    //
+    // The enumeration statistics and the time of the last bus reset.
+    //
+    tUSBDCDStats sStats;
+    uint32_t ui32ResetTime;
 }
 tDCDInstance;
 
@@ -228,6 +259,8 @@ extern bool USBDeviceConfigAlternate(tDCDInstance *psDevInst,
                                      uint8_t ui8AlternateSetting);
 
 extern void USBDCDDeviceInfoInit(uint32_t ui32Index, tDeviceInfo *psDevice);
+extern const tConfigCache *
+       USBDCDConfigCacheFind(const tConfigHeader *psConfig);
 
 //*****************************************************************************
 //
@@ -27,6 +27,7 @@
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/usb.h"
 #include "driverlib/rom.h"
 #include "driverlib/rom_map.h"
@@ -73,6 +74,49 @@
 #define HID_DO_PACKET_RX        5
 #define HID_DO_SEND_IDLE_REPORT 6
 
+//*****************************************************************************
+//
+// The header placed at the start of each entry in the report queue.  The
+// report data follows immediately after the header.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The USB frame number in which the report was submitted.
+    //
+    uint32_t ui32Frame;
+
+    //
+    // The number of bytes in the report.
+    //
+    uint16_t ui16Length;
+
+    //
+    // Padding to keep the report data word aligned.
+    //
+    uint16_t ui16Reserved;
+}
+tHIDQueueEntry;
+
+//*****************************************************************************
+//
+// Returns a pointer to a given entry in the report queue and to the report
+// data held in that entry.
+//
+//*****************************************************************************
+#define QueueEntry(psInst, ui32Index)                                         \
+                                ((tHIDQueueEntry *)((psInst)->pui8Queue +     \
+                                 ((ui32Index) * (psInst)->ui16QueueSlotSize)))
+#define QueueEntryData(psEntry) ((uint8_t *)(psEntry) + sizeof(tHIDQueueEntry))
+
+//*****************************************************************************
+//
+// The USB frame number counter wraps at this value.
+//
+//*****************************************************************************
+#define HID_FRAME_MASK          0x7FF
+
 //*****************************************************************************
 //
 // Endpoints to use for each of the required endpoints in the driver.
@@ -711,6 +755,122 @@ ScheduleReportTransmission(tHIDInstance *psHIDInst)
     return(i32Retcode);
 }
 
+//*****************************************************************************
+//
+// Records the latency of the report whose transmission has just completed.
+//
+// \param psHIDInst points to the HID device instance whose report was
+// acknowledged by the host.
+//
+// The latency is the number of USB frames between the submission of the
+// report and the interrupt IN transaction in which the host acknowledged the
+// last packet of the report.  It is added to a histogram with logarithmic
+// bins.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+ReportLatencyUpdate(tHIDInstance *psHIDInst)
+{
+    uint32_t ui32Latency, ui32Bin;
+
+    ui32Latency = (MAP_USBFrameNumberGet(psHIDInst->ui32USBBase) -
+                   psHIDInst->ui32InReportFrame) & HID_FRAME_MASK;
+
+    //
+    // Find the first bin whose upper limit is above the latency.
+    //
+    for(ui32Bin = 0; ui32Latency && (ui32Bin < (USBDHID_LATENCY_BINS - 1));
+        ui32Bin++)
+    {
+        ui32Latency >>= 1;
+    }
+
+    psHIDInst->sStats.pui32Latency[ui32Bin]++;
+    psHIDInst->sStats.ui32Sent++;
+}
+
+//*****************************************************************************
+//
+// Discards any reports held in the report queue.
+//
+// \param psHIDInst points to the HID device instance whose queue is to be
+// emptied.
+//
+// This function is called when the host configures the device or the device
+// is disconnected since any reports still queued at that point are stale.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+ReportQueueReset(tHIDInstance *psHIDInst)
+{
+    psHIDInst->ui8QueueRead = 0;
+    psHIDInst->ui8QueueCount = 0;
+    psHIDInst->bQueueInFlight = false;
+}
+
+//*****************************************************************************
+//
+// Starts transmission of the oldest report in the report queue.
+//
+// \param psHIDDevice is the device instance whose queued report is to be
+// sent.
+//
+// This function must only be called when the transmitter is idle and the
+// report queue is not empty.  It is called either from the endpoint interrupt
+// handler or with interrupts disabled.  The queue entry remains in place
+// until the host acknowledges the report so that the data it holds is not
+// overwritten while it is being sent.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+ReportQueueSend(tUSBDHIDDevice *psHIDDevice)
+{
+    tHIDInstance *psInst;
+    tHIDQueueEntry *psEntry;
+
+    psInst = &psHIDDevice->sPrivateData;
+    psEntry = QueueEntry(psInst, psInst->ui8QueueRead);
+
+    //
+    // Clear the elapsed time since this report was last sent.
+    //
+    if(psEntry->ui16Length)
+    {
+        ClearReportTimer(psHIDDevice, *QueueEntryData(psEntry));
+    }
+
+    //
+    // Point the transmit state at the queued report and send its first
+    // packet.
+    //
+    psInst->pui8InReportData = QueueEntryData(psEntry);
+    psInst->ui16InReportIndex = 0;
+    psInst->ui16InReportSize = psEntry->ui16Length;
+    psInst->ui32InReportFrame = psEntry->ui32Frame;
+    psInst->bQueueInFlight = true;
+    psInst->iHIDTxState = eHIDStateWaitData;
+
+    if(ScheduleReportTransmission(psInst) == -1)
+    {
+        //
+        // The report could not be written to the FIFO so discard it rather
+        // than stall the queue.
+        //
+        psInst->iHIDTxState = eHIDStateIdle;
+        psInst->bQueueInFlight = false;
+        psInst->ui8QueueRead = (psInst->ui8QueueRead + 1) %
+                               psInst->ui8QueueSlots;
+        psInst->ui8QueueCount--;
+        psInst->sStats.ui32Dropped++;
+    }
+}
+
 //*****************************************************************************
 //
 // Receives notifications related to data received from the host.
@@ -850,8 +1010,20 @@ ProcessDataToHost(tUSBDHIDDevice *psHIDDevice, uint32_t ui32Status)
         //
         // We finished sending the last report so are idle once again.
         //
+        ReportLatencyUpdate(psInst);
         psInst->iHIDTxState = eHIDStateIdle;
 
+        //
+        // If the report came from the queue, release its entry.
+        //
+        if(psInst->bQueueInFlight)
+        {
+            psInst->bQueueInFlight = false;
+            psInst->ui8QueueRead = (psInst->ui8QueueRead + 1) %
+                                   psInst->ui8QueueSlots;
+            psInst->ui8QueueCount--;
+        }
+
         //
         // Notify the client that the report transmission completed.
         //
@@ -859,6 +1031,16 @@ ProcessDataToHost(tUSBDHIDDevice *psHIDDevice, uint32_t ui32Status)
                                    USB_EVENT_TX_COMPLETE,
                                    psInst->ui16InReportSize, (void *)0);
 
+        //
+        // Send the next queued report, if any, so that it is ready for the
+        // next interrupt IN transaction from the host.  Reports waiting in
+        // the queue take priority over those due to idle timer timeouts.
+        //
+        if(psInst->ui8QueueCount && (psInst->iHIDTxState == eHIDStateIdle))
+        {
+            ReportQueueSend(psHIDDevice);
+        }
+
         //
         // Do we have any reports to send as a result of idle timer timeouts?
         //
@@ -954,6 +1136,11 @@ HandleConfigChange(void *pvHIDInstance, uint32_t ui32Info)
     psInst->iHIDRxState = eHIDStateIdle;
     psInst->iHIDTxState = eHIDStateIdle;
 
+    //
+    // Throw away any reports queued before this configuration.
+    //
+    ReportQueueReset(psInst);
+
     //
     // If we are not currently connected let the client know we are open for
     // business.
@@ -1113,6 +1300,11 @@ HandleDisconnect(void *pvHIDInstance)
     // Remember that we are no longer connected.
     //
     psHIDDevice->sPrivateData.bConnected = false;
+
+    //
+    // Any reports still waiting to be sent are now stale.
+    //
+    ReportQueueReset(&psHIDDevice->sPrivateData);
 }
 
 //*****************************************************************************
@@ -1882,6 +2074,7 @@ USBDHIDCompositeInit(uint32_t ui32Index, tUSBDHIDDevice *psHIDDevice,
     psInst->sDevInfo.psCallbacks = &g_sHIDHandlers;
     psInst->sDevInfo.pui8DeviceDescriptor = g_pui8HIDDeviceDescriptor;
     psInst->sDevInfo.ppsConfigDescriptors = psHIDDevice->ppsConfigDescriptor;
+    psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
     psInst->sDevInfo.ppui8StringDescriptors =
                                         psHIDDevice->ppui8StringDescriptors;
     psInst->sDevInfo.ui32NumStringDescriptors =
@@ -1962,6 +2155,11 @@ USBDHIDCompositeInit(uint32_t ui32Index, tUSBDHIDDevice *psHIDDevice,
     psInst->pui8InReportData = (uint8_t *)0;
     psInst->ui16OutReportSize = 0;
     psInst->pui8OutReportData = (uint8_t *)0;
+    psInst->pui8Queue = (uint8_t *)0;
+    psInst->ui8QueueSlots = 0;
+    psInst->ui16QueueSlotSize = 0;
+    ReportQueueReset(psInst);
+    USBDHIDReportStatsClear((void *)psHIDDevice);
 
     //
     // Initialize the device info structure for the HID device.
@@ -2192,6 +2390,7 @@ USBDHIDReportWrite(void *pvHIDInstance, uint8_t *pi8Data, uint32_t ui32Length,
     psInst->pui8InReportData = pi8Data;
     psInst->ui16InReportIndex = 0;
     psInst->ui16InReportSize = ui32Length;
+    psInst->ui32InReportFrame = MAP_USBFrameNumberGet(psInst->ui32USBBase);
 
     //
     // Schedule transmission of the first packet of the report.
@@ -2494,6 +2693,331 @@ USBDHIDRemoteWakeupRequest(void *pvHIDInstance)
     return(USBDCDRemoteWakeupRequest(0));
 }
 
+//*****************************************************************************
+//
+//! Provides the HID device class driver with workspace for a report queue.
+//!
+//! \param pvHIDInstance is the pointer to the device instance structure as
+//! returned by USBDHIDInit() or USBDHIDCompositeInit().
+//! \param pvWorkspace points to a word-aligned buffer that the driver uses to
+//! hold queued reports.
+//! \param ui32Size is the size of the \e pvWorkspace buffer in bytes.
+//! \param ui32MaxSize is the size of the largest report that will be queued.
+//!
+//! This function enables the use of USBDHIDReportQueue() for the given HID
+//! instance.  The workspace is divided into as many entries of
+//! \e ui32MaxSize bytes as will fit, up to a maximum of 255.  The macro
+//! USBDHID_QUEUE_SIZE() may be used to determine the workspace size required
+//! to queue a given number of reports.  The function must be called after
+//! USBDHIDInit() or USBDHIDCompositeInit() since these functions disable the
+//! queue.  Passing a \e ui32Size of 0 disables the queue again.
+//!
+//! \return Returns \b true if the queue was configured or \b false if the
+//! workspace is too small to hold a single report.
+//
+//*****************************************************************************
+bool
+USBDHIDReportQueueConfig(void *pvHIDInstance, void *pvWorkspace,
+                         uint32_t ui32Size, uint32_t ui32MaxSize)
+{
+    tHIDInstance *psInst;
+    uint32_t ui32SlotSize, ui32Slots;
+    bool bIntsOff;
+
+    ASSERT(pvHIDInstance);
+    ASSERT(((uint32_t)pvWorkspace & 3) == 0);
+
+    psInst = &((tUSBDHIDDevice *)pvHIDInstance)->sPrivateData;
+
+    //
+    // Work out how many reports fit in the workspace.
+    //
+    ui32SlotSize = USBDHID_QUEUE_SIZE(1, ui32MaxSize);
+    ui32Slots = ui32Size / ui32SlotSize;
+    if(ui32Slots > 255)
+    {
+        ui32Slots = 255;
+    }
+
+    //
+    // Make sure the endpoint interrupt does not use the queue while it is
+    // being changed.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    //
+    // A report from the old queue may still be in flight.  It stays valid
+    // until acknowledged but must not be released from the new queue.
+    //
+    ReportQueueReset(psInst);
+
+    if(ui32Slots)
+    {
+        psInst->pui8Queue = (uint8_t *)pvWorkspace;
+        psInst->ui8QueueSlots = (uint8_t)ui32Slots;
+        psInst->ui16QueueSlotSize = (uint16_t)ui32SlotSize;
+    }
+    else
+    {
+        psInst->pui8Queue = (uint8_t *)0;
+        psInst->ui8QueueSlots = 0;
+        psInst->ui16QueueSlotSize = 0;
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+
+    return((ui32Slots != 0) || (ui32Size == 0));
+}
+
+//*****************************************************************************
+//
+//! Queues a HID device report for transmission to the USB host.
+//!
+//! \param pvHIDInstance is the pointer to the device instance structure as
+//! returned by USBDHIDInit() or USBDHIDCompositeInit().
+//! \param pui8Data points to the report which is to be transmitted.
+//! \param ui32Length is the number of bytes in the report.
+//! \param pfnCoalesce is the function used to merge this report into one
+//! that is already waiting in the queue or NULL if reports must never be
+//! merged.
+//!
+//! This function copies the report into the queue configured using
+//! USBDHIDReportQueueConfig() so, unlike USBDHIDReportWrite(), the caller may
+//! reuse the report buffer as soon as this function returns.  If the
+//! transmitter is idle, the report is sent immediately, otherwise it is sent
+//! when the host acknowledges the reports ahead of it.  A queued report is
+//! sent on each interrupt IN transaction from the host until the queue is
+//! empty.
+//!
+//! If \e pfnCoalesce is provided and the most recently queued report of the
+//! same length has not yet been handed to the USB controller, the function is
+//! called to merge the new report into it.  This allows a class to, for
+//! example, accumulate relative movement or replace an absolute state report
+//! while the host is busy rather than consuming another queue entry.  The
+//! coalesce function is called with interrupts disabled.
+//!
+//! If no queue has been configured, this function behaves as
+//! USBDHIDReportWrite().
+//!
+//! \return Returns \e ui32Length if the report was queued or merged or 0 if
+//! the queue was full or the report is too large for a queue entry.
+//
+//*****************************************************************************
+uint32_t
+USBDHIDReportQueue(void *pvHIDInstance, uint8_t *pui8Data, uint32_t ui32Length,
+                   tUSBDHIDCoalesce pfnCoalesce)
+{
+    tHIDInstance *psInst;
+    tHIDQueueEntry *psEntry;
+    uint32_t ui32Loop, ui32Waiting;
+    uint8_t *pui8Entry;
+    bool bIntsOff;
+
+    ASSERT(pvHIDInstance);
+
+    psInst = &((tUSBDHIDDevice *)pvHIDInstance)->sPrivateData;
+
+    //
+    // Without a queue, fall back to sending the report directly.
+    //
+    if(psInst->pui8Queue == 0)
+    {
+        return(USBDHIDReportWrite(pvHIDInstance, pui8Data, ui32Length, true));
+    }
+
+    //
+    // Is the report too large to fit in a queue entry?
+    //
+    if(ui32Length > (psInst->ui16QueueSlotSize - sizeof(tHIDQueueEntry)))
+    {
+        return(0);
+    }
+
+    //
+    // Keep the endpoint interrupt out of the queue while it is updated.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    psInst->sStats.ui32Queued++;
+
+    //
+    // Determine how many queued reports have not yet been handed to the USB
+    // controller and can therefore still be changed.
+    //
+    ui32Waiting = psInst->ui8QueueCount;
+    if(psInst->bQueueInFlight)
+    {
+        ui32Waiting--;
+    }
+
+    //
+    // Try to merge the report into the newest waiting report.
+    //
+    if(pfnCoalesce && ui32Waiting)
+    {
+        psEntry = QueueEntry(psInst, (psInst->ui8QueueRead +
+                                      psInst->ui8QueueCount - 1) %
+                                     psInst->ui8QueueSlots);
+
+        if((psEntry->ui16Length == ui32Length) &&
+           pfnCoalesce(QueueEntryData(psEntry), pui8Data, ui32Length))
+        {
+            psInst->sStats.ui32Coalesced++;
+
+            if(!bIntsOff)
+            {
+                MAP_IntMasterEnable();
+            }
+
+            return(ui32Length);
+        }
+    }
+
+    //
+    // Is there space for another report?
+    //
+    if(psInst->ui8QueueCount == psInst->ui8QueueSlots)
+    {
+        psInst->sStats.ui32Dropped++;
+
+        if(!bIntsOff)
+        {
+            MAP_IntMasterEnable();
+        }
+
+        return(0);
+    }
+
+    //
+    // Copy the report into the next free entry.
+    //
+    psEntry = QueueEntry(psInst, (psInst->ui8QueueRead +
+                                  psInst->ui8QueueCount) %
+                                 psInst->ui8QueueSlots);
+    psEntry->ui32Frame = MAP_USBFrameNumberGet(psInst->ui32USBBase);
+    psEntry->ui16Length = (uint16_t)ui32Length;
+    pui8Entry = QueueEntryData(psEntry);
+
+    for(ui32Loop = 0; ui32Loop < ui32Length; ui32Loop++)
+    {
+        pui8Entry[ui32Loop] = pui8Data[ui32Loop];
+    }
+
+    psInst->ui8QueueCount++;
+
+    //
+    // If the transmitter is idle, start sending the report now.
+    //
+    if((psInst->iHIDTxState == eHIDStateIdle) && !psInst->bSendInProgress)
+    {
+        ReportQueueSend((tUSBDHIDDevice *)pvHIDInstance);
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+
+    return(ui32Length);
+}
+
+//*****************************************************************************
+//
+//! Returns the report transmission statistics for a HID device.
+//!
+//! \param pvHIDInstance is the pointer to the device instance structure as
+//! returned by USBDHIDInit() or USBDHIDCompositeInit().
+//! \param psStats points to the structure that is written with the
+//! statistics.
+//!
+//! This function returns counts of the reports queued, merged, dropped and
+//! sent along with a histogram of the latency between the submission of each
+//! report and its acknowledgment by the host.  Reports sent directly using
+//! USBDHIDReportWrite() are included in the sent count and latency histogram
+//! with a latency measured from the call to USBDHIDReportWrite().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBDHIDReportStatsGet(void *pvHIDInstance, tUSBDHIDReportStats *psStats)
+{
+    tHIDInstance *psInst;
+    uint32_t ui32Loop;
+    bool bIntsOff;
+
+    ASSERT(pvHIDInstance);
+    ASSERT(psStats);
+
+    psInst = &((tUSBDHIDDevice *)pvHIDInstance)->sPrivateData;
+
+    //
+    // Take a consistent snapshot of the statistics.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    psStats->ui32Queued = psInst->sStats.ui32Queued;
+    psStats->ui32Coalesced = psInst->sStats.ui32Coalesced;
+    psStats->ui32Dropped = psInst->sStats.ui32Dropped;
+    psStats->ui32Sent = psInst->sStats.ui32Sent;
+
+    for(ui32Loop = 0; ui32Loop < USBDHID_LATENCY_BINS; ui32Loop++)
+    {
+        psStats->pui32Latency[ui32Loop] =
+                                    psInst->sStats.pui32Latency[ui32Loop];
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Clears the report transmission statistics for a HID device.
+//!
+//! \param pvHIDInstance is the pointer to the device instance structure as
+//! returned by USBDHIDInit() or USBDHIDCompositeInit().
+//!
+//! This function resets all the counts returned by USBDHIDReportStatsGet()
+//! to zero.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBDHIDReportStatsClear(void *pvHIDInstance)
+{
+    tHIDInstance *psInst;
+    uint32_t ui32Loop;
+    bool bIntsOff;
+
+    ASSERT(pvHIDInstance);
+
+    psInst = &((tUSBDHIDDevice *)pvHIDInstance)->sPrivateData;
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    psInst->sStats.ui32Queued = 0;
+    psInst->sStats.ui32Coalesced = 0;
+    psInst->sStats.ui32Dropped = 0;
+    psInst->sStats.ui32Sent = 0;
+
+    for(ui32Loop = 0; ui32Loop < USBDHID_LATENCY_BINS; ui32Loop++)
+    {
+        psInst->sStats.pui32Latency[ui32Loop] = 0;
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
 //*****************************************************************************
 //
 // Close the Doxygen group.
@@ -655,6 +655,78 @@ typedef enum
 }
 tHIDState;
 
+//*****************************************************************************
+//
+//! The number of entries in the report latency histogram held in
+//! tUSBDHIDReportStats.
+//
+//*****************************************************************************
+#define USBDHID_LATENCY_BINS    8
+
+//*****************************************************************************
+//
+//! This macro returns the number of bytes of workspace that must be passed to
+//! USBDHIDReportQueueConfig() to hold \e ui32Reports queued reports each of
+//! up to \e ui32MaxSize bytes.
+//
+//*****************************************************************************
+#define USBDHID_QUEUE_SIZE(ui32Reports, ui32MaxSize)                          \
+                                ((ui32Reports) *                              \
+                                 ((((ui32MaxSize) + 3) & ~3) + 8))
+
+//*****************************************************************************
+//
+//! The structure used to return report transmission statistics from
+//! USBDHIDReportStatsGet().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of reports passed to USBDHIDReportQueue().
+    //
+    uint32_t ui32Queued;
+
+    //
+    //! The number of reports that were merged into a report already waiting
+    //! in the queue rather than occupying a queue entry of their own.
+    //
+    uint32_t ui32Coalesced;
+
+    //
+    //! The number of reports that were discarded because the queue was full.
+    //
+    uint32_t ui32Dropped;
+
+    //
+    //! The number of reports that have been acknowledged by the host.
+    //
+    uint32_t ui32Sent;
+
+    //
+    //! A histogram of the time from submission of a report to its
+    //! acknowledgment by the host, measured in USB frames.  Entry 0 counts
+    //! reports acknowledged within the frame in which they were submitted and
+    //! entry n counts latencies from 2^(n-1) to (2^n - 1) frames.  The final
+    //! entry also counts all longer latencies.
+    //
+    uint32_t pui32Latency[USBDHID_LATENCY_BINS];
+}
+tUSBDHIDReportStats;
+
+//*****************************************************************************
+//
+//! The prototype of a function that merges a new report into one that is
+//! waiting in the report queue.  \e pui8Queued points to the queued report,
+//! \e pui8Report to the new report and \e ui32Length is the size of both.
+//! The function returns \b true if the new report was merged into the queued
+//! one or \b false if the new report must be queued separately.
+//
+//*****************************************************************************
+typedef bool (*tUSBDHIDCoalesce)(uint8_t *pui8Queued,
+                                 const uint8_t *pui8Report,
+                                 uint32_t ui32Length);
+
 //*****************************************************************************
 //
 // PRIVATE
@@ -747,6 +819,38 @@ typedef struct
     // The bulk class interface number, this is modified in composite devices.
     //
     uint8_t ui8Interface;
+
+    //
+    // Whether the report currently being transmitted came from the report
+    // queue.
+    //
+    volatile bool bQueueInFlight;
+
+    //
+    // The report queue workspace, the number of reports it holds and the size
+    // of each entry in bytes.
+    //
+    uint8_t *pui8Queue;
+    uint8_t ui8QueueSlots;
+    uint16_t ui16QueueSlotSize;
+
+    //
+    // The index of the oldest entry in the report queue and the number of
+    // entries currently in use.
+    //
+    volatile uint8_t ui8QueueRead;
+    volatile uint8_t ui8QueueCount;
+
+    //
+    // The USB frame number in which the report currently being transmitted
+    // was submitted.
+    //
+    uint32_t ui32InReportFrame;
+
+    //
+    // Report transmission statistics.
+    //
+    tUSBDHIDReportStats sStats;
 }
 tHIDInstance;
 
@@ -1068,6 +1172,14 @@ extern uint32_t USBDHIDPacketRead(void *pvHIDInstance, uint8_t *pi8Data,
 extern uint32_t USBDHIDTxPacketAvailable(void *pvHIDInstance);
 extern uint32_t USBDHIDRxPacketAvailable(void *pvHIDInstance);
 extern bool USBDHIDRemoteWakeupRequest(void *pvHIDInstance);
+extern bool USBDHIDReportQueueConfig(void *pvHIDInstance, void *pvWorkspace,
+                                     uint32_t ui32Size, uint32_t ui32MaxSize);
+extern uint32_t USBDHIDReportQueue(void *pvHIDInstance, uint8_t *pui8Data,
+                                   uint32_t ui32Length,
+                                   tUSBDHIDCoalesce pfnCoalesce);
+extern void USBDHIDReportStatsGet(void *pvHIDInstance,
+                                  tUSBDHIDReportStats *psStats);
+extern void USBDHIDReportStatsClear(void *pvHIDInstance);
 
 //*****************************************************************************
 //
@@ -283,6 +283,35 @@ static const uint8_t *g_ppui8GameClassDescriptors[] =
     g_pui8GameReportDescriptor
 };
 
+//*****************************************************************************
+//
+// Merges a new gamepad report into one that is waiting in the report queue.
+//
+// \param pui8Queued points to the report waiting in the queue.
+// \param pui8Report points to the new report.
+// \param ui32Length is the size of both reports.
+//
+// Gamepad reports carry the absolute state of the controls so the new report
+// simply replaces the waiting one and the host always receives the latest
+// state.
+//
+// \return Always returns \b true.
+//
+//*****************************************************************************
+static bool
+GamepadReportCoalesce(uint8_t *pui8Queued, const uint8_t *pui8Report,
+                      uint32_t ui32Length)
+{
+    uint32_t ui32Loop;
+
+    for(ui32Loop = 0; ui32Loop < ui32Length; ui32Loop++)
+    {
+        pui8Queued[ui32Loop] = pui8Report[ui32Loop];
+    }
+
+    return(true);
+}
+
 //*****************************************************************************
 //
 // HID gamepad transmit channel event handler function.
@@ -596,6 +625,15 @@ USBDHIDGamepadInit(uint32_t ui32Index, tUSBDHIDGamepadDevice *psGamepad)
         //
         pvRetcode = USBDHIDInit(ui32Index, psHIDDevice);
 
+        //
+        // USBDHIDInit() resets the report queue so hand it the workspace
+        // again.
+        //
+        USBDHIDReportQueueConfig((void *)psHIDDevice,
+                                 psGamepad->sPrivateData.pui32Queue,
+                                 sizeof(psGamepad->sPrivateData.pui32Queue),
+                                 USBDHID_MAX_PACKET);
+
         return(psGamepad);
     }
     else
@@ -634,6 +672,7 @@ USBDHIDGamepadCompositeInit(uint32_t ui32Index,
 {
     tUSBDGamepadInstance *psInst;
     tUSBDHIDDevice *psHIDDevice;
+    void *pvRetcode;
 
     //
     // Check parameter validity.
@@ -706,7 +745,20 @@ USBDHIDGamepadCompositeInit(uint32_t ui32Index,
     // Initialize the lower layer HID driver and pass it the various structures
     // and descriptors necessary to declare that we are a gamepad.
     //
-    return(USBDHIDCompositeInit(ui32Index, psHIDDevice, psCompEntry));
+    pvRetcode = USBDHIDCompositeInit(ui32Index, psHIDDevice, psCompEntry);
+
+    //
+    // Give the HID driver somewhere to hold the latest report while the
+    // previous one is waiting to be collected by the host.
+    //
+    if(pvRetcode)
+    {
+        USBDHIDReportQueueConfig((void *)psHIDDevice, psInst->pui32Queue,
+                                 sizeof(psInst->pui32Queue),
+                                 USBDHID_MAX_PACKET);
+    }
+
+    return(pvRetcode);
 }
 
 //*****************************************************************************
@@ -719,10 +771,12 @@ USBDHIDGamepadCompositeInit(uint32_t ui32Index,
 //! \param ui32Size is the number of bytes in the \e pvReport buffer.
 //!
 //! This call is made by an application to schedule data to be sent to the
-//! host when the host requests an update from the device.  The application
-//! must then wait for a \b USB_EVENT_TX_COMPLETE event in the function
-//! provided in the \e pfnCallback pointer in the tUSBDHIDGamepadDevice
-//! structure before being able to send more data with this function.  The
+//! host when the host requests an update from the device.  If a previous
+//! report is still waiting to be collected by the host, the new report
+//! replaces any report queued behind it so the host always receives the
+//! latest state on its next poll.  A \b USB_EVENT_TX_COMPLETE event is sent
+//! to the function provided in the \e pfnCallback pointer in the
+//! tUSBDHIDGamepadDevice structure as each report is acknowledged.  The
 //! pointer passed in the \e pvReport can be updated once this call returns as
 //! the data has been copied from the buffer.  The function returns
 //! \b USBDGAMEPAD_SUCCESS if the transmission was successfully scheduled or
@@ -761,35 +815,26 @@ USBDHIDGamepadSendReport(tUSBDHIDGamepadDevice *psHIDGamepad, void *pvReport,
     }
 
     //
-    // Only send a report if the transmitter is currently free.
+    // Queue the report for the host, replacing any older report that is
+    // still waiting to be sent.
     //
-    if(USBDHIDTxPacketAvailable((void *)psHIDDevice))
-    {
-        //
-        // Send the report to the host.
-        //
-        psInst->iState = eHIDGamepadStateSending;
-        ui32Count = USBDHIDReportWrite((void *)psHIDDevice, pvReport, ui32Size,
-                                       true);
+    psInst->iState = eHIDGamepadStateSending;
+    ui32Count = USBDHIDReportQueue((void *)psHIDDevice, pvReport, ui32Size,
+                                   GamepadReportCoalesce);
 
+    //
+    // Did we queue the report correctly?
+    //
+    if(ui32Count == 0)
+    {
         //
-        // Did we schedule a packet for transmission correctly?
+        // No - report the error to the caller.
         //
-        if(ui32Count == 0)
-        {
-            //
-            // No - report the error to the caller.
-            //
-            ui32Retcode = USBDGAMEPAD_TX_ERROR;
-        }
-        else
-        {
-            ui32Retcode = USBDGAMEPAD_SUCCESS;
-        }
+        ui32Retcode = USBDGAMEPAD_TX_ERROR;
     }
     else
     {
-        ui32Retcode = USBDGAMEPAD_TX_ERROR;
+        ui32Retcode = USBDGAMEPAD_SUCCESS;
     }
 
     //
@@ -72,6 +72,17 @@ typedef enum
 }
 tGamepadState;
 
+//*****************************************************************************
+//
+// PRIVATE
+//
+// The number of reports held in the game pad report queue.  One entry holds
+// the report being sent while the other holds the latest state waiting to be
+// sent.
+//
+//*****************************************************************************
+#define GAMEPAD_QUEUE_DEPTH     2
+
 //*****************************************************************************
 //
 // PRIVATE
@@ -97,6 +108,12 @@ typedef struct
     // required by the lower level HID driver.
     //
     tHIDReportIdle sReportIdle;
+
+    //
+    // The workspace used by the lower level HID driver to queue reports.
+    //
+    uint32_t pui32Queue[USBDHID_QUEUE_SIZE(GAMEPAD_QUEUE_DEPTH,
+                                           USBDHID_MAX_PACKET) / 4];
 } tUSBDGamepadInstance;
 
 //*****************************************************************************
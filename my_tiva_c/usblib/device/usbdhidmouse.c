@@ -304,6 +304,50 @@ static uint32_t HIDMouseTxHandler(void *pvMouseDevice, uint32_t ui32Event,
 #define HID_REPORT_X            1
 #define HID_REPORT_Y            2
 
+//*****************************************************************************
+//
+// Merges a new mouse report into one that is waiting in the report queue.
+//
+// \param pui8Queued points to the report waiting in the queue.
+// \param pui8Report points to the new report.
+// \param ui32Length is the size of both reports.
+//
+// Movement is relative so the pointer deltas of the two reports are added
+// together.  Reports are only merged if the button state is unchanged, so
+// that every button press and release reaches the host, and if the combined
+// movement still fits in a single report.
+//
+// \return Returns \b true if the reports were merged or \b false otherwise.
+//
+//*****************************************************************************
+static bool
+MouseReportCoalesce(uint8_t *pui8Queued, const uint8_t *pui8Report,
+                    uint32_t ui32Length)
+{
+    int32_t i32DeltaX, i32DeltaY;
+
+    if(pui8Queued[HID_REPORT_BUTTONS] != pui8Report[HID_REPORT_BUTTONS])
+    {
+        return(false);
+    }
+
+    i32DeltaX = (int32_t)(int8_t)pui8Queued[HID_REPORT_X] +
+                (int32_t)(int8_t)pui8Report[HID_REPORT_X];
+    i32DeltaY = (int32_t)(int8_t)pui8Queued[HID_REPORT_Y] +
+                (int32_t)(int8_t)pui8Report[HID_REPORT_Y];
+
+    if((i32DeltaX < -127) || (i32DeltaX > 127) ||
+       (i32DeltaY < -127) || (i32DeltaY > 127))
+    {
+        return(false);
+    }
+
+    pui8Queued[HID_REPORT_X] = (uint8_t)i32DeltaX;
+    pui8Queued[HID_REPORT_Y] = (uint8_t)i32DeltaY;
+
+    return(true);
+}
+
 //*****************************************************************************
 //
 // Main HID device class event handler function.
@@ -612,6 +656,15 @@ USBDHIDMouseInit(uint32_t ui32Index, tUSBDHIDMouseDevice *psMouseDevice)
         //
         pvRetcode = USBDHIDInit(ui32Index, psHIDDevice);
 
+        //
+        // USBDHIDInit() resets the report queue so hand it the workspace
+        // again.
+        //
+        USBDHIDReportQueueConfig((void *)psHIDDevice,
+                            psMouseDevice->sPrivateData.pui32Queue,
+                            sizeof(psMouseDevice->sPrivateData.pui32Queue),
+                            MOUSE_REPORT_SIZE);
+
         return((void *)psMouseDevice);
     }
     else
@@ -649,7 +702,7 @@ USBDHIDMouseCompositeInit(uint32_t ui32Index,
 {
     tHIDMouseInstance *psInst;
     tUSBDHIDDevice *psHIDDevice;
-
+    void *pvRetcode;
 
     //
     // Check parameter validity.
@@ -708,7 +761,20 @@ USBDHIDMouseCompositeInit(uint32_t ui32Index,
     // Initialize the lower layer HID driver and pass it the various structures
     // and descriptors necessary to declare that we are a keyboard.
     //
-    return(USBDHIDCompositeInit(ui32Index, psHIDDevice, psCompEntry));
+    pvRetcode = USBDHIDCompositeInit(ui32Index, psHIDDevice, psCompEntry);
+
+    //
+    // Give the HID driver somewhere to queue reports that are generated
+    // while the host has yet to collect earlier ones.
+    //
+    if(pvRetcode)
+    {
+        USBDHIDReportQueueConfig((void *)psHIDDevice, psInst->pui32Queue,
+                                 sizeof(psInst->pui32Queue),
+                                 MOUSE_REPORT_SIZE);
+    }
+
+    return(pvRetcode);
 }
 
 //*****************************************************************************
@@ -825,13 +891,16 @@ USBDHIDMouseSetCBData(void *pvMouseDevice, void *pvCBData)
 //! its previous position, or changes in the states of up to 3 buttons that
 //! the mouse may support.  The return code indicates whether or not the
 //! mouse report could be sent to the host.  In cases where a previous
-//! report is still being transmitted, \b MOUSE_ERR_TX_ERROR is returned
-//! and the state change is ignored.
+//! report is still being transmitted, the state change is queued and sent on
+//! a following interrupt IN transaction.  Pointer movements reported while
+//! the button state is unchanged are added to the queued report so that no
+//! movement is lost when the application reports changes more often than
+//! the host polls the device.
 //!
 //! \return Returns \b MOUSE_SUCCESS on success, \b MOUSE_ERR_TX_ERROR if an
 //! error occurred while attempting to schedule transmission of the mouse
-//! report to the host (typically due to a previous report which has not yet
-//! completed transmission or due to disconnection of the host) or \b
+//! report to the host (typically due to the report queue being full or due
+//! to disconnection of the host) or \b
 //! MOUSE_ERR_NOT_CONFIGURED if called before a host has connected to and
 //! configured the device.
 //
@@ -877,37 +946,28 @@ USBDHIDMouseStateChange(void *pvMouseDevice, int8_t i8DeltaX, int8_t i8DeltaY,
     }
 
     //
-    // Only send a report if the transmitter is currently free.
+    // Queue the report for the host, merging it with any report that is
+    // still waiting to be sent.
     //
-    if(USBDHIDTxPacketAvailable((void *)psHIDDevice))
-    {
-        //
-        // Send the report to the host.
-        //
-        psInst->iMouseState = eHIDMouseStateSend;
-        ui32Count = USBDHIDReportWrite((void *)psHIDDevice,
-                                       psInst->pui8Report, MOUSE_REPORT_SIZE,
-                                       true);
+    psInst->iMouseState = eHIDMouseStateSend;
+    ui32Count = USBDHIDReportQueue((void *)psHIDDevice, psInst->pui8Report,
+                                   MOUSE_REPORT_SIZE, MouseReportCoalesce);
 
+    //
+    // Did we queue the report correctly?
+    //
+    if(!ui32Count)
+    {
         //
-        // Did we schedule a packet for transmission correctly?
+        // No - report the error to the caller.
         //
-        if(!ui32Count)
-        {
-            //
-            // No - report the error to the caller.
-            //
-            ui32Retcode = MOUSE_ERR_TX_ERROR;
-        }
-        else
-        {
-            ui32Retcode = MOUSE_SUCCESS;
-        }
+        ui32Retcode = MOUSE_ERR_TX_ERROR;
     }
     else
     {
-        ui32Retcode = MOUSE_ERR_TX_ERROR;
+        ui32Retcode = MOUSE_SUCCESS;
     }
+
     //
     // Return the relevant error code to the caller.
     //
@@ -63,6 +63,16 @@ extern "C"
 //*****************************************************************************
 #define MOUSE_REPORT_SIZE       3
 
+//*****************************************************************************
+//
+// PRIVATE
+//
+// The number of mouse reports that can be queued while earlier reports are
+// waiting to be collected by the host.
+//
+//*****************************************************************************
+#define MOUSE_QUEUE_DEPTH       4
+
 //*****************************************************************************
 //
 // PRIVATE
@@ -123,6 +133,12 @@ typedef struct
     //
     uint8_t pui8Report[MOUSE_REPORT_SIZE];
 
+    //
+    // The workspace used by the lower level HID driver to queue reports.
+    //
+    uint32_t pui32Queue[USBDHID_QUEUE_SIZE(MOUSE_QUEUE_DEPTH,
+                                           MOUSE_REPORT_SIZE) / 4];
+
     //
     // The current state of the mouse interrupt IN endpoint.
     //
@@ -82,12 +82,16 @@
 
 //*****************************************************************************
 //
-// Maximum packet size for the bulk endpoints is 64 bytes.
+// Maximum packet size for the bulk endpoints is 64 bytes at full speed and
+// 512 bytes at high speed.
 //
 //*****************************************************************************
 #define DATA_IN_EP_MAX_SIZE     64
 #define DATA_OUT_EP_MAX_SIZE    64
 
+#define DATA_IN_EP_MAX_SIZE_HS  USBFIFOSizeToBytes(USB_FIFO_SZ_512)
+#define DATA_OUT_EP_MAX_SIZE_HS USBFIFOSizeToBytes(USB_FIFO_SZ_512)
+
 //*****************************************************************************
 //
 // These defines control the size of USB transfers for commands.
@@ -253,6 +257,45 @@ const uint8_t g_pui8MSCInterface[MSCINTERFACE_SIZE] =
     0,                              // The polling interval for this endpoint.
 };
 
+const uint8_t g_pui8MSCInterfaceHS[MSCINTERFACE_SIZE] =
+{
+    //
+    // Vendor-specific Interface Descriptor.
+    //
+    9,                              // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE,            // Type of this descriptor.
+    0,                              // The index for this interface.
+    0,                              // The alternate setting for this
+                                    // interface.
+    2,                              // The number of endpoints used by this
+                                    // interface.
+    USB_CLASS_MASS_STORAGE,         // The interface class
+    USB_MSC_SUBCLASS_SCSI,          // The interface sub-class.
+    USB_MSC_PROTO_BULKONLY,         // The interface protocol for the sub-class
+                                    // specified above.
+    0,                              // The string index for this interface.
+
+    //
+    // Endpoint Descriptor
+    //
+    7,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+    USB_EP_DESC_IN | USBEPToIndex(DATA_IN_ENDPOINT),
+    USB_EP_ATTR_BULK,               // Endpoint is a bulk endpoint.
+    USBShort(DATA_IN_EP_MAX_SIZE_HS),  // The maximum packet size.
+    0,                              // The polling interval for this endpoint.
+
+    //
+    // Endpoint Descriptor
+    //
+    7,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+    USB_EP_DESC_OUT | USBEPToIndex(DATA_OUT_ENDPOINT),
+    USB_EP_ATTR_BULK,               // Endpoint is a bulk endpoint.
+    USBShort(DATA_OUT_EP_MAX_SIZE_HS), // The maximum packet size.
+    0,                              // The polling interval for this endpoint.
+};
+
 //*****************************************************************************
 //
 // The mass storage configuration descriptor is defined as two sections,
@@ -272,6 +315,12 @@ const tConfigSection g_sMSCInterfaceSection =
     g_pui8MSCInterface
 };
 
+const tConfigSection g_sMSCInterfaceSectionHS =
+{
+    sizeof(g_pui8MSCInterfaceHS),
+    g_pui8MSCInterfaceHS
+};
+
 //*****************************************************************************
 //
 // This array lists all the sections that must be concatenated to make a
@@ -284,6 +333,12 @@ const tConfigSection *g_psMSCSections[] =
     &g_sMSCInterfaceSection
 };
 
+const tConfigSection *g_psMSCSectionsHS[] =
+{
+    &g_sMSCConfigSection,
+    &g_sMSCInterfaceSectionHS
+};
+
 #define NUM_MSC_SECTIONS        (sizeof(g_psMSCSections) /                    \
                                  sizeof(g_psMSCSections[0]))
 
@@ -300,6 +355,12 @@ const tConfigHeader g_sMSCConfigHeader =
     g_psMSCSections
 };
 
+const tConfigHeader g_sMSCConfigHeaderHS =
+{
+    NUM_MSC_SECTIONS,
+    g_psMSCSectionsHS
+};
+
 //*****************************************************************************
 //
 // Configuration Descriptor.
@@ -310,6 +371,18 @@ const tConfigHeader * const g_ppsMSCConfigDescriptors[] =
     &g_sMSCConfigHeader
 };
 
+const tConfigHeader * const g_ppsMSCConfigDescriptorsHS[] =
+{
+    &g_sMSCConfigHeaderHS
+};
+
+//*****************************************************************************
+//
+// Variable to get the maximum packet size for the bulk endpoints.
+//
+//*****************************************************************************
+static uint16_t g_ui16MaxPacketSize = DATA_IN_EP_MAX_SIZE;
+
 //*****************************************************************************
 //
 // Various internal handlers needed by this class.
@@ -834,7 +907,8 @@ HandleDevice(void *pvMSCDevice, uint32_t ui32Request, void *pvRequestData)
                 //
                 psInst->ui8INDMA =
                     USBLibDMAChannelAllocate(psInst->psDMAInstance,
-                                             psInst->ui8INEndpoint, 0,
+                                             psInst->ui8INEndpoint,
+                                             g_ui16MaxPacketSize,
                                              USB_DMA_EP_TX |
                                              USB_DMA_EP_DEVICE);
 
@@ -867,7 +941,8 @@ HandleDevice(void *pvMSCDevice, uint32_t ui32Request, void *pvRequestData)
                 //
                 psInst->ui8OUTDMA =
                     USBLibDMAChannelAllocate(psInst->psDMAInstance,
-                                             psInst->ui8OUTEndpoint, 0,
+                                             psInst->ui8OUTEndpoint,
+                                             g_ui16MaxPacketSize,
                                              USB_DMA_EP_RX |
                                              USB_DMA_EP_DEVICE);
 
@@ -987,6 +1062,16 @@ ConfigChangeHandler(void *pvMSCDevice, uint32_t ui32Value)
     //
     psMSCDevice = (tUSBDMSCDevice *)pvMSCDevice;
 
+    //
+    // The host may have configured the device at a speed other than the one
+    // chosen when the class was initialized, so take the packet size used
+    // for the DMA channels from the configuration in use.
+    //
+    g_ui16MaxPacketSize =
+        (psMSCDevice->sPrivateData.sDevInfo.ppsConfigDescriptors ==
+         g_ppsMSCConfigDescriptorsHS) ? DATA_IN_EP_MAX_SIZE_HS :
+                                        DATA_IN_EP_MAX_SIZE;
+
     //
     // If the DMA channel has already been allocated then clear
     // that channel and prepare to possibly use a new one.
@@ -1002,7 +1087,8 @@ ConfigChangeHandler(void *pvMSCDevice, uint32_t ui32Value)
     //
     psMSCDevice->sPrivateData.ui8OUTDMA =
         USBLibDMAChannelAllocate(psMSCDevice->sPrivateData.psDMAInstance,
-                                 psMSCDevice->sPrivateData.ui8OUTEndpoint, 64,
+                                 psMSCDevice->sPrivateData.ui8OUTEndpoint,
+                                 g_ui16MaxPacketSize,
                                  USB_DMA_EP_RX | USB_DMA_EP_DEVICE);
 
     USBLibDMAUnitSizeSet(psMSCDevice->sPrivateData.psDMAInstance,
@@ -1026,7 +1112,8 @@ ConfigChangeHandler(void *pvMSCDevice, uint32_t ui32Value)
     //
     psMSCDevice->sPrivateData.ui8INDMA =
         USBLibDMAChannelAllocate(psMSCDevice->sPrivateData.psDMAInstance,
-                                 psMSCDevice->sPrivateData.ui8INEndpoint, 64,
+                                 psMSCDevice->sPrivateData.ui8INEndpoint,
+                                 g_ui16MaxPacketSize,
                                  USB_DMA_EP_TX | USB_DMA_EP_DEVICE);
 
     USBLibDMAUnitSizeSet(psMSCDevice->sPrivateData.psDMAInstance,
@@ -1151,6 +1238,7 @@ USBDMSCCompositeInit(uint32_t ui32Index, tUSBDMSCDevice *psMSCDevice,
                      tCompositeEntry *psCompEntry)
 {
     tMSCInstance *psInst;
+    uint32_t ui32ulpiFeature = 0;
 
     //
     // Check parameter validity.
@@ -1184,6 +1272,22 @@ USBDMSCCompositeInit(uint32_t ui32Index, tUSBDMSCDevice *psMSCDevice,
     psInst->sDevInfo.psCallbacks = &g_sMSCHandlers;
     psInst->sDevInfo.pui8DeviceDescriptor = g_pui8MSCDeviceDescriptor;
     psInst->sDevInfo.ppsConfigDescriptors = g_ppsMSCConfigDescriptors;
+    psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
+
+    //
+    // Use 512 byte bulk packets if the ULPI PHY is running at high speed.
+    //
+    USBDCDFeatureGet(0, USBLIB_FEATURE_USBULPI, &ui32ulpiFeature);
+
+    g_ui16MaxPacketSize = DATA_IN_EP_MAX_SIZE;
+
+    if(USBLIB_FEATURE_ULPI_HS == ui32ulpiFeature)
+    {
+        psInst->sDevInfo.ppsConfigDescriptors = g_ppsMSCConfigDescriptorsHS;
+        psInst->sDevInfo.ppsOtherSpeedDescriptors = g_ppsMSCConfigDescriptors;
+        g_ui16MaxPacketSize = DATA_IN_EP_MAX_SIZE_HS;
+    }
+
     psInst->sDevInfo.ppui8StringDescriptors = 0;
     psInst->sDevInfo.ui32NumStringDescriptors = 0;
 
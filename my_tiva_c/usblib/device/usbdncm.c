@@ -0,0 +1,2954 @@
+//*****************************************************************************
+//
+// usbdncm.c - USB CDC NCM network device class driver.
+//
+// Copyright (c) 2008-2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva USB Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/usb.h"
+#include "usblib/usblib.h"
+#include "usblib/usblibpriv.h"
+#include "usblib/usbcdc.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdcomp.h"
+#include "usblib/device/usbdncm.h"
+
+//*****************************************************************************
+//
+//! \addtogroup ncm_device_class_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The subset of endpoint status flags that we consider to be reception
+// errors.  These are passed to the client via USB_EVENT_ERROR if seen.
+//
+//*****************************************************************************
+#define USB_RX_ERROR_FLAGS      (USBERR_DEV_RX_DATA_ERROR |                   \
+                                 USBERR_DEV_RX_OVERRUN |                      \
+                                 USBERR_DEV_RX_FIFO_FULL)
+
+//*****************************************************************************
+//
+// Flags that may appear in ui32Flags to track the state of the transmit,
+// receive and notification channels.
+//
+//*****************************************************************************
+#define NCM_FLAG_TX_ZLP         0x00000001
+#define NCM_FLAG_NOTIFY_BUSY    0x00000002
+#define NCM_FLAG_NOTIFY_SPEED   0x00000004
+#define NCM_FLAG_NOTIFY_LINK    0x00000008
+#define NCM_FLAG_RX_BLOCKED     0x00000010
+#define NCM_FLAG_RX_DISCARD     0x00000020
+
+//*****************************************************************************
+//
+// The largest number of NDPs followed in a single received NTB.  This bounds
+// the work done on an NTB whose NDPs have been linked into a loop.
+//
+//*****************************************************************************
+#define NCM_RX_MAX_NDPS         8
+
+//*****************************************************************************
+//
+// Endpoints to use for each of the required endpoints in the driver.
+//
+//*****************************************************************************
+#define CONTROL_ENDPOINT        USB_EP_1
+#define DATA_IN_ENDPOINT        USB_EP_2
+#define DATA_OUT_ENDPOINT       USB_EP_1
+
+//*****************************************************************************
+//
+// The default control and data interface numbers.
+//
+//*****************************************************************************
+#define NCM_INTERFACE_CONTROL   0
+#define NCM_INTERFACE_DATA      1
+
+//*****************************************************************************
+//
+// Maximum packet size for the bulk endpoints used for NTB transmission and
+// reception and the associated FIFO sizes to set aside for each endpoint.
+//
+//*****************************************************************************
+#define DATA_IN_EP_MAX_SIZE     USBFIFOSizeToBytes(USB_FIFO_SZ_64)
+#define DATA_OUT_EP_MAX_SIZE    USBFIFOSizeToBytes(USB_FIFO_SZ_64)
+
+#define DATA_IN_EP_MAX_SIZE_HS  USBFIFOSizeToBytes(USB_FIFO_SZ_512)
+#define DATA_OUT_EP_MAX_SIZE_HS USBFIFOSizeToBytes(USB_FIFO_SZ_512)
+
+#define CTL_IN_EP_MAX_SIZE      USBFIFOSizeToBytes(USB_FIFO_SZ_16)
+
+//*****************************************************************************
+//
+// The string index of the MAC address string in the Ethernet Networking
+// functional descriptor.
+//
+//*****************************************************************************
+#define NCM_MAC_ADDRESS_STRING  6
+
+//*****************************************************************************
+//
+// Device Descriptor.  This is stored in RAM to allow several fields to be
+// changed at runtime based on the client's requirements.
+//
+//*****************************************************************************
+uint8_t g_pui8NCMDeviceDescriptor[] =
+{
+    18,                             // Size of this structure.
+    USB_DTYPE_DEVICE,               // Type of this structure.
+    USBShort(0x110),                // USB version 1.1 (if we say 2.0, hosts
+                                    // assume high-speed - see USB 2.0 spec
+                                    // 9.2.6.6)
+    USB_CLASS_CDC,                  // USB Device Class (spec 5.1.1)
+    0,                              // USB Device Sub-class (spec 5.1.1)
+    USB_CDC_PROTOCOL_NONE,          // USB Device protocol (spec 5.1.1)
+    64,                             // Maximum packet size for default pipe.
+    USBShort(0),                    // Vendor ID (filled in during
+                                    // USBDNCMInit).
+    USBShort(0),                    // Product ID (filled in during
+                                    // USBDNCMInit).
+    USBShort(0x100),                // Device Version BCD.
+    1,                              // Manufacturer string identifier.
+    2,                              // Product string identifier.
+    3,                              // Product serial number.
+    1                               // Number of configurations.
+};
+
+//*****************************************************************************
+//
+// NCM configuration descriptor.
+//
+// It is vital that the configuration descriptor bConfigurationValue field
+// (byte 6) is 1 for the first configuration and increments by 1 for each
+// additional configuration defined here.  This relationship is assumed in the
+// device stack for simplicity even though the USB 2.0 specification imposes
+// no such restriction on the bConfigurationValue values.
+//
+// Note that this structure is deliberately located in RAM since we need to
+// be able to patch some values in it based on client requirements.
+//
+//*****************************************************************************
+uint8_t g_pui8NCMDescriptor[] =
+{
+    //
+    // Configuration descriptor header.
+    //
+    9,                              // Size of the configuration descriptor.
+    USB_DTYPE_CONFIGURATION,        // Type of this descriptor.
+    USBShort(9),                    // The total size of this full structure,
+                                    // this will be patched so it is just set
+                                    // to the size of this structure.
+    2,                              // The number of interfaces in this
+                                    // configuration.
+    1,                              // The unique value for this configuration.
+    5,                              // The string identifier that describes
+                                    // this configuration.
+    USB_CONF_ATTR_SELF_PWR,         // Bus Powered, Self Powered, remote wake
+                                    // up.
+    250,                            // The maximum power in 2mA increments.
+};
+
+const tConfigSection g_sNCMConfigSection =
+{
+    sizeof(g_pui8NCMDescriptor),
+    g_pui8NCMDescriptor
+};
+
+//*****************************************************************************
+//
+// This is the Interface Association Descriptor for the NCM device used in
+// composite devices.
+//
+//*****************************************************************************
+uint8_t g_pui8IADNCMDescriptor[NCMDESCRIPTOR_SIZE] =
+{
+    8,                              // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE_ASC,        // Interface Association Type.
+    0x0,                            // Default starting interface is 0.
+    0x2,                            // Number of interfaces in this
+                                    // association.
+    USB_CLASS_CDC,                  // The device class for this association.
+    USB_CDC_SUBCLASS_NCM_MODEL,     // The device subclass for this
+                                    // association.
+    USB_CDC_PROTOCOL_NONE,          // The protocol for this association.
+    0                               // The string index for this association.
+};
+
+const tConfigSection g_sIADNCMConfigSection =
+{
+    sizeof(g_pui8IADNCMDescriptor),
+    g_pui8IADNCMDescriptor
+};
+
+//*****************************************************************************
+//
+// This is the control interface for the NCM device.
+//
+//*****************************************************************************
+const uint8_t g_pui8NCMCommInterface[NCMCOMMINTERFACE_SIZE] =
+{
+    //
+    // Communication Class Interface Descriptor.
+    //
+    9,                              // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE,            // Type of this descriptor.
+    NCM_INTERFACE_CONTROL,          // The index for this interface.
+    0,                              // The alternate setting for this
+                                    // interface.
+    1,                              // The number of endpoints used by this
+                                    // interface.
+    USB_CLASS_CDC,                  // The interface class constant defined by
+                                    // USB-IF (spec 5.1.3).
+    USB_CDC_SUBCLASS_NCM_MODEL,     // The interface sub-class constant
+                                    // defined by USB-IF (spec 5.1.3).
+    USB_CDC_PROTOCOL_NONE,          // The interface protocol for the sub-class
+                                    // specified above.
+    4,                              // The string index for this interface.
+
+    //
+    // Communication Class Interface Functional Descriptor - Header
+    //
+    5,                              // Size of the functional descriptor.
+    USB_CDC_CS_INTERFACE,           // CDC interface descriptor
+    USB_CDC_FD_SUBTYPE_HEADER,      // Header functional descriptor
+    USBShort(0x110),                // Complies with CDC version 1.1
+
+    //
+    // Communication Class Interface Functional Descriptor - Unions
+    //
+    5,                              // Size of the functional descriptor.
+    USB_CDC_CS_INTERFACE,           // CDC interface descriptor
+    USB_CDC_FD_SUBTYPE_UNION,
+    NCM_INTERFACE_CONTROL,
+    NCM_INTERFACE_DATA,             // Data interface number
+
+    //
+    // Communication Class Interface Functional Descriptor - Ethernet
+    // Networking
+    //
+    13,                             // Size of the functional descriptor.
+    USB_CDC_CS_INTERFACE,           // CDC interface descriptor
+    USB_CDC_FD_SUBTYPE_ETHERNET,
+    NCM_MAC_ADDRESS_STRING,         // The string index of the MAC address.
+    0, 0, 0, 0,                     // No Ethernet statistics are collected.
+    USBShort(USBDNCM_MAX_SEGMENT_SIZE),
+                                    // The largest Ethernet frame.
+    USBShort(0),                    // No multicast filters.
+    0,                              // No power management filters.
+
+    //
+    // Communication Class Interface Functional Descriptor - NCM
+    //
+    6,                              // Size of the functional descriptor.
+    USB_CDC_CS_INTERFACE,           // CDC interface descriptor
+    USB_CDC_FD_SUBTYPE_NCM,
+    USBShort(0x100),                // Complies with NCM version 1.0
+    USB_CDC_NCM_SUPPORTS_PACKET_FILTER,
+
+    //
+    // Endpoint Descriptor (interrupt, IN)
+    //
+    7,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+    USB_EP_DESC_IN | USBEPToIndex(CONTROL_ENDPOINT),
+    USB_EP_ATTR_INT,                // Endpoint is an interrupt endpoint.
+    USBShort(CTL_IN_EP_MAX_SIZE),   // The maximum packet size.
+    1                               // The polling interval for this endpoint.
+};
+
+const tConfigSection g_sNCMCommInterfaceSection =
+{
+    sizeof(g_pui8NCMCommInterface),
+    g_pui8NCMCommInterface
+};
+
+//*****************************************************************************
+//
+// This is the Data interface for the NCM device.  Alternate setting 0 has no
+// endpoints and is selected by the host while the link is down.  Alternate
+// setting 1 carries the NTBs.
+//
+//*****************************************************************************
+const uint8_t g_pui8NCMDataInterface[NCMDATAINTERFACE_SIZE] =
+{
+    //
+    // Communication Class Data Interface Descriptor, alternate setting 0.
+    //
+    9,                              // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE,            // Type of this descriptor.
+    NCM_INTERFACE_DATA,             // The index for this interface.
+    0,                              // The alternate setting for this
+                                    // interface.
+    0,                              // The number of endpoints used by this
+                                    // interface.
+    USB_CLASS_CDC_DATA,             // The interface class constant defined by
+                                    // USB-IF (spec 5.1.3).
+    0,                              // The interface sub-class constant
+                                    // defined by USB-IF (spec 5.1.3).
+    USB_CDC_PROTOCOL_NCM_NTB,       // The interface protocol for the sub-class
+                                    // specified above.
+    0,                              // The string index for this interface.
+
+    //
+    // Communication Class Data Interface Descriptor, alternate setting 1.
+    //
+    9,                              // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE,            // Type of this descriptor.
+    NCM_INTERFACE_DATA,             // The index for this interface.
+    1,                              // The alternate setting for this
+                                    // interface.
+    2,                              // The number of endpoints used by this
+                                    // interface.
+    USB_CLASS_CDC_DATA,             // The interface class constant defined by
+                                    // USB-IF (spec 5.1.3).
+    0,                              // The interface sub-class constant
+                                    // defined by USB-IF (spec 5.1.3).
+    USB_CDC_PROTOCOL_NCM_NTB,       // The interface protocol for the sub-class
+                                    // specified above.
+    0,                              // The string index for this interface.
+
+    //
+    // Endpoint Descriptor
+    //
+    7,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+    USB_EP_DESC_IN | USBEPToIndex(DATA_IN_ENDPOINT),
+    USB_EP_ATTR_BULK,               // Endpoint is a bulk endpoint.
+    USBShort(DATA_IN_EP_MAX_SIZE),  // The maximum packet size.
+    0,                              // The polling interval for this endpoint.
+
+    //
+    // Endpoint Descriptor
+    //
+    7,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+    USB_EP_DESC_OUT | USBEPToIndex(DATA_OUT_ENDPOINT),
+    USB_EP_ATTR_BULK,               // Endpoint is a bulk endpoint.
+    USBShort(DATA_OUT_EP_MAX_SIZE), // The maximum packet size.
+    0,                              // The polling interval for this endpoint.
+};
+
+const tConfigSection g_sNCMDataInterfaceSection =
+{
+    sizeof(g_pui8NCMDataInterface),
+    g_pui8NCMDataInterface
+};
+
+const uint8_t g_pui8NCMDataInterfaceHS[NCMDATAINTERFACE_SIZE] =
+{
+    //
+    // Communication Class Data Interface Descriptor, alternate setting 0.
+    //
+    9,                              // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE,            // Type of this descriptor.
+    NCM_INTERFACE_DATA,             // The index for this interface.
+    0,                              // The alternate setting for this
+                                    // interface.
+    0,                              // The number of endpoints used by this
+                                    // interface.
+    USB_CLASS_CDC_DATA,             // The interface class constant defined by
+                                    // USB-IF (spec 5.1.3).
+    0,                              // The interface sub-class constant
+                                    // defined by USB-IF (spec 5.1.3).
+    USB_CDC_PROTOCOL_NCM_NTB,       // The interface protocol for the sub-class
+                                    // specified above.
+    0,                              // The string index for this interface.
+
+    //
+    // Communication Class Data Interface Descriptor, alternate setting 1.
+    //
+    9,                              // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE,            // Type of this descriptor.
+    NCM_INTERFACE_DATA,             // The index for this interface.
+    1,                              // The alternate setting for this
+                                    // interface.
+    2,                              // The number of endpoints used by this
+                                    // interface.
+    USB_CLASS_CDC_DATA,             // The interface class constant defined by
+                                    // USB-IF (spec 5.1.3).
+    0,                              // The interface sub-class constant
+                                    // defined by USB-IF (spec 5.1.3).
+    USB_CDC_PROTOCOL_NCM_NTB,       // The interface protocol for the sub-class
+                                    // specified above.
+    0,                              // The string index for this interface.
+
+    //
+    // Endpoint Descriptor
+    //
+    7,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+    USB_EP_DESC_IN | USBEPToIndex(DATA_IN_ENDPOINT),
+    USB_EP_ATTR_BULK,               // Endpoint is a bulk endpoint.
+    USBShort(DATA_IN_EP_MAX_SIZE_HS),  // The maximum packet size.
+    0,                              // The polling interval for this endpoint.
+
+    //
+    // Endpoint Descriptor
+    //
+    7,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+    USB_EP_DESC_OUT | USBEPToIndex(DATA_OUT_ENDPOINT),
+    USB_EP_ATTR_BULK,               // Endpoint is a bulk endpoint.
+    USBShort(DATA_OUT_EP_MAX_SIZE_HS), // The maximum packet size.
+    0,                              // The polling interval for this endpoint.
+};
+
+const tConfigSection g_sNCMDataInterfaceSectionHS =
+{
+    sizeof(g_pui8NCMDataInterfaceHS),
+    g_pui8NCMDataInterfaceHS
+};
+
+//*****************************************************************************
+//
+// This array lists all the sections that must be concatenated to make a
+// single, complete NCM configuration descriptor.
+//
+//*****************************************************************************
+const tConfigSection *g_psNCMSections[] =
+{
+    &g_sNCMConfigSection,
+    &g_sNCMCommInterfaceSection,
+    &g_sNCMDataInterfaceSection,
+};
+
+const tConfigSection *g_psNCMSectionsHS[] =
+{
+    &g_sNCMConfigSection,
+    &g_sNCMCommInterfaceSection,
+    &g_sNCMDataInterfaceSectionHS,
+};
+
+#define NUM_NCM_SECTIONS        (sizeof(g_psNCMSections) /                    \
+                                 sizeof(g_psNCMSections[0]))
+
+//*****************************************************************************
+//
+// The header for the single configuration.  This is the root of the data
+// structure that defines all the bits and pieces that are pulled together to
+// generate the configuration descriptor.
+//
+//*****************************************************************************
+const tConfigHeader g_sNCMConfigHeader =
+{
+    NUM_NCM_SECTIONS,
+    g_psNCMSections
+};
+
+const tConfigHeader g_sNCMConfigHeaderHS =
+{
+    NUM_NCM_SECTIONS,
+    g_psNCMSectionsHS
+};
+
+//*****************************************************************************
+//
+// This array lists all the sections that must be concatenated to make a
+// single, complete NCM configuration descriptor used in composite devices.
+// The only addition is the g_sIADNCMConfigSection.
+//
+//*****************************************************************************
+const tConfigSection *g_psNCMCompSections[] =
+{
+    &g_sNCMConfigSection,
+    &g_sIADNCMConfigSection,
+    &g_sNCMCommInterfaceSection,
+    &g_sNCMDataInterfaceSection,
+};
+
+const tConfigSection *g_psNCMCompSectionsHS[] =
+{
+    &g_sNCMConfigSection,
+    &g_sIADNCMConfigSection,
+    &g_sNCMCommInterfaceSection,
+    &g_sNCMDataInterfaceSectionHS,
+};
+
+#define NUM_COMP_NCM_SECTIONS   (sizeof(g_psNCMCompSections) /                \
+                                 sizeof(g_psNCMCompSections[0]))
+
+//*****************************************************************************
+//
+// The header for the composite configuration.  This is the root of the data
+// structure that defines all the bits and pieces that are pulled together to
+// generate the configuration descriptor.
+//
+//*****************************************************************************
+const tConfigHeader g_sNCMCompConfigHeader =
+{
+    NUM_COMP_NCM_SECTIONS,
+    g_psNCMCompSections
+};
+
+const tConfigHeader g_sNCMCompConfigHeaderHS =
+{
+    NUM_COMP_NCM_SECTIONS,
+    g_psNCMCompSectionsHS
+};
+
+//*****************************************************************************
+//
+// Configuration Descriptor for the NCM class device.
+//
+//*****************************************************************************
+const tConfigHeader * const g_ppNCMConfigDescriptors[] =
+{
+    &g_sNCMConfigHeader
+};
+
+const tConfigHeader * const g_ppNCMConfigDescriptorsHS[] =
+{
+    &g_sNCMConfigHeaderHS
+};
+
+//*****************************************************************************
+//
+// Configuration Descriptor for the NCM class device used in a composite
+// device.
+//
+//*****************************************************************************
+const tConfigHeader * const g_ppNCMCompConfigDescriptors[] =
+{
+    &g_sNCMCompConfigHeader
+};
+
+const tConfigHeader * const g_ppNCMCompConfigDescriptorsHS[] =
+{
+    &g_sNCMCompConfigHeaderHS
+};
+
+//*****************************************************************************
+//
+// Variable to get the maximum packet size for the interface
+//
+//*****************************************************************************
+static uint16_t g_ui16MaxPacketSize = USBFIFOSizeToBytes(USB_FIFO_SZ_64);
+
+//*****************************************************************************
+//
+// The padding written between the datagrams of a transmitted NTB.
+//
+//*****************************************************************************
+static const uint8_t g_pui8NCMPad[4] =
+{
+    0, 0, 0, 0
+};
+
+//*****************************************************************************
+//
+// Forward references for device handler callbacks
+//
+//*****************************************************************************
+static void HandleRequests(void *pvNCMDevice, tUSBRequest *pUSBRequest);
+static void HandleInterfaceChange(void *pvNCMDevice, uint8_t ui8InterfaceNum,
+                                  uint8_t ui8AlternateSetting);
+static void HandleConfigChange(void *pvNCMDevice, uint32_t ui32Info);
+static void HandleEP0Data(void *pvNCMDevice, uint32_t ui32DataSize);
+static void HandleDisconnect(void *pvNCMDevice);
+static void HandleEndpoints(void *pvNCMDevice, uint32_t ui32Status);
+static void HandleSuspend(void *pvNCMDevice);
+static void HandleResume(void *pvNCMDevice);
+static void HandleDevice(void *pvNCMDevice, uint32_t ui32Request,
+                         void *pvRequestData);
+
+//*****************************************************************************
+//
+// Device event handler callbacks.
+//
+//*****************************************************************************
+const tCustomHandlers g_sNCMHandlers =
+{
+    //
+    // GetDescriptor
+    //
+    0,
+
+    //
+    // RequestHandler
+    //
+    HandleRequests,
+
+    //
+    // InterfaceChange
+    //
+    HandleInterfaceChange,
+
+    //
+    // ConfigChange
+    //
+    HandleConfigChange,
+
+    //
+    // DataReceived
+    //
+    HandleEP0Data,
+
+    //
+    // DataSentCallback
+    //
+    0,
+
+    //
+    // ResetHandler
+    //
+    0,
+
+    //
+    // SuspendHandler
+    //
+    HandleSuspend,
+
+    //
+    // ResumeHandler
+    //
+    HandleResume,
+
+    //
+    // DisconnectHandler
+    //
+    HandleDisconnect,
+
+    //
+    // EndpointHandler
+    //
+    HandleEndpoints,
+
+    //
+    // Device handler
+    //
+    HandleDevice
+};
+
+//*****************************************************************************
+//
+// Sends the next pending notification on the interrupt IN endpoint.
+//
+// \param psNCMDevice is the device instance sending the notification.
+//
+// A CONNECTION_SPEED_CHANGE notification is sent before a NETWORK_CONNECTION
+// notification when both are pending, as the host expects to know the speed
+// of the link before it is told that the link is up.  Nothing is done if a
+// notification is already in progress; the next one is sent when it
+// completes.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+SendNotification(tUSBDNCMDevice *psNCMDevice)
+{
+    tNCMInstance *psInst;
+    tUSBRequest *psRequest;
+    uint8_t *pui8Notify;
+    uint32_t ui32Size, ui32Rate;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    if(psInst->ui32Flags & NCM_FLAG_NOTIFY_BUSY)
+    {
+        return;
+    }
+
+    pui8Notify = (uint8_t *)psInst->pui32Notify;
+    psRequest = (tUSBRequest *)pui8Notify;
+    psRequest->bmRequestType = (USB_RTYPE_DIR_IN | USB_RTYPE_CLASS |
+                                USB_RTYPE_INTERFACE);
+    psRequest->wIndex = psInst->ui8InterfaceControl;
+
+    if(psInst->ui32Flags & NCM_FLAG_NOTIFY_SPEED)
+    {
+        psInst->ui32Flags &= ~NCM_FLAG_NOTIFY_SPEED;
+
+        //
+        // Report the bus speed as the speed of the link in both directions.
+        //
+        ui32Rate = (g_ui16MaxPacketSize == DATA_IN_EP_MAX_SIZE_HS) ?
+                   480000000 : 12000000;
+
+        psRequest->bRequest = USB_CDC_NOTIFY_CONNECTION_SPEED_CHANGE;
+        psRequest->wValue = 0;
+        psRequest->wLength = 8;
+        SetNotifyConnectionSpeedChange(pui8Notify + sizeof(tUSBRequest),
+                                       ui32Rate, ui32Rate);
+        ui32Size = sizeof(tUSBRequest) + 8;
+    }
+    else if(psInst->ui32Flags & NCM_FLAG_NOTIFY_LINK)
+    {
+        psInst->ui32Flags &= ~NCM_FLAG_NOTIFY_LINK;
+
+        psRequest->bRequest = USB_CDC_NOTIFY_NETWORK_CONNECTION;
+        psRequest->wValue = psInst->bDataActive ?
+                            USB_CDC_NETWORK_CONNECTED :
+                            USB_CDC_NETWORK_DISCONNECTED;
+        psRequest->wLength = 0;
+        ui32Size = sizeof(tUSBRequest);
+    }
+    else
+    {
+        return;
+    }
+
+    //
+    // Write the notification to the FIFO and schedule it to be sent.
+    //
+    if(MAP_USBEndpointDataPut(psInst->ui32USBBase, psInst->ui8ControlEndpoint,
+                              pui8Notify, ui32Size) != -1)
+    {
+        psInst->ui32Flags |= NCM_FLAG_NOTIFY_BUSY;
+        MAP_USBEndpointDataSend(psInst->ui32USBBase,
+                                psInst->ui8ControlEndpoint, USB_TRANS_IN);
+    }
+}
+
+//*****************************************************************************
+//
+// Writes part of one section of the NTB being sent to the FIFO.
+//
+// \param psNCMDevice is the device instance sending the NTB.
+// \param pvFrame is the client's frame if the section is a datagram, or
+// NULL if the section is held in \e pui8Data.
+// \param pui8Data points to the section data if \e pvFrame is NULL.
+// \param ui32Start is the offset of the section within the NTB.
+// \param ui32Length is the length of the section.
+// \param ui32Offset is the offset within the NTB of the packet being written.
+// \param ui32End is the offset within the NTB of the end of the packet.
+//
+// Only the part of the section that falls within the packet is written.
+// Datagram data is copied straight from the client's frame, using the
+// client's pfnTxFrameData function to find each contiguous piece of it if one
+// was supplied.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+TxSectionPut(tUSBDNCMDevice *psNCMDevice, void *pvFrame,
+             const uint8_t *pui8Data, uint32_t ui32Start, uint32_t ui32Length,
+             uint32_t ui32Offset, uint32_t ui32End)
+{
+    tNCMInstance *psInst;
+    uint32_t ui32Pos, ui32Size, ui32Chunk;
+
+    //
+    // Does any of this section fall within the packet?
+    //
+    if(((ui32Start + ui32Length) <= ui32Offset) || (ui32Start >= ui32End))
+    {
+        return;
+    }
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Find the part of the section within the packet.
+    //
+    ui32Pos = (ui32Offset > ui32Start) ? (ui32Offset - ui32Start) : 0;
+    ui32Size = (((ui32Start + ui32Length) < ui32End) ?
+                (ui32Start + ui32Length) : ui32End) - ui32Start - ui32Pos;
+
+    while(ui32Size)
+    {
+        if(pvFrame == 0)
+        {
+            ui32Chunk = ui32Size;
+            pui8Data += ui32Pos;
+        }
+        else if(psNCMDevice->pfnTxFrameData)
+        {
+            ui32Chunk = psNCMDevice->pfnTxFrameData(psNCMDevice->pvTxCBData,
+                                                    pvFrame, ui32Pos,
+                                                    &pui8Data);
+
+            //
+            // The client must be able to supply every byte of the frame.
+            //
+            ASSERT(ui32Chunk != 0);
+            if(ui32Chunk == 0)
+            {
+                return;
+            }
+
+            if(ui32Chunk > ui32Size)
+            {
+                ui32Chunk = ui32Size;
+            }
+        }
+        else
+        {
+            ui32Chunk = ui32Size;
+            pui8Data = (const uint8_t *)pvFrame + ui32Pos;
+        }
+
+        MAP_USBEndpointDataPut(psInst->ui32USBBase, psInst->ui8INEndpoint,
+                               (uint8_t *)pui8Data, ui32Chunk);
+
+        ui32Pos += ui32Chunk;
+        ui32Size -= ui32Chunk;
+    }
+}
+
+//*****************************************************************************
+//
+// Writes one packet of the NTB being sent to the FIFO.
+//
+// \param psNCMDevice is the device instance sending the NTB.
+// \param ui32Offset is the offset of the packet within the NTB.
+// \param ui32Size is the size of the packet.
+//
+// The NTB is never assembled in memory.  Instead each packet is gathered from
+// the NTH16 and NDP16 held in the instance, the padding between datagrams and
+// the queued frames themselves.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+TxPacketPut(tUSBDNCMDevice *psNCMDevice, uint32_t ui32Offset,
+            uint32_t ui32Size)
+{
+    tNCMInstance *psInst;
+    const uint8_t *pui8NDP;
+    uint32_t ui32End, ui32Pos, ui32Index, ui32Frame, ui32Loop;
+    tNCMTxFrame *psFrame;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    pui8NDP = (const uint8_t *)psInst->pui32TxNDP;
+    ui32End = ui32Offset + ui32Size;
+
+    //
+    // The NTH16 is always first.
+    //
+    TxSectionPut(psNCMDevice, 0, (const uint8_t *)psInst->pui32TxNTH, 0,
+                 USB_CDC_NCM_NTH16_SIZE, ui32Offset, ui32End);
+    ui32Pos = USB_CDC_NCM_NTH16_SIZE;
+
+    //
+    // Each datagram follows, at the position recorded for it in the NDP16.
+    //
+    ui32Frame = psInst->ui32TxRead;
+    for(ui32Loop = 0; ui32Loop < psInst->ui32TxNTBFrames; ui32Loop++)
+    {
+        psFrame = &psInst->psTxQueue[ui32Frame];
+        ui32Index = SHORT(pui8NDP + 8 + (ui32Loop * 4));
+
+        TxSectionPut(psNCMDevice, 0, g_pui8NCMPad, ui32Pos,
+                     ui32Index - ui32Pos, ui32Offset, ui32End);
+        TxSectionPut(psNCMDevice, psFrame->pvFrame, 0, ui32Index,
+                     psFrame->ui32Length, ui32Offset, ui32End);
+
+        ui32Pos = ui32Index + psFrame->ui32Length;
+        ui32Frame = (ui32Frame + 1) % USBDNCM_TX_QUEUE_SIZE;
+    }
+
+    //
+    // The NDP16 ends the NTB.
+    //
+    TxSectionPut(psNCMDevice, 0, g_pui8NCMPad, ui32Pos,
+                 psInst->ui32TxNDPIndex - ui32Pos, ui32Offset, ui32End);
+    TxSectionPut(psNCMDevice, 0, pui8NDP, psInst->ui32TxNDPIndex,
+                 USB_CDC_NCM_NDP16_SIZE(psInst->ui32TxNTBFrames), ui32Offset,
+                 ui32End);
+}
+
+//*****************************************************************************
+//
+// Moves the NTB being sent on to its next packet.
+//
+// \param psNCMDevice is the device instance whose NTB is to be continued.
+//
+// This function is called to start sending an NTB and then each time that
+// the previous packet has been acknowledged.  A zero-length packet ends an
+// NTB whose length is a multiple of the maximum packet size but is shorter
+// than the largest NTB the host accepts.  Once the whole NTB has been sent,
+// the client is sent a \b USB_EVENT_TX_COMPLETE event for each frame that it
+// carried and the next NTB is started from any frames queued meanwhile.
+//
+// \return None.
+//
+//*****************************************************************************
+static void TxNTBStart(tUSBDNCMDevice *psNCMDevice);
+
+static void
+TxNTBNext(tUSBDNCMDevice *psNCMDevice)
+{
+    tNCMInstance *psInst;
+    uint32_t ui32Size, ui32Loop, ui32Frames;
+    void *pvFrame;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Send the next packet of the NTB.
+    //
+    if(psInst->ui32TxNTBOffset < psInst->ui32TxNTBSize)
+    {
+        ui32Size = psInst->ui32TxNTBSize - psInst->ui32TxNTBOffset;
+        if(ui32Size > g_ui16MaxPacketSize)
+        {
+            ui32Size = g_ui16MaxPacketSize;
+        }
+
+        TxPacketPut(psNCMDevice, psInst->ui32TxNTBOffset, ui32Size);
+        psInst->ui32TxNTBOffset += ui32Size;
+
+        MAP_USBEndpointDataSend(psInst->ui32USBBase, psInst->ui8INEndpoint,
+                                USB_TRANS_IN);
+        return;
+    }
+
+    //
+    // End the NTB with a zero-length packet if it is needed.
+    //
+    if(psInst->ui32Flags & NCM_FLAG_TX_ZLP)
+    {
+        psInst->ui32Flags &= ~NCM_FLAG_TX_ZLP;
+
+        MAP_USBEndpointDataSend(psInst->ui32USBBase, psInst->ui8INEndpoint,
+                                USB_TRANS_IN);
+        return;
+    }
+
+    //
+    // The NTB has been sent so hand each of its frames back to the client.
+    // The frames are removed from the queue before the client is called so
+    // that it may queue more frames from the callback.
+    //
+    ui32Frames = psInst->ui32TxNTBFrames;
+    psInst->sStats.ui32TxNTBs++;
+
+    for(ui32Loop = 0; ui32Loop < ui32Frames; ui32Loop++)
+    {
+        pvFrame = psInst->psTxQueue[psInst->ui32TxRead].pvFrame;
+        ui32Size = psInst->psTxQueue[psInst->ui32TxRead].ui32Length;
+        psInst->ui32TxRead = (psInst->ui32TxRead + 1) % USBDNCM_TX_QUEUE_SIZE;
+        psInst->ui32TxCount--;
+        psInst->sStats.ui32TxFrames++;
+
+        psNCMDevice->pfnTxCallback(psNCMDevice->pvTxCBData,
+                                   USB_EVENT_TX_COMPLETE, ui32Size, pvFrame);
+    }
+
+    //
+    // Start the next NTB if more frames are waiting.
+    //
+    psInst->ui32TxNTBFrames = 0;
+    TxNTBStart(psNCMDevice);
+}
+
+//*****************************************************************************
+//
+// Starts sending an NTB holding as many of the queued frames as fit.
+//
+// \param psNCMDevice is the device instance which is to send the NTB.
+//
+// The frames at the head of the transmit queue are aggregated into a single
+// NTB of no more than the size the host allows.  Each datagram starts on a
+// 4-byte boundary, as advertised in the NTB parameters, and the NDP16 that
+// indexes the datagrams follows the last of them.  Nothing is done if an NTB
+// is already being sent, in which case frames queued meanwhile are sent in
+// the following NTB.
+//
+// This function must be called with the USB interrupt unable to run.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+TxNTBStart(tUSBDNCMDevice *psNCMDevice)
+{
+    tNCMInstance *psInst;
+    uint8_t *pui8NTH, *pui8NDP;
+    uint32_t ui32Pos, ui32Index, ui32Frame, ui32Frames, ui32Length;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    if(psInst->ui32TxNTBFrames || !psInst->ui32TxCount || !psInst->bDataActive)
+    {
+        return;
+    }
+
+    pui8NTH = (uint8_t *)psInst->pui32TxNTH;
+    pui8NDP = (uint8_t *)psInst->pui32TxNDP;
+
+    //
+    // Place as many frames as will fit in the NTB.  The first frame always
+    // fits since the smallest NTB the host may ask for holds a frame of the
+    // largest size.
+    //
+    ui32Pos = USB_CDC_NCM_NTH16_SIZE;
+    ui32Frame = psInst->ui32TxRead;
+    for(ui32Frames = 0; (ui32Frames < psInst->ui32TxCount) &&
+                        (ui32Frames < USBDNCM_TX_NTB_FRAMES); ui32Frames++)
+    {
+        ui32Length = psInst->psTxQueue[ui32Frame].ui32Length;
+        ui32Index = (ui32Pos + 3) & ~3;
+
+        if(ui32Frames &&
+           ((((ui32Index + ui32Length + 3) & ~3) +
+             USB_CDC_NCM_NDP16_SIZE(ui32Frames + 1)) >
+            psInst->ui32NTBInMaxSize))
+        {
+            break;
+        }
+
+        SHORT(pui8NDP + 8 + (ui32Frames * 4)) = (uint16_t)ui32Index;
+        SHORT(pui8NDP + 10 + (ui32Frames * 4)) = (uint16_t)ui32Length;
+
+        ui32Pos = ui32Index + ui32Length;
+        ui32Frame = (ui32Frame + 1) % USBDNCM_TX_QUEUE_SIZE;
+    }
+
+    //
+    // Terminate the datagram pointers and fill in the rest of the NDP16.
+    //
+    SHORT(pui8NDP + 8 + (ui32Frames * 4)) = 0;
+    SHORT(pui8NDP + 10 + (ui32Frames * 4)) = 0;
+
+    LONG(pui8NDP) = USB_CDC_NCM_NDP16_SIGNATURE;
+    SHORT(pui8NDP + 4) = USB_CDC_NCM_NDP16_SIZE(ui32Frames);
+    SHORT(pui8NDP + 6) = 0;
+
+    psInst->ui32TxNDPIndex = (ui32Pos + 3) & ~3;
+    psInst->ui32TxNTBSize = psInst->ui32TxNDPIndex +
+                            USB_CDC_NCM_NDP16_SIZE(ui32Frames);
+    psInst->ui32TxNTBOffset = 0;
+    psInst->ui32TxNTBFrames = ui32Frames;
+
+    //
+    // Fill in the NTH16.
+    //
+    LONG(pui8NTH) = USB_CDC_NCM_NTH16_SIGNATURE;
+    SHORT(pui8NTH + 4) = USB_CDC_NCM_NTH16_SIZE;
+    SHORT(pui8NTH + 6) = psInst->ui16TxSequence++;
+    SHORT(pui8NTH + 8) = (uint16_t)psInst->ui32TxNTBSize;
+    SHORT(pui8NTH + 10) = (uint16_t)psInst->ui32TxNDPIndex;
+
+    //
+    // An NTB of the largest size is ended by its length alone.  Any other
+    // NTB that fills its last packet needs a zero-length packet.
+    //
+    if(((psInst->ui32TxNTBSize % g_ui16MaxPacketSize) == 0) &&
+       (psInst->ui32TxNTBSize < psInst->ui32NTBInMaxSize))
+    {
+        psInst->ui32Flags |= NCM_FLAG_TX_ZLP;
+    }
+    else
+    {
+        psInst->ui32Flags &= ~NCM_FLAG_TX_ZLP;
+    }
+
+    TxNTBNext(psNCMDevice);
+}
+
+//*****************************************************************************
+//
+// Hands every queued frame back to the client without sending it.
+//
+// \param psNCMDevice is the device instance whose queue is to be emptied.
+//
+// This is used when the link goes down.  Each frame is returned through a
+// \b USB_EVENT_TX_COMPLETE event with a length of zero.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+TxFlush(tUSBDNCMDevice *psNCMDevice)
+{
+    tNCMInstance *psInst;
+    void *pvFrame;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Discard any part of an NTB left in the FIFO.
+    //
+    if(psInst->ui32TxNTBFrames)
+    {
+        MAP_USBFIFOFlush(psInst->ui32USBBase, psInst->ui8INEndpoint,
+                         USB_EP_DEV_IN);
+    }
+
+    psInst->ui32TxNTBFrames = 0;
+    psInst->ui32Flags &= ~NCM_FLAG_TX_ZLP;
+
+    while(psInst->ui32TxCount)
+    {
+        pvFrame = psInst->psTxQueue[psInst->ui32TxRead].pvFrame;
+        psInst->ui32TxRead = (psInst->ui32TxRead + 1) % USBDNCM_TX_QUEUE_SIZE;
+        psInst->ui32TxCount--;
+        psInst->sStats.ui32TxDiscarded++;
+
+        psNCMDevice->pfnTxCallback(psNCMDevice->pvTxCBData,
+                                   USB_EVENT_TX_COMPLETE, 0, pvFrame);
+    }
+}
+
+//*****************************************************************************
+//
+// Chooses the receive buffer that the next NTB is read into.
+//
+// \param psInst is the instance data for the device.
+//
+// The buffer after the one last filled is preferred so that datagrams the
+// client still holds from the last NTB are left alone.  If the client holds
+// datagrams in every buffer, no buffer is chosen and reception stops until
+// one is released.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+RxNTBSelect(tNCMInstance *psInst)
+{
+    uint32_t ui32Loop, ui32Start, ui32Idx;
+
+    ui32Start = (psInst->ui32RxFill < USBDNCM_RX_NTB_BUFFERS) ?
+                psInst->ui32RxFill : 0;
+
+    for(ui32Loop = 1; ui32Loop <= USBDNCM_RX_NTB_BUFFERS; ui32Loop++)
+    {
+        ui32Idx = (ui32Start + ui32Loop) % USBDNCM_RX_NTB_BUFFERS;
+
+        if(psInst->psRxNTB[ui32Idx].ui32RefCount == 0)
+        {
+            psInst->psRxNTB[ui32Idx].ui32Count = 0;
+            psInst->ui32RxFill = ui32Idx;
+            return;
+        }
+    }
+
+    psInst->ui32RxFill = USBDNCM_RX_NTB_BUFFERS;
+}
+
+//*****************************************************************************
+//
+// Parses a received NTB and passes each of its datagrams to the client.
+//
+// \param psNCMDevice is the device instance which received the NTB.
+// \param psNTB is the buffer holding the NTB.
+//
+// The NTH16, each NDP16 and each datagram pointer are checked against the
+// length of the NTB before they are used so that a malformed NTB cannot
+// cause data outside the buffer to be passed to the client.  Each datagram
+// is passed to the client, in place, with a \b USB_EVENT_RX_AVAILABLE event
+// and the buffer is held until the client has released all of them.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+RxNTBParse(tUSBDNCMDevice *psNCMDevice, tNCMRxNTB *psNTB)
+{
+    tNCMInstance *psInst;
+    const uint8_t *pui8NTB, *pui8NDP;
+    uint32_t ui32Block, ui32NDP, ui32Length, ui32Entry, ui32Loop;
+    uint32_t ui32Index, ui32Size;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    pui8NTB = psNTB->pui8Data;
+    psInst->sStats.ui32RxNTBs++;
+
+    //
+    // Check the NTH16.
+    //
+    if((psNTB->ui32Count < USB_CDC_NCM_NTH16_SIZE) ||
+       (LONG(pui8NTB) != USB_CDC_NCM_NTH16_SIGNATURE) ||
+       (SHORT(pui8NTB + 4) != USB_CDC_NCM_NTH16_SIZE))
+    {
+        psInst->sStats.ui32RxErrors++;
+        return;
+    }
+
+    ui32Block = SHORT(pui8NTB + 8);
+    if((ui32Block < USB_CDC_NCM_NTH16_SIZE) || (ui32Block > psNTB->ui32Count))
+    {
+        psInst->sStats.ui32RxErrors++;
+        return;
+    }
+
+    //
+    // Hold the buffer while the datagrams are passed to the client, in case
+    // the client releases each of them as it is passed.
+    //
+    psNTB->ui32RefCount = 1;
+
+    //
+    // Follow the chain of NDP16s.
+    //
+    ui32NDP = SHORT(pui8NTB + 10);
+    for(ui32Loop = 0; ui32NDP && (ui32Loop < NCM_RX_MAX_NDPS); ui32Loop++)
+    {
+        pui8NDP = pui8NTB + ui32NDP;
+
+        if((ui32NDP & 3) || (ui32NDP < USB_CDC_NCM_NTH16_SIZE) ||
+           ((ui32NDP + USB_CDC_NCM_NDP16_SIZE(1)) > ui32Block) ||
+           (LONG(pui8NDP) != USB_CDC_NCM_NDP16_SIGNATURE))
+        {
+            psInst->sStats.ui32RxErrors++;
+            break;
+        }
+
+        ui32Length = SHORT(pui8NDP + 4);
+        if((ui32Length < USB_CDC_NCM_NDP16_SIZE(1)) || (ui32Length & 3) ||
+           ((ui32NDP + ui32Length) > ui32Block))
+        {
+            psInst->sStats.ui32RxErrors++;
+            break;
+        }
+
+        //
+        // Pass each datagram to the client until the null entry.
+        //
+        for(ui32Entry = 8; (ui32Entry + 4) <= ui32Length; ui32Entry += 4)
+        {
+            ui32Index = SHORT(pui8NDP + ui32Entry);
+            ui32Size = SHORT(pui8NDP + ui32Entry + 2);
+
+            if((ui32Index == 0) || (ui32Size == 0))
+            {
+                break;
+            }
+
+            if((ui32Index < USB_CDC_NCM_NTH16_SIZE) ||
+               (ui32Size > USBDNCM_MAX_SEGMENT_SIZE) ||
+               ((ui32Index + ui32Size) > ui32Block))
+            {
+                psInst->sStats.ui32RxErrors++;
+                continue;
+            }
+
+            psNTB->ui32RefCount++;
+            psInst->sStats.ui32RxFrames++;
+
+            psNCMDevice->pfnRxCallback(psNCMDevice->pvRxCBData,
+                                       USB_EVENT_RX_AVAILABLE, ui32Size,
+                                       (void *)(pui8NTB + ui32Index));
+        }
+
+        ui32NDP = SHORT(pui8NDP + 6);
+    }
+
+    //
+    // Drop the hold taken above.
+    //
+    psNTB->ui32RefCount--;
+}
+
+//*****************************************************************************
+//
+// Reads a received packet into the NTB being received.
+//
+// \param psNCMDevice is the device instance whose NTB is to be continued.
+//
+// This function reads the packet waiting in the OUT endpoint FIFO, if there
+// is one, into the current receive buffer and acknowledges it.  The NTB
+// ends with a short packet or when the largest NTB the device accepts has
+// been received, at which point it is parsed.  If the client holds datagrams
+// in every receive buffer, the packet is left unacknowledged so that the host
+// is held off until a buffer is released.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+RxNTBNext(tUSBDNCMDevice *psNCMDevice)
+{
+    tNCMInstance *psInst;
+    tNCMRxNTB *psNTB;
+    uint32_t ui32Size;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    if(!(MAP_USBEndpointStatus(psInst->ui32USBBase, psInst->ui8OUTEndpoint) &
+         USB_DEV_RX_PKT_RDY))
+    {
+        return;
+    }
+
+    //
+    // Hold the host off if there is nowhere to put the packet.
+    //
+    if(psInst->ui32RxFill >= USBDNCM_RX_NTB_BUFFERS)
+    {
+        if(!(psInst->ui32Flags & NCM_FLAG_RX_BLOCKED))
+        {
+            psInst->ui32Flags |= NCM_FLAG_RX_BLOCKED;
+            psInst->sStats.ui32RxNoBuffer++;
+        }
+        return;
+    }
+
+    psInst->ui32Flags &= ~NCM_FLAG_RX_BLOCKED;
+    psNTB = &psInst->psRxNTB[psInst->ui32RxFill];
+
+    //
+    // An NTB larger than the buffer breaks the NTB parameters that the host
+    // was given, so the rest of it is read over the start of the buffer and
+    // the whole NTB is dropped.
+    //
+    ui32Size = MAP_USBEndpointDataAvail(psInst->ui32USBBase,
+                                        psInst->ui8OUTEndpoint);
+    if((psNTB->ui32Count + ui32Size) > psInst->ui32RxNTBSize)
+    {
+        psInst->ui32Flags |= NCM_FLAG_RX_DISCARD;
+        psNTB->ui32Count = 0;
+    }
+
+    MAP_USBEndpointDataGet(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                           psNTB->pui8Data + psNTB->ui32Count, &ui32Size);
+    MAP_USBDevEndpointDataAck(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                              true);
+
+    psNTB->ui32Count += ui32Size;
+
+    //
+    // A short packet or a full buffer ends the NTB.
+    //
+    if((ui32Size == g_ui16MaxPacketSize) &&
+       (psNTB->ui32Count < psInst->ui32RxNTBSize))
+    {
+        return;
+    }
+
+    if(psInst->ui32Flags & NCM_FLAG_RX_DISCARD)
+    {
+        psInst->ui32Flags &= ~NCM_FLAG_RX_DISCARD;
+        psInst->sStats.ui32RxErrors++;
+    }
+    else
+    {
+        RxNTBParse(psNCMDevice, psNTB);
+    }
+
+    //
+    // Move on to a buffer for the next NTB.
+    //
+    RxNTBSelect(psInst);
+}
+
+//*****************************************************************************
+//
+// Resets the state of the data interface.
+//
+// \param psNCMDevice is the device instance whose data interface is reset.
+//
+// Any frames waiting to be sent are handed back to the client, any partly
+// received NTB is dropped and the NTB input size returns to its default, as
+// the NCM specification requires whenever the data interface is reset.
+// Datagrams still held by the client remain valid until it releases them.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+DataInterfaceReset(tUSBDNCMDevice *psNCMDevice)
+{
+    tNCMInstance *psInst;
+    uint32_t ui32Loop;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    TxFlush(psNCMDevice);
+    psInst->ui16TxSequence = 0;
+    psInst->ui32NTBInMaxSize = USBDNCM_NTB_IN_MAX_SIZE;
+
+    for(ui32Loop = 0; ui32Loop < USBDNCM_RX_NTB_BUFFERS; ui32Loop++)
+    {
+        psInst->psRxNTB[ui32Loop].ui32Count = 0;
+    }
+    psInst->ui32Flags &= ~(NCM_FLAG_RX_BLOCKED | NCM_FLAG_RX_DISCARD);
+    RxNTBSelect(psInst);
+}
+
+//*****************************************************************************
+//
+// Receives notifications related to data received from the host.
+//
+// \param psNCMDevice is the device instance whose endpoint is to be
+// processed.
+// \param ui32Status is the USB interrupt status that caused this function to
+// be called.
+//
+// This function is called from HandleEndpoints for all interrupts signaling
+// the arrival of data on the bulk OUT endpoint.
+//
+// \return Returns \b true on success or \b false on failure.
+//
+//*****************************************************************************
+static bool
+ProcessDataFromHost(tUSBDNCMDevice *psNCMDevice, uint32_t ui32Status)
+{
+    uint32_t ui32EPStatus;
+    tNCMInstance *psInst;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Get the endpoint status to see why we were called.
+    //
+    ui32EPStatus = MAP_USBEndpointStatus(psInst->ui32USBBase,
+                                         psInst->ui8OUTEndpoint);
+
+    //
+    // Clear the status bits.
+    //
+    MAP_USBDevEndpointStatusClear(psInst->ui32USBBase, psInst->ui8OUTEndpoint,
+                                  ui32EPStatus);
+
+    //
+    // Has a packet been received?
+    //
+    if(ui32EPStatus & USB_DEV_RX_PKT_RDY)
+    {
+        RxNTBNext(psNCMDevice);
+    }
+    else
+    {
+        //
+        // No packet was received.  Some error must have been reported.  Check
+        // and pass this on to the client if necessary.
+        //
+        if(ui32EPStatus & USB_RX_ERROR_FLAGS)
+        {
+            psNCMDevice->pfnRxCallback(psNCMDevice->pvRxCBData,
+                                       USB_EVENT_ERROR,
+                                       (ui32EPStatus & USB_RX_ERROR_FLAGS),
+                                       (void *)0);
+        }
+        return(false);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Receives notifications related to data sent to the host.
+//
+// \param psNCMDevice is the device instance whose endpoint is to be
+// processed.
+// \param ui32Status is the USB interrupt status that caused this function to
+// be called.
+//
+// This function is called from HandleEndpoints for all interrupts originating
+// from the bulk IN endpoint (in other words, whenever a packet of an NTB has
+// been transmitted to the USB host).
+//
+// \return Returns \b true on success or \b false on failure.
+//
+//*****************************************************************************
+static bool
+ProcessDataToHost(tUSBDNCMDevice *psNCMDevice, uint32_t ui32Status)
+{
+    tNCMInstance *psInst;
+    uint32_t ui32EPStatus;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Get the endpoint status to see why we were called.
+    //
+    ui32EPStatus = MAP_USBEndpointStatus(psInst->ui32USBBase,
+                                         psInst->ui8INEndpoint);
+
+    //
+    // Clear the status bits.
+    //
+    MAP_USBDevEndpointStatusClear(psInst->ui32USBBase, psInst->ui8INEndpoint,
+                                  ui32EPStatus);
+
+    //
+    // Move the NTB in progress on, if there is one.
+    //
+    if(psInst->ui32TxNTBFrames)
+    {
+        TxNTBNext(psNCMDevice);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Receives notifications related to interrupt messages sent to the host.
+//
+// \param psNCMDevice is the device instance whose endpoint is to be
+// processed.
+// \param ui32Status is the USB interrupt status that caused this function to
+// be called.
+//
+// This function is called from HandleEndpoints for all interrupts originating
+// from the interrupt IN endpoint.  The next pending notification, if any, is
+// sent.
+//
+// \return Returns \b true on success or \b false on failure.
+//
+//*****************************************************************************
+static bool
+ProcessNotificationToHost(tUSBDNCMDevice *psNCMDevice, uint32_t ui32Status)
+{
+    tNCMInstance *psInst;
+    uint32_t ui32EPStatus;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Get the endpoint status to see why we were called.
+    //
+    ui32EPStatus = MAP_USBEndpointStatus(psInst->ui32USBBase,
+                                         psInst->ui8ControlEndpoint);
+
+    //
+    // Clear the status bits.
+    //
+    MAP_USBDevEndpointStatusClear(psInst->ui32USBBase,
+                                  psInst->ui8ControlEndpoint, ui32EPStatus);
+
+    //
+    // The last notification has gone so send the next one.
+    //
+    psInst->ui32Flags &= ~NCM_FLAG_NOTIFY_BUSY;
+    SendNotification(psNCMDevice);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Called by the USB stack for any activity involving one of our endpoints
+// other than EP0.  This function is a fan out that merely directs the call to
+// the correct handler depending upon the endpoint and transaction direction
+// signaled in ui32Status.
+//
+//*****************************************************************************
+static void
+HandleEndpoints(void *pvNCMDevice, uint32_t ui32Status)
+{
+    tUSBDNCMDevice *psNCMDevice;
+    tNCMInstance *psInst;
+
+    ASSERT(pvNCMDevice != 0);
+
+    //
+    // The NCM device structure pointer.
+    //
+    psNCMDevice = (tUSBDNCMDevice *)pvNCMDevice;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Handler for the bulk OUT data endpoint.
+    //
+    if(ui32Status & (0x10000 << USBEPToIndex(psInst->ui8OUTEndpoint)))
+    {
+        ProcessDataFromHost(psNCMDevice, ui32Status);
+    }
+
+    //
+    // Handler for the bulk IN data endpoint.
+    //
+    if(ui32Status & (1 << USBEPToIndex(psInst->ui8INEndpoint)))
+    {
+        ProcessDataToHost(psNCMDevice, ui32Status);
+    }
+
+    //
+    // Handler for the interrupt IN notification endpoint.
+    //
+    if(ui32Status & (1 << USBEPToIndex(psInst->ui8ControlEndpoint)))
+    {
+        ProcessNotificationToHost(psNCMDevice, ui32Status);
+    }
+}
+
+//*****************************************************************************
+//
+// Called by the USB stack whenever a configuration change occurs.
+//
+//*****************************************************************************
+static void
+HandleConfigChange(void *pvNCMDevice, uint32_t ui32Info)
+{
+    tNCMInstance *psInst;
+    tUSBDNCMDevice *psNCMDevice;
+
+    ASSERT(pvNCMDevice != 0);
+
+    //
+    // The NCM device structure pointer.
+    //
+    psNCMDevice = (tUSBDNCMDevice *)pvNCMDevice;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // The host may have configured the device at a speed other than the one
+    // chosen when the class was initialized, so take the packet size from the
+    // configuration in use.
+    //
+    g_ui16MaxPacketSize = ((psInst->sDevInfo.ppsConfigDescriptors ==
+                            g_ppNCMConfigDescriptorsHS) ||
+                           (psInst->sDevInfo.ppsConfigDescriptors ==
+                            g_ppNCMCompConfigDescriptorsHS)) ?
+                          DATA_IN_EP_MAX_SIZE_HS : DATA_IN_EP_MAX_SIZE;
+
+    //
+    // The data interface always starts in alternate setting 0, so the link
+    // is down until the host selects alternate setting 1.
+    //
+    if(psInst->bDataActive)
+    {
+        psInst->bDataActive = false;
+        psNCMDevice->pfnRxCallback(psNCMDevice->pvRxCBData,
+                                   USB_EVENT_DISCONNECTED, 0, (void *)0);
+    }
+
+    DataInterfaceReset(psNCMDevice);
+    psInst->ui32Flags = 0;
+
+    //
+    // Remember that we are connected.
+    //
+    psInst->bConnected = true;
+}
+
+//*****************************************************************************
+//
+// Called by the USB stack whenever the host selects an alternate setting of
+// one of our interfaces.
+//
+//*****************************************************************************
+static void
+HandleInterfaceChange(void *pvNCMDevice, uint8_t ui8InterfaceNum,
+                      uint8_t ui8AlternateSetting)
+{
+    tNCMInstance *psInst;
+    tUSBDNCMDevice *psNCMDevice;
+    bool bWasActive;
+
+    ASSERT(pvNCMDevice != 0);
+
+    //
+    // The NCM device structure pointer.
+    //
+    psNCMDevice = (tUSBDNCMDevice *)pvNCMDevice;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Only the data interface has alternate settings.
+    //
+    if(ui8InterfaceNum != psInst->ui8InterfaceData)
+    {
+        return;
+    }
+
+    //
+    // Selecting either setting resets the data interface.
+    //
+    bWasActive = psInst->bDataActive;
+    psInst->bDataActive = false;
+    DataInterfaceReset(psNCMDevice);
+
+    if(bWasActive)
+    {
+        psNCMDevice->pfnRxCallback(psNCMDevice->pvRxCBData,
+                                   USB_EVENT_DISCONNECTED, 0, (void *)0);
+    }
+
+    //
+    // Alternate setting 1 brings the link up.  Tell the host the speed of
+    // the link and that it is connected, then tell the client.
+    //
+    if(ui8AlternateSetting == 1)
+    {
+        psInst->bDataActive = true;
+        psInst->ui32Flags |= NCM_FLAG_NOTIFY_SPEED | NCM_FLAG_NOTIFY_LINK;
+        SendNotification(psNCMDevice);
+
+        psNCMDevice->pfnRxCallback(psNCMDevice->pvRxCBData,
+                                   USB_EVENT_CONNECTED, 0, (void *)0);
+    }
+}
+
+//*****************************************************************************
+//
+// USB data received callback.
+//
+// This function is called by the USB stack whenever any data requested from
+// EP0 is received.
+//
+//*****************************************************************************
+static void
+HandleEP0Data(void *pvNCMDevice, uint32_t ui32DataSize)
+{
+    tUSBDNCMDevice *psNCMDevice;
+    tNCMInstance *psInst;
+    uint32_t ui32Value;
+
+    ASSERT(pvNCMDevice != 0);
+
+    //
+    // The NCM device structure pointer.
+    //
+    psNCMDevice = (tUSBDNCMDevice *)pvNCMDevice;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // If we were not passed any data, just return.
+    //
+    if(ui32DataSize == 0)
+    {
+        return;
+    }
+
+    switch(psInst->ui8PendingRequest)
+    {
+        //
+        // The host has chosen the largest IN NTB it will accept.  It may not
+        // ask for less than the smallest NTB or more than we offered.
+        //
+        case USB_CDC_SET_NTB_INPUT_SIZE:
+        {
+            ui32Value = psInst->pui32RequestData[0];
+
+            if((ui32DataSize < USB_CDC_SIZE_NTB_INPUT_SIZE) ||
+               (ui32Value < USBDNCM_NTB_OUT_MIN_SIZE) ||
+               (ui32Value > USBDNCM_NTB_IN_MAX_SIZE))
+            {
+                USBDCDStallEP0(0);
+            }
+            else
+            {
+                psInst->ui32NTBInMaxSize = ui32Value;
+            }
+            break;
+        }
+
+        default:
+        {
+            USBDCDStallEP0(0);
+            break;
+        }
+    }
+
+    psInst->ui8PendingRequest = 0;
+}
+
+//*****************************************************************************
+//
+// Device instance specific handler.
+//
+//*****************************************************************************
+static void
+HandleDevice(void *pvNCMDevice, uint32_t ui32Request, void *pvRequestData)
+{
+    tNCMInstance *psInst;
+    uint8_t *pui8Data;
+    tUSBDNCMDevice *psNCMDevice;
+
+    //
+    // The NCM device structure pointer.
+    //
+    psNCMDevice = (tUSBDNCMDevice *)pvNCMDevice;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Create the 8-bit array used by the events supported by the USB NCM
+    // class.
+    //
+    pui8Data = (uint8_t *)pvRequestData;
+
+    switch(ui32Request)
+    {
+        //
+        // This was an interface change event.
+        //
+        case USB_EVENT_COMP_IFACE_CHANGE:
+        {
+            //
+            // Save the change to the appropriate interface number.
+            //
+            if(pui8Data[0] == NCM_INTERFACE_CONTROL)
+            {
+                psInst->ui8InterfaceControl = pui8Data[1];
+            }
+            else if(pui8Data[0] == NCM_INTERFACE_DATA)
+            {
+                psInst->ui8InterfaceData = pui8Data[1];
+            }
+            break;
+        }
+
+        //
+        // This was an endpoint change event.
+        //
+        case USB_EVENT_COMP_EP_CHANGE:
+        {
+            //
+            // Determine if this is an IN or OUT endpoint that has changed.
+            //
+            if(pui8Data[0] & USB_EP_DESC_IN)
+            {
+                //
+                // Determine which IN endpoint to modify.
+                //
+                if((pui8Data[0] & 0x7f) == USBEPToIndex(CONTROL_ENDPOINT))
+                {
+                    psInst->ui8ControlEndpoint =
+                        IndexToUSBEP((pui8Data[1] & 0x7f));
+                }
+                else
+                {
+                    psInst->ui8INEndpoint =
+                        IndexToUSBEP((pui8Data[1] & 0x7f));
+                }
+            }
+            else
+            {
+                //
+                // Extract the new endpoint number.
+                //
+                psInst->ui8OUTEndpoint = IndexToUSBEP(pui8Data[1] & 0x7f);
+            }
+            break;
+        }
+
+        //
+        // Handle class specific reconfiguring of the configuration descriptor
+        // once the composite class has built the full descriptor.
+        //
+        case USB_EVENT_COMP_CONFIG:
+        {
+            //
+            // This sets the bFirstInterface of the Interface Association
+            // descriptor to the first interface which is the control
+            // interface used by this instance.
+            //
+            pui8Data[2] = psInst->ui8InterfaceControl;
+
+            //
+            // This sets the bMasterInterface of the Union descriptor to the
+            // Control interface and the bSlaveInterface of the Union
+            // Descriptor to the Data interface used by this instance.
+            //
+            pui8Data[25] = psInst->ui8InterfaceControl;
+            pui8Data[26] = psInst->ui8InterfaceData;
+            break;
+        }
+        case USB_EVENT_LPM_RESUME:
+        case USB_EVENT_LPM_SLEEP:
+        case USB_EVENT_LPM_ERROR:
+        {
+            //
+            // Pass the LPM event to the client.
+            //
+            psNCMDevice->pfnRxCallback(psNCMDevice->pvRxCBData, ui32Request,
+                                       0, (void *)0);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// USB non-standard request callback.
+//
+// This function is called by the USB stack whenever any non-standard request
+// is made to the device.  The handler should process any requests that it
+// supports or stall EP0 in any unsupported cases.
+//
+//*****************************************************************************
+static void
+HandleRequests(void *pvNCMDevice, tUSBRequest *pUSBRequest)
+{
+    tUSBDNCMDevice *psNCMDevice;
+    tNCMInstance *psInst;
+    uint32_t ui32Size;
+
+    ASSERT(pvNCMDevice != 0);
+
+    //
+    // The NCM device structure pointer.
+    //
+    psNCMDevice = (tUSBDNCMDevice *)pvNCMDevice;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Only handle requests meant for this interface.
+    //
+    if(pUSBRequest->wIndex != psInst->ui8InterfaceControl)
+    {
+        return;
+    }
+
+    switch(pUSBRequest->bRequest)
+    {
+        //
+        // Return the NTB parameters.
+        //
+        case USB_CDC_GET_NTB_PARAMETERS:
+        {
+            MAP_USBDevEndpointDataAck(psInst->ui32USBBase, USB_EP_0, false);
+
+            ui32Size = pUSBRequest->wLength;
+            if(ui32Size > USB_CDC_SIZE_NTB_PARAMETERS)
+            {
+                ui32Size = USB_CDC_SIZE_NTB_PARAMETERS;
+            }
+
+            USBDCDSendDataEP0(0, (uint8_t *)&psInst->sNTBParams, ui32Size);
+            break;
+        }
+
+        //
+        // Return the largest IN NTB currently allowed.
+        //
+        case USB_CDC_GET_NTB_INPUT_SIZE:
+        {
+            MAP_USBDevEndpointDataAck(psInst->ui32USBBase, USB_EP_0, false);
+
+            psInst->pui32RequestData[0] = psInst->ui32NTBInMaxSize;
+
+            ui32Size = pUSBRequest->wLength;
+            if(ui32Size > USB_CDC_SIZE_NTB_INPUT_SIZE)
+            {
+                ui32Size = USB_CDC_SIZE_NTB_INPUT_SIZE;
+            }
+
+            USBDCDSendDataEP0(0, (uint8_t *)psInst->pui32RequestData,
+                              ui32Size);
+            break;
+        }
+
+        //
+        // Set the largest IN NTB.  The value is checked once the data stage
+        // arrives in HandleEP0Data.
+        //
+        case USB_CDC_SET_NTB_INPUT_SIZE:
+        {
+            ui32Size = pUSBRequest->wLength;
+            if(ui32Size > sizeof(psInst->pui32RequestData))
+            {
+                ui32Size = sizeof(psInst->pui32RequestData);
+            }
+
+            psInst->ui8PendingRequest = USB_CDC_SET_NTB_INPUT_SIZE;
+
+            USBDCDRequestDataEP0(0, (uint8_t *)psInst->pui32RequestData,
+                                 ui32Size);
+
+            //
+            // ACK what we have already received.  We must do this after
+            // requesting the data or we get into a race condition where the
+            // data may return before we have set the stack state appropriately
+            // to receive it.
+            //
+            MAP_USBDevEndpointDataAck(psInst->ui32USBBase, USB_EP_0, false);
+            break;
+        }
+
+        //
+        // Only the 16-bit NTB format is supported.
+        //
+        case USB_CDC_GET_NTB_FORMAT:
+        {
+            MAP_USBDevEndpointDataAck(psInst->ui32USBBase, USB_EP_0, false);
+
+            psInst->pui32RequestData[0] = 0;
+
+            ui32Size = pUSBRequest->wLength;
+            if(ui32Size > USB_CDC_SIZE_NTB_FORMAT)
+            {
+                ui32Size = USB_CDC_SIZE_NTB_FORMAT;
+            }
+
+            USBDCDSendDataEP0(0, (uint8_t *)psInst->pui32RequestData,
+                              ui32Size);
+            break;
+        }
+
+        case USB_CDC_SET_NTB_FORMAT:
+        {
+            if(pUSBRequest->wValue != 0)
+            {
+                USBDCDStallEP0(0);
+            }
+            else
+            {
+                MAP_USBDevEndpointDataAck(psInst->ui32USBBase, USB_EP_0,
+                                          true);
+            }
+            break;
+        }
+
+        //
+        // No filtering is done on frames sent to the host, so the packet
+        // filter is accepted but has no effect.
+        //
+        case USB_CDC_SET_ETHERNET_PACKET_FILTER:
+        {
+            MAP_USBDevEndpointDataAck(psInst->ui32USBBase, USB_EP_0, true);
+            break;
+        }
+
+        default:
+        {
+            USBDCDStallEP0(0);
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// This function is called by the USB device stack whenever the device is
+// disconnected from the host.
+//
+//*****************************************************************************
+static void
+HandleDisconnect(void *pvNCMDevice)
+{
+    tUSBDNCMDevice *psNCMDevice;
+    tNCMInstance *psInst;
+
+    ASSERT(pvNCMDevice != 0);
+
+    //
+    // The NCM device structure pointer.
+    //
+    psNCMDevice = (tUSBDNCMDevice *)pvNCMDevice;
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // If the link was up, let the client know it has gone.
+    //
+    if(psInst->bDataActive)
+    {
+        psInst->bDataActive = false;
+        psNCMDevice->pfnRxCallback(psNCMDevice->pvRxCBData,
+                                   USB_EVENT_DISCONNECTED, 0, (void *)0);
+    }
+
+    //
+    // Remember that we are no longer connected.  Any NTBs in progress are
+    // abandoned.
+    //
+    DataInterfaceReset(psNCMDevice);
+    psInst->ui32Flags = 0;
+    psInst->bConnected = false;
+}
+
+//*****************************************************************************
+//
+// This function is called by the USB device stack whenever the bus is put into
+// suspend state.
+//
+//*****************************************************************************
+static void
+HandleSuspend(void *pvNCMDevice)
+{
+    const tUSBDNCMDevice *psNCMDevice;
+
+    ASSERT(pvNCMDevice != 0);
+
+    //
+    // The NCM device structure pointer.
+    //
+    psNCMDevice = (const tUSBDNCMDevice *)pvNCMDevice;
+
+    //
+    // Pass the event on to the client.
+    //
+    psNCMDevice->pfnRxCallback(psNCMDevice->pvRxCBData, USB_EVENT_SUSPEND, 0,
+                               (void *)0);
+}
+
+//*****************************************************************************
+//
+// This function is called by the USB device stack whenever the bus is taken
+// out of suspend state.
+//
+//*****************************************************************************
+static void
+HandleResume(void *pvNCMDevice)
+{
+    const tUSBDNCMDevice *psNCMDevice;
+
+    ASSERT(pvNCMDevice != 0);
+
+    //
+    // The NCM device structure pointer.
+    //
+    psNCMDevice = (const tUSBDNCMDevice *)pvNCMDevice;
+
+    //
+    // Pass the event on to the client.
+    //
+    psNCMDevice->pfnRxCallback(psNCMDevice->pvRxCBData, USB_EVENT_RESUME, 0,
+                               (void *)0);
+}
+
+//*****************************************************************************
+//
+// This function is called periodically and provides us with a time reference
+// and method of implementing delayed or time-dependent operations.
+//
+// \param pvNCMDevice is the NCM device instance.
+// \param ui32TimemS is the elapsed time in milliseconds since the last call
+// to this function.
+//
+// Reception that stopped because the client held every receive buffer is
+// resumed here once a buffer has been released.
+//
+// \return None.
+//
+//*****************************************************************************
+static void
+NCMTickHandler(void *pvNCMDevice, uint32_t ui32TimemS)
+{
+    tNCMInstance *psInst;
+
+    ASSERT(pvNCMDevice != 0);
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &((tUSBDNCMDevice *)pvNCMDevice)->sPrivateData;
+
+    if((psInst->ui32Flags & NCM_FLAG_RX_BLOCKED) &&
+       (psInst->ui32RxFill < USBDNCM_RX_NTB_BUFFERS))
+    {
+        RxNTBNext((tUSBDNCMDevice *)pvNCMDevice);
+    }
+}
+
+//*****************************************************************************
+//
+//! Initializes NCM device operation for a given USB controller.
+//!
+//! \param ui32Index is the index of the USB controller which is to be
+//! initialized for NCM device operation.
+//! \param psNCMDevice points to a structure containing parameters customizing
+//! the operation of the NCM device.
+//!
+//! An application wishing to appear as a USB network adapter using the CDC
+//! Network Control Model must call this function to initialize the USB
+//! controller and attach the device to the USB bus.  This function performs
+//! all required USB initialization.
+//!
+//! The value returned by this function is the \e psNCMDevice pointer passed
+//! to it if successful.  This pointer must be passed to all later calls to the
+//! NCM class driver to identify the device instance.
+//!
+//! The link is up while the host has selected the alternate setting of the
+//! data interface that carries traffic.  The receive callback is sent
+//! \b USB_EVENT_CONNECTED when the link comes up and
+//! \b USB_EVENT_DISCONNECTED when it goes down.
+//!
+//! Transmit Operation:
+//!
+//! Ethernet frames are queued with USBDNCMFrameWrite().  The frame data is
+//! not copied; frames queued while an NTB is being sent are aggregated into
+//! the next NTB and copied into the endpoint FIFO straight from the client's
+//! buffers.  Once a frame has been sent, a \b USB_EVENT_TX_COMPLETE event is
+//! sent to the transmit callback with the frame pointer as its message data,
+//! after which the client may free the frame.
+//!
+//! Receive Operation:
+//!
+//! Each datagram received from the host is passed, in place, to the receive
+//! callback with a \b USB_EVENT_RX_AVAILABLE event giving its length and a
+//! pointer to it.  The client must call USBDNCMRxDatagramRelease() once it
+//! has finished with each datagram, either from the callback or later.
+//!
+//! \note The application must not make any calls to the low level USB Device
+//! API if interacting with USB via the NCM device class API.  Doing so
+//! will cause unpredictable (though almost certainly unpleasant) behavior.
+//!
+//! \return Returns NULL on failure or the psNCMDevice pointer on success.
+//
+//*****************************************************************************
+void *
+USBDNCMInit(uint32_t ui32Index, tUSBDNCMDevice *psNCMDevice)
+{
+    void *pvRet;
+    tDeviceDescriptor *psDevDesc;
+    tConfigDescriptor *psConfigDesc;
+
+    //
+    // Check parameter validity.
+    //
+    ASSERT(ui32Index == 0);
+    ASSERT(psNCMDevice);
+
+    pvRet = USBDNCMCompositeInit(ui32Index, psNCMDevice, 0);
+
+    if(pvRet)
+    {
+        //
+        // Fix up the device descriptor with the client-supplied values.
+        //
+        psDevDesc = (tDeviceDescriptor *)g_pui8NCMDeviceDescriptor;
+        psDevDesc->idVendor = psNCMDevice->ui16VID;
+        psDevDesc->idProduct = psNCMDevice->ui16PID;
+
+        //
+        // Fix up the configuration descriptor with client-supplied values.
+        //
+        psConfigDesc = (tConfigDescriptor *)g_pui8NCMDescriptor;
+        psConfigDesc->bmAttributes = psNCMDevice->ui8PwrAttributes;
+        psConfigDesc->bMaxPower = (uint8_t)(psNCMDevice->ui16MaxPowermA / 2);
+
+        //
+        // All is well so now pass the descriptors to the lower layer and put
+        // the NCM device on the bus.
+        //
+        USBDCDInit(ui32Index, &psNCMDevice->sPrivateData.sDevInfo,
+                   (void *)psNCMDevice);
+    }
+
+    return(pvRet);
+}
+
+//*****************************************************************************
+//
+//! Initializes NCM device operation for use in a composite device.
+//!
+//! \param ui32Index is the index of the USB controller which is to be
+//! initialized for NCM device operation.
+//! \param psNCMDevice points to a structure containing parameters customizing
+//! the operation of the NCM device.
+//! \param psCompEntry is the composite device entry to initialize when
+//! creating a composite device.
+//!
+//! This call is very similar to USBDNCMInit() except that it is used for
+//! initializing an instance of the NCM device for use in a composite device.
+//! When this NCM device is part of a composite device, then the
+//! \e psCompEntry should point to the composite device entry to initialize.
+//! This is part of the array that is passed to the USBDCompositeInit()
+//! function.  The MAC address string is then taken from index 6 of the
+//! composite device's string table.
+//!
+//! \return Returns zero on failure or a non-zero instance value that should be
+//! used with the remaining USB NCM APIs.
+//
+//*****************************************************************************
+void *
+USBDNCMCompositeInit(uint32_t ui32Index, tUSBDNCMDevice *psNCMDevice,
+                     tCompositeEntry *psCompEntry)
+{
+    tNCMInstance *psInst;
+    uint32_t ui32ulpiFeature = 0;
+    uint32_t ui32Loop;
+
+    //
+    // Check parameter validity.
+    //
+    ASSERT(ui32Index == 0);
+    ASSERT(psNCMDevice);
+    ASSERT(psNCMDevice->ppui8StringDescriptors);
+    ASSERT(psNCMDevice->pfnRxCallback);
+    ASSERT(psNCMDevice->pfnTxCallback);
+    ASSERT(psNCMDevice->pui8RxBuffer);
+    ASSERT(!((uint32_t)psNCMDevice->pui8RxBuffer & 3));
+    ASSERT(psNCMDevice->ui32RxBufferSize >=
+           (USBDNCM_RX_NTB_BUFFERS * USBDNCM_NTB_OUT_MIN_SIZE));
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &psNCMDevice->sPrivateData;
+
+    //
+    // Initialize the composite entry that is used by the composite device
+    // class.
+    //
+    if(psCompEntry != 0)
+    {
+        psCompEntry->psDevInfo = &psInst->sDevInfo;
+        psCompEntry->pvInstance = (void *)psNCMDevice;
+    }
+
+    //
+    // Initialize the device information structure.
+    //
+    psInst->sDevInfo.psCallbacks = &g_sNCMHandlers;
+    psInst->sDevInfo.pui8DeviceDescriptor = g_pui8NCMDeviceDescriptor;
+
+    //
+    // Get the Feature set for ULPI
+    //
+    USBDCDFeatureGet(0, USBLIB_FEATURE_USBULPI, &ui32ulpiFeature);
+
+    g_ui16MaxPacketSize = USBFIFOSizeToBytes(USB_FIFO_SZ_64);
+
+    //
+    // The NCM configuration is different for composite devices and stand
+    // alone devices.
+    //
+    if(psCompEntry == 0)
+    {
+        psInst->sDevInfo.ppsConfigDescriptors = g_ppNCMConfigDescriptors;
+        psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
+
+        if(USBLIB_FEATURE_ULPI_HS == ui32ulpiFeature)
+        {
+            psInst->sDevInfo.ppsConfigDescriptors =
+                                                g_ppNCMConfigDescriptorsHS;
+            psInst->sDevInfo.ppsOtherSpeedDescriptors =
+                                                g_ppNCMConfigDescriptors;
+            g_ui16MaxPacketSize = USBFIFOSizeToBytes(USB_FIFO_SZ_512);
+        }
+    }
+    else
+    {
+        psInst->sDevInfo.ppsConfigDescriptors = g_ppNCMCompConfigDescriptors;
+        psInst->sDevInfo.ppsOtherSpeedDescriptors = 0;
+
+        if(USBLIB_FEATURE_ULPI_HS == ui32ulpiFeature)
+        {
+            psInst->sDevInfo.ppsConfigDescriptors =
+                                            g_ppNCMCompConfigDescriptorsHS;
+            g_ui16MaxPacketSize = USBFIFOSizeToBytes(USB_FIFO_SZ_512);
+        }
+    }
+    psInst->sDevInfo.ppui8StringDescriptors = 0;
+    psInst->sDevInfo.ui32NumStringDescriptors = 0;
+
+    //
+    // Set the default endpoint and interface assignments.
+    //
+    psInst->ui8ControlEndpoint = CONTROL_ENDPOINT;
+    psInst->ui8INEndpoint = DATA_IN_ENDPOINT;
+    psInst->ui8OUTEndpoint = DATA_OUT_ENDPOINT;
+    psInst->ui8InterfaceControl = NCM_INTERFACE_CONTROL;
+    psInst->ui8InterfaceData = NCM_INTERFACE_DATA;
+
+    //
+    // Split the client's receive buffer into NTB buffers.  Each is a whole
+    // number of the largest packets so that a full buffer always ends an NTB
+    // on a packet boundary.
+    //
+    psInst->ui32RxNTBSize = psNCMDevice->ui32RxBufferSize /
+                            USBDNCM_RX_NTB_BUFFERS;
+    psInst->ui32RxNTBSize -= psInst->ui32RxNTBSize %
+                             USBFIFOSizeToBytes(USB_FIFO_SZ_512);
+    if(psInst->ui32RxNTBSize > 0xffff)
+    {
+        psInst->ui32RxNTBSize = 0xfe00;
+    }
+
+    for(ui32Loop = 0; ui32Loop < USBDNCM_RX_NTB_BUFFERS; ui32Loop++)
+    {
+        psInst->psRxNTB[ui32Loop].pui8Data = psNCMDevice->pui8RxBuffer +
+                                             (ui32Loop *
+                                              psInst->ui32RxNTBSize);
+        psInst->psRxNTB[ui32Loop].ui32Count = 0;
+        psInst->psRxNTB[ui32Loop].ui32RefCount = 0;
+    }
+    psInst->ui32RxFill = 0;
+
+    //
+    // Fill in the NTB parameters returned to the host.  Datagrams and NDPs
+    // are aligned to 4 bytes in both directions.
+    //
+    psInst->sNTBParams.ui16Length = USB_CDC_SIZE_NTB_PARAMETERS;
+    psInst->sNTBParams.ui16NTBFormats = USB_CDC_NCM_NTB16_FORMAT;
+    psInst->sNTBParams.ui32NTBInMaxSize = USBDNCM_NTB_IN_MAX_SIZE;
+    psInst->sNTBParams.ui16NDPInDivisor = 4;
+    psInst->sNTBParams.ui16NDPInRemainder = 0;
+    psInst->sNTBParams.ui16NDPInAlignment = 4;
+    psInst->sNTBParams.ui16Reserved = 0;
+    psInst->sNTBParams.ui32NTBOutMaxSize = psInst->ui32RxNTBSize;
+    psInst->sNTBParams.ui16NDPOutDivisor = 4;
+    psInst->sNTBParams.ui16NDPOutRemainder = 0;
+    psInst->sNTBParams.ui16NDPOutAlignment = 4;
+    psInst->sNTBParams.ui16NTBOutMaxDatagrams = 0;
+
+    //
+    // Initialize the workspace in the passed instance structure.
+    //
+    psInst->ui32USBBase = USB0_BASE;
+    psInst->bConnected = false;
+    psInst->bDataActive = false;
+    psInst->ui8PendingRequest = 0;
+    psInst->ui32Flags = 0;
+    psInst->ui32NTBInMaxSize = USBDNCM_NTB_IN_MAX_SIZE;
+    psInst->ui32TxRead = 0;
+    psInst->ui32TxWrite = 0;
+    psInst->ui32TxCount = 0;
+    psInst->ui32TxNTBFrames = 0;
+    psInst->ui16TxSequence = 0;
+
+    USBDNCMStatsClear((void *)psNCMDevice);
+
+    //
+    // Initialize the device info structure for the NCM device.
+    //
+    USBDCDDeviceInfoInit(0, &psInst->sDevInfo);
+
+    //
+    // Plug in the client's string stable to the device information
+    // structure.
+    //
+    psInst->sDevInfo.ppui8StringDescriptors =
+                                        psNCMDevice->ppui8StringDescriptors;
+    psInst->sDevInfo.ui32NumStringDescriptors =
+                                        psNCMDevice->ui32NumStringDescriptors;
+
+    //
+    // Initialize the USB tick module, this will prevent it from being
+    // initialized later in the call to USBDCDInit();
+    //
+    InternalUSBTickInit();
+
+    //
+    // Register our tick handler (this must be done after USBDCDInit).
+    //
+    InternalUSBRegisterTickHandler(NCMTickHandler, (void *)psNCMDevice);
+
+    //
+    // Return the pointer to the instance indicating that everything went well.
+    //
+    return((void *)psNCMDevice);
+}
+
+//*****************************************************************************
+//
+//! Shuts down the NCM device instance.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//!
+//! This function terminates NCM operation for the instance supplied and
+//! removes the device from the USB bus.  This function should not be called
+//! if the NCM device is part of a composite device and instead the
+//! USBDCompositeTerm() function should be called for the full composite
+//! device.
+//!
+//! Following this call, the \e pvNCMDevice instance should not me used in
+//! any other calls.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBDNCMTerm(void *pvNCMDevice)
+{
+    tNCMInstance *psInst;
+
+    ASSERT(pvNCMDevice);
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &((tUSBDNCMDevice *)pvNCMDevice)->sPrivateData;
+
+    //
+    // Terminate the requested instance.
+    //
+    USBDCDTerm(USBBaseToIndex(psInst->ui32USBBase));
+
+    psInst->ui32USBBase = 0;
+}
+
+//*****************************************************************************
+//
+//! Sets the client-specific pointer parameter for the receive channel
+//! callback.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//! \param pvCBData is the pointer that client wishes to be provided on each
+//! event sent to the receive channel callback function.
+//!
+//! The client uses this function to change the callback pointer passed in
+//! the first parameter on all callbacks to the \e pfnRxCallback function
+//! passed on USBDNCMInit().
+//!
+//! \return Returns the previous callback pointer that was being used for
+//! this instance's receive callback.
+//
+//*****************************************************************************
+void *
+USBDNCMSetRxCBData(void *pvNCMDevice, void *pvCBData)
+{
+    void *pvOldValue;
+
+    ASSERT(pvNCMDevice);
+
+    pvOldValue = ((tUSBDNCMDevice *)pvNCMDevice)->pvRxCBData;
+    ((tUSBDNCMDevice *)pvNCMDevice)->pvRxCBData = pvCBData;
+
+    return(pvOldValue);
+}
+
+//*****************************************************************************
+//
+//! Sets the client-specific pointer parameter for the transmit callback.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//! \param pvCBData is the pointer that client wishes to be provided on each
+//! event sent to the transmit channel callback function and on each call to
+//! the frame data function.
+//!
+//! The client uses this function to change the callback pointer passed in
+//! the first parameter on all callbacks to the \e pfnTxCallback and
+//! \e pfnTxFrameData functions passed on USBDNCMInit().
+//!
+//! \return Returns the previous callback pointer that was being used for
+//! this instance's transmit callback.
+//
+//*****************************************************************************
+void *
+USBDNCMSetTxCBData(void *pvNCMDevice, void *pvCBData)
+{
+    void *pvOldValue;
+
+    ASSERT(pvNCMDevice);
+
+    pvOldValue = ((tUSBDNCMDevice *)pvNCMDevice)->pvTxCBData;
+    ((tUSBDNCMDevice *)pvNCMDevice)->pvTxCBData = pvCBData;
+
+    return(pvOldValue);
+}
+
+//*****************************************************************************
+//
+//! Queues an Ethernet frame for transmission to the host.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//! \param pvFrame is the frame to send.  This points to the frame data
+//! unless a \e pfnTxFrameData function was supplied, in which case it is
+//! passed to that function to find the data.
+//! \param ui32Length is the length of the frame in bytes, excluding the CRC.
+//!
+//! The frame is not copied, so it must remain valid until the transmit
+//! callback is sent a \b USB_EVENT_TX_COMPLETE event whose message data is
+//! \e pvFrame.  That event carries a length of zero if the frame was discarded
+//! because the link went down before it could be sent.
+//!
+//! Frames queued while an NTB is being sent are aggregated into the next one,
+//! so a client sending many small frames in quick succession needs far fewer
+//! USB transfers than frames.
+//!
+//! \return Returns \b true if the frame was queued or \b false if the link is
+//! down, the frame is too long or the transmit queue is full.
+//
+//*****************************************************************************
+bool
+USBDNCMFrameWrite(void *pvNCMDevice, void *pvFrame, uint32_t ui32Length)
+{
+    tNCMInstance *psInst;
+    bool bIntsOff;
+
+    ASSERT(pvNCMDevice);
+    ASSERT(pvFrame);
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &((tUSBDNCMDevice *)pvNCMDevice)->sPrivateData;
+
+    if(!psInst->bDataActive || (ui32Length == 0) ||
+       (ui32Length > USBDNCM_MAX_SEGMENT_SIZE))
+    {
+        return(false);
+    }
+
+    //
+    // The queue is shared with the USB interrupt, which removes frames once
+    // they have been sent.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    if(psInst->ui32TxCount == USBDNCM_TX_QUEUE_SIZE)
+    {
+        psInst->sStats.ui32TxQueueFull++;
+
+        if(!bIntsOff)
+        {
+            MAP_IntMasterEnable();
+        }
+        return(false);
+    }
+
+    psInst->psTxQueue[psInst->ui32TxWrite].pvFrame = pvFrame;
+    psInst->psTxQueue[psInst->ui32TxWrite].ui32Length = ui32Length;
+    psInst->ui32TxWrite = (psInst->ui32TxWrite + 1) % USBDNCM_TX_QUEUE_SIZE;
+    psInst->ui32TxCount++;
+
+    //
+    // Start sending at once if no NTB is in progress.
+    //
+    TxNTBStart((tUSBDNCMDevice *)pvNCMDevice);
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Returns the number of frames that may currently be queued.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//!
+//! \return Returns the number of free entries in the transmit queue, or zero
+//! if the link is down.
+//
+//*****************************************************************************
+uint32_t
+USBDNCMTxQueueSpace(void *pvNCMDevice)
+{
+    tNCMInstance *psInst;
+
+    ASSERT(pvNCMDevice);
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &((tUSBDNCMDevice *)pvNCMDevice)->sPrivateData;
+
+    if(!psInst->bDataActive)
+    {
+        return(0);
+    }
+
+    return(USBDNCM_TX_QUEUE_SIZE - psInst->ui32TxCount);
+}
+
+//*****************************************************************************
+//
+//! Releases a received datagram.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//! \param pui8Datagram is the datagram pointer that was passed with a
+//! \b USB_EVENT_RX_AVAILABLE event.
+//!
+//! Each received datagram must be released once the client has finished with
+//! it.  An NTB buffer is reused only after every datagram in it has been
+//! released, and the host is held off while all of the buffers are in use.
+//! This function may be called from the receive callback or later from any
+//! context.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBDNCMRxDatagramRelease(void *pvNCMDevice, const uint8_t *pui8Datagram)
+{
+    tNCMInstance *psInst;
+    tNCMRxNTB *psNTB;
+    uint32_t ui32Loop;
+    bool bIntsOff;
+
+    ASSERT(pvNCMDevice);
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &((tUSBDNCMDevice *)pvNCMDevice)->sPrivateData;
+
+    for(ui32Loop = 0; ui32Loop < USBDNCM_RX_NTB_BUFFERS; ui32Loop++)
+    {
+        psNTB = &psInst->psRxNTB[ui32Loop];
+
+        if((pui8Datagram >= psNTB->pui8Data) &&
+           (pui8Datagram < (psNTB->pui8Data + psInst->ui32RxNTBSize)))
+        {
+            bIntsOff = MAP_IntMasterDisable();
+
+            ASSERT(psNTB->ui32RefCount != 0);
+            if(psNTB->ui32RefCount)
+            {
+                psNTB->ui32RefCount--;
+            }
+
+            //
+            // If reception stopped for want of a buffer, this one can now be
+            // used.  Reception resumes from the tick handler.
+            //
+            if((psNTB->ui32RefCount == 0) &&
+               (psInst->ui32RxFill >= USBDNCM_RX_NTB_BUFFERS))
+            {
+                psNTB->ui32Count = 0;
+                psInst->ui32RxFill = ui32Loop;
+            }
+
+            if(!bIntsOff)
+            {
+                MAP_IntMasterEnable();
+            }
+            return;
+        }
+    }
+
+    //
+    // The pointer was not in any receive buffer.
+    //
+    ASSERT(0);
+}
+
+//*****************************************************************************
+//
+//! Returns the number of receive buffers that hold no datagrams.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//!
+//! A client that holds on to received datagrams rather than copying them
+//! keeps the NTB buffers holding them from being reused, and reception stops
+//! if it holds datagrams in every buffer.  The client can use this function
+//! to decide whether a datagram may be held or should be copied and released
+//! at once.  The buffer being filled with the next NTB is counted as free.
+//!
+//! \return Returns the number of NTB buffers, out of
+//! \b USBDNCM_RX_NTB_BUFFERS, in which the client holds no datagrams.
+//
+//*****************************************************************************
+uint32_t
+USBDNCMRxBuffersFree(void *pvNCMDevice)
+{
+    tNCMInstance *psInst;
+    uint32_t ui32Loop, ui32Free;
+
+    ASSERT(pvNCMDevice);
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &((tUSBDNCMDevice *)pvNCMDevice)->sPrivateData;
+
+    ui32Free = 0;
+    for(ui32Loop = 0; ui32Loop < USBDNCM_RX_NTB_BUFFERS; ui32Loop++)
+    {
+        if(psInst->psRxNTB[ui32Loop].ui32RefCount == 0)
+        {
+            ui32Free++;
+        }
+    }
+
+    return(ui32Free);
+}
+
+//*****************************************************************************
+//
+//! Reports whether the network link to the host is up.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//!
+//! \return Returns \b true if the host has enabled the data interface and
+//! frames may be exchanged, or \b false otherwise.
+//
+//*****************************************************************************
+bool
+USBDNCMLinkUp(void *pvNCMDevice)
+{
+    ASSERT(pvNCMDevice);
+
+    return(((tUSBDNCMDevice *)pvNCMDevice)->sPrivateData.bDataActive);
+}
+
+//*****************************************************************************
+//
+//! Returns the statistics kept for an NCM device.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//! \param psStats points to the structure that the statistics are copied to.
+//!
+//! The counts cover the frames and NTBs exchanged with the host since the
+//! device was initialized or USBDNCMStatsClear() was last called.  Sampling
+//! them at intervals gives the frame rate in each direction and the degree of
+//! aggregation achieved.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBDNCMStatsGet(void *pvNCMDevice, tUSBDNCMStats *psStats)
+{
+    tNCMInstance *psInst;
+    bool bIntsOff;
+
+    ASSERT(pvNCMDevice);
+    ASSERT(psStats);
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &((tUSBDNCMDevice *)pvNCMDevice)->sPrivateData;
+
+    //
+    // Take a consistent snapshot of the counts.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+
+    psStats->ui32TxFrames = psInst->sStats.ui32TxFrames;
+    psStats->ui32TxNTBs = psInst->sStats.ui32TxNTBs;
+    psStats->ui32TxQueueFull = psInst->sStats.ui32TxQueueFull;
+    psStats->ui32TxDiscarded = psInst->sStats.ui32TxDiscarded;
+    psStats->ui32RxFrames = psInst->sStats.ui32RxFrames;
+    psStats->ui32RxNTBs = psInst->sStats.ui32RxNTBs;
+    psStats->ui32RxErrors = psInst->sStats.ui32RxErrors;
+    psStats->ui32RxNoBuffer = psInst->sStats.ui32RxNoBuffer;
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Clears the statistics kept for an NCM device.
+//!
+//! \param pvNCMDevice is the pointer to the device instance structure as
+//! returned by USBDNCMInit().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBDNCMStatsClear(void *pvNCMDevice)
+{
+    tNCMInstance *psInst;
+    bool bIntsOff;
+
+    ASSERT(pvNCMDevice);
+
+    //
+    // Get a pointer to the NCM device instance data pointer
+    //
+    psInst = &((tUSBDNCMDevice *)pvNCMDevice)->sPrivateData;
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    psInst->sStats.ui32TxFrames = 0;
+    psInst->sStats.ui32TxNTBs = 0;
+    psInst->sStats.ui32TxQueueFull = 0;
+    psInst->sStats.ui32TxDiscarded = 0;
+    psInst->sStats.ui32RxFrames = 0;
+    psInst->sStats.ui32RxNTBs = 0;
+    psInst->sStats.ui32RxErrors = 0;
+    psInst->sStats.ui32RxNoBuffer = 0;
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
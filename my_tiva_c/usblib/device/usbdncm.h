@@ -0,0 +1,483 @@
+//*****************************************************************************
+//
+// usbdncm.h - USBLib support for a CDC NCM network device.
+//
+// Copyright (c) 2008-2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva USB Library.
+//
+//*****************************************************************************
+
+#ifndef __USBDNCM_H__
+#define __USBDNCM_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup ncm_device_class_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The largest Ethernet frame, excluding the CRC, that may be passed to
+//! USBDNCMFrameWrite() or received from the host.
+//
+//*****************************************************************************
+#define USBDNCM_MAX_SEGMENT_SIZE                                              \
+                                1514
+
+//*****************************************************************************
+//
+//! The largest NCM Transfer Block (NTB) that the device sends to the host.
+//! The host may lower this using the SET_NTB_INPUT_SIZE request but may not
+//! raise it.
+//
+//*****************************************************************************
+#define USBDNCM_NTB_IN_MAX_SIZE 2048
+
+//*****************************************************************************
+//
+//! The number of frames that may be queued for transmission by
+//! USBDNCMFrameWrite() and the largest number of those frames that is
+//! aggregated into a single NTB.
+//
+//*****************************************************************************
+#define USBDNCM_TX_QUEUE_SIZE   16
+#define USBDNCM_TX_NTB_FRAMES   8
+
+//*****************************************************************************
+//
+//! The receive buffer supplied in tUSBDNCMDevice is split into this number of
+//! NTB buffers, each of which must hold at least
+//! \b USBDNCM_NTB_OUT_MIN_SIZE bytes.  Three buffers let a client hold the
+//! datagrams of one NTB while the next two are received.
+//
+//*****************************************************************************
+#define USBDNCM_RX_NTB_BUFFERS  3
+#define USBDNCM_NTB_OUT_MIN_SIZE                                              \
+                                2048
+
+//*****************************************************************************
+//
+// PRIVATE
+//
+// The first few sections of this header are private defines that are used by
+// the USB NCM code and are here only to help with the application allocating
+// the correct amount of memory for the NCM device code.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// PRIVATE
+//
+// A frame waiting in the transmit queue.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The client's frame pointer passed to USBDNCMFrameWrite().
+    //
+    void *pvFrame;
+
+    //
+    // The length of the frame in bytes.
+    //
+    uint32_t ui32Length;
+}
+tNCMTxFrame;
+
+//*****************************************************************************
+//
+// PRIVATE
+//
+// The state of one of the NTB buffers used for reception.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The start of the buffer.
+    //
+    uint8_t *pui8Data;
+
+    //
+    // The number of bytes of the current NTB received so far.
+    //
+    uint32_t ui32Count;
+
+    //
+    // The number of datagrams in this buffer still held by the client.
+    //
+    volatile uint32_t ui32RefCount;
+}
+tNCMRxNTB;
+
+//*****************************************************************************
+//
+//! The statistics kept by the NCM device class and returned by
+//! USBDNCMStatsGet().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of frames sent to the host.
+    //
+    uint32_t ui32TxFrames;
+
+    //
+    //! The number of NTBs sent to the host.  Dividing \e ui32TxFrames by this
+    //! value gives the average number of frames aggregated into each NTB.
+    //
+    uint32_t ui32TxNTBs;
+
+    //
+    //! The number of frames rejected by USBDNCMFrameWrite() because the
+    //! transmit queue was full.
+    //
+    uint32_t ui32TxQueueFull;
+
+    //
+    //! The number of queued frames discarded because the host closed the
+    //! data interface or the device was disconnected.
+    //
+    uint32_t ui32TxDiscarded;
+
+    //
+    //! The number of datagrams received from the host.
+    //
+    uint32_t ui32RxFrames;
+
+    //
+    //! The number of NTBs received from the host.
+    //
+    uint32_t ui32RxNTBs;
+
+    //
+    //! The number of NTBs or datagrams received from the host that were
+    //! discarded because they were malformed.
+    //
+    uint32_t ui32RxErrors;
+
+    //
+    //! The number of times a packet from the host was held off because the
+    //! client still held datagrams in every receive buffer.
+    //
+    uint32_t ui32RxNoBuffer;
+}
+tUSBDNCMStats;
+
+//*****************************************************************************
+//
+// PRIVATE
+//
+// This structure defines the private instance data and state variables for
+// the NCM device.  The memory for this structure is included in the
+// sPrivateData field in the tUSBDNCMDevice structure passed on USBDNCMInit().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Base address for the USB controller.
+    //
+    uint32_t ui32USBBase;
+
+    //
+    // The device info to interact with the lower level DCD code.
+    //
+    tDeviceInfo sDevInfo;
+
+    //
+    // The connection status of the device and whether the host has selected
+    // the alternate setting of the data interface that carries traffic.
+    //
+    volatile bool bConnected;
+    volatile bool bDataActive;
+
+    //
+    // The interrupt, bulk IN and bulk OUT endpoint numbers, these are
+    // modified in composite devices.
+    //
+    uint8_t ui8ControlEndpoint;
+    uint8_t ui8INEndpoint;
+    uint8_t ui8OUTEndpoint;
+
+    //
+    // The control and data interface numbers, these are modified in
+    // composite devices.
+    //
+    uint8_t ui8InterfaceControl;
+    uint8_t ui8InterfaceData;
+
+    //
+    // The request whose data stage is expected on endpoint zero, and the
+    // buffer that the data is read into.
+    //
+    uint8_t ui8PendingRequest;
+    uint32_t pui32RequestData[2];
+
+    //
+    // Flags tracking the transmit, receive and notification state.
+    //
+    volatile uint32_t ui32Flags;
+
+    //
+    // The notification being sent on the interrupt endpoint.
+    //
+    uint32_t pui32Notify[4];
+
+    //
+    // The parameters returned for GET_NTB_PARAMETERS and the largest IN NTB
+    // currently allowed by the host.
+    //
+    tNCMNTBParameters sNTBParams;
+    uint32_t ui32NTBInMaxSize;
+
+    //
+    // The transmit queue.  Frames are added at ui32TxWrite and removed, once
+    // sent, from ui32TxRead.
+    //
+    tNCMTxFrame psTxQueue[USBDNCM_TX_QUEUE_SIZE];
+    volatile uint32_t ui32TxRead;
+    volatile uint32_t ui32TxWrite;
+    volatile uint32_t ui32TxCount;
+
+    //
+    // The NTB being sent: the number of queued frames it carries, its total
+    // size and the number of bytes written to the FIFO so far.  The NTH16
+    // and NDP16 are built here and the frames themselves are copied straight
+    // from the client's buffers into the FIFO.
+    //
+    uint32_t ui32TxNTBFrames;
+    uint32_t ui32TxNTBSize;
+    uint32_t ui32TxNTBOffset;
+    uint32_t ui32TxNDPIndex;
+    uint16_t ui16TxSequence;
+    uint32_t pui32TxNTH[USB_CDC_NCM_NTH16_SIZE / 4];
+    uint32_t pui32TxNDP[USB_CDC_NCM_NDP16_SIZE(USBDNCM_TX_NTB_FRAMES) / 4];
+
+    //
+    // The receive NTB buffers, the size of each and the index of the buffer
+    // being filled, or USBDNCM_RX_NTB_BUFFERS if none is free.
+    //
+    tNCMRxNTB psRxNTB[USBDNCM_RX_NTB_BUFFERS];
+    uint32_t ui32RxNTBSize;
+    volatile uint32_t ui32RxFill;
+
+    //
+    // The statistics for this instance.
+    //
+    tUSBDNCMStats sStats;
+}
+tNCMInstance;
+
+//*****************************************************************************
+//
+// The size of the Interface Association Descriptor and of the control and
+// data interface sections of the configuration descriptor.
+//
+//*****************************************************************************
+#define NCMDESCRIPTOR_SIZE      (8)
+#define NCMCOMMINTERFACE_SIZE   (45)
+#define NCMDATAINTERFACE_SIZE   (32)
+
+//*****************************************************************************
+//
+//! The size of the memory that should be allocated to create a configuration
+//! descriptor for a single instance of the USB NCM Device.
+//! This does not include the configuration descriptor which is automatically
+//! ignored by the composite device class.
+//
+//*****************************************************************************
+#define COMPOSITE_DNCM_SIZE     (NCMDESCRIPTOR_SIZE + NCMCOMMINTERFACE_SIZE + \
+                                 NCMDATAINTERFACE_SIZE)
+
+//*****************************************************************************
+//
+//! The prototype for the function used to find the data of a frame passed to
+//! USBDNCMFrameWrite() when it is not held in a single contiguous buffer.
+//!
+//! The function is passed the transmit callback data, the frame pointer and
+//! an offset into the frame.  It must set the pointer it is given to the
+//! frame data at that offset and return the number of contiguous bytes that
+//! can be read from there.
+//
+//*****************************************************************************
+typedef uint32_t (* tUSBDNCMFrameData)(void *pvCBData, void *pvFrame,
+                                       uint32_t ui32Offset,
+                                       const uint8_t **ppui8Data);
+
+//*****************************************************************************
+//
+//! The structure used by the application to define operating parameters for
+//! the NCM device.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The vendor ID that this device is to present in the device descriptor.
+    //
+    const uint16_t ui16VID;
+
+    //
+    //! The product ID that this device is to present in the device descriptor.
+    //
+    const uint16_t ui16PID;
+
+    //
+    //! The maximum power consumption of the device, expressed in milliamps.
+    //
+    const uint16_t ui16MaxPowermA;
+
+    //
+    //! Indicates whether the device is self- or bus-powered and whether or not
+    //! it supports remote wakeup.  Valid values are USB_CONF_ATTR_SELF_PWR or
+    //! USB_CONF_ATTR_BUS_PWR, optionally ORed with USB_CONF_ATTR_RWAKE.
+    //
+    const uint8_t ui8PwrAttributes;
+
+    //
+    //! A pointer to the callback function which will be called to notify
+    //! the application of received frames and of link and bus events.
+    //
+    const tUSBCallback pfnRxCallback;
+
+    //
+    //! A client-supplied pointer which will be sent as the first
+    //! parameter in all calls made to the receive channel callback,
+    //! pfnRxCallback.
+    //
+    void *pvRxCBData;
+
+    //
+    //! A pointer to the callback function which will be called to notify
+    //! the application that a frame passed to USBDNCMFrameWrite() is no
+    //! longer needed.
+    //
+    const tUSBCallback pfnTxCallback;
+
+    //
+    //! A client-supplied pointer which will be sent as the first
+    //! parameter in all calls made to the transmit channel callback,
+    //! pfnTxCallback, and to pfnTxFrameData.
+    //
+    void *pvTxCBData;
+
+    //
+    //! A pointer to the function used to find the data of a queued frame, or
+    //! NULL if the frame pointers passed to USBDNCMFrameWrite() point to
+    //! contiguous frame data.
+    //
+    const tUSBDNCMFrameData pfnTxFrameData;
+
+    //
+    //! A word-aligned buffer used to receive NTBs from the host.  It must
+    //! hold at least \b USBDNCM_RX_NTB_BUFFERS times
+    //! \b USBDNCM_NTB_OUT_MIN_SIZE bytes.
+    //
+    uint8_t *pui8RxBuffer;
+
+    //
+    //! The size of the receive buffer in bytes.
+    //
+    const uint32_t ui32RxBufferSize;
+
+    //
+    //! A pointer to the string descriptor array for this device.  This array
+    //! must contain pointers to the following string descriptors in this
+    //! order.  Language descriptor, Manufacturer name string (language 1),
+    //! Product name string (language 1), Serial number string (language 1),
+    //! Control interface description string (language 1), Configuration
+    //! description string (language 1) and MAC address string (language 1).
+    //! The MAC address string holds the 12 hexadecimal digits of the address
+    //! that the host uses for its end of the link.
+    //!
+    //! If supporting more than 1 language, the strings for indices 1 through 6
+    //! must be repeated for each of the other languages defined in the
+    //! language descriptor.
+    //
+    const uint8_t * const *ppui8StringDescriptors;
+
+    //
+    //! The number of descriptors provided in the ppStringDescriptors array.
+    //! This must be 1 + (6 * number of supported languages).
+    //
+    const uint32_t ui32NumStringDescriptors;
+
+    //
+    //! The private instance data for this device.  This memory must
+    //! not be modified by any code outside the NCM class driver.
+    //
+    tNCMInstance sPrivateData;
+}
+tUSBDNCMDevice;
+
+//*****************************************************************************
+//
+// API Function Prototypes
+//
+//*****************************************************************************
+extern void *USBDNCMInit(uint32_t ui32Index, tUSBDNCMDevice *psNCMDevice);
+extern void *USBDNCMCompositeInit(uint32_t ui32Index,
+                                  tUSBDNCMDevice *psNCMDevice,
+                                  tCompositeEntry *psCompEntry);
+extern void USBDNCMTerm(void *pvNCMDevice);
+extern void *USBDNCMSetRxCBData(void *pvNCMDevice, void *pvCBData);
+extern void *USBDNCMSetTxCBData(void *pvNCMDevice, void *pvCBData);
+extern bool USBDNCMFrameWrite(void *pvNCMDevice, void *pvFrame,
+                              uint32_t ui32Length);
+extern uint32_t USBDNCMTxQueueSpace(void *pvNCMDevice);
+extern void USBDNCMRxDatagramRelease(void *pvNCMDevice,
+                                     const uint8_t *pui8Datagram);
+extern uint32_t USBDNCMRxBuffersFree(void *pvNCMDevice);
+extern bool USBDNCMLinkUp(void *pvNCMDevice);
+extern void USBDNCMStatsGet(void *pvNCMDevice, tUSBDNCMStats *psStats);
+extern void USBDNCMStatsClear(void *pvNCMDevice);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __USBDNCM_H__
@@ -627,10 +627,18 @@ AudioGetInterface(tUSBHostAudioInstance *psAudioDevice, uint16_t ui16Format,
             //
             // Configure the USB pipe as a Isochronous IN end point.
             //
-            USBHCDPipeConfig(g_sAudioDevice.ui32IsochInPipe,
-                             pINEndpoint->wMaxPacketSize,
-                             0,
-                             g_sAudioDevice.ui8IsochInAddress);
+            if(USBHCDPipeConfig(g_sAudioDevice.ui32IsochInPipe,
+                                pINEndpoint->wMaxPacketSize,
+                                0,
+                                g_sAudioDevice.ui8IsochInAddress) != 0)
+            {
+                //
+                // There is not enough periodic bandwidth left for the
+                // endpoint so this format cannot be used.  The pipe is kept
+                // for the next format that is tried.
+                //
+                return(INVALID_INTERFACE);
+            }
         }
 
         //
@@ -686,9 +694,17 @@ AudioGetInterface(tUSBHostAudioInstance *psAudioDevice, uint16_t ui16Format,
             //
             // Configure the USB pipe as a Isochronous OUT end point.
             //
-            USBHCDPipeConfig(g_sAudioDevice.ui32IsochOutPipe,
-                             pOUTEndpoint->wMaxPacketSize, 0,
-                             g_sAudioDevice.ui8IsochOutAddress);
+            if(USBHCDPipeConfig(g_sAudioDevice.ui32IsochOutPipe,
+                                pOUTEndpoint->wMaxPacketSize, 0,
+                                g_sAudioDevice.ui8IsochOutAddress) != 0)
+            {
+                //
+                // There is not enough periodic bandwidth left for the
+                // endpoint so this format cannot be used.  The pipe is kept
+                // for the next format that is tried.
+                //
+                return(INVALID_INTERFACE);
+            }
         }
 
         return(psInterface->bInterfaceNumber |
@@ -322,11 +322,24 @@ HIDDriverOpen(tUSBHostDevice *psDevice)
                         g_psHIDDevice[i32Dev].ui32IntInPipe =
                                 USBHCDPipeAlloc(0, USBHCD_PIPE_INTR_IN,
                                                 psDevice, HIDIntINCallback);
-                        USBHCDPipeConfig(g_psHIDDevice[i32Dev].ui32IntInPipe,
+                        if(USBHCDPipeConfig(
+                                    g_psHIDDevice[i32Dev].ui32IntInPipe,
                                     psEndpointDescriptor->wMaxPacketSize,
                                     psEndpointDescriptor->bInterval,
                                     (psEndpointDescriptor->bEndpointAddress &
-                                     USB_EP_DESC_NUM_M));
+                                     USB_EP_DESC_NUM_M)) != 0)
+                        {
+                            //
+                            // There is not enough periodic bandwidth left
+                            // for the endpoint so the device cannot be used.
+                            //
+                            USBHCDPipeFree(
+                                    g_psHIDDevice[i32Dev].ui32IntInPipe);
+                            g_psHIDDevice[i32Dev].ui32IntInPipe = 0;
+                            g_psHIDDevice[i32Dev].psDevice = 0;
+
+                            return(0);
+                        }
                     }
                 }
             }
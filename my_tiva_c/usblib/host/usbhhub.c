@@ -218,8 +218,11 @@ struct tHubInstance
     uint32_t ui32Flags;
 
     //
-    // Flag indicating that a device is currently in process of being
-    // enumerated.
+    // Flag indicating that a device is currently being reset or is still
+    // using the default address.  Only one device on the bus may do so at a
+    // time, so the next port waiting to be enumerated is held off until this
+    // is cleared.  Devices that have been addressed finish their enumeration
+    // with this flag clear.
     //
     volatile bool bEnumerationBusy;
 
@@ -699,11 +702,19 @@ HubDriverOpen(tUSBHostDevice *psDevice)
             g_sRootHub.ui32IntInPipe = USBHCDPipeAlloc(0, USBHCD_PIPE_INTR_IN,
                                                        psDevice,
                                                        HubIntINCallback);
-            USBHCDPipeConfig(g_sRootHub.ui32IntInPipe,
-                             psEndpointDescriptor->wMaxPacketSize,
-                             psEndpointDescriptor->bInterval,
-                             psEndpointDescriptor->bEndpointAddress &
-                             USB_EP_DESC_NUM_M);
+            if(USBHCDPipeConfig(g_sRootHub.ui32IntInPipe,
+                                psEndpointDescriptor->wMaxPacketSize,
+                                psEndpointDescriptor->bInterval,
+                                psEndpointDescriptor->bEndpointAddress &
+                                USB_EP_DESC_NUM_M) != 0)
+            {
+                //
+                // There is not enough periodic bandwidth left for the
+                // endpoint so the pipe cannot be used.
+                //
+                USBHCDPipeFree(g_sRootHub.ui32IntInPipe);
+                g_sRootHub.ui32IntInPipe = 0;
+            }
         }
     }
 
@@ -1011,12 +1022,10 @@ HubDriverDeviceDisconnect(uint8_t ui8Port)
     }
 
     //
-    // If the device was being enumerated, make sure we clear the flag
-    // indicating that an enumeration is still ongoing.
+    // If the device was holding the default address, make sure we clear the
+    // flag indicating that an enumeration is still ongoing.
     //
-    if((g_sRootHub.psPorts[ui8Port].iState == ePortResetActive) ||
-       (g_sRootHub.psPorts[ui8Port].iState == ePortResetWait) ||
-       (g_sRootHub.psPorts[ui8Port].iState == ePortActive))
+    if(g_sRootHub.bEnumerationBusy && (g_sRootHub.ui8EnumIdx == ui8Port))
     {
         g_sRootHub.bEnumerationBusy = false;
     }
@@ -1105,14 +1114,11 @@ USBHHubMain(void)
         }
 
         //
-        // If an enumeration is in progress and the loop is not on the port
-        // being enumerated then skip the port.
+        // Changes are handled on every port even while another port is being
+        // enumerated so that the connection debounce of newly connected
+        // devices overlaps the enumeration.  Only the port reset is held off
+        // until the default address is free.
         //
-        if(g_sRootHub.bEnumerationBusy &&
-           (g_sRootHub.ui8EnumIdx != ui8Port))
-        {
-            continue;
-        }
 
         //
         // Did something change for this particular port?
@@ -1271,6 +1277,37 @@ USBHHubMain(void)
     }
 }
 
+//*****************************************************************************
+//
+//! Informs the hub class driver that a downstream device has been addressed.
+//!
+//! \param ui8Hub is the address of the hub to which the downstream device
+//! is attached.
+//! \param ui8Port is the port on the hub to which the downstream device is
+//! attached.
+//!
+//! This function is called by the host controller driver once a downstream
+//! device has moved from the default address to its assigned address.  The
+//! hub driver may then start resetting the next newly connected device while
+//! the host controller driver completes the enumeration of this one.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBHHubEnumerationAddressed(uint8_t ui8Hub, uint8_t ui8Port)
+{
+    DEBUG_OUTPUT("Addressed device on hub %d, port %d\n", ui8Hub, ui8Port);
+
+    //
+    // The default address is free so allow the next enumeration to start.
+    //
+    if(g_sRootHub.ui8EnumIdx == ui8Port)
+    {
+        g_sRootHub.bEnumerationBusy = false;
+    }
+}
+
 //*****************************************************************************
 //
 //! Informs the hub class driver that a downstream device has been enumerated.
@@ -1299,11 +1336,14 @@ USBHHubEnumerationComplete(uint8_t ui8Hub, uint8_t ui8Port)
     g_sRootHub.psPorts[ui8Port].iState = ePortEnumerated;
 
     //
-    // Clear the flag we use to defer further enumerations.  This will cause
-    // the next connected device (if any) to start enumeration on the next
-    // call to USBHHubMain().
+    // Clear the flag we use to defer further enumerations if this port still
+    // holds it.  This will cause the next connected device (if any) to start
+    // enumeration on the next call to USBHHubMain().
     //
-    g_sRootHub.bEnumerationBusy = false;
+    if(g_sRootHub.ui8EnumIdx == ui8Port)
+    {
+        g_sRootHub.bEnumerationBusy = false;
+    }
 }
 
 //*****************************************************************************
@@ -1334,11 +1374,14 @@ USBHHubEnumerationError(uint8_t ui8Hub, uint8_t ui8Port)
     g_sRootHub.psPorts[ui8Port].iState = ePortError;
 
     //
-    // Clear the flag we use to defer further enumerations.  This will cause
-    // the next connected device (if any) to start enumeration on the next
-    // call to USBHHubMain().
+    // Clear the flag we use to defer further enumerations if this port still
+    // holds it.  This will cause the next connected device (if any) to start
+    // enumeration on the next call to USBHHubMain().
     //
-    g_sRootHub.bEnumerationBusy = false;
+    if(g_sRootHub.ui8EnumIdx == ui8Port)
+    {
+        g_sRootHub.bEnumerationBusy = false;
+    }
 }
 
 //*****************************************************************************
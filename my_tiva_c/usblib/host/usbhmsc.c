@@ -90,6 +90,36 @@ struct tUSBHMSCInstance
     // Bulk OUT pipe.
     //
     uint32_t ui32BulkOutPipe;
+
+    //
+    // The sense data reported by the device for the last failed command,
+    // packed as the sense key, additional sense code and qualifier.
+    //
+    uint32_t ui32Sense;
+
+    //
+    // The buffer used to cache blocks for read-ahead and write-behind and its
+    // size in bytes.
+    //
+    uint8_t *pui8Cache;
+    uint32_t ui32CacheSize;
+
+    //
+    // The first block held in the cache and the number of blocks held.
+    //
+    uint32_t ui32CacheLBA;
+    uint32_t ui32CacheCount;
+
+    //
+    // Set if the cache holds blocks that have not been written to the device.
+    //
+    bool bCacheDirty;
+
+    //
+    // The block following the last block read, used to detect sequential
+    // reads.
+    //
+    uint32_t ui32NextLBA;
 };
 
 //*****************************************************************************
@@ -237,6 +267,14 @@ USBHMSCOpen(tUSBHostDevice *psDevice)
 
     g_sUSBHMSCDevice.ui32MaxLUN = 0xffffffff;
 
+    //
+    // Start with an empty cache and no sense data.
+    //
+    g_sUSBHMSCDevice.ui32Sense = 0;
+    g_sUSBHMSCDevice.ui32CacheCount = 0;
+    g_sUSBHMSCDevice.bCacheDirty = false;
+    g_sUSBHMSCDevice.ui32NextLBA = 0xffffffff;
+
     //
     // Return the only instance of this device.
     //
@@ -272,6 +310,12 @@ USBHMSCClose(void *pvInstance)
     //
     g_sUSBHMSCDevice.psDevice = 0;
 
+    //
+    // Anything left in the cache can no longer be written so discard it.
+    //
+    g_sUSBHMSCDevice.ui32CacheCount = 0;
+    g_sUSBHMSCDevice.bCacheDirty = false;
+
     //
     // Free the Bulk IN pipe.
     //
@@ -354,6 +398,139 @@ USBHMSCGetMaxLUN(tUSBHostDevice *psDevice, uint32_t ui32Interface,
     }
 }
 
+//*****************************************************************************
+//
+// This function issues a SCSI Request Sense command to the device and saves
+// the sense key, additional sense code and qualifier that it returns.
+//
+//*****************************************************************************
+static void
+USBHMSCSenseRequest(tUSBHMSCInstance *psMSCInstance)
+{
+    uint8_t pui8Sense[SCSI_REQUEST_SENSE_SZ];
+    uint32_t ui32Size;
+
+    ui32Size = SCSI_REQUEST_SENSE_SZ;
+
+    if(USBHSCSIRequestSense(psMSCInstance->ui32BulkInPipe,
+                            psMSCInstance->ui32BulkOutPipe, pui8Sense,
+                            &ui32Size) != SCSI_CMD_STATUS_PASS)
+    {
+        //
+        // No sense data is available so report an aborted command.
+        //
+        psMSCInstance->ui32Sense = SCSI_RS_KEY_ABORT << 16;
+        return;
+    }
+
+    psMSCInstance->ui32Sense =
+                        ((pui8Sense[SCSI_RS_SKEY] & SCSI_RS_KEY_M) << 16) |
+                        (pui8Sense[SCSI_RS_SKEY_AD_SKEY] << 8) |
+                        pui8Sense[SCSI_RS_SKEY_AD_SKEY + 1];
+}
+
+//*****************************************************************************
+//
+// This function transfers a run of blocks to or from the device using a
+// single SCSI Read(10) or Write(10) command.  If the command fails the sense
+// data is read from the device and a command that failed because of a unit
+// attention condition is retried once.
+//
+//*****************************************************************************
+static int32_t
+USBHMSCTransfer(tUSBHMSCInstance *psMSCInstance, bool bWrite,
+                uint32_t ui32LBA, uint8_t *pui8Data, uint32_t ui32NumBlocks)
+{
+    uint32_t ui32Size, ui32Retry, ui32Status;
+
+    for(ui32Retry = 0; ui32Retry < 2; ui32Retry++)
+    {
+        //
+        // Calculate the actual byte size of the transfer.
+        //
+        ui32Size = psMSCInstance->ui32BlockSize * ui32NumBlocks;
+
+        if(bWrite)
+        {
+            ui32Status = USBHSCSIWrite10(psMSCInstance->ui32BulkInPipe,
+                                         psMSCInstance->ui32BulkOutPipe,
+                                         ui32LBA, pui8Data, &ui32Size,
+                                         ui32NumBlocks);
+        }
+        else
+        {
+            ui32Status = USBHSCSIRead10(psMSCInstance->ui32BulkInPipe,
+                                        psMSCInstance->ui32BulkOutPipe,
+                                        ui32LBA, pui8Data, &ui32Size,
+                                        ui32NumBlocks);
+        }
+
+        if(ui32Status == SCSI_CMD_STATUS_PASS)
+        {
+            psMSCInstance->ui32Sense = 0;
+            return(0);
+        }
+
+        //
+        // Find out why the command failed.
+        //
+        USBHMSCSenseRequest(psMSCInstance);
+
+        if(USBHMSC_SENSE_KEY(psMSCInstance->ui32Sense) !=
+           SCSI_RS_KEY_UNIT_ATTN)
+        {
+            break;
+        }
+    }
+
+    return(-1);
+}
+
+//*****************************************************************************
+//
+// Copies a number of blocks between the cache and a caller's buffer.
+//
+//*****************************************************************************
+static void
+USBHMSCCacheCopy(uint8_t *pui8Dst, const uint8_t *pui8Src, uint32_t ui32Size)
+{
+    while(ui32Size--)
+    {
+        *pui8Dst++ = *pui8Src++;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the number of blocks that fit in the cache.
+//
+//*****************************************************************************
+static uint32_t
+USBHMSCCacheBlocks(tUSBHMSCInstance *psMSCInstance)
+{
+    if((psMSCInstance->pui8Cache == 0) || (psMSCInstance->ui32BlockSize == 0))
+    {
+        return(0);
+    }
+
+    return(psMSCInstance->ui32CacheSize / psMSCInstance->ui32BlockSize);
+}
+
+//*****************************************************************************
+//
+// Returns true if any of the blocks in a range are held in the cache.
+//
+//*****************************************************************************
+static bool
+USBHMSCCacheOverlap(tUSBHMSCInstance *psMSCInstance, uint32_t ui32LBA,
+                    uint32_t ui32NumBlocks)
+{
+    return((psMSCInstance->ui32CacheCount != 0) &&
+           (ui32LBA < (psMSCInstance->ui32CacheLBA +
+                       psMSCInstance->ui32CacheCount)) &&
+           ((ui32LBA + ui32NumBlocks) > psMSCInstance->ui32CacheLBA));
+}
+
 //*****************************************************************************
 //
 //! This function checks if a drive is ready to be accessed.
@@ -440,10 +617,7 @@ USBHMSCDriveReady(tUSBHMSCInstance *psMSCInstance)
         // Get the current sense data from the device to see why it failed
         // the Read Capacity command.
         //
-        ui32Size = SCSI_REQUEST_SENSE_SZ;
-        USBHSCSIRequestSense(psMSCInstance->ui32BulkInPipe,
-                             psMSCInstance->ui32BulkOutPipe, pui8Buffer,
-                             &ui32Size);
+        USBHMSCSenseRequest(psMSCInstance);
 
         //
         // If the read capacity failed then check if the drive is ready.
@@ -456,10 +630,7 @@ USBHMSCDriveReady(tUSBHMSCInstance *psMSCInstance)
             // Get the current sense data from the device to see why it failed
             // the Test Unit Ready command.
             //
-            ui32Size = SCSI_REQUEST_SENSE_SZ;
-            USBHSCSIRequestSense(psMSCInstance->ui32BulkInPipe,
-                                 psMSCInstance->ui32BulkOutPipe, pui8Buffer,
-                                 &ui32Size);
+            USBHMSCSenseRequest(psMSCInstance);
         }
 
         return(-1);
@@ -492,10 +663,7 @@ USBHMSCDriveReady(tUSBHMSCInstance *psMSCInstance)
         // Get the current sense data from the device to see why it failed
         // the Test Unit Ready command.
         //
-        ui32Size = SCSI_REQUEST_SENSE_SZ;
-        USBHSCSIRequestSense(psMSCInstance->ui32BulkInPipe,
-                             psMSCInstance->ui32BulkOutPipe, pui8Buffer,
-                             &ui32Size);
+        USBHMSCSenseRequest(psMSCInstance);
 
         return(-1);
     }
@@ -503,6 +671,8 @@ USBHMSCDriveReady(tUSBHMSCInstance *psMSCInstance)
     //
     // Success.
     //
+    psMSCInstance->ui32Sense = 0;
+
     return(0);
 }
 
@@ -557,7 +727,8 @@ USBHMSCDriveOpen(uint32_t ui32Drive, tUSBHMSCCallback pfnCallback)
 //! \param psMSCInstance is the device instance that is to be released.
 //!
 //! This function is called when an MSC drive is to be released in preparation
-//! for shutdown or a switch to USB device mode, for example.  Following this
+//! for shutdown or a switch to USB device mode, for example.  Any blocks held
+//! in the write-behind cache are written to the drive first.  Following this
 //! call, the drive is available for other clients who may open it again using
 //! a call to USBHMSCDriveOpen().
 //!
@@ -567,6 +738,14 @@ USBHMSCDriveOpen(uint32_t ui32Drive, tUSBHMSCCallback pfnCallback)
 void
 USBHMSCDriveClose(tUSBHMSCInstance *psMSCInstance)
 {
+    //
+    // Write out any blocks still held in the cache.
+    //
+    if(psMSCInstance->psDevice)
+    {
+        USBHMSCFlush(psMSCInstance);
+    }
+
     //
     // Close the drive (if it is already open)
     //
@@ -594,15 +773,23 @@ USBHMSCDriveClose(tUSBHMSCInstance *psMSCInstance)
 //! of 512 bytes of data.  The \e *pui8Data buffer should be at least
 //! \e ui32NumBlocks * 512 bytes in size.
 //!
+//! If a cache has been provided using USBHMSCCacheConfig(), blocks already in
+//! the cache are returned without accessing the device.  When a read follows
+//! on directly from the previous read, the device is asked for a full cache
+//! of blocks in a single command so that the following sequential reads are
+//! satisfied from the cache.
+//!
 //! \return The function returns zero for success and any negative value
-//! indicates a failure.
+//! indicates a failure.  The reason for a failure can be found by calling
+//! USBHMSCSenseGet().
 //
 //*****************************************************************************
 int32_t
 USBHMSCBlockRead(tUSBHMSCInstance *psMSCInstance, uint32_t ui32LBA,
                  uint8_t *pui8Data, uint32_t ui32NumBlocks)
 {
-    uint32_t ui32Size;
+    uint32_t ui32CacheBlocks, ui32Count;
+    bool bSequential;
 
     //
     // If there is no device present then return an error.
@@ -612,25 +799,85 @@ USBHMSCBlockRead(tUSBHMSCInstance *psMSCInstance, uint32_t ui32LBA,
         return(-1);
     }
 
+    ui32CacheBlocks = USBHMSCCacheBlocks(psMSCInstance);
+    bSequential = (ui32LBA == psMSCInstance->ui32NextLBA) ? true : false;
+    psMSCInstance->ui32NextLBA = ui32LBA + ui32NumBlocks;
+
     //
-    // Calculate the actual byte size of the read.
+    // Return the blocks straight from the cache if they are all there.
     //
-    ui32Size = psMSCInstance->ui32BlockSize * ui32NumBlocks;
+    if(USBHMSCCacheOverlap(psMSCInstance, ui32LBA, ui32NumBlocks) &&
+       (ui32LBA >= psMSCInstance->ui32CacheLBA) &&
+       ((ui32LBA + ui32NumBlocks) <= (psMSCInstance->ui32CacheLBA +
+                                      psMSCInstance->ui32CacheCount)))
+    {
+        USBHMSCCacheCopy(pui8Data, psMSCInstance->pui8Cache +
+                         ((ui32LBA - psMSCInstance->ui32CacheLBA) *
+                          psMSCInstance->ui32BlockSize),
+                         ui32NumBlocks * psMSCInstance->ui32BlockSize);
+
+        return(0);
+    }
 
     //
-    // Perform the SCSI read command.
+    // Blocks waiting to be written must reach the device before any of them
+    // are read back from it.
     //
-    if(USBHSCSIRead10(psMSCInstance->ui32BulkInPipe,
-                      psMSCInstance->ui32BulkOutPipe, ui32LBA, pui8Data,
-                      &ui32Size, ui32NumBlocks) != SCSI_CMD_STATUS_PASS)
+    if(psMSCInstance->bCacheDirty &&
+       USBHMSCCacheOverlap(psMSCInstance, ui32LBA, ui32NumBlocks))
     {
-        return(-1);
+        if(USBHMSCFlush(psMSCInstance) != 0)
+        {
+            return(-1);
+        }
     }
 
     //
-    // Success.
+    // Read ahead into the cache if this read continues a sequential run, the
+    // request is smaller than the cache and the cache does not hold blocks
+    // that are still to be written.  The instance's ui32NumBlocks is the
+    // address of the last block, as returned by READ CAPACITY, so a read
+    // that starts beyond it goes straight to the device and fails there.
     //
-    return(0);
+    if(bSequential && (ui32NumBlocks < ui32CacheBlocks) &&
+       !psMSCInstance->bCacheDirty &&
+       (ui32LBA <= psMSCInstance->ui32NumBlocks))
+    {
+        //
+        // Do not read past the last block on the device.
+        //
+        ui32Count = ui32CacheBlocks;
+
+        if((ui32LBA + ui32Count) > (psMSCInstance->ui32NumBlocks + 1))
+        {
+            ui32Count = psMSCInstance->ui32NumBlocks + 1 - ui32LBA;
+        }
+
+        if(ui32Count >= ui32NumBlocks)
+        {
+            psMSCInstance->ui32CacheCount = 0;
+
+            if(USBHMSCTransfer(psMSCInstance, false, ui32LBA,
+                               psMSCInstance->pui8Cache, ui32Count) != 0)
+            {
+                return(-1);
+            }
+
+            psMSCInstance->ui32CacheLBA = ui32LBA;
+            psMSCInstance->ui32CacheCount = ui32Count;
+
+            USBHMSCCacheCopy(pui8Data, psMSCInstance->pui8Cache,
+                             ui32NumBlocks * psMSCInstance->ui32BlockSize);
+
+            return(0);
+        }
+    }
+
+    //
+    // Otherwise read the blocks directly into the caller's buffer.
+    //
+    return(USBHMSCTransfer(psMSCInstance, false, ui32LBA, pui8Data,
+                           ui32NumBlocks));
 }
 
 //*****************************************************************************
@@ -650,15 +897,23 @@ USBHMSCBlockRead(tUSBHMSCInstance *psMSCInstance, uint32_t ui32LBA,
 //! \e ui32NumBlocks * 512 bytes in size to prevent unwanted data being written
 //! to the device.
 //!
+//! If a cache has been provided using USBHMSCCacheConfig(), writes smaller
+//! than the cache are held in the cache and consecutive writes are combined
+//! so that they reach the device in a single command when the cache fills,
+//! when a write to a different part of the device is made or when
+//! USBHMSCFlush() is called.  Callers using a cache must call USBHMSCFlush()
+//! before the device may be removed.
+//!
 //! \return The function returns zero for success and any negative value
-//! indicates a failure.
+//! indicates a failure.  The reason for a failure can be found by calling
+//! USBHMSCSenseGet().
 //
 //*****************************************************************************
 int32_t
 USBHMSCBlockWrite(tUSBHMSCInstance *psMSCInstance, uint32_t ui32LBA,
                   uint8_t *pui8Data, uint32_t ui32NumBlocks)
 {
-    uint32_t ui32Size;
+    uint32_t ui32CacheBlocks, ui32End;
 
     //
     // If there is no device present then return an error.
@@ -668,27 +923,195 @@ USBHMSCBlockWrite(tUSBHMSCInstance *psMSCInstance, uint32_t ui32LBA,
         return(-1);
     }
 
+    ui32CacheBlocks = USBHMSCCacheBlocks(psMSCInstance);
+    ui32End = psMSCInstance->ui32CacheLBA + psMSCInstance->ui32CacheCount;
+
     //
-    // Calculate the actual byte size of the write.
+    // Writes that do not fit in the cache go straight to the device once any
+    // cached copy of the same blocks has been dealt with.
     //
-    ui32Size = psMSCInstance->ui32BlockSize * ui32NumBlocks;
+    if(ui32NumBlocks >= ui32CacheBlocks)
+    {
+        if(USBHMSCCacheOverlap(psMSCInstance, ui32LBA, ui32NumBlocks))
+        {
+            if(psMSCInstance->bCacheDirty &&
+               (USBHMSCFlush(psMSCInstance) != 0))
+            {
+                return(-1);
+            }
+
+            psMSCInstance->ui32CacheCount = 0;
+        }
+
+        return(USBHMSCTransfer(psMSCInstance, true, ui32LBA, pui8Data,
+                               ui32NumBlocks));
+    }
+
+    if(psMSCInstance->bCacheDirty &&
+       (ui32LBA >= psMSCInstance->ui32CacheLBA) && (ui32LBA <= ui32End) &&
+       ((ui32LBA + ui32NumBlocks) <=
+        (psMSCInstance->ui32CacheLBA + ui32CacheBlocks)))
+    {
+        //
+        // The write overlaps or follows on from the blocks waiting in the
+        // cache, so merge it in.
+        //
+        if((ui32LBA + ui32NumBlocks) > ui32End)
+        {
+            psMSCInstance->ui32CacheCount = ui32LBA + ui32NumBlocks -
+                                            psMSCInstance->ui32CacheLBA;
+        }
+    }
+    else
+    {
+        //
+        // Write out the blocks waiting in the cache and start a new run with
+        // this write.
+        //
+        if(USBHMSCFlush(psMSCInstance) != 0)
+        {
+            return(-1);
+        }
+
+        psMSCInstance->ui32CacheLBA = ui32LBA;
+        psMSCInstance->ui32CacheCount = ui32NumBlocks;
+        psMSCInstance->bCacheDirty = true;
+    }
+
+    USBHMSCCacheCopy(psMSCInstance->pui8Cache +
+                     ((ui32LBA - psMSCInstance->ui32CacheLBA) *
+                      psMSCInstance->ui32BlockSize), pui8Data,
+                     ui32NumBlocks * psMSCInstance->ui32BlockSize);
 
     //
-    // Perform the SCSI write command.
+    // Write the run out as soon as the cache is full.
     //
-    if(USBHSCSIWrite10(psMSCInstance->ui32BulkInPipe,
-                       psMSCInstance->ui32BulkOutPipe, ui32LBA, pui8Data,
-                       &ui32Size, ui32NumBlocks) != SCSI_CMD_STATUS_PASS)
+    if(psMSCInstance->ui32CacheCount == ui32CacheBlocks)
+    {
+        return(USBHMSCFlush(psMSCInstance));
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! This function provides a block cache to an MSC device instance.
+//!
+//! \param psMSCInstance is the device instance to use the cache.
+//! \param pui8Cache is a pointer to the buffer used to hold cached blocks or
+//! zero to stop using a cache.
+//! \param ui32Size is the size of the buffer pointed to by \e pui8Cache in
+//! bytes.
+//!
+//! This function gives the mass storage class driver a buffer that is used to
+//! read ahead when blocks are read sequentially and to hold back and combine
+//! consecutive block writes.  Each SCSI command carries a fixed cost in
+//! command and status transfers, so reading and writing several blocks per
+//! command greatly improves the throughput of small sequential accesses such
+//! as those made by a file system.  The buffer should hold several blocks and
+//! be word aligned so that it can be used with uDMA.  The cache is used once
+//! the block size of the device is known, which is after USBHMSCDriveReady()
+//! has returned zero.
+//!
+//! Any blocks waiting in a previous cache are written to the device before
+//! the new cache is used.
+//!
+//! \return The function returns zero for success and any negative value
+//! indicates that blocks in the previous cache could not be written.
+//
+//*****************************************************************************
+int32_t
+USBHMSCCacheConfig(tUSBHMSCInstance *psMSCInstance, uint8_t *pui8Cache,
+                   uint32_t ui32Size)
+{
+    //
+    // Write out anything held in the current cache.
+    //
+    if(psMSCInstance->bCacheDirty && (USBHMSCFlush(psMSCInstance) != 0))
     {
         return(-1);
     }
 
+    psMSCInstance->pui8Cache = pui8Cache;
+    psMSCInstance->ui32CacheSize = pui8Cache ? ui32Size : 0;
+    psMSCInstance->ui32CacheCount = 0;
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! This function writes any cached blocks to an MSC device.
+//!
+//! \param psMSCInstance is the device instance to flush.
+//!
+//! This function writes any blocks that are being held in the cache provided
+//! by USBHMSCCacheConfig() to the device.  It must be called when a file
+//! system is synchronized and before the device is removed to ensure that
+//! all data written with USBHMSCBlockWrite() has reached the device.
+//!
+//! \return The function returns zero for success and any negative value
+//! indicates a failure.  The reason for a failure can be found by calling
+//! USBHMSCSenseGet().
+//
+//*****************************************************************************
+int32_t
+USBHMSCFlush(tUSBHMSCInstance *psMSCInstance)
+{
+    if(!psMSCInstance->bCacheDirty || (psMSCInstance->ui32CacheCount == 0))
+    {
+        psMSCInstance->bCacheDirty = false;
+        return(0);
+    }
+
     //
-    // Success.
+    // If there is no device present then return an error.
+    //
+    if(psMSCInstance->psDevice == 0)
+    {
+        return(-1);
+    }
+
+    //
+    // Write the run of blocks with a single command.  The blocks are kept in
+    // the cache as they still match the device.
     //
+    if(USBHMSCTransfer(psMSCInstance, true, psMSCInstance->ui32CacheLBA,
+                       psMSCInstance->pui8Cache,
+                       psMSCInstance->ui32CacheCount) != 0)
+    {
+        return(-1);
+    }
+
+    psMSCInstance->bCacheDirty = false;
+
     return(0);
 }
 
+//*****************************************************************************
+//
+//! This function returns the sense data for the last failed command.
+//!
+//! \param psMSCInstance is the device instance to query.
+//!
+//! When a SCSI command sent to the device fails, the mass storage class
+//! driver issues a SCSI Request Sense command to find out why.  This
+//! function returns the sense key, additional sense code and additional sense
+//! code qualifier that the device reported, which can be extracted using the
+//! USBHMSC_SENSE_KEY(), USBHMSC_SENSE_ASC() and USBHMSC_SENSE_ASCQ() macros.
+//! The value is cleared when a command completes successfully.
+//!
+//! \return Returns the packed sense data or zero if the last command did not
+//! fail.
+//
+//*****************************************************************************
+uint32_t
+USBHMSCSenseGet(tUSBHMSCInstance *psMSCInstance)
+{
+    return(psMSCInstance->ui32Sense);
+}
+
 //*****************************************************************************
 //
 //! This function forwards an LPM request for a device to enter L1 sleep state.
@@ -54,6 +54,19 @@ typedef struct tUSBHMSCInstance tUSBHMSCInstance;
 #define MSC_EVENT_OPEN          1
 #define MSC_EVENT_CLOSE         2
 
+//*****************************************************************************
+//
+// These macros extract the sense key, additional sense code and additional
+// sense code qualifier from the value returned by USBHMSCSenseGet().
+//
+//*****************************************************************************
+#define USBHMSC_SENSE_KEY(ui32Sense)                                          \
+                                (((ui32Sense) >> 16) & 0xff)
+#define USBHMSC_SENSE_ASC(ui32Sense)                                          \
+                                (((ui32Sense) >> 8) & 0xff)
+#define USBHMSC_SENSE_ASCQ(ui32Sense)                                         \
+                                ((ui32Sense) & 0xff)
+
 //*****************************************************************************
 //
 // The prototype for the USB MSC host driver callback function.
@@ -78,6 +91,10 @@ extern int32_t USBHMSCBlockRead(tUSBHMSCInstance *psMSCInstance,
 extern int32_t USBHMSCBlockWrite(tUSBHMSCInstance *psMSCInstance,
                                  uint32_t ui32LBA, uint8_t *pui8Data,
                                  uint32_t ui32NumBlocks);
+extern int32_t USBHMSCCacheConfig(tUSBHMSCInstance *psMSCInstance,
+                                  uint8_t *pui8Cache, uint32_t ui32Size);
+extern int32_t USBHMSCFlush(tUSBHMSCInstance *psMSCInstance);
+extern uint32_t USBHMSCSenseGet(tUSBHMSCInstance *psMSCInstance);
 extern uint32_t USBHMSCLPMSleep(tUSBHMSCInstance *psMSCInstance);
 extern uint32_t USBHMSCLPMStatus(tUSBHMSCInstance *psMSCInstance);
 
@@ -85,6 +85,20 @@ extern "C"
 #define USBHCD_LPM_ERROR        0x00000001
 #define USBHCD_LPM_PENDING      0x00000002
 
+//*****************************************************************************
+//
+// The number of bytes per frame that may be reserved by periodic (interrupt
+// and isochronous) pipes on full/low speed and high speed devices.  The
+// defaults are the 90% and 80% limits set by the USB 2.0 specification.
+//
+//*****************************************************************************
+#ifndef USBHCD_PERIODIC_BW_FS
+#define USBHCD_PERIODIC_BW_FS   1350
+#endif
+#ifndef USBHCD_PERIODIC_BW_HS
+#define USBHCD_PERIODIC_BW_HS   48000
+#endif
+
 //*****************************************************************************
 //
 //! This macro is used to declare an instance of an Event driver for the USB
@@ -181,6 +195,48 @@ typedef struct
 }
 tUSBHostClassDriver;
 
+//*****************************************************************************
+//
+//! This structure holds the transfer statistics kept for each USB pipe and is
+//! returned by USBHCDPipeStatsGet().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of data bytes transferred on the pipe.
+    //
+    uint32_t ui32Bytes;
+
+    //
+    //! The number of packets successfully transferred on the pipe.
+    //
+    uint32_t ui32Packets;
+
+    //
+    //! The number of times the device stalled the pipe.
+    //
+    uint32_t ui32Stalls;
+
+    //
+    //! The number of transfers on the pipe that failed with an error.
+    //
+    uint32_t ui32Errors;
+
+    //
+    //! The number of \b USB_EVENT_SCHEDULER events sent to the pipe.
+    //
+    uint32_t ui32Events;
+
+    //
+    //! The number of frames over which the statistics were gathered.  The
+    //! throughput of the pipe in bytes per millisecond is \e ui32Bytes
+    //! divided by this value.
+    //
+    uint32_t ui32Frames;
+}
+tUSBHCDPipeStats;
+
 //*****************************************************************************
 //
 // Close the Doxygen group.
@@ -250,6 +306,8 @@ extern uint32_t USBHCDPipeTransferSizeGet(uint32_t ui32Pipe);
 extern void USBHCDPipeDataAck(uint32_t ui32Pipe);
 extern uint32_t USBHCDPipeReadNonBlocking(uint32_t ui32Pipe, uint8_t *pui8Data,
                                           uint32_t ui32Size);
+extern void USBHCDPipeStatsGet(uint32_t ui32Pipe, tUSBHCDPipeStats *psStats);
+extern void USBHCDPipeStatsClear(uint32_t ui32Pipe);
 extern uint32_t USBHCDStringDescriptorGet(tUSBHostDevice *psDevice,
                                           uint8_t *pui8Buffer,
                                           uint32_t ui32Size,
@@ -353,6 +353,25 @@ typedef struct
     // The bit offset in the allocation structure.
     //
     uint8_t ui8FIFOBitOffset;
+
+    //
+    // The number of bytes per frame reserved for this pipe if it is an
+    // interrupt or isochronous pipe.
+    //
+    uint32_t ui32Bandwidth;
+
+    //
+    // The maximum packet size for the pipe.  This is 64 bytes for full speed
+    // bulk endpoints and up to 512 bytes for high speed bulk endpoints.
+    //
+    uint32_t ui32MaxPacketSize;
+
+    //
+    // The transfer statistics for this pipe and the tick at which they were
+    // last cleared.
+    //
+    tUSBHCDPipeStats sStats;
+    uint32_t ui32StatsTick;
 }
 tUSBHCDPipe;
 
@@ -440,6 +459,14 @@ static void ProcessUSBDeviceStateMachine(tUSBHDeviceState iOldState,
 //*****************************************************************************
 #define EP_OFFSET(Endpoint)     (Endpoint - 0x10)
 
+//*****************************************************************************
+//
+// The protocol overhead in bytes of a single periodic transaction, which is
+// added to the maximum payload of a pipe when reserving bus bandwidth.
+//
+//*****************************************************************************
+#define PERIODIC_OVERHEAD       13
+
 //*****************************************************************************
 //
 // This structure holds the state information for a given host controller.
@@ -526,6 +553,17 @@ typedef struct
     // The host initiated resume duration in us.
     //
     uint32_t ui32LPMHIRD;
+
+    //
+    // The bytes per frame reserved by periodic pipes on full/low speed
+    // devices and on high speed devices.
+    //
+    uint32_t pui32PeriodicBW[2];
+
+    //
+    // The IN pipe at which the next scan for scheduler events starts.
+    //
+    uint32_t ui32SchedulePipe;
 }
 tUSBHCD;
 
@@ -536,6 +574,110 @@ tUSBHCD;
 //*****************************************************************************
 static tUSBHCD g_sUSBHCD;
 
+//*****************************************************************************
+//
+// Returns the index of the periodic bandwidth pool used by a pipe, which
+// depends on the speed of the device that the pipe is talking to.
+//
+//*****************************************************************************
+static uint32_t
+PipeBandwidthPool(tUSBHCDPipe *psPipe)
+{
+    if(psPipe->psDevice && (psPipe->psDevice->ui32Speed == USB_EP_SPEED_HIGH))
+    {
+        return(1);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Returns the average number of bytes per frame that a pipe needs on the bus.
+// Only interrupt and isochronous pipes have bandwidth reserved for them.
+//
+//*****************************************************************************
+static uint32_t
+PipeBandwidth(uint32_t ui32Type, bool bHighSpeed, uint32_t ui32MaxPayload,
+              uint32_t ui32Interval)
+{
+    uint32_t ui32Period, ui32Bytes;
+
+    if(!(ui32Type & (EP_PIPE_TYPE_ISOC | EP_PIPE_TYPE_INTR)))
+    {
+        return(0);
+    }
+
+    if(bHighSpeed || (ui32Type & EP_PIPE_TYPE_ISOC))
+    {
+        //
+        // High speed pipes, and full speed isochronous pipes, poll every
+        // 2^(ui32Interval - 1) periods.
+        //
+        if(ui32Interval > 16)
+        {
+            ui32Interval = 16;
+        }
+
+        ui32Period = ui32Interval ? (1 << (ui32Interval - 1)) : 1;
+    }
+    else
+    {
+        //
+        // Full and low speed interrupt pipes poll every ui32Interval frames.
+        //
+        ui32Period = ui32Interval ? ui32Interval : 1;
+    }
+
+    ui32Bytes = ui32MaxPayload + PERIODIC_OVERHEAD;
+
+    //
+    // A high speed period is a 125us microframe, so a pipe which polls more
+    // often than once a millisecond uses the bus several times in each frame.
+    //
+    if(bHighSpeed)
+    {
+        if(ui32Period < 8)
+        {
+            return(ui32Bytes * (8 / ui32Period));
+        }
+
+        ui32Period /= 8;
+    }
+
+    return((ui32Bytes + ui32Period - 1) / ui32Period);
+}
+
+//*****************************************************************************
+//
+// Returns the bandwidth reserved by a pipe to its pool.
+//
+//*****************************************************************************
+static void
+PipeBandwidthRelease(tUSBHCDPipe *psPipe)
+{
+    g_sUSBHCD.pui32PeriodicBW[PipeBandwidthPool(psPipe)] -=
+                                                        psPipe->ui32Bandwidth;
+    psPipe->ui32Bandwidth = 0;
+}
+
+//*****************************************************************************
+//
+// Clears the transfer statistics for a pipe.
+//
+//*****************************************************************************
+static void
+PipeStatsClear(tUSBHCDPipe *psPipe)
+{
+    psPipe->sStats.ui32Bytes = 0;
+    psPipe->sStats.ui32Packets = 0;
+    psPipe->sStats.ui32Stalls = 0;
+    psPipe->sStats.ui32Errors = 0;
+    psPipe->sStats.ui32Events = 0;
+    psPipe->sStats.ui32Frames = 0;
+    psPipe->ui32StatsTick = g_ui32CurrentTick;
+}
+
 //*****************************************************************************
 //
 // Allocates the memory needed to support configuration descriptors for
@@ -1085,6 +1227,86 @@ USBHCDPipeTransferSizeGet(uint32_t ui32Pipe)
     return(g_sUSBHCD.psUSBINPipes[ui32Index].ui32DataRead);
 }
 
+//*****************************************************************************
+//
+//! This function returns the transfer statistics for a USB HCD pipe.
+//!
+//! \param ui32Pipe is the allocated pipe to query.
+//! \param psStats points to the structure that is written with the
+//! statistics.
+//!
+//! This call returns the number of bytes and packets transferred along with
+//! the stall, error and scheduler event counts for the pipe specified by the
+//! \e ui32Pipe parameter since it was allocated or since the last call to
+//! USBHCDPipeStatsClear().  The \e ui32Frames member gives the number of
+//! frames over which the counts were gathered so that the caller can
+//! calculate the throughput of the pipe.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBHCDPipeStatsGet(uint32_t ui32Pipe, tUSBHCDPipeStats *psStats)
+{
+    tUSBHCDPipe *psPipe;
+
+    ASSERT(psStats);
+
+    if(ui32Pipe & EP_PIPE_TYPE_OUT)
+    {
+        psPipe = &g_sUSBHCD.psUSBOUTPipes[ui32Pipe & EP_PIPE_IDX_M];
+    }
+    else
+    {
+        psPipe = &g_sUSBHCD.psUSBINPipes[ui32Pipe & EP_PIPE_IDX_M];
+    }
+
+    //
+    // Take a consistent copy of the counters which are updated by the
+    // interrupt handler.
+    //
+    OS_INT_DISABLE(g_sUSBHCD.ui32IntNum);
+
+    psStats->ui32Bytes = psPipe->sStats.ui32Bytes;
+    psStats->ui32Packets = psPipe->sStats.ui32Packets;
+    psStats->ui32Stalls = psPipe->sStats.ui32Stalls;
+    psStats->ui32Errors = psPipe->sStats.ui32Errors;
+    psStats->ui32Events = psPipe->sStats.ui32Events;
+    psStats->ui32Frames = g_ui32CurrentTick - psPipe->ui32StatsTick;
+
+    OS_INT_ENABLE(g_sUSBHCD.ui32IntNum);
+}
+
+//*****************************************************************************
+//
+//! This function clears the transfer statistics for a USB HCD pipe.
+//!
+//! \param ui32Pipe is the allocated pipe whose statistics are cleared.
+//!
+//! This call resets the counters returned by USBHCDPipeStatsGet() for the
+//! pipe specified by the \e ui32Pipe parameter and restarts the frame count
+//! used to measure throughput.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USBHCDPipeStatsClear(uint32_t ui32Pipe)
+{
+    OS_INT_DISABLE(g_sUSBHCD.ui32IntNum);
+
+    if(ui32Pipe & EP_PIPE_TYPE_OUT)
+    {
+        PipeStatsClear(&g_sUSBHCD.psUSBOUTPipes[ui32Pipe & EP_PIPE_IDX_M]);
+    }
+    else
+    {
+        PipeStatsClear(&g_sUSBHCD.psUSBINPipes[ui32Pipe & EP_PIPE_IDX_M]);
+    }
+
+    OS_INT_ENABLE(g_sUSBHCD.ui32IntNum);
+}
+
 //*****************************************************************************
 //
 //! This function is used to allocate a USB HCD pipe.
@@ -1191,6 +1413,13 @@ USBHCDPipeAllocSize(uint32_t ui32Index, uint32_t ui32EndpointType,
                 //
                 g_sUSBHCD.psUSBOUTPipes[i32Idx].iState = ePipeIdle;
 
+                //
+                // No bandwidth is reserved until the pipe is configured.
+                //
+                g_sUSBHCD.psUSBOUTPipes[i32Idx].ui32Bandwidth = 0;
+                g_sUSBHCD.psUSBOUTPipes[i32Idx].ui32MaxPacketSize = ui32Size;
+                PipeStatsClear(&g_sUSBHCD.psUSBOUTPipes[i32Idx]);
+
                 //
                 // Allocate space in the FIFO for this endpoint.
                 //
@@ -1313,6 +1542,13 @@ USBHCDPipeAllocSize(uint32_t ui32Index, uint32_t ui32EndpointType,
                 //
                 g_sUSBHCD.psUSBINPipes[i32Idx].iState = ePipeIdle;
 
+                //
+                // No bandwidth is reserved until the pipe is configured.
+                //
+                g_sUSBHCD.psUSBINPipes[i32Idx].ui32Bandwidth = 0;
+                g_sUSBHCD.psUSBINPipes[i32Idx].ui32MaxPacketSize = ui32Size;
+                PipeStatsClear(&g_sUSBHCD.psUSBINPipes[i32Idx]);
+
                 break;
             }
         }
@@ -1386,6 +1622,16 @@ USBHCDPipeAlloc(uint32_t ui32Index, uint32_t ui32EndpointType,
 //! value from 1-255 and is the count in frames between polling the endpoint.
 //! For isochronous endpoints \e ui32Interval ranges from 1-16 and is the
 //! polling interval in frames represented as 2^(\e ui32Interval-1) frames.
+//! For interrupt and isochronous endpoints on high speed devices, \e
+//! ui32Interval is the \e bInterval value from the endpoint descriptor, which
+//! gives the polling interval as 2^(\e ui32Interval-1) microframes of 125us.
+//!
+//! Bus bandwidth is reserved for interrupt and isochronous pipes based on the
+//! \e ui32MaxPayload and \e ui32Interval parameters.  If the periodic pipes
+//! already configured leave too little bandwidth for the pipe, as set by
+//! \b USBHCD_PERIODIC_BW_FS or \b USBHCD_PERIODIC_BW_HS, the pipe is not
+//! configured and an error is returned.  This keeps the remaining bandwidth
+//! of each frame available for bulk and control transfers.
 //!
 //! \param ui32Pipe is the allocated endpoint to modify.
 //! \param ui32MaxPayload is maximum data that can be handled per transaction.
@@ -1403,13 +1649,52 @@ USBHCDPipeConfig(uint32_t ui32Pipe, uint32_t ui32MaxPayload,
                  uint32_t ui32Interval, uint32_t ui32TargetEndpoint)
 {
     uint32_t ui32Flags;
-    uint32_t ui32Index;
+    uint32_t ui32Index, ui32Pool, ui32Bandwidth, ui32Limit;
+    tUSBHCDPipe *psPipe;
 
     //
     // Get the index number from the allocated pipe.
     //
     ui32Index = (ui32Pipe & EP_PIPE_IDX_M);
 
+    if(ui32Pipe & EP_PIPE_TYPE_OUT)
+    {
+        psPipe = &g_sUSBHCD.psUSBOUTPipes[ui32Index];
+    }
+    else
+    {
+        psPipe = &g_sUSBHCD.psUSBINPipes[ui32Index];
+    }
+
+    //
+    // Reserve bandwidth for a periodic pipe, replacing any reservation made
+    // by an earlier configuration of the pipe.
+    //
+    ui32Pool = PipeBandwidthPool(psPipe);
+    ui32Limit = ui32Pool ? USBHCD_PERIODIC_BW_HS : USBHCD_PERIODIC_BW_FS;
+    ui32Bandwidth = PipeBandwidth(psPipe->ui32Type, ui32Pool ? true : false,
+                                  ui32MaxPayload, ui32Interval);
+
+    if((g_sUSBHCD.pui32PeriodicBW[ui32Pool] - psPipe->ui32Bandwidth +
+        ui32Bandwidth) > ui32Limit)
+    {
+        DEBUG_OUTPUT("Pipe %08x - no periodic bandwidth.\n", ui32Pipe);
+
+        return(1);
+    }
+
+    g_sUSBHCD.pui32PeriodicBW[ui32Pool] += ui32Bandwidth;
+    g_sUSBHCD.pui32PeriodicBW[ui32Pool] -= psPipe->ui32Bandwidth;
+    psPipe->ui32Bandwidth = ui32Bandwidth;
+
+    //
+    // Transfers on this pipe are split into packets of this size.
+    //
+    if(ui32MaxPayload)
+    {
+        psPipe->ui32MaxPacketSize = ui32MaxPayload;
+    }
+
     //
     // Set the direction.
     //
@@ -1564,6 +1849,7 @@ uint32_t
 USBHCDPipeWrite(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
 {
     uint32_t ui32Endpoint, ui32RemainingBytes, ui32ByteToSend, ui32PipeIdx;
+    uint32_t ui32MaxPacket;
     bool bUseDMA;
 
     //
@@ -1576,6 +1862,11 @@ USBHCDPipeWrite(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
     //
     ui32PipeIdx = ui32Pipe & EP_PIPE_IDX_M;
 
+    //
+    // Get the packet size for the pipe.
+    //
+    ui32MaxPacket = g_sUSBHCD.psUSBOUTPipes[ui32PipeIdx].ui32MaxPacketSize;
+
     //
     // Set the total number of bytes to send out.
     //
@@ -1614,12 +1905,12 @@ USBHCDPipeWrite(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
                             g_sUSBHCD.psUSBOUTPipes[ui32PipeIdx].ui8DMAChannel,
                             pui8Data, ui32RemainingBytes) != 0)
             {
-                if(ui32RemainingBytes < 64)
+                if(ui32RemainingBytes < ui32MaxPacket)
                 {
                     g_sUSBHCD.psUSBOUTPipes[ui32PipeIdx].iState =
                                                             ePipeWriteDMASend;
                 }
-                else if((ui32RemainingBytes % 64) == 0)
+                else if((ui32RemainingBytes % ui32MaxPacket) == 0)
                 {
                     g_sUSBHCD.psUSBOUTPipes[ui32PipeIdx].iState =
                                                                 ePipeWriteDMA;
@@ -1642,11 +1933,11 @@ USBHCDPipeWrite(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
         if(bUseDMA == false)
         {
             //
-            // Only send 64 bytes at a time if not using DMA.
+            // Only send one packet at a time if not using DMA.
             //
-            if(ui32ByteToSend > 64)
+            if(ui32ByteToSend > ui32MaxPacket)
             {
-                ui32ByteToSend = 64;
+                ui32ByteToSend = ui32MaxPacket;
             }
             else
             {
@@ -1717,10 +2008,10 @@ USBHCDPipeWrite(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
                 pui8Data += ui32ByteToSend;
 
                 //
-                // If there are less than 64 bytes to send then this is the
+                // If there is less than a packet to send then this is the
                 // last of the data to go out.
                 //
-                if(ui32RemainingBytes < 64)
+                if(ui32RemainingBytes < ui32MaxPacket)
                 {
                     ui32ByteToSend = ui32RemainingBytes;
                 }
@@ -1788,6 +2079,8 @@ USBHCDPipeWrite(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
     //
     g_sUSBHCD.psUSBOUTPipes[ui32PipeIdx].iState = ePipeIdle;
 
+    g_sUSBHCD.psUSBOUTPipes[ui32PipeIdx].sStats.ui32Bytes += ui32Size;
+
     return(ui32Size);
 }
 
@@ -1861,6 +2154,8 @@ USBHCDPipeSchedule(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
             //
             MAP_USBEndpointDataSend(USB0_BASE, ui32Endpoint, USB_TRANS_OUT);
         }
+
+        g_sUSBHCD.psUSBOUTPipes[ui32PipeIdx].sStats.ui32Bytes += ui32Size;
     }
     else
     {
@@ -1955,6 +2250,16 @@ USBHCDPipeReadNonBlocking(uint32_t ui32Pipe, uint8_t *pui8Data,
     //
     MAP_USBHostEndpointDataAck(USB0_BASE, ui32Endpoint);
 
+    //
+    // Data read into a buffer by the interrupt handler has already been
+    // counted.
+    //
+    if(g_sUSBHCD.psUSBINPipes[EP_PIPE_IDX_M & ui32Pipe].pui8ReadPtr == 0)
+    {
+        g_sUSBHCD.psUSBINPipes[EP_PIPE_IDX_M & ui32Pipe].sStats.ui32Bytes +=
+                                                                    ui32Size;
+    }
+
     //
     // Go Idle once this state has been reached.
     //
@@ -2029,6 +2334,7 @@ uint32_t
 USBHCDPipeRead(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
 {
     uint32_t ui32Endpoint, ui32RemainingBytes, ui32BytesRead, ui32PipeIdx;
+    uint32_t ui32MaxPacket;
     bool bUseDMA;
 
     //
@@ -2036,6 +2342,11 @@ USBHCDPipeRead(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
     //
     ui32PipeIdx = ui32Pipe & EP_PIPE_IDX_M;
 
+    //
+    // Get the packet size for the pipe.
+    //
+    ui32MaxPacket = g_sUSBHCD.psUSBINPipes[ui32PipeIdx].ui32MaxPacketSize;
+
     //
     // Initialized the number of bytes read.
     //
@@ -2111,7 +2422,8 @@ USBHCDPipeRead(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
             //
             g_sUSBHCD.psUSBINPipes[ui32PipeIdx].pui8ReadPtr = pui8Data;
             g_sUSBHCD.psUSBINPipes[ui32PipeIdx].ui32ReadSize =
-                        (ui32RemainingBytes < 64) ? ui32RemainingBytes : 64;
+                        (ui32RemainingBytes < ui32MaxPacket) ?
+                        ui32RemainingBytes : ui32MaxPacket;
         }
 
         //
@@ -2198,8 +2510,8 @@ USBHCDPipeRead(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
                     //
                     // Compute bytes to transfer and set up transfer
                     //
-                    ui32BytesRead =
-                            ui32RemainingBytes > 64 ? 64 : ui32RemainingBytes;
+                    ui32BytesRead = (ui32RemainingBytes > ui32MaxPacket) ?
+                                    ui32MaxPacket : ui32RemainingBytes;
 
                     //
                     // Acknowledge that the data was read from the endpoint.
@@ -2213,10 +2525,10 @@ USBHCDPipeRead(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
                 ui32RemainingBytes -= ui32BytesRead;
 
                 //
-                // If there were less than 64 bytes read, then this was a short
+                // If there was less than a packet read, then this was a short
                 // packet and no more data will be returned.
                 //
-                if(ui32BytesRead < 64)
+                if(ui32BytesRead < ui32MaxPacket)
                 {
                     //
                     // Subtract off the bytes that were not received and exit
@@ -2231,7 +2543,7 @@ USBHCDPipeRead(uint32_t ui32Pipe, uint8_t *pui8Data, uint32_t ui32Size)
                     // Move the buffer ahead to receive more data into the
                     // buffer.
                     //
-                    pui8Data += 64;
+                    pui8Data += ui32MaxPacket;
                 }
                 break;
             }
@@ -2291,11 +2603,16 @@ USBHCDPipeFree(uint32_t ui32Pipe)
 
     if(ui32Pipe & EP_PIPE_TYPE_OUT)
     {
+        //
+        // Release any bandwidth reserved by this pipe.
+        //
+        PipeBandwidthRelease(&g_sUSBHCD.psUSBOUTPipes[ui32Index]);
+
         //
         // Clear the address and type for this endpoint to free it up.
         //
         g_sUSBHCD.psUSBOUTPipes[ui32Index].psDevice = 0;
-        g_sUSBHCD.psUSBOUTPipes[ui32Index].ui32Type = 0;
+        g_sUSBHCD.psUSBOUTPipes[ui32Index].ui32Type = USBHCD_PIPE_UNUSED;
         g_sUSBHCD.psUSBOUTPipes[ui32Index].pfnCallback = 0;
 
         //
@@ -2340,11 +2657,16 @@ USBHCDPipeFree(uint32_t ui32Pipe)
     }
     else if(ui32Pipe & EP_PIPE_TYPE_IN)
     {
+        //
+        // Release any bandwidth reserved by this pipe.
+        //
+        PipeBandwidthRelease(&g_sUSBHCD.psUSBINPipes[ui32Index]);
+
         //
         // Clear the address and type for this endpoint to free it up.
         //
         g_sUSBHCD.psUSBINPipes[ui32Index].psDevice = 0;
-        g_sUSBHCD.psUSBINPipes[ui32Index].ui32Type = 0;
+        g_sUSBHCD.psUSBINPipes[ui32Index].ui32Type = USBHCD_PIPE_UNUSED;
         g_sUSBHCD.psUSBINPipes[ui32Index].pfnCallback = 0;
 
         //
@@ -2455,11 +2777,22 @@ USBHCDInitInternal(uint32_t ui32Index, void *pvPool, uint32_t ui32PoolSize)
         g_sUSBHCD.psUSBINPipes[i32Idx].psDevice = 0;
         g_sUSBHCD.psUSBINPipes[i32Idx].ui32Type = USBHCD_PIPE_UNUSED;
         g_sUSBHCD.psUSBINPipes[i32Idx].ui8DMAChannel = USBHCD_DMA_UNUSED;
+        g_sUSBHCD.psUSBINPipes[i32Idx].ui32Bandwidth = 0;
+        g_sUSBHCD.psUSBINPipes[i32Idx].ui32MaxPacketSize = 64;
         g_sUSBHCD.psUSBOUTPipes[i32Idx].psDevice = 0;
         g_sUSBHCD.psUSBOUTPipes[i32Idx].ui32Type = USBHCD_PIPE_UNUSED;
         g_sUSBHCD.psUSBOUTPipes[i32Idx].ui8DMAChannel = USBHCD_DMA_UNUSED;
+        g_sUSBHCD.psUSBOUTPipes[i32Idx].ui32Bandwidth = 0;
+        g_sUSBHCD.psUSBOUTPipes[i32Idx].ui32MaxPacketSize = 64;
     }
 
+    //
+    // No periodic bandwidth is reserved at start.
+    //
+    g_sUSBHCD.pui32PeriodicBW[0] = 0;
+    g_sUSBHCD.pui32PeriodicBW[1] = 0;
+    g_sUSBHCD.ui32SchedulePipe = 0;
+
     //
     // Make sure that the hub driver is initialized since it is called even
     // if it is not present in the system.
@@ -3754,6 +4087,13 @@ USBHCDSetInterface(uint32_t ui32Index, uint32_t ui32Device,
 // interrupts to determine if a new scheduler event should be sent to the USB
 // pipe.
 //
+// The scan for pipes that are due starts just after the first pipe that was
+// due in the last scan, so that pipes which become due in the same frame
+// take turns at being serviced first rather than the lowest numbered pipe
+// always winning.  Starting one pipe further on each frame is not enough,
+// since every unused pipe that the start passes over hands the first turn
+// back to the lowest numbered pipe.
+//
 // \return None.
 //
 //*****************************************************************************
@@ -3761,11 +4101,27 @@ void
 USBHostCheckPipes(void)
 {
     int32_t i32Idx;
+    uint32_t ui32Count;
+    bool bDue;
 
     g_ui32CurrentTick++;
 
-    for(i32Idx = 0; i32Idx < g_sUSBHCD.ui32NumEndpoints; i32Idx++)
+    if(g_sUSBHCD.ui32NumEndpoints == 0)
     {
+        return;
+    }
+
+    i32Idx = g_sUSBHCD.ui32SchedulePipe;
+    bDue = false;
+
+    for(ui32Count = 0; ui32Count < g_sUSBHCD.ui32NumEndpoints;
+        ui32Count++, i32Idx++)
+    {
+        if(i32Idx >= g_sUSBHCD.ui32NumEndpoints)
+        {
+            i32Idx = 0;
+        }
+
         //
         // Skip unused pipes.
         //
@@ -3781,6 +4137,21 @@ USBHostCheckPipes(void)
            (g_sUSBHCD.psUSBINPipes[i32Idx].ui32NextEventTick ==
             g_ui32CurrentTick))
         {
+            //
+            // The next scan starts after the first pipe that is due in this
+            // one.
+            //
+            if(!bDue)
+            {
+                bDue = true;
+                g_sUSBHCD.ui32SchedulePipe = i32Idx + 1;
+
+                if(g_sUSBHCD.ui32SchedulePipe >= g_sUSBHCD.ui32NumEndpoints)
+                {
+                    g_sUSBHCD.ui32SchedulePipe = 0;
+                }
+            }
+
             //
             // Schedule the next event.
             //
@@ -3794,6 +4165,7 @@ USBHostCheckPipes(void)
             if((g_sUSBHCD.psUSBINPipes[i32Idx].iState == ePipeIdle) &&
                (g_sUSBHCD.psUSBINPipes[i32Idx].pfnCallback))
             {
+                g_sUSBHCD.psUSBINPipes[i32Idx].sStats.ui32Events++;
                 g_sUSBHCD.psUSBINPipes[i32Idx].pfnCallback(
                                                         IN_PIPE_HANDLE(i32Idx),
                                                         USB_EVENT_SCHEDULER);
@@ -4054,6 +4426,9 @@ USBHostIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
                     // not occur.  So process the data ready event here.
                     //
                     g_sUSBHCD.psUSBINPipes[ui32Idx].iState = ePipeDataReady;
+                    g_sUSBHCD.psUSBINPipes[ui32Idx].sStats.ui32Packets++;
+                    g_sUSBHCD.psUSBINPipes[ui32Idx].sStats.ui32Bytes +=
+                                g_sUSBHCD.psUSBINPipes[ui32Idx].ui32DataRead;
 
                     //
                     // Only call a handler if one is present.
@@ -4100,6 +4475,7 @@ USBHostIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
                 // Data was transmitted successfully.
                 //
                 g_sUSBHCD.psUSBOUTPipes[ui32Idx].iState = ePipeDataSent;
+                g_sUSBHCD.psUSBOUTPipes[ui32Idx].sStats.ui32Packets++;
 
                 //
                 // Only call a handler if one is present.
@@ -4182,6 +4558,7 @@ USBHostIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
                 // Save the STALLED state.
                 //
                 g_sUSBHCD.psUSBINPipes[ui32Idx].iState = ePipeStalled;
+                g_sUSBHCD.psUSBINPipes[ui32Idx].sStats.ui32Stalls++;
 
                 //
                 // Notify the pipe that it was stalled.
@@ -4208,6 +4585,7 @@ USBHostIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
                 // Save the STALLED state.
                 //
                 g_sUSBHCD.psUSBINPipes[ui32Idx].iState = ePipeError;
+                g_sUSBHCD.psUSBINPipes[ui32Idx].sStats.ui32Errors++;
 
                 //
                 // Notify the pipe that it was stalled.
@@ -4275,6 +4653,7 @@ USBHostIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
                 // Data is available.
                 //
                 g_sUSBHCD.psUSBINPipes[ui32Idx].iState = ePipeDataReady;
+                g_sUSBHCD.psUSBINPipes[ui32Idx].sStats.ui32Packets++;
 
                 //
                 // Read the data out of the USB endpoint interface into the
@@ -4289,6 +4668,9 @@ USBHostIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
                     USBEndpointDataGet(USB0_BASE, IndexToUSBEP(ui32Idx + 1),
                                 g_sUSBHCD.psUSBINPipes[ui32Idx].pui8ReadPtr,
                                 &g_sUSBHCD.psUSBINPipes[ui32Idx].ui32DataRead);
+
+                    g_sUSBHCD.psUSBINPipes[ui32Idx].sStats.ui32Bytes +=
+                                g_sUSBHCD.psUSBINPipes[ui32Idx].ui32DataRead;
                 }
 
                 //
@@ -4338,6 +4720,7 @@ USBHostIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
                 // Save the STALLED state.
                 //
                 g_sUSBHCD.psUSBOUTPipes[ui32Idx].iState = ePipeStalled;
+                g_sUSBHCD.psUSBOUTPipes[ui32Idx].sStats.ui32Stalls++;
 
                 //
                 // Only call a handler if one is present.
@@ -4365,6 +4748,7 @@ USBHostIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
                 // Save the Pipes error state.
                 //
                 g_sUSBHCD.psUSBOUTPipes[ui32Idx].iState = ePipeError;
+                g_sUSBHCD.psUSBOUTPipes[ui32Idx].sStats.ui32Errors++;
 
                 //
                 // Only call a handler if one is present.
@@ -4388,6 +4772,7 @@ USBHostIntHandlerInternal(uint32_t ui32Index, uint32_t ui32Status)
                 // Data was transmitted successfully.
                 //
                 g_sUSBHCD.psUSBOUTPipes[ui32Idx].iState = ePipeDataSent;
+                g_sUSBHCD.psUSBOUTPipes[ui32Idx].sStats.ui32Packets++;
 
                 //
                 // Only call a handler if one is present.
@@ -5057,6 +5442,18 @@ ProcessUSBDeviceStateMachine(tUSBHDeviceState iOldState,
                 // Move on to the addressed state.
                 //
                 g_sUSBHCD.piDeviceState[ui32DevIndex] = eHCDDevAddressed;
+
+                //
+                // The device no longer answers on the default address so let
+                // the hub driver start resetting the next device waiting on
+                // one of its ports while this one completes enumeration.
+                //
+                if(g_sUSBHCD.psUSBDevice[ui32DevIndex].ui8Hub)
+                {
+                    USBHHubEnumerationAddressed(
+                            g_sUSBHCD.psUSBDevice[ui32DevIndex].ui8Hub,
+                            g_sUSBHCD.psUSBDevice[ui32DevIndex].ui8HubPort);
+                }
             }
             break;
         }
@@ -184,6 +184,7 @@ extern void USBHCDHubDeviceDisconnected(uint32_t ui32Index,
 //*****************************************************************************
 extern void USBHHubMain(void);
 extern void USBHHubInit(void);
+extern void USBHHubEnumerationAddressed(uint8_t ui8Hub, uint8_t ui8Port);
 extern void USBHHubEnumerationComplete(uint8_t ui8Hub, uint8_t ui8Port);
 extern void USBHHubEnumerationError(uint8_t ui8Hub, uint8_t ui8Port);
 extern uint32_t USBHCDLPMSleep(tUSBHostDevice *psDevice);
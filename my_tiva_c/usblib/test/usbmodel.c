@@ -0,0 +1,2046 @@
+//*****************************************************************************
+//
+// usbmodel.c - A USB controller model for the USB library host build.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva USB Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_usb.h"
+#include "driverlib/sysctl.h"
+#include "usbmodel.h"
+
+//*****************************************************************************
+//
+// The model covers the device side of the controller: endpoint zero and the
+// seven other endpoints, their FIFOs, the interrupt status registers, the
+// integrated DMA controller, and the ULPI register interface to the high
+// speed PHY.  The host side of the bus is driven by the functions at the end
+// of this file, which make one transaction per call and run the USB
+// interrupt handler until it has dealt with any interrupt that the
+// transaction raised.
+//
+// When the software puts the controller in host mode, no device is attached
+// to it.  The host's registers hold what is written to them, and a
+// transaction started on endpoint zero fails with an error once the
+// controller has given up on it in the next frame.
+//
+// Bus time is counted in thirds of a nanosecond, which makes both the full
+// speed and the high speed byte times whole numbers.  The cost of each
+// transaction is its data plus the protocol overhead given by the USB 2.0
+// specification for a bulk transaction, and a transaction that will not fit
+// in what remains of the current (micro)frame waits for the next one.
+//
+//*****************************************************************************
+#define MODEL_TIME_PER_NS       3
+
+//*****************************************************************************
+//
+// The timing of each bus speed.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The time taken to send one byte.
+    //
+    uint32_t ui32ByteTime;
+
+    //
+    // The length of a frame or microframe.
+    //
+    uint32_t ui32FrameTime;
+
+    //
+    // The number of (micro)frames in each millisecond frame number.
+    //
+    uint32_t ui32FramesPerMs;
+
+    //
+    // The protocol overhead of a transaction, and the length of the start of
+    // frame packet, both in bytes.
+    //
+    uint32_t ui32Overhead;
+    uint32_t ui32SOFBytes;
+}
+tModelSpeed;
+
+static const tModelSpeed g_psModelSpeeds[2] =
+{
+    //
+    // Full speed, 12Mbit/s in 1ms frames.
+    //
+    { 2000, 3000000, 1, 13, 6 },
+
+    //
+    // High speed, 480Mbit/s in 125us microframes.
+    //
+    { 50, 375000, 8, 55, 20 }
+};
+
+//*****************************************************************************
+//
+// The size of the register block and the number of endpoints modeled.
+//
+//*****************************************************************************
+#define MODEL_REG_SIZE          0x1000
+#define MODEL_NUM_EPS           8
+#define MODEL_NUM_DMA           8
+
+//*****************************************************************************
+//
+// Every FIFO can hold the largest packet that any endpoint can send.
+//
+//*****************************************************************************
+#define MODEL_FIFO_SIZE         1024
+
+//*****************************************************************************
+//
+// The upper bits of the location returned for a byte access to a FIFO.  A
+// read leaves them set, and a write of a byte clears them.
+//
+//*****************************************************************************
+#define MODEL_FIFO_READ         0x5a5a5a00
+
+//*****************************************************************************
+//
+// The number of times in a row that the interrupt handler may be called
+// before the interrupt is considered stuck.
+//
+//*****************************************************************************
+#define MODEL_MAX_INT_CALLS     64
+
+//*****************************************************************************
+//
+// The ULPI PHY registers used by the USB library, and their reset values.
+//
+//*****************************************************************************
+#define ULPI_FCTL               0x04
+#define ULPI_ICTL               0x07
+#define ULPI_OTGCTL             0x0a
+#define ULPI_FCTL_XCVR_M        0x03
+#define ULPI_FCTL_XCVR_HS       0x00
+#define ULPI_FCTL_RESET         0x41
+#define ULPI_OTGCTL_RESET       0x06
+
+//*****************************************************************************
+//
+// The offset of an endpoint's register, given the offset of the endpoint 1
+// register.
+//
+//*****************************************************************************
+#define EPREG(ui32EP, ui32Reg)  ((ui32Reg) + (((ui32EP) - 1) * 0x10))
+
+//*****************************************************************************
+//
+// The offsets of the registers of a DMA channel.
+//
+//*****************************************************************************
+#define DMAREG(ui32Channel, ui32Reg)                                          \
+                                ((ui32Reg) + ((ui32Channel) * 0x10))
+
+//*****************************************************************************
+//
+// The kinds of access that may be waiting to be applied.
+//
+//*****************************************************************************
+#define MODEL_ACCESS_NONE       0
+#define MODEL_ACCESS_REG        1
+#define MODEL_ACCESS_FIFO       2
+#define MODEL_ACCESS_BIT        3
+
+//*****************************************************************************
+//
+// A FIFO, holding one packet.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t pui8Data[MODEL_FIFO_SIZE];
+    uint32_t ui32Count;
+    uint32_t ui32Read;
+}
+tModelFIFO;
+
+//*****************************************************************************
+//
+// The state of the controller model.
+//
+//*****************************************************************************
+static struct
+{
+    //
+    // The register block, as seen by the software.
+    //
+    uint8_t pui8Reg[MODEL_REG_SIZE];
+
+    //
+    // The locations returned for register accesses, one for each offset.
+    //
+    uint32_t pui32Cell[MODEL_REG_SIZE];
+
+    //
+    // The access that has not been applied yet, its offset or address, its
+    // size in bytes, the bit accessed in the bit-band alias, and the value
+    // that it found.
+    //
+    uint32_t ui32Access;
+    uint32_t ui32Offset;
+    volatile void *pvBitAddr;
+    uint32_t ui32Size;
+    uint32_t ui32Bit;
+    uint32_t ui32Value;
+    uint32_t ui32BitCell;
+
+    //
+    // The transmit and receive FIFOs of each endpoint.
+    //
+    tModelFIFO psTxFIFO[MODEL_NUM_EPS];
+    tModelFIFO psRxFIFO[MODEL_NUM_EPS];
+
+    //
+    // The FIFO sizing registers of each endpoint, which are reached through
+    // the index register.
+    //
+    uint8_t pui8TxFIFOSz[MODEL_NUM_EPS];
+    uint8_t pui8RxFIFOSz[MODEL_NUM_EPS];
+    uint16_t pui16TxFIFOAdd[MODEL_NUM_EPS];
+    uint16_t pui16RxFIFOAdd[MODEL_NUM_EPS];
+
+    //
+    // The registers of the ULPI PHY.
+    //
+    uint8_t pui8ULPI[256];
+
+    //
+    // Endpoint zero's status stage: the software has ended an OUT or no-data
+    // control transfer and the status stage is an IN, or the last packet of
+    // an IN data stage has been sent and the status stage is an OUT.
+    //
+    bool bEP0StatusIn;
+    bool bEP0StatusOut;
+
+    //
+    // The last packet of an IN data stage is in endpoint zero's FIFO.
+    //
+    bool bEP0TxLast;
+
+    //
+    // A host transaction on endpoint zero is waiting for the next frame to
+    // fail.
+    //
+    bool bHostTimeout;
+
+    //
+    // The speed of the bus and the start of the current (micro)frame.
+    //
+    uint32_t ui32Speed;
+    uint64_t ui64FrameStart;
+    uint32_t ui32MicroFrame;
+
+    //
+    // The USB interrupt handler, whether the USB interrupt is enabled, and
+    // whether interrupts are masked in the processor.
+    //
+    void (*pfnHandler)(void);
+    bool bIntEnabled;
+    bool bIntMasked;
+
+    //
+    // The depth of calls to the interrupt handler.
+    //
+    uint32_t ui32IntDepth;
+
+    //
+    // The counts and times gathered by the model.
+    //
+    tUSBModelStats sStats;
+}
+g_sModel;
+
+//*****************************************************************************
+//
+// A forward declaration for the function that starts the next frame.
+//
+//*****************************************************************************
+static void ModelFrameNext(void);
+
+//*****************************************************************************
+//
+// Reports an error found by the model.
+//
+//*****************************************************************************
+static void
+ModelError(const char *pcError, uint32_t ui32Value)
+{
+    g_sModel.sStats.ui32Errors++;
+    printf("usbmodel: %s (0x%x)\n", pcError, (unsigned)ui32Value);
+}
+
+//*****************************************************************************
+//
+// Returns the host's clock in nanoseconds.
+//
+//*****************************************************************************
+static uint64_t
+ModelClock(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return(((uint64_t)sNow.tv_sec * 1000000000) + sNow.tv_nsec);
+}
+
+//*****************************************************************************
+//
+// Reads and writes registers of more than one byte.
+//
+//*****************************************************************************
+static uint32_t
+ModelReg16(uint32_t ui32Offset)
+{
+    return(g_sModel.pui8Reg[ui32Offset] |
+           (g_sModel.pui8Reg[ui32Offset + 1] << 8));
+}
+
+static uint32_t
+ModelReg32(uint32_t ui32Offset)
+{
+    return(ModelReg16(ui32Offset) | (ModelReg16(ui32Offset + 2) << 16));
+}
+
+static void
+ModelReg16Set(uint32_t ui32Offset, uint32_t ui32Value)
+{
+    g_sModel.pui8Reg[ui32Offset] = ui32Value & 0xff;
+    g_sModel.pui8Reg[ui32Offset + 1] = (ui32Value >> 8) & 0xff;
+}
+
+static void
+ModelReg32Set(uint32_t ui32Offset, uint32_t ui32Value)
+{
+    ModelReg16Set(ui32Offset, ui32Value & 0xffff);
+    ModelReg16Set(ui32Offset + 2, ui32Value >> 16);
+}
+
+//*****************************************************************************
+//
+// Empties a FIFO.
+//
+//*****************************************************************************
+static void
+ModelFIFOFlush(tModelFIFO *psFIFO)
+{
+    psFIFO->ui32Count = 0;
+    psFIFO->ui32Read = 0;
+}
+
+//*****************************************************************************
+//
+// Returns whether the software has put the controller in host mode.
+//
+//*****************************************************************************
+static bool
+ModelHostMode(void)
+{
+    return(((g_sModel.pui8Reg[USB_O_GPCS] & USB_GPCS_DEVMOD_M) ==
+            USB_GPCS_DEVMOD_HOST) ? true : false);
+}
+
+//*****************************************************************************
+//
+// Brings the transmit FIFO not empty bit of an endpoint up to date.
+//
+//*****************************************************************************
+static void
+ModelTxFIFOUpdate(uint32_t ui32EP)
+{
+    uint8_t *pui8CSRL;
+
+    if(ui32EP != 0)
+    {
+        pui8CSRL = &g_sModel.pui8Reg[EPREG(ui32EP, USB_O_TXCSRL1)];
+
+        if(g_sModel.psTxFIFO[ui32EP].ui32Count)
+        {
+            *pui8CSRL |= USB_TXCSRL1_FIFONE;
+        }
+        else
+        {
+            *pui8CSRL &= ~USB_TXCSRL1_FIFONE;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Places a packet from the host in an endpoint's receive FIFO.
+//
+//*****************************************************************************
+static void
+ModelRxPacket(uint32_t ui32EP, const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    tModelFIFO *psFIFO;
+
+    psFIFO = &g_sModel.psRxFIFO[ui32EP];
+    memcpy(psFIFO->pui8Data, pui8Data, ui32Size);
+    psFIFO->ui32Count = ui32Size;
+    psFIFO->ui32Read = 0;
+
+    if(ui32EP == 0)
+    {
+        ModelReg16Set(USB_O_COUNT0, ui32Size);
+        g_sModel.pui8Reg[USB_O_CSRL0] |= USB_CSRL0_RXRDY;
+    }
+    else
+    {
+        ModelReg16Set(EPREG(ui32EP, USB_O_RXCOUNT1), ui32Size);
+        g_sModel.pui8Reg[EPREG(ui32EP, USB_O_RXCSRL1)] |= USB_RXCSRL1_RXRDY;
+    }
+}
+
+//*****************************************************************************
+//
+// Discards the packet in an endpoint's receive FIFO.
+//
+//*****************************************************************************
+static void
+ModelRxConsume(uint32_t ui32EP)
+{
+    ModelFIFOFlush(&g_sModel.psRxFIFO[ui32EP]);
+
+    if(ui32EP == 0)
+    {
+        ModelReg16Set(USB_O_COUNT0, 0);
+    }
+    else
+    {
+        ModelReg16Set(EPREG(ui32EP, USB_O_RXCOUNT1), 0);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the maximum packet size set for an endpoint.
+//
+//*****************************************************************************
+static uint32_t
+ModelMaxPacket(uint32_t ui32EP, bool bTx)
+{
+    if(ui32EP == 0)
+    {
+        return(64);
+    }
+
+    return(ModelReg16(EPREG(ui32EP, bTx ? USB_O_TXMAXP1 : USB_O_RXMAXP1)) &
+           0x7ff);
+}
+
+//*****************************************************************************
+//
+// Reads and writes the registers of the ULPI PHY.  Each of the control
+// registers has a set and a clear alias at the two following addresses.
+//
+//*****************************************************************************
+static uint8_t
+ModelULPIRead(uint8_t ui8Reg)
+{
+    if((ui8Reg >= ULPI_FCTL) && (ui8Reg <= (ULPI_OTGCTL + 2)))
+    {
+        ui8Reg -= (ui8Reg - ULPI_FCTL) % 3;
+    }
+
+    return(g_sModel.pui8ULPI[ui8Reg]);
+}
+
+static void
+ModelULPIWrite(uint8_t ui8Reg, uint8_t ui8Data)
+{
+    uint32_t ui32Alias;
+
+    if((ui8Reg >= ULPI_FCTL) && (ui8Reg <= (ULPI_OTGCTL + 2)))
+    {
+        ui32Alias = (ui8Reg - ULPI_FCTL) % 3;
+        ui8Reg -= ui32Alias;
+
+        if(ui32Alias == 1)
+        {
+            ui8Data |= g_sModel.pui8ULPI[ui8Reg];
+        }
+        else if(ui32Alias == 2)
+        {
+            ui8Data = g_sModel.pui8ULPI[ui8Reg] & ~ui8Data;
+        }
+    }
+
+    g_sModel.pui8ULPI[ui8Reg] = ui8Data;
+}
+
+//*****************************************************************************
+//
+// Runs the DMA channels, moving data between memory and the endpoint FIFOs
+// for as long as the endpoints allow.  A channel holds the low 32 bits of a
+// host address, so the host build places all DMA buffers below 4GB.
+//
+//*****************************************************************************
+static void
+ModelDMARun(void)
+{
+    uint32_t ui32Channel, ui32Ctl, ui32EP, ui32Addr, ui32Count, ui32Size;
+    uint32_t ui32MaxPacket;
+    uint8_t *pui8CSRL, *pui8CSRH;
+    tModelFIFO *psFIFO;
+    bool bDone;
+
+    for(ui32Channel = 0; ui32Channel < MODEL_NUM_DMA; ui32Channel++)
+    {
+        ui32Ctl = ModelReg32(DMAREG(ui32Channel, USB_O_DMACTL0));
+
+        if(!(ui32Ctl & USB_DMACTL0_ENABLE))
+        {
+            continue;
+        }
+
+        ui32EP = (ui32Ctl & USB_DMACTL0_EP_M) >> USB_DMACTL0_EP_S;
+        if((ui32EP == 0) || (ui32EP >= MODEL_NUM_EPS))
+        {
+            ModelError("DMA channel enabled for a bad endpoint", ui32Ctl);
+            ModelReg32Set(DMAREG(ui32Channel, USB_O_DMACTL0),
+                          ui32Ctl & ~USB_DMACTL0_ENABLE);
+            continue;
+        }
+
+        ui32Addr = ModelReg32(DMAREG(ui32Channel, USB_O_DMAADDR0));
+        ui32Count = ModelReg32(DMAREG(ui32Channel, USB_O_DMACOUNT0));
+        bDone = (ui32Count == 0) ? true : false;
+
+        if(ui32Ctl & USB_DMACTL0_DIR)
+        {
+            //
+            // Fill the transmit FIFO with a packet each time it is empty.
+            // In mode 1 with auto set, the packet is sent when it is full;
+            // in mode 0, one packet is moved and the software sends it.
+            //
+            pui8CSRL = &g_sModel.pui8Reg[EPREG(ui32EP, USB_O_TXCSRL1)];
+            pui8CSRH = &g_sModel.pui8Reg[EPREG(ui32EP, USB_O_TXCSRH1)];
+            psFIFO = &g_sModel.psTxFIFO[ui32EP];
+            ui32MaxPacket = ModelMaxPacket(ui32EP, true);
+
+            while(!bDone && (*pui8CSRH & USB_TXCSRH1_DMAEN) &&
+                  !(*pui8CSRL & USB_TXCSRL1_TXRDY) &&
+                  (psFIFO->ui32Count == 0))
+            {
+                ui32Size = (ui32Count < ui32MaxPacket) ? ui32Count :
+                                                         ui32MaxPacket;
+                memcpy(psFIFO->pui8Data, (void *)(uintptr_t)ui32Addr,
+                       ui32Size);
+                psFIFO->ui32Count = ui32Size;
+                ui32Addr += ui32Size;
+                ui32Count -= ui32Size;
+                g_sModel.sStats.ui64DMABytes += ui32Size;
+
+                if((ui32Ctl & USB_DMACTL0_MODE) &&
+                   (*pui8CSRH & USB_TXCSRH1_AUTOSET) &&
+                   (ui32Size == ui32MaxPacket))
+                {
+                    *pui8CSRL |= USB_TXCSRL1_TXRDY;
+                }
+
+                bDone = ((ui32Count == 0) || !(ui32Ctl & USB_DMACTL0_MODE)) ?
+                        true : false;
+            }
+
+            ModelTxFIFOUpdate(ui32EP);
+        }
+        else
+        {
+            //
+            // Empty the receive FIFO each time that it holds a packet.  With
+            // auto clear, a full packet is acknowledged once it has been
+            // unloaded, in either mode.  In mode 1 a short packet ends the
+            // transfer; in mode 0, one packet is moved.
+            //
+            pui8CSRL = &g_sModel.pui8Reg[EPREG(ui32EP, USB_O_RXCSRL1)];
+            pui8CSRH = &g_sModel.pui8Reg[EPREG(ui32EP, USB_O_RXCSRH1)];
+            psFIFO = &g_sModel.psRxFIFO[ui32EP];
+            ui32MaxPacket = ModelMaxPacket(ui32EP, false);
+
+            while(!bDone && (*pui8CSRH & USB_RXCSRH1_DMAEN) &&
+                  (*pui8CSRL & USB_RXCSRL1_RXRDY) &&
+                  (psFIFO->ui32Read < psFIFO->ui32Count))
+            {
+                ui32Size = psFIFO->ui32Count - psFIFO->ui32Read;
+                if(ui32Size > ui32Count)
+                {
+                    ModelError("DMA receive overflows the buffer", ui32Size);
+                    ui32Size = ui32Count;
+                }
+
+                memcpy((void *)(uintptr_t)ui32Addr,
+                       psFIFO->pui8Data + psFIFO->ui32Read, ui32Size);
+                psFIFO->ui32Read += ui32Size;
+                ui32Addr += ui32Size;
+                ui32Count -= ui32Size;
+                g_sModel.sStats.ui64DMABytes += ui32Size;
+
+                bDone = ((ui32Count == 0) || !(ui32Ctl & USB_DMACTL0_MODE) ||
+                         (psFIFO->ui32Count < ui32MaxPacket)) ? true : false;
+
+                if((*pui8CSRH & USB_RXCSRH1_AUTOCL) &&
+                   (psFIFO->ui32Count == ui32MaxPacket))
+                {
+                    *pui8CSRL &= ~USB_RXCSRL1_RXRDY;
+                    ModelRxConsume(ui32EP);
+                }
+            }
+        }
+
+        ModelReg32Set(DMAREG(ui32Channel, USB_O_DMAADDR0), ui32Addr);
+        ModelReg32Set(DMAREG(ui32Channel, USB_O_DMACOUNT0), ui32Count);
+
+        //
+        // The channel stops at the end of the transfer, and raises its
+        // interrupt if that is enabled.
+        //
+        if(bDone)
+        {
+            ModelReg32Set(DMAREG(ui32Channel, USB_O_DMACTL0),
+                          ui32Ctl & ~USB_DMACTL0_ENABLE);
+
+            if(ui32Ctl & USB_DMACTL0_IE)
+            {
+                g_sModel.pui8Reg[USB_O_DMAINTR] |= 1 << ui32Channel;
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Applies a write of one byte of an endpoint's registers, for endpoints 1 to
+// 7.
+//
+//*****************************************************************************
+static void
+ModelEPWrite(uint32_t ui32EP, uint32_t ui32Offset, uint8_t ui8Old,
+             uint8_t ui8New)
+{
+    uint8_t *pui8Reg;
+
+    pui8Reg = &g_sModel.pui8Reg[ui32Offset];
+
+    switch(ui32Offset - EPREG(ui32EP, USB_O_TXMAXP1))
+    {
+        //
+        // Transmit control and status.  The packet ready bit can only be set
+        // by the software, and the sent stall and underrun bits can only be
+        // cleared.
+        //
+        case USB_O_TXCSRL1 - USB_O_TXMAXP1:
+        {
+            *pui8Reg = ui8Old & (USB_TXCSRL1_TXRDY | USB_TXCSRL1_UNDRN |
+                                 USB_TXCSRL1_STALLED);
+            *pui8Reg |= ui8New & USB_TXCSRL1_STALL;
+
+            if(!(ui8New & USB_TXCSRL1_UNDRN))
+            {
+                *pui8Reg &= ~USB_TXCSRL1_UNDRN;
+            }
+            if(!(ui8New & USB_TXCSRL1_STALLED))
+            {
+                *pui8Reg &= ~USB_TXCSRL1_STALLED;
+            }
+
+            if(ui8New & USB_TXCSRL1_FLUSH)
+            {
+                ModelFIFOFlush(&g_sModel.psTxFIFO[ui32EP]);
+                *pui8Reg &= ~USB_TXCSRL1_TXRDY;
+            }
+            else if((ui8New & USB_TXCSRL1_TXRDY) &&
+                    !(ui8Old & USB_TXCSRL1_TXRDY))
+            {
+                if(g_sModel.psTxFIFO[ui32EP].ui32Count >
+                   ModelMaxPacket(ui32EP, true))
+                {
+                    ModelError("packet longer than the maximum packet size",
+                               ui32EP);
+                }
+                *pui8Reg |= USB_TXCSRL1_TXRDY;
+            }
+
+            ModelTxFIFOUpdate(ui32EP);
+            break;
+        }
+
+        //
+        // Receive control and status.  Clearing the packet ready bit frees
+        // the FIFO for the next packet.
+        //
+        case USB_O_RXCSRL1 - USB_O_TXMAXP1:
+        {
+            *pui8Reg = ui8Old & (USB_RXCSRL1_RXRDY | USB_RXCSRL1_FULL |
+                                 USB_RXCSRL1_OVER | USB_RXCSRL1_DATAERR |
+                                 USB_RXCSRL1_STALLED);
+            *pui8Reg |= ui8New & USB_RXCSRL1_STALL;
+
+            if(!(ui8New & USB_RXCSRL1_OVER))
+            {
+                *pui8Reg &= ~USB_RXCSRL1_OVER;
+            }
+            if(!(ui8New & USB_RXCSRL1_STALLED))
+            {
+                *pui8Reg &= ~USB_RXCSRL1_STALLED;
+            }
+
+            if((ui8New & USB_RXCSRL1_FLUSH) ||
+               ((ui8Old & USB_RXCSRL1_RXRDY) &&
+                !(ui8New & USB_RXCSRL1_RXRDY)))
+            {
+                *pui8Reg &= ~USB_RXCSRL1_RXRDY;
+                ModelRxConsume(ui32EP);
+            }
+            break;
+        }
+
+        //
+        // The receive count is read-only.
+        //
+        case USB_O_RXCOUNT1 - USB_O_TXMAXP1:
+        case USB_O_RXCOUNT1 + 1 - USB_O_TXMAXP1:
+        {
+            break;
+        }
+
+        default:
+        {
+            *pui8Reg = ui8New;
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Applies a write of one byte of the register block.
+//
+//*****************************************************************************
+static void
+ModelRegWrite(uint32_t ui32Offset, uint8_t ui8Old, uint8_t ui8New)
+{
+    uint8_t *pui8Reg;
+    uint32_t ui32Index;
+
+    pui8Reg = &g_sModel.pui8Reg[ui32Offset];
+    ui32Index = g_sModel.pui8Reg[USB_O_EPIDX] & (MODEL_NUM_EPS - 1);
+
+    if((ui32Offset >= USB_O_TXMAXP1) &&
+       (ui32Offset < EPREG(MODEL_NUM_EPS, USB_O_TXMAXP1)))
+    {
+        ModelEPWrite(((ui32Offset - USB_O_TXMAXP1) / 0x10) + 1, ui32Offset,
+                     ui8Old, ui8New);
+        return;
+    }
+
+    switch(ui32Offset)
+    {
+        //
+        // The high speed mode bit is set by the controller after a reset.
+        //
+        case USB_O_POWER:
+        {
+            *pui8Reg = (ui8New & ~USB_POWER_HSMODE) |
+                       (ui8Old & USB_POWER_HSMODE);
+            break;
+        }
+
+        //
+        // Endpoint zero's control and status.  Writing the packet ready
+        // clear bit frees the FIFO for the next packet, and with the data
+        // end bit ends the control transfer.  Writing the transmit packet
+        // ready bit sends the FIFO, and with the data end bit ends the data
+        // stage.
+        //
+        case USB_O_CSRL0:
+        {
+            //
+            // A host sends a setup or OUT packet, or requests an IN packet,
+            // with nobody to answer it.  The error is raised in the next
+            // frame, and the bits written as 0 clear the host status bits.
+            //
+            if(ModelHostMode())
+            {
+                *pui8Reg = ui8Old & ui8New & (USB_CSRL0_NAKTO |
+                                              USB_CSRL0_ERROR |
+                                              USB_CSRL0_STALLED);
+
+                if(ui8New & (USB_CSRL0_TXRDY | USB_CSRL0_REQPKT))
+                {
+                    ModelFIFOFlush(&g_sModel.psTxFIFO[0]);
+                    g_sModel.bHostTimeout = true;
+                }
+                break;
+            }
+
+            *pui8Reg = ui8Old & (USB_CSRL0_RXRDY | USB_CSRL0_TXRDY |
+                                 USB_CSRL0_STALLED | USB_CSRL0_SETEND |
+                                 USB_CSRL0_STALL);
+            *pui8Reg |= ui8New & USB_CSRL0_STALL;
+
+            if(!(ui8New & USB_CSRL0_STALLED))
+            {
+                *pui8Reg &= ~USB_CSRL0_STALLED;
+            }
+            if(ui8New & USB_CSRL0_SETENDC)
+            {
+                *pui8Reg &= ~USB_CSRL0_SETEND;
+            }
+            if(ui8New & USB_CSRL0_RXRDYC)
+            {
+                *pui8Reg &= ~USB_CSRL0_RXRDY;
+                ModelRxConsume(0);
+
+                if(ui8New & USB_CSRL0_DATAEND)
+                {
+                    g_sModel.bEP0StatusIn = true;
+                }
+            }
+            if((ui8New & USB_CSRL0_TXRDY) && !(ui8Old & USB_CSRL0_TXRDY))
+            {
+                if(g_sModel.psTxFIFO[0].ui32Count > 64)
+                {
+                    ModelError("endpoint zero packet too long",
+                               g_sModel.psTxFIFO[0].ui32Count);
+                }
+                *pui8Reg |= USB_CSRL0_TXRDY;
+                g_sModel.bEP0TxLast = (ui8New & USB_CSRL0_DATAEND) ? true :
+                                                                     false;
+            }
+            break;
+        }
+
+        case USB_O_CSRH0:
+        {
+            if(ui8New & USB_CSRH0_FLUSH)
+            {
+                ModelFIFOFlush(&g_sModel.psTxFIFO[0]);
+                ModelRxConsume(0);
+                g_sModel.pui8Reg[USB_O_CSRL0] &= ~(USB_CSRL0_TXRDY |
+                                                   USB_CSRL0_RXRDY);
+            }
+            *pui8Reg = ui8New & ~USB_CSRH0_FLUSH;
+            break;
+        }
+
+        //
+        // The index register selects the FIFO sizing registers of an
+        // endpoint.
+        //
+        case USB_O_EPIDX:
+        {
+            *pui8Reg = ui8New & 0x0f;
+            ui32Index = ui8New & (MODEL_NUM_EPS - 1);
+            g_sModel.pui8Reg[USB_O_TXFIFOSZ] =
+                g_sModel.pui8TxFIFOSz[ui32Index];
+            g_sModel.pui8Reg[USB_O_RXFIFOSZ] =
+                g_sModel.pui8RxFIFOSz[ui32Index];
+            ModelReg16Set(USB_O_TXFIFOADD, g_sModel.pui16TxFIFOAdd[ui32Index]);
+            ModelReg16Set(USB_O_RXFIFOADD, g_sModel.pui16RxFIFOAdd[ui32Index]);
+            break;
+        }
+
+        case USB_O_TXFIFOSZ:
+        {
+            *pui8Reg = ui8New;
+            g_sModel.pui8TxFIFOSz[ui32Index] = ui8New;
+            break;
+        }
+
+        case USB_O_RXFIFOSZ:
+        {
+            *pui8Reg = ui8New;
+            g_sModel.pui8RxFIFOSz[ui32Index] = ui8New;
+            break;
+        }
+
+        case USB_O_TXFIFOADD:
+        case USB_O_TXFIFOADD + 1:
+        {
+            *pui8Reg = ui8New;
+            g_sModel.pui16TxFIFOAdd[ui32Index] = ModelReg16(USB_O_TXFIFOADD);
+            break;
+        }
+
+        case USB_O_RXFIFOADD:
+        case USB_O_RXFIFOADD + 1:
+        {
+            *pui8Reg = ui8New;
+            g_sModel.pui16RxFIFOAdd[ui32Index] = ModelReg16(USB_O_RXFIFOADD);
+            break;
+        }
+
+        //
+        // A ULPI register access completes at once.
+        //
+        case USB_O_ULPIREGCTL:
+        {
+            if(ui8New & USB_ULPIREGCTL_REGACC)
+            {
+                if(ui8New & USB_ULPIREGCTL_RDWR)
+                {
+                    g_sModel.pui8Reg[USB_O_ULPIREGDATA] =
+                        ModelULPIRead(g_sModel.pui8Reg[USB_O_ULPIREGADDR]);
+                }
+                else
+                {
+                    ModelULPIWrite(g_sModel.pui8Reg[USB_O_ULPIREGADDR],
+                                   g_sModel.pui8Reg[USB_O_ULPIREGDATA]);
+                }
+                *pui8Reg = USB_ULPIREGCTL_REGCMPLT |
+                           (ui8New & USB_ULPIREGCTL_RDWR);
+            }
+            else
+            {
+                *pui8Reg = ui8New & USB_ULPIREGCTL_RDWR;
+            }
+            break;
+        }
+
+        //
+        // The interrupt clear registers clear the bits written as 1.
+        //
+        case USB_O_EPCISC:
+        case USB_O_DRISC:
+        case USB_O_VDCISC:
+        case USB_O_IDVISC:
+        {
+            *pui8Reg = ui8Old & ~ui8New;
+            break;
+        }
+
+        //
+        // Status and identification registers are read-only.
+        //
+        case USB_O_TXIS:
+        case USB_O_TXIS + 1:
+        case USB_O_RXIS:
+        case USB_O_RXIS + 1:
+        case USB_O_IS:
+        case USB_O_FRAME:
+        case USB_O_FRAME + 1:
+        case USB_O_DEVCTL:
+        case USB_O_EPINFO:
+        case USB_O_RAMINFO:
+        case USB_O_COUNT0:
+        case USB_O_COUNT0 + 1:
+        case USB_O_DMAINTR:
+        case USB_O_DMAINTR + 1:
+        case USB_O_DMAINTR + 2:
+        case USB_O_DMAINTR + 3:
+        case USB_O_LPMRIS:
+        case USB_O_PP:
+        case USB_O_PP + 1:
+        case USB_O_PP + 2:
+        case USB_O_PP + 3:
+        {
+            break;
+        }
+
+        default:
+        {
+            *pui8Reg = ui8New;
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Applies the side effects of reading one byte of the register block.  The
+// interrupt status registers are cleared by reading them.
+//
+//*****************************************************************************
+static void
+ModelRegRead(uint32_t ui32Offset)
+{
+    switch(ui32Offset)
+    {
+        case USB_O_TXIS:
+        case USB_O_TXIS + 1:
+        case USB_O_RXIS:
+        case USB_O_RXIS + 1:
+        case USB_O_IS:
+        case USB_O_DMAINTR:
+        case USB_O_DMAINTR + 1:
+        case USB_O_DMAINTR + 2:
+        case USB_O_DMAINTR + 3:
+        case USB_O_LPMRIS:
+        {
+            g_sModel.pui8Reg[ui32Offset] = 0;
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Applies the side effects of the previous access.
+//
+//*****************************************************************************
+static void
+ModelAccessSync(void)
+{
+    uint32_t ui32Offset, ui32Value, ui32Idx, ui32EP;
+    tModelFIFO *psFIFO;
+    uint32_t ui32Mask;
+
+    ui32Offset = g_sModel.ui32Offset;
+
+    switch(g_sModel.ui32Access)
+    {
+        case MODEL_ACCESS_REG:
+        {
+            ui32Value = g_sModel.pui32Cell[ui32Offset];
+            if(g_sModel.ui32Size < 4)
+            {
+                ui32Value &= (1 << (8 * g_sModel.ui32Size)) - 1;
+            }
+
+            if(ui32Value != g_sModel.ui32Value)
+            {
+                g_sModel.sStats.ui32RegWrites++;
+                for(ui32Idx = 0; ui32Idx < g_sModel.ui32Size; ui32Idx++)
+                {
+                    ModelRegWrite(ui32Offset + ui32Idx,
+                                  (g_sModel.ui32Value >> (8 * ui32Idx)) & 0xff,
+                                  (ui32Value >> (8 * ui32Idx)) & 0xff);
+                }
+                ModelDMARun();
+            }
+            else
+            {
+                g_sModel.sStats.ui32RegReads++;
+                for(ui32Idx = 0; ui32Idx < g_sModel.ui32Size; ui32Idx++)
+                {
+                    ModelRegRead(ui32Offset + ui32Idx);
+                }
+            }
+            break;
+        }
+
+        //
+        // A FIFO read takes the next byte of the receive FIFO, and a write
+        // adds a byte to the transmit FIFO.
+        //
+        case MODEL_ACCESS_FIFO:
+        {
+            ui32EP = (ui32Offset - USB_O_FIFO0) / 4;
+            ui32Value = g_sModel.pui32Cell[ui32Offset];
+
+            if(ui32Value == g_sModel.ui32Value)
+            {
+                g_sModel.sStats.ui32RegReads++;
+                psFIFO = &g_sModel.psRxFIFO[ui32EP];
+                if(psFIFO->ui32Read < psFIFO->ui32Count)
+                {
+                    psFIFO->ui32Read++;
+                }
+                else
+                {
+                    ModelError("read from an empty FIFO", ui32EP);
+                }
+            }
+            else
+            {
+                g_sModel.sStats.ui32RegWrites++;
+                psFIFO = &g_sModel.psTxFIFO[ui32EP];
+                if(psFIFO->ui32Count < MODEL_FIFO_SIZE)
+                {
+                    psFIFO->pui8Data[psFIFO->ui32Count++] = ui32Value & 0xff;
+                }
+                else
+                {
+                    ModelError("write to a full FIFO", ui32EP);
+                }
+                ModelTxFIFOUpdate(ui32EP);
+            }
+            break;
+        }
+
+        //
+        // A write to a bit-band alias sets or clears the bit in memory.
+        //
+        case MODEL_ACCESS_BIT:
+        {
+            if(g_sModel.ui32BitCell != g_sModel.ui32Value)
+            {
+                ui32Mask = 1 << g_sModel.ui32Bit;
+
+                if(g_sModel.ui32Size == 4)
+                {
+                    ui32Value = *(volatile uint32_t *)g_sModel.pvBitAddr;
+                }
+                else if(g_sModel.ui32Size == 2)
+                {
+                    ui32Value = *(volatile uint16_t *)g_sModel.pvBitAddr;
+                }
+                else
+                {
+                    ui32Value = *(volatile uint8_t *)g_sModel.pvBitAddr;
+                }
+
+                ui32Value = (g_sModel.ui32BitCell & 1) ?
+                            (ui32Value | ui32Mask) : (ui32Value & ~ui32Mask);
+
+                if(g_sModel.ui32Size == 4)
+                {
+                    *(volatile uint32_t *)g_sModel.pvBitAddr = ui32Value;
+                }
+                else if(g_sModel.ui32Size == 2)
+                {
+                    *(volatile uint16_t *)g_sModel.pvBitAddr = ui32Value;
+                }
+                else
+                {
+                    *(volatile uint8_t *)g_sModel.pvBitAddr = ui32Value;
+                }
+            }
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    g_sModel.ui32Access = MODEL_ACCESS_NONE;
+}
+
+//*****************************************************************************
+//
+// Returns the location for a register access, after applying the previous
+// access.
+//
+//*****************************************************************************
+volatile uint32_t *
+USBModelReg(uintptr_t uiAddr, uint32_t ui32Size)
+{
+    uint32_t ui32Offset, ui32Idx, ui32Value, ui32EP;
+    tModelFIFO *psFIFO;
+
+    ModelAccessSync();
+
+    if((uiAddr < USB0_BASE) || (uiAddr >= (USB0_BASE + MODEL_REG_SIZE)) ||
+       (uiAddr & (ui32Size - 1)))
+    {
+        ModelError("access outside the USB controller", (uint32_t)uiAddr);
+        g_sModel.pui32Cell[0] = 0;
+        return(&g_sModel.pui32Cell[0]);
+    }
+
+    ui32Offset = uiAddr - USB0_BASE;
+    g_sModel.ui32Offset = ui32Offset;
+    g_sModel.ui32Size = ui32Size;
+
+    //
+    // A byte access to a FIFO returns the next byte of the receive FIFO, with
+    // the upper bits set so that a write can be recognized.
+    //
+    if((ui32Offset >= USB_O_FIFO0) && (ui32Offset <= (USB_O_FIFO7 + 3)))
+    {
+        if(ui32Size != 1)
+        {
+            ModelError("FIFO access wider than a byte", ui32Offset);
+        }
+
+        ui32EP = (ui32Offset - USB_O_FIFO0) / 4;
+        psFIFO = &g_sModel.psRxFIFO[ui32EP];
+        ui32Value = MODEL_FIFO_READ;
+        if(psFIFO->ui32Read < psFIFO->ui32Count)
+        {
+            ui32Value |= psFIFO->pui8Data[psFIFO->ui32Read];
+        }
+
+        g_sModel.ui32Access = MODEL_ACCESS_FIFO;
+        g_sModel.ui32Value = ui32Value;
+        g_sModel.pui32Cell[ui32Offset] = ui32Value;
+        return(&g_sModel.pui32Cell[ui32Offset]);
+    }
+
+    ui32Value = 0;
+    for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+    {
+        ui32Value |= g_sModel.pui8Reg[ui32Offset + ui32Idx] << (8 * ui32Idx);
+    }
+
+    g_sModel.ui32Access = MODEL_ACCESS_REG;
+    g_sModel.ui32Value = ui32Value;
+    g_sModel.pui32Cell[ui32Offset] = ui32Value;
+
+    return(&g_sModel.pui32Cell[ui32Offset]);
+}
+
+//*****************************************************************************
+//
+// Returns the location for an access to a bit-band alias, after applying
+// the previous access.
+//
+//*****************************************************************************
+volatile uint32_t *
+USBModelBit(volatile void *pvAddr, uint32_t ui32Size, uint32_t ui32Bit)
+{
+    uint32_t ui32Value;
+
+    ModelAccessSync();
+
+    if(ui32Size == 4)
+    {
+        ui32Value = *(volatile uint32_t *)pvAddr;
+    }
+    else if(ui32Size == 2)
+    {
+        ui32Value = *(volatile uint16_t *)pvAddr;
+    }
+    else
+    {
+        ui32Value = *(volatile uint8_t *)pvAddr;
+    }
+
+    g_sModel.ui32Access = MODEL_ACCESS_BIT;
+    g_sModel.pvBitAddr = pvAddr;
+    g_sModel.ui32Size = ui32Size;
+    g_sModel.ui32Bit = ui32Bit;
+    g_sModel.ui32Value = (ui32Value >> ui32Bit) & 1;
+    g_sModel.ui32BitCell = g_sModel.ui32Value;
+
+    return(&g_sModel.ui32BitCell);
+}
+
+//*****************************************************************************
+//
+// Puts the controller in its reset state.
+//
+//*****************************************************************************
+static void
+ModelControllerReset(void)
+{
+    uint32_t ui32EP;
+
+    g_sModel.ui32Access = MODEL_ACCESS_NONE;
+    memset(g_sModel.pui8Reg, 0, sizeof(g_sModel.pui8Reg));
+    memset(g_sModel.pui8ULPI, 0, sizeof(g_sModel.pui8ULPI));
+
+    for(ui32EP = 0; ui32EP < MODEL_NUM_EPS; ui32EP++)
+    {
+        ModelFIFOFlush(&g_sModel.psTxFIFO[ui32EP]);
+        ModelFIFOFlush(&g_sModel.psRxFIFO[ui32EP]);
+        g_sModel.pui8TxFIFOSz[ui32EP] = 0;
+        g_sModel.pui8RxFIFOSz[ui32EP] = 0;
+        g_sModel.pui16TxFIFOAdd[ui32EP] = 0;
+        g_sModel.pui16RxFIFOAdd[ui32EP] = 0;
+    }
+
+    g_sModel.pui8Reg[USB_O_POWER] = USB_POWER_HSENAB;
+    g_sModel.pui8Reg[USB_O_DEVCTL] = USB_DEVCTL_DEV | USB_DEVCTL_VBUS_VALID |
+                                     USB_DEVCTL_SESSION;
+    g_sModel.pui8Reg[USB_O_EPINFO] = ((MODEL_NUM_EPS - 1) <<
+                                      USB_EPINFO_RXEP_S) |
+                                     (MODEL_NUM_EPS - 1);
+    g_sModel.pui8Reg[USB_O_RAMINFO] = (MODEL_NUM_DMA <<
+                                       USB_RAMINFO_DMACHAN_S) | 12;
+    ModelReg32Set(USB_O_PP, (MODEL_NUM_EPS << USB_PP_ECNT_S) | USB_PP_USB_OTG |
+                            USB_PP_ULPI | USB_PP_PHY | USB_PP_TYPE_1);
+
+    g_sModel.pui8ULPI[ULPI_FCTL] = ULPI_FCTL_RESET;
+    g_sModel.pui8ULPI[ULPI_OTGCTL] = ULPI_OTGCTL_RESET;
+
+    g_sModel.bEP0StatusIn = false;
+    g_sModel.bEP0StatusOut = false;
+    g_sModel.bEP0TxLast = false;
+    g_sModel.bHostTimeout = false;
+}
+
+//*****************************************************************************
+//
+// Returns whether the controller is asserting its interrupt.
+//
+//*****************************************************************************
+static bool
+ModelIntPending(void)
+{
+    uint8_t *pui8Reg;
+
+    pui8Reg = g_sModel.pui8Reg;
+
+    return(((pui8Reg[USB_O_IS] & pui8Reg[USB_O_IE]) ||
+            (ModelReg16(USB_O_TXIS) & ModelReg16(USB_O_TXIE)) ||
+            (ModelReg16(USB_O_RXIS) & ModelReg16(USB_O_RXIE)) ||
+            ModelReg32(USB_O_DMAINTR) ||
+            (pui8Reg[USB_O_LPMRIS] & pui8Reg[USB_O_LPMIM])) ? true : false);
+}
+
+//*****************************************************************************
+//
+// Calls the USB interrupt handler for as long as the controller asserts its
+// interrupt, unless the interrupt is disabled or the handler is already
+// running.
+//
+//*****************************************************************************
+static void
+ModelIntDispatch(void)
+{
+    uint32_t ui32Calls;
+    uint64_t ui64Start;
+
+    ModelAccessSync();
+
+    //
+    // A host transaction that nobody answered fails at the start of the next
+    // frame.
+    //
+    if(g_sModel.bHostTimeout)
+    {
+        g_sModel.bHostTimeout = false;
+        g_sModel.pui8Reg[USB_O_CSRL0] |= USB_CSRL0_ERROR;
+        ModelReg16Set(USB_O_TXIS, ModelReg16(USB_O_TXIS) | 1);
+
+        do
+        {
+            ModelFrameNext();
+        }
+        while(g_sModel.ui32MicroFrame);
+    }
+
+    if(g_sModel.ui32IntDepth || !g_sModel.bIntEnabled ||
+       g_sModel.bIntMasked || !g_sModel.pfnHandler)
+    {
+        return;
+    }
+
+    for(ui32Calls = 0; ModelIntPending(); ui32Calls++)
+    {
+        if(ui32Calls == MODEL_MAX_INT_CALLS)
+        {
+            ModelError("interrupt not cleared by the handler",
+                       g_sModel.pui8Reg[USB_O_IS]);
+            break;
+        }
+
+        g_sModel.ui32IntDepth++;
+        ui64Start = ModelClock();
+        g_sModel.pfnHandler();
+        ModelAccessSync();
+        g_sModel.sStats.ui64IntTime += ModelClock() - ui64Start;
+        g_sModel.sStats.ui32Interrupts++;
+        g_sModel.ui32IntDepth--;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the next (micro)frame, raising the start of frame interrupt once
+// for each millisecond frame number.
+//
+//*****************************************************************************
+static void
+ModelFrameNext(void)
+{
+    const tModelSpeed *psSpeed;
+    uint32_t ui32Frame;
+
+    psSpeed = &g_psModelSpeeds[g_sModel.ui32Speed];
+
+    g_sModel.ui64FrameStart += psSpeed->ui32FrameTime;
+    if(g_sModel.sStats.ui64BusTime < g_sModel.ui64FrameStart)
+    {
+        g_sModel.sStats.ui64BusTime = g_sModel.ui64FrameStart;
+    }
+    g_sModel.sStats.ui64BusTime += psSpeed->ui32SOFBytes *
+                                   psSpeed->ui32ByteTime;
+    g_sModel.sStats.ui32Frames++;
+
+    if(++g_sModel.ui32MicroFrame == psSpeed->ui32FramesPerMs)
+    {
+        g_sModel.ui32MicroFrame = 0;
+        ui32Frame = (ModelReg16(USB_O_FRAME) + 1) & USB_FRAME_M;
+        ModelReg16Set(USB_O_FRAME, ui32Frame);
+        g_sModel.pui8Reg[USB_O_IS] |= USB_IS_SOF;
+        ModelIntDispatch();
+    }
+}
+
+//*****************************************************************************
+//
+// Accounts for the bus time of a transaction with the given number of data
+// bytes, waiting for the next (micro)frame if it does not fit in this one.
+//
+//*****************************************************************************
+static void
+ModelTransaction(uint32_t ui32Bytes)
+{
+    const tModelSpeed *psSpeed;
+    uint64_t ui64Time;
+
+    psSpeed = &g_psModelSpeeds[g_sModel.ui32Speed];
+    ui64Time = (ui32Bytes + psSpeed->ui32Overhead) * psSpeed->ui32ByteTime;
+
+    while((g_sModel.sStats.ui64BusTime + ui64Time) >
+          (g_sModel.ui64FrameStart + psSpeed->ui32FrameTime))
+    {
+        ModelFrameNext();
+    }
+
+    g_sModel.sStats.ui64BusTime += ui64Time;
+    g_sModel.sStats.ui32Transactions++;
+}
+
+//*****************************************************************************
+//
+// Answers a transaction with a handshake alone.
+//
+//*****************************************************************************
+static uint32_t
+ModelHandshake(uint32_t ui32Handshake)
+{
+    ModelTransaction(0);
+
+    if(ui32Handshake == USBMODEL_NAK)
+    {
+        g_sModel.sStats.ui32NAKs++;
+    }
+    else if(ui32Handshake == USBMODEL_STALL)
+    {
+        g_sModel.sStats.ui32Stalls++;
+    }
+
+    return(ui32Handshake);
+}
+
+//*****************************************************************************
+//
+// Answers a transaction on a stalled endpoint, noting that the stall was sent
+// and raising the endpoint's interrupt.
+//
+//*****************************************************************************
+static uint32_t
+ModelStall(uint32_t ui32EP, bool bTx)
+{
+    if(ui32EP == 0)
+    {
+        g_sModel.pui8Reg[USB_O_CSRL0] &= ~USB_CSRL0_STALL;
+        g_sModel.pui8Reg[USB_O_CSRL0] |= USB_CSRL0_STALLED;
+        g_sModel.pui8Reg[USB_O_TXIS] |= USB_TXIS_EP0;
+    }
+    else if(bTx)
+    {
+        g_sModel.pui8Reg[EPREG(ui32EP, USB_O_TXCSRL1)] |= USB_TXCSRL1_STALLED;
+        g_sModel.pui8Reg[USB_O_TXIS] |= 1 << ui32EP;
+    }
+    else
+    {
+        g_sModel.pui8Reg[EPREG(ui32EP, USB_O_RXCSRL1)] |= USB_RXCSRL1_STALLED;
+        g_sModel.pui8Reg[USB_O_RXIS] |= 1 << ui32EP;
+    }
+
+    ModelHandshake(USBMODEL_STALL);
+    ModelIntDispatch();
+
+    return(USBMODEL_STALL);
+}
+
+//*****************************************************************************
+//
+// Initializes the model with the controller in its reset state, and sets the
+// function to be called for the USB interrupt.
+//
+//*****************************************************************************
+void
+USBModelInit(void (*pfnHandler)(void))
+{
+    memset(&g_sModel, 0, sizeof(g_sModel));
+    ModelControllerReset();
+    g_sModel.pfnHandler = pfnHandler;
+}
+
+//*****************************************************************************
+//
+// Resets the bus, at high speed if the host asks for it and the device has
+// enabled the high speed PHY.  Returns false if the device is not connected.
+//
+//*****************************************************************************
+bool
+USBModelReset(uint32_t ui32Speed)
+{
+    uint32_t ui32EP;
+
+    ModelIntDispatch();
+
+    if(!(g_sModel.pui8Reg[USB_O_POWER] & USB_POWER_SOFTCONN))
+    {
+        return(false);
+    }
+
+    //
+    // The reset lasts for 10ms, with no frames.
+    //
+    g_sModel.sStats.ui64BusTime += 10000000 * MODEL_TIME_PER_NS;
+    g_sModel.ui64FrameStart = g_sModel.sStats.ui64BusTime;
+    g_sModel.ui32MicroFrame = 0;
+
+    if((ui32Speed == USBMODEL_SPEED_HIGH) &&
+       (g_sModel.pui8Reg[USB_O_POWER] & USB_POWER_HSENAB) &&
+       (ModelReg32(USB_O_PC) & USB_PC_ULPIEN) &&
+       ((g_sModel.pui8ULPI[ULPI_FCTL] & ULPI_FCTL_XCVR_M) ==
+        ULPI_FCTL_XCVR_HS))
+    {
+        g_sModel.ui32Speed = USBMODEL_SPEED_HIGH;
+        g_sModel.pui8Reg[USB_O_POWER] |= USB_POWER_HSMODE;
+    }
+    else
+    {
+        g_sModel.ui32Speed = USBMODEL_SPEED_FULL;
+        g_sModel.pui8Reg[USB_O_POWER] &= ~USB_POWER_HSMODE;
+    }
+
+    //
+    // The reset clears the address and any packets in the FIFOs.
+    //
+    g_sModel.pui8Reg[USB_O_FADDR] = 0;
+    for(ui32EP = 0; ui32EP < MODEL_NUM_EPS; ui32EP++)
+    {
+        ModelFIFOFlush(&g_sModel.psTxFIFO[ui32EP]);
+        ModelRxConsume(ui32EP);
+
+        if(ui32EP != 0)
+        {
+            g_sModel.pui8Reg[EPREG(ui32EP, USB_O_TXCSRL1)] = 0;
+            g_sModel.pui8Reg[EPREG(ui32EP, USB_O_RXCSRL1)] = 0;
+        }
+    }
+    g_sModel.pui8Reg[USB_O_CSRL0] = 0;
+    g_sModel.bEP0StatusIn = false;
+    g_sModel.bEP0StatusOut = false;
+    g_sModel.bEP0TxLast = false;
+
+    g_sModel.pui8Reg[USB_O_IS] |= USB_IS_RESET;
+    ModelIntDispatch();
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Returns the speed at which the bus is running.
+//
+//*****************************************************************************
+uint32_t
+USBModelSpeed(void)
+{
+    return(g_sModel.ui32Speed);
+}
+
+//*****************************************************************************
+//
+// Returns the address that the device answers to.
+//
+//*****************************************************************************
+uint32_t
+USBModelAddress(void)
+{
+    ModelAccessSync();
+
+    return(g_sModel.pui8Reg[USB_O_FADDR] & USB_FADDR_M);
+}
+
+//*****************************************************************************
+//
+// Sends a SETUP packet to endpoint zero.  The device cannot refuse it, and a
+// SETUP that arrives before the previous control transfer has finished ends
+// that transfer.
+//
+//*****************************************************************************
+uint32_t
+USBModelSetup(const uint8_t *pui8Request)
+{
+    ModelIntDispatch();
+    ModelTransaction(8);
+    g_sModel.sStats.ui64BytesOut += 8;
+
+    if((g_sModel.pui8Reg[USB_O_CSRL0] & USB_CSRL0_TXRDY) ||
+       g_sModel.bEP0StatusIn || g_sModel.bEP0StatusOut)
+    {
+        g_sModel.pui8Reg[USB_O_CSRL0] |= USB_CSRL0_SETEND;
+        g_sModel.pui8Reg[USB_O_CSRL0] &= ~USB_CSRL0_TXRDY;
+        ModelFIFOFlush(&g_sModel.psTxFIFO[0]);
+        g_sModel.bEP0StatusIn = false;
+        g_sModel.bEP0StatusOut = false;
+    }
+
+    ModelRxPacket(0, pui8Request, 8);
+    g_sModel.pui8Reg[USB_O_TXIS] |= USB_TXIS_EP0;
+    ModelIntDispatch();
+
+    return(USBMODEL_ACK);
+}
+
+//*****************************************************************************
+//
+// Sends an IN token to an endpoint.  On entry *pui32Size is the size of the
+// buffer, and on an ACK it is set to the length of the packet received.
+//
+//*****************************************************************************
+uint32_t
+USBModelIn(uint32_t ui32EP, uint8_t *pui8Data, uint32_t *pui32Size)
+{
+    tModelFIFO *psFIFO;
+    uint8_t *pui8CSRL, ui8CSRH;
+    uint32_t ui32Size;
+
+    ModelIntDispatch();
+
+    psFIFO = &g_sModel.psTxFIFO[ui32EP];
+
+    if(ui32EP == 0)
+    {
+        pui8CSRL = &g_sModel.pui8Reg[USB_O_CSRL0];
+
+        if(*pui8CSRL & USB_CSRL0_STALL)
+        {
+            return(ModelStall(0, true));
+        }
+
+        //
+        // With no packet to send, the status stage of an OUT or no-data
+        // control transfer is a zero-length packet.
+        //
+        if(!(*pui8CSRL & USB_CSRL0_TXRDY))
+        {
+            if(!g_sModel.bEP0StatusIn)
+            {
+                return(ModelHandshake(USBMODEL_NAK));
+            }
+
+            ModelTransaction(0);
+            g_sModel.bEP0StatusIn = false;
+            *pui32Size = 0;
+            g_sModel.pui8Reg[USB_O_TXIS] |= USB_TXIS_EP0;
+            ModelIntDispatch();
+
+            return(USBMODEL_ACK);
+        }
+    }
+    else
+    {
+        pui8CSRL = &g_sModel.pui8Reg[EPREG(ui32EP, USB_O_TXCSRL1)];
+
+        if(*pui8CSRL & USB_TXCSRL1_STALL)
+        {
+            return(ModelStall(ui32EP, true));
+        }
+        if(!(*pui8CSRL & USB_TXCSRL1_TXRDY))
+        {
+            return(ModelHandshake(USBMODEL_NAK));
+        }
+    }
+
+    //
+    // Send the packet in the FIFO.
+    //
+    ui32Size = psFIFO->ui32Count;
+    if(ui32Size > *pui32Size)
+    {
+        ModelError("packet longer than the host's buffer", ui32Size);
+        ui32Size = *pui32Size;
+    }
+    memcpy(pui8Data, psFIFO->pui8Data, ui32Size);
+    *pui32Size = ui32Size;
+    ModelFIFOFlush(psFIFO);
+
+    ModelTransaction(ui32Size);
+    g_sModel.sStats.ui64BytesIn += ui32Size;
+
+    if(ui32EP == 0)
+    {
+        //
+        // The interrupt for the last packet of the data stage is raised when
+        // the status stage completes.
+        //
+        *pui8CSRL &= ~USB_CSRL0_TXRDY;
+        if(g_sModel.bEP0TxLast)
+        {
+            g_sModel.bEP0TxLast = false;
+            g_sModel.bEP0StatusOut = true;
+        }
+        else
+        {
+            g_sModel.pui8Reg[USB_O_TXIS] |= USB_TXIS_EP0;
+        }
+    }
+    else
+    {
+        //
+        // No endpoint interrupt is raised while DMA mode 1 is in use, since
+        // the DMA interrupt marks the end of the transfer.
+        //
+        *pui8CSRL &= ~USB_TXCSRL1_TXRDY;
+        ModelTxFIFOUpdate(ui32EP);
+        ui8CSRH = g_sModel.pui8Reg[EPREG(ui32EP, USB_O_TXCSRH1)];
+
+        if((ui8CSRH & (USB_TXCSRH1_DMAEN | USB_TXCSRH1_DMAMOD)) !=
+           (USB_TXCSRH1_DMAEN | USB_TXCSRH1_DMAMOD))
+        {
+            g_sModel.pui8Reg[USB_O_TXIS] |= 1 << ui32EP;
+        }
+        ModelDMARun();
+    }
+
+    ModelIntDispatch();
+
+    return(USBMODEL_ACK);
+}
+
+//*****************************************************************************
+//
+// Sends an OUT packet to an endpoint.
+//
+//*****************************************************************************
+uint32_t
+USBModelOut(uint32_t ui32EP, const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint8_t *pui8CSRL, ui8CSRH;
+
+    ModelIntDispatch();
+
+    if(ui32EP == 0)
+    {
+        pui8CSRL = &g_sModel.pui8Reg[USB_O_CSRL0];
+
+        if(*pui8CSRL & USB_CSRL0_STALL)
+        {
+            return(ModelStall(0, false));
+        }
+
+        //
+        // The status stage of an IN control transfer.
+        //
+        if(g_sModel.bEP0StatusOut && (ui32Size == 0))
+        {
+            ModelTransaction(0);
+            g_sModel.bEP0StatusOut = false;
+            g_sModel.pui8Reg[USB_O_TXIS] |= USB_TXIS_EP0;
+            ModelIntDispatch();
+
+            return(USBMODEL_ACK);
+        }
+
+        if(*pui8CSRL & USB_CSRL0_RXRDY)
+        {
+            return(ModelHandshake(USBMODEL_NAK));
+        }
+        if(ui32Size > 64)
+        {
+            ModelError("endpoint zero packet too long", ui32Size);
+            ui32Size = 64;
+        }
+
+        ModelTransaction(ui32Size);
+        g_sModel.sStats.ui64BytesOut += ui32Size;
+        ModelRxPacket(0, pui8Data, ui32Size);
+        g_sModel.pui8Reg[USB_O_TXIS] |= USB_TXIS_EP0;
+    }
+    else
+    {
+        pui8CSRL = &g_sModel.pui8Reg[EPREG(ui32EP, USB_O_RXCSRL1)];
+
+        if(*pui8CSRL & USB_RXCSRL1_STALL)
+        {
+            return(ModelStall(ui32EP, false));
+        }
+        if(*pui8CSRL & USB_RXCSRL1_RXRDY)
+        {
+            return(ModelHandshake(USBMODEL_NAK));
+        }
+        if(ui32Size > ModelMaxPacket(ui32EP, false))
+        {
+            ModelError("packet longer than the maximum packet size", ui32EP);
+            ui32Size = ModelMaxPacket(ui32EP, false);
+        }
+
+        ModelTransaction(ui32Size);
+        g_sModel.sStats.ui64BytesOut += ui32Size;
+        ModelRxPacket(ui32EP, pui8Data, ui32Size);
+
+        ui8CSRH = g_sModel.pui8Reg[EPREG(ui32EP, USB_O_RXCSRH1)];
+        if((ui8CSRH & (USB_RXCSRH1_DMAEN | USB_RXCSRH1_DMAMOD)) !=
+           (USB_RXCSRH1_DMAEN | USB_RXCSRH1_DMAMOD))
+        {
+            g_sModel.pui8Reg[USB_O_RXIS] |= 1 << ui32EP;
+        }
+        ModelDMARun();
+    }
+
+    ModelIntDispatch();
+
+    return(USBMODEL_ACK);
+}
+
+//*****************************************************************************
+//
+// Lets the bus run idle for the given number of nanoseconds.
+//
+//*****************************************************************************
+void
+USBModelWait(uint64_t ui64Time)
+{
+    const tModelSpeed *psSpeed;
+    uint64_t ui64End;
+
+    ModelIntDispatch();
+
+    psSpeed = &g_psModelSpeeds[g_sModel.ui32Speed];
+    ui64End = g_sModel.sStats.ui64BusTime + (ui64Time * MODEL_TIME_PER_NS);
+
+    while((g_sModel.ui64FrameStart + psSpeed->ui32FrameTime) <= ui64End)
+    {
+        ModelFrameNext();
+    }
+
+    if(g_sModel.sStats.ui64BusTime < ui64End)
+    {
+        g_sModel.sStats.ui64BusTime = ui64End;
+    }
+}
+
+//*****************************************************************************
+//
+// Applies any access still waiting, and handles any interrupt that the
+// software has raised since the bus was last used.
+//
+//*****************************************************************************
+void
+USBModelSync(void)
+{
+    ModelIntDispatch();
+}
+
+//*****************************************************************************
+//
+// Returns the counts and times gathered by the model, with the bus time in
+// nanoseconds.
+//
+//*****************************************************************************
+void
+USBModelStatsGet(tUSBModelStats *psStats)
+{
+    ModelAccessSync();
+
+    *psStats = g_sModel.sStats;
+    psStats->ui64BusTime /= MODEL_TIME_PER_NS;
+}
+
+//*****************************************************************************
+//
+// Counts a failed ASSERT in the USB library or in driverlib.
+//
+//*****************************************************************************
+void
+__error__(char *pcFilename, uint32_t ui32Line)
+{
+    g_sModel.sStats.ui32Errors++;
+    printf("usbmodel: ASSERT failed at %s:%u\n", pcFilename,
+           (unsigned)ui32Line);
+}
+
+//*****************************************************************************
+//
+// Interrupt controller functions used by the USB library.  Only the USB
+// interrupt is modeled, and unmasking it handles anything pending at once.
+//
+//*****************************************************************************
+bool
+IntMasterDisable(void)
+{
+    bool bMasked;
+
+    bMasked = g_sModel.bIntMasked;
+    g_sModel.bIntMasked = true;
+
+    return(bMasked);
+}
+
+bool
+IntMasterEnable(void)
+{
+    bool bMasked;
+
+    bMasked = g_sModel.bIntMasked;
+    g_sModel.bIntMasked = false;
+    ModelIntDispatch();
+
+    return(bMasked);
+}
+
+void
+IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void))
+{
+    if(ui32Interrupt == INT_USB0_TM4C129)
+    {
+        g_sModel.pfnHandler = pfnHandler;
+    }
+}
+
+void
+IntUnregister(uint32_t ui32Interrupt)
+{
+}
+
+void
+IntEnable(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt == INT_USB0_TM4C129)
+    {
+        g_sModel.bIntEnabled = true;
+        ModelIntDispatch();
+    }
+}
+
+void
+IntDisable(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt == INT_USB0_TM4C129)
+    {
+        g_sModel.bIntEnabled = false;
+    }
+}
+
+uint32_t
+IntIsEnabled(uint32_t ui32Interrupt)
+{
+    return(((ui32Interrupt == INT_USB0_TM4C129) && g_sModel.bIntEnabled) ?
+           1 : 0);
+}
+
+//*****************************************************************************
+//
+// System control functions used by the USB library.  Resetting the USB
+// controller puts the model in its reset state.
+//
+//*****************************************************************************
+void
+SysCtlPeripheralReset(uint32_t ui32Peripheral)
+{
+    if(ui32Peripheral == SYSCTL_PERIPH_USB0)
+    {
+        ModelControllerReset();
+    }
+}
+
+void
+SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+}
+
+void
+SysCtlPeripheralDisable(uint32_t ui32Peripheral)
+{
+}
+
+void
+SysCtlUSBPLLEnable(void)
+{
+}
+
+void
+SysCtlUSBPLLDisable(void)
+{
+}
+
+void
+SysCtlDelay(uint32_t ui32Count)
+{
+}
+
+uint32_t
+SysCtlClockGet(void)
+{
+    return(120000000);
+}
+
+//*****************************************************************************
+//
+// The model's controller has the integrated DMA controller, so the USB
+// library never uses the uDMA controller.
+//
+//*****************************************************************************
+void
+uDMAChannelEnable(uint32_t ui32ChannelNum)
+{
+    ModelError("uDMA used with the integrated DMA controller", ui32ChannelNum);
+}
+
+void
+uDMAChannelDisable(uint32_t ui32ChannelNum)
+{
+    ModelError("uDMA used with the integrated DMA controller", ui32ChannelNum);
+}
+
+void
+uDMAChannelAttributeDisable(uint32_t ui32ChannelNum, uint32_t ui32Attr)
+{
+    ModelError("uDMA used with the integrated DMA controller", ui32ChannelNum);
+}
+
+void
+uDMAChannelControlSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Control)
+{
+    ModelError("uDMA used with the integrated DMA controller",
+               ui32ChannelStructIndex);
+}
+
+void
+uDMAChannelTransferSet(uint32_t ui32ChannelStructIndex, uint32_t ui32Mode,
+                       void *pvSrcAddr, void *pvDstAddr,
+                       uint32_t ui32TransferSize)
+{
+    ModelError("uDMA used with the integrated DMA controller",
+               ui32ChannelStructIndex);
+}
+
+uint32_t
+uDMAChannelModeGet(uint32_t ui32ChannelStructIndex)
+{
+    ModelError("uDMA used with the integrated DMA controller",
+               ui32ChannelStructIndex);
+
+    return(0);
+}
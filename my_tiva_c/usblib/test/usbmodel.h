@@ -0,0 +1,174 @@
+//*****************************************************************************
+//
+// usbmodel.h - A USB controller model for the USB library host build.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva USB Library.
+//
+//*****************************************************************************
+
+#ifndef __USBMODEL_H__
+#define __USBMODEL_H__
+
+//*****************************************************************************
+//
+// This header is included ahead of every source file of the host build, so
+// that the USB library and the driverlib USB functions reach the model
+// rather than the hardware.  The model is of a TM4C129-class USB controller,
+// which has the integrated DMA controller and the ULPI interface used for
+// high speed operation.
+//
+//*****************************************************************************
+#include <stdbool.h>
+#include <stdint.h>
+
+#define CLASS_IS_TM4C123        0
+#define CLASS_IS_TM4C129        1
+
+#include "inc/hw_types.h"
+
+//*****************************************************************************
+//
+// Every register access is redirected to the model, which returns the
+// location that the access reads or writes.  The model sees each access when
+// it is made, and applies the side effects of the access when the next
+// access is made or when the bus is next used.  Accesses to a register of
+// any width are made through a 32-bit location, which allows the model to
+// tell a read of an endpoint FIFO from a write.  The bit-band aliases are
+// used by the USB library on its own variables, so the model applies those
+// accesses directly to memory.
+//
+//*****************************************************************************
+extern volatile uint32_t *USBModelReg(uintptr_t uiAddr, uint32_t ui32Size);
+extern volatile uint32_t *USBModelBit(volatile void *pvAddr, uint32_t ui32Size,
+                                      uint32_t ui32Bit);
+
+#undef HWREG
+#undef HWREGH
+#undef HWREGB
+#undef HWREGBITW
+#undef HWREGBITH
+#undef HWREGBITB
+#define HWREG(x)                (*USBModelReg((uintptr_t)(x), 4))
+#define HWREGH(x)               (*USBModelReg((uintptr_t)(x), 2))
+#define HWREGB(x)               (*USBModelReg((uintptr_t)(x), 1))
+#define HWREGBITW(x, b)         (*USBModelBit((x), 4, (b)))
+#define HWREGBITH(x, b)         (*USBModelBit((x), 2, (b)))
+#define HWREGBITB(x, b)         (*USBModelBit((x), 1, (b)))
+
+//*****************************************************************************
+//
+// The speeds at which the model's host can run the bus.
+//
+//*****************************************************************************
+#define USBMODEL_SPEED_FULL     0
+#define USBMODEL_SPEED_HIGH     1
+
+//*****************************************************************************
+//
+// The handshakes with which the device can answer a transaction.
+//
+//*****************************************************************************
+#define USBMODEL_ACK            0
+#define USBMODEL_NAK            1
+#define USBMODEL_STALL          2
+
+//*****************************************************************************
+//
+// The counts and times gathered by the model.  Bus times are in nanoseconds
+// of simulated bus time, and include the time taken by transactions and by
+// the start of frame packets, and any time that the host spends waiting.
+// The interrupt handler time is measured in nanoseconds with the host's
+// clock.  The register access counts do not depend on the host, so are the
+// best measure of the cost of the library for a regression test.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The simulated time since the model was initialized.
+    //
+    uint64_t ui64BusTime;
+
+    //
+    // The time spent in the USB interrupt handler.
+    //
+    uint64_t ui64IntTime;
+
+    //
+    // The number of calls made to the USB interrupt handler.
+    //
+    uint32_t ui32Interrupts;
+
+    //
+    // The number of register reads and writes made by the software.
+    //
+    uint32_t ui32RegReads;
+    uint32_t ui32RegWrites;
+
+    //
+    // The number of transactions, and the number of those which were
+    // answered with NAK or with STALL.
+    //
+    uint32_t ui32Transactions;
+    uint32_t ui32NAKs;
+    uint32_t ui32Stalls;
+
+    //
+    // The number of frames started.
+    //
+    uint32_t ui32Frames;
+
+    //
+    // The number of data bytes sent by the device and by the host.
+    //
+    uint64_t ui64BytesIn;
+    uint64_t ui64BytesOut;
+
+    //
+    // The number of bytes moved by the USB DMA controller.
+    //
+    uint64_t ui64DMABytes;
+
+    //
+    // The number of errors found by the model, including failed ASSERTs in
+    // the software and accesses that the model does not support.
+    //
+    uint32_t ui32Errors;
+}
+tUSBModelStats;
+
+//*****************************************************************************
+//
+// Prototypes for the model.
+//
+//*****************************************************************************
+extern void USBModelInit(void (*pfnHandler)(void));
+extern bool USBModelReset(uint32_t ui32Speed);
+extern uint32_t USBModelSpeed(void);
+extern uint32_t USBModelAddress(void);
+extern uint32_t USBModelSetup(const uint8_t *pui8Request);
+extern uint32_t USBModelIn(uint32_t ui32Endpoint, uint8_t *pui8Data,
+                           uint32_t *pui32Size);
+extern uint32_t USBModelOut(uint32_t ui32Endpoint, const uint8_t *pui8Data,
+                            uint32_t ui32Size);
+extern void USBModelWait(uint64_t ui64Time);
+extern void USBModelSync(void);
+extern void USBModelStatsGet(tUSBModelStats *psStats);
+
+#endif // __USBMODEL_H__
@@ -0,0 +1,4174 @@
+//*****************************************************************************
+//
+// usbsim.c - A USB traffic generator for the USB library host build.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva USB Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "driverlib/usb.h"
+#include "usblib/usblib.h"
+#include "usblib/usbaudio.h"
+#include "usblib/usbcdc.h"
+#include "usblib/usbhid.h"
+#include "usblib/usbmsc.h"
+#include "usblib/usb-ids.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdaudio.h"
+#include "usblib/device/usbdbulk.h"
+#include "usblib/device/usbdcomp.h"
+#include "usblib/device/usbdhid.h"
+#include "usblib/device/usbdhidmouse.h"
+#include "usblib/device/usbdncm.h"
+#include "usblib/host/usbhost.h"
+#include "usblib/host/usbhostpriv.h"
+#include "usblib/host/usbhmsc.h"
+#include "usblib/host/usbhscsi.h"
+#include "utils/test/test.h"
+#include "usbmodel.h"
+
+//*****************************************************************************
+//
+// This program runs the USB library, built for the host, as a device on the
+// model of the USB controller, and acts as the USB host to it.  The traffic
+// is described by a script, which is a text file with one command on each
+// line.  Blank lines, and anything following a '#', are ignored.
+//
+// device bulk|ncm|mouse|composite full|high
+// device audio full [rate [bits]]
+//     Starts the generic bulk device class, the NCM device class, the HID
+//     mouse device class or a composite device made up of the bulk device
+//     and the HID mouse, with or without the high speed ULPI PHY enabled, or
+//     the audio device class with an asynchronous OUT endpoint and the given
+//     sample format.  The default format is 48000Hz with 16 bit samples.
+//
+// reset [full|high]
+//     Resets the bus, at high speed if it is asked for and the device
+//     supports it.  The default is the speed of the last reset.
+//
+// cache
+//     Compiles the device's configuration descriptor and registers it with
+//     the device controller driver using USBDCDConfigCacheInit().
+//
+// enumerate [count]
+//     Enumerates the device the way that Linux does, count times, and
+//     reports the time, the interrupts and the register accesses that each
+//     enumeration takes.  A device that returns a device qualifier must also
+//     return its other speed configuration.
+//
+// control count
+//     Sends a storm of standard requests to endpoint zero, and reports the
+//     latency of each request.
+//
+// bulk-out bytes [transfer size|packet]
+// bulk-in bytes [transfer size|packet]
+//     Streams bytes to or from the bulk device, which uses the transfer API
+//     with transfers of the given size or the packet API, and reports the
+//     throughput and the cost of each packet.
+//
+// ncm-out frames size [hold]
+// ncm-in frames size
+//     Sends frames of the given size to or from the NCM device, aggregated
+//     into NTBs of up to 2048 bytes, and reports the frame rate and the cost
+//     of each frame.  With hold, the device holds on to received datagrams
+//     while more than one of its NTB buffers is free, the way that lwiplib.c
+//     passes them to lwIP, and releases them when the command ends.
+//
+// audio-start
+//     Finds the format and the endpoints of the audio device's streaming
+//     interface, selects the interface's active setting, and reads the first
+//     feedback value.  Reports the sample format and the offsets of the
+//     descriptors from the start of the streaming interface, which are the
+//     offsets at which the audio device patches the format in.
+//
+// audio-ring bytes period
+//     Gives the audio device a ring of the given size, which reports each
+//     period of data received.
+//
+// audio-out packets size codec-bytes
+//     Sends packets of the given size to the audio device, one in each
+//     frame, and reads the feedback endpoint after each.  In each frame the
+//     codec plays codec-bytes from the ring, and the count of its samples is
+//     reported to the audio device for the feedback value.  Reports the
+//     packets that the ring had no room for, the frames in which the codec
+//     found the ring empty, the level of the ring, the bytes moved by DMA,
+//     and the last feedback value.
+//
+// mouse reports dx dy poll [click]
+//     Moves the HID mouse by dx,dy in each of the given number of frames,
+//     pressing or releasing its first button each time if click is given,
+//     while the host reads its interrupt IN endpoint only once every poll
+//     frames.  The host then reads the reports still queued.  Reports the
+//     calls to USBDHIDMouseStateChange() that failed, the reports queued,
+//     coalesced, dropped and sent by the HID device, the reports received
+//     by the host, the sum of their movement, the number of times that their
+//     buttons changed, and the highest bin of the HID device's latency
+//     histogram that is in use.
+//
+// request interface|endpoint number
+//     Sends a HID Get_Report request for the input report to the given
+//     interface or endpoint, and reports whether the device answered it,
+//     stalled it or did not answer it at all.
+//
+// composite
+//     Reports, for each device in the composite device, the endpoint events
+//     that the composite device class passed to it and those that it was
+//     spared, and the requests and endpoint zero data events passed to it,
+//     then clears the counts.
+//
+// host full|high
+//     Starts the USB library as a host instead of a device, for devices of
+//     the given speed.  Nothing is attached to the model's host port, so the
+//     host commands give the class drivers simulated devices instead, and
+//     any request that the host controller driver sends to endpoint zero
+//     fails.
+//
+// msc blocks cache-blocks
+//     Opens the mass storage class driver on a simulated drive with the
+//     given number of 512 byte blocks, and gives the driver a cache of
+//     cache-blocks blocks.  The drive's SCSI commands are answered by this
+//     program, which provides the functions of usbhscsi.c in their place.
+//
+// msc-read lba blocks [count]
+// msc-write lba blocks [count]
+// msc-flush
+//     Reads or writes count runs of blocks through the mass storage class
+//     driver, each run following on from the last, or flushes the driver's
+//     cache.  Reports the calls that failed, the READ(10) and WRITE(10)
+//     commands and the blocks that reached the drive, the sense key, any
+//     data read that was wrong, and the blocks that the drive has yet to be
+//     sent.
+//
+// periodic intr|isoc size interval count
+//     Opens count interrupt or isochronous pipes to the host's simulated
+//     device, alternately IN and OUT, with packets of the given size and the
+//     given polling interval.  Reports the pipes that the host controller
+//     driver accepted and those that it refused for want of periodic
+//     bandwidth, then frees them all again.
+//
+// schedule pipes frames
+//     Opens the given number of interrupt IN pipes, all of which are due in
+//     every frame, and runs them for the given number of frames.  Reports
+//     the fewest and the most scheduler events given to a pipe, and the
+//     fewest and the most frames in which a pipe was given the first event.
+//
+// wait ms
+//     Lets the bus run idle.
+//
+// expect metric <|<=|==|>=|> value
+//     Checks a metric reported by the last command.  The metrics depend only
+//     on the model's simulated bus time and on the register accesses made by
+//     the library, so do not vary from one host to another.
+//
+// Each command reports its results on a single line, and the program exits
+// with a non-zero status if any command or expectation fails.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The number of NAKs in a row after which the host gives up on an endpoint.
+//
+//*****************************************************************************
+#define HOST_NAK_LIMIT          10000
+
+//*****************************************************************************
+//
+// The result of a control transfer which the device did not complete.
+//
+//*****************************************************************************
+#define HOST_TIMEOUT            3
+
+//*****************************************************************************
+//
+// The address assigned to the device during enumeration.
+//
+//*****************************************************************************
+#define HOST_ADDRESS            5
+
+//*****************************************************************************
+//
+// The largest stream, and the largest transfer, that the bulk commands can
+// send.
+//
+//*****************************************************************************
+#define SIM_STREAM_MAX          (1024 * 1024)
+#define SIM_XFER_MAX            (64 * 1024)
+
+//*****************************************************************************
+//
+// The size of the workspace for the compiled configuration descriptor.
+//
+//*****************************************************************************
+#define SIM_CACHE_SIZE          512
+
+//*****************************************************************************
+//
+// The block size of the simulated drive, the largest drive, and the largest
+// cache that the mass storage class driver can be given.
+//
+//*****************************************************************************
+#define SIM_MSC_BLOCK_SIZE      512
+#define SIM_MSC_MAX_BLOCKS      256
+#define SIM_MSC_CACHE_MAX       16
+
+//*****************************************************************************
+//
+// The largest run of blocks that msc-read and msc-write can ask for in one
+// call, and the additional sense code for a logical block address that is
+// out of range.
+//
+//*****************************************************************************
+#define SIM_MSC_RUN_MAX         32
+#define SIM_MSC_ASC_LBA_RANGE   0x21
+
+//*****************************************************************************
+//
+// The size of the memory that the host controller driver reads descriptors
+// into.
+//
+//*****************************************************************************
+#define SIM_HOST_POOL_SIZE      256
+
+//*****************************************************************************
+//
+// The largest number of periodic pipes that the pipe commands can open.  The
+// model's host controller has three endpoints in each direction besides
+// endpoint zero.
+//
+//*****************************************************************************
+#define SIM_PIPES_MAX           6
+
+//*****************************************************************************
+//
+// The device classes that the device command can start.
+//
+//*****************************************************************************
+#define SIM_DEVICE_BULK         0
+#define SIM_DEVICE_NCM          1
+#define SIM_DEVICE_AUDIO        2
+#define SIM_DEVICE_MOUSE        3
+#define SIM_DEVICE_COMPOSITE    4
+
+static const char * const g_ppcDeviceClasses[] =
+{
+    "bulk",
+    "ncm",
+    "audio",
+    "mouse",
+    "composite"
+};
+
+#define NUM_DEVICE_CLASSES      (sizeof(g_ppcDeviceClasses) /                 \
+                                 sizeof(g_ppcDeviceClasses[0]))
+
+//*****************************************************************************
+//
+// The largest ring that the audio device can be given, and the largest
+// packet that audio-out can send.
+//
+//*****************************************************************************
+#define SIM_AUDIO_RING_MAX      8192
+#define SIM_AUDIO_PACKET_MAX    1024
+
+//*****************************************************************************
+//
+// The largest number of metrics that a command can report.
+//
+//*****************************************************************************
+#define SIM_MAX_METRICS         16
+
+//*****************************************************************************
+//
+// The size of the NCM device's receive buffer, the size of the NTBs that the
+// host sends to it, and the largest number of received datagrams that the
+// device holds on to.
+//
+//*****************************************************************************
+#define SIM_NCM_RX_SIZE         (USBDNCM_RX_NTB_BUFFERS *                     \
+                                 USBDNCM_NTB_OUT_MIN_SIZE)
+#define SIM_NCM_NTB_SIZE        USBDNCM_NTB_OUT_MIN_SIZE
+#define SIM_NCM_HOLD            8
+
+//*****************************************************************************
+//
+// The string descriptors of the bulk device and of the NCM device.
+//
+//*****************************************************************************
+static const uint8_t g_pui8LangDescriptor[] =
+{
+    4,
+    USB_DTYPE_STRING,
+    USBShort(USB_LANG_EN_US)
+};
+
+static const uint8_t g_pui8ManufacturerString[] =
+{
+    (17 + 1) * 2,
+    USB_DTYPE_STRING,
+    'T', 0, 'e', 0, 'x', 0, 'a', 0, 's', 0, ' ', 0, 'I', 0, 'n', 0, 's', 0,
+    't', 0, 'r', 0, 'u', 0, 'm', 0, 'e', 0, 'n', 0, 't', 0, 's', 0,
+};
+
+static const uint8_t g_pui8ProductString[] =
+{
+    (11 + 1) * 2,
+    USB_DTYPE_STRING,
+    'U', 0, 'S', 0, 'B', 0, ' ', 0, 'T', 0, 'r', 0, 'a', 0, 'f', 0, 'f', 0,
+    'i', 0, 'c', 0
+};
+
+static const uint8_t g_pui8SerialNumberString[] =
+{
+    (8 + 1) * 2,
+    USB_DTYPE_STRING,
+    '1', 0, '2', 0, '3', 0, '4', 0, '5', 0, '6', 0, '7', 0, '8', 0
+};
+
+static const uint8_t g_pui8DataInterfaceString[] =
+{
+    (4 + 1) * 2,
+    USB_DTYPE_STRING,
+    'B', 0, 'u', 0, 'l', 0, 'k', 0
+};
+
+static const uint8_t g_pui8ConfigString[] =
+{
+    (7 + 1) * 2,
+    USB_DTYPE_STRING,
+    'D', 0, 'e', 0, 'f', 0, 'a', 0, 'u', 0, 'l', 0, 't', 0
+};
+
+static const uint8_t g_pui8ControlInterfaceString[] =
+{
+    (3 + 1) * 2,
+    USB_DTYPE_STRING,
+    'N', 0, 'C', 0, 'M', 0
+};
+
+static const uint8_t g_pui8MACAddressString[] =
+{
+    (12 + 1) * 2,
+    USB_DTYPE_STRING,
+    '0', 0, '2', 0, '1', 0, 'A', 0, 'B', 0, '6', 0, '0', 0, '0', 0, '0', 0,
+    '0', 0, '0', 0, '1', 0
+};
+
+static const uint8_t * const g_ppui8StringDescriptors[] =
+{
+    g_pui8LangDescriptor,
+    g_pui8ManufacturerString,
+    g_pui8ProductString,
+    g_pui8SerialNumberString,
+    g_pui8DataInterfaceString,
+    g_pui8ConfigString
+};
+
+#define NUM_STRING_DESCRIPTORS  (sizeof(g_ppui8StringDescriptors) /           \
+                                 sizeof(uint8_t *))
+
+static const uint8_t * const g_ppui8NCMStringDescriptors[] =
+{
+    g_pui8LangDescriptor,
+    g_pui8ManufacturerString,
+    g_pui8ProductString,
+    g_pui8SerialNumberString,
+    g_pui8ControlInterfaceString,
+    g_pui8ConfigString,
+    g_pui8MACAddressString
+};
+
+#define NUM_NCM_STRING_DESCRIPTORS                                            \
+                                (sizeof(g_ppui8NCMStringDescriptors) /        \
+                                 sizeof(uint8_t *))
+
+//*****************************************************************************
+//
+// The callbacks of the bulk device and of the NCM device.
+//
+//*****************************************************************************
+static uint32_t RxHandler(void *pvCBData, uint32_t ui32Event,
+                          uint32_t ui32MsgValue, void *pvMsgData);
+static uint32_t TxHandler(void *pvCBData, uint32_t ui32Event,
+                          uint32_t ui32MsgValue, void *pvMsgData);
+static uint32_t NCMRxHandler(void *pvCBData, uint32_t ui32Event,
+                             uint32_t ui32MsgValue, void *pvMsgData);
+static uint32_t NCMTxHandler(void *pvCBData, uint32_t ui32Event,
+                             uint32_t ui32MsgValue, void *pvMsgData);
+static uint32_t AudioHandler(void *pvCBData, uint32_t ui32Event,
+                             uint32_t ui32MsgValue, void *pvMsgData);
+static uint32_t MouseHandler(void *pvCBData, uint32_t ui32Event,
+                             uint32_t ui32MsgValue, void *pvMsgData);
+
+//*****************************************************************************
+//
+// The bulk device.
+//
+//*****************************************************************************
+static tUSBDBulkDevice g_sBulkDevice =
+{
+    USB_VID_TI_1CBE,
+    USB_PID_BULK,
+    500,
+    USB_CONF_ATTR_SELF_PWR,
+    RxHandler,
+    (void *)&g_sBulkDevice,
+    TxHandler,
+    (void *)&g_sBulkDevice,
+    g_ppui8StringDescriptors,
+    NUM_STRING_DESCRIPTORS
+};
+
+//*****************************************************************************
+//
+// The NCM device, and the word aligned buffer that it receives NTBs into.
+// The frames that it sends are contiguous, so it needs no function to find
+// their data.
+//
+//*****************************************************************************
+static uint32_t g_pui32NCMRxBuffer[SIM_NCM_RX_SIZE / 4];
+
+static tUSBDNCMDevice g_sNCMDevice =
+{
+    USB_VID_TI_1CBE,
+    USB_PID_BULK,
+    500,
+    USB_CONF_ATTR_SELF_PWR,
+    NCMRxHandler,
+    (void *)&g_sNCMDevice,
+    NCMTxHandler,
+    (void *)&g_sNCMDevice,
+    0,
+    (uint8_t *)g_pui32NCMRxBuffer,
+    SIM_NCM_RX_SIZE,
+    g_ppui8NCMStringDescriptors,
+    NUM_NCM_STRING_DESCRIPTORS
+};
+
+//*****************************************************************************
+//
+// The HID mouse device, which queues the reports that the host has yet to
+// collect and merges the movement of those with the same buttons.
+//
+//*****************************************************************************
+static tUSBDHIDMouseDevice g_sMouseDevice =
+{
+    USB_VID_TI_1CBE,
+    USB_PID_MOUSE,
+    500,
+    USB_CONF_ATTR_SELF_PWR,
+    MouseHandler,
+    (void *)&g_sMouseDevice,
+    g_ppui8StringDescriptors,
+    NUM_STRING_DESCRIPTORS
+};
+
+//*****************************************************************************
+//
+// The composite device, which is made up of the bulk device and the HID
+// mouse, in that order, and the memory that its configuration descriptor is
+// built in.
+//
+//*****************************************************************************
+#define SIM_COMPOSITE_BULK      0
+#define SIM_COMPOSITE_MOUSE     1
+#define SIM_COMPOSITE_DEVICES   2
+#define SIM_COMPOSITE_SIZE      (COMPOSITE_DBULK_SIZE + COMPOSITE_DHID_SIZE)
+
+static tCompositeEntry g_psCompositeEntries[SIM_COMPOSITE_DEVICES];
+static uint8_t g_pui8CompositeDescriptor[SIM_COMPOSITE_SIZE];
+
+static tUSBDCompositeDevice g_sCompositeDevice =
+{
+    USB_VID_TI_1CBE,
+    USB_PID_COMP_HID_SER,
+    500,
+    USB_CONF_ATTR_SELF_PWR,
+    0,
+    g_ppui8StringDescriptors,
+    NUM_STRING_DESCRIPTORS,
+    SIM_COMPOSITE_DEVICES,
+    g_psCompositeEntries
+};
+
+//*****************************************************************************
+//
+// The value of a HID Get_Report request for the input report with no report
+// ID.
+//
+//*****************************************************************************
+#define SIM_HID_INPUT_REPORT    0x0100
+
+//*****************************************************************************
+//
+// The audio device, which is made when the device is started since its
+// sample format is given by the script, and the word aligned ring that it
+// writes the audio data to.
+//
+//*****************************************************************************
+static tUSBDAudioDevice *g_psAudioDevice;
+static uint32_t g_pui32AudioRing[SIM_AUDIO_RING_MAX / 4];
+
+//*****************************************************************************
+//
+// The state of the application on the device.  The buffers are word aligned
+// so that the bulk device can use DMA for them.
+//
+//*****************************************************************************
+static struct
+{
+    //
+    // The SIM_DEVICE_* class of the device.
+    //
+    uint32_t ui32Class;
+
+    //
+    // Whether the host has selected the configuration, or for the NCM
+    // device, has brought the link up.
+    //
+    bool bConnected;
+
+    //
+    // Whether the transfer API is used, and the size of each transfer.
+    //
+    bool bTransfer;
+    uint32_t ui32XferSize;
+
+    //
+    // The number of bytes of the stream received, the number of those that
+    // did not match the stream's pattern, and the number of bytes expected.
+    //
+    uint32_t ui32RxCount;
+    uint32_t ui32RxBad;
+    uint32_t ui32RxSize;
+
+    //
+    // The number of bytes of the stream given to the bulk device to send,
+    // and the number to be sent.
+    //
+    uint32_t ui32TxCount;
+    uint32_t ui32TxSize;
+
+    //
+    // Whether a transmission is in progress.
+    //
+    bool bTxBusy;
+
+    //
+    // The size of the frames sent to and by the NCM device, the number of
+    // frames that it has received, and the number of frames that it is to
+    // send, has queued and has sent.
+    //
+    uint32_t ui32FrameSize;
+    uint32_t ui32RxFrames;
+    uint32_t ui32TxFrames;
+    uint32_t ui32TxQueued;
+    uint32_t ui32TxDone;
+
+    //
+    // Whether the NCM device holds on to received datagrams, and the
+    // datagrams that it holds.
+    //
+    bool bHold;
+    uint32_t ui32Held;
+    const uint8_t *ppui8Held[SIM_NCM_HOLD];
+
+    //
+    // The number of bytes of the audio stream sent by the host, the number
+    // of periods reported by the audio device, and the number of frames in
+    // which the codec found the ring empty.
+    //
+    uint32_t ui32AudioSent;
+    uint32_t ui32Periods;
+    uint32_t ui32Underruns;
+}
+g_sApp;
+
+static uint32_t g_pui32RxBuffer[SIM_XFER_MAX / 4];
+static uint32_t g_pui32CacheWorkspace[SIM_CACHE_SIZE / 4];
+static tConfigCache g_sConfigCache;
+static uint32_t g_pui32TxBuffer[SIM_STREAM_MAX / 4];
+
+//*****************************************************************************
+//
+// The state of the host.
+//
+//*****************************************************************************
+static struct
+{
+    //
+    // The speed of the last reset.
+    //
+    uint32_t ui32Speed;
+
+    //
+    // The maximum packet size of endpoint zero.
+    //
+    uint32_t ui32MaxPacket0;
+
+    //
+    // The bulk endpoints and their maximum packet sizes, found in the
+    // configuration descriptor.
+    //
+    uint32_t ui32InEP;
+    uint32_t ui32InMaxPacket;
+    uint32_t ui32OutEP;
+    uint32_t ui32OutMaxPacket;
+
+    //
+    // The interface and alternate setting that hold the bulk endpoints.
+    //
+    uint32_t ui32DataInterface;
+    uint32_t ui32DataAltSetting;
+
+    //
+    // The total length of the configuration descriptor.
+    //
+    uint32_t ui32ConfigSize;
+
+    //
+    // Set if the device returned a device qualifier, and the maximum packet
+    // size of the bulk IN endpoint in its other speed configuration.
+    //
+    bool bQualifier;
+    uint32_t ui32OtherMaxPacket;
+
+    //
+    // The isochronous OUT endpoint of the audio device, and its feedback
+    // endpoint.
+    //
+    uint32_t ui32IsocEP;
+    uint32_t ui32FeedbackEP;
+
+    //
+    // The interrupt IN endpoint of the HID mouse, the number of reports read
+    // from it, the sums of their movement, and the number of times that
+    // their buttons changed.
+    //
+    uint32_t ui32IntEP;
+    uint32_t ui32Reports;
+    int32_t i32X;
+    int32_t i32Y;
+    uint32_t ui32Clicks;
+    uint8_t ui8Buttons;
+}
+g_sHost;
+
+//*****************************************************************************
+//
+// The class drivers registered when the library runs as a host, and the
+// memory that the host controller driver reads descriptors into.
+//
+//*****************************************************************************
+static const tUSBHostClassDriver * const g_ppsHostClassDrivers[] =
+{
+    &g_sUSBHostMSCClassDriver
+};
+
+#define NUM_HOST_CLASS_DRIVERS  (sizeof(g_ppsHostClassDrivers) /              \
+                                 sizeof(g_ppsHostClassDrivers[0]))
+
+static uint8_t g_pui8HostPool[SIM_HOST_POOL_SIZE];
+
+//*****************************************************************************
+//
+// The configuration descriptor of the simulated mass storage device, which
+// has a single bulk-only SCSI interface.
+//
+//*****************************************************************************
+static uint8_t g_pui8MSCConfigDescriptor[] =
+{
+    9,                              // Size of the configuration descriptor.
+    USB_DTYPE_CONFIGURATION,        // Type of this descriptor.
+    USBShort(32),                   // The total size of this descriptor.
+    1,                              // The number of interfaces.
+    1,                              // The unique value for this configuration.
+    0,                              // The string identifier.
+    USB_CONF_ATTR_SELF_PWR,         // Configuration attributes.
+    250,                            // The maximum power in 2mA increments.
+
+    9,                              // Size of the interface descriptor.
+    USB_DTYPE_INTERFACE,            // Type of this descriptor.
+    0,                              // The index for this interface.
+    0,                              // The alternate setting.
+    2,                              // The number of endpoints.
+    USB_CLASS_MASS_STORAGE,         // The interface class.
+    0x06,                           // The SCSI transparent command set.
+    0x50,                           // The bulk-only transport.
+    0,                              // The string index for this interface.
+
+    7,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+    USB_EP_DESC_IN | 1,             // The bulk IN endpoint.
+    USB_EP_ATTR_BULK,               // Endpoint is a bulk endpoint.
+    USBShort(64),                   // The maximum packet size.
+    0,                              // The polling interval.
+
+    7,                              // The size of the endpoint descriptor.
+    USB_DTYPE_ENDPOINT,             // Descriptor type is an endpoint.
+    USB_EP_DESC_OUT | 2,            // The bulk OUT endpoint.
+    USB_EP_ATTR_BULK,               // Endpoint is a bulk endpoint.
+    USBShort(64),                   // The maximum packet size.
+    0                               // The polling interval.
+};
+
+//*****************************************************************************
+//
+// The simulated device that is given to the host class drivers.
+//
+//*****************************************************************************
+static tUSBHostDevice g_sSimDevice;
+
+//*****************************************************************************
+//
+// The periodic pipes opened on the simulated device by the pipe commands,
+// the pipe that was given the first scheduler event of the current frame,
+// and the number of frames in which each pipe was given the first event.
+//
+//*****************************************************************************
+static struct
+{
+    uint32_t ui32Count;
+    uint32_t pui32Pipes[SIM_PIPES_MAX];
+    uint32_t ui32First;
+    uint32_t pui32Firsts[SIM_PIPES_MAX];
+}
+g_sPipes;
+
+//*****************************************************************************
+//
+// The simulated drive behind the mass storage class driver.  The drive's
+// contents are kept alongside an image of what has been written to it
+// through the driver, so that the blocks held back by the driver's cache
+// can be told apart.  The buffers are word aligned, as the driver's cache
+// must be.
+//
+//*****************************************************************************
+static struct
+{
+    //
+    // The number of blocks on the drive.
+    //
+    uint32_t ui32Blocks;
+
+    //
+    // The READ(10) and WRITE(10) commands received by the drive, and the
+    // total number of blocks that they asked for.
+    //
+    uint32_t ui32Reads;
+    uint32_t ui32Writes;
+    uint64_t ui64Blocks;
+
+    //
+    // The sense key and additional sense code of the last command that
+    // failed.
+    //
+    uint8_t ui8SenseKey;
+    uint8_t ui8SenseCode;
+
+    //
+    // The number of runs of blocks written, which is added to the data of
+    // each run to make it differ from what is already on the drive.
+    //
+    uint32_t ui32Generation;
+}
+g_sDrive;
+
+static tUSBHMSCInstance *g_psMSCInstance;
+static uint8_t g_pui8Drive[SIM_MSC_MAX_BLOCKS * SIM_MSC_BLOCK_SIZE];
+static uint8_t g_pui8DriveImage[SIM_MSC_MAX_BLOCKS * SIM_MSC_BLOCK_SIZE];
+static uint32_t g_pui32MSCCache[(SIM_MSC_CACHE_MAX * SIM_MSC_BLOCK_SIZE) / 4];
+static uint32_t g_pui32MSCBuffer[(SIM_MSC_RUN_MAX * SIM_MSC_BLOCK_SIZE) / 4];
+
+//*****************************************************************************
+//
+// The script being run, and the metrics reported by its last command.
+//
+//*****************************************************************************
+static const char *g_pcScript;
+static uint32_t g_ui32Line;
+static bool g_bDevice;
+static bool g_bHost;
+
+static struct
+{
+    const char *pcName;
+    double dValue;
+}
+g_psMetrics[SIM_MAX_METRICS];
+static uint32_t g_ui32NumMetrics;
+
+//*****************************************************************************
+//
+// Returns the byte of the test pattern at the given offset in a stream.
+//
+//*****************************************************************************
+static uint8_t
+PatternByte(uint32_t ui32Offset)
+{
+    return((ui32Offset * 31) + (ui32Offset >> 9));
+}
+
+//*****************************************************************************
+//
+// Records a check of the script, printing the script's line if it fails.
+//
+//*****************************************************************************
+static bool
+ScriptCheck(bool bPass, const char *pcCheck)
+{
+    g_ui32TestChecks++;
+
+    if(!bPass)
+    {
+        g_ui32TestFailures++;
+        printf("%s:%u: check failed: %s\n", g_pcScript, (unsigned)g_ui32Line,
+               pcCheck);
+    }
+
+    return(bPass);
+}
+
+//*****************************************************************************
+//
+// Records a metric of the current command.
+//
+//*****************************************************************************
+static void
+MetricSet(const char *pcName, double dValue)
+{
+    if(g_ui32NumMetrics < SIM_MAX_METRICS)
+    {
+        g_psMetrics[g_ui32NumMetrics].pcName = pcName;
+        g_psMetrics[g_ui32NumMetrics].dValue = dValue;
+        g_ui32NumMetrics++;
+    }
+}
+
+//*****************************************************************************
+//
+// Verifies a part of the stream received by the device.
+//
+//*****************************************************************************
+static void
+RxVerify(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+    {
+        if(pui8Data[ui32Idx] != PatternByte(g_sApp.ui32RxCount + ui32Idx))
+        {
+            g_sApp.ui32RxBad++;
+        }
+    }
+
+    g_sApp.ui32RxCount += ui32Size;
+}
+
+//*****************************************************************************
+//
+// Handles events on the bulk device's receive channel.
+//
+//*****************************************************************************
+static uint32_t
+RxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
+          void *pvMsgData)
+{
+    switch(ui32Event)
+    {
+        case USB_EVENT_CONNECTED:
+        {
+            g_sApp.bConnected = true;
+            break;
+        }
+
+        case USB_EVENT_DISCONNECTED:
+        {
+            g_sApp.bConnected = false;
+            break;
+        }
+
+        //
+        // With the transfer API the data has been read into the transfer
+        // buffer, and the next transfer is started.  With the packet API, or
+        // if no transfer has been started, the packet is still in the FIFO.
+        //
+        case USB_EVENT_RX_AVAILABLE:
+        {
+            if(pvMsgData)
+            {
+                RxVerify(pvMsgData, ui32MsgValue);
+                if(g_sApp.ui32RxCount < g_sApp.ui32RxSize)
+                {
+                    USBDBulkTransferRead(pvCBData,
+                                         (uint8_t *)g_pui32RxBuffer,
+                                         g_sApp.ui32XferSize);
+                }
+                return(ui32MsgValue);
+            }
+
+            if(!g_sApp.bTransfer)
+            {
+                ui32MsgValue = USBDBulkPacketRead(pvCBData,
+                                                  (uint8_t *)g_pui32RxBuffer,
+                                                  sizeof(g_pui32RxBuffer),
+                                                  true);
+                RxVerify((uint8_t *)g_pui32RxBuffer, ui32MsgValue);
+                return(ui32MsgValue);
+            }
+
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Gives the bulk device the next part of the stream to send.
+//
+//*****************************************************************************
+static void
+TxNext(void)
+{
+    uint32_t ui32Size, ui32Sent;
+    uint8_t *pui8Data;
+
+    ui32Size = g_sApp.ui32TxSize - g_sApp.ui32TxCount;
+    if(ui32Size == 0)
+    {
+        return;
+    }
+
+    pui8Data = (uint8_t *)g_pui32TxBuffer + g_sApp.ui32TxCount;
+
+    if(g_sApp.bTransfer)
+    {
+        if(ui32Size > g_sApp.ui32XferSize)
+        {
+            ui32Size = g_sApp.ui32XferSize;
+        }
+        ui32Sent = USBDBulkTransferWrite(&g_sBulkDevice, pui8Data, ui32Size);
+    }
+    else
+    {
+        if(ui32Size > g_sHost.ui32InMaxPacket)
+        {
+            ui32Size = g_sHost.ui32InMaxPacket;
+        }
+        ui32Sent = USBDBulkPacketWrite(&g_sBulkDevice, pui8Data, ui32Size,
+                                       true);
+    }
+
+    if(ui32Sent)
+    {
+        g_sApp.ui32TxCount += ui32Sent;
+        g_sApp.bTxBusy = true;
+    }
+}
+
+//*****************************************************************************
+//
+// Handles events on the bulk device's transmit channel.
+//
+//*****************************************************************************
+static uint32_t
+TxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
+          void *pvMsgData)
+{
+    if(ui32Event == USB_EVENT_TX_COMPLETE)
+    {
+        g_sApp.bTxBusy = false;
+        TxNext();
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Handles events on the NCM device's receive channel.  Each datagram is
+// verified as part of the stream, then either held or released at once as
+// if it had been copied.  Datagrams are held only while more than one NTB
+// buffer is free, which is the rule that lwiplib.c follows, so that the
+// datagrams held can never stop reception.
+//
+//*****************************************************************************
+static uint32_t
+NCMRxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
+             void *pvMsgData)
+{
+    switch(ui32Event)
+    {
+        case USB_EVENT_CONNECTED:
+        {
+            g_sApp.bConnected = true;
+            break;
+        }
+
+        case USB_EVENT_DISCONNECTED:
+        {
+            g_sApp.bConnected = false;
+            break;
+        }
+
+        case USB_EVENT_RX_AVAILABLE:
+        {
+            RxVerify(pvMsgData, ui32MsgValue);
+            g_sApp.ui32RxFrames++;
+
+            if(g_sApp.bHold && (g_sApp.ui32Held < SIM_NCM_HOLD) &&
+               (USBDNCMRxBuffersFree(pvCBData) > 1))
+            {
+                g_sApp.ppui8Held[g_sApp.ui32Held++] = pvMsgData;
+            }
+            else
+            {
+                USBDNCMRxDatagramRelease(pvCBData, pvMsgData);
+            }
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Queues as many of the frames still to be sent as the NCM device accepts.
+// Each frame is the next part of the stream.
+//
+//*****************************************************************************
+static void
+NCMTxNext(void)
+{
+    uint8_t *pui8Frame;
+
+    while((g_sApp.ui32TxQueued < g_sApp.ui32TxFrames) &&
+          USBDNCMTxQueueSpace(&g_sNCMDevice))
+    {
+        pui8Frame = ((uint8_t *)g_pui32TxBuffer +
+                     (g_sApp.ui32TxQueued * g_sApp.ui32FrameSize));
+
+        if(!USBDNCMFrameWrite(&g_sNCMDevice, pui8Frame,
+                              g_sApp.ui32FrameSize))
+        {
+            break;
+        }
+
+        g_sApp.ui32TxQueued++;
+    }
+}
+
+//*****************************************************************************
+//
+// Handles events on the NCM device's transmit channel.  Frames are queued
+// from the callback as they would be by a network stack, so that they are
+// aggregated into the next NTB.
+//
+//*****************************************************************************
+static uint32_t
+NCMTxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
+             void *pvMsgData)
+{
+    if((ui32Event == USB_EVENT_TX_COMPLETE) && ui32MsgValue)
+    {
+        g_sApp.ui32TxDone++;
+        NCMTxNext();
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Handles the events of the audio device.
+//
+//*****************************************************************************
+static uint32_t
+AudioHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
+             void *pvMsgData)
+{
+    if(ui32Event == USB_EVENT_CONNECTED)
+    {
+        g_sApp.bConnected = true;
+    }
+    else if(ui32Event == USB_EVENT_DISCONNECTED)
+    {
+        g_sApp.bConnected = false;
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Handles the events of the HID mouse.
+//
+//*****************************************************************************
+static uint32_t
+MouseHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
+             void *pvMsgData)
+{
+    if(ui32Event == USB_EVENT_CONNECTED)
+    {
+        g_sApp.bConnected = true;
+    }
+    else if(ui32Event == USB_EVENT_DISCONNECTED)
+    {
+        g_sApp.bConnected = false;
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Counts the periods of data that the audio device writes to the ring.
+//
+//*****************************************************************************
+static void
+AudioPeriod(void *pvBuffer, uint32_t ui32Param, uint32_t ui32Event)
+{
+    if(ui32Event == USBD_AUDIO_EVENT_PERIOD)
+    {
+        g_sApp.ui32Periods++;
+    }
+}
+
+//*****************************************************************************
+//
+// Makes the audio device with the given sample format.  The fields of the
+// device structure are constant, so the structure is built on the stack and
+// copied to memory of its own.
+//
+//*****************************************************************************
+static tUSBDAudioDevice *
+AudioDeviceCreate(uint32_t ui32SampleRate, uint8_t ui8SampleBits)
+{
+    tUSBDAudioDevice *psAudioDevice;
+    tUSBDAudioDevice sAudioDevice =
+    {
+        USB_VID_TI_1CBE,
+        USB_PID_AUDIO,
+        "TI      ",
+        "Audio Traffic   ",
+        "1.00",
+        500,
+        USB_CONF_ATTR_SELF_PWR,
+        AudioHandler,
+        g_ppui8StringDescriptors,
+        NUM_STRING_DESCRIPTORS,
+        0,
+        (int16_t)0xdc80,
+        0x0080,
+        ui32SampleRate,
+        ui8SampleBits,
+        USBD_AUDIO_FLAG_ASYNC
+    };
+
+    psAudioDevice = malloc(sizeof(tUSBDAudioDevice));
+    if(psAudioDevice)
+    {
+        memcpy(psAudioDevice, &sAudioDevice, sizeof(tUSBDAudioDevice));
+    }
+
+    return(psAudioDevice);
+}
+
+//*****************************************************************************
+//
+// Plays the given number of bytes from the audio device's ring, as the codec
+// would, and verifies them as part of the stream.  Returns false if the ring
+// did not hold enough data.
+//
+//*****************************************************************************
+static bool
+AudioPlay(uint32_t ui32Bytes)
+{
+    uint32_t ui32Size;
+    uint8_t *pui8Data;
+
+    while(ui32Bytes)
+    {
+        ui32Size = USBAudioRingRead(g_psAudioDevice, &pui8Data);
+        if(ui32Size == 0)
+        {
+            return(false);
+        }
+        if(ui32Size > ui32Bytes)
+        {
+            ui32Size = ui32Bytes;
+        }
+
+        RxVerify(pui8Data, ui32Size);
+        USBAudioRingAdvance(g_psAudioDevice, ui32Size);
+        ui32Bytes -= ui32Size;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Does the work of the device application's main loop.
+//
+//*****************************************************************************
+static void
+DevicePoll(void)
+{
+    if(g_sApp.ui32Class == SIM_DEVICE_NCM)
+    {
+        NCMTxNext();
+    }
+    else if(((g_sApp.ui32Class == SIM_DEVICE_BULK) ||
+             (g_sApp.ui32Class == SIM_DEVICE_COMPOSITE)) && !g_sApp.bTxBusy)
+    {
+        TxNext();
+    }
+}
+
+//*****************************************************************************
+//
+// Makes a control transfer with an IN data stage, or with no data stage.
+// Returns the handshake which ended the transfer, or HOST_TIMEOUT if the
+// device did not complete it.  On success, *pui32Size is set to the number
+// of bytes received.
+//
+//*****************************************************************************
+static uint32_t
+HostControl(uint8_t ui8Type, uint8_t ui8Request, uint16_t ui16Value,
+            uint16_t ui16Index, uint16_t ui16Length, uint8_t *pui8Data,
+            uint32_t *pui32Size)
+{
+    uint8_t pui8Setup[8], pui8Packet[64];
+    uint32_t ui32Count, ui32Size, ui32NAKs, ui32Result;
+
+    pui8Setup[0] = ui8Type;
+    pui8Setup[1] = ui8Request;
+    pui8Setup[2] = ui16Value & 0xff;
+    pui8Setup[3] = ui16Value >> 8;
+    pui8Setup[4] = ui16Index & 0xff;
+    pui8Setup[5] = ui16Index >> 8;
+    pui8Setup[6] = ui16Length & 0xff;
+    pui8Setup[7] = ui16Length >> 8;
+
+    USBModelSetup(pui8Setup);
+
+    //
+    // The data stage.
+    //
+    ui32Count = 0;
+    ui32NAKs = 0;
+    while(ui32Count < ui16Length)
+    {
+        ui32Size = g_sHost.ui32MaxPacket0;
+        ui32Result = USBModelIn(0, pui8Packet, &ui32Size);
+
+        if(ui32Result == USBMODEL_NAK)
+        {
+            if(++ui32NAKs == HOST_NAK_LIMIT)
+            {
+                return(HOST_TIMEOUT);
+            }
+            continue;
+        }
+        if(ui32Result != USBMODEL_ACK)
+        {
+            return(ui32Result);
+        }
+
+        if(ui32Size > (ui16Length - ui32Count))
+        {
+            ScriptCheck(false, "device sent more than was asked for");
+            ui32Size = ui16Length - ui32Count;
+        }
+        memcpy(pui8Data + ui32Count, pui8Packet, ui32Size);
+        ui32Count += ui32Size;
+
+        if(ui32Size < g_sHost.ui32MaxPacket0)
+        {
+            break;
+        }
+    }
+
+    //
+    // The status stage, in the opposite direction to the data stage.
+    //
+    ui32NAKs = 0;
+    do
+    {
+        if(ui16Length)
+        {
+            ui32Result = USBModelOut(0, 0, 0);
+        }
+        else
+        {
+            ui32Size = sizeof(pui8Packet);
+            ui32Result = USBModelIn(0, pui8Packet, &ui32Size);
+        }
+
+        if(++ui32NAKs == HOST_NAK_LIMIT)
+        {
+            return(HOST_TIMEOUT);
+        }
+    }
+    while(ui32Result == USBMODEL_NAK);
+
+    if(pui32Size)
+    {
+        *pui32Size = ui32Count;
+    }
+
+    return(ui32Result);
+}
+
+//*****************************************************************************
+//
+// Reads a descriptor from the device.
+//
+//*****************************************************************************
+static uint32_t
+HostDescriptorGet(uint8_t ui8Type, uint8_t ui8Index, uint16_t ui16Lang,
+                  uint16_t ui16Length, uint8_t *pui8Data, uint32_t *pui32Size)
+{
+    return(HostControl(USB_RTYPE_DIR_IN | USB_RTYPE_STANDARD |
+                       USB_RTYPE_DEVICE, USBREQ_GET_DESCRIPTOR,
+                       (ui8Type << 8) | ui8Index, ui16Lang, ui16Length,
+                       pui8Data, pui32Size));
+}
+
+//*****************************************************************************
+//
+// Reads a whole configuration descriptor, or other speed configuration
+// descriptor, from the device.  Returns the size of the descriptor, or 0 if
+// it could not be read.
+//
+//*****************************************************************************
+static uint32_t
+HostConfigGet(uint8_t ui8Type, uint8_t *pui8Config, uint32_t ui32Max)
+{
+    uint32_t ui32Size, ui32Total;
+
+    if((HostDescriptorGet(ui8Type, 0, 0, 9, pui8Config, &ui32Size) !=
+        USBMODEL_ACK) || (ui32Size != 9) || (pui8Config[1] != ui8Type))
+    {
+        return(0);
+    }
+
+    ui32Total = pui8Config[2] | (pui8Config[3] << 8);
+    if(ui32Total > ui32Max)
+    {
+        ui32Total = ui32Max;
+    }
+
+    if((HostDescriptorGet(ui8Type, 0, 0, ui32Total, pui8Config,
+                          &ui32Size) != USBMODEL_ACK) ||
+       (ui32Size != ui32Total) || (pui8Config[1] != ui8Type))
+    {
+        return(0);
+    }
+
+    return(ui32Size);
+}
+
+//*****************************************************************************
+//
+// Finds the bulk endpoints in a configuration descriptor.  The endpoints
+// found in an other speed configuration are only used for their packet size.
+//
+//*****************************************************************************
+static void
+HostEndpointsFind(const uint8_t *pui8Config, uint32_t ui32Size)
+{
+    uint32_t ui32Offset, ui32Interface, ui32AltSetting;
+    const uint8_t *pui8Desc;
+
+    if(pui8Config[1] == USB_DTYPE_OSPEED_CONF)
+    {
+        for(ui32Offset = 0; (ui32Offset + 5) < ui32Size;
+            ui32Offset += pui8Config[ui32Offset])
+        {
+            pui8Desc = pui8Config + ui32Offset;
+
+            if(pui8Desc[0] == 0)
+            {
+                break;
+            }
+
+            if((pui8Desc[1] == USB_DTYPE_ENDPOINT) &&
+               (pui8Desc[2] & USB_EP_DESC_IN) &&
+               ((pui8Desc[3] & USB_EP_ATTR_TYPE_M) == USB_EP_ATTR_BULK))
+            {
+                g_sHost.ui32OtherMaxPacket = pui8Desc[4] |
+                                             (pui8Desc[5] << 8);
+            }
+        }
+        return;
+    }
+
+    g_sHost.ui32InEP = 0;
+    g_sHost.ui32OutEP = 0;
+    g_sHost.ui32IntEP = 0;
+    g_sHost.ui32DataInterface = 0;
+    g_sHost.ui32DataAltSetting = 0;
+    ui32Interface = 0;
+    ui32AltSetting = 0;
+
+    for(ui32Offset = 0; (ui32Offset + 1) < ui32Size;
+        ui32Offset += pui8Config[ui32Offset])
+    {
+        pui8Desc = pui8Config + ui32Offset;
+
+        if(pui8Desc[0] == 0)
+        {
+            break;
+        }
+
+        if((pui8Desc[1] == USB_DTYPE_INTERFACE) && (pui8Desc[0] >= 9))
+        {
+            ui32Interface = pui8Desc[2];
+            ui32AltSetting = pui8Desc[3];
+        }
+
+        if((pui8Desc[1] == USB_DTYPE_ENDPOINT) && (pui8Desc[0] >= 7) &&
+           ((pui8Desc[3] & USB_EP_ATTR_TYPE_M) == USB_EP_ATTR_BULK))
+        {
+            g_sHost.ui32DataInterface = ui32Interface;
+            g_sHost.ui32DataAltSetting = ui32AltSetting;
+
+            if(pui8Desc[2] & USB_EP_DESC_IN)
+            {
+                g_sHost.ui32InEP = pui8Desc[2] & USB_EP_DESC_NUM_M;
+                g_sHost.ui32InMaxPacket = pui8Desc[4] | (pui8Desc[5] << 8);
+            }
+            else
+            {
+                g_sHost.ui32OutEP = pui8Desc[2] & USB_EP_DESC_NUM_M;
+                g_sHost.ui32OutMaxPacket = pui8Desc[4] | (pui8Desc[5] << 8);
+            }
+        }
+
+        if((pui8Desc[1] == USB_DTYPE_ENDPOINT) && (pui8Desc[0] >= 7) &&
+           ((pui8Desc[3] & USB_EP_ATTR_TYPE_M) == USB_EP_ATTR_INT) &&
+           (pui8Desc[2] & USB_EP_DESC_IN))
+        {
+            g_sHost.ui32IntEP = pui8Desc[2] & USB_EP_DESC_NUM_M;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Enumerates the device in the order used by Linux.  The first request for
+// the device descriptor asks for 64 bytes and is followed by a second reset,
+// before the address is set.  Returns false if any step fails.
+//
+//*****************************************************************************
+static bool
+HostEnumerate(void)
+{
+    uint8_t pui8Device[64], pui8Config[512], pui8String[256];
+    uint32_t ui32Size, ui32Idx, ui32Result;
+
+    g_sHost.ui32MaxPacket0 = 64;
+
+    if(!ScriptCheck(USBModelReset(g_sHost.ui32Speed),
+                    "device connected to the bus"))
+    {
+        return(false);
+    }
+
+    if(!ScriptCheck((HostDescriptorGet(USB_DTYPE_DEVICE, 0, 0, 64, pui8Device,
+                                       &ui32Size) == USBMODEL_ACK) &&
+                    (ui32Size >= 8) && (pui8Device[1] == USB_DTYPE_DEVICE),
+                    "first device descriptor"))
+    {
+        return(false);
+    }
+    g_sHost.ui32MaxPacket0 = pui8Device[7];
+
+    USBModelReset(g_sHost.ui32Speed);
+
+    if(!ScriptCheck(HostControl(USB_RTYPE_DIR_OUT | USB_RTYPE_STANDARD |
+                                USB_RTYPE_DEVICE, USBREQ_SET_ADDRESS,
+                                HOST_ADDRESS, 0, 0, 0, 0) == USBMODEL_ACK,
+                    "SET_ADDRESS"))
+    {
+        return(false);
+    }
+
+    //
+    // The device has 2ms to start using its new address.
+    //
+    USBModelWait(2000000);
+    if(!ScriptCheck(USBModelAddress() == HOST_ADDRESS, "device address"))
+    {
+        return(false);
+    }
+
+    if(!ScriptCheck((HostDescriptorGet(USB_DTYPE_DEVICE, 0, 0, 18, pui8Device,
+                                       &ui32Size) == USBMODEL_ACK) &&
+                    (ui32Size == 18), "device descriptor"))
+    {
+        return(false);
+    }
+
+    g_sHost.ui32ConfigSize = HostConfigGet(USB_DTYPE_CONFIGURATION,
+                                           pui8Config, sizeof(pui8Config));
+    if(!ScriptCheck(g_sHost.ui32ConfigSize != 0, "configuration descriptor"))
+    {
+        return(false);
+    }
+    HostEndpointsFind(pui8Config, g_sHost.ui32ConfigSize);
+
+    //
+    // A full speed only device stalls the device qualifier request.  A high
+    // speed capable device returns it, and its configuration for the other
+    // speed.
+    //
+    ui32Result = HostDescriptorGet(USB_DTYPE_DEVICE_QUAL, 0, 0, 10,
+                                   pui8String, &ui32Size);
+    if(!ScriptCheck((ui32Result == USBMODEL_STALL) ||
+                    ((ui32Result == USBMODEL_ACK) && (ui32Size == 10) &&
+                     (pui8String[1] == USB_DTYPE_DEVICE_QUAL) &&
+                     (pui8String[8] == pui8Device[17])), "device qualifier"))
+    {
+        return(false);
+    }
+
+    g_sHost.bQualifier = (ui32Result == USBMODEL_ACK);
+    g_sHost.ui32OtherMaxPacket = 0;
+
+    if(g_sHost.bQualifier)
+    {
+        ui32Size = HostConfigGet(USB_DTYPE_OSPEED_CONF, pui8Config,
+                                 sizeof(pui8Config));
+        if(!ScriptCheck(ui32Size != 0,
+                        "other speed configuration descriptor"))
+        {
+            return(false);
+        }
+        HostEndpointsFind(pui8Config, ui32Size);
+    }
+
+    //
+    // The language table, then the strings named by the device descriptor.
+    //
+    if(!ScriptCheck((HostDescriptorGet(USB_DTYPE_STRING, 0, 0, 255,
+                                       pui8String, &ui32Size) ==
+                     USBMODEL_ACK) && (ui32Size >= 4),
+                    "string language table"))
+    {
+        return(false);
+    }
+
+    for(ui32Idx = 14; ui32Idx <= 16; ui32Idx++)
+    {
+        if(pui8Device[ui32Idx] &&
+           !ScriptCheck((HostDescriptorGet(USB_DTYPE_STRING,
+                                           pui8Device[ui32Idx],
+                                           USB_LANG_EN_US, 255, pui8String,
+                                           &ui32Size) == USBMODEL_ACK) &&
+                        (ui32Size >= 2) &&
+                        (pui8String[1] == USB_DTYPE_STRING), "string"))
+        {
+            return(false);
+        }
+    }
+
+    if(!ScriptCheck(HostControl(USB_RTYPE_DIR_OUT | USB_RTYPE_STANDARD |
+                                USB_RTYPE_DEVICE, USBREQ_SET_CONFIG, 1, 0, 0,
+                                0, 0) == USBMODEL_ACK, "SET_CONFIGURATION"))
+    {
+        return(false);
+    }
+
+    //
+    // Bulk endpoints in an alternate setting, such as those of the NCM data
+    // interface, only carry data once the host selects that setting.
+    //
+    if(g_sHost.ui32DataAltSetting &&
+       !ScriptCheck(HostControl(USB_RTYPE_DIR_OUT | USB_RTYPE_STANDARD |
+                                USB_RTYPE_INTERFACE, USBREQ_SET_INTERFACE,
+                                g_sHost.ui32DataAltSetting,
+                                g_sHost.ui32DataInterface, 0, 0, 0) ==
+                    USBMODEL_ACK, "SET_INTERFACE"))
+    {
+        return(false);
+    }
+
+    return(ScriptCheck(g_sApp.bConnected, "device configured"));
+}
+
+//*****************************************************************************
+//
+// Returns the number of register accesses made by the library.
+//
+//*****************************************************************************
+static uint32_t
+StatsRegs(const tUSBModelStats *psStats)
+{
+    return(psStats->ui32RegReads + psStats->ui32RegWrites);
+}
+
+//*****************************************************************************
+//
+// Starts the device.
+//
+//*****************************************************************************
+static bool
+CmdDevice(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32ULPI, ui32Class, ui32SampleRate, ui32SampleBits;
+
+    for(ui32Class = 0; ui32Args && (ui32Class < NUM_DEVICE_CLASSES);
+        ui32Class++)
+    {
+        if(!strcmp(ppcArgs[0], g_ppcDeviceClasses[ui32Class]))
+        {
+            break;
+        }
+    }
+
+    if(!ScriptCheck((ui32Args >= 2) && (ui32Class < NUM_DEVICE_CLASSES) &&
+                    ((ui32Args == 2) || (ui32Class == SIM_DEVICE_AUDIO)) &&
+                    (ui32Args <= 4) &&
+                    (!strcmp(ppcArgs[1], "full") ||
+                     !strcmp(ppcArgs[1], "high")) && !g_bDevice && !g_bHost,
+                    "device bulk|ncm|mouse|composite full|high or device "
+                    "audio full [rate [bits]], once in each script"))
+    {
+        return(false);
+    }
+
+    //
+    // The audio device sends its feedback as a number of samples in each
+    // full speed frame.
+    //
+    if(!ScriptCheck((ui32Class != SIM_DEVICE_AUDIO) ||
+                    !strcmp(ppcArgs[1], "full"), "audio device at full speed"))
+    {
+        return(false);
+    }
+
+    USBModelInit(USB0DeviceIntHandler);
+
+    if(!strcmp(ppcArgs[1], "high"))
+    {
+        ui32ULPI = USBLIB_FEATURE_ULPI_HS;
+        USBDCDFeatureSet(0, USBLIB_FEATURE_USBULPI, &ui32ULPI);
+        g_sHost.ui32Speed = USBMODEL_SPEED_HIGH;
+    }
+    else
+    {
+        g_sHost.ui32Speed = USBMODEL_SPEED_FULL;
+    }
+
+    g_bDevice = true;
+    g_sApp.ui32Class = ui32Class;
+
+    if(ui32Class == SIM_DEVICE_NCM)
+    {
+        return(ScriptCheck(USBDNCMInit(0, &g_sNCMDevice) != 0,
+                           "USBDNCMInit"));
+    }
+
+    if(ui32Class == SIM_DEVICE_MOUSE)
+    {
+        return(ScriptCheck(USBDHIDMouseInit(0, &g_sMouseDevice) != 0,
+                           "USBDHIDMouseInit"));
+    }
+
+    if(ui32Class == SIM_DEVICE_COMPOSITE)
+    {
+        return(ScriptCheck(USBDBulkCompositeInit(0, &g_sBulkDevice,
+                               &g_psCompositeEntries[SIM_COMPOSITE_BULK]) !=
+                           0, "USBDBulkCompositeInit") &&
+               ScriptCheck(USBDHIDMouseCompositeInit(0, &g_sMouseDevice,
+                               &g_psCompositeEntries[SIM_COMPOSITE_MOUSE]) !=
+                           0, "USBDHIDMouseCompositeInit") &&
+               ScriptCheck(USBDCompositeInit(0, &g_sCompositeDevice,
+                                             SIM_COMPOSITE_SIZE,
+                                             g_pui8CompositeDescriptor) != 0,
+                           "USBDCompositeInit"));
+    }
+
+    if(ui32Class == SIM_DEVICE_AUDIO)
+    {
+        ui32SampleRate = (ui32Args > 2) ? strtoul(ppcArgs[2], 0, 0) : 48000;
+        ui32SampleBits = (ui32Args > 3) ? strtoul(ppcArgs[3], 0, 0) : 16;
+
+        if(!ScriptCheck((ui32SampleRate >= 8000) &&
+                        (ui32SampleRate <= 96000) &&
+                        ((ui32SampleBits == 16) || (ui32SampleBits == 24)),
+                        "rate of 8000 to 96000 with 16 or 24 bits"))
+        {
+            return(false);
+        }
+
+        g_psAudioDevice = AudioDeviceCreate(ui32SampleRate,
+                                            (uint8_t)ui32SampleBits);
+
+        return(ScriptCheck(g_psAudioDevice &&
+                           USBDAudioInit(0, g_psAudioDevice),
+                           "USBDAudioInit"));
+    }
+
+    return(ScriptCheck(USBDBulkInit(0, &g_sBulkDevice) != 0,
+                       "USBDBulkInit"));
+}
+
+//*****************************************************************************
+//
+// Starts the library as a host.
+//
+//*****************************************************************************
+static bool
+CmdHost(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32ULPI;
+
+    if(!ScriptCheck((ui32Args == 1) &&
+                    (!strcmp(ppcArgs[0], "full") ||
+                     !strcmp(ppcArgs[0], "high")) && !g_bDevice && !g_bHost,
+                    "host full|high, once in each script"))
+    {
+        return(false);
+    }
+
+    USBModelInit(USB0HostIntHandler);
+
+    if(!strcmp(ppcArgs[0], "high"))
+    {
+        ui32ULPI = USBLIB_FEATURE_ULPI_HS;
+        USBHCDFeatureSet(0, USBLIB_FEATURE_USBULPI, &ui32ULPI);
+        g_sSimDevice.ui32Speed = USB_EP_SPEED_HIGH;
+    }
+    else
+    {
+        g_sSimDevice.ui32Speed = USB_EP_SPEED_FULL;
+    }
+
+    g_bHost = true;
+
+    USBStackModeSet(0, eUSBModeForceHost, 0);
+    USBHCDRegisterDrivers(0, g_ppsHostClassDrivers, NUM_HOST_CLASS_DRIVERS);
+    USBHCDInit(0, g_pui8HostPool, SIM_HOST_POOL_SIZE);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Resets the bus.
+//
+//*****************************************************************************
+static bool
+CmdReset(char **ppcArgs, uint32_t ui32Args)
+{
+    if(ui32Args)
+    {
+        g_sHost.ui32Speed = strcmp(ppcArgs[0], "high") ?
+                            USBMODEL_SPEED_FULL : USBMODEL_SPEED_HIGH;
+    }
+
+    if(!ScriptCheck(USBModelReset(g_sHost.ui32Speed),
+                    "device connected to the bus"))
+    {
+        return(false);
+    }
+
+    printf("%s:%u: reset: %s speed\n", g_pcScript, (unsigned)g_ui32Line,
+           (USBModelSpeed() == USBMODEL_SPEED_HIGH) ? "high" : "full");
+    MetricSet("speed", (USBModelSpeed() == USBMODEL_SPEED_HIGH) ? 480 : 12);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Compiles the configuration descriptor of the device.
+//
+//*****************************************************************************
+static bool
+CmdCache(char **ppcArgs, uint32_t ui32Args)
+{
+    const tConfigHeader *psConfig;
+
+    if(g_sApp.ui32Class == SIM_DEVICE_NCM)
+    {
+        psConfig =
+            g_sNCMDevice.sPrivateData.sDevInfo.ppsConfigDescriptors[0];
+    }
+    else if(g_sApp.ui32Class == SIM_DEVICE_AUDIO)
+    {
+        psConfig =
+            g_psAudioDevice->sPrivateData.sDevInfo.ppsConfigDescriptors[0];
+    }
+    else if(g_sApp.ui32Class == SIM_DEVICE_MOUSE)
+    {
+        psConfig = g_sMouseDevice.sPrivateData.sHIDDevice.sPrivateData.
+                   sDevInfo.ppsConfigDescriptors[0];
+    }
+    else if(g_sApp.ui32Class == SIM_DEVICE_COMPOSITE)
+    {
+        psConfig =
+            g_sCompositeDevice.sPrivateData.sDevInfo.ppsConfigDescriptors[0];
+    }
+    else
+    {
+        psConfig =
+            g_sBulkDevice.sPrivateData.sDevInfo.ppsConfigDescriptors[0];
+    }
+
+    if(!ScriptCheck(USBDCDConfigCacheSize(psConfig) <= SIM_CACHE_SIZE,
+                    "configuration descriptor fits in the workspace"))
+    {
+        return(false);
+    }
+
+    return(ScriptCheck(USBDCDConfigCacheInit(0, psConfig, &g_sConfigCache,
+                                             (uint8_t *)g_pui32CacheWorkspace,
+                                             SIM_CACHE_SIZE),
+                       "USBDCDConfigCacheInit"));
+}
+
+//*****************************************************************************
+//
+// Enumerates the device one or more times.
+//
+//*****************************************************************************
+static bool
+CmdEnumerate(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32Count, ui32Idx;
+    uint64_t ui64Time, ui64MaxTime;
+    tUSBModelStats sStart, sBefore, sAfter;
+    tUSBDCDStats sDCDStart, sDCDEnd;
+
+    ui32Count = ui32Args ? strtoul(ppcArgs[0], 0, 0) : 1;
+    if(!ScriptCheck(ui32Count != 0, "enumeration count"))
+    {
+        return(false);
+    }
+
+    ui64MaxTime = 0;
+    USBModelStatsGet(&sStart);
+    USBDCDStatsGet(0, &sDCDStart);
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        USBModelStatsGet(&sBefore);
+        if(!HostEnumerate())
+        {
+            return(false);
+        }
+        USBModelStatsGet(&sAfter);
+
+        ui64Time = sAfter.ui64BusTime - sBefore.ui64BusTime;
+        if(ui64Time > ui64MaxTime)
+        {
+            ui64MaxTime = ui64Time;
+        }
+    }
+
+    USBDCDStatsGet(0, &sDCDEnd);
+
+    printf("%s:%u: enumerate x%u at %s speed: %.1f us on the bus "
+           "(max %.1f), %.1f interrupts, %.1f registers, %.0f ns of CPU, "
+           "%.1f requests, %u ms (max) by the device's tick\n", g_pcScript,
+           (unsigned)g_ui32Line, (unsigned)ui32Count,
+           (USBModelSpeed() == USBMODEL_SPEED_HIGH) ? "high" : "full",
+           (double)(sAfter.ui64BusTime - sStart.ui64BusTime) /
+           (ui32Count * 1000.0), (double)ui64MaxTime / 1000.0,
+           (double)(sAfter.ui32Interrupts - sStart.ui32Interrupts) /
+           ui32Count,
+           (double)(StatsRegs(&sAfter) - StatsRegs(&sStart)) / ui32Count,
+           (double)(sAfter.ui64IntTime - sStart.ui64IntTime) / ui32Count,
+           (double)(sDCDEnd.ui32Requests - sDCDStart.ui32Requests) /
+           ui32Count, (unsigned)sDCDEnd.ui32MaxEnumTime);
+
+    MetricSet("speed", (USBModelSpeed() == USBMODEL_SPEED_HIGH) ? 480 : 12);
+    MetricSet("enum-us", (double)(sAfter.ui64BusTime - sStart.ui64BusTime) /
+                         (ui32Count * 1000.0));
+    MetricSet("enum-max-us", (double)ui64MaxTime / 1000.0);
+    MetricSet("enum-interrupts",
+              (double)(sAfter.ui32Interrupts - sStart.ui32Interrupts) /
+              ui32Count);
+    MetricSet("enum-registers",
+              (double)(StatsRegs(&sAfter) - StatsRegs(&sStart)) / ui32Count);
+    MetricSet("enum-tick-ms", sDCDEnd.ui32MaxEnumTime);
+    MetricSet("max-packet", g_sHost.ui32InMaxPacket);
+    MetricSet("qualifier", g_sHost.bQualifier ? 1 : 0);
+    MetricSet("other-max-packet", g_sHost.ui32OtherMaxPacket);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Sends a storm of standard requests to endpoint zero.
+//
+//*****************************************************************************
+static bool
+CmdControl(char **ppcArgs, uint32_t ui32Args)
+{
+    uint8_t pui8Data[512];
+    uint32_t ui32Count, ui32Idx, ui32Result, ui32Size;
+    uint64_t ui64Time, ui64MaxTime, ui64IntTime, ui64MaxIntTime;
+    tUSBModelStats sStart, sBefore, sAfter;
+
+    ui32Count = ui32Args ? strtoul(ppcArgs[0], 0, 0) : 0;
+    if(!ScriptCheck(ui32Count != 0, "request count") ||
+       !ScriptCheck(g_sApp.bConnected, "device configured"))
+    {
+        return(false);
+    }
+
+    ui64MaxTime = 0;
+    ui64MaxIntTime = 0;
+    USBModelStatsGet(&sStart);
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        USBModelStatsGet(&sBefore);
+
+        switch(ui32Idx % 5)
+        {
+            case 0:
+            {
+                ui32Result = HostControl(USB_RTYPE_DIR_IN |
+                                         USB_RTYPE_STANDARD |
+                                         USB_RTYPE_DEVICE,
+                                         USBREQ_GET_STATUS, 0, 0, 2,
+                                         pui8Data, &ui32Size);
+                ui32Result = ((ui32Result == USBMODEL_ACK) &&
+                              (ui32Size == 2)) ? ui32Result : HOST_TIMEOUT;
+                break;
+            }
+
+            case 1:
+            {
+                ui32Result = HostDescriptorGet(USB_DTYPE_DEVICE, 0, 0, 18,
+                                               pui8Data, &ui32Size);
+                ui32Result = ((ui32Result == USBMODEL_ACK) &&
+                              (ui32Size == 18)) ? ui32Result : HOST_TIMEOUT;
+                break;
+            }
+
+            case 2:
+            {
+                ui32Result = HostControl(USB_RTYPE_DIR_IN |
+                                         USB_RTYPE_STANDARD |
+                                         USB_RTYPE_DEVICE,
+                                         USBREQ_GET_CONFIG, 0, 0, 1,
+                                         pui8Data, &ui32Size);
+                ui32Result = ((ui32Result == USBMODEL_ACK) &&
+                              (ui32Size == 1) && (pui8Data[0] == 1)) ?
+                             ui32Result : HOST_TIMEOUT;
+                break;
+            }
+
+            case 3:
+            {
+                ui32Result = HostDescriptorGet(USB_DTYPE_CONFIGURATION, 0, 0,
+                                               g_sHost.ui32ConfigSize,
+                                               pui8Data, &ui32Size);
+                ui32Result = ((ui32Result == USBMODEL_ACK) &&
+                              (ui32Size == g_sHost.ui32ConfigSize)) ?
+                             ui32Result : HOST_TIMEOUT;
+                break;
+            }
+
+            default:
+            {
+                ui32Result = HostControl(USB_RTYPE_DIR_IN |
+                                         USB_RTYPE_STANDARD |
+                                         USB_RTYPE_ENDPOINT,
+                                         USBREQ_GET_STATUS, 0,
+                                         USB_EP_DESC_IN | g_sHost.ui32InEP, 2,
+                                         pui8Data, &ui32Size);
+                ui32Result = ((ui32Result == USBMODEL_ACK) &&
+                              (ui32Size == 2)) ? ui32Result : HOST_TIMEOUT;
+                break;
+            }
+        }
+
+        if(!ScriptCheck(ui32Result == USBMODEL_ACK, "control request"))
+        {
+            return(false);
+        }
+
+        USBModelStatsGet(&sAfter);
+        ui64Time = sAfter.ui64BusTime - sBefore.ui64BusTime;
+        ui64IntTime = sAfter.ui64IntTime - sBefore.ui64IntTime;
+        if(ui64Time > ui64MaxTime)
+        {
+            ui64MaxTime = ui64Time;
+        }
+        if(ui64IntTime > ui64MaxIntTime)
+        {
+            ui64MaxIntTime = ui64IntTime;
+        }
+    }
+
+    printf("%s:%u: control x%u: %.2f us on the bus (max %.2f), "
+           "%.1f interrupts, %.1f registers, %.0f ns of CPU (max %u)\n",
+           g_pcScript, (unsigned)g_ui32Line, (unsigned)ui32Count,
+           (double)(sAfter.ui64BusTime - sStart.ui64BusTime) /
+           (ui32Count * 1000.0), (double)ui64MaxTime / 1000.0,
+           (double)(sAfter.ui32Interrupts - sStart.ui32Interrupts) /
+           ui32Count,
+           (double)(StatsRegs(&sAfter) - StatsRegs(&sStart)) / ui32Count,
+           (double)(sAfter.ui64IntTime - sStart.ui64IntTime) / ui32Count,
+           (unsigned)ui64MaxIntTime);
+
+    MetricSet("control-us", (double)(sAfter.ui64BusTime -
+                                     sStart.ui64BusTime) /
+                            (ui32Count * 1000.0));
+    MetricSet("control-max-us", (double)ui64MaxTime / 1000.0);
+    MetricSet("control-interrupts",
+              (double)(sAfter.ui32Interrupts - sStart.ui32Interrupts) /
+              ui32Count);
+    MetricSet("control-registers",
+              (double)(StatsRegs(&sAfter) - StatsRegs(&sStart)) / ui32Count);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Parses the arguments of the bulk commands.
+//
+//*****************************************************************************
+static bool
+BulkArgsParse(char **ppcArgs, uint32_t ui32Args, uint32_t *pui32Bytes)
+{
+    *pui32Bytes = ui32Args ? strtoul(ppcArgs[0], 0, 0) : 0;
+    g_sApp.bTransfer = false;
+    g_sApp.ui32XferSize = 0;
+
+    if((ui32Args >= 3) && !strcmp(ppcArgs[1], "transfer"))
+    {
+        g_sApp.bTransfer = true;
+        g_sApp.ui32XferSize = strtoul(ppcArgs[2], 0, 0);
+    }
+    else if((ui32Args != 1) &&
+            ((ui32Args != 2) || strcmp(ppcArgs[1], "packet")))
+    {
+        *pui32Bytes = 0;
+    }
+
+    return(ScriptCheck((*pui32Bytes != 0) &&
+                       (*pui32Bytes <= SIM_STREAM_MAX) &&
+                       (g_sApp.ui32XferSize <= SIM_XFER_MAX),
+                       "bulk-in|bulk-out bytes [transfer size|packet]") &&
+           ScriptCheck((g_sApp.ui32Class == SIM_DEVICE_BULK) ||
+                       (g_sApp.ui32Class == SIM_DEVICE_COMPOSITE),
+                       "bulk device") &&
+           ScriptCheck(g_sApp.bConnected && g_sHost.ui32InEP &&
+                       g_sHost.ui32OutEP, "device configured"));
+}
+
+//*****************************************************************************
+//
+// Reports the results of a bulk command.
+//
+//*****************************************************************************
+static void
+BulkReport(const char *pcCommand, uint32_t ui32Bytes, uint32_t ui32MaxPacket,
+           const tUSBModelStats *psStart, const tUSBModelStats *psEnd)
+{
+    double dPackets, dTime;
+
+    dPackets = (ui32Bytes + ui32MaxPacket - 1) / ui32MaxPacket;
+    dTime = (double)(psEnd->ui64BusTime - psStart->ui64BusTime);
+
+    printf("%s:%u: %s %u bytes (%s", g_pcScript, (unsigned)g_ui32Line,
+           pcCommand, (unsigned)ui32Bytes,
+           g_sApp.bTransfer ? "transfer " : "packet");
+    if(g_sApp.bTransfer)
+    {
+        printf("%u", (unsigned)g_sApp.ui32XferSize);
+    }
+    printf(") at %s speed: %.0f kB/s, %u NAKs, %.2f interrupts/packet, "
+           "%.1f registers/packet, %.0f ns of CPU/packet, %u DMA bytes\n",
+           (USBModelSpeed() == USBMODEL_SPEED_HIGH) ? "high" : "full",
+           ui32Bytes * 1000000.0 / dTime,
+           (unsigned)(psEnd->ui32NAKs - psStart->ui32NAKs),
+           (psEnd->ui32Interrupts - psStart->ui32Interrupts) / dPackets,
+           (StatsRegs(psEnd) - StatsRegs(psStart)) / dPackets,
+           (psEnd->ui64IntTime - psStart->ui64IntTime) / dPackets,
+           (unsigned)(psEnd->ui64DMABytes - psStart->ui64DMABytes));
+
+    MetricSet("kbps", ui32Bytes * 1000000.0 / dTime);
+    MetricSet("naks", psEnd->ui32NAKs - psStart->ui32NAKs);
+    MetricSet("interrupts-per-packet",
+              (psEnd->ui32Interrupts - psStart->ui32Interrupts) / dPackets);
+    MetricSet("registers-per-packet",
+              (StatsRegs(psEnd) - StatsRegs(psStart)) / dPackets);
+    MetricSet("dma-bytes", psEnd->ui64DMABytes - psStart->ui64DMABytes);
+}
+
+//*****************************************************************************
+//
+// Streams data from the host to the bulk device.
+//
+//*****************************************************************************
+static bool
+CmdBulkOut(char **ppcArgs, uint32_t ui32Args)
+{
+    uint8_t pui8Packet[512];
+    uint32_t ui32Bytes, ui32Offset, ui32Size, ui32Idx, ui32NAKs;
+    tUSBModelStats sStart, sEnd;
+    bool bZLP;
+
+    if(!BulkArgsParse(ppcArgs, ui32Args, &ui32Bytes))
+    {
+        return(false);
+    }
+
+    g_sApp.ui32RxCount = 0;
+    g_sApp.ui32RxBad = 0;
+    g_sApp.ui32RxSize = ui32Bytes;
+    if(g_sApp.bTransfer &&
+       !ScriptCheck(USBDBulkTransferRead(&g_sBulkDevice,
+                                         (uint8_t *)g_pui32RxBuffer,
+                                         g_sApp.ui32XferSize) != 0,
+                    "USBDBulkTransferRead"))
+    {
+        return(false);
+    }
+
+    USBModelStatsGet(&sStart);
+
+    //
+    // Send the stream.  If the last transfer would be left waiting for more
+    // data, the stream ends with a zero-length packet.
+    //
+    ui32NAKs = 0;
+    bZLP = (g_sApp.bTransfer && (ui32Bytes % g_sApp.ui32XferSize) &&
+            !(ui32Bytes % g_sHost.ui32OutMaxPacket)) ? true : false;
+    for(ui32Offset = 0; (ui32Offset < ui32Bytes) || bZLP; )
+    {
+        ui32Size = ui32Bytes - ui32Offset;
+        if(ui32Size > g_sHost.ui32OutMaxPacket)
+        {
+            ui32Size = g_sHost.ui32OutMaxPacket;
+        }
+        for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+        {
+            pui8Packet[ui32Idx] = PatternByte(ui32Offset + ui32Idx);
+        }
+
+        if(USBModelOut(g_sHost.ui32OutEP, pui8Packet, ui32Size) ==
+           USBMODEL_ACK)
+        {
+            ui32NAKs = 0;
+            ui32Offset += ui32Size;
+            if(ui32Size == 0)
+            {
+                bZLP = false;
+            }
+        }
+        else if(!ScriptCheck(++ui32NAKs < HOST_NAK_LIMIT,
+                             "bulk OUT endpoint accepts data"))
+        {
+            return(false);
+        }
+
+        DevicePoll();
+    }
+
+    USBModelSync();
+    USBModelStatsGet(&sEnd);
+
+    ScriptCheck(g_sApp.ui32RxCount == ui32Bytes, "all of the data received");
+    ScriptCheck(g_sApp.ui32RxBad == 0, "received data matches");
+
+    BulkReport("bulk-out", ui32Bytes, g_sHost.ui32OutMaxPacket, &sStart,
+               &sEnd);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Streams data from the bulk device to the host.
+//
+//*****************************************************************************
+static bool
+CmdBulkIn(char **ppcArgs, uint32_t ui32Args)
+{
+    uint8_t pui8Packet[512];
+    uint32_t ui32Bytes, ui32Offset, ui32Size, ui32Idx, ui32NAKs, ui32Bad;
+    uint32_t ui32Result;
+    tUSBModelStats sStart, sEnd;
+
+    if(!BulkArgsParse(ppcArgs, ui32Args, &ui32Bytes))
+    {
+        return(false);
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Bytes; ui32Idx++)
+    {
+        ((uint8_t *)g_pui32TxBuffer)[ui32Idx] = PatternByte(ui32Idx);
+    }
+    g_sApp.ui32TxCount = 0;
+    g_sApp.ui32TxSize = ui32Bytes;
+
+    USBModelStatsGet(&sStart);
+
+    ui32NAKs = 0;
+    ui32Bad = 0;
+    for(ui32Offset = 0; ui32Offset < ui32Bytes; )
+    {
+        DevicePoll();
+
+        ui32Size = sizeof(pui8Packet);
+        ui32Result = USBModelIn(g_sHost.ui32InEP, pui8Packet, &ui32Size);
+
+        if(ui32Result == USBMODEL_ACK)
+        {
+            ui32NAKs = 0;
+            if(ui32Size > (ui32Bytes - ui32Offset))
+            {
+                ScriptCheck(false, "device sent more than the stream");
+                ui32Size = ui32Bytes - ui32Offset;
+            }
+            for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+            {
+                if(pui8Packet[ui32Idx] != PatternByte(ui32Offset + ui32Idx))
+                {
+                    ui32Bad++;
+                }
+            }
+            ui32Offset += ui32Size;
+        }
+        else if(!ScriptCheck((ui32Result == USBMODEL_NAK) &&
+                             (++ui32NAKs < HOST_NAK_LIMIT),
+                             "bulk IN endpoint sends data"))
+        {
+            return(false);
+        }
+    }
+
+    //
+    // Collect the zero-length packet that ends a transfer whose length is a
+    // multiple of the maximum packet size.
+    //
+    for(ui32NAKs = 0; g_sApp.bTxBusy && (ui32NAKs < HOST_NAK_LIMIT);
+        ui32NAKs++)
+    {
+        ui32Size = sizeof(pui8Packet);
+        ui32Result = USBModelIn(g_sHost.ui32InEP, pui8Packet, &ui32Size);
+        ScriptCheck((ui32Result != USBMODEL_ACK) || (ui32Size == 0),
+                    "zero-length packet ends the stream");
+    }
+
+    USBModelStatsGet(&sEnd);
+
+    ScriptCheck(!g_sApp.bTxBusy, "transmission completed");
+    ScriptCheck(ui32Bad == 0, "sent data matches");
+
+    BulkReport("bulk-in", ui32Bytes, g_sHost.ui32InMaxPacket, &sStart, &sEnd);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Writes and reads the little-endian fields of an NTB.
+//
+//*****************************************************************************
+static void
+NTBShortPut(uint8_t *pui8Field, uint32_t ui32Value)
+{
+    pui8Field[0] = ui32Value & 0xff;
+    pui8Field[1] = (ui32Value >> 8) & 0xff;
+}
+
+static void
+NTBLongPut(uint8_t *pui8Field, uint32_t ui32Value)
+{
+    NTBShortPut(pui8Field, ui32Value & 0xffff);
+    NTBShortPut(pui8Field + 2, ui32Value >> 16);
+}
+
+static uint32_t
+NTBShortGet(const uint8_t *pui8Field)
+{
+    return(pui8Field[0] | (pui8Field[1] << 8));
+}
+
+static uint32_t
+NTBLongGet(const uint8_t *pui8Field)
+{
+    return(NTBShortGet(pui8Field) | (NTBShortGet(pui8Field + 2) << 16));
+}
+
+//*****************************************************************************
+//
+// Parses the arguments of the NCM commands.
+//
+//*****************************************************************************
+static bool
+NCMArgsParse(char **ppcArgs, uint32_t ui32Args, bool bOut,
+             uint32_t *pui32Frames)
+{
+    *pui32Frames = (ui32Args >= 2) ? strtoul(ppcArgs[0], 0, 0) : 0;
+    g_sApp.ui32FrameSize = (ui32Args >= 2) ? strtoul(ppcArgs[1], 0, 0) : 0;
+    g_sApp.bHold = false;
+
+    if(bOut && (ui32Args == 3) && !strcmp(ppcArgs[2], "hold"))
+    {
+        g_sApp.bHold = true;
+    }
+    else if(ui32Args != 2)
+    {
+        *pui32Frames = 0;
+    }
+
+    return(ScriptCheck((*pui32Frames != 0) && (g_sApp.ui32FrameSize != 0) &&
+                       (g_sApp.ui32FrameSize <= USBDNCM_MAX_SEGMENT_SIZE) &&
+                       (*pui32Frames <=
+                        (SIM_STREAM_MAX / g_sApp.ui32FrameSize)),
+                       bOut ? "ncm-out frames size [hold]" :
+                              "ncm-in frames size") &&
+           ScriptCheck(g_sApp.ui32Class == SIM_DEVICE_NCM, "NCM device") &&
+           ScriptCheck(g_sApp.bConnected && g_sHost.ui32InEP &&
+                       g_sHost.ui32OutEP, "NCM link up"));
+}
+
+//*****************************************************************************
+//
+// Reports the results of an NCM command.
+//
+//*****************************************************************************
+static void
+NCMReport(const char *pcCommand, uint32_t ui32Frames, uint32_t ui32NTBs,
+          const tUSBModelStats *psStart, const tUSBModelStats *psEnd)
+{
+    double dTime;
+
+    dTime = (double)(psEnd->ui64BusTime - psStart->ui64BusTime);
+
+    printf("%s:%u: %s %u frames of %u bytes at %s speed: %.0f frames/s, "
+           "%.1f frames/NTB, %u NAKs, %.2f interrupts/frame, "
+           "%.1f registers/frame, %.0f ns of CPU/frame\n", g_pcScript,
+           (unsigned)g_ui32Line, pcCommand, (unsigned)ui32Frames,
+           (unsigned)g_sApp.ui32FrameSize,
+           (USBModelSpeed() == USBMODEL_SPEED_HIGH) ? "high" : "full",
+           ui32Frames * 1000000000.0 / dTime,
+           (double)ui32Frames / ui32NTBs,
+           (unsigned)(psEnd->ui32NAKs - psStart->ui32NAKs),
+           (double)(psEnd->ui32Interrupts - psStart->ui32Interrupts) /
+           ui32Frames,
+           (double)(StatsRegs(psEnd) - StatsRegs(psStart)) / ui32Frames,
+           (double)(psEnd->ui64IntTime - psStart->ui64IntTime) / ui32Frames);
+
+    MetricSet("fps", ui32Frames * 1000000000.0 / dTime);
+    MetricSet("frames-per-ntb", (double)ui32Frames / ui32NTBs);
+    MetricSet("naks", psEnd->ui32NAKs - psStart->ui32NAKs);
+    MetricSet("interrupts-per-frame",
+              (double)(psEnd->ui32Interrupts - psStart->ui32Interrupts) /
+              ui32Frames);
+    MetricSet("registers-per-frame",
+              (double)(StatsRegs(psEnd) - StatsRegs(psStart)) / ui32Frames);
+}
+
+//*****************************************************************************
+//
+// Builds an NTB holding as many of the frames of the stream, starting at the
+// given frame, as fit in SIM_NCM_NTB_SIZE bytes.  Each datagram starts on a
+// 4-byte boundary and the NDP16 follows the last of them.  Returns the size
+// of the NTB, and sets *pui32Count to the number of frames in it.
+//
+//*****************************************************************************
+static uint32_t
+HostNTBBuild(uint8_t *pui8NTB, uint32_t ui32Frame, uint32_t ui32Frames,
+             uint16_t ui16Sequence, uint32_t *pui32Count)
+{
+    uint16_t pui16Index[SIM_NCM_NTB_SIZE / 4];
+    uint32_t ui32Pos, ui32Index, ui32Count, ui32Idx, ui32Offset, ui32NDP;
+    uint32_t ui32Size;
+
+    ui32Size = g_sApp.ui32FrameSize;
+    memset(pui8NTB, 0, SIM_NCM_NTB_SIZE);
+
+    ui32Pos = USB_CDC_NCM_NTH16_SIZE;
+    for(ui32Count = 0; (ui32Frame + ui32Count) < ui32Frames; ui32Count++)
+    {
+        ui32Index = (ui32Pos + 3) & ~3;
+        if((((ui32Index + ui32Size + 3) & ~3) +
+            USB_CDC_NCM_NDP16_SIZE(ui32Count + 1)) > SIM_NCM_NTB_SIZE)
+        {
+            break;
+        }
+
+        ui32Offset = (ui32Frame + ui32Count) * ui32Size;
+        for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+        {
+            pui8NTB[ui32Index + ui32Idx] = PatternByte(ui32Offset + ui32Idx);
+        }
+
+        pui16Index[ui32Count] = ui32Index;
+        ui32Pos = ui32Index + ui32Size;
+    }
+
+    //
+    // The NDP16, whose datagram pointers end with a null entry.
+    //
+    ui32NDP = (ui32Pos + 3) & ~3;
+    NTBLongPut(pui8NTB + ui32NDP, USB_CDC_NCM_NDP16_SIGNATURE);
+    NTBShortPut(pui8NTB + ui32NDP + 4, USB_CDC_NCM_NDP16_SIZE(ui32Count));
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        NTBShortPut(pui8NTB + ui32NDP + 8 + (ui32Idx * 4),
+                    pui16Index[ui32Idx]);
+        NTBShortPut(pui8NTB + ui32NDP + 10 + (ui32Idx * 4), ui32Size);
+    }
+
+    //
+    // The NTH16.
+    //
+    ui32Pos = ui32NDP + USB_CDC_NCM_NDP16_SIZE(ui32Count);
+    NTBLongPut(pui8NTB, USB_CDC_NCM_NTH16_SIGNATURE);
+    NTBShortPut(pui8NTB + 4, USB_CDC_NCM_NTH16_SIZE);
+    NTBShortPut(pui8NTB + 6, ui16Sequence);
+    NTBShortPut(pui8NTB + 8, ui32Pos);
+    NTBShortPut(pui8NTB + 10, ui32NDP);
+
+    *pui32Count = ui32Count;
+
+    return(ui32Pos);
+}
+
+//*****************************************************************************
+//
+// Sends an NTB to the NCM device.  An NTB shorter than the largest that the
+// device accepts, whose length is a multiple of the maximum packet size, is
+// ended with a zero-length packet.
+//
+//*****************************************************************************
+static bool
+HostNTBSend(const uint8_t *pui8NTB, uint32_t ui32Size)
+{
+    uint32_t ui32Offset, ui32Packet, ui32NAKs;
+    bool bZLP;
+
+    ui32NAKs = 0;
+    bZLP = (!(ui32Size % g_sHost.ui32OutMaxPacket) &&
+            (ui32Size < SIM_NCM_NTB_SIZE)) ? true : false;
+    for(ui32Offset = 0; (ui32Offset < ui32Size) || bZLP; )
+    {
+        ui32Packet = ui32Size - ui32Offset;
+        if(ui32Packet > g_sHost.ui32OutMaxPacket)
+        {
+            ui32Packet = g_sHost.ui32OutMaxPacket;
+        }
+
+        if(USBModelOut(g_sHost.ui32OutEP, pui8NTB + ui32Offset,
+                       ui32Packet) == USBMODEL_ACK)
+        {
+            ui32NAKs = 0;
+            ui32Offset += ui32Packet;
+            if(ui32Packet == 0)
+            {
+                bZLP = false;
+            }
+        }
+        else if(!ScriptCheck(++ui32NAKs < HOST_NAK_LIMIT,
+                             "NCM OUT endpoint accepts data"))
+        {
+            return(false);
+        }
+
+        DevicePoll();
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Sends frames from the host to the NCM device.
+//
+//*****************************************************************************
+static bool
+CmdNCMOut(char **ppcArgs, uint32_t ui32Args)
+{
+    uint8_t pui8NTB[SIM_NCM_NTB_SIZE];
+    uint32_t ui32Frames, ui32Frame, ui32Count, ui32Size, ui32NTBs, ui32Held;
+    tUSBDNCMStats sNCMStart, sNCMEnd;
+    tUSBModelStats sStart, sEnd;
+
+    if(!NCMArgsParse(ppcArgs, ui32Args, true, &ui32Frames))
+    {
+        return(false);
+    }
+
+    g_sApp.ui32RxCount = 0;
+    g_sApp.ui32RxBad = 0;
+    g_sApp.ui32RxFrames = 0;
+    g_sApp.ui32Held = 0;
+
+    USBDNCMStatsGet(&g_sNCMDevice, &sNCMStart);
+    USBModelStatsGet(&sStart);
+
+    for(ui32Frame = 0, ui32NTBs = 0; ui32Frame < ui32Frames; ui32NTBs++)
+    {
+        ui32Size = HostNTBBuild(pui8NTB, ui32Frame, ui32Frames,
+                                (uint16_t)ui32NTBs, &ui32Count);
+        if(!HostNTBSend(pui8NTB, ui32Size))
+        {
+            break;
+        }
+        ui32Frame += ui32Count;
+    }
+
+    USBModelSync();
+    USBModelStatsGet(&sEnd);
+    USBDNCMStatsGet(&g_sNCMDevice, &sNCMEnd);
+
+    //
+    // Let go of the datagrams held by the device.
+    //
+    ui32Held = g_sApp.ui32Held;
+    while(g_sApp.ui32Held)
+    {
+        USBDNCMRxDatagramRelease(&g_sNCMDevice,
+                                 g_sApp.ppui8Held[--g_sApp.ui32Held]);
+    }
+
+    if(ui32Frame < ui32Frames)
+    {
+        return(false);
+    }
+
+    ScriptCheck(g_sApp.ui32RxFrames == ui32Frames, "all frames received");
+    ScriptCheck(g_sApp.ui32RxCount == (ui32Frames * g_sApp.ui32FrameSize),
+                "all of the data received");
+    ScriptCheck(g_sApp.ui32RxBad == 0, "received data matches");
+    ScriptCheck(sNCMEnd.ui32RxErrors == sNCMStart.ui32RxErrors,
+                "no NTBs dropped");
+
+    NCMReport("ncm-out", ui32Frames, ui32NTBs, &sStart, &sEnd);
+    MetricSet("held", ui32Held);
+    MetricSet("rx-no-buffer",
+              sNCMEnd.ui32RxNoBuffer - sNCMStart.ui32RxNoBuffer);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Checks an NTB received from the NCM device and the frames in it, which are
+// the next part of the stream.  Returns the number of frames, or 0 if the
+// NTB is malformed.
+//
+//*****************************************************************************
+static uint32_t
+HostNTBCheck(const uint8_t *pui8NTB, uint32_t ui32Size, uint32_t ui32Frame)
+{
+    uint32_t ui32NDP, ui32Length, ui32Entry, ui32Index, ui32Count;
+    uint32_t ui32Offset, ui32Idx;
+
+    if((ui32Size < USB_CDC_NCM_NTH16_SIZE) ||
+       (NTBLongGet(pui8NTB) != USB_CDC_NCM_NTH16_SIGNATURE) ||
+       (NTBShortGet(pui8NTB + 8) != ui32Size))
+    {
+        return(0);
+    }
+
+    ui32NDP = NTBShortGet(pui8NTB + 10);
+    if((ui32NDP & 3) || ((ui32NDP + USB_CDC_NCM_NDP16_SIZE(1)) > ui32Size) ||
+       (NTBLongGet(pui8NTB + ui32NDP) != USB_CDC_NCM_NDP16_SIGNATURE))
+    {
+        return(0);
+    }
+
+    ui32Length = NTBShortGet(pui8NTB + ui32NDP + 4);
+    if((ui32NDP + ui32Length) > ui32Size)
+    {
+        return(0);
+    }
+
+    ui32Count = 0;
+    for(ui32Entry = 8; (ui32Entry + 4) <= ui32Length; ui32Entry += 4)
+    {
+        ui32Index = NTBShortGet(pui8NTB + ui32NDP + ui32Entry);
+        if(ui32Index == 0)
+        {
+            break;
+        }
+
+        if((NTBShortGet(pui8NTB + ui32NDP + ui32Entry + 2) !=
+            g_sApp.ui32FrameSize) ||
+           ((ui32Index + g_sApp.ui32FrameSize) > ui32Size))
+        {
+            return(0);
+        }
+
+        ui32Offset = (ui32Frame + ui32Count) * g_sApp.ui32FrameSize;
+        for(ui32Idx = 0; ui32Idx < g_sApp.ui32FrameSize; ui32Idx++)
+        {
+            if(pui8NTB[ui32Index + ui32Idx] !=
+               PatternByte(ui32Offset + ui32Idx))
+            {
+                return(0);
+            }
+        }
+        ui32Count++;
+    }
+
+    return(ui32Count);
+}
+
+//*****************************************************************************
+//
+// Sends frames from the NCM device to the host.
+//
+//*****************************************************************************
+static bool
+CmdNCMIn(char **ppcArgs, uint32_t ui32Args)
+{
+    uint8_t pui8NTB[USBDNCM_NTB_IN_MAX_SIZE + 512];
+    uint32_t ui32Frames, ui32Frame, ui32Count, ui32Size, ui32NTBs, ui32Idx;
+    uint32_t ui32Packet, ui32NAKs, ui32Result;
+    tUSBModelStats sStart, sEnd;
+
+    if(!NCMArgsParse(ppcArgs, ui32Args, false, &ui32Frames))
+    {
+        return(false);
+    }
+
+    for(ui32Idx = 0; ui32Idx < (ui32Frames * g_sApp.ui32FrameSize); ui32Idx++)
+    {
+        ((uint8_t *)g_pui32TxBuffer)[ui32Idx] = PatternByte(ui32Idx);
+    }
+    g_sApp.ui32TxFrames = ui32Frames;
+    g_sApp.ui32TxQueued = 0;
+    g_sApp.ui32TxDone = 0;
+
+    USBModelStatsGet(&sStart);
+
+    ui32NAKs = 0;
+    ui32Size = 0;
+    for(ui32Frame = 0, ui32NTBs = 0; ui32Frame < ui32Frames; )
+    {
+        DevicePoll();
+
+        ui32Packet = sizeof(pui8NTB) - ui32Size;
+        ui32Result = USBModelIn(g_sHost.ui32InEP, pui8NTB + ui32Size,
+                                &ui32Packet);
+
+        if(ui32Result != USBMODEL_ACK)
+        {
+            if(!ScriptCheck((ui32Result == USBMODEL_NAK) &&
+                            (++ui32NAKs < HOST_NAK_LIMIT),
+                            "NCM IN endpoint sends data"))
+            {
+                return(false);
+            }
+            continue;
+        }
+
+        //
+        // A short packet, or the largest NTB, ends the NTB.
+        //
+        ui32NAKs = 0;
+        ui32Size += ui32Packet;
+        if((ui32Packet == g_sHost.ui32InMaxPacket) &&
+           (ui32Size < USBDNCM_NTB_IN_MAX_SIZE))
+        {
+            continue;
+        }
+
+        ui32Count = HostNTBCheck(pui8NTB, ui32Size, ui32Frame);
+        if(!ScriptCheck(ui32Count != 0, "NTB holds the next frames"))
+        {
+            return(false);
+        }
+
+        ui32Frame += ui32Count;
+        ui32NTBs++;
+        ui32Size = 0;
+    }
+
+    USBModelSync();
+    USBModelStatsGet(&sEnd);
+
+    ScriptCheck(ui32Frame == ui32Frames, "no more frames than were sent");
+    ScriptCheck(g_sApp.ui32TxDone == ui32Frames, "all frames completed");
+
+    NCMReport("ncm-in", ui32Frames, ui32NTBs, &sStart, &sEnd);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Checks that the device is the audio device, and that it is configured.
+//
+//*****************************************************************************
+static bool
+AudioCheck(void)
+{
+    return(ScriptCheck(g_sApp.ui32Class == SIM_DEVICE_AUDIO, "audio device") &&
+           ScriptCheck(g_sApp.bConnected, "device configured"));
+}
+
+//*****************************************************************************
+//
+// Reads a feedback value from the audio device.  Returns false if the device
+// had no value waiting to be sent.
+//
+//*****************************************************************************
+static bool
+AudioFeedbackRead(uint32_t *pui32Value)
+{
+    uint8_t pui8Value[4];
+    uint32_t ui32Size;
+
+    ui32Size = sizeof(pui8Value);
+    if((USBModelIn(g_sHost.ui32FeedbackEP, pui8Value, &ui32Size) !=
+        USBMODEL_ACK) || (ui32Size != 3))
+    {
+        return(false);
+    }
+
+    *pui32Value = pui8Value[0] | (pui8Value[1] << 8) | (pui8Value[2] << 16);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Lets the bus run idle until the next frame starts.
+//
+//*****************************************************************************
+static void
+HostFrameWait(void)
+{
+    tUSBModelStats sStats;
+    uint32_t ui32Frames;
+
+    USBModelStatsGet(&sStats);
+    ui32Frames = sStats.ui32Frames;
+
+    do
+    {
+        USBModelWait(10000);
+        USBModelStatsGet(&sStats);
+    }
+    while(sStats.ui32Frames == ui32Frames);
+}
+
+//*****************************************************************************
+//
+// Finds the streaming interface of the audio device and makes it active.
+//
+//*****************************************************************************
+static bool
+CmdAudioStart(char **ppcArgs, uint32_t ui32Args)
+{
+    uint8_t pui8Config[512];
+    uint32_t ui32Size, ui32Offset, ui32Stream, ui32Format, ui32Data;
+    uint32_t ui32Feedback, ui32Rate, ui32Value;
+    const uint8_t *pui8Desc;
+
+    if(!AudioCheck())
+    {
+        return(false);
+    }
+
+    ui32Size = HostConfigGet(USB_DTYPE_CONFIGURATION, pui8Config,
+                             sizeof(pui8Config));
+    if(!ScriptCheck(ui32Size != 0, "configuration descriptor"))
+    {
+        return(false);
+    }
+
+    //
+    // Find the first interface descriptor of the streaming interface, which
+    // is that of its idle setting, and the format and the endpoints which
+    // follow it.
+    //
+    ui32Stream = 0;
+    ui32Format = 0;
+    ui32Data = 0;
+    ui32Feedback = 0;
+
+    for(ui32Offset = 0; (ui32Offset + 1) < ui32Size;
+        ui32Offset += pui8Config[ui32Offset])
+    {
+        pui8Desc = pui8Config + ui32Offset;
+
+        if(pui8Desc[0] == 0)
+        {
+            break;
+        }
+
+        if((pui8Desc[1] == USB_DTYPE_INTERFACE) &&
+           (pui8Desc[5] == USB_CLASS_AUDIO) &&
+           (pui8Desc[6] == USB_ASC_AUDIO_STREAMING) && !ui32Stream)
+        {
+            ui32Stream = ui32Offset;
+            g_sHost.ui32DataInterface = pui8Desc[2];
+        }
+        else if(ui32Stream && (pui8Desc[1] == USB_DTYPE_CS_INTERFACE) &&
+                (pui8Desc[2] == USB_ASDSTYPE_FORMAT_TYPE))
+        {
+            ui32Format = ui32Offset;
+        }
+        else if(ui32Stream && (pui8Desc[1] == USB_DTYPE_ENDPOINT))
+        {
+            if(pui8Desc[2] & USB_EP_DESC_IN)
+            {
+                ui32Feedback = ui32Offset;
+            }
+            else
+            {
+                ui32Data = ui32Offset;
+            }
+        }
+    }
+
+    if(!ScriptCheck(ui32Stream && ui32Format && ui32Data && ui32Feedback,
+                    "audio streaming interface with a feedback endpoint"))
+    {
+        return(false);
+    }
+
+    g_sHost.ui32IsocEP = pui8Config[ui32Data + 2] & USB_EP_DESC_NUM_M;
+    g_sHost.ui32FeedbackEP = pui8Config[ui32Feedback + 2] & USB_EP_DESC_NUM_M;
+    g_sHost.ui32DataAltSetting = 1;
+
+    if(!ScriptCheck(HostControl(USB_RTYPE_DIR_OUT | USB_RTYPE_STANDARD |
+                                USB_RTYPE_INTERFACE, USBREQ_SET_INTERFACE,
+                                g_sHost.ui32DataAltSetting,
+                                g_sHost.ui32DataInterface, 0, 0, 0) ==
+                    USBMODEL_ACK, "SET_INTERFACE") ||
+       !ScriptCheck(AudioFeedbackRead(&ui32Value), "feedback value"))
+    {
+        return(false);
+    }
+
+    pui8Desc = pui8Config + ui32Format;
+    ui32Rate = pui8Desc[8] | (pui8Desc[9] << 8) | (pui8Desc[10] << 16);
+
+    printf("%s:%u: audio-start: %u Hz, %u bit samples in %u bytes, %u byte "
+           "packets, format at %u, endpoints at %u and %u, feedback %u "
+           "(%.3f samples/frame)\n", g_pcScript, (unsigned)g_ui32Line,
+           (unsigned)ui32Rate, pui8Desc[6], pui8Desc[5],
+           pui8Config[ui32Data + 4] | (pui8Config[ui32Data + 5] << 8),
+           (unsigned)(ui32Format - ui32Stream),
+           (unsigned)(ui32Data - ui32Stream),
+           (unsigned)(ui32Feedback - ui32Stream), (unsigned)ui32Value,
+           ui32Value / 16384.0);
+
+    MetricSet("rate", ui32Rate);
+    MetricSet("bits", pui8Desc[6]);
+    MetricSet("subframe", pui8Desc[5]);
+    MetricSet("max-packet",
+              pui8Config[ui32Data + 4] | (pui8Config[ui32Data + 5] << 8));
+    MetricSet("sync-endpoint", pui8Config[ui32Data + 8]);
+    MetricSet("refresh", pui8Config[ui32Feedback + 7]);
+    MetricSet("format-offset", ui32Format - ui32Stream);
+    MetricSet("endpoint-offset", ui32Data - ui32Stream);
+    MetricSet("feedback-offset", ui32Feedback - ui32Stream);
+    MetricSet("feedback", ui32Value);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Gives the audio device a ring.  The data played from the ring is verified
+// from the next byte that the host sends.
+//
+//*****************************************************************************
+static bool
+CmdAudioRing(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32Size, ui32Period;
+
+    if(!AudioCheck() ||
+       !ScriptCheck(ui32Args == 2, "audio-ring bytes period"))
+    {
+        return(false);
+    }
+
+    ui32Size = strtoul(ppcArgs[0], 0, 0);
+    ui32Period = strtoul(ppcArgs[1], 0, 0);
+
+    if(!ScriptCheck((ui32Size <= SIM_AUDIO_RING_MAX) && (ui32Period != 0),
+                    "a ring of at most 8192 bytes"))
+    {
+        return(false);
+    }
+
+    g_sApp.ui32RxCount = g_sApp.ui32AudioSent;
+    g_sApp.ui32RxBad = 0;
+    g_sApp.ui32Periods = 0;
+
+    return(ScriptCheck(USBAudioRingOut(g_psAudioDevice, g_pui32AudioRing,
+                                       ui32Size, ui32Period,
+                                       AudioPeriod) == 0,
+                       "USBAudioRingOut"));
+}
+
+//*****************************************************************************
+//
+// Streams audio data to the audio device, one packet in each frame, while the
+// codec plays it from the ring.
+//
+//*****************************************************************************
+static bool
+CmdAudioOut(char **ppcArgs, uint32_t ui32Args)
+{
+    uint8_t pui8Packet[SIM_AUDIO_PACKET_MAX];
+    uint32_t ui32Packets, ui32Size, ui32Codec, ui32Idx, ui32Offset;
+    uint32_t ui32Feedback, ui32FeedbackReads, ui32Overruns, ui32Level;
+    tAudioInstance *psInst;
+    tUSBModelStats sStart, sEnd;
+
+    if(!AudioCheck() ||
+       !ScriptCheck(ui32Args == 3, "audio-out packets size codec-bytes"))
+    {
+        return(false);
+    }
+
+    psInst = &g_psAudioDevice->sPrivateData;
+    ui32Packets = strtoul(ppcArgs[0], 0, 0);
+    ui32Size = strtoul(ppcArgs[1], 0, 0);
+    ui32Codec = strtoul(ppcArgs[2], 0, 0);
+
+    if(!ScriptCheck(g_sHost.ui32IsocEP != 0, "streaming interface active") ||
+       !ScriptCheck(psInst->sRing.pui8Data != 0, "ring given") ||
+       !ScriptCheck((ui32Size <= psInst->ui16MaxPacketSize) &&
+                    !(ui32Codec % psInst->ui8FrameSize),
+                    "packets of at most the maximum packet size, and whole "
+                    "samples played"))
+    {
+        return(false);
+    }
+
+    g_sApp.ui32RxBad = 0;
+    g_sApp.ui32Periods = 0;
+    g_sApp.ui32Underruns = 0;
+    ui32Overruns = psInst->sRing.ui32Overruns;
+    ui32Feedback = 0;
+    ui32FeedbackReads = 0;
+    USBModelStatsGet(&sStart);
+
+    for(ui32Idx = 0; ui32Idx < ui32Packets; ui32Idx++)
+    {
+        //
+        // An isochronous packet is never sent again, whether or not the
+        // device had room for it.
+        //
+        for(ui32Offset = 0; ui32Offset < ui32Size; ui32Offset++)
+        {
+            pui8Packet[ui32Offset] =
+                PatternByte(g_sApp.ui32AudioSent + ui32Offset);
+        }
+        USBModelOut(g_sHost.ui32IsocEP, pui8Packet, ui32Size);
+        g_sApp.ui32AudioSent += ui32Size;
+
+        if(AudioFeedbackRead(&ui32Feedback))
+        {
+            ui32FeedbackReads++;
+        }
+
+        //
+        // The codec plays its samples whether or not the ring holds them.
+        //
+        if(!AudioPlay(ui32Codec))
+        {
+            g_sApp.ui32Underruns++;
+        }
+        USBAudioFeedbackUpdate(g_psAudioDevice,
+                               ui32Codec / psInst->ui8FrameSize);
+
+        HostFrameWait();
+    }
+
+    USBModelSync();
+    USBModelStatsGet(&sEnd);
+
+    ui32Overruns = psInst->sRing.ui32Overruns - ui32Overruns;
+    ui32Level = ((psInst->sRing.ui32Write + psInst->sRing.ui32Size -
+                  psInst->sRing.ui32Read) % psInst->sRing.ui32Size);
+
+    printf("%s:%u: audio-out %u x %u bytes, codec %u bytes/frame: "
+           "%u overruns, %u underruns, %u bytes in the ring, %u periods, "
+           "%u bad bytes, %u DMA bytes, %u feedback reads, feedback %u "
+           "(%.3f samples/frame)\n", g_pcScript, (unsigned)g_ui32Line,
+           (unsigned)ui32Packets, (unsigned)ui32Size, (unsigned)ui32Codec,
+           (unsigned)ui32Overruns, (unsigned)g_sApp.ui32Underruns,
+           (unsigned)ui32Level, (unsigned)g_sApp.ui32Periods,
+           (unsigned)g_sApp.ui32RxBad,
+           (unsigned)(sEnd.ui64DMABytes - sStart.ui64DMABytes),
+           (unsigned)ui32FeedbackReads, (unsigned)ui32Feedback,
+           ui32Feedback / 16384.0);
+
+    MetricSet("overruns", ui32Overruns);
+    MetricSet("underruns", g_sApp.ui32Underruns);
+    MetricSet("level", ui32Level);
+    MetricSet("periods", g_sApp.ui32Periods);
+    MetricSet("bad", g_sApp.ui32RxBad);
+    MetricSet("dma-bytes", sEnd.ui64DMABytes - sStart.ui64DMABytes);
+    MetricSet("feedback-reads", ui32FeedbackReads);
+    MetricSet("feedback", ui32Feedback);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Reads a report from the HID mouse and adds it to the host's sums.  Returns
+// false if the mouse had no report waiting to be sent.
+//
+//*****************************************************************************
+static bool
+MouseReportRead(void)
+{
+    uint8_t pui8Report[8];
+    uint32_t ui32Size;
+
+    ui32Size = sizeof(pui8Report);
+    if((USBModelIn(g_sHost.ui32IntEP, pui8Report, &ui32Size) !=
+        USBMODEL_ACK) ||
+       !ScriptCheck(ui32Size == MOUSE_REPORT_SIZE, "mouse report size"))
+    {
+        return(false);
+    }
+
+    g_sHost.ui32Reports++;
+    g_sHost.i32X += (int8_t)pui8Report[1];
+    g_sHost.i32Y += (int8_t)pui8Report[2];
+
+    if(pui8Report[0] != g_sHost.ui8Buttons)
+    {
+        g_sHost.ui8Buttons = pui8Report[0];
+        g_sHost.ui32Clicks++;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Moves the HID mouse in every frame, while the host collects its reports
+// less often.
+//
+//*****************************************************************************
+static bool
+CmdMouse(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32Reports, ui32Poll, ui32Idx, ui32Errors, ui32Latency;
+    int32_t i32DeltaX, i32DeltaY;
+    uint8_t ui8Buttons;
+    bool bClick;
+    tUSBDHIDReportStats sStats;
+
+    if(!ScriptCheck((g_sApp.ui32Class == SIM_DEVICE_MOUSE) ||
+                    (g_sApp.ui32Class == SIM_DEVICE_COMPOSITE),
+                    "mouse device") ||
+       !ScriptCheck(g_sApp.bConnected, "device configured") ||
+       !ScriptCheck(g_sHost.ui32IntEP != 0, "interrupt IN endpoint") ||
+       !ScriptCheck(((ui32Args == 4) || ((ui32Args == 5) &&
+                                         !strcmp(ppcArgs[4], "click"))),
+                    "mouse reports dx dy poll [click]"))
+    {
+        return(false);
+    }
+
+    ui32Reports = strtoul(ppcArgs[0], 0, 0);
+    i32DeltaX = strtol(ppcArgs[1], 0, 0);
+    i32DeltaY = strtol(ppcArgs[2], 0, 0);
+    ui32Poll = strtoul(ppcArgs[3], 0, 0);
+    bClick = (ui32Args == 5);
+
+    if(!ScriptCheck((i32DeltaX >= -127) && (i32DeltaX <= 127) &&
+                    (i32DeltaY >= -127) && (i32DeltaY <= 127) &&
+                    (ui32Poll != 0), "movement of -127 to 127 and a poll "
+                    "interval of at least one frame"))
+    {
+        return(false);
+    }
+
+    g_sHost.ui32Reports = 0;
+    g_sHost.i32X = 0;
+    g_sHost.i32Y = 0;
+    g_sHost.ui32Clicks = 0;
+    USBDHIDReportStatsClear(&g_sMouseDevice.sPrivateData.sHIDDevice);
+
+    ui32Errors = 0;
+    ui8Buttons = g_sHost.ui8Buttons;
+
+    for(ui32Idx = 0; ui32Idx < ui32Reports; ui32Idx++)
+    {
+        if(bClick)
+        {
+            ui8Buttons ^= MOUSE_REPORT_BUTTON_1;
+        }
+
+        if(USBDHIDMouseStateChange(&g_sMouseDevice, (int8_t)i32DeltaX,
+                                   (int8_t)i32DeltaY, ui8Buttons) !=
+           MOUSE_SUCCESS)
+        {
+            ui32Errors++;
+        }
+
+        if(((ui32Idx + 1) % ui32Poll) == 0)
+        {
+            MouseReportRead();
+        }
+
+        HostFrameWait();
+    }
+
+    //
+    // Collect the reports that are still queued, one in each frame.
+    //
+    for(ui32Idx = 0; (ui32Idx <= ui32Reports) && MouseReportRead();
+        ui32Idx++)
+    {
+        HostFrameWait();
+    }
+
+    USBDHIDReportStatsGet(&g_sMouseDevice.sPrivateData.sHIDDevice, &sStats);
+
+    //
+    // Find the longest latency in the histogram.
+    //
+    for(ui32Latency = USBDHID_LATENCY_BINS - 1;
+        ui32Latency && !sStats.pui32Latency[ui32Latency]; ui32Latency--)
+    {
+    }
+
+    printf("%s:%u: mouse: %u errors, %u queued, %u coalesced, %u dropped, "
+           "%u sent, %u received, moved %d,%d, %u clicks, latency bin %u\n",
+           g_pcScript, (unsigned)g_ui32Line, (unsigned)ui32Errors,
+           (unsigned)sStats.ui32Queued, (unsigned)sStats.ui32Coalesced,
+           (unsigned)sStats.ui32Dropped, (unsigned)sStats.ui32Sent,
+           (unsigned)g_sHost.ui32Reports, (int)g_sHost.i32X,
+           (int)g_sHost.i32Y, (unsigned)g_sHost.ui32Clicks,
+           (unsigned)ui32Latency);
+
+    MetricSet("errors", ui32Errors);
+    MetricSet("queued", sStats.ui32Queued);
+    MetricSet("coalesced", sStats.ui32Coalesced);
+    MetricSet("dropped", sStats.ui32Dropped);
+    MetricSet("sent", sStats.ui32Sent);
+    MetricSet("received", g_sHost.ui32Reports);
+    MetricSet("x", g_sHost.i32X);
+    MetricSet("y", g_sHost.i32Y);
+    MetricSet("clicks", g_sHost.ui32Clicks);
+    MetricSet("latency", ui32Latency);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Sends a class request to an interface or an endpoint of the device.
+//
+//*****************************************************************************
+static bool
+CmdRequest(char **ppcArgs, uint32_t ui32Args)
+{
+    uint8_t pui8Data[8];
+    uint32_t ui32Result, ui32Size;
+    uint8_t ui8Recipient;
+
+    if(!ScriptCheck((ui32Args == 2) && (!strcmp(ppcArgs[0], "interface") ||
+                                        !strcmp(ppcArgs[0], "endpoint")),
+                    "request interface|endpoint number") ||
+       !ScriptCheck(g_sApp.bConnected, "device configured"))
+    {
+        return(false);
+    }
+
+    ui8Recipient = strcmp(ppcArgs[0], "interface") ? USB_RTYPE_ENDPOINT :
+                                                     USB_RTYPE_INTERFACE;
+
+    //
+    // Ask for the HID input report, which a device that is not a HID device
+    // has no reason to answer.
+    //
+    ui32Size = 0;
+    ui32Result = HostControl(USB_RTYPE_DIR_IN | USB_RTYPE_CLASS |
+                             ui8Recipient, USBREQ_GET_REPORT,
+                             SIM_HID_INPUT_REPORT,
+                             (uint16_t)strtoul(ppcArgs[1], 0, 0),
+                             sizeof(pui8Data), pui8Data, &ui32Size);
+
+    printf("%s:%u: request: %s, %u bytes\n", g_pcScript,
+           (unsigned)g_ui32Line,
+           (ui32Result == USBMODEL_ACK) ? "answered" :
+           ((ui32Result == USBMODEL_STALL) ? "stalled" : "not answered"),
+           (unsigned)ui32Size);
+
+    MetricSet("answered", (ui32Result == USBMODEL_ACK) ? 1 : 0);
+    MetricSet("stalled", (ui32Result == USBMODEL_STALL) ? 1 : 0);
+    MetricSet("size", ui32Size);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Reports the event dispatch statistics of the devices in the composite
+// device, and clears them.
+//
+//*****************************************************************************
+static bool
+CmdComposite(char **ppcArgs, uint32_t ui32Args)
+{
+    tCompositeStats sBulk, sMouse;
+
+    if(!ScriptCheck(g_sApp.ui32Class == SIM_DEVICE_COMPOSITE,
+                    "composite device") ||
+       !ScriptCheck(USBDCompositeStatsGet(&g_sCompositeDevice,
+                                          SIM_COMPOSITE_BULK, &sBulk) &&
+                    USBDCompositeStatsGet(&g_sCompositeDevice,
+                                          SIM_COMPOSITE_MOUSE, &sMouse),
+                    "USBDCompositeStatsGet"))
+    {
+        return(false);
+    }
+
+    USBDCompositeStatsClear(&g_sCompositeDevice);
+
+    printf("%s:%u: composite: bulk %u endpoint events, %u skipped, "
+           "%u requests, %u EP0 events; mouse %u endpoint events, "
+           "%u skipped, %u requests, %u EP0 events\n", g_pcScript,
+           (unsigned)g_ui32Line, (unsigned)sBulk.ui32EndpointEvents,
+           (unsigned)sBulk.ui32EndpointSkipped, (unsigned)sBulk.ui32Requests,
+           (unsigned)sBulk.ui32EP0Events, (unsigned)sMouse.ui32EndpointEvents,
+           (unsigned)sMouse.ui32EndpointSkipped,
+           (unsigned)sMouse.ui32Requests, (unsigned)sMouse.ui32EP0Events);
+
+    MetricSet("bulk-events", sBulk.ui32EndpointEvents);
+    MetricSet("bulk-skipped", sBulk.ui32EndpointSkipped);
+    MetricSet("bulk-requests", sBulk.ui32Requests);
+    MetricSet("bulk-ep0", sBulk.ui32EP0Events);
+    MetricSet("mouse-events", sMouse.ui32EndpointEvents);
+    MetricSet("mouse-skipped", sMouse.ui32EndpointSkipped);
+    MetricSet("mouse-requests", sMouse.ui32Requests);
+    MetricSet("mouse-ep0", sMouse.ui32EP0Events);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Records the first pipe to be given a scheduler event in each frame.
+//
+//*****************************************************************************
+static void
+PipeCallback(uint32_t ui32Pipe, uint32_t ui32Event)
+{
+    uint32_t ui32Idx;
+
+    if((ui32Event != USB_EVENT_SCHEDULER) ||
+       (g_sPipes.ui32First < g_sPipes.ui32Count))
+    {
+        return;
+    }
+
+    for(ui32Idx = 0; ui32Idx < g_sPipes.ui32Count; ui32Idx++)
+    {
+        if(g_sPipes.pui32Pipes[ui32Idx] == ui32Pipe)
+        {
+            g_sPipes.ui32First = ui32Idx;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Allocates and configures periodic pipes on the simulated device, either
+// all IN pipes or alternately IN and OUT pipes, each on an endpoint of its
+// own.  The pipes that the host controller driver has no bandwidth for are
+// freed again, and the number of them is returned.
+//
+//*****************************************************************************
+static uint32_t
+PipesOpen(bool bIsoc, bool bOut, uint32_t ui32Size, uint32_t ui32Interval,
+          uint32_t ui32Count)
+{
+    uint32_t ui32Idx, ui32Type, ui32Pipe, ui32Refused;
+
+    g_sPipes.ui32Count = 0;
+    ui32Refused = 0;
+
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        if(bOut && (ui32Idx & 1))
+        {
+            ui32Type = bIsoc ? USBHCD_PIPE_ISOC_OUT : USBHCD_PIPE_INTR_OUT;
+        }
+        else
+        {
+            ui32Type = bIsoc ? USBHCD_PIPE_ISOC_IN : USBHCD_PIPE_INTR_IN;
+        }
+
+        ui32Pipe = USBHCDPipeAllocSize(0, ui32Type, &g_sSimDevice, ui32Size,
+                                       PipeCallback);
+        if(!ScriptCheck(ui32Pipe != 0, "pipe allocated"))
+        {
+            break;
+        }
+
+        if(USBHCDPipeConfig(ui32Pipe, ui32Size, ui32Interval,
+                            bOut ? ((ui32Idx / 2) + 1) : (ui32Idx + 1)))
+        {
+            USBHCDPipeFree(ui32Pipe);
+            ui32Refused++;
+        }
+        else
+        {
+            g_sPipes.pui32Pipes[g_sPipes.ui32Count++] = ui32Pipe;
+        }
+    }
+
+    return(ui32Refused);
+}
+
+//*****************************************************************************
+//
+// Frees the pipes opened by PipesOpen().
+//
+//*****************************************************************************
+static void
+PipesClose(void)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < g_sPipes.ui32Count; ui32Idx++)
+    {
+        USBHCDPipeFree(g_sPipes.pui32Pipes[ui32Idx]);
+    }
+
+    g_sPipes.ui32Count = 0;
+}
+
+//*****************************************************************************
+//
+// Opens periodic pipes until the host controller driver refuses them for
+// want of bandwidth.
+//
+//*****************************************************************************
+static bool
+CmdPeriodic(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32Size, ui32Interval, ui32Count, ui32Refused;
+
+    if(!ScriptCheck((ui32Args == 4) &&
+                    (!strcmp(ppcArgs[0], "intr") ||
+                     !strcmp(ppcArgs[0], "isoc")),
+                    "periodic intr|isoc size interval count"))
+    {
+        return(false);
+    }
+
+    ui32Size = strtoul(ppcArgs[1], 0, 0);
+    ui32Interval = strtoul(ppcArgs[2], 0, 0);
+    ui32Count = strtoul(ppcArgs[3], 0, 0);
+
+    if(!ScriptCheck((ui32Size != 0) && (ui32Size <= 1024) &&
+                    (ui32Count <= SIM_PIPES_MAX),
+                    "packets of at most 1024 bytes and at most 6 pipes"))
+    {
+        return(false);
+    }
+
+    ui32Refused = PipesOpen(!strcmp(ppcArgs[0], "isoc"), true, ui32Size,
+                            ui32Interval, ui32Count);
+
+    printf("%s:%u: periodic: %u accepted, %u refused\n", g_pcScript,
+           (unsigned)g_ui32Line, (unsigned)g_sPipes.ui32Count,
+           (unsigned)ui32Refused);
+
+    MetricSet("accepted", g_sPipes.ui32Count);
+    MetricSet("refused", ui32Refused);
+
+    PipesClose();
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Runs interrupt IN pipes which are all due in every frame, and counts the
+// frames in which each pipe is the first to be given a scheduler event.
+//
+//*****************************************************************************
+static bool
+CmdSchedule(char **ppcArgs, uint32_t ui32Args)
+{
+    tUSBHCDPipeStats sStats;
+    uint32_t ui32Pipes, ui32Frames, ui32Frame, ui32Idx;
+    uint32_t ui32FirstMin, ui32FirstMax, ui32EventsMin, ui32EventsMax;
+
+    if(!ScriptCheck(ui32Args == 2, "schedule pipes frames"))
+    {
+        return(false);
+    }
+
+    ui32Pipes = strtoul(ppcArgs[0], 0, 0);
+    ui32Frames = strtoul(ppcArgs[1], 0, 0);
+
+    if(!ScriptCheck((ui32Pipes != 0) && (ui32Pipes <= (SIM_PIPES_MAX / 2)),
+                    "at most 3 pipes") ||
+       !ScriptCheck(PipesOpen(false, false, 64, 1, ui32Pipes) == 0,
+                    "pipes configured"))
+    {
+        PipesClose();
+        return(false);
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Pipes; ui32Idx++)
+    {
+        g_sPipes.pui32Firsts[ui32Idx] = 0;
+        USBHCDPipeStatsClear(g_sPipes.pui32Pipes[ui32Idx]);
+    }
+
+    //
+    // The host controller driver checks the pipes once for each start of
+    // frame that it handles.
+    //
+    for(ui32Frame = 0; ui32Frame < ui32Frames; ui32Frame++)
+    {
+        g_sPipes.ui32First = SIM_PIPES_MAX;
+
+        USBModelWait(1000000);
+        USBHCDMain();
+
+        if(g_sPipes.ui32First < ui32Pipes)
+        {
+            g_sPipes.pui32Firsts[g_sPipes.ui32First]++;
+        }
+    }
+
+    ui32FirstMin = ui32EventsMin = 0xffffffff;
+    ui32FirstMax = ui32EventsMax = 0;
+
+    for(ui32Idx = 0; ui32Idx < ui32Pipes; ui32Idx++)
+    {
+        USBHCDPipeStatsGet(g_sPipes.pui32Pipes[ui32Idx], &sStats);
+
+        if(sStats.ui32Events < ui32EventsMin)
+        {
+            ui32EventsMin = sStats.ui32Events;
+        }
+        if(sStats.ui32Events > ui32EventsMax)
+        {
+            ui32EventsMax = sStats.ui32Events;
+        }
+        if(g_sPipes.pui32Firsts[ui32Idx] < ui32FirstMin)
+        {
+            ui32FirstMin = g_sPipes.pui32Firsts[ui32Idx];
+        }
+        if(g_sPipes.pui32Firsts[ui32Idx] > ui32FirstMax)
+        {
+            ui32FirstMax = g_sPipes.pui32Firsts[ui32Idx];
+        }
+    }
+
+    printf("%s:%u: schedule: %u-%u events, first in %u-%u frames\n",
+           g_pcScript, (unsigned)g_ui32Line, (unsigned)ui32EventsMin,
+           (unsigned)ui32EventsMax, (unsigned)ui32FirstMin,
+           (unsigned)ui32FirstMax);
+
+    MetricSet("events-min", ui32EventsMin);
+    MetricSet("events-max", ui32EventsMax);
+    MetricSet("first-min", ui32FirstMin);
+    MetricSet("first-max", ui32FirstMax);
+
+    PipesClose();
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Records the failure of a SCSI command by the simulated drive.
+//
+//*****************************************************************************
+static uint32_t
+DriveFail(uint8_t ui8SenseKey, uint8_t ui8SenseCode)
+{
+    g_sDrive.ui8SenseKey = ui8SenseKey;
+    g_sDrive.ui8SenseCode = ui8SenseCode;
+
+    return(SCSI_CMD_STATUS_FAIL);
+}
+
+//*****************************************************************************
+//
+// Moves blocks to or from the simulated drive for a READ(10) or WRITE(10)
+// command.  A command for blocks beyond the end of the drive fails without
+// moving any data, as it does on a real drive.
+//
+//*****************************************************************************
+static uint32_t
+DriveTransfer(bool bWrite, uint32_t ui32LBA, uint8_t *pui8Data,
+              uint32_t *pui32Size, uint32_t ui32NumBlocks)
+{
+    uint8_t *pui8Block;
+
+    if(bWrite)
+    {
+        g_sDrive.ui32Writes++;
+    }
+    else
+    {
+        g_sDrive.ui32Reads++;
+    }
+    g_sDrive.ui64Blocks += ui32NumBlocks;
+
+    if((ui32LBA >= g_sDrive.ui32Blocks) ||
+       (ui32NumBlocks > (g_sDrive.ui32Blocks - ui32LBA)))
+    {
+        *pui32Size = 0;
+        return(DriveFail(SCSI_RS_KEY_ILGL_RQST, SIM_MSC_ASC_LBA_RANGE));
+    }
+
+    pui8Block = g_pui8Drive + (ui32LBA * SIM_MSC_BLOCK_SIZE);
+    *pui32Size = ui32NumBlocks * SIM_MSC_BLOCK_SIZE;
+
+    if(bWrite)
+    {
+        memcpy(pui8Block, pui8Data, *pui32Size);
+    }
+    else
+    {
+        memcpy(pui8Data, pui8Block, *pui32Size);
+    }
+
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+//*****************************************************************************
+//
+// The SCSI commands used by the mass storage class driver, answered by the
+// simulated drive.  These are linked in place of the functions in
+// usbhscsi.c, which would send the commands on the bus.
+//
+//*****************************************************************************
+uint32_t
+USBHSCSIInquiry(uint32_t ui32InPipe, uint32_t ui32OutPipe,
+                uint8_t *pui8Buffer, uint32_t *pui32Size)
+{
+    memset(pui8Buffer, 0, SCSI_INQUIRY_DATA_SZ);
+    *pui32Size = SCSI_INQUIRY_DATA_SZ;
+
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+uint32_t
+USBHSCSIReadCapacity(uint32_t ui32InPipe, uint32_t ui32OutPipe,
+                     uint8_t *pui8Data, uint32_t *pui32Size)
+{
+    uint32_t ui32Last;
+
+    //
+    // The address of the last block and the block size, both big endian.
+    //
+    ui32Last = g_sDrive.ui32Blocks - 1;
+    pui8Data[0] = ui32Last >> 24;
+    pui8Data[1] = ui32Last >> 16;
+    pui8Data[2] = ui32Last >> 8;
+    pui8Data[3] = ui32Last;
+    pui8Data[4] = 0;
+    pui8Data[5] = 0;
+    pui8Data[6] = SIM_MSC_BLOCK_SIZE >> 8;
+    pui8Data[7] = SIM_MSC_BLOCK_SIZE & 0xff;
+    *pui32Size = 8;
+
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+uint32_t
+USBHSCSITestUnitReady(uint32_t ui32InPipe, uint32_t ui32OutPipe)
+{
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+uint32_t
+USBHSCSIRequestSense(uint32_t ui32InPipe, uint32_t ui32OutPipe,
+                     uint8_t *pui8Data, uint32_t *pui32Size)
+{
+    memset(pui8Data, 0, SCSI_REQUEST_SENSE_SZ);
+    pui8Data[0] = SCSI_RS_CUR_ERRORS;
+    pui8Data[SCSI_RS_SKEY] = g_sDrive.ui8SenseKey;
+    pui8Data[SCSI_RS_SKEY_AD_SKEY] = g_sDrive.ui8SenseCode;
+    *pui32Size = SCSI_REQUEST_SENSE_SZ;
+
+    g_sDrive.ui8SenseKey = SCSI_RS_KEY_NO_SENSE;
+    g_sDrive.ui8SenseCode = 0;
+
+    return(SCSI_CMD_STATUS_PASS);
+}
+
+uint32_t
+USBHSCSIRead10(uint32_t ui32InPipe, uint32_t ui32OutPipe, uint32_t ui32LBA,
+               uint8_t *pui8Data, uint32_t *pui32Size, uint32_t ui32NumBlocks)
+{
+    return(DriveTransfer(false, ui32LBA, pui8Data, pui32Size, ui32NumBlocks));
+}
+
+uint32_t
+USBHSCSIWrite10(uint32_t ui32InPipe, uint32_t ui32OutPipe, uint32_t ui32LBA,
+                uint8_t *pui8Data, uint32_t *pui32Size,
+                uint32_t ui32NumBlocks)
+{
+    return(DriveTransfer(true, ui32LBA, pui8Data, pui32Size, ui32NumBlocks));
+}
+
+//*****************************************************************************
+//
+// Handles the events of the mass storage class driver, which need no action.
+//
+//*****************************************************************************
+static void
+MSCCallback(tUSBHMSCInstance *psMSCInstance, uint32_t ui32Event,
+            void *pvEventData)
+{
+}
+
+//*****************************************************************************
+//
+// Opens the mass storage class driver on the simulated drive.
+//
+//*****************************************************************************
+static bool
+CmdMSC(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32Blocks, ui32CacheBlocks, ui32Idx;
+
+    if(!ScriptCheck((ui32Args == 2) && !g_psMSCInstance,
+                    "msc blocks cache-blocks, once in each script"))
+    {
+        return(false);
+    }
+
+    ui32Blocks = strtoul(ppcArgs[0], 0, 0);
+    ui32CacheBlocks = strtoul(ppcArgs[1], 0, 0);
+
+    if(!ScriptCheck((ui32Blocks != 0) && (ui32Blocks <= SIM_MSC_MAX_BLOCKS) &&
+                    (ui32CacheBlocks <= SIM_MSC_CACHE_MAX),
+                    "at most 256 blocks and a cache of at most 16 blocks"))
+    {
+        return(false);
+    }
+
+    //
+    // Fill the drive with the test pattern.
+    //
+    g_sDrive.ui32Blocks = ui32Blocks;
+    for(ui32Idx = 0; ui32Idx < (ui32Blocks * SIM_MSC_BLOCK_SIZE); ui32Idx++)
+    {
+        g_pui8Drive[ui32Idx] = PatternByte(ui32Idx);
+        g_pui8DriveImage[ui32Idx] = PatternByte(ui32Idx);
+    }
+
+    //
+    // Open the driver for the simulated device, as the host controller
+    // driver does once it has enumerated a mass storage device.
+    //
+    g_sSimDevice.ui32Address = 1;
+    g_sSimDevice.psConfigDescriptor =
+        (tConfigDescriptor *)g_pui8MSCConfigDescriptor;
+    g_sSimDevice.ui32ConfigDescriptorSize = sizeof(g_pui8MSCConfigDescriptor);
+
+    g_psMSCInstance = USBHMSCDriveOpen(0, MSCCallback);
+
+    if(!ScriptCheck(g_psMSCInstance &&
+                    g_sUSBHostMSCClassDriver.pfnOpen(&g_sSimDevice),
+                    "mass storage class driver opened") ||
+       !ScriptCheck(USBHMSCDriveReady(g_psMSCInstance) == 0, "drive ready"))
+    {
+        return(false);
+    }
+
+    return(ScriptCheck(USBHMSCCacheConfig(g_psMSCInstance,
+                                          ui32CacheBlocks ?
+                                          (uint8_t *)g_pui32MSCCache : 0,
+                                          ui32CacheBlocks *
+                                          SIM_MSC_BLOCK_SIZE) == 0,
+                       "USBHMSCCacheConfig"));
+}
+
+//*****************************************************************************
+//
+// Parses the arguments of the msc-read and msc-write commands, and clears
+// the drive's counts.
+//
+//*****************************************************************************
+static bool
+MSCArgsParse(char **ppcArgs, uint32_t ui32Args, uint32_t *pui32LBA,
+             uint32_t *pui32Blocks, uint32_t *pui32Count)
+{
+    if(!ScriptCheck(g_psMSCInstance != 0, "drive opened") ||
+       !ScriptCheck((ui32Args == 2) || (ui32Args == 3),
+                    "msc-read|msc-write lba blocks [count]"))
+    {
+        return(false);
+    }
+
+    *pui32LBA = strtoul(ppcArgs[0], 0, 0);
+    *pui32Blocks = strtoul(ppcArgs[1], 0, 0);
+    *pui32Count = (ui32Args == 3) ? strtoul(ppcArgs[2], 0, 0) : 1;
+
+    g_sDrive.ui32Reads = 0;
+    g_sDrive.ui32Writes = 0;
+    g_sDrive.ui64Blocks = 0;
+
+    return(ScriptCheck((*pui32Blocks != 0) &&
+                       (*pui32Blocks <= SIM_MSC_RUN_MAX),
+                       "runs of at most 32 blocks"));
+}
+
+//*****************************************************************************
+//
+// Reports the results of a mass storage command.  The blocks that are
+// pending are those on the drive that differ from what has been written to
+// it through the driver.
+//
+//*****************************************************************************
+static void
+MSCReport(const char *pcCommand, uint32_t ui32Failures, uint32_t ui32Bad)
+{
+    uint32_t ui32Block, ui32Pending, ui32Sense;
+
+    ui32Pending = 0;
+    for(ui32Block = 0; ui32Block < g_sDrive.ui32Blocks; ui32Block++)
+    {
+        if(memcmp(g_pui8Drive + (ui32Block * SIM_MSC_BLOCK_SIZE),
+                  g_pui8DriveImage + (ui32Block * SIM_MSC_BLOCK_SIZE),
+                  SIM_MSC_BLOCK_SIZE))
+        {
+            ui32Pending++;
+        }
+    }
+
+    ui32Sense = USBHMSC_SENSE_KEY(USBHMSCSenseGet(g_psMSCInstance));
+
+    printf("%s:%u: %s: %u failed, %u reads, %u writes, %llu blocks, "
+           "sense %u, %u bad bytes, %u blocks pending\n", g_pcScript,
+           (unsigned)g_ui32Line, pcCommand, (unsigned)ui32Failures,
+           (unsigned)g_sDrive.ui32Reads, (unsigned)g_sDrive.ui32Writes,
+           (unsigned long long)g_sDrive.ui64Blocks, (unsigned)ui32Sense,
+           (unsigned)ui32Bad, (unsigned)ui32Pending);
+
+    MetricSet("failures", ui32Failures);
+    MetricSet("reads", g_sDrive.ui32Reads);
+    MetricSet("writes", g_sDrive.ui32Writes);
+    MetricSet("blocks", (double)g_sDrive.ui64Blocks);
+    MetricSet("sense", ui32Sense);
+    MetricSet("bad", ui32Bad);
+    MetricSet("pending", ui32Pending);
+}
+
+//*****************************************************************************
+//
+// Reads runs of blocks through the mass storage class driver, and checks
+// them against what has been written to the drive.
+//
+//*****************************************************************************
+static bool
+CmdMSCRead(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32LBA, ui32Blocks, ui32Count, ui32Failures, ui32Bad;
+    uint32_t ui32Idx, ui32Offset;
+    uint8_t *pui8Data;
+
+    if(!MSCArgsParse(ppcArgs, ui32Args, &ui32LBA, &ui32Blocks, &ui32Count))
+    {
+        return(false);
+    }
+
+    pui8Data = (uint8_t *)g_pui32MSCBuffer;
+    ui32Failures = 0;
+    ui32Bad = 0;
+
+    for(; ui32Count; ui32Count--, ui32LBA += ui32Blocks)
+    {
+        memset(pui8Data, 0, ui32Blocks * SIM_MSC_BLOCK_SIZE);
+
+        if(USBHMSCBlockRead(g_psMSCInstance, ui32LBA, pui8Data,
+                            ui32Blocks) != 0)
+        {
+            ui32Failures++;
+            continue;
+        }
+
+        for(ui32Idx = 0; ui32Idx < (ui32Blocks * SIM_MSC_BLOCK_SIZE);
+            ui32Idx++)
+        {
+            ui32Offset = (ui32LBA * SIM_MSC_BLOCK_SIZE) + ui32Idx;
+
+            if((ui32Offset >= (g_sDrive.ui32Blocks * SIM_MSC_BLOCK_SIZE)) ||
+               (pui8Data[ui32Idx] != g_pui8DriveImage[ui32Offset]))
+            {
+                ui32Bad++;
+            }
+        }
+    }
+
+    MSCReport("msc-read", ui32Failures, ui32Bad);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Writes runs of blocks through the mass storage class driver.
+//
+//*****************************************************************************
+static bool
+CmdMSCWrite(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32LBA, ui32Blocks, ui32Count, ui32Failures;
+    uint32_t ui32Idx, ui32Offset;
+    uint8_t *pui8Data;
+
+    if(!MSCArgsParse(ppcArgs, ui32Args, &ui32LBA, &ui32Blocks, &ui32Count))
+    {
+        return(false);
+    }
+
+    pui8Data = (uint8_t *)g_pui32MSCBuffer;
+    ui32Failures = 0;
+
+    for(; ui32Count; ui32Count--, ui32LBA += ui32Blocks)
+    {
+        g_sDrive.ui32Generation++;
+
+        for(ui32Idx = 0; ui32Idx < (ui32Blocks * SIM_MSC_BLOCK_SIZE);
+            ui32Idx++)
+        {
+            pui8Data[ui32Idx] = PatternByte((ui32LBA * SIM_MSC_BLOCK_SIZE) +
+                                            ui32Idx) + g_sDrive.ui32Generation;
+        }
+
+        if(USBHMSCBlockWrite(g_psMSCInstance, ui32LBA, pui8Data,
+                             ui32Blocks) != 0)
+        {
+            ui32Failures++;
+            continue;
+        }
+
+        for(ui32Idx = 0; ui32Idx < (ui32Blocks * SIM_MSC_BLOCK_SIZE);
+            ui32Idx++)
+        {
+            ui32Offset = (ui32LBA * SIM_MSC_BLOCK_SIZE) + ui32Idx;
+
+            if(ui32Offset < (g_sDrive.ui32Blocks * SIM_MSC_BLOCK_SIZE))
+            {
+                g_pui8DriveImage[ui32Offset] = pui8Data[ui32Idx];
+            }
+        }
+    }
+
+    MSCReport("msc-write", ui32Failures, 0);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Writes the blocks held in the mass storage class driver's cache to the
+// drive.
+//
+//*****************************************************************************
+static bool
+CmdMSCFlush(char **ppcArgs, uint32_t ui32Args)
+{
+    if(!ScriptCheck(g_psMSCInstance != 0, "drive opened"))
+    {
+        return(false);
+    }
+
+    g_sDrive.ui32Reads = 0;
+    g_sDrive.ui32Writes = 0;
+    g_sDrive.ui64Blocks = 0;
+
+    MSCReport("msc-flush", (USBHMSCFlush(g_psMSCInstance) != 0) ? 1 : 0, 0);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Lets the bus run idle.
+//
+//*****************************************************************************
+static bool
+CmdWait(char **ppcArgs, uint32_t ui32Args)
+{
+    if(!ScriptCheck(ui32Args == 1, "wait ms"))
+    {
+        return(false);
+    }
+
+    USBModelWait((uint64_t)strtoul(ppcArgs[0], 0, 0) * 1000000);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Checks a metric of the last command.
+//
+//*****************************************************************************
+static bool
+CmdExpect(char **ppcArgs, uint32_t ui32Args)
+{
+    uint32_t ui32Idx;
+    double dValue, dLimit;
+    bool bPass;
+    char pcCheck[128];
+
+    if(!ScriptCheck(ui32Args == 3, "expect metric op value"))
+    {
+        return(false);
+    }
+
+    for(ui32Idx = 0; ui32Idx < g_ui32NumMetrics; ui32Idx++)
+    {
+        if(!strcmp(g_psMetrics[ui32Idx].pcName, ppcArgs[0]))
+        {
+            break;
+        }
+    }
+    if(!ScriptCheck(ui32Idx < g_ui32NumMetrics,
+                    "metric reported by the last command"))
+    {
+        return(false);
+    }
+
+    dValue = g_psMetrics[ui32Idx].dValue;
+    dLimit = strtod(ppcArgs[2], 0);
+
+    if(!strcmp(ppcArgs[1], "<"))
+    {
+        bPass = dValue < dLimit;
+    }
+    else if(!strcmp(ppcArgs[1], "<="))
+    {
+        bPass = dValue <= dLimit;
+    }
+    else if(!strcmp(ppcArgs[1], "=="))
+    {
+        bPass = dValue == dLimit;
+    }
+    else if(!strcmp(ppcArgs[1], ">="))
+    {
+        bPass = dValue >= dLimit;
+    }
+    else if(!strcmp(ppcArgs[1], ">"))
+    {
+        bPass = dValue > dLimit;
+    }
+    else
+    {
+        return(ScriptCheck(false, "comparison is one of < <= == >= >"));
+    }
+
+    snprintf(pcCheck, sizeof(pcCheck), "%s (%g) %s %s", ppcArgs[0], dValue,
+             ppcArgs[1], ppcArgs[2]);
+
+    return(ScriptCheck(bPass, pcCheck));
+}
+
+//*****************************************************************************
+//
+// The script commands.
+//
+//*****************************************************************************
+static const struct
+{
+    const char *pcName;
+    bool (*pfnCommand)(char **ppcArgs, uint32_t ui32Args);
+    bool bNeedsDevice;
+    bool bNeedsHost;
+    bool bKeepsMetrics;
+}
+g_psCommands[] =
+{
+    { "device", CmdDevice, false, false, false },
+    { "host", CmdHost, false, false, false },
+    { "reset", CmdReset, true, false, false },
+    { "cache", CmdCache, true, false, false },
+    { "enumerate", CmdEnumerate, true, false, false },
+    { "control", CmdControl, true, false, false },
+    { "bulk-out", CmdBulkOut, true, false, false },
+    { "bulk-in", CmdBulkIn, true, false, false },
+    { "ncm-out", CmdNCMOut, true, false, false },
+    { "ncm-in", CmdNCMIn, true, false, false },
+    { "audio-start", CmdAudioStart, true, false, false },
+    { "audio-ring", CmdAudioRing, true, false, false },
+    { "audio-out", CmdAudioOut, true, false, false },
+    { "mouse", CmdMouse, true, false, false },
+    { "request", CmdRequest, true, false, false },
+    { "composite", CmdComposite, true, false, false },
+    { "msc", CmdMSC, false, true, false },
+    { "msc-read", CmdMSCRead, false, true, false },
+    { "msc-write", CmdMSCWrite, false, true, false },
+    { "msc-flush", CmdMSCFlush, false, true, false },
+    { "periodic", CmdPeriodic, false, true, false },
+    { "schedule", CmdSchedule, false, true, false },
+    { "wait", CmdWait, true, false, true },
+    { "expect", CmdExpect, false, false, true }
+};
+
+#define NUM_COMMANDS            (sizeof(g_psCommands) /                       \
+                                 sizeof(g_psCommands[0]))
+
+//*****************************************************************************
+//
+// Runs a command from the script.
+//
+//*****************************************************************************
+static void
+ScriptCommand(char *pcLine)
+{
+    char *ppcArgs[8], *pcCommand;
+    uint32_t ui32Args, ui32Idx;
+    tUSBModelStats sStats;
+    uint32_t ui32Errors;
+
+    pcCommand = strtok(pcLine, " \t\r\n");
+    if(!pcCommand)
+    {
+        return;
+    }
+
+    for(ui32Args = 0; ui32Args < 8; ui32Args++)
+    {
+        ppcArgs[ui32Args] = strtok(0, " \t\r\n");
+        if(!ppcArgs[ui32Args])
+        {
+            break;
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < NUM_COMMANDS; ui32Idx++)
+    {
+        if(!strcmp(g_psCommands[ui32Idx].pcName, pcCommand))
+        {
+            break;
+        }
+    }
+    if(!ScriptCheck(ui32Idx < NUM_COMMANDS, "known command") ||
+       !ScriptCheck(g_bDevice || !g_psCommands[ui32Idx].bNeedsDevice,
+                    "device started") ||
+       !ScriptCheck(g_bHost || !g_psCommands[ui32Idx].bNeedsHost,
+                    "host started"))
+    {
+        return;
+    }
+
+    if(!g_psCommands[ui32Idx].bKeepsMetrics)
+    {
+        g_ui32NumMetrics = 0;
+    }
+
+    USBModelStatsGet(&sStats);
+    ui32Errors = sStats.ui32Errors;
+
+    g_psCommands[ui32Idx].pfnCommand(ppcArgs, ui32Args);
+
+    //
+    // Any error found by the model fails the command.
+    //
+    if(g_bDevice || g_bHost)
+    {
+        USBModelStatsGet(&sStats);
+        ScriptCheck(sStats.ui32Errors == ui32Errors,
+                    "no errors found by the model");
+    }
+}
+
+//*****************************************************************************
+//
+// Runs a traffic script.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    FILE *pFile;
+    char pcLine[256], *pcComment;
+
+    if(argc != 2)
+    {
+        printf("Usage: %s script\n", argv[0]);
+        return(2);
+    }
+
+    g_pcScript = argv[1];
+    pFile = fopen(g_pcScript, "r");
+    if(!pFile)
+    {
+        printf("%s: cannot open the script\n", g_pcScript);
+        return(2);
+    }
+
+    for(g_ui32Line = 1; fgets(pcLine, sizeof(pcLine), pFile); g_ui32Line++)
+    {
+        pcComment = strchr(pcLine, '#');
+        if(pcComment)
+        {
+            *pcComment = 0;
+        }
+
+        ScriptCommand(pcLine);
+    }
+
+    fclose(pFile);
+
+    return(TestResult(g_pcScript));
+}
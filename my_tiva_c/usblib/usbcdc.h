@@ -82,6 +82,8 @@ extern "C"
                                 0x06
 #define USB_CDC_SUBCLASS_ATM_MODEL                                            \
                                 0x07
+#define USB_CDC_SUBCLASS_NCM_MODEL                                            \
+                                0x0D
 
 //*****************************************************************************
 //
@@ -100,6 +102,8 @@ extern "C"
 //
 //*****************************************************************************
 #define USB_CDC_PROTOCOL_NONE   0x00
+#define USB_CDC_PROTOCOL_NCM_NTB                                              \
+                                0x01
 #define USB_CDC_PROTOCOL_I420   0x30
 #define USB_CDC_PROTOCOL_TRANSPARENT                                          \
                                 0x32
@@ -169,6 +173,7 @@ extern "C"
 #define USB_CDC_FD_SUBTYPE_ETHERNET                                           \
                                 0x0F
 #define USB_CDC_FD_SUBTYPE_ATM  0x10
+#define USB_CDC_FD_SUBTYPE_NCM  0x1A
 
 //*****************************************************************************
 //
@@ -336,6 +341,24 @@ extern "C"
 #define USB_CDC_ETHERNET_XMIT_TIMES_CRS_LOST                                  \
                                 0x00000010
 
+//*****************************************************************************
+//
+// USB_CDC_FD_SUBTYPE_NCM, NCM functional descriptor, bmNetworkCapabilities
+//
+//*****************************************************************************
+#define USB_CDC_NCM_SUPPORTS_PACKET_FILTER                                    \
+                                0x01
+#define USB_CDC_NCM_SUPPORTS_NET_ADDRESS                                      \
+                                0x02
+#define USB_CDC_NCM_SUPPORTS_ENCAPSULATED                                     \
+                                0x04
+#define USB_CDC_NCM_SUPPORTS_MAX_DATAGRAM                                     \
+                                0x08
+#define USB_CDC_NCM_SUPPORTS_CRC_MODE                                         \
+                                0x10
+#define USB_CDC_NCM_SUPPORTS_NTB_INPUT_SIZE_8                                 \
+                                0x20
+
 //*****************************************************************************
 //
 // USB_CDC_FD_SUBTYPE_ATM, ATM Networking functional descriptor,
@@ -425,6 +448,24 @@ extern "C"
                                 0x52
 #define USB_CDC_GET_ATM_VC_STATISTICS                                         \
                                 0x53
+#define USB_CDC_GET_NTB_PARAMETERS                                            \
+                                0x80
+#define USB_CDC_GET_NET_ADDRESS                                               \
+                                0x81
+#define USB_CDC_SET_NET_ADDRESS                                               \
+                                0x82
+#define USB_CDC_GET_NTB_FORMAT  0x83
+#define USB_CDC_SET_NTB_FORMAT  0x84
+#define USB_CDC_GET_NTB_INPUT_SIZE                                            \
+                                0x85
+#define USB_CDC_SET_NTB_INPUT_SIZE                                            \
+                                0x86
+#define USB_CDC_GET_MAX_DATAGRAM_SIZE                                         \
+                                0x87
+#define USB_CDC_SET_MAX_DATAGRAM_SIZE                                         \
+                                0x88
+#define USB_CDC_GET_CRC_MODE    0x89
+#define USB_CDC_SET_CRC_MODE    0x8A
 
 //*****************************************************************************
 //
@@ -455,6 +496,11 @@ extern "C"
                                 4
 #define USB_CDC_SIZE_LINE_PARMS                                               \
                                 10
+#define USB_CDC_SIZE_NTB_PARAMETERS                                           \
+                                28
+#define USB_CDC_SIZE_NTB_INPUT_SIZE                                           \
+                                4
+#define USB_CDC_SIZE_NTB_FORMAT 2
 
 //*****************************************************************************
 //
@@ -869,6 +915,22 @@ extern "C"
         }                                                                     \
         while(0)
 
+//*****************************************************************************
+//
+// NCM Transfer Block (NTB) definitions.  Only the 16-bit NTB format is
+// described here.
+//
+//*****************************************************************************
+#define USB_CDC_NCM_NTB16_FORMAT                                              \
+                                0x0001
+#define USB_CDC_NCM_NTH16_SIGNATURE                                           \
+                                0x484D434E
+#define USB_CDC_NCM_NDP16_SIGNATURE                                           \
+                                0x304D434E
+#define USB_CDC_NCM_NTH16_SIZE  12
+#define USB_CDC_NCM_NDP16_SIZE(ui32Datagrams)                                 \
+                                (8 + (((ui32Datagrams) + 1) * 4))
+
 //*****************************************************************************
 //
 // Packed structure definitions for request/response data blocks
@@ -919,6 +981,62 @@ typedef struct
 }
 PACKED tLineCoding;
 
+//*****************************************************************************
+//
+//! USB_CDC_GET_NTB_PARAMETERS request-specific data.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The size of this structure, USB_CDC_SIZE_NTB_PARAMETERS.
+    //
+    uint16_t ui16Length;
+
+    //
+    //! The NTB formats supported.  USB_CDC_NCM_NTB16_FORMAT must be set.
+    //
+    uint16_t ui16NTBFormats;
+
+    //
+    //! The largest IN NTB that the device can send.
+    //
+    uint32_t ui32NTBInMaxSize;
+
+    //
+    //! The divisor, remainder and alignment applied to the position of each
+    //! datagram and NDP in IN NTBs.
+    //
+    uint16_t ui16NDPInDivisor;
+    uint16_t ui16NDPInRemainder;
+    uint16_t ui16NDPInAlignment;
+
+    //
+    //! Reserved, must be zero.
+    //
+    uint16_t ui16Reserved;
+
+    //
+    //! The largest OUT NTB that the device can receive.
+    //
+    uint32_t ui32NTBOutMaxSize;
+
+    //
+    //! The divisor, remainder and alignment the host should apply to the
+    //! position of each datagram and NDP in OUT NTBs.
+    //
+    uint16_t ui16NDPOutDivisor;
+    uint16_t ui16NDPOutRemainder;
+    uint16_t ui16NDPOutAlignment;
+
+    //
+    //! The largest number of datagrams the device can accept in one OUT NTB,
+    //! or zero if there is no limit.
+    //
+    uint16_t ui16NTBOutMaxDatagrams;
+}
+PACKED tNCMNTBParameters;
+
 //*****************************************************************************
 //
 // Return to default packing when using the IAR Embedded Workbench compiler.
@@ -1290,6 +1290,41 @@ static void
 iDMAUSBArbSizeSet(tUSBDMAInstance *psUSBDMAInst, uint32_t ui32Channel,
                   uint32_t ui32ArbSize)
 {
+    uint32_t ui32Value;
+
+    ASSERT(ui32Channel <= USB_MAX_DMA_CHANNELS_0);
+
+    //
+    // The integrated DMA controller always moves 32-bit words so the
+    // arbitration size maps on to the longest AHB burst that it allows.
+    // Longer bursts keep the bus busy for less time per packet, which
+    // matters at high speed where each bulk packet is 512 bytes.
+    //
+    if(ui32ArbSize >= 16)
+    {
+        ui32Value = USB_DMA_CFG_BURST_16;
+    }
+    else if(ui32ArbSize >= 8)
+    {
+        ui32Value = USB_DMA_CFG_BURST_8;
+    }
+    else if(ui32ArbSize >= 4)
+    {
+        ui32Value = USB_DMA_CFG_BURST_4;
+    }
+    else
+    {
+        ui32Value = USB_DMA_CFG_BURST_NONE;
+    }
+
+    //
+    // Keep the rest of the channel configuration and or in the burst mode.
+    // USB_DMA_CFG_BURST_16 has both burst mode bits set so also serves as
+    // the mask.  The new value is written to the controller on the next
+    // transfer.
+    //
+    psUSBDMAInst->pui32Config[ui32Channel - 1] &= ~USB_DMA_CFG_BURST_16;
+    psUSBDMAInst->pui32Config[ui32Channel - 1] |= ui32Value;
 }
 
 //*****************************************************************************
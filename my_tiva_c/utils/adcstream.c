@@ -0,0 +1,451 @@
+//*****************************************************************************
+//
+// adcstream.c - Continuous ADC streaming using ping-pong uDMA transfers.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_adc.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "driverlib/adc.h"
+#include "driverlib/debug.h"
+#include "driverlib/timer.h"
+#include "driverlib/udma.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "utils/adcstream.h"
+
+//*****************************************************************************
+//
+//! \addtogroup adcstream_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The spacing between the registers of consecutive sample sequencers.
+//
+//*****************************************************************************
+#define ADC_SEQ_STEP            (ADC_O_SSFIFO1 - ADC_O_SSFIFO0)
+
+//*****************************************************************************
+//
+// Programs one of the two control structures of a stream to fill a block.
+//
+//*****************************************************************************
+static void
+ADCStreamBlockSet(tADCStream *psStream, uint32_t ui32Block)
+{
+    MAP_uDMAChannelTransferSet(psStream->ui32DMAChannel |
+                               (ui32Block ? UDMA_ALT_SELECT :
+                                            UDMA_PRI_SELECT),
+                               UDMA_MODE_PINGPONG,
+                               (void *)(psStream->ui32ADCBase + ADC_O_SSFIFO0 +
+                                        (psStream->ui32SequenceNum *
+                                         ADC_SEQ_STEP)),
+                               psStream->pui16Buffer +
+                               (ui32Block * psStream->ui32BlockSize),
+                               psStream->ui32BlockSize);
+}
+
+//*****************************************************************************
+//
+//! Initializes a continuous ADC stream.
+//!
+//! \param psStream is a pointer to the stream state.
+//! \param ui32ADCBase is the base address of the ADC module.
+//! \param ui32SequenceNum is the sample sequencer to use.
+//! \param ui32Priority is the priority of the sample sequencer relative to
+//! the other sequencers of the ADC module, as passed to
+//! ADCSequenceConfigure(); 0 is the highest priority.  Each sequencer that
+//! the application uses must be given a different priority.
+//! \param ui32DMAMapping is the uDMA channel mapping for the sample
+//! sequencer, as passed to uDMAChannelAssign(); for example
+//! \b UDMA_CH14_ADC0_0.
+//! \param ui32StepsPerTrigger is the number of steps that the application
+//! has configured in the sample sequencer; it must be 1, 2, 4 or 8.
+//! \param pui16Buffer is a pointer to a buffer of 2 * \e ui32BlockSize
+//! samples that is filled alternately, one block at a time.
+//! \param ui32BlockSize is the number of samples in each block.  It must be a
+//! multiple of \e ui32StepsPerTrigger and no larger than
+//! \b ADC_STREAM_MAX_BLOCK.
+//! \param pfnCallback is the function called when a block is ready.
+//! \param pvCBData is the data pointer passed to \e pfnCallback.
+//!
+//! This function prepares a sample sequencer to stream samples to memory
+//! without processor intervention.  Each trigger from a timer converts the
+//! steps of the sequence and the uDMA controller moves the results from the
+//! sequencer FIFO to the current block using one burst.  When a block is full
+//! the uDMA controller switches to the other block and the ADC interrupt
+//! handler passes the full block to \e pfnCallback, so there is one interrupt
+//! per block rather than one per sequence.
+//!
+//! The application must enable the ADC, uDMA and timer peripherals, set up
+//! the uDMA control table, configure the steps of the sample sequencer with
+//! ADCSequenceStepConfigure() (setting \b ADC_CTL_IE and \b ADC_CTL_END on the
+//! last step), and call ADCStreamIntHandler() from the interrupt handler of
+//! the sample sequencer.  The sequencer is set to be triggered by a timer;
+//! ADCStreamTimerConfigure() sets up a timer to provide the trigger.  Several
+//! streams, for example one on each ADC module, may share the same timer.
+//!
+//! \return Returns \b true if the stream was initialized or \b false if the
+//! parameters are not valid.
+//
+//*****************************************************************************
+bool
+ADCStreamInit(tADCStream *psStream, uint32_t ui32ADCBase,
+              uint32_t ui32SequenceNum, uint32_t ui32Priority,
+              uint32_t ui32DMAMapping, uint32_t ui32StepsPerTrigger,
+              uint16_t *pui16Buffer, uint32_t ui32BlockSize,
+              tADCStreamCallback pfnCallback, void *pvCBData)
+{
+    uint32_t ui32Arb;
+
+    ASSERT(psStream);
+    ASSERT((ui32ADCBase == ADC0_BASE) || (ui32ADCBase == ADC1_BASE));
+    ASSERT(ui32SequenceNum < 4);
+    ASSERT(ui32Priority < 4);
+    ASSERT(pui16Buffer);
+    ASSERT(pfnCallback);
+
+    //
+    // The steps of each trigger are moved with one uDMA burst, so the burst
+    // size must match the number of steps.
+    //
+    switch(ui32StepsPerTrigger)
+    {
+        case 1:
+            ui32Arb = UDMA_ARB_1;
+            break;
+        case 2:
+            ui32Arb = UDMA_ARB_2;
+            break;
+        case 4:
+            ui32Arb = UDMA_ARB_4;
+            break;
+        case 8:
+            ui32Arb = UDMA_ARB_8;
+            break;
+        default:
+            return(false);
+    }
+
+    //
+    // Sequencer 0 holds 8 steps, sequencers 1 and 2 hold 4 and sequencer 3
+    // holds 1.
+    //
+    if((ui32StepsPerTrigger > ((ui32SequenceNum == 0) ? 8 :
+                               (ui32SequenceNum == 3) ? 1 : 4)) ||
+       (ui32BlockSize == 0) || (ui32BlockSize > ADC_STREAM_MAX_BLOCK) ||
+       (ui32BlockSize % ui32StepsPerTrigger))
+    {
+        return(false);
+    }
+
+    psStream->ui32ADCBase = ui32ADCBase;
+    psStream->ui32SequenceNum = ui32SequenceNum;
+    psStream->ui32DMAChannel = ui32DMAMapping & 0xff;
+    psStream->pui16Buffer = pui16Buffer;
+    psStream->ui32BlockSize = ui32BlockSize;
+    psStream->pfnCallback = pfnCallback;
+    psStream->pvCBData = pvCBData;
+    psStream->ui8NextBlock = 0;
+    psStream->ui32Blocks = 0;
+    psStream->ui32Overflows = 0;
+    psStream->ui32LateBlocks = 0;
+
+    //
+    // Trigger the sequencer from a timer.
+    //
+    MAP_ADCSequenceDisable(ui32ADCBase, ui32SequenceNum);
+    MAP_ADCSequenceConfigure(ui32ADCBase, ui32SequenceNum, ADC_TRIGGER_TIMER,
+                             ui32Priority);
+
+    //
+    // Route the sequencer to its uDMA channel.  The ADC only makes burst
+    // requests.
+    //
+    MAP_uDMAChannelAssign(ui32DMAMapping);
+    MAP_uDMAChannelAttributeDisable(psStream->ui32DMAChannel,
+                                    UDMA_ATTR_ALTSELECT |
+                                    UDMA_ATTR_HIGH_PRIORITY |
+                                    UDMA_ATTR_REQMASK);
+    MAP_uDMAChannelAttributeEnable(psStream->ui32DMAChannel,
+                                   UDMA_ATTR_USEBURST);
+
+    //
+    // Both control structures move 16-bit samples from the FIFO into
+    // consecutive locations of their block.
+    //
+    MAP_uDMAChannelControlSet(psStream->ui32DMAChannel | UDMA_PRI_SELECT,
+                              UDMA_SIZE_16 | UDMA_SRC_INC_NONE |
+                              UDMA_DST_INC_16 | ui32Arb);
+    MAP_uDMAChannelControlSet(psStream->ui32DMAChannel | UDMA_ALT_SELECT,
+                              UDMA_SIZE_16 | UDMA_SRC_INC_NONE |
+                              UDMA_DST_INC_16 | ui32Arb);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Starts a continuous ADC stream.
+//!
+//! \param psStream is a pointer to the stream state.
+//!
+//! This function arms both blocks of the stream and enables the sample
+//! sequencer.  Sampling begins with the next timer trigger.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ADCStreamStart(tADCStream *psStream)
+{
+    ASSERT(psStream);
+
+    psStream->ui8NextBlock = 0;
+
+    //
+    // Arm both blocks so that the uDMA controller can switch to the second
+    // while the first is processed.
+    //
+    ADCStreamBlockSet(psStream, 0);
+    ADCStreamBlockSet(psStream, 1);
+    MAP_uDMAChannelEnable(psStream->ui32DMAChannel);
+
+    //
+    // Discard any stale overflow and enable the interrupt that signals the
+    // end of a block.  On TM4C129 devices the uDMA completion has its own
+    // interrupt flag.
+    //
+    MAP_ADCSequenceOverflowClear(psStream->ui32ADCBase,
+                                 psStream->ui32SequenceNum);
+    MAP_ADCSequenceDMAEnable(psStream->ui32ADCBase, psStream->ui32SequenceNum);
+
+    if(CLASS_IS_TM4C129)
+    {
+        MAP_ADCIntClearEx(psStream->ui32ADCBase,
+                          ADC_INT_DMA_SS0 << psStream->ui32SequenceNum);
+        MAP_ADCIntEnableEx(psStream->ui32ADCBase,
+                           ADC_INT_DMA_SS0 << psStream->ui32SequenceNum);
+    }
+    else
+    {
+        MAP_ADCIntClear(psStream->ui32ADCBase, psStream->ui32SequenceNum);
+        MAP_ADCIntEnable(psStream->ui32ADCBase, psStream->ui32SequenceNum);
+    }
+
+    MAP_ADCSequenceEnable(psStream->ui32ADCBase, psStream->ui32SequenceNum);
+}
+
+//*****************************************************************************
+//
+//! Stops a continuous ADC stream.
+//!
+//! \param psStream is a pointer to the stream state.
+//!
+//! This function disables the sample sequencer and its uDMA channel.  Any
+//! partially filled block is discarded.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ADCStreamStop(tADCStream *psStream)
+{
+    ASSERT(psStream);
+
+    MAP_ADCSequenceDisable(psStream->ui32ADCBase, psStream->ui32SequenceNum);
+
+    if(CLASS_IS_TM4C129)
+    {
+        MAP_ADCIntDisableEx(psStream->ui32ADCBase,
+                            ADC_INT_DMA_SS0 << psStream->ui32SequenceNum);
+    }
+    else
+    {
+        MAP_ADCIntDisable(psStream->ui32ADCBase, psStream->ui32SequenceNum);
+    }
+
+    MAP_ADCSequenceDMADisable(psStream->ui32ADCBase,
+                              psStream->ui32SequenceNum);
+    MAP_uDMAChannelDisable(psStream->ui32DMAChannel);
+}
+
+//*****************************************************************************
+//
+//! Configures a timer to trigger ADC streams.
+//!
+//! \param ui32TimerBase is the base address of the timer module.
+//! \param ui32TimerClock is the clock rate of the timer, in Hz.
+//! \param ui32TriggerRate is the number of sequence triggers per second.
+//!
+//! This function configures timer A of the given module as a periodic timer
+//! that triggers the ADC each time it times out, and then starts it.  Each
+//! trigger converts all of the steps of every sample sequencer that is set to
+//! be triggered by a timer, so the sample rate of a stream is
+//! \e ui32TriggerRate multiplied by the number of steps in its sequence.  The
+//! timer should be configured after ADCStreamStart() has been called for all
+//! of the streams that it triggers so that they start on the same trigger.
+//!
+//! If the clock supplied to the timer changes, for example from a callback
+//! registered with ClockTreeRegister(), this function should be called again
+//! with the new clock rate to keep the trigger rate.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ADCStreamTimerConfigure(uint32_t ui32TimerBase, uint32_t ui32TimerClock,
+                        uint32_t ui32TriggerRate)
+{
+    ASSERT(ui32TriggerRate);
+    ASSERT(ui32TriggerRate <= ui32TimerClock);
+
+    MAP_TimerDisable(ui32TimerBase, TIMER_A);
+    MAP_TimerConfigure(ui32TimerBase, TIMER_CFG_PERIODIC);
+    MAP_TimerLoadSet(ui32TimerBase, TIMER_A,
+                     (ui32TimerClock / ui32TriggerRate) - 1);
+
+    //
+    // TM4C129 devices select which timer event triggers the ADC.
+    //
+    if(CLASS_IS_TM4C129)
+    {
+        MAP_TimerADCEventSet(ui32TimerBase, TIMER_ADC_TIMEOUT_A);
+    }
+    MAP_TimerControlTrigger(ui32TimerBase, TIMER_A, true);
+
+    MAP_TimerEnable(ui32TimerBase, TIMER_A);
+}
+
+//*****************************************************************************
+//
+//! Handles the ADC interrupt for a continuous ADC stream.
+//!
+//! \param psStream is a pointer to the stream state.
+//!
+//! This function must be called from the interrupt handler of the sample
+//! sequencer used by the stream.  It re-arms each block that the uDMA
+//! controller has finished filling and passes it to the block-ready callback,
+//! in the order in which the blocks were filled.  It also counts sequencer
+//! FIFO overflows, which indicate that samples were lost.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ADCStreamIntHandler(tADCStream *psStream)
+{
+    uint32_t ui32Block, ui32Done;
+
+    ASSERT(psStream);
+
+    //
+    // Clear the interrupt.
+    //
+    if(CLASS_IS_TM4C129)
+    {
+        MAP_ADCIntClearEx(psStream->ui32ADCBase,
+                          ADC_INT_DMA_SS0 << psStream->ui32SequenceNum);
+    }
+    else
+    {
+        MAP_ADCIntClear(psStream->ui32ADCBase, psStream->ui32SequenceNum);
+    }
+
+    //
+    // Count and clear any overflow of the sequencer FIFO.
+    //
+    if(MAP_ADCSequenceOverflow(psStream->ui32ADCBase,
+                               psStream->ui32SequenceNum))
+    {
+        psStream->ui32Overflows++;
+        MAP_ADCSequenceOverflowClear(psStream->ui32ADCBase,
+                                     psStream->ui32SequenceNum);
+    }
+
+    //
+    // Find the blocks that have been filled.  A control structure returns to
+    // the stopped mode when its transfer completes.
+    //
+    ui32Done = 0;
+    for(ui32Block = 0; ui32Block < 2; ui32Block++)
+    {
+        if(MAP_uDMAChannelModeGet(psStream->ui32DMAChannel |
+                                  (ui32Block ? UDMA_ALT_SELECT :
+                                               UDMA_PRI_SELECT)) ==
+           UDMA_MODE_STOP)
+        {
+            ui32Done |= 1 << ui32Block;
+        }
+    }
+
+    //
+    // If both blocks are full then the interrupt was handled too late for
+    // the uDMA controller to continue without a gap.
+    //
+    if(ui32Done == 3)
+    {
+        psStream->ui32LateBlocks++;
+    }
+
+    //
+    // Pass the full blocks to the application in the order that they were
+    // filled, re-arming each one first so the uDMA controller can switch back
+    // to it.
+    //
+    while(ui32Done & (1 << psStream->ui8NextBlock))
+    {
+        ui32Block = psStream->ui8NextBlock;
+        ui32Done &= ~(1 << ui32Block);
+        psStream->ui8NextBlock = ui32Block ^ 1;
+
+        ADCStreamBlockSet(psStream, ui32Block);
+        psStream->ui32Blocks++;
+
+        psStream->pfnCallback(psStream->pvCBData,
+                              psStream->pui16Buffer +
+                              (ui32Block * psStream->ui32BlockSize),
+                              psStream->ui32BlockSize);
+    }
+
+    //
+    // If the uDMA controller stopped because both blocks were full, restart
+    // the channel.
+    //
+    if(!MAP_uDMAChannelIsEnabled(psStream->ui32DMAChannel))
+    {
+        MAP_uDMAChannelEnable(psStream->ui32DMAChannel);
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,166 @@
+//*****************************************************************************
+//
+// adcstream.h - Prototypes for the continuous ADC streaming engine.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __ADCSTREAM_H__
+#define __ADCSTREAM_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup adcstream_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The largest block, in samples, that can be transferred by one uDMA control
+//! structure.
+//
+//*****************************************************************************
+#define ADC_STREAM_MAX_BLOCK    1024
+
+//*****************************************************************************
+//
+//! The prototype for the function that is called when a block of samples is
+//! ready.  The function is called from the ADC interrupt handler with a
+//! pointer to the block and the number of samples in it.  The uDMA controller
+//! is filling the other block while this one is processed, so the block must
+//! be consumed before the next block is ready.
+//
+//*****************************************************************************
+typedef void (*tADCStreamCallback)(void *pvCBData, uint16_t *pui16Block,
+                                   uint32_t ui32Count);
+
+//*****************************************************************************
+//
+//! This structure contains the state of a single ADC stream.  The members
+//! are set by ADCStreamInit() and should not be accessed or modified by the
+//! application.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The base address of the ADC module.
+    //
+    uint32_t ui32ADCBase;
+
+    //
+    //! The sample sequencer used by the stream.
+    //
+    uint32_t ui32SequenceNum;
+
+    //
+    //! The uDMA channel number used by the sample sequencer.
+    //
+    uint32_t ui32DMAChannel;
+
+    //
+    //! The buffer that holds the two blocks of samples.
+    //
+    uint16_t *pui16Buffer;
+
+    //
+    //! The number of samples in each block.
+    //
+    uint32_t ui32BlockSize;
+
+    //
+    //! The function called when a block of samples is ready, and the data
+    //! pointer passed to it.
+    //
+    tADCStreamCallback pfnCallback;
+    void *pvCBData;
+
+    //
+    //! The block that will be completed next; 0 for the block filled using
+    //! the primary control structure and 1 for the alternate.
+    //
+    uint8_t ui8NextBlock;
+
+    //
+    //! The number of blocks that have been passed to the callback.
+    //
+    volatile uint32_t ui32Blocks;
+
+    //
+    //! The number of times that the sample sequencer FIFO overflowed, which
+    //! means that samples were lost.
+    //
+    volatile uint32_t ui32Overflows;
+
+    //
+    //! The number of times that both blocks were complete when the interrupt
+    //! was handled, which means that the uDMA controller may have stalled.
+    //
+    volatile uint32_t ui32LateBlocks;
+}
+tADCStream;
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern bool ADCStreamInit(tADCStream *psStream, uint32_t ui32ADCBase,
+                          uint32_t ui32SequenceNum, uint32_t ui32Priority,
+                          uint32_t ui32DMAMapping,
+                          uint32_t ui32StepsPerTrigger, uint16_t *pui16Buffer,
+                          uint32_t ui32BlockSize,
+                          tADCStreamCallback pfnCallback, void *pvCBData);
+extern void ADCStreamStart(tADCStream *psStream);
+extern void ADCStreamStop(tADCStream *psStream);
+extern void ADCStreamTimerConfigure(uint32_t ui32TimerBase,
+                                    uint32_t ui32TimerClock,
+                                    uint32_t ui32TriggerRate);
+extern void ADCStreamIntHandler(tADCStream *psStream);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ADCSTREAM_H__
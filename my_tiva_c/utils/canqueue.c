@@ -0,0 +1,775 @@
+//*****************************************************************************
+//
+// canqueue.c - Queued, interrupt-driven CAN message object engine.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_can.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/can.h"
+#include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "utils/canqueue.h"
+
+//*****************************************************************************
+//
+//! \addtogroup canqueue_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The number of message objects in the CAN controller.
+//
+//*****************************************************************************
+#define NUM_MSG_OBJS            32
+
+//*****************************************************************************
+//
+// The interface register command used to read a received message.  It reads
+// the arbitration, control and data fields and clears the new data and
+// interrupt pending bits of the message object in the same transfer.
+//
+//*****************************************************************************
+#define RX_READ_CMD             (CAN_IF2CMSK_ARB | CAN_IF2CMSK_CONTROL |      \
+                                 CAN_IF2CMSK_CLRINTPND | CAN_IF2CMSK_NEWDAT | \
+                                 CAN_IF2CMSK_DATAA | CAN_IF2CMSK_DATAB)
+
+//*****************************************************************************
+//
+// The interface register command used to load a message for transmission.
+// The mask fields of the transmit message objects are never used, so they
+// are not transferred.
+//
+//*****************************************************************************
+#define TX_LOAD_CMD             (CAN_IF1CMSK_WRNRD | CAN_IF1CMSK_ARB |        \
+                                 CAN_IF1CMSK_CONTROL | CAN_IF1CMSK_DATAA |    \
+                                 CAN_IF1CMSK_DATAB)
+
+//*****************************************************************************
+//
+// Finds the statistics entry for a message identifier, or returns NULL if the
+// identifier is not in the statistics table.
+//
+//*****************************************************************************
+static tCANQueueIDStats *
+CANQueueStatsFind(tCANQueue *psQueue, uint32_t ui32ID)
+{
+    uint32_t ui32Low, ui32High, ui32Mid;
+
+    //
+    // Binary search the table, which is sorted by identifier.
+    //
+    ui32Low = 0;
+    ui32High = psQueue->ui32NumStats;
+    while(ui32Low < ui32High)
+    {
+        ui32Mid = (ui32Low + ui32High) / 2;
+        if(psQueue->psStats[ui32Mid].ui32ID == ui32ID)
+        {
+            return(&psQueue->psStats[ui32Mid]);
+        }
+        if(psQueue->psStats[ui32Mid].ui32ID < ui32ID)
+        {
+            ui32Low = ui32Mid + 1;
+        }
+        else
+        {
+            ui32High = ui32Mid;
+        }
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Waits for an interface register set to finish its transfer.  The transfer
+// between the interface registers and the message RAM takes a few CAN module
+// clocks, so this is only ever a short wait.
+//
+//*****************************************************************************
+static void
+CANQueueIFWait(uint32_t ui32CRQ)
+{
+    while(HWREG(ui32CRQ) & CAN_IF1CRQ_BUSY)
+    {
+    }
+}
+
+//*****************************************************************************
+//
+// Loads queued messages into the transmit message objects.  This must be
+// called from the interrupt handler or with interrupts disabled.
+//
+//*****************************************************************************
+static void
+CANQueueTxFill(tCANQueue *psQueue)
+{
+    uint32_t ui32Base, ui32Obj, ui32ArbReg0, ui32ArbReg1;
+    tCANQueueMsg *psMsg;
+
+    ui32Base = psQueue->ui32Base;
+
+    //
+    // The controller transmits the pending message object with the lowest
+    // number first.  Messages are only loaded once all of the transmit
+    // message objects are idle, and are loaded in increasing object order,
+    // so that they are transmitted in the order that they were queued.
+    //
+    if(psQueue->ui32TxBusy != 0)
+    {
+        return;
+    }
+
+    for(ui32Obj = 0; (ui32Obj < psQueue->ui32TxObjs) &&
+                     (psQueue->ui32TxRead != psQueue->ui32TxWrite); ui32Obj++)
+    {
+        psMsg = &psQueue->psTxQueue[psQueue->ui32TxRead];
+
+        if(psMsg->ui8Flags & CAN_QUEUE_EXTENDED)
+        {
+            ui32ArbReg0 = psMsg->ui32ID & CAN_IF1ARB1_ID_M;
+            ui32ArbReg1 = (((psMsg->ui32ID >> 16) & CAN_IF1ARB2_ID_M) |
+                           CAN_IF1ARB2_XTD);
+        }
+        else
+        {
+            ui32ArbReg0 = 0;
+            ui32ArbReg1 = (psMsg->ui32ID << 2) & CAN_IF1ARB2_ID_M;
+        }
+
+        //
+        // Wait for the previous transfer to finish, then write the message
+        // into the interface registers.  Writing the control field with
+        // the interrupt pending bit clear also acknowledges the previous
+        // transmit interrupt of the message object.
+        //
+        CANQueueIFWait(ui32Base + CAN_O_IF1CRQ);
+        HWREG(ui32Base + CAN_O_IF1CMSK) = TX_LOAD_CMD;
+        HWREG(ui32Base + CAN_O_IF1ARB1) = ui32ArbReg0;
+        HWREG(ui32Base + CAN_O_IF1ARB2) = (ui32ArbReg1 | CAN_IF1ARB2_MSGVAL |
+                                           CAN_IF1ARB2_DIR);
+        HWREG(ui32Base + CAN_O_IF1MCTL) = (CAN_IF1MCTL_TXIE |
+                                           CAN_IF1MCTL_TXRQST |
+                                           CAN_IF1MCTL_EOB |
+                                           (psMsg->ui8Len &
+                                            CAN_IF1MCTL_DLC_M));
+        HWREG(ui32Base + CAN_O_IF1DA1) = (psMsg->pui8Data[0] |
+                                          (psMsg->pui8Data[1] << 8));
+        HWREG(ui32Base + CAN_O_IF1DA2) = (psMsg->pui8Data[2] |
+                                          (psMsg->pui8Data[3] << 8));
+        HWREG(ui32Base + CAN_O_IF1DB1) = (psMsg->pui8Data[4] |
+                                          (psMsg->pui8Data[5] << 8));
+        HWREG(ui32Base + CAN_O_IF1DB2) = (psMsg->pui8Data[6] |
+                                          (psMsg->pui8Data[7] << 8));
+        HWREG(ui32Base + CAN_O_IF1CRQ) = psQueue->ui32TxFirst + ui32Obj;
+
+        //
+        // Remember whose statistics to update when the message is sent.
+        //
+        psQueue->ppsTxStats[ui32Obj] = CANQueueStatsFind(psQueue,
+                                                         psMsg->ui32ID);
+        psQueue->ui32TxBusy |= 1 << ui32Obj;
+
+        psQueue->ui32TxRead = ((psQueue->ui32TxRead + 1) %
+                               psQueue->ui32TxSize);
+    }
+}
+
+//*****************************************************************************
+//
+// Handles the transmit message objects that have finished sending, given as
+// a bit mask with bit 0 for the first transmit message object.
+//
+//*****************************************************************************
+static void
+CANQueueTxDone(tCANQueue *psQueue, uint32_t ui32Done)
+{
+    uint32_t ui32Base, ui32Obj, ui32Loaded;
+
+    ui32Base = psQueue->ui32Base;
+
+    //
+    // Count the messages that were sent.
+    //
+    for(ui32Obj = 0; ui32Obj < psQueue->ui32TxObjs; ui32Obj++)
+    {
+        if((ui32Done & (1 << ui32Obj)) && psQueue->ppsTxStats[ui32Obj])
+        {
+            psQueue->ppsTxStats[ui32Obj]->ui32TxFrames++;
+        }
+    }
+    psQueue->ui32TxBusy &= ~ui32Done;
+
+    //
+    // Load the next batch of messages.  Loading a message object also clears
+    // its interrupt, so only the objects that were not reloaded need to have
+    // their interrupt cleared separately.
+    //
+    CANQueueTxFill(psQueue);
+    ui32Loaded = psQueue->ui32TxBusy;
+
+    for(ui32Obj = 0; ui32Obj < psQueue->ui32TxObjs; ui32Obj++)
+    {
+        if((ui32Done & ~ui32Loaded) & (1 << ui32Obj))
+        {
+            CANQueueIFWait(ui32Base + CAN_O_IF1CRQ);
+            HWREG(ui32Base + CAN_O_IF1CMSK) = CAN_IF1CMSK_CLRINTPND;
+            HWREG(ui32Base + CAN_O_IF1CRQ) = psQueue->ui32TxFirst + ui32Obj;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Reads a received message from a message object into the receive queue.
+// The read command must already be in the IF2 command mask register.
+//
+//*****************************************************************************
+static void
+CANQueueRxObject(tCANQueue *psQueue, uint32_t ui32Obj)
+{
+    uint32_t ui32Base, ui32ArbReg0, ui32ArbReg1, ui32MsgCtrl, ui32Next;
+    uint32_t ui32Data;
+    tCANQueueIDStats *psStats;
+    tCANQueueMsg *psMsg;
+
+    ui32Base = psQueue->ui32Base;
+
+    //
+    // Transfer the message object into the IF2 registers.
+    //
+    HWREG(ui32Base + CAN_O_IF2CRQ) = ui32Obj;
+    CANQueueIFWait(ui32Base + CAN_O_IF2CRQ);
+
+    ui32MsgCtrl = HWREG(ui32Base + CAN_O_IF2MCTL);
+    if((ui32MsgCtrl & CAN_IF2MCTL_NEWDAT) == 0)
+    {
+        return;
+    }
+    ui32ArbReg0 = HWREG(ui32Base + CAN_O_IF2ARB1);
+    ui32ArbReg1 = HWREG(ui32Base + CAN_O_IF2ARB2);
+
+    //
+    // Find the statistics entry for the message and the next free entry in
+    // the receive queue.
+    //
+    ui32Next = (psQueue->ui32RxWrite + 1) % psQueue->ui32RxSize;
+    psMsg = &psQueue->psRxQueue[psQueue->ui32RxWrite];
+
+    if(ui32ArbReg1 & CAN_IF2ARB2_XTD)
+    {
+        psMsg->ui32ID = ((ui32ArbReg1 & CAN_IF2ARB2_ID_M) << 16) | ui32ArbReg0;
+        psMsg->ui8Flags = CAN_QUEUE_EXTENDED;
+    }
+    else
+    {
+        psMsg->ui32ID = (ui32ArbReg1 & CAN_IF2ARB2_ID_M) >> 2;
+        psMsg->ui8Flags = 0;
+    }
+    psStats = CANQueueStatsFind(psQueue, psMsg->ui32ID);
+
+    //
+    // If an earlier message was overwritten in the message object, clear the
+    // message lost bit and restore the read command.
+    //
+    if(ui32MsgCtrl & CAN_IF2MCTL_MSGLST)
+    {
+        psMsg->ui8Flags |= CAN_QUEUE_DATA_LOST;
+        psQueue->ui32RxLost++;
+        if(psStats)
+        {
+            psStats->ui32Lost++;
+        }
+
+        HWREG(ui32Base + CAN_O_IF2CMSK) = (CAN_IF2CMSK_WRNRD |
+                                           CAN_IF2CMSK_CONTROL);
+        HWREG(ui32Base + CAN_O_IF2MCTL) = (ui32MsgCtrl &
+                                           ~(CAN_IF2MCTL_NEWDAT |
+                                             CAN_IF2MCTL_MSGLST |
+                                             CAN_IF2MCTL_INTPND));
+        HWREG(ui32Base + CAN_O_IF2CRQ) = ui32Obj;
+        CANQueueIFWait(ui32Base + CAN_O_IF2CRQ);
+        HWREG(ui32Base + CAN_O_IF2CMSK) = RX_READ_CMD;
+    }
+
+    //
+    // Drop the message if the receive queue is full.
+    //
+    if(ui32Next == psQueue->ui32RxRead)
+    {
+        psQueue->ui32RxDropped++;
+        if(psStats)
+        {
+            psStats->ui32Lost++;
+        }
+        return;
+    }
+
+    //
+    // Copy out the data.  The registers are only read for the bytes that
+    // are present.
+    //
+    psMsg->ui8Len = ui32MsgCtrl & CAN_IF2MCTL_DLC_M;
+    if(psMsg->ui8Len > 8)
+    {
+        psMsg->ui8Len = 8;
+    }
+    if(psMsg->ui8Len > 0)
+    {
+        ui32Data = HWREG(ui32Base + CAN_O_IF2DA1);
+        psMsg->pui8Data[0] = ui32Data;
+        psMsg->pui8Data[1] = ui32Data >> 8;
+    }
+    if(psMsg->ui8Len > 2)
+    {
+        ui32Data = HWREG(ui32Base + CAN_O_IF2DA2);
+        psMsg->pui8Data[2] = ui32Data;
+        psMsg->pui8Data[3] = ui32Data >> 8;
+    }
+    if(psMsg->ui8Len > 4)
+    {
+        ui32Data = HWREG(ui32Base + CAN_O_IF2DB1);
+        psMsg->pui8Data[4] = ui32Data;
+        psMsg->pui8Data[5] = ui32Data >> 8;
+    }
+    if(psMsg->ui8Len > 6)
+    {
+        ui32Data = HWREG(ui32Base + CAN_O_IF2DB2);
+        psMsg->pui8Data[6] = ui32Data;
+        psMsg->pui8Data[7] = ui32Data >> 8;
+    }
+
+    if(psStats)
+    {
+        psStats->ui32RxFrames++;
+    }
+
+    psQueue->ui32RxWrite = ui32Next;
+}
+
+//*****************************************************************************
+//
+//! Initializes a queued CAN controller.
+//!
+//! \param psQueue is a pointer to the queue state.
+//! \param ui32Base is the base address of the CAN controller.
+//! \param psFilters is a pointer to the acceptance filter table.
+//! \param ui32NumFilters is the number of entries in the filter table.
+//! \param ui32NumTxObjs is the number of message objects used to transmit
+//! messages, from 1 to \b CAN_QUEUE_MAX_TX_OBJS.
+//! \param psRxQueue is a pointer to the receive queue buffer.
+//! \param ui32RxSize is the number of entries in the receive queue buffer.
+//! \param psTxQueue is a pointer to the transmit queue buffer.
+//! \param ui32TxSize is the number of entries in the transmit queue buffer.
+//!
+//! This function programs the message objects of a CAN controller and
+//! enables its interrupts.  The controller must have been initialized with
+//! CANInit() and had its bit rate set, but not yet enabled.
+//!
+//! Each filter table entry is assigned a chain of \e ui32Depth receive
+//! message objects, starting from message object 1, that are linked into a
+//! hardware FIFO.  The highest-numbered message objects are used for
+//! transmission.  The engine then owns both interface register sets of the
+//! controller, so CANMessageSet() and CANMessageGet() must not be used with
+//! the controller afterwards.
+//!
+//! The application must call CANQueueIntHandler() from the interrupt handler
+//! of the CAN controller.
+//!
+//! \return Returns \b true if the message objects were programmed and
+//! \b false if the filter table and transmit message objects need more than
+//! the 32 message objects of the controller.
+//
+//*****************************************************************************
+bool
+CANQueueInit(tCANQueue *psQueue, uint32_t ui32Base,
+             const tCANQueueFilter *psFilters, uint32_t ui32NumFilters,
+             uint32_t ui32NumTxObjs, tCANQueueMsg *psRxQueue,
+             uint32_t ui32RxSize, tCANQueueMsg *psTxQueue,
+             uint32_t ui32TxSize)
+{
+    tCANMsgObject sMsgObject;
+    uint32_t ui32Filter, ui32Idx, ui32Obj;
+
+    ASSERT(psQueue);
+    ASSERT((ui32Base == CAN0_BASE) || (ui32Base == CAN1_BASE));
+    ASSERT(psRxQueue && (ui32RxSize > 1));
+    ASSERT(psTxQueue && (ui32TxSize > 1));
+
+    //
+    // Make sure that there are enough message objects.
+    //
+    if((ui32NumTxObjs == 0) || (ui32NumTxObjs > CAN_QUEUE_MAX_TX_OBJS))
+    {
+        return(false);
+    }
+    ui32Obj = ui32NumTxObjs;
+    for(ui32Filter = 0; ui32Filter < ui32NumFilters; ui32Filter++)
+    {
+        ui32Obj += psFilters[ui32Filter].ui32Depth;
+    }
+    if(ui32Obj > NUM_MSG_OBJS)
+    {
+        return(false);
+    }
+
+    psQueue->ui32Base = ui32Base;
+    psQueue->psRxQueue = psRxQueue;
+    psQueue->ui32RxSize = ui32RxSize;
+    psQueue->ui32RxRead = 0;
+    psQueue->ui32RxWrite = 0;
+    psQueue->psTxQueue = psTxQueue;
+    psQueue->ui32TxSize = ui32TxSize;
+    psQueue->ui32TxRead = 0;
+    psQueue->ui32TxWrite = 0;
+    psQueue->ui32RxObjs = 0;
+    psQueue->ui32TxFirst = NUM_MSG_OBJS - ui32NumTxObjs + 1;
+    psQueue->ui32TxObjs = ui32NumTxObjs;
+    psQueue->ui32TxBusy = 0;
+    psQueue->psStats = 0;
+    psQueue->ui32NumStats = 0;
+    psQueue->ui32RxDropped = 0;
+    psQueue->ui32RxLost = 0;
+    psQueue->ui32BusErrors = 0;
+    psQueue->ui32BusOff = 0;
+
+    //
+    // Program the chain of receive message objects for each filter.  All but
+    // the last message object of a chain are marked as FIFO entries.  The
+    // extended identifier bit is always compared so that each filter only
+    // accepts the identifier size it was given.
+    //
+    ui32Obj = 1;
+    sMsgObject.ui32MsgLen = 8;
+    sMsgObject.pui8MsgData = 0;
+    for(ui32Filter = 0; ui32Filter < ui32NumFilters; ui32Filter++)
+    {
+        sMsgObject.ui32MsgID = psFilters[ui32Filter].ui32ID;
+        sMsgObject.ui32MsgIDMask = psFilters[ui32Filter].ui32Mask;
+
+        for(ui32Idx = 0; ui32Idx < psFilters[ui32Filter].ui32Depth; ui32Idx++)
+        {
+            sMsgObject.ui32Flags = (MSG_OBJ_RX_INT_ENABLE |
+                                    MSG_OBJ_USE_ID_FILTER |
+                                    MSG_OBJ_USE_EXT_FILTER);
+            if(psFilters[ui32Filter].ui32Flags & CAN_QUEUE_EXTENDED)
+            {
+                sMsgObject.ui32Flags |= MSG_OBJ_EXTENDED_ID;
+            }
+            if((ui32Idx + 1) < psFilters[ui32Filter].ui32Depth)
+            {
+                sMsgObject.ui32Flags |= MSG_OBJ_FIFO;
+            }
+
+            MAP_CANMessageSet(ui32Base, ui32Obj, &sMsgObject,
+                              MSG_OBJ_TYPE_RX);
+            psQueue->ui32RxObjs |= 1 << (ui32Obj - 1);
+            ui32Obj++;
+        }
+    }
+
+    //
+    // The transmit message objects are fully programmed each time that a
+    // message is loaded, so they are left as cleared by CANInit().  Enable
+    // the message object and error interrupts.
+    //
+    MAP_CANIntEnable(ui32Base, CAN_INT_MASTER | CAN_INT_ERROR);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Supplies a table for per-identifier statistics.
+//!
+//! \param psQueue is a pointer to the queue state.
+//! \param psStats is a pointer to the statistics table, sorted by increasing
+//! identifier, with the \e ui32ID member of each entry filled in.
+//! \param ui32NumStats is the number of entries in the table.
+//!
+//! Messages received and transmitted with an identifier in the table, and
+//! messages lost, are counted in the matching entry.  The table is searched
+//! with a binary search on each message.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+CANQueueStatsSet(tCANQueue *psQueue, tCANQueueIDStats *psStats,
+                 uint32_t ui32NumStats)
+{
+    uint32_t ui32Idx;
+    bool bIntsOff;
+
+    ASSERT(psQueue);
+
+    for(ui32Idx = 0; ui32Idx < ui32NumStats; ui32Idx++)
+    {
+        psStats[ui32Idx].ui32RxFrames = 0;
+        psStats[ui32Idx].ui32TxFrames = 0;
+        psStats[ui32Idx].ui32Lost = 0;
+    }
+
+    //
+    // Messages in flight may still refer to the previous table.
+    //
+    bIntsOff = MAP_IntMasterDisable();
+    for(ui32Idx = 0; ui32Idx < CAN_QUEUE_MAX_TX_OBJS; ui32Idx++)
+    {
+        psQueue->ppsTxStats[ui32Idx] = 0;
+    }
+    psQueue->psStats = psStats;
+    psQueue->ui32NumStats = ui32NumStats;
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Queues a message for transmission.
+//!
+//! \param psQueue is a pointer to the queue state.
+//! \param psMsg is a pointer to the message to send; it is copied into the
+//! transmit queue.
+//!
+//! This function does not wait for the message to be sent.  If the transmit
+//! message objects are idle the message is loaded immediately; otherwise it
+//! is loaded by the interrupt handler once the messages ahead of it have
+//! been sent.  Messages are sent in the order that they are queued.
+//!
+//! \return Returns \b true if the message was queued and \b false if the
+//! transmit queue is full.
+//
+//*****************************************************************************
+bool
+CANQueueSend(tCANQueue *psQueue, const tCANQueueMsg *psMsg)
+{
+    uint32_t ui32Next;
+    bool bIntsOff;
+
+    ASSERT(psQueue);
+    ASSERT(psMsg && (psMsg->ui8Len <= 8));
+
+    ui32Next = (psQueue->ui32TxWrite + 1) % psQueue->ui32TxSize;
+    if(ui32Next == psQueue->ui32TxRead)
+    {
+        return(false);
+    }
+
+    psQueue->psTxQueue[psQueue->ui32TxWrite] = *psMsg;
+    psQueue->ui32TxWrite = ui32Next;
+
+    //
+    // Start transmission if the transmit message objects are idle.  The
+    // interrupt handler also uses the IF1 registers, so it must not run
+    // while they are being written.
+    //
+    if(psQueue->ui32TxBusy == 0)
+    {
+        bIntsOff = MAP_IntMasterDisable();
+        CANQueueTxFill(psQueue);
+        if(!bIntsOff)
+        {
+            MAP_IntMasterEnable();
+        }
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Removes a received message from the receive queue.
+//!
+//! \param psQueue is a pointer to the queue state.
+//! \param psMsg is a pointer to the structure that receives the message.
+//!
+//! \return Returns \b true if a message was returned and \b false if the
+//! receive queue is empty.
+//
+//*****************************************************************************
+bool
+CANQueueReceive(tCANQueue *psQueue, tCANQueueMsg *psMsg)
+{
+    ASSERT(psQueue);
+    ASSERT(psMsg);
+
+    if(psQueue->ui32RxRead == psQueue->ui32RxWrite)
+    {
+        return(false);
+    }
+
+    *psMsg = psQueue->psRxQueue[psQueue->ui32RxRead];
+    psQueue->ui32RxRead = (psQueue->ui32RxRead + 1) % psQueue->ui32RxSize;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Returns the number of messages in the receive queue.
+//!
+//! \param psQueue is a pointer to the queue state.
+//!
+//! \return Returns the number of messages waiting to be read.
+//
+//*****************************************************************************
+uint32_t
+CANQueueRxCount(tCANQueue *psQueue)
+{
+    uint32_t ui32Read, ui32Write;
+
+    ASSERT(psQueue);
+
+    ui32Read = psQueue->ui32RxRead;
+    ui32Write = psQueue->ui32RxWrite;
+
+    return((ui32Write >= ui32Read) ? (ui32Write - ui32Read) :
+           (psQueue->ui32RxSize - ui32Read + ui32Write));
+}
+
+//*****************************************************************************
+//
+//! Handles the interrupt of a queued CAN controller.
+//!
+//! \param psQueue is a pointer to the queue state.
+//!
+//! This function must be called from the interrupt handler of the CAN
+//! controller.  Rather than handling one message object per interrupt, it
+//! reads the interrupt pending registers and services every pending message
+//! object in one pass, repeating until no interrupts remain.  Received
+//! messages are read in increasing message object order, which preserves
+//! the order of the messages within each receive FIFO.
+//!
+//! If the controller goes bus-off it is restarted automatically.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+CANQueueIntHandler(tCANQueue *psQueue)
+{
+    uint32_t ui32Base, ui32Status, ui32Pending, ui32Obj, ui32Other;
+
+    ASSERT(psQueue);
+
+    ui32Base = psQueue->ui32Base;
+
+    while((HWREG(ui32Base + CAN_O_INT) & CAN_INT_INTID_M) != 0)
+    {
+        //
+        // The status interrupt has the highest priority.  Reading the status
+        // register clears it.
+        //
+        if((HWREG(ui32Base + CAN_O_INT) & CAN_INT_INTID_M) ==
+           CAN_INT_INTID_STATUS)
+        {
+            ui32Status = HWREG(ui32Base + CAN_O_STS);
+
+            if(((ui32Status & CAN_STS_LEC_M) != CAN_STS_LEC_NONE) &&
+               ((ui32Status & CAN_STS_LEC_M) != CAN_STS_LEC_NOEVENT))
+            {
+                psQueue->ui32BusErrors++;
+            }
+
+            //
+            // Set the last error code to a value that the controller never
+            // writes so that the next error is seen as a change.
+            //
+            HWREG(ui32Base + CAN_O_STS) = CAN_STS_LEC_NOEVENT;
+
+            //
+            // The controller stops when it goes bus-off.  Clearing the
+            // initialization bit starts the bus-off recovery sequence.
+            //
+            if(ui32Status & CAN_STS_BOFF)
+            {
+                psQueue->ui32BusOff++;
+                HWREG(ui32Base + CAN_O_CTL) &= ~CAN_CTL_INIT;
+            }
+
+            continue;
+        }
+
+        ui32Pending = (HWREG(ui32Base + CAN_O_MSG1INT) |
+                       (HWREG(ui32Base + CAN_O_MSG2INT) << 16));
+
+        //
+        // Read all of the pending receive message objects.  The read command
+        // is the same for each, so it is written once.
+        //
+        if(ui32Pending & psQueue->ui32RxObjs)
+        {
+            CANQueueIFWait(ui32Base + CAN_O_IF2CRQ);
+            HWREG(ui32Base + CAN_O_IF2CMSK) = RX_READ_CMD;
+
+            for(ui32Obj = 1; ui32Obj <= NUM_MSG_OBJS; ui32Obj++)
+            {
+                if(ui32Pending & psQueue->ui32RxObjs & (1 << (ui32Obj - 1)))
+                {
+                    CANQueueRxObject(psQueue, ui32Obj);
+                }
+            }
+        }
+
+        //
+        // Handle the transmit message objects that have finished.
+        //
+        if(ui32Pending >> (psQueue->ui32TxFirst - 1))
+        {
+            CANQueueTxDone(psQueue,
+                           ui32Pending >> (psQueue->ui32TxFirst - 1));
+        }
+
+        //
+        // Clear the interrupt of any other message object so that it can not
+        // hold the interrupt asserted.
+        //
+        ui32Other = (ui32Pending & ~psQueue->ui32RxObjs &
+                     ((1 << (psQueue->ui32TxFirst - 1)) - 1));
+        for(ui32Obj = 1; ui32Other; ui32Obj++, ui32Other >>= 1)
+        {
+            if(ui32Other & 1)
+            {
+                CANQueueIFWait(ui32Base + CAN_O_IF2CRQ);
+                HWREG(ui32Base + CAN_O_IF2CMSK) = CAN_IF2CMSK_CLRINTPND;
+                HWREG(ui32Base + CAN_O_IF2CRQ) = ui32Obj;
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
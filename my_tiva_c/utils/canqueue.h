@@ -0,0 +1,280 @@
+//*****************************************************************************
+//
+// canqueue.h - Prototypes for the queued CAN message object engine.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __CANQUEUE_H__
+#define __CANQUEUE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup canqueue_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The largest number of message objects that can be used for transmission.
+//
+//*****************************************************************************
+#define CAN_QUEUE_MAX_TX_OBJS   8
+
+//*****************************************************************************
+//
+//! The message or filter uses a 29-bit identifier.
+//
+//*****************************************************************************
+#define CAN_QUEUE_EXTENDED      0x01
+
+//*****************************************************************************
+//
+//! At least one message with the identifier of this received message was
+//! overwritten in the controller before it could be read.
+//
+//*****************************************************************************
+#define CAN_QUEUE_DATA_LOST     0x02
+
+//*****************************************************************************
+//
+//! This structure holds a single CAN data frame in a transmit or receive
+//! queue.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The 11-bit or 29-bit identifier of the message.
+    //
+    uint32_t ui32ID;
+
+    //
+    //! A combination of \b CAN_QUEUE_EXTENDED and \b CAN_QUEUE_DATA_LOST.
+    //
+    uint8_t ui8Flags;
+
+    //
+    //! The number of data bytes in the message, from 0 to 8.
+    //
+    uint8_t ui8Len;
+
+    //
+    //! The data bytes of the message.
+    //
+    uint8_t pui8Data[8];
+}
+tCANQueueMsg;
+
+//*****************************************************************************
+//
+//! This structure describes one entry of the acceptance filter table.  Each
+//! entry is given a chain of receive message objects that act as a hardware
+//! FIFO for the messages that it accepts.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The identifier to accept.
+    //
+    uint32_t ui32ID;
+
+    //
+    //! The identifier bits that must match \e ui32ID; zero bits are ignored.
+    //
+    uint32_t ui32Mask;
+
+    //
+    //! \b CAN_QUEUE_EXTENDED to accept 29-bit identifiers, or zero to accept
+    //! 11-bit identifiers.
+    //
+    uint32_t ui32Flags;
+
+    //
+    //! The number of message objects chained to receive the messages.
+    //
+    uint32_t ui32Depth;
+}
+tCANQueueFilter;
+
+//*****************************************************************************
+//
+//! This structure holds the statistics for one message identifier.  A table
+//! of these, sorted by increasing identifier, is supplied to
+//! CANQueueStatsSet().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The identifier for which statistics are kept.
+    //
+    uint32_t ui32ID;
+
+    //
+    //! The number of messages received with this identifier.
+    //
+    volatile uint32_t ui32RxFrames;
+
+    //
+    //! The number of messages transmitted with this identifier.
+    //
+    volatile uint32_t ui32TxFrames;
+
+    //
+    //! The number of messages with this identifier that were lost, either in
+    //! the controller or because the receive queue was full.
+    //
+    volatile uint32_t ui32Lost;
+}
+tCANQueueIDStats;
+
+//*****************************************************************************
+//
+//! This structure contains the state of a queued CAN controller.  The
+//! members are set by CANQueueInit() and should not be modified by the
+//! application; the counters may be read at any time.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The base address of the CAN controller.
+    //
+    uint32_t ui32Base;
+
+    //
+    //! The receive queue, its size, and the read and write indices.
+    //
+    tCANQueueMsg *psRxQueue;
+    uint32_t ui32RxSize;
+    volatile uint32_t ui32RxRead;
+    volatile uint32_t ui32RxWrite;
+
+    //
+    //! The transmit queue, its size, and the read and write indices.
+    //
+    tCANQueueMsg *psTxQueue;
+    uint32_t ui32TxSize;
+    volatile uint32_t ui32TxRead;
+    volatile uint32_t ui32TxWrite;
+
+    //
+    //! The message objects used for reception, one bit per object with bit 0
+    //! for message object 1.
+    //
+    uint32_t ui32RxObjs;
+
+    //
+    //! The first message object used for transmission and the number of
+    //! transmit message objects.
+    //
+    uint32_t ui32TxFirst;
+    uint32_t ui32TxObjs;
+
+    //
+    //! The transmit message objects that have a message in flight, with bit
+    //! 0 for the first transmit message object.
+    //
+    volatile uint32_t ui32TxBusy;
+
+    //
+    //! The statistics entry of the message in each transmit message object.
+    //
+    tCANQueueIDStats *ppsTxStats[CAN_QUEUE_MAX_TX_OBJS];
+
+    //
+    //! The table of per-identifier statistics and the number of entries.
+    //
+    tCANQueueIDStats *psStats;
+    uint32_t ui32NumStats;
+
+    //
+    //! The number of received messages discarded because the receive queue
+    //! was full.
+    //
+    volatile uint32_t ui32RxDropped;
+
+    //
+    //! The number of messages overwritten in the controller before they were
+    //! read.
+    //
+    volatile uint32_t ui32RxLost;
+
+    //
+    //! The number of error frames detected on the bus.
+    //
+    volatile uint32_t ui32BusErrors;
+
+    //
+    //! The number of times that the controller went bus-off and was
+    //! restarted.
+    //
+    volatile uint32_t ui32BusOff;
+}
+tCANQueue;
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern bool CANQueueInit(tCANQueue *psQueue, uint32_t ui32Base,
+                         const tCANQueueFilter *psFilters,
+                         uint32_t ui32NumFilters, uint32_t ui32NumTxObjs,
+                         tCANQueueMsg *psRxQueue, uint32_t ui32RxSize,
+                         tCANQueueMsg *psTxQueue, uint32_t ui32TxSize);
+extern void CANQueueStatsSet(tCANQueue *psQueue, tCANQueueIDStats *psStats,
+                             uint32_t ui32NumStats);
+extern bool CANQueueSend(tCANQueue *psQueue, const tCANQueueMsg *psMsg);
+extern bool CANQueueReceive(tCANQueue *psQueue, tCANQueueMsg *psMsg);
+extern uint32_t CANQueueRxCount(tCANQueue *psQueue);
+extern void CANQueueIntHandler(tCANQueue *psQueue);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CANQUEUE_H__
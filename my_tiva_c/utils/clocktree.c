@@ -0,0 +1,289 @@
+//*****************************************************************************
+//
+// clocktree.c - Cached clock tree manager.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "utils/clocktree.h"
+
+//*****************************************************************************
+//
+//! \addtogroup clocktree_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The cached processor and PWM clock frequencies.
+//
+//*****************************************************************************
+uint32_t g_ui32ClockTreeSysClock;
+uint32_t g_ui32ClockTreePWMClock;
+
+//*****************************************************************************
+//
+// The list of clients that are notified of clock changes.
+//
+//*****************************************************************************
+static tClockTreeClient *g_psClockTreeClients;
+
+//*****************************************************************************
+//
+// Computes the derived clocks from the processor clock.  This is the only
+// place that the clock configuration registers are decoded.
+//
+//*****************************************************************************
+static void
+ClockTreeUpdate(uint32_t ui32SysClock)
+{
+    uint32_t ui32RCC;
+
+    g_ui32ClockTreeSysClock = ui32SysClock;
+    g_ui32ClockTreePWMClock = ui32SysClock;
+
+    if(CLASS_IS_TM4C123)
+    {
+        ui32RCC = HWREG(SYSCTL_RCC);
+        if(ui32RCC & SYSCTL_RCC_USEPWMDIV)
+        {
+            g_ui32ClockTreePWMClock /=
+                2 << ((ui32RCC & SYSCTL_RCC_PWMDIV_M) >> 17);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Notifies the registered clients of a clock change.
+//
+//*****************************************************************************
+static void
+ClockTreeNotify(void)
+{
+    tClockTreeClient *psClient;
+
+    for(psClient = g_psClockTreeClients; psClient; psClient = psClient->psNext)
+    {
+        psClient->pfnCallback(psClient->pvCBData, g_ui32ClockTreeSysClock);
+    }
+}
+
+//*****************************************************************************
+//
+//! Initializes the clock tree manager.
+//!
+//! \param ui32SysClock is the current processor clock frequency, or 0 to
+//! determine it with SysCtlClockGet() on TM4C123 devices.  On TM4C129
+//! devices, this must be the value returned by SysCtlClockFreqSet() if the
+//! clock has been configured, or 16000000 if it has not.
+//!
+//! This function computes the clock frequencies once, after which they are
+//! returned by ClockTreeSysClockGet() and ClockTreePWMClockGet() without
+//! reading the clock configuration registers.  Clock changes must then be
+//! made through ClockTreeSet(), ClockTreeFreqSet() or ClockTreePWMClockSet()
+//! so that the cached values remain valid.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockTreeInit(uint32_t ui32SysClock)
+{
+    ASSERT(ui32SysClock || CLASS_IS_TM4C123);
+
+    g_psClockTreeClients = 0;
+
+    if(!ui32SysClock)
+    {
+        ui32SysClock = MAP_SysCtlClockGet();
+    }
+    ClockTreeUpdate(ui32SysClock);
+}
+
+//*****************************************************************************
+//
+//! Configures the clocking of a TM4C123 device.
+//!
+//! \param ui32Config is the clock configuration, as passed to
+//! SysCtlClockSet().
+//!
+//! This function configures the clocking with SysCtlClockSet(), recomputes
+//! the cached clock frequencies and notifies the registered clients.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockTreeSet(uint32_t ui32Config)
+{
+    ASSERT(CLASS_IS_TM4C123);
+
+    MAP_SysCtlClockSet(ui32Config);
+    ClockTreeUpdate(MAP_SysCtlClockGet());
+    ClockTreeNotify();
+}
+
+//*****************************************************************************
+//
+//! Configures the clocking of a TM4C129 device.
+//!
+//! \param ui32Config is the clock configuration, as passed to
+//! SysCtlClockFreqSet().
+//! \param ui32SysClock is the requested processor clock frequency.
+//!
+//! This function configures the clocking with SysCtlClockFreqSet().  If it
+//! succeeds, the cached clock frequencies are recomputed and the registered
+//! clients are notified.
+//!
+//! \return Returns the actual processor clock frequency, or 0 if the clocking
+//! could not be configured, as returned by SysCtlClockFreqSet().
+//
+//*****************************************************************************
+uint32_t
+ClockTreeFreqSet(uint32_t ui32Config, uint32_t ui32SysClock)
+{
+    ASSERT(CLASS_IS_TM4C129);
+
+    ui32SysClock = MAP_SysCtlClockFreqSet(ui32Config, ui32SysClock);
+    if(ui32SysClock)
+    {
+        ClockTreeUpdate(ui32SysClock);
+        ClockTreeNotify();
+    }
+
+    return(ui32SysClock);
+}
+
+//*****************************************************************************
+//
+//! Sets the PWM clock divider of a TM4C123 device.
+//!
+//! \param ui32Config is the PWM clock configuration, as passed to
+//! SysCtlPWMClockSet().
+//!
+//! This function sets the PWM clock divider with SysCtlPWMClockSet(),
+//! recomputes the cached PWM clock frequency and notifies the registered
+//! clients.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockTreePWMClockSet(uint32_t ui32Config)
+{
+    ASSERT(CLASS_IS_TM4C123);
+
+    MAP_SysCtlPWMClockSet(ui32Config);
+    ClockTreeUpdate(g_ui32ClockTreeSysClock);
+    ClockTreeNotify();
+}
+
+//*****************************************************************************
+//
+//! Registers a client to be notified of clock changes.
+//!
+//! \param psClient is a pointer to the client structure.
+//! \param pfnCallback is the function called when the clocks change.
+//! \param pvCBData is the data pointer passed to \e pfnCallback.
+//!
+//! The callback is called from the context of the function that changes the
+//! clocks, after the change has taken effect, so that the client can retune
+//! its baud rates and timer periods.
+//!  UARTStdioClockChanged(), SchedulerClockChanged() and
+//! SPIBusClockChanged() may be registered directly as callbacks.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockTreeRegister(tClockTreeClient *psClient, tClockTreeCallback pfnCallback,
+                  void *pvCBData)
+{
+    bool bIntsOff;
+
+    ASSERT(psClient);
+    ASSERT(pfnCallback);
+
+    psClient->pfnCallback = pfnCallback;
+    psClient->pvCBData = pvCBData;
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    psClient->psNext = g_psClockTreeClients;
+    g_psClockTreeClients = psClient;
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Unregisters a client.
+//!
+//! \param psClient is a pointer to the client structure.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClockTreeUnregister(tClockTreeClient *psClient)
+{
+    tClockTreeClient **ppsClient;
+    bool bIntsOff;
+
+    ASSERT(psClient);
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    for(ppsClient = &g_psClockTreeClients; *ppsClient;
+        ppsClient = &(*ppsClient)->psNext)
+    {
+        if(*ppsClient == psClient)
+        {
+            *ppsClient = psClient->psNext;
+            break;
+        }
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
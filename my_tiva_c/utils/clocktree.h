@@ -0,0 +1,135 @@
+//*****************************************************************************
+//
+// clocktree.h - Prototypes for the cached clock tree manager.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __CLOCKTREE_H__
+#define __CLOCKTREE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup clocktree_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The prototype for the function that is called when the clocks change.  It
+//! is called with the callback data of the client and the new processor
+//! clock frequency, after the new clock configuration has taken effect.
+//
+//*****************************************************************************
+typedef void (*tClockTreeCallback)(void *pvCBData, uint32_t ui32SysClock);
+
+//*****************************************************************************
+//
+//! This structure describes a client that is notified of clock changes.  It
+//! is owned by the clock tree manager while the client is registered.
+//
+//*****************************************************************************
+typedef struct tClockTreeClient
+{
+    //
+    //! The next registered client.
+    //
+    struct tClockTreeClient *psNext;
+
+    //
+    //! The function called when the clocks change, and the data pointer
+    //! passed to it.
+    //
+    tClockTreeCallback pfnCallback;
+    void *pvCBData;
+}
+tClockTreeClient;
+
+//*****************************************************************************
+//
+// The cached clock frequencies.  These should be read with the functions
+// below rather than directly.
+//
+//*****************************************************************************
+extern uint32_t g_ui32ClockTreeSysClock;
+extern uint32_t g_ui32ClockTreePWMClock;
+
+//*****************************************************************************
+//
+//! Returns the cached processor clock frequency, in Hz.  This is also the
+//! clock frequency of most peripherals, and may be passed to the
+//! *ConfigSetExpClk() functions in place of SysCtlClockGet().
+//
+//*****************************************************************************
+#define ClockTreeSysClockGet()  (g_ui32ClockTreeSysClock)
+
+//*****************************************************************************
+//
+//! Returns the cached PWM module clock frequency, in Hz, as set by the
+//! processor clock and the divider programmed by ClockTreePWMClockSet().  On
+//! TM4C129 devices, the PWM clock divider is part of the PWM module, and this
+//! returns the processor clock frequency.
+//
+//*****************************************************************************
+#define ClockTreePWMClockGet()  (g_ui32ClockTreePWMClock)
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void ClockTreeInit(uint32_t ui32SysClock);
+extern void ClockTreeSet(uint32_t ui32Config);
+extern uint32_t ClockTreeFreqSet(uint32_t ui32Config, uint32_t ui32SysClock);
+extern void ClockTreePWMClockSet(uint32_t ui32Config);
+extern void ClockTreeRegister(tClockTreeClient *psClient,
+                              tClockTreeCallback pfnCallback,
+                              void *pvCBData);
+extern void ClockTreeUnregister(tClockTreeClient *psClient);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CLOCKTREE_H__
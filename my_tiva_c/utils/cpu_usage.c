@@ -78,6 +78,13 @@ static uint32_t g_ui32CPUUsageTimer;
 //*****************************************************************************
 static uint32_t g_ui32CPUUsageTicks;
 
+//*****************************************************************************
+//
+// The number of times per second that CPUUsageTick() is called.
+//
+//*****************************************************************************
+static uint32_t g_ui32CPUUsageRate;
+
 //*****************************************************************************
 //
 // The value of timer two on the previous timing period.  This is used to
@@ -160,6 +167,7 @@ CPUUsageInit(uint32_t ui32ClockRate, uint32_t ui32Rate, uint32_t ui32Timer)
     //
     // Determine the number of system clocks per measurement period.
     //
+    g_ui32CPUUsageRate = ui32Rate;
     g_ui32CPUUsageTicks = ui32ClockRate / ui32Rate;
 
     //
@@ -198,6 +206,39 @@ CPUUsageInit(uint32_t ui32ClockRate, uint32_t ui32Rate, uint32_t ui32Timer)
     MAP_TimerEnable(g_pui32CPUUsageTimerBase[ui32Timer], TIMER_A);
 }
 
+//*****************************************************************************
+//
+//! Informs the CPU usage measurement module of a new clock rate.
+//!
+//! \param ui32ClockRate is the new rate of the clock supplied to the timer
+//! module.
+//!
+//! This function must be called whenever the system clock is changed after
+//! CPUUsageInit(), since the usage is computed from the number of clocks in
+//! each timing period.  Without it, a fully busy processor running at a
+//! fraction of the initial clock rate reports the same fraction of 100%.
+//! The timing period in progress when the clock changes is measured partly
+//! at each rate, so the next usage returned is approximate.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+CPUUsageClockSet(uint32_t ui32ClockRate)
+{
+    //
+    // Nothing is measured until CPUUsageInit() has been called.
+    //
+    if(g_ui32CPUUsageRate == 0)
+    {
+        return;
+    }
+
+    ASSERT(ui32ClockRate > g_ui32CPUUsageRate);
+
+    g_ui32CPUUsageTicks = ui32ClockRate / g_ui32CPUUsageRate;
+}
+
 //*****************************************************************************
 //
 // Close the Doxygen group.
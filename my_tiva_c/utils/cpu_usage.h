@@ -44,6 +44,7 @@ extern "C"
 extern uint32_t CPUUsageTick(void);
 extern void CPUUsageInit(uint32_t ui32ClockRate, uint32_t ui32Rate,
                          uint32_t ui32Timer);
+extern void CPUUsageClockSet(uint32_t ui32ClockRate);
 
 //*****************************************************************************
 //
@@ -0,0 +1,868 @@
+//*****************************************************************************
+//
+// dsplib.c - Block-based signal processing functions.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "driverlib/debug.h"
+#include "utils/dsplib.h"
+#include "utils/isqrt.h"
+#include "utils/sine.h"
+#if defined(ewarm)
+#include <intrinsics.h>
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup dsplib_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Wrappers for the Cortex-M4 SIMD instructions used by the block functions.
+// Each operates on a pair of Q15 values packed into a 32-bit word, with the
+// first value of the pair in the lower half-word.
+//
+//   SMLAD   - acc + (a.lo * b.lo) + (a.hi * b.hi)
+//   SMUSD   - (a.lo * b.lo) - (a.hi * b.hi)
+//   SMUADX  - (a.lo * b.hi) + (a.hi * b.lo)
+//   QADD16  - saturating a + b on each half-word
+//   SHADD16 - (a + b) / 2 on each half-word
+//   SHSUB16 - (a - b) / 2 on each half-word
+//
+//*****************************************************************************
+#if defined(codered) || defined(gcc) || defined(sourcerygxx)
+static inline int32_t
+SMLAD(uint32_t ui32A, uint32_t ui32B, int32_t i32Acc)
+{
+    int32_t i32Ret;
+
+    __asm("    smlad   %0, %1, %2, %3\n"
+          : "=r" (i32Ret) : "r" (ui32A), "r" (ui32B), "r" (i32Acc));
+
+    return(i32Ret);
+}
+
+static inline int32_t
+SMUSD(uint32_t ui32A, uint32_t ui32B)
+{
+    int32_t i32Ret;
+
+    __asm("    smusd   %0, %1, %2\n"
+          : "=r" (i32Ret) : "r" (ui32A), "r" (ui32B));
+
+    return(i32Ret);
+}
+
+static inline int32_t
+SMUADX(uint32_t ui32A, uint32_t ui32B)
+{
+    int32_t i32Ret;
+
+    __asm("    smuadx  %0, %1, %2\n"
+          : "=r" (i32Ret) : "r" (ui32A), "r" (ui32B));
+
+    return(i32Ret);
+}
+
+static inline uint32_t
+QADD16(uint32_t ui32A, uint32_t ui32B)
+{
+    uint32_t ui32Ret;
+
+    __asm("    qadd16  %0, %1, %2\n"
+          : "=r" (ui32Ret) : "r" (ui32A), "r" (ui32B));
+
+    return(ui32Ret);
+}
+
+static inline uint32_t
+SHADD16(uint32_t ui32A, uint32_t ui32B)
+{
+    uint32_t ui32Ret;
+
+    __asm("    shadd16 %0, %1, %2\n"
+          : "=r" (ui32Ret) : "r" (ui32A), "r" (ui32B));
+
+    return(ui32Ret);
+}
+
+static inline uint32_t
+SHSUB16(uint32_t ui32A, uint32_t ui32B)
+{
+    uint32_t ui32Ret;
+
+    __asm("    shsub16 %0, %1, %2\n"
+          : "=r" (ui32Ret) : "r" (ui32A), "r" (ui32B));
+
+    return(ui32Ret);
+}
+#elif defined(ewarm)
+#define SMLAD(a, b, c)          ((int32_t)__SMLAD((a), (b), (c)))
+#define SMUSD(a, b)             ((int32_t)__SMUSD((a), (b)))
+#define SMUADX(a, b)            ((int32_t)__SMUADX((a), (b)))
+#define QADD16(a, b)            __QADD16((a), (b))
+#define SHADD16(a, b)           __SHADD16((a), (b))
+#define SHSUB16(a, b)           __SHSUB16((a), (b))
+#elif defined(rvmdk) || defined(__ARMCC_VERSION)
+#define SMLAD(a, b, c)          ((int32_t)__smlad((a), (b), (c)))
+#define SMUSD(a, b)             ((int32_t)__smusd((a), (b)))
+#define SMUADX(a, b)            ((int32_t)__smuadx((a), (b)))
+#define QADD16(a, b)            __qadd16((a), (b))
+#define SHADD16(a, b)           __shadd16((a), (b))
+#define SHSUB16(a, b)           __shsub16((a), (b))
+#elif defined(ccs)
+#define SMLAD(a, b, c)          ((int32_t)_smlad((a), (b), (c)))
+#define SMUSD(a, b)             ((int32_t)_smusd((a), (b)))
+#define SMUADX(a, b)            ((int32_t)_smuadx((a), (b)))
+#define QADD16(a, b)            _qadd16((a), (b))
+#define SHADD16(a, b)           _shadd16((a), (b))
+#define SHSUB16(a, b)           _shsub16((a), (b))
+#else
+//
+// Portable equivalents, used when building with any other compiler (for
+// example, when building the functions on a host for verification).
+//
+#define LO(x)                   ((int32_t)(int16_t)((x) & 0xffff))
+#define HI(x)                   ((int32_t)(int16_t)((x) >> 16))
+#define PACK(lo, hi)            (((uint32_t)(lo) & 0xffff) |                  \
+                                 ((uint32_t)(hi) << 16))
+
+static int32_t
+Sat16(int32_t i32Value)
+{
+    return((i32Value > 32767) ? 32767 :
+           ((i32Value < -32768) ? -32768 : i32Value));
+}
+
+static int32_t
+SMLAD(uint32_t ui32A, uint32_t ui32B, int32_t i32Acc)
+{
+    return((int32_t)((uint32_t)i32Acc + (uint32_t)(LO(ui32A) * LO(ui32B)) +
+                     (uint32_t)(HI(ui32A) * HI(ui32B))));
+}
+
+static int32_t
+SMUSD(uint32_t ui32A, uint32_t ui32B)
+{
+    return((LO(ui32A) * LO(ui32B)) - (HI(ui32A) * HI(ui32B)));
+}
+
+static int32_t
+SMUADX(uint32_t ui32A, uint32_t ui32B)
+{
+    return((int32_t)((uint32_t)(LO(ui32A) * HI(ui32B)) +
+                     (uint32_t)(HI(ui32A) * LO(ui32B))));
+}
+
+static uint32_t
+QADD16(uint32_t ui32A, uint32_t ui32B)
+{
+    return(PACK(Sat16(LO(ui32A) + LO(ui32B)), Sat16(HI(ui32A) + HI(ui32B))));
+}
+
+static uint32_t
+SHADD16(uint32_t ui32A, uint32_t ui32B)
+{
+    return(PACK((LO(ui32A) + LO(ui32B)) >> 1, (HI(ui32A) + HI(ui32B)) >> 1));
+}
+
+static uint32_t
+SHSUB16(uint32_t ui32A, uint32_t ui32B)
+{
+    return(PACK((LO(ui32A) - LO(ui32B)) >> 1, (HI(ui32A) - HI(ui32B)) >> 1));
+}
+#endif
+
+//*****************************************************************************
+//
+// Reads a pair of consecutive Q15 values as a packed word.  The values are
+// read separately since the pair may not be word aligned.
+//
+//*****************************************************************************
+#define PAIR(pi16Ptr)           ((uint32_t)(uint16_t)(pi16Ptr)[0] |           \
+                                 ((uint32_t)(uint16_t)(pi16Ptr)[1] << 16))
+
+//*****************************************************************************
+//
+// Saturates a value to the Q15 range.
+//
+//*****************************************************************************
+static int16_t
+Q15Sat(int32_t i32Value)
+{
+    if(i32Value > 32767)
+    {
+        return(32767);
+    }
+    if(i32Value < -32768)
+    {
+        return(-32768);
+    }
+    return((int16_t)i32Value);
+}
+
+//*****************************************************************************
+//
+//! Converts a block of ADC samples to Q15 values.
+//!
+//! \param pui16In is a pointer to the 12-bit unsigned ADC samples.
+//! \param pi16Out is a pointer to the buffer that receives the Q15 values.
+//! \param ui32Count is the number of samples.
+//!
+//! This function converts samples, such as a block from the ADC streaming
+//! engine, to signed Q15 values centered on mid-scale.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPADCToQ15(const uint16_t *pui16In, int16_t *pi16Out, uint32_t ui32Count)
+{
+    while(ui32Count--)
+    {
+        *pi16Out++ = (int16_t)(((int32_t)(*pui16In++ & 0xfff) - 2048) << 4);
+    }
+}
+
+//*****************************************************************************
+//
+//! Converts a block of Q15 values to floating point.
+//!
+//! \param pi16In is a pointer to the Q15 values.
+//! \param pfOut is a pointer to the buffer that receives the floating-point
+//! values, in the range [-1, 1).
+//! \param ui32Count is the number of values.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPQ15ToF32(const int16_t *pi16In, float *pfOut, uint32_t ui32Count)
+{
+    while(ui32Count--)
+    {
+        *pfOut++ = (float)*pi16In++ * (1.0f / 32768.0f);
+    }
+}
+
+//*****************************************************************************
+//
+//! Adds two blocks of Q15 values with saturation.
+//!
+//! \param pi16InA is a pointer to the first block.
+//! \param pi16InB is a pointer to the second block.
+//! \param pi16Out is a pointer to the buffer that receives the sums; it may be
+//! the same as either input.
+//! \param ui32Count is the number of values.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPAddQ15(const int16_t *pi16InA, const int16_t *pi16InB, int16_t *pi16Out,
+          uint32_t ui32Count)
+{
+    uint32_t ui32Sum;
+
+    //
+    // Add two values at a time.
+    //
+    while(ui32Count >= 2)
+    {
+        ui32Sum = QADD16(PAIR(pi16InA), PAIR(pi16InB));
+        pi16Out[0] = (int16_t)ui32Sum;
+        pi16Out[1] = (int16_t)(ui32Sum >> 16);
+        pi16InA += 2;
+        pi16InB += 2;
+        pi16Out += 2;
+        ui32Count -= 2;
+    }
+
+    if(ui32Count)
+    {
+        *pi16Out = Q15Sat((int32_t)*pi16InA + *pi16InB);
+    }
+}
+
+//*****************************************************************************
+//
+// Filters up to one state buffer worth of samples, producing an output every
+// ui16Factor input samples.  Returns the number of output samples.
+//
+//*****************************************************************************
+static uint32_t
+DSPFIRQ15Block(tDSPFIRQ15 *psFIR, const int16_t *pi16In, int16_t *pi16Out,
+               uint32_t ui32Count)
+{
+    const int16_t *pi16Coeffs, *pi16Window;
+    uint32_t ui32Idx, ui32Tap, ui32NumTaps, ui32Out;
+    int32_t i32Acc;
+
+    pi16Coeffs = psFIR->pi16Coeffs;
+    ui32NumTaps = psFIR->ui16NumTaps;
+
+    //
+    // Append the new samples to the history of the previous block.
+    //
+    memcpy(psFIR->pi16State + ui32NumTaps - 1, pi16In,
+           ui32Count * sizeof(int16_t));
+
+    ui32Out = 0;
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        if(psFIR->ui16Phase == 0)
+        {
+            //
+            // The window of samples that ends with this input sample.
+            //
+            pi16Window = psFIR->pi16State + ui32Idx;
+
+            //
+            // Accumulate two taps at a time.  The products are Q30, so the
+            // accumulator cannot overflow provided the sum of the absolute
+            // values of the coefficients is less than 2.
+            //
+            i32Acc = 0;
+            for(ui32Tap = 0; (ui32Tap + 1) < ui32NumTaps; ui32Tap += 2)
+            {
+                i32Acc = SMLAD(PAIR(pi16Coeffs + ui32Tap),
+                               PAIR(pi16Window + ui32Tap), i32Acc);
+            }
+            if(ui32NumTaps & 1)
+            {
+                i32Acc += (int32_t)pi16Coeffs[ui32Tap] * pi16Window[ui32Tap];
+            }
+
+            pi16Out[ui32Out++] = Q15Sat(i32Acc >> 15);
+            psFIR->ui16Phase = psFIR->ui16Factor;
+        }
+        psFIR->ui16Phase--;
+    }
+
+    //
+    // Keep the last ui32NumTaps - 1 samples for the next block.
+    //
+    memmove(psFIR->pi16State, psFIR->pi16State + ui32Count,
+            (ui32NumTaps - 1) * sizeof(int16_t));
+
+    return(ui32Out);
+}
+
+//*****************************************************************************
+//
+//! Initializes a Q15 FIR filter.
+//!
+//! \param psFIR is a pointer to the filter state.
+//! \param pi16Coeffs is a pointer to the Q15 filter coefficients, stored in
+//! time-reversed order (the coefficient applied to the oldest sample first).
+//! \param ui16NumTaps is the number of coefficients.
+//! \param pi16State is a pointer to a state buffer of
+//! \e ui16NumTaps - 1 + \e ui16BlockSize samples.
+//! \param ui16BlockSize is the largest number of samples filtered in one
+//! pass; longer blocks are split into passes of this size.
+//!
+//! The products are accumulated in 32 bits, two taps per SMLAD instruction,
+//! so the sum of the absolute values of the coefficients must be less than 2.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPFIRQ15Init(tDSPFIRQ15 *psFIR, const int16_t *pi16Coeffs,
+              uint16_t ui16NumTaps, int16_t *pi16State,
+              uint16_t ui16BlockSize)
+{
+    DSPDecimateQ15Init(psFIR, pi16Coeffs, ui16NumTaps, 1, pi16State,
+                       ui16BlockSize);
+}
+
+//*****************************************************************************
+//
+//! Filters a block of Q15 samples with a FIR filter.
+//!
+//! \param psFIR is a pointer to the filter state.
+//! \param pi16In is a pointer to the input samples.
+//! \param pi16Out is a pointer to the buffer that receives the filtered
+//! samples; it may be the same as \e pi16In.
+//! \param ui32Count is the number of samples.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPFIRQ15(tDSPFIRQ15 *psFIR, const int16_t *pi16In, int16_t *pi16Out,
+          uint32_t ui32Count)
+{
+    DSPDecimateQ15(psFIR, pi16In, pi16Out, ui32Count);
+}
+
+//*****************************************************************************
+//
+//! Initializes a Q15 decimating FIR filter.
+//!
+//! \param psFIR is a pointer to the filter state.
+//! \param pi16Coeffs is a pointer to the Q15 anti-aliasing filter
+//! coefficients, stored in time-reversed order.
+//! \param ui16NumTaps is the number of coefficients.
+//! \param ui16Factor is the decimation factor.
+//! \param pi16State is a pointer to a state buffer of
+//! \e ui16NumTaps - 1 + \e ui16BlockSize samples.
+//! \param ui16BlockSize is the largest number of input samples processed in
+//! one pass.
+//!
+//! The filter output is only computed for the samples that are kept, so
+//! decimating by \e ui16Factor costs 1 / \e ui16Factor of filtering at the
+//! input rate.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPDecimateQ15Init(tDSPFIRQ15 *psFIR, const int16_t *pi16Coeffs,
+                   uint16_t ui16NumTaps, uint16_t ui16Factor,
+                   int16_t *pi16State, uint16_t ui16BlockSize)
+{
+    ASSERT(psFIR);
+    ASSERT(pi16Coeffs);
+    ASSERT(pi16State);
+    ASSERT(ui16NumTaps);
+    ASSERT(ui16Factor);
+    ASSERT(ui16BlockSize);
+
+    psFIR->pi16Coeffs = pi16Coeffs;
+    psFIR->pi16State = pi16State;
+    psFIR->ui16NumTaps = ui16NumTaps;
+    psFIR->ui16BlockSize = ui16BlockSize;
+    psFIR->ui16Factor = ui16Factor;
+    psFIR->ui16Phase = 0;
+
+    //
+    // Start with a history of silence.
+    //
+    memset(pi16State, 0, (ui16NumTaps - 1) * sizeof(int16_t));
+}
+
+//*****************************************************************************
+//
+//! Filters and decimates a block of Q15 samples.
+//!
+//! \param psFIR is a pointer to the filter state.
+//! \param pi16In is a pointer to the input samples.
+//! \param pi16Out is a pointer to the buffer that receives the output
+//! samples; it may be the same as \e pi16In.
+//! \param ui32Count is the number of input samples.
+//!
+//! The decimation phase is kept between calls, so blocks need not be a
+//! multiple of the decimation factor.
+//!
+//! \return Returns the number of output samples.
+//
+//*****************************************************************************
+uint32_t
+DSPDecimateQ15(tDSPFIRQ15 *psFIR, const int16_t *pi16In, int16_t *pi16Out,
+               uint32_t ui32Count)
+{
+    uint32_t ui32Pass, ui32Out;
+
+    ASSERT(psFIR);
+
+    ui32Out = 0;
+    while(ui32Count)
+    {
+        ui32Pass = (ui32Count > psFIR->ui16BlockSize) ?
+                   psFIR->ui16BlockSize : ui32Count;
+
+        ui32Out += DSPFIRQ15Block(psFIR, pi16In, pi16Out + ui32Out, ui32Pass);
+
+        pi16In += ui32Pass;
+        ui32Count -= ui32Pass;
+    }
+
+    return(ui32Out);
+}
+
+//*****************************************************************************
+//
+//! Initializes a cascade of floating-point biquad filter stages.
+//!
+//! \param psBiquad is a pointer to the filter state.
+//! \param ui32NumStages is the number of second order stages.
+//! \param pfCoeffs is a pointer to five coefficients per stage, in the order
+//! b0, b1, b2, a1, a2.
+//! \param pfState is a pointer to a buffer of two values per stage.
+//!
+//! The stages are implemented in transposed direct form II using the
+//! floating-point unit, which must be enabled by the application.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPBiquadF32Init(tDSPBiquadF32 *psBiquad, uint32_t ui32NumStages,
+                 const float *pfCoeffs, float *pfState)
+{
+    ASSERT(psBiquad);
+    ASSERT(pfCoeffs);
+    ASSERT(pfState);
+
+    psBiquad->ui32NumStages = ui32NumStages;
+    psBiquad->pfCoeffs = pfCoeffs;
+    psBiquad->pfState = pfState;
+
+    memset(pfState, 0, ui32NumStages * 2 * sizeof(float));
+}
+
+//*****************************************************************************
+//
+//! Filters a block of floating-point samples with a cascade of biquads.
+//!
+//! \param psBiquad is a pointer to the filter state.
+//! \param pfIn is a pointer to the input samples.
+//! \param pfOut is a pointer to the buffer that receives the filtered
+//! samples; it may be the same as \e pfIn.
+//! \param ui32Count is the number of samples.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPBiquadF32(tDSPBiquadF32 *psBiquad, const float *pfIn, float *pfOut,
+             uint32_t ui32Count)
+{
+    const float *pfCoeffs;
+    float fB0, fB1, fB2, fA1, fA2, fD1, fD2, fX, fY;
+    uint32_t ui32Stage, ui32Idx;
+
+    ASSERT(psBiquad);
+
+    pfCoeffs = psBiquad->pfCoeffs;
+
+    //
+    // Run the whole block through each stage in turn so that the
+    // coefficients and state of a stage stay in registers.
+    //
+    for(ui32Stage = 0; ui32Stage < psBiquad->ui32NumStages; ui32Stage++)
+    {
+        fB0 = pfCoeffs[0];
+        fB1 = pfCoeffs[1];
+        fB2 = pfCoeffs[2];
+        fA1 = pfCoeffs[3];
+        fA2 = pfCoeffs[4];
+        fD1 = psBiquad->pfState[ui32Stage * 2];
+        fD2 = psBiquad->pfState[(ui32Stage * 2) + 1];
+
+        for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+        {
+            fX = pfIn[ui32Idx];
+            fY = (fB0 * fX) + fD1;
+            fD1 = (fB1 * fX) - (fA1 * fY) + fD2;
+            fD2 = (fB2 * fX) - (fA2 * fY);
+            pfOut[ui32Idx] = fY;
+        }
+
+        psBiquad->pfState[ui32Stage * 2] = fD1;
+        psBiquad->pfState[(ui32Stage * 2) + 1] = fD2;
+
+        //
+        // The following stages filter the output of this one.
+        //
+        pfIn = pfOut;
+        pfCoeffs += 5;
+    }
+}
+
+//*****************************************************************************
+//
+//! Computes the RMS value of a block of Q15 samples.
+//!
+//! \param pi16In is a pointer to the samples.
+//! \param ui32Count is the number of samples.
+//!
+//! \return Returns the RMS value in Q15 format.
+//
+//*****************************************************************************
+int16_t
+DSPRMSQ15(const int16_t *pi16In, uint32_t ui32Count)
+{
+    uint64_t ui64Sum;
+    uint32_t ui32Idx;
+
+    if(ui32Count == 0)
+    {
+        return(0);
+    }
+
+    //
+    // Square and sum two samples at a time.  Each pair sum is at most 2^31,
+    // so it is accumulated as an unsigned value.
+    //
+    ui64Sum = 0;
+    for(ui32Idx = 0; (ui32Idx + 1) < ui32Count; ui32Idx += 2)
+    {
+        ui64Sum += (uint32_t)SMLAD(PAIR(pi16In + ui32Idx),
+                                   PAIR(pi16In + ui32Idx), 0);
+    }
+    if(ui32Count & 1)
+    {
+        ui64Sum += (uint32_t)((int32_t)pi16In[ui32Idx] * pi16In[ui32Idx]);
+    }
+
+    //
+    // The mean square is Q30, so its square root is Q15.
+    //
+    return(Q15Sat((int32_t)isqrt((uint32_t)(ui64Sum / ui32Count))));
+}
+
+//*****************************************************************************
+//
+//! Initializes a Goertzel single-frequency detector.
+//!
+//! \param psGoertzel is a pointer to the detector state.
+//! \param ui32Frequency is the frequency to detect, in Hz.
+//! \param ui32SampleRate is the sample rate, in Hz.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPGoertzelInit(tDSPGoertzel *psGoertzel, uint32_t ui32Frequency,
+                uint32_t ui32SampleRate)
+{
+    uint32_t ui32Angle, ui32Frac;
+    int32_t i32Cos0, i32Cos1;
+
+    ASSERT(psGoertzel);
+    ASSERT(ui32Frequency < ui32SampleRate);
+
+    //
+    // The angle advanced per sample, as a 0.32 fraction of a circle.
+    //
+    ui32Angle = (uint32_t)(((uint64_t)ui32Frequency << 32) / ui32SampleRate);
+
+    //
+    // The sine table has an entry every 1/512 of a circle, which on its own
+    // would move the detector frequency by up to a few tenths of a percent of
+    // the sample rate.  Interpolate between the entries either side of the
+    // angle instead.
+    //
+    ui32Frac = ui32Angle & 0x007fffff;
+    i32Cos0 = cosine(ui32Angle - ui32Frac);
+    i32Cos1 = cosine(ui32Angle - ui32Frac + 0x00800000);
+
+    psGoertzel->fCoeff = (2.0f * ((float)i32Cos0 +
+                                  (((float)(i32Cos1 - i32Cos0) *
+                                    (float)ui32Frac) / 8388608.0f))) /
+                         65536.0f;
+    psGoertzel->fS1 = 0.0f;
+    psGoertzel->fS2 = 0.0f;
+}
+
+//*****************************************************************************
+//
+//! Passes a block of Q15 samples through a Goertzel detector.
+//!
+//! \param psGoertzel is a pointer to the detector state.
+//! \param pi16In is a pointer to the samples.
+//! \param ui32Count is the number of samples.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPGoertzelQ15(tDSPGoertzel *psGoertzel, const int16_t *pi16In,
+               uint32_t ui32Count)
+{
+    float fS0, fS1, fS2, fCoeff;
+
+    ASSERT(psGoertzel);
+
+    fCoeff = psGoertzel->fCoeff;
+    fS1 = psGoertzel->fS1;
+    fS2 = psGoertzel->fS2;
+
+    while(ui32Count--)
+    {
+        fS0 = ((float)*pi16In++ * (1.0f / 32768.0f)) + (fCoeff * fS1) - fS2;
+        fS2 = fS1;
+        fS1 = fS0;
+    }
+
+    psGoertzel->fS1 = fS1;
+    psGoertzel->fS2 = fS2;
+}
+
+//*****************************************************************************
+//
+//! Returns the power detected by a Goertzel detector and restarts it.
+//!
+//! \param psGoertzel is a pointer to the detector state.
+//!
+//! For N samples of a full-scale sine wave at the detector frequency, the
+//! power is approximately (N / 2) squared.
+//!
+//! \return Returns the squared magnitude of the frequency component.
+//
+//*****************************************************************************
+float
+DSPGoertzelPowerGet(tDSPGoertzel *psGoertzel)
+{
+    float fPower;
+
+    ASSERT(psGoertzel);
+
+    fPower = (psGoertzel->fS1 * psGoertzel->fS1) +
+             (psGoertzel->fS2 * psGoertzel->fS2) -
+             (psGoertzel->fCoeff * psGoertzel->fS1 * psGoertzel->fS2);
+
+    psGoertzel->fS1 = 0.0f;
+    psGoertzel->fS2 = 0.0f;
+
+    return(fPower);
+}
+
+//*****************************************************************************
+//
+//! Computes the twiddle factors for a Q15 FFT.
+//!
+//! \param pi16Twiddle is a pointer to a buffer of 2^\e ui32Log2Size values
+//! (2^(\e ui32Log2Size - 1) complex values).
+//! \param ui32Log2Size is the base 2 logarithm of the FFT size.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPFFTQ15TwiddleInit(int16_t *pi16Twiddle, uint32_t ui32Log2Size)
+{
+    uint32_t ui32Idx, ui32Angle;
+
+    ASSERT(pi16Twiddle);
+    ASSERT((ui32Log2Size > 0) && (ui32Log2Size < 16));
+
+    //
+    // Twiddle k is exp(-j * 2 * pi * k / N), converted from 16.16 to Q15.
+    //
+    for(ui32Idx = 0; ui32Idx < (1 << (ui32Log2Size - 1)); ui32Idx++)
+    {
+        ui32Angle = ui32Idx << (32 - ui32Log2Size);
+        pi16Twiddle[ui32Idx * 2] = Q15Sat(cosine(ui32Angle) / 2);
+        pi16Twiddle[(ui32Idx * 2) + 1] = Q15Sat(-sine(ui32Angle) / 2);
+    }
+}
+
+//*****************************************************************************
+//
+//! Computes an in-place complex FFT of Q15 data.
+//!
+//! \param pi16Data is a pointer to 2^\e ui32Log2Size complex values, stored
+//! as interleaved real and imaginary parts; it must be word aligned.
+//! \param pi16Twiddle is a pointer to the twiddle factors computed by
+//! DSPFFTQ15TwiddleInit() for the same size.
+//! \param ui32Log2Size is the base 2 logarithm of the FFT size.
+//!
+//! This function computes a radix-2 decimation in time FFT.  Each stage
+//! halves its results, using the SHADD16 and SHSUB16 instructions to form both
+//! halves of each butterfly at once, so the output is the FFT divided by the
+//! FFT size and cannot overflow.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DSPFFTQ15(int16_t *pi16Data, const int16_t *pi16Twiddle,
+          uint32_t ui32Log2Size)
+{
+    uint32_t *pui32Data, ui32Size, ui32Idx, ui32Rev, ui32Bit;
+    uint32_t ui32Len, ui32Half, ui32Step, ui32Group, ui32Pair;
+    uint32_t ui32A, ui32B, ui32T, ui32W;
+
+    ASSERT(pi16Data);
+    ASSERT(pi16Twiddle);
+    ASSERT(((uint32_t)pi16Data & 3) == 0);
+
+    pui32Data = (uint32_t *)pi16Data;
+    ui32Size = 1 << ui32Log2Size;
+
+    //
+    // Put the input into bit-reversed order.
+    //
+    ui32Rev = 0;
+    for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+    {
+        if(ui32Idx < ui32Rev)
+        {
+            ui32T = pui32Data[ui32Idx];
+            pui32Data[ui32Idx] = pui32Data[ui32Rev];
+            pui32Data[ui32Rev] = ui32T;
+        }
+
+        ui32Bit = ui32Size >> 1;
+        while(ui32Rev & ui32Bit)
+        {
+            ui32Rev ^= ui32Bit;
+            ui32Bit >>= 1;
+        }
+        ui32Rev |= ui32Bit;
+    }
+
+    //
+    // Combine pairs of transforms of increasing size.
+    //
+    for(ui32Len = 2; ui32Len <= ui32Size; ui32Len <<= 1)
+    {
+        ui32Half = ui32Len >> 1;
+        ui32Step = ui32Size / ui32Len;
+
+        for(ui32Group = 0; ui32Group < ui32Size; ui32Group += ui32Len)
+        {
+            for(ui32Pair = 0; ui32Pair < ui32Half; ui32Pair++)
+            {
+                ui32W = PAIR(pi16Twiddle + (ui32Pair * ui32Step * 2));
+                ui32A = pui32Data[ui32Group + ui32Pair];
+                ui32B = pui32Data[ui32Group + ui32Pair + ui32Half];
+
+                //
+                // Multiply the second input by the twiddle factor.
+                //
+                ui32T = (((uint32_t)Q15Sat(SMUSD(ui32B, ui32W) >> 15) &
+                          0xffff) |
+                         ((uint32_t)Q15Sat(SMUADX(ui32B, ui32W) >> 15) << 16));
+
+                pui32Data[ui32Group + ui32Pair] = SHADD16(ui32A, ui32T);
+                pui32Data[ui32Group + ui32Pair + ui32Half] =
+                    SHSUB16(ui32A, ui32T);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,186 @@
+//*****************************************************************************
+//
+// dsplib.h - Prototypes for the block-based signal processing functions.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __DSPLIB_H__
+#define __DSPLIB_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup dsplib_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! This structure contains the state of a Q15 FIR filter or decimator.  The
+//! members are set by DSPFIRQ15Init() or DSPDecimateQ15Init() and should not
+//! be accessed or modified by the application.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The filter coefficients, in time-reversed order.
+    //
+    const int16_t *pi16Coeffs;
+
+    //
+    //! The state buffer, which holds ui16NumTaps - 1 + ui16BlockSize
+    //! samples.
+    //
+    int16_t *pi16State;
+
+    //
+    //! The number of filter taps.
+    //
+    uint16_t ui16NumTaps;
+
+    //
+    //! The largest number of input samples processed in one pass.
+    //
+    uint16_t ui16BlockSize;
+
+    //
+    //! The decimation factor, which is 1 for a plain FIR filter.
+    //
+    uint16_t ui16Factor;
+
+    //
+    //! The number of input samples until the next output sample.
+    //
+    uint16_t ui16Phase;
+}
+tDSPFIRQ15;
+
+//*****************************************************************************
+//
+//! This structure contains the state of a cascade of floating-point biquad
+//! filter stages.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The number of second order stages.
+    //
+    uint32_t ui32NumStages;
+
+    //
+    //! The coefficients of each stage, in the order b0, b1, b2, a1, a2.  The
+    //! feedback coefficients are those of the denominator
+    //! 1 + a1 z^-1 + a2 z^-2.
+    //
+    const float *pfCoeffs;
+
+    //
+    //! The state of each stage, two values per stage.
+    //
+    float *pfState;
+}
+tDSPBiquadF32;
+
+//*****************************************************************************
+//
+//! This structure contains the state of a Goertzel single-frequency detector.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The recurrence coefficient, 2 * cos(2 * pi * f / fs).
+    //
+    float fCoeff;
+
+    //
+    //! The two most recent values of the recurrence.
+    //
+    float fS1;
+    float fS2;
+}
+tDSPGoertzel;
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void DSPADCToQ15(const uint16_t *pui16In, int16_t *pi16Out,
+                        uint32_t ui32Count);
+extern void DSPQ15ToF32(const int16_t *pi16In, float *pfOut,
+                        uint32_t ui32Count);
+extern void DSPAddQ15(const int16_t *pi16InA, const int16_t *pi16InB,
+                      int16_t *pi16Out, uint32_t ui32Count);
+extern void DSPFIRQ15Init(tDSPFIRQ15 *psFIR, const int16_t *pi16Coeffs,
+                          uint16_t ui16NumTaps, int16_t *pi16State,
+                          uint16_t ui16BlockSize);
+extern void DSPFIRQ15(tDSPFIRQ15 *psFIR, const int16_t *pi16In,
+                      int16_t *pi16Out, uint32_t ui32Count);
+extern void DSPDecimateQ15Init(tDSPFIRQ15 *psFIR, const int16_t *pi16Coeffs,
+                               uint16_t ui16NumTaps, uint16_t ui16Factor,
+                               int16_t *pi16State, uint16_t ui16BlockSize);
+extern uint32_t DSPDecimateQ15(tDSPFIRQ15 *psFIR, const int16_t *pi16In,
+                               int16_t *pi16Out, uint32_t ui32Count);
+extern void DSPBiquadF32Init(tDSPBiquadF32 *psBiquad, uint32_t ui32NumStages,
+                             const float *pfCoeffs, float *pfState);
+extern void DSPBiquadF32(tDSPBiquadF32 *psBiquad, const float *pfIn,
+                         float *pfOut, uint32_t ui32Count);
+extern int16_t DSPRMSQ15(const int16_t *pi16In, uint32_t ui32Count);
+extern void DSPGoertzelInit(tDSPGoertzel *psGoertzel, uint32_t ui32Frequency,
+                            uint32_t ui32SampleRate);
+extern void DSPGoertzelQ15(tDSPGoertzel *psGoertzel, const int16_t *pi16In,
+                           uint32_t ui32Count);
+extern float DSPGoertzelPowerGet(tDSPGoertzel *psGoertzel);
+extern void DSPFFTQ15TwiddleInit(int16_t *pi16Twiddle, uint32_t ui32Log2Size);
+extern void DSPFFTQ15(int16_t *pi16Data, const int16_t *pi16Twiddle,
+                      uint32_t ui32Log2Size);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DSPLIB_H__
@@ -0,0 +1,298 @@
+//*****************************************************************************
+//
+// eepromqueue.c - Non-blocking, interrupt-driven EEPROM writer.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_eeprom.h"
+#include "inc/hw_flash.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/eeprom.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "utils/eepromqueue.h"
+
+//*****************************************************************************
+//
+//! \addtogroup eepromqueue_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The EEPROM status flags that cause a write to fail.
+//
+//*****************************************************************************
+#define WRITE_ERRORS            (EEPROM_EEDONE_NOPERM | EEPROM_EEDONE_WRBUSY)
+
+//*****************************************************************************
+//
+// The write in progress, which is the head of the queue, and the last write
+// in the queue.
+//
+//*****************************************************************************
+static tEEPROMQueueWrite * volatile g_psEEPROMQueueHead;
+static tEEPROMQueueWrite *g_psEEPROMQueueTail;
+
+//*****************************************************************************
+//
+// Indicates that a word is being programmed.
+//
+//*****************************************************************************
+static volatile bool g_bEEPROMQueueActive;
+
+//*****************************************************************************
+//
+// Programs the next word of the queue that differs from the contents of the
+// EEPROM, completing each write that has no more words to program.  This is
+// called with the EEPROM idle and with interrupts disabled or from the
+// interrupt handler.
+//
+//*****************************************************************************
+static void
+EEPROMQueueNext(void)
+{
+    tEEPROMQueueWrite *psWrite;
+    uint32_t ui32Word, ui32Status;
+
+    //
+    // Mark the EEPROM as active while the queue is worked through so that a
+    // write queued by a callback is started here rather than by the submit.
+    //
+    g_bEEPROMQueueActive = true;
+
+    while((psWrite = g_psEEPROMQueueHead) != 0)
+    {
+        //
+        // Skip the words that already hold the new value.
+        //
+        ui32Status = 0;
+        while(psWrite->ui32Pos < psWrite->ui32Count)
+        {
+            MAP_EEPROMRead(&ui32Word, psWrite->ui32Address + psWrite->ui32Pos,
+                           4);
+            if(ui32Word != psWrite->pui32Data[psWrite->ui32Pos / 4])
+            {
+                break;
+            }
+            psWrite->ui32Pos += 4;
+        }
+
+        //
+        // Start programming the word, if there is one; its completion is
+        // signaled by the EEPROM interrupt.
+        //
+        if(psWrite->ui32Pos < psWrite->ui32Count)
+        {
+            ui32Status = MAP_EEPROMProgramNonBlocking(
+                             psWrite->pui32Data[psWrite->ui32Pos / 4],
+                             psWrite->ui32Address + psWrite->ui32Pos);
+            ui32Status &= WRITE_ERRORS;
+            if(!ui32Status)
+            {
+                return;
+            }
+        }
+
+        //
+        // The write is complete, or has failed, so remove it from the queue.
+        //
+        g_psEEPROMQueueHead = psWrite->psNext;
+        psWrite->ui32Status = ui32Status;
+        if(psWrite->pfnCallback)
+        {
+            psWrite->pfnCallback(psWrite->pvCBData, ui32Status);
+        }
+    }
+
+    g_bEEPROMQueueActive = false;
+}
+
+//*****************************************************************************
+//
+//! Initializes the non-blocking EEPROM writer.
+//!
+//! This function enables the EEPROM done interrupt, which is signaled through
+//! the flash controller.  The application must have initialized the EEPROM
+//! with EEPROMInit() and must enable the flash interrupt in the interrupt
+//! controller, calling EEPROMQueueIntHandler() from its handler.  If the
+//! flash interrupt is also used by the background flash service, the handler
+//! calls both FlashQueueIntHandler() and EEPROMQueueIntHandler().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+EEPROMQueueInit(void)
+{
+    g_psEEPROMQueueHead = 0;
+    g_psEEPROMQueueTail = 0;
+    g_bEEPROMQueueActive = false;
+
+    MAP_EEPROMIntClear(EEPROM_INT_PROGRAM);
+    MAP_EEPROMIntEnable(EEPROM_INT_PROGRAM);
+}
+
+//*****************************************************************************
+//
+//! Queues a multi-word write to the EEPROM.
+//!
+//! \param psWrite is a pointer to the write structure.
+//! \param pui32Data is a pointer to the data to write.  The data must not be
+//! modified until the write completes.
+//! \param ui32Address is the EEPROM address of the first word to write.
+//! \param ui32Count is the number of bytes to write; it must be a multiple of
+//! four.
+//! \param pfnCallback is the function called when the write completes, or
+//! NULL.
+//! \param pvCBData is the data pointer passed to \e pfnCallback.
+//!
+//! This function returns immediately.  The words are programmed one at a
+//! time from the EEPROM interrupt, and words that already hold the new value
+//! are not programmed at all, saving both time and EEPROM wear.  The status
+//! of the write is \b EEPROM_QUEUE_PENDING until it completes.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+EEPROMQueueWrite(tEEPROMQueueWrite *psWrite, const uint32_t *pui32Data,
+                 uint32_t ui32Address, uint32_t ui32Count,
+                 tEEPROMQueueCallback pfnCallback, void *pvCBData)
+{
+    bool bIntsOff;
+
+    ASSERT(psWrite);
+    ASSERT(pui32Data || !ui32Count);
+    ASSERT(!(ui32Address & 3));
+    ASSERT(!(ui32Count & 3));
+
+    psWrite->psNext = 0;
+    psWrite->pui32Data = pui32Data;
+    psWrite->ui32Address = ui32Address;
+    psWrite->ui32Count = ui32Count;
+    psWrite->ui32Pos = 0;
+    psWrite->ui32Programmed = 0;
+    psWrite->pfnCallback = pfnCallback;
+    psWrite->pvCBData = pvCBData;
+    psWrite->ui32Status = EEPROM_QUEUE_PENDING;
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    if(g_psEEPROMQueueHead)
+    {
+        g_psEEPROMQueueTail->psNext = psWrite;
+        g_psEEPROMQueueTail = psWrite;
+    }
+    else
+    {
+        g_psEEPROMQueueHead = psWrite;
+        g_psEEPROMQueueTail = psWrite;
+    }
+
+    if(!g_bEEPROMQueueActive)
+    {
+        EEPROMQueueNext();
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Determines whether any EEPROM writes are queued.
+//!
+//! \return Returns \b true if a write is in progress or queued and \b false
+//! otherwise.
+//
+//*****************************************************************************
+bool
+EEPROMQueueBusy(void)
+{
+    return(g_psEEPROMQueueHead != 0);
+}
+
+//*****************************************************************************
+//
+//! Handles the EEPROM done interrupt.
+//!
+//! This function must be called from the flash interrupt handler.  It
+//! ignores the interrupt if the EEPROM done interrupt is not pending.
+//! Otherwise, it completes the word that was being programmed and starts
+//! programming the next one.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+EEPROMQueueIntHandler(void)
+{
+    tEEPROMQueueWrite *psWrite;
+    uint32_t ui32Status;
+
+    if(!MAP_EEPROMIntStatus(true))
+    {
+        return;
+    }
+    MAP_EEPROMIntClear(EEPROM_INT_PROGRAM);
+
+    psWrite = g_psEEPROMQueueHead;
+    if(!g_bEEPROMQueueActive || !psWrite)
+    {
+        return;
+    }
+
+    //
+    // Fail the write if the word could not be programmed.
+    //
+    ui32Status = HWREG(EEPROM_EEDONE) & WRITE_ERRORS;
+    if(ui32Status)
+    {
+        g_psEEPROMQueueHead = psWrite->psNext;
+        psWrite->ui32Status = ui32Status;
+        if(psWrite->pfnCallback)
+        {
+            psWrite->pfnCallback(psWrite->pvCBData, ui32Status);
+        }
+    }
+    else
+    {
+        psWrite->ui32Pos += 4;
+        psWrite->ui32Programmed++;
+    }
+
+    EEPROMQueueNext();
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
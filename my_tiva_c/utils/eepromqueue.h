@@ -0,0 +1,143 @@
+//*****************************************************************************
+//
+// eepromqueue.h - Prototypes for the non-blocking EEPROM writer.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __EEPROMQUEUE_H__
+#define __EEPROMQUEUE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup eepromqueue_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The status of a write that has been queued but has not completed.  Once
+//! complete, the status is 0 on success or the \b EEPROM_RC_NOPERM and
+//! \b EEPROM_RC_WRBUSY flags that caused it to fail, as returned by
+//! EEPROMProgram().
+//
+//*****************************************************************************
+#define EEPROM_QUEUE_PENDING    0x80000000
+
+//*****************************************************************************
+//
+//! The prototype for the function that is called when a write completes.  It
+//! is called from the EEPROM interrupt handler, or from EEPROMQueueWrite() if
+//! no word needed to be programmed, with the callback data of the write and
+//! its final status.
+//
+//*****************************************************************************
+typedef void (*tEEPROMQueueCallback)(void *pvCBData, uint32_t ui32Status);
+
+//*****************************************************************************
+//
+//! This structure describes a single multi-word write.  The structure, and
+//! the data to be written, are owned by the writer from the time that the
+//! write is queued until it completes.
+//
+//*****************************************************************************
+typedef struct tEEPROMQueueWrite
+{
+    //
+    //! The next write in the queue.
+    //
+    struct tEEPROMQueueWrite *psNext;
+
+    //
+    //! The data to write, the EEPROM address of the first word, and the
+    //! number of bytes to write, which must be a multiple of four.
+    //
+    const uint32_t *pui32Data;
+    uint32_t ui32Address;
+    uint32_t ui32Count;
+
+    //
+    //! The number of bytes that have been processed.
+    //
+    uint32_t ui32Pos;
+
+    //
+    //! The number of words that were programmed; words that already held
+    //! the new value are skipped and are not counted.
+    //
+    uint32_t ui32Programmed;
+
+    //
+    //! The function called when the write completes, or NULL, and the data
+    //! pointer passed to it.
+    //
+    tEEPROMQueueCallback pfnCallback;
+    void *pvCBData;
+
+    //
+    //! The status of the write.
+    //
+    volatile uint32_t ui32Status;
+}
+tEEPROMQueueWrite;
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void EEPROMQueueInit(void);
+extern void EEPROMQueueWrite(tEEPROMQueueWrite *psWrite,
+                             const uint32_t *pui32Data, uint32_t ui32Address,
+                             uint32_t ui32Count,
+                             tEEPROMQueueCallback pfnCallback,
+                             void *pvCBData);
+extern bool EEPROMQueueBusy(void);
+extern void EEPROMQueueIntHandler(void);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __EEPROMQUEUE_H__
@@ -0,0 +1,409 @@
+//*****************************************************************************
+//
+// flashqueue.c - Background flash erase/program service.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_flash.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/flash.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "utils/flashqueue.h"
+
+//*****************************************************************************
+//
+//! \addtogroup flashqueue_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The instruction fetches of the processor stall while the flash is being
+// erased or programmed.  The functions that run while an operation is in
+// progress, or that start the next one, are therefore placed in SRAM with
+// the compilers that support it; with other compilers they run from flash
+// and simply stall until the operation completes.  With the GNU compilers
+// the functions are placed in the .ramfunc section, which the linker script
+// must place in the .data output section so that it is copied to SRAM at
+// startup.
+//
+//*****************************************************************************
+#if defined(ewarm)
+#define RAMFUNC                 __ramfunc
+#elif defined(codered) || defined(gcc) || defined(sourcerygxx)
+#define RAMFUNC                 __attribute__((section(".ramfunc"),          \
+                                               long_call, noinline))
+#else
+#define RAMFUNC
+#endif
+
+//*****************************************************************************
+//
+// The flash controller errors that cause an erase or a program operation to
+// fail.
+//
+//*****************************************************************************
+#define ERASE_ERRORS            (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS |     \
+                                 FLASH_FCRIS_ERRIS)
+#define PROGRAM_ERRORS          (FLASH_FCRIS_ARIS | FLASH_FCRIS_VOLTRIS |     \
+                                 FLASH_FCRIS_INVDRIS | FLASH_FCRIS_PROGRIS)
+
+//*****************************************************************************
+//
+// The size of the block erased by one erase operation.
+//
+//*****************************************************************************
+#define ERASE_SIZE              (CLASS_IS_TM4C129 ? 0x4000 : FLASH_ERASE_SIZE)
+
+//*****************************************************************************
+//
+// The operation in progress, which is the head of the queue, and the last
+// operation in the queue.
+//
+//*****************************************************************************
+static tFlashQueueOp * volatile g_psFlashQueueHead;
+static tFlashQueueOp *g_psFlashQueueTail;
+
+//*****************************************************************************
+//
+// The number of bytes of the program operation in progress that have been
+// written to the flash write buffer.
+//
+//*****************************************************************************
+static uint32_t g_ui32FlashQueuePos;
+
+//*****************************************************************************
+//
+// Indicates that the flash controller is executing an operation.
+//
+//*****************************************************************************
+static volatile bool g_bFlashQueueActive;
+
+//*****************************************************************************
+//
+// Loads the next part of a program operation, up to the end of a 32-word
+// block of flash, into the write buffer and starts programming it.
+//
+//*****************************************************************************
+static RAMFUNC void
+FlashQueueBufferWrite(tFlashQueueOp *psOp)
+{
+    uint32_t ui32Address;
+    const uint32_t *pui32Data;
+
+    ui32Address = psOp->ui32Address + g_ui32FlashQueuePos;
+    pui32Data = psOp->pui32Data + (g_ui32FlashQueuePos / 4);
+
+    HWREG(FLASH_FMA) = ui32Address & ~(0x7f);
+
+    do
+    {
+        HWREG(FLASH_FWBN + (ui32Address & 0x7c)) = *pui32Data++;
+        ui32Address += 4;
+        g_ui32FlashQueuePos += 4;
+    }
+    while((g_ui32FlashQueuePos < psOp->ui32Count) && (ui32Address & 0x7c));
+
+    HWREG(FLASH_FMC2) = FLASH_FMC2_WRKEY | FLASH_FMC2_WRBUF;
+}
+
+//*****************************************************************************
+//
+// Starts the operation at the head of the queue.
+//
+//*****************************************************************************
+static RAMFUNC void
+FlashQueueStart(void)
+{
+    tFlashQueueOp *psOp;
+
+    psOp = g_psFlashQueueHead;
+    g_bFlashQueueActive = true;
+
+    if(psOp->ui32Type == FLASH_QUEUE_ERASE)
+    {
+        HWREG(FLASH_FCMISC) = (FLASH_FCMISC_AMISC | FLASH_FCMISC_VOLTMISC |
+                               FLASH_FCMISC_ERMISC);
+        HWREG(FLASH_FMA) = psOp->ui32Address;
+        HWREG(FLASH_FMC) = FLASH_FMC_WRKEY | FLASH_FMC_ERASE;
+    }
+    else
+    {
+        HWREG(FLASH_FCMISC) = (FLASH_FCMISC_AMISC | FLASH_FCMISC_VOLTMISC |
+                               FLASH_FCMISC_INVDMISC | FLASH_FCMISC_PROGMISC);
+        g_ui32FlashQueuePos = 0;
+        FlashQueueBufferWrite(psOp);
+    }
+}
+
+//*****************************************************************************
+//
+// Adds an operation to the queue, starting it if the flash controller is
+// idle.
+//
+//*****************************************************************************
+static void
+FlashQueueSubmit(tFlashQueueOp *psOp)
+{
+    bool bIntsOff;
+
+    psOp->psNext = 0;
+    psOp->i32Status = FLASH_QUEUE_PENDING;
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    if(g_psFlashQueueHead)
+    {
+        g_psFlashQueueTail->psNext = psOp;
+        g_psFlashQueueTail = psOp;
+    }
+    else
+    {
+        g_psFlashQueueHead = psOp;
+        g_psFlashQueueTail = psOp;
+    }
+
+    if(!g_bFlashQueueActive)
+    {
+        FlashQueueStart();
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Initializes the background flash service.
+//!
+//! This function enables the flash controller interrupt that signals the end
+//! of each erase and program cycle.  The application must enable the flash
+//! interrupt in the interrupt controller, with FlashQueueIntHandler() as its
+//! handler.
+//!
+//! Operations are carried out one erase, or one 32-word write buffer, at a
+//! time with no processor time spent waiting for them.  The processor stalls
+//! on any instruction fetch or data read from flash while the flash is busy,
+//! so only code and data in SRAM, such as a control loop interrupt handler
+//! placed in SRAM, keep running during an operation.  With the GCC-based and
+//! IAR compilers, the functions of this service that run between operations
+//! are themselves placed in SRAM.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+FlashQueueInit(void)
+{
+    g_psFlashQueueHead = 0;
+    g_psFlashQueueTail = 0;
+    g_bFlashQueueActive = false;
+
+    MAP_FlashIntClear(FLASH_INT_PROGRAM);
+    MAP_FlashIntEnable(FLASH_INT_PROGRAM);
+}
+
+//*****************************************************************************
+//
+//! Queues the erase of a block of flash.
+//!
+//! \param psOp is a pointer to the operation structure.
+//! \param ui32Address is the start address of the block; it must be a
+//! multiple of the erase block size (1 KB on TM4C123 devices and 16 KB on
+//! TM4C129 devices).
+//! \param pfnCallback is the function called when the erase completes, or
+//! NULL.
+//! \param pvCBData is the data pointer passed to \e pfnCallback.
+//!
+//! This function returns immediately.  The status of the operation is
+//! \b FLASH_QUEUE_PENDING until it completes.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+FlashQueueErase(tFlashQueueOp *psOp, uint32_t ui32Address,
+                tFlashQueueCallback pfnCallback, void *pvCBData)
+{
+    ASSERT(psOp);
+    ASSERT(!(ui32Address & (ERASE_SIZE - 1)));
+
+    psOp->ui32Type = FLASH_QUEUE_ERASE;
+    psOp->ui32Address = ui32Address;
+    psOp->pui32Data = 0;
+    psOp->ui32Count = 0;
+    psOp->pfnCallback = pfnCallback;
+    psOp->pvCBData = pvCBData;
+
+    FlashQueueSubmit(psOp);
+}
+
+//*****************************************************************************
+//
+//! Queues the programming of words of flash.
+//!
+//! \param psOp is a pointer to the operation structure.
+//! \param pui32Data is a pointer to the data to program.  The data must not
+//! be modified until the operation completes.
+//! \param ui32Address is the address of the first word to program.
+//! \param ui32Count is the number of bytes to program; it must be a non-zero
+//! multiple of four.
+//! \param pfnCallback is the function called when the programming completes,
+//! or NULL.
+//! \param pvCBData is the data pointer passed to \e pfnCallback.
+//!
+//! This function returns immediately.  The status of the operation is
+//! \b FLASH_QUEUE_PENDING until it completes.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+FlashQueueProgram(tFlashQueueOp *psOp, const uint32_t *pui32Data,
+                  uint32_t ui32Address, uint32_t ui32Count,
+                  tFlashQueueCallback pfnCallback, void *pvCBData)
+{
+    ASSERT(psOp);
+    ASSERT(pui32Data);
+    ASSERT(!(ui32Address & 3));
+    ASSERT(ui32Count && !(ui32Count & 3));
+
+    psOp->ui32Type = FLASH_QUEUE_PROGRAM;
+    psOp->ui32Address = ui32Address;
+    psOp->pui32Data = pui32Data;
+    psOp->ui32Count = ui32Count;
+    psOp->pfnCallback = pfnCallback;
+    psOp->pvCBData = pvCBData;
+
+    FlashQueueSubmit(psOp);
+}
+
+//*****************************************************************************
+//
+//! Determines whether any flash operations are queued.
+//!
+//! \return Returns \b true if an operation is in progress or queued and
+//! \b false otherwise.
+//
+//*****************************************************************************
+bool
+FlashQueueBusy(void)
+{
+    return(g_psFlashQueueHead != 0);
+}
+
+//*****************************************************************************
+//
+//! Handles the flash controller interrupt.
+//!
+//! This function must be called from the flash interrupt handler, or be the
+//! handler itself if the EEPROM interrupt is not used.  It continues a
+//! program operation with the next write buffer, or completes the operation
+//! in progress and starts the next one.
+//!
+//! The callback of an operation is called before the next operation is
+//! started, while the flash can still be read, since the callback is
+//! normally in flash.
+//!
+//! \return None.
+//
+//*****************************************************************************
+RAMFUNC void
+FlashQueueIntHandler(void)
+{
+    tFlashQueueOp *psOp;
+    uint32_t ui32Status;
+    int32_t i32Status;
+
+    //
+    // Clear the flash interrupts, leaving the EEPROM interrupt, which shares
+    // the flash interrupt, for its own handler.
+    //
+    ui32Status = HWREG(FLASH_FCMISC) & ~FLASH_FCMISC_EMISC;
+    HWREG(FLASH_FCMISC) = ui32Status;
+
+    psOp = g_psFlashQueueHead;
+    if(!(ui32Status & FLASH_FCMISC_PMISC) || !g_bFlashQueueActive)
+    {
+        return;
+    }
+
+    //
+    // Program the rest of the data, a write buffer at a time.
+    //
+    if(psOp->ui32Type == FLASH_QUEUE_PROGRAM)
+    {
+        if(HWREG(FLASH_FCRIS) & PROGRAM_ERRORS)
+        {
+            i32Status = -1;
+        }
+        else if(g_ui32FlashQueuePos < psOp->ui32Count)
+        {
+            FlashQueueBufferWrite(psOp);
+            return;
+        }
+        else
+        {
+            i32Status = 0;
+        }
+    }
+    else
+    {
+        i32Status = (HWREG(FLASH_FCRIS) & ERASE_ERRORS) ? -1 : 0;
+    }
+
+    //
+    // Complete the operation.  The callback may queue another operation,
+    // which is started here rather than by the submit since the flash
+    // controller is still marked as active.
+    //
+    g_psFlashQueueHead = psOp->psNext;
+    psOp->i32Status = i32Status;
+    if(psOp->pfnCallback)
+    {
+        psOp->pfnCallback(psOp->pvCBData, i32Status);
+    }
+
+    if(g_psFlashQueueHead)
+    {
+        FlashQueueStart();
+    }
+    else
+    {
+        g_bFlashQueueActive = false;
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,155 @@
+//*****************************************************************************
+//
+// flashqueue.h - Prototypes for the background flash erase/program service.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __FLASHQUEUE_H__
+#define __FLASHQUEUE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup flashqueue_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The operation erases a block of flash.
+//
+//*****************************************************************************
+#define FLASH_QUEUE_ERASE       0
+
+//*****************************************************************************
+//
+//! The operation programs words of flash.
+//
+//*****************************************************************************
+#define FLASH_QUEUE_PROGRAM     1
+
+//*****************************************************************************
+//
+//! The status of an operation that has been queued but has not completed.
+//! Once complete, the status is 0 on success or -1 on failure, as returned by
+//! FlashErase() and FlashProgram().
+//
+//*****************************************************************************
+#define FLASH_QUEUE_PENDING     1
+
+//*****************************************************************************
+//
+//! The prototype for the function that is called when an operation
+//! completes.  It is called from the flash interrupt handler with the
+//! callback data of the operation and its final status.
+//
+//*****************************************************************************
+typedef void (*tFlashQueueCallback)(void *pvCBData, int32_t i32Status);
+
+//*****************************************************************************
+//
+//! This structure describes a single erase or program operation.  The
+//! structure, and the data to be programmed, are owned by the service from
+//! the time that the operation is queued until it completes.
+//
+//*****************************************************************************
+typedef struct tFlashQueueOp
+{
+    //
+    //! The next operation in the queue.
+    //
+    struct tFlashQueueOp *psNext;
+
+    //
+    //! The type of operation, either \b FLASH_QUEUE_ERASE or
+    //! \b FLASH_QUEUE_PROGRAM.
+    //
+    uint32_t ui32Type;
+
+    //
+    //! The address of the block to erase or of the first word to program.
+    //
+    uint32_t ui32Address;
+
+    //
+    //! The data to program and the number of bytes to program, which must be
+    //! a multiple of four.
+    //
+    const uint32_t *pui32Data;
+    uint32_t ui32Count;
+
+    //
+    //! The function called when the operation completes, or NULL, and the
+    //! data pointer passed to it.
+    //
+    tFlashQueueCallback pfnCallback;
+    void *pvCBData;
+
+    //
+    //! The status of the operation.
+    //
+    volatile int32_t i32Status;
+}
+tFlashQueueOp;
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void FlashQueueInit(void);
+extern void FlashQueueErase(tFlashQueueOp *psOp, uint32_t ui32Address,
+                            tFlashQueueCallback pfnCallback, void *pvCBData);
+extern void FlashQueueProgram(tFlashQueueOp *psOp, const uint32_t *pui32Data,
+                              uint32_t ui32Address, uint32_t ui32Count,
+                              tFlashQueueCallback pfnCallback,
+                              void *pvCBData);
+extern bool FlashQueueBusy(void);
+extern void FlashQueueIntHandler(void);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FLASHQUEUE_H__
@@ -0,0 +1,722 @@
+//*****************************************************************************
+//
+// i2cqueue.c - Queued, interrupt-driven I2C master transaction engine.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_i2c.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/i2c.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/udma.h"
+#include "utils/i2cqueue.h"
+
+//*****************************************************************************
+//
+//! \addtogroup i2cqueue_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The phases of a transaction.
+//
+//*****************************************************************************
+#define STATE_IDLE              0
+#define STATE_WRITE             1
+#define STATE_READ              2
+
+//*****************************************************************************
+//
+// The largest number of bytes that can be transferred in one burst.
+//
+//*****************************************************************************
+#define MAX_BURST               255
+
+//*****************************************************************************
+//
+// Moves as many bytes of the write phase into the transmit FIFO as will fit,
+// and stops the FIFO request interrupt once all of them have been queued.
+//
+//*****************************************************************************
+static void
+I2CQueueTxFIFOFill(tI2CQueue *psQueue)
+{
+    tI2CQueueTransaction *psTransaction;
+
+    psTransaction = psQueue->psHead;
+
+    while((psQueue->ui16FIFOPos < psTransaction->ui16WriteLen) &&
+          MAP_I2CFIFODataPutNonBlocking(psQueue->ui32Base,
+                                        psTransaction->pui8Write[
+                                            psQueue->ui16FIFOPos]))
+    {
+        psQueue->ui16FIFOPos++;
+    }
+
+    if(psQueue->ui16FIFOPos == psTransaction->ui16WriteLen)
+    {
+        MAP_I2CMasterIntDisableEx(psQueue->ui32Base,
+                                  I2C_MASTER_INT_TX_FIFO_REQ);
+    }
+}
+
+//*****************************************************************************
+//
+// Moves the received bytes from the receive FIFO into the read buffer.
+//
+//*****************************************************************************
+static void
+I2CQueueRxFIFODrain(tI2CQueue *psQueue)
+{
+    tI2CQueueTransaction *psTransaction;
+    uint8_t ui8Data;
+
+    psTransaction = psQueue->psHead;
+
+    while((psQueue->ui16FIFOPos < psTransaction->ui16ReadLen) &&
+          MAP_I2CFIFODataGetNonBlocking(psQueue->ui32Base, &ui8Data))
+    {
+        psTransaction->pui8Read[psQueue->ui16FIFOPos++] = ui8Data;
+    }
+}
+
+//*****************************************************************************
+//
+// Arms the uDMA channel of the current phase for the next burst.  The
+// transmit FIFO requests four bytes whenever it is half empty.  The receive
+// FIFO requests each byte as it arrives, since a request at a higher level
+// would never be raised for the last bytes of a burst.
+//
+//*****************************************************************************
+static void
+I2CQueueDMABurst(tI2CQueue *psQueue)
+{
+    tI2CQueueTransaction *psTransaction;
+
+    psTransaction = psQueue->psHead;
+
+    if(psQueue->ui8State == STATE_WRITE)
+    {
+        MAP_uDMAChannelControlSet(psQueue->ui32TxChannel | UDMA_PRI_SELECT,
+                                  (UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                                   UDMA_DST_INC_NONE | UDMA_ARB_4));
+        MAP_uDMAChannelTransferSet(psQueue->ui32TxChannel | UDMA_PRI_SELECT,
+                                   UDMA_MODE_BASIC,
+                                   (void *)(psTransaction->pui8Write +
+                                            psQueue->ui16Pos),
+                                   (void *)(psQueue->ui32Base +
+                                            I2C_O_FIFODATA),
+                                   psQueue->ui16Burst);
+        MAP_uDMAChannelEnable(psQueue->ui32TxChannel);
+    }
+    else
+    {
+        MAP_uDMAChannelControlSet(psQueue->ui32RxChannel | UDMA_PRI_SELECT,
+                                  (UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                                   UDMA_DST_INC_8 | UDMA_ARB_1));
+        MAP_uDMAChannelTransferSet(psQueue->ui32RxChannel | UDMA_PRI_SELECT,
+                                   UDMA_MODE_BASIC,
+                                   (void *)(psQueue->ui32Base +
+                                            I2C_O_FIFODATA),
+                                   (psTransaction->pui8Read +
+                                    psQueue->ui16Pos),
+                                   psQueue->ui16Burst);
+        MAP_uDMAChannelEnable(psQueue->ui32RxChannel);
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the next transfer of the current phase.  In FIFO mode this is a
+// burst of up to 255 bytes; otherwise it is a single byte.
+//
+//*****************************************************************************
+static void
+I2CQueueTransfer(tI2CQueue *psQueue, bool bStart)
+{
+    tI2CQueueTransaction *psTransaction;
+    uint32_t ui32Cmd, ui32Remaining;
+
+    psTransaction = psQueue->psHead;
+
+    if(psQueue->ui8State == STATE_WRITE)
+    {
+        ui32Remaining = psTransaction->ui16WriteLen - psQueue->ui16Pos;
+    }
+    else
+    {
+        ui32Remaining = psTransaction->ui16ReadLen - psQueue->ui16Pos;
+    }
+
+    if(psQueue->bFIFO)
+    {
+        psQueue->ui16Burst = ((ui32Remaining > MAX_BURST) ? MAX_BURST :
+                              ui32Remaining);
+        MAP_I2CMasterBurstLengthSet(psQueue->ui32Base, psQueue->ui16Burst);
+        ui32Cmd = I2C_MCS_BURST;
+
+        if(psQueue->bPhaseDMA)
+        {
+            psQueue->bDMAWait = false;
+            I2CQueueDMABurst(psQueue);
+        }
+    }
+    else
+    {
+        psQueue->ui16Burst = 1;
+        ui32Cmd = I2C_MCS_RUN;
+    }
+
+    if(bStart)
+    {
+        MAP_I2CMasterSlaveAddrSet(psQueue->ui32Base, psTransaction->ui8Address,
+                                  psQueue->ui8State == STATE_READ);
+        ui32Cmd |= I2C_MCS_START;
+    }
+
+    if(psQueue->ui8State == STATE_WRITE)
+    {
+        if(!psQueue->bFIFO)
+        {
+            MAP_I2CMasterDataPut(psQueue->ui32Base,
+                                 psTransaction->pui8Write[psQueue->ui16Pos]);
+        }
+
+        //
+        // The last write is followed by a stop unless there is a read phase,
+        // which starts with a repeated start instead.
+        //
+        if((psQueue->ui16Burst == ui32Remaining) &&
+           (psTransaction->ui16ReadLen == 0))
+        {
+            ui32Cmd |= I2C_MCS_STOP;
+        }
+    }
+    else
+    {
+        //
+        // Acknowledge each byte read except the last, which is followed by a
+        // stop.
+        //
+        if(psQueue->ui16Burst == ui32Remaining)
+        {
+            ui32Cmd |= I2C_MCS_STOP;
+        }
+        else
+        {
+            ui32Cmd |= I2C_MCS_ACK;
+        }
+    }
+
+    MAP_I2CMasterControl(psQueue->ui32Base, ui32Cmd);
+}
+
+//*****************************************************************************
+//
+// Starts the write or read phase of the current transaction.
+//
+//*****************************************************************************
+static void
+I2CQueuePhaseStart(tI2CQueue *psQueue, uint8_t ui8State)
+{
+    tI2CQueueTransaction *psTransaction;
+    uint32_t ui32Len;
+
+    psTransaction = psQueue->psHead;
+
+    psQueue->ui8State = ui8State;
+    psQueue->ui16Pos = 0;
+    psQueue->ui16FIFOPos = 0;
+
+    if(psQueue->bFIFO)
+    {
+        //
+        // Phases long enough to be worth setting up a uDMA channel for are
+        // moved by the uDMA controller, and others by the interrupt handler.
+        //
+        ui32Len = ((ui8State == STATE_WRITE) ? psTransaction->ui16WriteLen :
+                   psTransaction->ui16ReadLen);
+        psQueue->bPhaseDMA = (psQueue->bDMA &&
+                              (ui32Len >= I2C_QUEUE_DMA_MIN));
+
+        if(ui8State == STATE_WRITE)
+        {
+            MAP_I2CTxFIFOFlush(psQueue->ui32Base);
+            if(psQueue->bPhaseDMA)
+            {
+                MAP_I2CTxFIFOConfigSet(psQueue->ui32Base,
+                                       (I2C_FIFO_CFG_TX_MASTER_DMA |
+                                        I2C_FIFO_CFG_TX_TRIG_4));
+            }
+            else
+            {
+                //
+                // Prefill the transmit FIFO, and have it refilled from the
+                // interrupt handler as it drains if the data does not all
+                // fit.
+                //
+                MAP_I2CTxFIFOConfigSet(psQueue->ui32Base,
+                                       (I2C_FIFO_CFG_TX_MASTER |
+                                        I2C_FIFO_CFG_TX_TRIG_4));
+                MAP_I2CMasterIntEnableEx(psQueue->ui32Base,
+                                         I2C_MASTER_INT_TX_FIFO_REQ);
+                I2CQueueTxFIFOFill(psQueue);
+            }
+        }
+        else
+        {
+            MAP_I2CRxFIFOFlush(psQueue->ui32Base);
+            if(psQueue->bPhaseDMA)
+            {
+                MAP_I2CRxFIFOConfigSet(psQueue->ui32Base,
+                                       (I2C_FIFO_CFG_RX_MASTER_DMA |
+                                        I2C_FIFO_CFG_RX_TRIG_1));
+                MAP_I2CMasterIntEnableEx(psQueue->ui32Base,
+                                         I2C_MASTER_INT_RX_DMA_DONE);
+            }
+            else
+            {
+                MAP_I2CRxFIFOConfigSet(psQueue->ui32Base,
+                                       (I2C_FIFO_CFG_RX_MASTER |
+                                        I2C_FIFO_CFG_RX_TRIG_4));
+                MAP_I2CMasterIntEnableEx(psQueue->ui32Base,
+                                         I2C_MASTER_INT_RX_FIFO_REQ);
+            }
+        }
+    }
+
+    I2CQueueTransfer(psQueue, true);
+}
+
+//*****************************************************************************
+//
+// Starts the transaction at the head of the queue, if there is one.
+//
+//*****************************************************************************
+static void
+I2CQueueNext(tI2CQueue *psQueue)
+{
+    if(psQueue->psHead == 0)
+    {
+        psQueue->ui8State = STATE_IDLE;
+    }
+    else if(psQueue->psHead->ui16WriteLen)
+    {
+        I2CQueuePhaseStart(psQueue, STATE_WRITE);
+    }
+    else
+    {
+        I2CQueuePhaseStart(psQueue, STATE_READ);
+    }
+}
+
+//*****************************************************************************
+//
+// Completes the current transaction and starts the next one.
+//
+//*****************************************************************************
+static void
+I2CQueueComplete(tI2CQueue *psQueue, uint32_t ui32Status)
+{
+    tI2CQueueTransaction *psTransaction;
+
+    if(psQueue->bFIFO)
+    {
+        MAP_I2CMasterIntDisableEx(psQueue->ui32Base,
+                                  (I2C_MASTER_INT_TX_FIFO_REQ |
+                                   I2C_MASTER_INT_RX_FIFO_REQ |
+                                   I2C_MASTER_INT_RX_DMA_DONE));
+    }
+
+    //
+    // Stop the uDMA channels, which still hold the rest of the phase if it
+    // failed.
+    //
+    if(psQueue->bPhaseDMA)
+    {
+        MAP_uDMAChannelDisable(psQueue->ui32TxChannel);
+        MAP_uDMAChannelDisable(psQueue->ui32RxChannel);
+        psQueue->bPhaseDMA = false;
+    }
+
+    psQueue->ui32Transactions++;
+    if(ui32Status != I2C_MASTER_ERR_NONE)
+    {
+        psQueue->ui32Errors++;
+    }
+
+    //
+    // Remove the transaction from the queue and start the next one before
+    // calling back, so that the bus is kept busy while the callback runs.
+    //
+    psTransaction = psQueue->psHead;
+    psQueue->psHead = psTransaction->psNext;
+    I2CQueueNext(psQueue);
+
+    psTransaction->ui32Status = ui32Status;
+    if(psTransaction->pfnCallback)
+    {
+        psTransaction->pfnCallback(psTransaction->pvCBData, ui32Status);
+    }
+}
+
+//*****************************************************************************
+//
+//! Initializes a queued I2C master.
+//!
+//! \param psQueue is a pointer to the queue state.
+//! \param ui32Base is the base address of the I2C module.
+//! \param ui32TxMapping is the uDMA channel mapping for the transmit request
+//! of the I2C module, as passed to uDMAChannelAssign(), or
+//! \b I2C_QUEUE_NO_DMA.
+//! \param ui32RxMapping is the uDMA channel mapping for the receive request
+//! of the I2C module, or \b I2C_QUEUE_NO_DMA.
+//!
+//! This function prepares an I2C module, which must already have been
+//! initialized with I2CMasterInitExpClk(), for queued operation and enables
+//! its master interrupt.  The application must call I2CQueueIntHandler()
+//! from the interrupt handler of the I2C module.
+//!
+//! On TM4C129 devices, transfers are made in bursts through the I2C FIFOs,
+//! with an interrupt when a FIFO needs servicing and when a burst completes.
+//! If uDMA channels are given, phases of at least \b I2C_QUEUE_DMA_MIN
+//! bytes are moved between the FIFOs and memory by the uDMA controller
+//! instead, leaving one interrupt per burst.  The application must then
+//! enable the uDMA controller and set its control table.  On TM4C123
+//! devices, which do not have the FIFOs, an interrupt is taken for each byte
+//! and the uDMA channel mappings are ignored.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+I2CQueueInit(tI2CQueue *psQueue, uint32_t ui32Base, uint32_t ui32TxMapping,
+             uint32_t ui32RxMapping)
+{
+    ASSERT(psQueue);
+
+    psQueue->ui32Base = ui32Base;
+    psQueue->bFIFO = CLASS_IS_TM4C129;
+    psQueue->bDMA = (psQueue->bFIFO && (ui32TxMapping != I2C_QUEUE_NO_DMA) &&
+                     (ui32RxMapping != I2C_QUEUE_NO_DMA));
+    psQueue->bPhaseDMA = false;
+    psQueue->bDMAWait = false;
+    psQueue->psHead = 0;
+    psQueue->psTail = 0;
+    psQueue->ui8State = STATE_IDLE;
+    psQueue->ui32Transactions = 0;
+    psQueue->ui32Errors = 0;
+
+    //
+    // Assign both FIFOs to the master.  The request interrupts are asserted
+    // when the transmit FIFO is half empty or the receive FIFO half full.
+    //
+    if(psQueue->bFIFO)
+    {
+        MAP_I2CTxFIFOConfigSet(ui32Base, (I2C_FIFO_CFG_TX_MASTER |
+                                          I2C_FIFO_CFG_TX_TRIG_4));
+        MAP_I2CRxFIFOConfigSet(ui32Base, (I2C_FIFO_CFG_RX_MASTER |
+                                          I2C_FIFO_CFG_RX_TRIG_4));
+    }
+
+    //
+    // Route the I2C module to its uDMA channels.
+    //
+    if(psQueue->bDMA)
+    {
+        psQueue->ui32TxChannel = ui32TxMapping & 0xff;
+        psQueue->ui32RxChannel = ui32RxMapping & 0xff;
+
+        MAP_uDMAChannelAssign(ui32TxMapping);
+        MAP_uDMAChannelAssign(ui32RxMapping);
+        MAP_uDMAChannelAttributeDisable(psQueue->ui32TxChannel,
+                                        UDMA_ATTR_ALL);
+        MAP_uDMAChannelAttributeDisable(psQueue->ui32RxChannel,
+                                        UDMA_ATTR_ALL);
+    }
+
+    MAP_I2CMasterIntClear(ui32Base);
+    MAP_I2CMasterIntEnableEx(ui32Base, I2C_MASTER_INT_DATA);
+}
+
+//*****************************************************************************
+//
+//! Fills in a transaction structure.
+//!
+//! \param psTransaction is a pointer to the transaction.
+//! \param ui8Address is the 7-bit address of the slave.
+//! \param pui8Write is a pointer to the data to write.
+//! \param ui16WriteLen is the number of bytes to write.
+//! \param pui8Read is a pointer to the buffer for the data read.
+//! \param ui16ReadLen is the number of bytes to read.
+//! \param pfnCallback is the function called when the transaction completes,
+//! or NULL.
+//! \param pvCBData is the data pointer passed to \e pfnCallback.
+//!
+//! A register read, for example, is a transaction that writes the register
+//! address and then reads the register value.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+I2CQueueTransactionSet(tI2CQueueTransaction *psTransaction,
+                       uint8_t ui8Address, const uint8_t *pui8Write,
+                       uint16_t ui16WriteLen, uint8_t *pui8Read,
+                       uint16_t ui16ReadLen, tI2CQueueCallback pfnCallback,
+                       void *pvCBData)
+{
+    ASSERT(psTransaction);
+    ASSERT(ui8Address < 128);
+
+    psTransaction->psNext = 0;
+    psTransaction->ui8Address = ui8Address;
+    psTransaction->pui8Write = pui8Write;
+    psTransaction->ui16WriteLen = ui16WriteLen;
+    psTransaction->pui8Read = pui8Read;
+    psTransaction->ui16ReadLen = ui16ReadLen;
+    psTransaction->pfnCallback = pfnCallback;
+    psTransaction->pvCBData = pvCBData;
+    psTransaction->ui32Status = I2C_MASTER_ERR_NONE;
+}
+
+//*****************************************************************************
+//
+//! Queues a transaction.
+//!
+//! \param psQueue is a pointer to the queue state.
+//! \param psTransaction is a pointer to the transaction.
+//!
+//! This function adds a transaction to the end of the queue and returns
+//! immediately; the transaction is started at once if the bus is idle.  The
+//! status of the transaction is \b I2C_QUEUE_PENDING until it completes, at
+//! which time its callback is called.  This function may be called from the
+//! callback of another transaction.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+I2CQueueSubmit(tI2CQueue *psQueue, tI2CQueueTransaction *psTransaction)
+{
+    bool bIntsOff;
+
+    ASSERT(psQueue);
+    ASSERT(psTransaction);
+    ASSERT(psTransaction->ui16WriteLen || psTransaction->ui16ReadLen);
+
+    psTransaction->psNext = 0;
+    psTransaction->ui32Status = I2C_QUEUE_PENDING;
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    if(psQueue->psHead)
+    {
+        psQueue->psTail->psNext = psTransaction;
+        psQueue->psTail = psTransaction;
+    }
+    else
+    {
+        psQueue->psHead = psTransaction;
+        psQueue->psTail = psTransaction;
+        I2CQueueNext(psQueue);
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Determines whether any transactions are queued.
+//!
+//! \param psQueue is a pointer to the queue state.
+//!
+//! \return Returns \b true if a transaction is in progress or queued and
+//! \b false otherwise.
+//
+//*****************************************************************************
+bool
+I2CQueueBusy(tI2CQueue *psQueue)
+{
+    ASSERT(psQueue);
+
+    return(psQueue->psHead != 0);
+}
+
+//*****************************************************************************
+//
+//! Handles the interrupt of a queued I2C master.
+//!
+//! \param psQueue is a pointer to the queue state.
+//!
+//! This function must be called from the interrupt handler of the I2C
+//! module.  It services the FIFOs, moves each transaction through its
+//! phases, and calls the completion callbacks.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+I2CQueueIntHandler(tI2CQueue *psQueue)
+{
+    tI2CQueueTransaction *psTransaction;
+    uint32_t ui32Status, ui32Err;
+
+    ASSERT(psQueue);
+
+    ui32Status = MAP_I2CMasterIntStatusEx(psQueue->ui32Base, true);
+    MAP_I2CMasterIntClearEx(psQueue->ui32Base, ui32Status);
+
+    psTransaction = psQueue->psHead;
+    if((psTransaction == 0) || (psQueue->ui8State == STATE_IDLE))
+    {
+        return;
+    }
+
+    //
+    // Service the FIFO used by the current phase, unless the uDMA controller
+    // is doing so.
+    //
+    if(psQueue->bFIFO && !psQueue->bPhaseDMA)
+    {
+        if(psQueue->ui8State == STATE_WRITE)
+        {
+            I2CQueueTxFIFOFill(psQueue);
+        }
+        else
+        {
+            I2CQueueRxFIFODrain(psQueue);
+        }
+    }
+
+    //
+    // A burst read by the uDMA controller is only complete once the last of
+    // its bytes has been moved out of the receive FIFO, which may happen
+    // after the burst completes on the bus.
+    //
+    if(psQueue->bDMAWait)
+    {
+        if(MAP_uDMAChannelIsEnabled(psQueue->ui32RxChannel))
+        {
+            return;
+        }
+        psQueue->bDMAWait = false;
+    }
+
+    //
+    // Nothing more to do until the current transfer is complete.
+    //
+    else if((ui32Status & I2C_MASTER_INT_DATA) == 0)
+    {
+        return;
+    }
+
+    //
+    // See if the transfer failed.  The bus is released with a stop unless
+    // arbitration was lost, in which case another master owns it.
+    //
+    ui32Err = (MAP_I2CMasterErr(psQueue->ui32Base) |
+               (HWREG(psQueue->ui32Base + I2C_O_MCS) & I2C_MCS_CLKTO));
+    if(ui32Err != I2C_MASTER_ERR_NONE)
+    {
+        if((ui32Err & I2C_MASTER_ERR_ARB_LOST) == 0)
+        {
+            MAP_I2CMasterControl(psQueue->ui32Base,
+                                 I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+        }
+        I2CQueueComplete(psQueue, ui32Err);
+        return;
+    }
+
+    //
+    // Collect the data read by the transfer.
+    //
+    if(psQueue->ui8State == STATE_READ)
+    {
+        if(psQueue->bPhaseDMA)
+        {
+            if(MAP_uDMAChannelIsEnabled(psQueue->ui32RxChannel))
+            {
+                psQueue->bDMAWait = true;
+                return;
+            }
+        }
+        else if(psQueue->bFIFO)
+        {
+            I2CQueueRxFIFODrain(psQueue);
+        }
+        else
+        {
+            psTransaction->pui8Read[psQueue->ui16Pos] =
+                MAP_I2CMasterDataGet(psQueue->ui32Base);
+        }
+    }
+
+    //
+    // Move on to the next transfer, the next phase, or the next transaction.
+    //
+    psQueue->ui16Pos += psQueue->ui16Burst;
+    if(psQueue->ui8State == STATE_WRITE)
+    {
+        if(psQueue->ui16Pos < psTransaction->ui16WriteLen)
+        {
+            I2CQueueTransfer(psQueue, false);
+        }
+        else if(psTransaction->ui16ReadLen)
+        {
+            I2CQueuePhaseStart(psQueue, STATE_READ);
+        }
+        else
+        {
+            I2CQueueComplete(psQueue, I2C_MASTER_ERR_NONE);
+        }
+    }
+    else
+    {
+        if(psQueue->ui16Pos < psTransaction->ui16ReadLen)
+        {
+            I2CQueueTransfer(psQueue, false);
+        }
+        else
+        {
+            I2CQueueComplete(psQueue, I2C_MASTER_ERR_NONE);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
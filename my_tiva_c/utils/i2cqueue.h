@@ -0,0 +1,229 @@
+//*****************************************************************************
+//
+// i2cqueue.h - Prototypes for the queued I2C master transaction engine.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __I2CQUEUE_H__
+#define __I2CQUEUE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup i2cqueue_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The status of a transaction that has been queued but has not completed.
+//! Once complete, the status is \b I2C_MASTER_ERR_NONE or a combination of
+//! the \b I2C_MASTER_ERR_xxx values describing the failure.
+//
+//*****************************************************************************
+#define I2C_QUEUE_PENDING       0x80000000
+
+//*****************************************************************************
+//
+//! The value passed to I2CQueueInit() in place of a uDMA channel mapping when
+//! the queue should not use the uDMA controller.
+//
+//*****************************************************************************
+#define I2C_QUEUE_NO_DMA        0xffffffff
+
+//*****************************************************************************
+//
+//! The smallest phase, in bytes, that is moved with the uDMA controller.
+//! Shorter phases are moved through the FIFOs by the interrupt handler,
+//! which avoids the cost of setting up the uDMA channels.
+//
+//*****************************************************************************
+#ifndef I2C_QUEUE_DMA_MIN
+#define I2C_QUEUE_DMA_MIN       8
+#endif
+
+//*****************************************************************************
+//
+//! The prototype for the function that is called when a transaction
+//! completes.  It is called from the I2C interrupt handler with the callback
+//! data of the transaction and its final status.
+//
+//*****************************************************************************
+typedef void (*tI2CQueueCallback)(void *pvCBData, uint32_t ui32Status);
+
+//*****************************************************************************
+//
+//! This structure describes a single I2C transaction.  A transaction writes
+//! and then reads the slave, using a repeated start between the two phases;
+//! either phase may be empty.  The structure is owned by the engine from the
+//! time that it is passed to I2CQueueSubmit() until it completes, so it must
+//! not be modified or reused during that time.
+//
+//*****************************************************************************
+typedef struct tI2CQueueTransaction
+{
+    //
+    //! The next transaction in the queue.
+    //
+    struct tI2CQueueTransaction *psNext;
+
+    //
+    //! The 7-bit address of the slave.
+    //
+    uint8_t ui8Address;
+
+    //
+    //! The data to write and the number of bytes to write.
+    //
+    const uint8_t *pui8Write;
+    uint16_t ui16WriteLen;
+
+    //
+    //! The buffer for the data read and the number of bytes to read.
+    //
+    uint8_t *pui8Read;
+    uint16_t ui16ReadLen;
+
+    //
+    //! The function called when the transaction completes, or NULL, and the
+    //! data pointer passed to it.
+    //
+    tI2CQueueCallback pfnCallback;
+    void *pvCBData;
+
+    //
+    //! The status of the transaction.
+    //
+    volatile uint32_t ui32Status;
+}
+tI2CQueueTransaction;
+
+//*****************************************************************************
+//
+//! This structure contains the state of a queued I2C master.  The members
+//! are set by I2CQueueInit() and should not be accessed or modified by the
+//! application.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The base address of the I2C module.
+    //
+    uint32_t ui32Base;
+
+    //
+    //! Indicates that transfers are made in bursts through the FIFOs rather
+    //! than one byte at a time.
+    //
+    bool bFIFO;
+
+    //
+    //! The uDMA channels used for transmit and receive, if bDMA is set.
+    //
+    uint32_t ui32TxChannel;
+    uint32_t ui32RxChannel;
+    bool bDMA;
+
+    //
+    //! Indicates that the current phase is moved by the uDMA controller, and
+    //! that the current burst has completed on the bus but its last bytes
+    //! have not yet been moved out of the receive FIFO.
+    //
+    bool bPhaseDMA;
+    bool bDMAWait;
+
+    //
+    //! The transaction in progress, which is the head of the queue, and the
+    //! last transaction in the queue.
+    //
+    tI2CQueueTransaction * volatile psHead;
+    tI2CQueueTransaction *psTail;
+
+    //
+    //! The phase of the transaction in progress.
+    //
+    uint8_t ui8State;
+
+    //
+    //! The offset in the current phase of the transfer in progress, the
+    //! number of bytes in it, and the offset of the next byte to be moved
+    //! through a FIFO.
+    //
+    uint16_t ui16Pos;
+    uint16_t ui16Burst;
+    uint16_t ui16FIFOPos;
+
+    //
+    //! The number of transactions completed and the number that failed.
+    //
+    volatile uint32_t ui32Transactions;
+    volatile uint32_t ui32Errors;
+}
+tI2CQueue;
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void I2CQueueInit(tI2CQueue *psQueue, uint32_t ui32Base,
+                         uint32_t ui32TxMapping, uint32_t ui32RxMapping);
+extern void I2CQueueTransactionSet(tI2CQueueTransaction *psTransaction,
+                                   uint8_t ui8Address,
+                                   const uint8_t *pui8Write,
+                                   uint16_t ui16WriteLen, uint8_t *pui8Read,
+                                   uint16_t ui16ReadLen,
+                                   tI2CQueueCallback pfnCallback,
+                                   void *pvCBData);
+extern void I2CQueueSubmit(tI2CQueue *psQueue,
+                           tI2CQueueTransaction *psTransaction);
+extern bool I2CQueueBusy(tI2CQueue *psQueue);
+extern void I2CQueueIntHandler(tI2CQueue *psQueue);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __I2CQUEUE_H__
@@ -0,0 +1,422 @@
+//*****************************************************************************
+//
+// isrtrace.c - Interrupt dispatcher with latency and nesting tracing.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "utils/isrtrace.h"
+#include "utils/uartstdio.h"
+
+//*****************************************************************************
+//
+//! \addtogroup isrtrace_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The data watchpoint and trace unit registers, and the trace enable bit of
+// the debug exception and monitor control register, which are used for the
+// processor cycle counter.
+//
+//*****************************************************************************
+#define DWT_CTRL                0xE0001000
+#define DWT_CYCCNT              0xE0001004
+#define DWT_CTRL_CYCCNTENA      0x00000001
+#define NVIC_DBG_INT_TRCENA     0x01000000
+
+//*****************************************************************************
+//
+// The dispatcher is placed in SRAM with the compilers that support it, so
+// that its timing does not depend on flash wait states or on the flash being
+// busy with an erase or program operation.  With the GNU compilers the
+// dispatcher is placed in the .ramfunc section, which the linker script must
+// place in the .data output section so that it is copied to SRAM at startup.
+//
+//*****************************************************************************
+#if defined(ewarm)
+#define RAMFUNC                 __ramfunc
+#elif defined(codered) || defined(gcc) || defined(sourcerygxx)
+#define RAMFUNC                 __attribute__((section(".ramfunc"),          \
+                                               long_call, noinline))
+#else
+#define RAMFUNC
+#endif
+
+//*****************************************************************************
+//
+// The statistics of each traced interrupt, indexed by interrupt number, or
+// NULL for interrupts that are dispatched directly through the vector table.
+//
+//*****************************************************************************
+static tISRTraceStats *g_ppsISRTraceStats[NUM_INTERRUPTS];
+
+//*****************************************************************************
+//
+// The number of traced handlers that are currently executing.
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32ISRTraceDepth;
+
+//*****************************************************************************
+//
+// Adds a latency to the statistics of an interrupt.
+//
+//*****************************************************************************
+static RAMFUNC void
+ISRTraceLatencyAdd(tISRTraceStats *psStats, uint32_t ui32Latency)
+{
+    uint32_t ui32Bin, ui32Value;
+
+    psStats->ui32Latencies++;
+    if(ui32Latency > psStats->ui32MaxLatency)
+    {
+        psStats->ui32MaxLatency = ui32Latency;
+    }
+
+    for(ui32Bin = 0, ui32Value = ui32Latency >> 4;
+        ui32Value && (ui32Bin < (ISR_TRACE_BINS - 1)); ui32Bin++)
+    {
+        ui32Value >>= 1;
+    }
+    psStats->pui32Histogram[ui32Bin]++;
+}
+
+//*****************************************************************************
+//
+// The handler installed in the vector table for each traced interrupt.  It
+// time stamps the entry to and exit from the real handler.
+//
+//*****************************************************************************
+static RAMFUNC void
+ISRTraceDispatch(void)
+{
+    tISRTraceStats *psStats;
+    uint32_t ui32Entry, ui32Depth;
+
+    ui32Entry = HWREG(DWT_CYCCNT);
+    psStats = g_ppsISRTraceStats[HWREG(NVIC_INT_CTRL) &
+                                 NVIC_INT_CTRL_VEC_ACT_M];
+
+    ui32Depth = ++g_ui32ISRTraceDepth;
+    if(ui32Depth > psStats->ui32MaxNesting)
+    {
+        psStats->ui32MaxNesting = ui32Depth;
+    }
+
+    //
+    // The latency is known if the interrupt was triggered by
+    // ISRTraceTrigger(); otherwise the handler may supply it.
+    //
+    if(psStats->bEvent)
+    {
+        psStats->bEvent = false;
+        psStats->ui32Latency = ui32Entry - psStats->ui32EventTime;
+    }
+    else
+    {
+        psStats->ui32Latency = ISR_TRACE_NO_LATENCY;
+    }
+
+    psStats->pfnHandler();
+
+    ui32Entry = HWREG(DWT_CYCCNT) - ui32Entry;
+    if(ui32Entry > psStats->ui32MaxDuration)
+    {
+        psStats->ui32MaxDuration = ui32Entry;
+    }
+    if(psStats->ui32Latency != ISR_TRACE_NO_LATENCY)
+    {
+        ISRTraceLatencyAdd(psStats, psStats->ui32Latency);
+    }
+    psStats->ui32Count++;
+
+    g_ui32ISRTraceDepth--;
+}
+
+//*****************************************************************************
+//
+//! Initializes the traced interrupt dispatcher.
+//!
+//! This function starts the processor cycle counter, which is used for all
+//! time stamps, and moves the vector table to SRAM (if IntRegister() has not
+//! already done so), so that interrupts are dispatched through the SRAM
+//! vector table from then on.  All SRAM on these devices is accessed in a
+//! single cycle, so the location of the table within SRAM does not matter.
+//!
+//! The cycle counter is part of the debug logic; a debugger that is attached
+//! may also use it, but does not normally reset it.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ISRTraceInit(void)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < NUM_INTERRUPTS; ui32Idx++)
+    {
+        g_ppsISRTraceStats[ui32Idx] = 0;
+    }
+    g_ui32ISRTraceDepth = 0;
+
+    HWREG(NVIC_DBG_INT) |= NVIC_DBG_INT_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+
+    //
+    // Registering the current handler of an interrupt moves the vector table
+    // to SRAM without changing the handler.
+    //
+    IntRegister(FAULT_SYSTICK,
+                (void (*)(void))HWREG(HWREG(NVIC_VTABLE) +
+                                      (FAULT_SYSTICK * 4)));
+}
+
+//*****************************************************************************
+//
+//! Dispatches an interrupt through the tracing dispatcher.
+//!
+//! \param ui32Interrupt is the interrupt number, one of the \b INT_* values,
+//! or \b FAULT_SYSTICK.
+//! \param pfnHandler is the handler of the interrupt, or NULL to trace the
+//! handler that is currently in the vector table.
+//! \param psStats is a pointer to the structure that holds the statistics of
+//! the interrupt.
+//!
+//! The interrupt should be disabled, or its handler should not be executing,
+//! while this function is called.  The statistics are cleared.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ISRTraceRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void),
+                 tISRTraceStats *psStats)
+{
+    ASSERT((ui32Interrupt >= FAULT_SYSTICK) &&
+           (ui32Interrupt < NUM_INTERRUPTS));
+    ASSERT(psStats);
+
+    if(!pfnHandler)
+    {
+        pfnHandler = (void (*)(void))HWREG(HWREG(NVIC_VTABLE) +
+                                           (ui32Interrupt * 4));
+        ASSERT(pfnHandler != ISRTraceDispatch);
+    }
+
+    psStats->pfnHandler = pfnHandler;
+    psStats->bEvent = false;
+    ISRTraceClear(psStats);
+
+    g_ppsISRTraceStats[ui32Interrupt] = psStats;
+    IntRegister(ui32Interrupt, ISRTraceDispatch);
+}
+
+//*****************************************************************************
+//
+//! Stops tracing an interrupt.
+//!
+//! \param ui32Interrupt is the interrupt number.
+//!
+//! This function restores the handler of the interrupt to the vector table,
+//! so that it is again dispatched directly.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ISRTraceUnregister(uint32_t ui32Interrupt)
+{
+    ASSERT((ui32Interrupt >= FAULT_SYSTICK) &&
+           (ui32Interrupt < NUM_INTERRUPTS));
+    ASSERT(g_ppsISRTraceStats[ui32Interrupt]);
+
+    IntRegister(ui32Interrupt,
+                g_ppsISRTraceStats[ui32Interrupt]->pfnHandler);
+    g_ppsISRTraceStats[ui32Interrupt] = 0;
+}
+
+//*****************************************************************************
+//
+//! Triggers a traced interrupt and measures its latency.
+//!
+//! \param ui32Interrupt is the interrupt number.
+//!
+//! This function records the current time and pends the interrupt, so that
+//! the time until its handler is entered is added to its latency statistics.
+//! This measures the latency caused by higher priority handlers and by
+//! sections of code that run with interrupts disabled.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ISRTraceTrigger(uint32_t ui32Interrupt)
+{
+    tISRTraceStats *psStats;
+
+    ASSERT((ui32Interrupt >= FAULT_SYSTICK) &&
+           (ui32Interrupt < NUM_INTERRUPTS));
+    ASSERT(g_ppsISRTraceStats[ui32Interrupt]);
+
+    psStats = g_ppsISRTraceStats[ui32Interrupt];
+    psStats->ui32EventTime = HWREG(DWT_CYCCNT);
+    psStats->bEvent = true;
+    MAP_IntPendSet(ui32Interrupt);
+}
+
+//*****************************************************************************
+//
+//! Supplies the latency of the traced handler that is executing.
+//!
+//! \param ui32Cycles is the latency of the interrupt in processor cycles.
+//!
+//! This function is called by a traced handler that can determine its own
+//! latency, such as the handler of a periodic timer that reads the number of
+//! cycles that have elapsed since the timer expired.  The latency is added
+//! to the statistics of the interrupt when the handler returns.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ISRTraceLatencySet(uint32_t ui32Cycles)
+{
+    tISRTraceStats *psStats;
+
+    psStats = g_ppsISRTraceStats[HWREG(NVIC_INT_CTRL) &
+                                 NVIC_INT_CTRL_VEC_ACT_M];
+    if(psStats)
+    {
+        psStats->ui32Latency = ui32Cycles;
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the processor cycle counter used for the time stamps.
+//!
+//! \return Returns the current value of the cycle counter.
+//
+//*****************************************************************************
+uint32_t
+ISRTraceTimeGet(void)
+{
+    return(HWREG(DWT_CYCCNT));
+}
+
+//*****************************************************************************
+//
+//! Clears the statistics of a traced interrupt.
+//!
+//! \param psStats is a pointer to the statistics structure.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ISRTraceClear(tISRTraceStats *psStats)
+{
+    uint32_t ui32Bin;
+
+    ASSERT(psStats);
+
+    psStats->ui32Count = 0;
+    psStats->ui32Latencies = 0;
+    psStats->ui32MaxLatency = 0;
+    psStats->ui32MaxDuration = 0;
+    psStats->ui32MaxNesting = 0;
+    for(ui32Bin = 0; ui32Bin < ISR_TRACE_BINS; ui32Bin++)
+    {
+        psStats->pui32Histogram[ui32Bin] = 0;
+    }
+}
+
+//*****************************************************************************
+//
+//! Prints the statistics of a traced interrupt.
+//!
+//! \param ui32Interrupt is the interrupt number.
+//!
+//! This function prints the statistics and the latency histogram of the
+//! interrupt with UARTprintf(), one line per non-empty bin.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ISRTraceDump(uint32_t ui32Interrupt)
+{
+    tISRTraceStats *psStats;
+    uint32_t ui32Bin;
+
+    ASSERT((ui32Interrupt >= FAULT_SYSTICK) &&
+           (ui32Interrupt < NUM_INTERRUPTS));
+
+    psStats = g_ppsISRTraceStats[ui32Interrupt];
+    if(!psStats)
+    {
+        return;
+    }
+
+    UARTprintf("Interrupt %d: %d calls, max duration %d, max nesting %d\n",
+               ui32Interrupt, psStats->ui32Count, psStats->ui32MaxDuration,
+               psStats->ui32MaxNesting);
+    UARTprintf("  %d latencies, max %d\n", psStats->ui32Latencies,
+               psStats->ui32MaxLatency);
+
+    for(ui32Bin = 0; ui32Bin < ISR_TRACE_BINS; ui32Bin++)
+    {
+        if(!psStats->pui32Histogram[ui32Bin])
+        {
+            continue;
+        }
+        if(ui32Bin == (ISR_TRACE_BINS - 1))
+        {
+            UARTprintf("  >= %8d: %d\n", 8 << ui32Bin,
+                       psStats->pui32Histogram[ui32Bin]);
+        }
+        else
+        {
+            UARTprintf("  <  %8d: %d\n", 16 << ui32Bin,
+                       psStats->pui32Histogram[ui32Bin]);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
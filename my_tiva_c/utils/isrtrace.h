@@ -0,0 +1,152 @@
+//*****************************************************************************
+//
+// isrtrace.h - Prototypes for the traced interrupt dispatcher.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __ISRTRACE_H__
+#define __ISRTRACE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup isrtrace_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The number of bins in the latency histogram of an interrupt.  Bin 0 counts
+//! latencies of less than 16 processor cycles, and each following bin counts
+//! latencies up to twice those of the previous one; the last bin counts all
+//! longer latencies.
+//
+//*****************************************************************************
+#define ISR_TRACE_BINS          16
+
+//*****************************************************************************
+//
+//! This structure holds the handler and the statistics of a traced
+//! interrupt.  It is owned by the dispatcher from the time that it is passed
+//! to ISRTraceRegister(); the statistics may be read, or cleared with
+//! ISRTraceClear(), at any time.  All times are in processor cycles.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The handler of the interrupt.
+    //
+    void (*pfnHandler)(void);
+
+    //
+    //! The number of times that the handler has been called.
+    //
+    uint32_t ui32Count;
+
+    //
+    //! The number of latencies that have been measured, and the longest.
+    //
+    uint32_t ui32Latencies;
+    uint32_t ui32MaxLatency;
+
+    //
+    //! The longest time spent in the handler, including the time spent in
+    //! the handlers of interrupts that preempted it.
+    //
+    uint32_t ui32MaxDuration;
+
+    //
+    //! The deepest interrupt nesting seen on entry to the handler; 1 means
+    //! that no traced handler was preempted.
+    //
+    uint32_t ui32MaxNesting;
+
+    //
+    //! The histogram of the measured latencies.
+    //
+    uint32_t pui32Histogram[ISR_TRACE_BINS];
+
+    //
+    //! The time at which the interrupt was triggered by ISRTraceTrigger(),
+    //! and whether the trigger time is valid.
+    //
+    uint32_t ui32EventTime;
+    volatile bool bEvent;
+
+    //
+    //! The latency of the current call of the handler, or
+    //! \b ISR_TRACE_NO_LATENCY if it is not known.
+    //
+    uint32_t ui32Latency;
+}
+tISRTraceStats;
+
+//*****************************************************************************
+//
+//! The latency of a handler call whose latency was not measured.
+//
+//*****************************************************************************
+#define ISR_TRACE_NO_LATENCY    0xFFFFFFFF
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void ISRTraceInit(void);
+extern void ISRTraceRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void),
+                             tISRTraceStats *psStats);
+extern void ISRTraceUnregister(uint32_t ui32Interrupt);
+extern void ISRTraceTrigger(uint32_t ui32Interrupt);
+extern void ISRTraceLatencySet(uint32_t ui32Cycles);
+extern uint32_t ISRTraceTimeGet(void);
+extern void ISRTraceClear(tISRTraceStats *psStats);
+extern void ISRTraceDump(uint32_t ui32Interrupt);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ISRTRACE_H__
@@ -0,0 +1,688 @@
+//*****************************************************************************
+//
+// jsonparse.c - A streaming, path-matching JSON parser.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "driverlib/debug.h"
+#include "utils/lwiplib.h"
+#include "utils/jsonparse.h"
+
+//*****************************************************************************
+//
+//! \addtogroup jsonparse_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The lexical states of the parser.
+//
+//*****************************************************************************
+#define JSON_STATE_START        0
+#define JSON_STATE_VALUE        1
+#define JSON_STATE_ARRAY_START  2
+#define JSON_STATE_OBJECT_START 3
+#define JSON_STATE_KEY          4
+#define JSON_STATE_COLON        5
+#define JSON_STATE_STRING       6
+#define JSON_STATE_ESCAPE       7
+#define JSON_STATE_UNICODE      8
+#define JSON_STATE_LITERAL      9
+#define JSON_STATE_AFTER_VALUE  10
+#define JSON_STATE_DONE         11
+#define JSON_STATE_ERROR        12
+
+//*****************************************************************************
+//
+// The value stored in pui8PathLen for a container whose path has overflowed
+// the path buffer.
+//
+//*****************************************************************************
+#define JSON_PATH_INVALID       0xff
+
+//*****************************************************************************
+//
+// Returns true if the character is JSON white space.
+//
+//*****************************************************************************
+static bool
+JSONIsSpace(uint8_t ui8Char)
+{
+    return((ui8Char == ' ') || (ui8Char == '\t') || (ui8Char == '\r') ||
+           (ui8Char == '\n'));
+}
+
+//*****************************************************************************
+//
+// Starts a new key or value token.
+//
+//*****************************************************************************
+static void
+JSONTokenStart(tJSONParser *psParser, bool bKey)
+{
+    psParser->ui8TokenLen = 0;
+    psParser->bKey = bKey;
+    psParser->bTokenOverflow = false;
+}
+
+//*****************************************************************************
+//
+// Appends a character to the current token, truncating it if it is full.
+//
+//*****************************************************************************
+static void
+JSONTokenAdd(tJSONParser *psParser, char cChar)
+{
+    if(psParser->ui8TokenLen < (JSON_MAX_TOKEN - 1))
+    {
+        psParser->pcToken[psParser->ui8TokenLen++] = cChar;
+    }
+    else
+    {
+        psParser->bTokenOverflow = true;
+    }
+}
+
+//*****************************************************************************
+//
+// Restores the path to that of the innermost open container.
+//
+//*****************************************************************************
+static void
+JSONPathRestore(tJSONParser *psParser)
+{
+    uint8_t ui8Len;
+
+    ui8Len = psParser->pui8PathLen[psParser->ui8Depth - 1];
+
+    if(ui8Len == JSON_PATH_INVALID)
+    {
+        psParser->bPathOverflow = true;
+    }
+    else
+    {
+        psParser->bPathOverflow = false;
+        psParser->ui8PathLen = ui8Len;
+        psParser->pcPath[ui8Len] = 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Appends the key just read to the path of the innermost open container.
+//
+//*****************************************************************************
+static void
+JSONPathKeyAdd(tJSONParser *psParser)
+{
+    uint32_t ui32Len;
+
+    JSONPathRestore(psParser);
+
+    if(psParser->bPathOverflow || psParser->bTokenOverflow)
+    {
+        psParser->bPathOverflow = true;
+        return;
+    }
+
+    //
+    // Check that the separator, key and terminating NUL fit.
+    //
+    ui32Len = psParser->ui8PathLen + psParser->ui8TokenLen +
+              (psParser->ui8PathLen ? 1 : 0);
+    if(ui32Len >= JSON_MAX_PATH)
+    {
+        psParser->bPathOverflow = true;
+        return;
+    }
+
+    if(psParser->ui8PathLen)
+    {
+        psParser->pcPath[psParser->ui8PathLen++] = '.';
+    }
+    memcpy(psParser->pcPath + psParser->ui8PathLen, psParser->pcToken,
+           psParser->ui8TokenLen);
+    psParser->ui8PathLen = (uint8_t)ui32Len;
+    psParser->pcPath[ui32Len] = 0;
+}
+
+//*****************************************************************************
+//
+// Opens a new object or array.  Returns false if the nesting is too deep.
+//
+//*****************************************************************************
+static bool
+JSONContainerPush(tJSONParser *psParser, char cType)
+{
+    if(psParser->ui8Depth == JSON_MAX_DEPTH)
+    {
+        return(false);
+    }
+
+    psParser->pcStack[psParser->ui8Depth] = cType;
+    psParser->pui8PathLen[psParser->ui8Depth] =
+        psParser->bPathOverflow ? JSON_PATH_INVALID : psParser->ui8PathLen;
+    psParser->ui8Depth++;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Closes the innermost object or array and returns the next lexical state.
+//
+//*****************************************************************************
+static uint8_t
+JSONContainerPop(tJSONParser *psParser, char cClose)
+{
+    char cOpen;
+
+    cOpen = (cClose == '}') ? '{' : '[';
+
+    if(psParser->pcStack[psParser->ui8Depth - 1] != cOpen)
+    {
+        return(JSON_STATE_ERROR);
+    }
+
+    psParser->ui8Depth--;
+
+    //
+    // Closing the outermost container completes the document.
+    //
+    if(psParser->ui8Depth == 0)
+    {
+        return(JSON_STATE_DONE);
+    }
+
+    JSONPathRestore(psParser);
+
+    return(JSON_STATE_AFTER_VALUE);
+}
+
+//*****************************************************************************
+//
+// Passes a completed scalar value to the handler registered for its path, if
+// any.
+//
+//*****************************************************************************
+static void
+JSONValueReport(tJSONParser *psParser, uint32_t ui32Type)
+{
+    uint32_t ui32Idx;
+
+    psParser->pcToken[psParser->ui8TokenLen] = 0;
+
+    if(!psParser->bPathOverflow)
+    {
+        for(ui32Idx = 0; ui32Idx < psParser->ui32NumHandlers; ui32Idx++)
+        {
+            if(strcmp(psParser->psHandlers[ui32Idx].pcPath,
+                      psParser->pcPath) == 0)
+            {
+                psParser->psHandlers[ui32Idx].pfnCallback(psParser->pvCBData,
+                                                          ui32Idx, ui32Type,
+                                                          psParser->pcToken);
+            }
+        }
+    }
+
+    //
+    // The value has been consumed, so return to the container's path.
+    //
+    JSONPathRestore(psParser);
+}
+
+//*****************************************************************************
+//
+// Reports a completed true, false, null or number value.  Returns false if the
+// literal is not valid.
+//
+//*****************************************************************************
+static bool
+JSONLiteralReport(tJSONParser *psParser)
+{
+    uint32_t ui32Type;
+    char cFirst;
+
+    psParser->pcToken[psParser->ui8TokenLen] = 0;
+    cFirst = psParser->pcToken[0];
+
+    if((cFirst == '-') || ((cFirst >= '0') && (cFirst <= '9')))
+    {
+        ui32Type = JSON_TYPE_NUMBER;
+    }
+    else if(strcmp(psParser->pcToken, "true") == 0)
+    {
+        ui32Type = JSON_TYPE_TRUE;
+    }
+    else if(strcmp(psParser->pcToken, "false") == 0)
+    {
+        ui32Type = JSON_TYPE_FALSE;
+    }
+    else if(strcmp(psParser->pcToken, "null") == 0)
+    {
+        ui32Type = JSON_TYPE_NULL;
+    }
+    else
+    {
+        return(false);
+    }
+
+    JSONValueReport(psParser, ui32Type);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Handles the first character of a value.  Returns the next lexical state.
+//
+//*****************************************************************************
+static uint8_t
+JSONValueStart(tJSONParser *psParser, uint8_t ui8Char)
+{
+    if(ui8Char == '{')
+    {
+        return(JSONContainerPush(psParser, '{') ? JSON_STATE_OBJECT_START :
+                                                  JSON_STATE_ERROR);
+    }
+    if(ui8Char == '[')
+    {
+        return(JSONContainerPush(psParser, '[') ? JSON_STATE_ARRAY_START :
+                                                  JSON_STATE_ERROR);
+    }
+    if(ui8Char == '"')
+    {
+        JSONTokenStart(psParser, false);
+        return(JSON_STATE_STRING);
+    }
+    if((ui8Char == '-') || ((ui8Char >= '0') && (ui8Char <= '9')) ||
+       ((ui8Char >= 'a') && (ui8Char <= 'z')))
+    {
+        JSONTokenStart(psParser, false);
+        JSONTokenAdd(psParser, (char)ui8Char);
+        return(JSON_STATE_LITERAL);
+    }
+
+    return(JSON_STATE_ERROR);
+}
+
+//*****************************************************************************
+//
+// Handles the character following a value.  Returns the next lexical state.
+//
+//*****************************************************************************
+static uint8_t
+JSONValueEnd(tJSONParser *psParser, uint8_t ui8Char)
+{
+    if(ui8Char == ',')
+    {
+        return((psParser->pcStack[psParser->ui8Depth - 1] == '{') ?
+               JSON_STATE_KEY : JSON_STATE_VALUE);
+    }
+    if((ui8Char == '}') || (ui8Char == ']'))
+    {
+        return(JSONContainerPop(psParser, (char)ui8Char));
+    }
+
+    return(JSON_STATE_ERROR);
+}
+
+//*****************************************************************************
+//
+//! Initializes a streaming JSON parser.
+//!
+//! \param psParser points to the parser state to initialize.
+//! \param psHandlers points to a table of paths of interest and the functions
+//! to call when a value is found at each path.
+//! \param ui32NumHandlers is the number of entries in \e psHandlers.
+//! \param pvCBData is an application data pointer passed to the handler
+//! functions.
+//!
+//! This function prepares a parser to read a new JSON document.  The document
+//! is then passed to the parser, in pieces of any size, using JSONParserData()
+//! or JSONParserPbuf().  Each byte of the document is examined only once and
+//! the document is never buffered, so the parser may be fed directly from TCP
+//! segments as they arrive.
+//!
+//! Any bytes before the first '{' or '[' character are ignored, which allows
+//! the parser to be fed a complete HTTP response including its headers.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+JSONParserInit(tJSONParser *psParser, const tJSONPathHandler *psHandlers,
+               uint32_t ui32NumHandlers, void *pvCBData)
+{
+    ASSERT(psParser);
+    ASSERT(psHandlers || (ui32NumHandlers == 0));
+
+    psParser->psHandlers = psHandlers;
+    psParser->ui32NumHandlers = ui32NumHandlers;
+    psParser->pvCBData = pvCBData;
+    psParser->ui8State = JSON_STATE_START;
+    psParser->ui8Depth = 0;
+    psParser->pcPath[0] = 0;
+    psParser->ui8PathLen = 0;
+    psParser->bPathOverflow = false;
+    JSONTokenStart(psParser, false);
+}
+
+//*****************************************************************************
+//
+//! Passes the next piece of a JSON document to a streaming parser.
+//!
+//! \param psParser points to the parser state.
+//! \param pui8Data points to the data.
+//! \param ui32Size is the number of bytes of data.
+//!
+//! This function parses the next \e ui32Size bytes of the document, calling
+//! the registered handler function for each string, number, true, false or
+//! null value whose path matches an entry in the handler table.  Tokens may
+//! be split across calls at any point.
+//!
+//! \return Returns \b JSON_PARSE_MORE if the document is not yet complete,
+//! \b JSON_PARSE_DONE once the outermost object or array has been closed
+//! (any further data is ignored), or \b JSON_PARSE_ERROR if the document is
+//! malformed or nested more deeply than \b JSON_MAX_DEPTH.
+//
+//*****************************************************************************
+int32_t
+JSONParserData(tJSONParser *psParser, const uint8_t *pui8Data,
+               uint32_t ui32Size)
+{
+    uint8_t ui8State, ui8Char;
+
+    ASSERT(psParser);
+    ASSERT(pui8Data || (ui32Size == 0));
+
+    ui8State = psParser->ui8State;
+
+    while(ui32Size && (ui8State != JSON_STATE_DONE) &&
+          (ui8State != JSON_STATE_ERROR))
+    {
+        ui8Char = *pui8Data++;
+        ui32Size--;
+
+        switch(ui8State)
+        {
+            //
+            // Skip anything before the start of the document.
+            //
+            case JSON_STATE_START:
+            {
+                if((ui8Char == '{') || (ui8Char == '['))
+                {
+                    ui8State = JSONValueStart(psParser, ui8Char);
+                }
+                break;
+            }
+
+            //
+            // Expecting a value, or the end of an empty array.
+            //
+            case JSON_STATE_ARRAY_START:
+            case JSON_STATE_VALUE:
+            {
+                if(JSONIsSpace(ui8Char))
+                {
+                    break;
+                }
+                if((ui8Char == ']') && (ui8State == JSON_STATE_ARRAY_START))
+                {
+                    ui8State = JSONContainerPop(psParser, ']');
+                    break;
+                }
+                ui8State = JSONValueStart(psParser, ui8Char);
+                break;
+            }
+
+            //
+            // Expecting a key, or the end of an empty object.
+            //
+            case JSON_STATE_OBJECT_START:
+            case JSON_STATE_KEY:
+            {
+                if(JSONIsSpace(ui8Char))
+                {
+                    break;
+                }
+                if((ui8Char == '}') && (ui8State == JSON_STATE_OBJECT_START))
+                {
+                    ui8State = JSONContainerPop(psParser, '}');
+                    break;
+                }
+                if(ui8Char == '"')
+                {
+                    JSONTokenStart(psParser, true);
+                    ui8State = JSON_STATE_STRING;
+                    break;
+                }
+                ui8State = JSON_STATE_ERROR;
+                break;
+            }
+
+            //
+            // Expecting the ':' between a key and its value.
+            //
+            case JSON_STATE_COLON:
+            {
+                if(ui8Char == ':')
+                {
+                    ui8State = JSON_STATE_VALUE;
+                }
+                else if(!JSONIsSpace(ui8Char))
+                {
+                    ui8State = JSON_STATE_ERROR;
+                }
+                break;
+            }
+
+            //
+            // Reading a key or string value.
+            //
+            case JSON_STATE_STRING:
+            {
+                if(ui8Char == '\\')
+                {
+                    ui8State = JSON_STATE_ESCAPE;
+                }
+                else if(ui8Char == '"')
+                {
+                    if(psParser->bKey)
+                    {
+                        JSONPathKeyAdd(psParser);
+                        ui8State = JSON_STATE_COLON;
+                    }
+                    else
+                    {
+                        JSONValueReport(psParser, JSON_TYPE_STRING);
+                        ui8State = JSON_STATE_AFTER_VALUE;
+                    }
+                }
+                else
+                {
+                    JSONTokenAdd(psParser, (char)ui8Char);
+                }
+                break;
+            }
+
+            //
+            // Decoding the character following a '\' in a string.
+            //
+            case JSON_STATE_ESCAPE:
+            {
+                ui8State = JSON_STATE_STRING;
+
+                switch(ui8Char)
+                {
+                    case 'b':
+                        ui8Char = '\b';
+                        break;
+                    case 'f':
+                        ui8Char = '\f';
+                        break;
+                    case 'n':
+                        ui8Char = '\n';
+                        break;
+                    case 'r':
+                        ui8Char = '\r';
+                        break;
+                    case 't':
+                        ui8Char = '\t';
+                        break;
+
+                    //
+                    // Unicode escapes are replaced by '?' and their four hex
+                    // digits are skipped.
+                    //
+                    case 'u':
+                        ui8Char = '?';
+                        psParser->ui8HexDigits = 4;
+                        ui8State = JSON_STATE_UNICODE;
+                        break;
+
+                    default:
+                        break;
+                }
+
+                JSONTokenAdd(psParser, (char)ui8Char);
+                break;
+            }
+
+            //
+            // Skipping the hex digits of a \u escape.
+            //
+            case JSON_STATE_UNICODE:
+            {
+                if(--psParser->ui8HexDigits == 0)
+                {
+                    ui8State = JSON_STATE_STRING;
+                }
+                break;
+            }
+
+            //
+            // Reading a number, true, false or null.
+            //
+            case JSON_STATE_LITERAL:
+            {
+                if((ui8Char == ',') || (ui8Char == '}') || (ui8Char == ']') ||
+                   JSONIsSpace(ui8Char))
+                {
+                    if(!JSONLiteralReport(psParser))
+                    {
+                        ui8State = JSON_STATE_ERROR;
+                    }
+                    else if(JSONIsSpace(ui8Char))
+                    {
+                        ui8State = JSON_STATE_AFTER_VALUE;
+                    }
+                    else
+                    {
+                        ui8State = JSONValueEnd(psParser, ui8Char);
+                    }
+                }
+                else
+                {
+                    JSONTokenAdd(psParser, (char)ui8Char);
+                }
+                break;
+            }
+
+            //
+            // Expecting a ',' or the end of the enclosing container.
+            //
+            case JSON_STATE_AFTER_VALUE:
+            {
+                if(!JSONIsSpace(ui8Char))
+                {
+                    ui8State = JSONValueEnd(psParser, ui8Char);
+                }
+                break;
+            }
+
+            default:
+            {
+                ui8State = JSON_STATE_ERROR;
+                break;
+            }
+        }
+    }
+
+    psParser->ui8State = ui8State;
+
+    if(ui8State == JSON_STATE_DONE)
+    {
+        return(JSON_PARSE_DONE);
+    }
+    if(ui8State == JSON_STATE_ERROR)
+    {
+        return(JSON_PARSE_ERROR);
+    }
+    return(JSON_PARSE_MORE);
+}
+
+//*****************************************************************************
+//
+//! Passes an lwIP pbuf chain to a streaming JSON parser.
+//!
+//! \param psParser points to the parser state.
+//! \param psBuf points to the first pbuf of the chain.
+//!
+//! This function passes the payload of each pbuf in the chain to
+//! JSONParserData(), allowing a TCP receive callback to feed each received
+//! segment to the parser without copying it.  The caller remains responsible
+//! for freeing the chain.
+//!
+//! \return Returns \b JSON_PARSE_MORE, \b JSON_PARSE_DONE or
+//! \b JSON_PARSE_ERROR as for JSONParserData().
+//
+//*****************************************************************************
+int32_t
+JSONParserPbuf(tJSONParser *psParser, struct pbuf *psBuf)
+{
+    int32_t i32Status;
+
+    i32Status = JSON_PARSE_MORE;
+
+    while(psBuf && (i32Status == JSON_PARSE_MORE))
+    {
+        i32Status = JSONParserData(psParser, (const uint8_t *)psBuf->payload,
+                                   psBuf->len);
+        psBuf = psBuf->next;
+    }
+
+    return(i32Status);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
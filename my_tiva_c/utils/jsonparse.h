@@ -0,0 +1,205 @@
+//*****************************************************************************
+//
+// jsonparse.h - Prototypes for the streaming JSON parser.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __JSONPARSE_H__
+#define __JSONPARSE_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+// The maximum nesting depth of objects and arrays supported by the parser.
+// Documents nested more deeply are rejected.
+//
+//*****************************************************************************
+#ifndef JSON_MAX_DEPTH
+#define JSON_MAX_DEPTH          8
+#endif
+
+//*****************************************************************************
+//
+// The size of the buffer holding the path of the current value, including the
+// terminating NUL.  Values whose path does not fit are not reported.
+//
+//*****************************************************************************
+#ifndef JSON_MAX_PATH
+#define JSON_MAX_PATH           64
+#endif
+
+//*****************************************************************************
+//
+// The size of the buffer holding the current key or value, including the
+// terminating NUL.  Longer strings are truncated.
+//
+//*****************************************************************************
+#ifndef JSON_MAX_TOKEN
+#define JSON_MAX_TOKEN          32
+#endif
+
+//*****************************************************************************
+//
+// The types of value passed to a tJSONValueCallback function.
+//
+//*****************************************************************************
+#define JSON_TYPE_STRING        0
+#define JSON_TYPE_NUMBER        1
+#define JSON_TYPE_TRUE          2
+#define JSON_TYPE_FALSE         3
+#define JSON_TYPE_NULL          4
+
+//*****************************************************************************
+//
+// The values returned by JSONParserData() and JSONParserPbuf().
+//
+//*****************************************************************************
+#define JSON_PARSE_MORE         0
+#define JSON_PARSE_DONE         1
+#define JSON_PARSE_ERROR        -1
+
+//*****************************************************************************
+//
+// The prototype for a function called when a value is found at a path of
+// interest.  The parameters are the application data pointer passed to
+// JSONParserInit(), the index of the matching entry in the handler table, the
+// type of the value (one of the JSON_TYPE_* values) and the value itself as a
+// NUL-terminated string, with any string escapes decoded.
+//
+//*****************************************************************************
+typedef void (*tJSONValueCallback)(void *pvCBData, uint32_t ui32Index,
+                                   uint32_t ui32Type, const char *pcValue);
+
+//*****************************************************************************
+//
+// An entry in the table of paths of interest passed to JSONParserInit().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The path of the value, as the keys leading to it separated by '.'
+    // characters, for example "main.temp".  Arrays do not add to the path, so
+    // "weather.icon" matches the "icon" key of every object in the "weather"
+    // array.
+    //
+    const char *pcPath;
+
+    //
+    // The function called for each value found at this path.
+    //
+    tJSONValueCallback pfnCallback;
+}
+tJSONPathHandler;
+
+//*****************************************************************************
+//
+// The state of a streaming JSON parser.  The fields of this structure are
+// private to the parser.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The table of paths of interest, its size, and the data pointer passed
+    // to the callback functions.
+    //
+    const tJSONPathHandler *psHandlers;
+    uint32_t ui32NumHandlers;
+    void *pvCBData;
+
+    //
+    // The current lexical state.
+    //
+    uint8_t ui8State;
+
+    //
+    // The current nesting depth.
+    //
+    uint8_t ui8Depth;
+
+    //
+    // The type of each open container, either '{' or '['.
+    //
+    char pcStack[JSON_MAX_DEPTH];
+
+    //
+    // The length of the path of each open container.
+    //
+    uint8_t pui8PathLen[JSON_MAX_DEPTH];
+
+    //
+    // The path of the current value.
+    //
+    char pcPath[JSON_MAX_PATH];
+    uint8_t ui8PathLen;
+
+    //
+    // Indicates that the current path has overflowed pcPath.
+    //
+    bool bPathOverflow;
+
+    //
+    // The key or value currently being read, whether it is a key, whether it
+    // has been truncated, and the number of hex digits of a \u escape that
+    // remain to be skipped.
+    //
+    char pcToken[JSON_MAX_TOKEN];
+    uint8_t ui8TokenLen;
+    bool bKey;
+    bool bTokenOverflow;
+    uint8_t ui8HexDigits;
+}
+tJSONParser;
+
+//*****************************************************************************
+//
+// Prototypes for the streaming JSON parser.
+//
+//*****************************************************************************
+struct pbuf;
+extern void JSONParserInit(tJSONParser *psParser,
+                           const tJSONPathHandler *psHandlers,
+                           uint32_t ui32NumHandlers, void *pvCBData);
+extern int32_t JSONParserData(tJSONParser *psParser, const uint8_t *pui8Data,
+                              uint32_t ui32Size);
+extern int32_t JSONParserPbuf(tJSONParser *psParser, struct pbuf *psBuf);
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __JSONPARSE_H__
@@ -180,6 +180,53 @@ extern void lwIPHostTimerHandler(void);
 //*****************************************************************************
 #define LINK_TMR_INTERVAL       10
 
+//*****************************************************************************
+//
+// The default maximum number of received frames handed to lwIP by a single
+// receive poll when adaptive (polled) receive mode is enabled.
+//
+//*****************************************************************************
+#ifndef LWIP_RX_POLL_BUDGET
+#define LWIP_RX_POLL_BUDGET     16
+#endif
+
+//*****************************************************************************
+//
+// The Ethernet MAC receive interrupt sources that are masked while the
+// receive descriptor ring is being polled.
+//
+//*****************************************************************************
+#define LWIP_RX_POLL_INTS       (EMAC_INT_RECEIVE | EMAC_INT_RX_NO_BUFFER)
+
+//*****************************************************************************
+//
+// The number of datagrams received from the USB host that may wait to be
+// handed to lwIP, which must be a power of two, and the number of received
+// datagrams that lwIP may hold in place in the NCM receive buffers.
+//
+//*****************************************************************************
+#if LWIP_USB_NCM
+#ifndef LWIP_USB_NCM_RX_QUEUE
+#define LWIP_USB_NCM_RX_QUEUE   16
+#endif
+#ifndef LWIP_USB_NCM_RX_PBUFS
+#define LWIP_USB_NCM_RX_PBUFS   8
+#endif
+#endif
+
+//*****************************************************************************
+//
+// Datagrams received from the USB host are passed to lwIP in place when lwIP
+// supports custom pbufs and does not expect padding before the Ethernet
+// header.  Otherwise each is copied into a pbuf from the pool.
+//
+//*****************************************************************************
+#if LWIP_USB_NCM && LWIP_SUPPORT_CUSTOM_PBUF && (ETH_PAD_SIZE == 0)
+#define LWIP_USB_NCM_ZERO_COPY  1
+#else
+#define LWIP_USB_NCM_ZERO_COPY  0
+#endif
+
 //*****************************************************************************
 //
 // Set the PHY configuration to the default (internal) option if necessary.
@@ -201,9 +248,16 @@ extern void lwIPHostTimerHandler(void);
 #include "inc/hw_nvic.h"
 #include "driverlib/debug.h"
 #include "driverlib/emac.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/rom.h"
 #include "driverlib/rom_map.h"
 #include "driverlib/sysctl.h"
+#if LWIP_USB_NCM
+#include "usblib/usblib.h"
+#include "usblib/usbcdc.h"
+#include "usblib/device/usbdevice.h"
+#include "usblib/device/usbdncm.h"
+#endif
 #if !NO_SYS
 #if RTOS_FREERTOS
 #include "FreeRTOS.h"
@@ -351,45 +405,663 @@ static bool g_bLinkActive = false;
 
 //*****************************************************************************
 //
-// The IP address to be used.  This is used during the initialization of the
-// stack and when the interface configuration is changed.
+// The IP address to be used.  This is used during the initialization of the
+// stack and when the interface configuration is changed.
+//
+//*****************************************************************************
+static uint32_t g_ui32IPAddr;
+
+//*****************************************************************************
+//
+// The netmask to be used.  This is used during the initialization of the stack
+// and when the interface configuration is changed.
+//
+//*****************************************************************************
+static uint32_t g_ui32NetMask;
+
+//*****************************************************************************
+//
+// The gateway address to be used.  This is used during the initialization of
+// the stack and when the interface configuration is changed.
+//
+//*****************************************************************************
+static uint32_t g_ui32GWAddr;
+
+//*****************************************************************************
+//
+// Adaptive receive mode state.  When g_bRxPollEnable is set, a receive
+// interrupt masks further receive interrupts and sets g_bRxPolling; the
+// receive descriptor ring is then drained in budgeted polls until it is
+// empty, at which point the receive interrupts are unmasked again.
+//
+//*****************************************************************************
+static volatile bool g_bRxPollEnable = false;
+static volatile bool g_bRxPolling = false;
+static uint32_t g_ui32RxPollBudget = LWIP_RX_POLL_BUDGET;
+static bool g_bRxCoalesce = false;
+
+//*****************************************************************************
+//
+// Interrupt and receive polling counters, returned by lwIPRxPollStatsGet().
+//
+//*****************************************************************************
+static tLwIPRxPollStats g_sRxPollStats;
+
+//*****************************************************************************
+//
+// The stack size for the interrupt task.
+//
+//*****************************************************************************
+#if !NO_SYS
+#define STACKSIZE_LWIPINTTASK   128
+#endif
+
+//*****************************************************************************
+//
+// The handle for the "queue" (semaphore) used to signal the interrupt task
+// from the interrupt handler.
+//
+//*****************************************************************************
+#if !NO_SYS
+static xQueueHandle g_pInterrupt;
+#endif
+
+//*****************************************************************************
+//
+// The lwIP network interface structure for the USB NCM device, the NCM
+// device instance it uses and its network configuration.
+//
+//*****************************************************************************
+#if LWIP_USB_NCM
+static struct netif g_sNCMNetIF;
+static void *g_pvNCMDevice;
+static uint8_t g_pui8NCMMAC[6];
+static uint32_t g_ui32NCMIPAddr;
+static uint32_t g_ui32NCMNetMask;
+static uint32_t g_ui32NCMGWAddr;
+static volatile bool g_bNCMNetIFReady = false;
+#endif
+
+//*****************************************************************************
+//
+// The USB link state reported by the NCM device.  g_bNCMLinkChange is set by
+// the USB interrupt and cleared once the change has been passed to lwIP.
+//
+//*****************************************************************************
+#if LWIP_USB_NCM
+static volatile bool g_bNCMLinkUp = false;
+static volatile bool g_bNCMLinkChange = false;
+#endif
+
+//*****************************************************************************
+//
+// Set while the Ethernet interrupt task has been signaled by the USB
+// interrupt but has not yet serviced the NCM interface, so that the signal
+// queue never holds more than one such signal.
+//
+//*****************************************************************************
+#if LWIP_USB_NCM && !NO_SYS
+static volatile bool g_bNCMSignaled = false;
+#endif
+
+//*****************************************************************************
+//
+// The queue of datagrams received by the USB interrupt and waiting to be
+// handed to lwIP.  The read and write indices run freely and are used modulo
+// the queue size.
+//
+//*****************************************************************************
+#if LWIP_USB_NCM
+typedef struct
+{
+    const uint8_t *pui8Datagram;
+    uint32_t ui32Length;
+}
+tNCMRxEntry;
+
+static tNCMRxEntry g_psNCMRxQueue[LWIP_USB_NCM_RX_QUEUE];
+static volatile uint32_t g_ui32NCMRxRead = 0;
+static volatile uint32_t g_ui32NCMRxWrite = 0;
+#endif
+
+//*****************************************************************************
+//
+// The queue of pbufs that the NCM device has finished sending and that are
+// waiting to be freed in the lwIP context.  g_ui32NCMTxQueued counts the
+// pbufs ever passed to the NCM device, so that the number still outstanding,
+// g_ui32NCMTxQueued - g_ui32NCMTxDoneRead, never exceeds the queue size.
+//
+//*****************************************************************************
+#if LWIP_USB_NCM
+static struct pbuf *g_ppsNCMTxDone[USBDNCM_TX_QUEUE_SIZE];
+static volatile uint32_t g_ui32NCMTxDoneRead = 0;
+static volatile uint32_t g_ui32NCMTxDoneWrite = 0;
+static volatile uint32_t g_ui32NCMTxQueued = 0;
+#endif
+
+//*****************************************************************************
+//
+// The custom pbufs used to pass received datagrams to lwIP in place.  Each
+// returns its datagram to the NCM device when lwIP frees it.
+//
+//*****************************************************************************
+#if LWIP_USB_NCM_ZERO_COPY
+typedef struct
+{
+    struct pbuf_custom sPbuf;
+    const uint8_t *pui8Datagram;
+    volatile bool bUsed;
+}
+tNCMRxPbuf;
+
+static tNCMRxPbuf g_psNCMRxPbufs[LWIP_USB_NCM_RX_PBUFS];
+#endif
+
+//*****************************************************************************
+//
+// Marks or unmarks the receive descriptors as not generating a receive
+// interrupt on completion.  Frames received into marked descriptors raise
+// the receive interrupt only when the receive interrupt watchdog expires,
+// allowing the MAC to coalesce a burst of frames into a single interrupt.
+// The descriptor list itself is owned by the Tiva Ethernet interface driver.
+// Descriptors owned by the DMA are left alone, since the DMA may be reading
+// them; they are marked by lwIPRxDescHandBack() as the interface driver
+// refills them.
+//
+//*****************************************************************************
+static void
+lwIPRxDescIntSet(bool bDisable)
+{
+    uint32_t ui32Loop;
+
+    for(ui32Loop = 0; ui32Loop < g_RxDescList.ui32NumDescs; ui32Loop++)
+    {
+        if(g_RxDescList.pDescriptors[ui32Loop].Desc.ui32CtrlStatus &
+           DES0_RX_CTRL_OWN)
+        {
+            continue;
+        }
+
+        if(bDisable)
+        {
+            g_RxDescList.pDescriptors[ui32Loop].Desc.ui32Count |=
+                DES1_RX_CTRL_DISABLE_INT;
+        }
+        else
+        {
+            g_RxDescList.pDescriptors[ui32Loop].Desc.ui32Count &=
+                ~DES1_RX_CTRL_DISABLE_INT;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Marks the receive descriptors that the interface driver has just refilled
+// and handed back to the DMA, from ui32Start up to the driver's new read
+// position, as not generating a receive interrupt.  The driver rewrites the
+// control word of each descriptor that it refills.  These descriptors are
+// behind the DMA's position in the ring, so the DMA does not reach them
+// before they are marked.
+//
+//*****************************************************************************
+static void
+lwIPRxDescHandBack(uint32_t ui32Start, uint32_t ui32Frames)
+{
+    uint32_t ui32Count;
+
+    ui32Count = ((g_RxDescList.ui32Read + g_RxDescList.ui32NumDescs -
+                  ui32Start) % g_RxDescList.ui32NumDescs);
+    if((ui32Count == 0) && ui32Frames)
+    {
+        ui32Count = g_RxDescList.ui32NumDescs;
+    }
+
+    while(ui32Count--)
+    {
+        g_RxDescList.pDescriptors[ui32Start].Desc.ui32Count |=
+            DES1_RX_CTRL_DISABLE_INT;
+        ui32Start = (ui32Start + 1) % g_RxDescList.ui32NumDescs;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the number of complete received frames that are waiting in the
+// receive descriptor ring, starting from the driver's current read position.
+//
+//*****************************************************************************
+static uint32_t
+lwIPRxFramesReady(void)
+{
+    uint32_t ui32Index, ui32Loop, ui32Frames, ui32Status;
+
+    ui32Frames = 0;
+    ui32Index = g_RxDescList.ui32Read;
+
+    for(ui32Loop = 0; ui32Loop < g_RxDescList.ui32NumDescs; ui32Loop++)
+    {
+        ui32Status = g_RxDescList.pDescriptors[ui32Index].Desc.ui32CtrlStatus;
+
+        //
+        // Stop at the first descriptor still owned by the DMA.
+        //
+        if(ui32Status & DES0_RX_CTRL_OWN)
+        {
+            break;
+        }
+
+        //
+        // Count the frame when its last descriptor is found.
+        //
+        if(ui32Status & DES0_RX_STAT_LAST_DESC)
+        {
+            ui32Frames++;
+        }
+
+        ui32Index++;
+        if(ui32Index == g_RxDescList.ui32NumDescs)
+        {
+            ui32Index = 0;
+        }
+    }
+
+    return(ui32Frames);
+}
+
+//*****************************************************************************
+//
+// Drains the receive descriptor ring, handing at most the configured budget
+// of frames to lwIP (rounded up to whole passes over the ring).  If the ring
+// is empty once the budget has been used, polling mode is left and the caller
+// is responsible for unmasking the receive interrupts; otherwise polling mode
+// remains active and the next poll is made from the next lwIP timer event
+// (without an RTOS) or the next tick of the Ethernet interrupt task (with an
+// RTOS).
+//
+//*****************************************************************************
+static void
+lwIPRxPoll(void)
+{
+    uint32_t ui32Frames, ui32Ready, ui32Read;
+
+    ui32Frames = 0;
+    g_sRxPollStats.ui32Polls++;
+
+    while(ui32Frames < g_ui32RxPollBudget)
+    {
+        ui32Ready = lwIPRxFramesReady();
+        if(ui32Ready == 0)
+        {
+            break;
+        }
+
+        ui32Read = g_RxDescList.ui32Read;
+        tivaif_interrupt(&g_sNetIF, EMAC_INT_RECEIVE);
+        ui32Frames += ui32Ready;
+
+        //
+        // The interface driver has rewritten the control word of the
+        // descriptors it refilled, so mark them again if coalescing.
+        //
+        if(g_bRxCoalesce)
+        {
+            lwIPRxDescHandBack(ui32Read, ui32Ready);
+        }
+    }
+
+    //
+    // Restart the receive DMA in case it suspended for lack of descriptors
+    // while the receive interrupts were masked.
+    //
+    MAP_EMACRxDMAPollDemand(EMAC0_BASE);
+
+    //
+    // Update the frame counters.
+    //
+    g_sRxPollStats.ui32Frames += ui32Frames;
+    if(ui32Frames > g_sRxPollStats.ui32MaxFramesPerPoll)
+    {
+        g_sRxPollStats.ui32MaxFramesPerPoll = ui32Frames;
+    }
+
+    //
+    // Clear any receive interrupt raised by the frames just handled before
+    // checking the ring for the last time.  A frame that completes after this
+    // check raises the interrupt again once it is unmasked.
+    //
+    MAP_EMACIntClear(EMAC0_BASE, LWIP_RX_POLL_INTS);
+
+    if(lwIPRxFramesReady())
+    {
+        g_sRxPollStats.ui32BudgetExhausted++;
+    }
+    else
+    {
+        g_bRxPolling = false;
+    }
+}
+
+#if LWIP_USB_NCM
+//*****************************************************************************
+//
+// Arranges for the NCM interface to be serviced in the lwIP context.  This is
+// called from the USB interrupt.  Without an RTOS, the Ethernet interrupt is
+// triggered as it is by lwIPTimer(); with an RTOS, the Ethernet interrupt
+// task is signaled.
+//
+//*****************************************************************************
+static void
+lwIPUSBNCMSignal(void)
+{
+#if NO_SYS
+    HWREG(NVIC_SW_TRIG) |= INT_EMAC0 - 16;
+#else
+    portBASE_TYPE xWake;
+    uint32_t ui32Status;
+
+    if(g_bNCMSignaled)
+    {
+        return;
+    }
+
+    g_bNCMSignaled = true;
+    ui32Status = 0;
+    xWake = pdFALSE;
+    xQueueSendFromISR(g_pInterrupt, (void *)&ui32Status, &xWake);
+
+#if RTOS_FREERTOS
+    if(xWake == pdTRUE)
+    {
+        portYIELD_FROM_ISR(true);
+    }
+#endif
+#endif
+}
+
+//*****************************************************************************
+//
+// Returns a datagram to the NCM device once lwIP has freed the custom pbuf
+// that carried it.
+//
+//*****************************************************************************
+#if LWIP_USB_NCM_ZERO_COPY
+static void
+lwIPUSBNCMPbufFree(struct pbuf *p)
+{
+    tNCMRxPbuf *psRxPbuf;
+
+    psRxPbuf = (tNCMRxPbuf *)p;
+
+    USBDNCMRxDatagramRelease(g_pvNCMDevice, psRxPbuf->pui8Datagram);
+    psRxPbuf->bUsed = false;
+}
+#endif
+
+//*****************************************************************************
+//
+// Wraps a datagram received from the USB host in a pbuf.  The datagram is
+// referenced in place if a custom pbuf is free; otherwise it is copied into a
+// pbuf from the pool and returned to the NCM device at once.  lwIP may hold
+// a pbuf for a long time, for example in the TCP out of sequence queue, and
+// while it does the NTB buffer holding the datagram cannot be reused.  The
+// datagram is therefore also copied when no more than one NTB buffer is
+// free, so that there is always a buffer to receive the next NTB into.
+//
+//*****************************************************************************
+static struct pbuf *
+lwIPUSBNCMPbufGet(const uint8_t *pui8Datagram, uint32_t ui32Length)
+{
+    struct pbuf *p;
+#if LWIP_USB_NCM_ZERO_COPY
+    uint32_t ui32Loop;
+
+    if(USBDNCMRxBuffersFree(g_pvNCMDevice) > 1)
+    {
+        for(ui32Loop = 0; ui32Loop < LWIP_USB_NCM_RX_PBUFS; ui32Loop++)
+        {
+            if(!g_psNCMRxPbufs[ui32Loop].bUsed)
+            {
+                g_psNCMRxPbufs[ui32Loop].bUsed = true;
+                g_psNCMRxPbufs[ui32Loop].pui8Datagram = pui8Datagram;
+                g_psNCMRxPbufs[ui32Loop].sPbuf.custom_free_function =
+                    lwIPUSBNCMPbufFree;
+
+                return(pbuf_alloced_custom(PBUF_RAW, (u16_t)ui32Length,
+                                           PBUF_REF,
+                                           &g_psNCMRxPbufs[ui32Loop].sPbuf,
+                                           (void *)pui8Datagram,
+                                           (u16_t)ui32Length));
+            }
+        }
+    }
+#endif
+
+    p = pbuf_alloc(PBUF_RAW, (u16_t)(ui32Length + ETH_PAD_SIZE), PBUF_POOL);
+    if(p)
+    {
+#if ETH_PAD_SIZE
+        pbuf_header(p, -ETH_PAD_SIZE);
+#endif
+        pbuf_take(p, pui8Datagram, (u16_t)ui32Length);
+#if ETH_PAD_SIZE
+        pbuf_header(p, ETH_PAD_SIZE);
+#endif
+    }
+
+    USBDNCMRxDatagramRelease(g_pvNCMDevice, pui8Datagram);
+
+    return(p);
+}
+
+//*****************************************************************************
+//
+// Applies a change in the USB link state to the NCM interface.  This is
+// directly called when not using a RTOS and provided as a callback to the
+// TCP/IP thread when using a RTOS.
+//
+//*****************************************************************************
+static void
+lwIPUSBNCMPrivateLink(void *pvArg)
+{
+    if((uint32_t)pvArg)
+    {
+        netif_set_link_up(&g_sNCMNetIF);
+    }
+    else
+    {
+        netif_set_link_down(&g_sNCMNetIF);
+    }
+}
+
+//*****************************************************************************
+//
+// Services the NCM interface in the lwIP context.  Pbufs that have been sent
+// are freed, link changes are passed on and received datagrams are handed to
+// lwIP.
+//
+//*****************************************************************************
+static void
+lwIPUSBNCMService(void)
+{
+    struct pbuf *p;
+    tNCMRxEntry *psEntry;
+    const uint8_t *pui8Datagram;
+    uint32_t ui32Length;
+    bool bLinkUp;
+
+#if !NO_SYS
+    g_bNCMSignaled = false;
+#endif
+
+    //
+    // Free the pbufs that have been sent.
+    //
+    while(g_ui32NCMTxDoneRead != g_ui32NCMTxDoneWrite)
+    {
+        p = g_ppsNCMTxDone[g_ui32NCMTxDoneRead % USBDNCM_TX_QUEUE_SIZE];
+        g_ui32NCMTxDoneRead++;
+        pbuf_free(p);
+    }
+
+    //
+    // Pass on any change in the link state once the interface exists.
+    //
+    if(g_bNCMNetIFReady && g_bNCMLinkChange)
+    {
+        g_bNCMLinkChange = false;
+        bLinkUp = g_bNCMLinkUp;
+#if NO_SYS
+        lwIPUSBNCMPrivateLink((void *)(uint32_t)bLinkUp);
+#else
+        tcpip_callback(lwIPUSBNCMPrivateLink, (void *)(uint32_t)bLinkUp);
+#endif
+    }
+
+    //
+    // Hand the received datagrams to lwIP.
+    //
+    while(g_ui32NCMRxRead != g_ui32NCMRxWrite)
+    {
+        psEntry = &g_psNCMRxQueue[g_ui32NCMRxRead % LWIP_USB_NCM_RX_QUEUE];
+        pui8Datagram = psEntry->pui8Datagram;
+        ui32Length = psEntry->ui32Length;
+        g_ui32NCMRxRead++;
+
+        if(!g_bNCMNetIFReady)
+        {
+            USBDNCMRxDatagramRelease(g_pvNCMDevice, pui8Datagram);
+            continue;
+        }
+
+        p = lwIPUSBNCMPbufGet(pui8Datagram, ui32Length);
+        if(p == 0)
+        {
+            LINK_STATS_INC(link.memerr);
+            LINK_STATS_INC(link.drop);
+            continue;
+        }
+
+        LINK_STATS_INC(link.recv);
+
+#if NO_SYS
+        if(ethernet_input(p, &g_sNCMNetIF) != ERR_OK)
+#else
+        if(g_sNCMNetIF.input(p, &g_sNCMNetIF) != ERR_OK)
+#endif
+        {
+            pbuf_free(p);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Sends an Ethernet frame on the NCM interface.  The pbuf is referenced
+// rather than copied and is freed once the NCM device has sent it.
 //
 //*****************************************************************************
-static uint32_t g_ui32IPAddr;
+static err_t
+lwIPUSBNCMLinkOutput(struct netif *psNetif, struct pbuf *p)
+{
+    //
+    // Refuse the frame if as many frames as the NCM device can queue are
+    // already outstanding.
+    //
+    if((g_ui32NCMTxQueued - g_ui32NCMTxDoneRead) >= USBDNCM_TX_QUEUE_SIZE)
+    {
+        LINK_STATS_INC(link.drop);
+        return(ERR_MEM);
+    }
 
-//*****************************************************************************
-//
-// The netmask to be used.  This is used during the initialization of the stack
-// and when the interface configuration is changed.
-//
-//*****************************************************************************
-static uint32_t g_ui32NetMask;
+    pbuf_ref(p);
+    g_ui32NCMTxQueued++;
 
-//*****************************************************************************
-//
-// The gateway address to be used.  This is used during the initialization of
-// the stack and when the interface configuration is changed.
-//
-//*****************************************************************************
-static uint32_t g_ui32GWAddr;
+    if(!USBDNCMFrameWrite(g_pvNCMDevice, (void *)p,
+                          p->tot_len - ETH_PAD_SIZE))
+    {
+        g_ui32NCMTxQueued--;
+        pbuf_free(p);
+        LINK_STATS_INC(link.drop);
+        return(ERR_IF);
+    }
+
+    LINK_STATS_INC(link.xmit);
+
+    return(ERR_OK);
+}
 
 //*****************************************************************************
 //
-// The stack size for the interrupt task.
+// Initializes the lwIP network interface structure for the NCM interface.
 //
 //*****************************************************************************
-#if !NO_SYS
-#define STACKSIZE_LWIPINTTASK   128
+static err_t
+lwIPUSBNCMNetIFInit(struct netif *psNetif)
+{
+    uint32_t ui32Loop;
+
+    psNetif->name[0] = 'u';
+    psNetif->name[1] = 'n';
+    psNetif->output = etharp_output;
+    psNetif->linkoutput = lwIPUSBNCMLinkOutput;
+
+    psNetif->hwaddr_len = ETHARP_HWADDR_LEN;
+    for(ui32Loop = 0; ui32Loop < ETHARP_HWADDR_LEN; ui32Loop++)
+    {
+        psNetif->hwaddr[ui32Loop] = g_pui8NCMMAC[ui32Loop];
+    }
+
+    //
+    // The largest frame excludes the 14 byte Ethernet header.
+    //
+    psNetif->mtu = USBDNCM_MAX_SEGMENT_SIZE - 14;
+    psNetif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+#if LWIP_IGMP
+    psNetif->flags |= NETIF_FLAG_IGMP;
 #endif
 
+    return(ERR_OK);
+}
+
 //*****************************************************************************
 //
-// The handle for the "queue" (semaphore) used to signal the interrupt task
-// from the interrupt handler.
+// Completes the initialization of the NCM interface.  This is directly called
+// when not using a RTOS and provided as a callback to the TCP/IP thread when
+// using a RTOS.
 //
 //*****************************************************************************
-#if !NO_SYS
-static xQueueHandle g_pInterrupt;
+static void
+lwIPUSBNCMPrivateInit(void *pvArg)
+{
+    struct ip_addr ip_addr;
+    struct ip_addr net_mask;
+    struct ip_addr gw_addr;
+
+    ip_addr.addr = htonl(g_ui32NCMIPAddr);
+    net_mask.addr = htonl(g_ui32NCMNetMask);
+    gw_addr.addr = htonl(g_ui32NCMGWAddr);
+
+    //
+    // Add the NCM interface alongside the Ethernet controller interface,
+    // which remains the default.
+    //
+#if NO_SYS
+    netif_add(&g_sNCMNetIF, &ip_addr, &net_mask, &gw_addr, NULL,
+              lwIPUSBNCMNetIFInit, ip_input);
+#else
+    netif_add(&g_sNCMNetIF, &ip_addr, &net_mask, &gw_addr, NULL,
+              lwIPUSBNCMNetIFInit, tcpip_input);
+#endif
+
+    //
+    // Bring the interface up with the current link state.  A later change of
+    // the link state is passed on once g_bNCMNetIFReady is set.
+    //
+    netif_set_up(&g_sNCMNetIF);
+    lwIPUSBNCMPrivateLink((void *)(uint32_t)g_bNCMLinkUp);
+    g_bNCMNetIFReady = true;
+}
 #endif
 
 //*****************************************************************************
@@ -402,30 +1074,68 @@ static xQueueHandle g_pInterrupt;
 static void
 lwIPInterruptTask(void *pvArg)
 {
+    uint32_t ui32Ints;
+
     //
     // Loop forever.
     //
     while(1)
     {
         //
-        // Wait until the semaphore has been signaled.
+        // Wait until the semaphore has been signaled.  While the receive ring
+        // is being polled, wake up every tick to continue draining it even if
+        // no further interrupt is signaled.
         //
-        while(xQueueReceive(g_pInterrupt, &pvArg, portMAX_DELAY) != pdPASS)
+        if(g_bRxPolling)
+        {
+            if(xQueueReceive(g_pInterrupt, &pvArg, 1) != pdPASS)
+            {
+                pvArg = 0;
+            }
+        }
+        else
         {
+            while(xQueueReceive(g_pInterrupt, &pvArg, portMAX_DELAY) !=
+                  pdPASS)
+            {
+            }
         }
 
         //
         // Processes any packets waiting to be sent or received.
         //
-        tivaif_interrupt(&g_sNetIF, (uint32_t)pvArg);
+        if((uint32_t)pvArg)
+        {
+            tivaif_interrupt(&g_sNetIF, (uint32_t)pvArg);
+        }
+
+        //
+        // Service the USB NCM interface.
+        //
+#if LWIP_USB_NCM
+        lwIPUSBNCMService();
+#endif
+
+        //
+        // Drain the receive ring if it is being polled.
+        //
+        if(g_bRxPolling)
+        {
+            lwIPRxPoll();
+        }
 
         //
-        // Re-enable the Ethernet interrupts.
+        // Re-enable the Ethernet interrupts, leaving the receive interrupts
+        // masked if the receive ring still needs to be polled.
         //
-        MAP_EMACIntEnable(EMAC0_BASE, (EMAC_INT_RECEIVE | EMAC_INT_TRANSMIT |
-                                       EMAC_INT_TX_STOPPED |
-                                       EMAC_INT_RX_NO_BUFFER |
-                                       EMAC_INT_RX_STOPPED | EMAC_INT_PHY));
+        ui32Ints = (EMAC_INT_RECEIVE | EMAC_INT_TRANSMIT |
+                    EMAC_INT_TX_STOPPED | EMAC_INT_RX_NO_BUFFER |
+                    EMAC_INT_RX_STOPPED | EMAC_INT_PHY);
+        if(g_bRxPolling)
+        {
+            ui32Ints &= ~LWIP_RX_POLL_INTS;
+        }
+        MAP_EMACIntEnable(EMAC0_BASE, ui32Ints);
     }
 }
 #endif
@@ -534,6 +1244,26 @@ lwIPLinkDetect(void)
 static void
 lwIPServiceTimers(void)
 {
+    //
+    // Service the USB NCM interface.
+    //
+#if LWIP_USB_NCM
+    lwIPUSBNCMService();
+#endif
+
+    //
+    // Continue draining the receive ring if it is being polled, and unmask the
+    // receive interrupts once it is empty.
+    //
+    if(g_bRxPolling)
+    {
+        lwIPRxPoll();
+        if(!g_bRxPolling)
+        {
+            MAP_EMACIntEnable(EMAC0_BASE, LWIP_RX_POLL_INTS);
+        }
+    }
+
     //
     // Service the host timer.
     //
@@ -715,8 +1445,16 @@ lwIPPrivateInit(void *pvArg)
     //
 #if !NO_SYS
 #if RTOS_FREERTOS
+#if LWIP_USB_NCM
+    //
+    // Leave room for a signal from the USB interrupt alongside the Ethernet
+    // interrupt status.
+    //
+    g_pInterrupt = xQueueCreate(2, sizeof(void *));
+#else
     g_pInterrupt = xQueueCreate(1, sizeof(void *));
 #endif
+#endif
 #endif
 
     //
@@ -878,7 +1616,13 @@ lwIPInit(uint32_t ui32SysClkHz, const uint8_t *pui8MAC, uint32_t ui32IPAddr,
                  4, 4, 0);
 
     //
-    // Set MAC configuration options.
+    // Set MAC configuration options.  Checksum offload causes the MAC to
+    // verify the IP, TCP, UDP and ICMP checksums of received frames, while the
+    // interface driver transmits each pbuf of an outgoing chain from its own
+    // DMA descriptor and requests checksum insertion on every frame.  The
+    // application's lwipopts.h should therefore set the CHECKSUM_GEN_* and
+    // CHECKSUM_CHECK_* options to 0 so that lwIP does not repeat this work in
+    // software.
     //
     MAP_EMACConfigSet(EMAC0_BASE, (EMAC_CONFIG_FULL_DUPLEX |
                                    EMAC_CONFIG_CHECKSUM_OFFLOAD |
@@ -1016,6 +1760,7 @@ lwIPEthernetIntHandler(void)
     // Read and Clear the interrupt.
     //
     ui32Status = EMACIntStatus(EMAC0_BASE, true);
+    g_sRxPollStats.ui32Interrupts++;
 
 #if EEE_SUPPORT
     if(ui32Status & EMAC_INT_LPI)
@@ -1067,6 +1812,20 @@ lwIPEthernetIntHandler(void)
         }
     }
 
+    //
+    // In adaptive receive mode, a receive interrupt masks further receive
+    // interrupts and switches to polling the receive descriptor ring.  The
+    // receive events are then handled by the poll rather than by the
+    // low-level interrupt handler.
+    //
+    if(g_bRxPollEnable && (ui32Status & LWIP_RX_POLL_INTS))
+    {
+        MAP_EMACIntDisable(EMAC0_BASE, LWIP_RX_POLL_INTS);
+        ui32Status &= ~LWIP_RX_POLL_INTS;
+        g_sRxPollStats.ui32RxInterrupts++;
+        g_bRxPolling = true;
+    }
+
     //
     // The handling of the interrupt is different based on the use of a RTOS.
     //
@@ -1081,7 +1840,8 @@ lwIPEthernetIntHandler(void)
     }
 
     //
-    // Service the lwIP timers.
+    // Service the lwIP timers.  This also performs the receive poll, if one
+    // is pending.
     //
     lwIPServiceTimers();
 #else
@@ -1112,6 +1872,124 @@ lwIPEthernetIntHandler(void)
 #endif
 }
 
+//*****************************************************************************
+//
+//! Configures adaptive (polled) receive mode for the Ethernet interface.
+//!
+//! \param bEnable is \b true to enable adaptive receive mode or \b false to
+//! return to handling every receive event in the Ethernet interrupt.
+//! \param ui32Budget is the maximum number of received frames handed to lwIP
+//! by a single poll of the receive descriptor ring, or 0 to use the default
+//! of \b LWIP_RX_POLL_BUDGET.
+//! \param ui8RxWatchdog is the receive interrupt watchdog timeout, expressed
+//! as a number of 256 system clock periods, or 0 to disable hardware
+//! interrupt coalescing.
+//!
+//! In adaptive receive mode, the first receive interrupt masks the Ethernet
+//! receive interrupts and switches to polling the receive descriptor ring.
+//! Each poll hands at most \e ui32Budget frames to lwIP; a poll that leaves
+//! frames in the ring is repeated from the next lwIP timer event (see
+//! lwIPTimer()) when no RTOS is used, or from the next tick of the Ethernet
+//! interrupt task when an RTOS is used.  Once a poll finds the ring empty,
+//! the receive interrupts are unmasked again.  Under a packet flood this
+//! bounds the time spent processing received frames per timer period and
+//! allows the application's main loop to continue running.
+//!
+//! The budget is checked between passes over the receive ring, so a poll may
+//! hand up to one ring's worth of frames (\b NUM_RX_DESCRIPTORS) more than
+//! \e ui32Budget to lwIP.
+//!
+//! If \e ui8RxWatchdog is non-zero, the receive descriptors are marked so
+//! that completed frames do not raise a receive interrupt directly; instead,
+//! the MAC's receive interrupt watchdog (see EMACRxWatchdogTimerSet()) raises
+//! a single interrupt once it expires, coalescing a burst of frames.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+lwIPRxPollingConfigSet(bool bEnable, uint32_t ui32Budget,
+                       uint8_t ui8RxWatchdog)
+{
+    //
+    // Hold off the Ethernet interrupt while the configuration is changed.
+    //
+    MAP_IntDisable(INT_EMAC0);
+
+    //
+    // Save the new poll budget.
+    //
+    g_ui32RxPollBudget = ui32Budget ? ui32Budget : LWIP_RX_POLL_BUDGET;
+
+    //
+    // Set up hardware coalescing using the receive interrupt watchdog.
+    //
+    // The watchdog is left running when coalescing is turned off, since
+    // descriptors owned by the DMA keep their mark until they are refilled.
+    // It has no effect on frames received into unmarked descriptors.
+    //
+    g_bRxCoalesce = (bEnable && ui8RxWatchdog) ? true : false;
+    lwIPRxDescIntSet(g_bRxCoalesce);
+    if(g_bRxCoalesce)
+    {
+        MAP_EMACRxWatchdogTimerSet(EMAC0_BASE, ui8RxWatchdog);
+    }
+
+    //
+    // Enable or disable adaptive receive mode.  If polling is in progress
+    // when the mode is disabled, finish it by unmasking the receive
+    // interrupts so that any remaining frames are handled in the interrupt.
+    //
+    g_bRxPollEnable = bEnable;
+    if(!bEnable && g_bRxPolling)
+    {
+        g_bRxPolling = false;
+        MAP_EMACIntEnable(EMAC0_BASE, LWIP_RX_POLL_INTS);
+    }
+
+    MAP_IntEnable(INT_EMAC0);
+}
+
+//*****************************************************************************
+//
+//! Returns the Ethernet interrupt and receive polling counters.
+//!
+//! \param psStats points to a structure that receives the current counters.
+//! \param bClear is \b true if the counters are to be reset after they are
+//! read.
+//!
+//! This function returns the number of Ethernet interrupts taken, the number
+//! of those that switched to receive polling, the number of receive polls
+//! performed, and the number of frames handed to lwIP by those polls.  The
+//! average number of packets per poll is \e ui32Frames divided by
+//! \e ui32Polls.  The counters are updated only while adaptive receive mode
+//! is enabled, except for \e ui32Interrupts which is always maintained.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+lwIPRxPollStatsGet(tLwIPRxPollStats *psStats, bool bClear)
+{
+    ASSERT(psStats);
+
+    MAP_IntDisable(INT_EMAC0);
+
+    *psStats = g_sRxPollStats;
+
+    if(bClear)
+    {
+        g_sRxPollStats.ui32Interrupts = 0;
+        g_sRxPollStats.ui32RxInterrupts = 0;
+        g_sRxPollStats.ui32Polls = 0;
+        g_sRxPollStats.ui32Frames = 0;
+        g_sRxPollStats.ui32MaxFramesPerPoll = 0;
+        g_sRxPollStats.ui32BudgetExhausted = 0;
+    }
+
+    MAP_IntEnable(INT_EMAC0);
+}
+
 //*****************************************************************************
 //
 //! Returns the IP address for this interface.
@@ -1414,6 +2292,208 @@ lwIPNetworkConfigChange(uint32_t ui32IPAddr, uint32_t ui32NetMask,
 #endif
 }
 
+#if LWIP_USB_NCM
+//*****************************************************************************
+//
+//! Adds a network interface for a USB CDC NCM device.
+//!
+//! \param pvNCMDevice is the NCM device instance returned by USBDNCMInit() or
+//! USBDNCMCompositeInit().
+//! \param pui8MAC is a pointer to a six byte array containing the MAC
+//! address to be used for the interface.  This should differ from the MAC
+//! address given to the USB host in the NCM device's MAC address string.
+//! \param ui32IPAddr is the IP address to be used (static).
+//! \param ui32NetMask is the network mask to be used (static).
+//! \param ui32GWAddr is the Gateway address to be used (static).
+//!
+//! This function adds a second lwIP network interface, alongside the Ethernet
+//! controller interface, that exchanges Ethernet frames with the USB host
+//! through the NCM device.  It must be called after lwIPInit(), since the
+//! interface is serviced in the same lwIP context as the Ethernet controller.
+//! The NCM device must be given lwIPUSBNCMRxHandler() and
+//! lwIPUSBNCMTxHandler() as its receive and transmit callbacks and
+//! lwIPUSBNCMFrameData() as its frame data function.
+//!
+//! Outgoing pbufs are queued on the NCM device without being copied.
+//! Received datagrams are passed to lwIP in place using custom pbufs when
+//! lwIP supports them (\b LWIP_SUPPORT_CUSTOM_PBUF) and \b ETH_PAD_SIZE is 0,
+//! up to \b LWIP_USB_NCM_RX_PBUFS at once.  Otherwise they are copied into
+//! pbufs from the pool.  The interface uses static addressing and its link is
+//! up while the USB host has the NCM data interface enabled.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+lwIPUSBNCMInit(void *pvNCMDevice, const uint8_t *pui8MAC, uint32_t ui32IPAddr,
+               uint32_t ui32NetMask, uint32_t ui32GWAddr)
+{
+    uint32_t ui32Loop;
+
+    ASSERT(pvNCMDevice);
+    ASSERT(pui8MAC);
+
+    //
+    // Save the configuration for later use by the private initialization.
+    //
+    g_pvNCMDevice = pvNCMDevice;
+    for(ui32Loop = 0; ui32Loop < 6; ui32Loop++)
+    {
+        g_pui8NCMMAC[ui32Loop] = pui8MAC[ui32Loop];
+    }
+    g_ui32NCMIPAddr = ui32IPAddr;
+    g_ui32NCMNetMask = ui32NetMask;
+    g_ui32NCMGWAddr = ui32GWAddr;
+
+    //
+    // Add the interface.  This is done immediately if not using a RTOS and it
+    // is deferred to the TCP/IP thread's context if using a RTOS.
+    //
+#if NO_SYS
+    lwIPUSBNCMPrivateInit(0);
+#else
+    tcpip_callback(lwIPUSBNCMPrivateInit, 0);
+#endif
+}
+
+//*****************************************************************************
+//
+//! Handles receive events from the USB CDC NCM device.
+//!
+//! \param pvCBData is the callback pointer given to the NCM device.
+//! \param ui32Event identifies the event.
+//! \param ui32MsgValue is an event-specific value.
+//! \param pvMsgData is an event-specific pointer.
+//!
+//! This function is to be used as the NCM device's receive callback.  It is
+//! called in the USB interrupt and queues each received datagram and link
+//! change to be handled in the lwIP context.  A datagram that arrives while
+//! \b LWIP_USB_NCM_RX_QUEUE datagrams are already waiting is dropped.
+//!
+//! \return Returns 0.
+//
+//*****************************************************************************
+uint32_t
+lwIPUSBNCMRxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
+                    void *pvMsgData)
+{
+    tNCMRxEntry *psEntry;
+
+    switch(ui32Event)
+    {
+        case USB_EVENT_RX_AVAILABLE:
+        {
+            if((g_ui32NCMRxWrite - g_ui32NCMRxRead) >= LWIP_USB_NCM_RX_QUEUE)
+            {
+                USBDNCMRxDatagramRelease(g_pvNCMDevice,
+                                         (const uint8_t *)pvMsgData);
+                break;
+            }
+
+            psEntry =
+                &g_psNCMRxQueue[g_ui32NCMRxWrite % LWIP_USB_NCM_RX_QUEUE];
+            psEntry->pui8Datagram = (const uint8_t *)pvMsgData;
+            psEntry->ui32Length = ui32MsgValue;
+            g_ui32NCMRxWrite++;
+
+            lwIPUSBNCMSignal();
+            break;
+        }
+
+        case USB_EVENT_CONNECTED:
+        case USB_EVENT_DISCONNECTED:
+        {
+            g_bNCMLinkUp = (ui32Event == USB_EVENT_CONNECTED) ? true : false;
+            g_bNCMLinkChange = true;
+
+            lwIPUSBNCMSignal();
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Handles transmit events from the USB CDC NCM device.
+//!
+//! \param pvCBData is the callback pointer given to the NCM device.
+//! \param ui32Event identifies the event.
+//! \param ui32MsgValue is an event-specific value.
+//! \param pvMsgData is an event-specific pointer.
+//!
+//! This function is to be used as the NCM device's transmit callback.  It is
+//! called in the USB interrupt and queues each pbuf that the NCM device has
+//! finished with to be freed in the lwIP context.
+//!
+//! \return Returns 0.
+//
+//*****************************************************************************
+uint32_t
+lwIPUSBNCMTxHandler(void *pvCBData, uint32_t ui32Event, uint32_t ui32MsgValue,
+                    void *pvMsgData)
+{
+    if(ui32Event == USB_EVENT_TX_COMPLETE)
+    {
+        g_ppsNCMTxDone[g_ui32NCMTxDoneWrite % USBDNCM_TX_QUEUE_SIZE] =
+            (struct pbuf *)pvMsgData;
+        g_ui32NCMTxDoneWrite++;
+
+        lwIPUSBNCMSignal();
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Finds the data of an outgoing frame for the USB CDC NCM device.
+//!
+//! \param pvCBData is the callback pointer given to the NCM device.
+//! \param pvFrame is the pbuf holding the frame.
+//! \param ui32Offset is the offset within the frame of the data required.
+//! \param ppui8Data is written with a pointer to the data.
+//!
+//! This function is to be used as the NCM device's frame data function.  It
+//! walks the pbuf chain so that the NCM device can copy a frame held in
+//! several pbufs straight to the USB FIFO.
+//!
+//! \return Returns the number of contiguous bytes at \e ppui8Data, or 0 if
+//! \e ui32Offset is beyond the end of the frame.
+//
+//*****************************************************************************
+uint32_t
+lwIPUSBNCMFrameData(void *pvCBData, void *pvFrame, uint32_t ui32Offset,
+                    const uint8_t **ppui8Data)
+{
+    struct pbuf *p;
+
+    p = (struct pbuf *)pvFrame;
+    ui32Offset += ETH_PAD_SIZE;
+
+    while(p && (ui32Offset >= p->len))
+    {
+        ui32Offset -= p->len;
+        p = p->next;
+    }
+
+    if(p == 0)
+    {
+        return(0);
+    }
+
+    *ppui8Data = (const uint8_t *)p->payload + ui32Offset;
+
+    return(p->len - ui32Offset);
+}
+#endif
+
 //*****************************************************************************
 //
 // Close the Doxygen group.
@@ -51,12 +51,23 @@ extern "C"
 #undef LWIP_DHCP_AUTOIP_COOP
 #define LWIP_DHCP_AUTOIP_COOP   ((LWIP_DHCP) && (LWIP_AUTOIP))
 
+//*****************************************************************************
+//
+// Set LWIP_USB_NCM to 1 in lwipopts.h to add a second network interface that
+// carries Ethernet frames to a USB host through the USB CDC NCM device class.
+//
+//*****************************************************************************
+#ifndef LWIP_USB_NCM
+#define LWIP_USB_NCM            0
+#endif
+
 //*****************************************************************************
 //
 // lwIP API Header Files
 //
 //*****************************************************************************
 #include <stdint.h>
+#include <stdbool.h>
 #include "lwip/api.h"
 #include "lwip/netifapi.h"
 #include "lwip/tcp.h"
@@ -90,6 +101,49 @@ extern "C"
 typedef void (* tHardwareTimerHandler)(uint32_t ui32Base,
                                        uint32_t ui32IntStatus);
 
+//*****************************************************************************
+//
+// Ethernet interrupt and adaptive receive polling counters, as returned by
+// lwIPRxPollStatsGet().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The number of Ethernet interrupts taken, including those triggered by
+    // lwIPTimer() when no RTOS is used.
+    //
+    uint32_t ui32Interrupts;
+
+    //
+    // The number of receive interrupts that masked the receive interrupts and
+    // switched to polling the receive descriptor ring.
+    //
+    uint32_t ui32RxInterrupts;
+
+    //
+    // The number of receive polls performed.
+    //
+    uint32_t ui32Polls;
+
+    //
+    // The number of frames handed to lwIP by receive polls.
+    //
+    uint32_t ui32Frames;
+
+    //
+    // The largest number of frames handed to lwIP by a single receive poll.
+    //
+    uint32_t ui32MaxFramesPerPoll;
+
+    //
+    // The number of receive polls that used their whole budget and left
+    // frames in the receive descriptor ring for the next poll.
+    //
+    uint32_t ui32BudgetExhausted;
+}
+tLwIPRxPollStats;
+
 //*****************************************************************************
 //
 // lwIP Abstraction Layer API
@@ -108,6 +162,21 @@ extern void lwIPLocalMACGet(uint8_t *pui8Mac);
 extern void lwIPNetworkConfigChange(uint32_t ui32IPAddr, uint32_t ui32NetMask,
                                     uint32_t ui32GWAddr, uint32_t ui32IPMode);
 extern uint32_t lwIPAcceptUDPPort(uint16_t ui16Port);
+extern void lwIPRxPollingConfigSet(bool bEnable, uint32_t ui32Budget,
+                                   uint8_t ui8RxWatchdog);
+extern void lwIPRxPollStatsGet(tLwIPRxPollStats *psStats, bool bClear);
+#if LWIP_USB_NCM
+extern void lwIPUSBNCMInit(void *pvNCMDevice, const uint8_t *pui8MAC,
+                           uint32_t ui32IPAddr, uint32_t ui32NetMask,
+                           uint32_t ui32GWAddr);
+extern uint32_t lwIPUSBNCMRxHandler(void *pvCBData, uint32_t ui32Event,
+                                    uint32_t ui32MsgValue, void *pvMsgData);
+extern uint32_t lwIPUSBNCMTxHandler(void *pvCBData, uint32_t ui32Event,
+                                    uint32_t ui32MsgValue, void *pvMsgData);
+extern uint32_t lwIPUSBNCMFrameData(void *pvCBData, void *pvFrame,
+                                    uint32_t ui32Offset,
+                                    const uint8_t **ppui8Data);
+#endif
 
 //*****************************************************************************
 //
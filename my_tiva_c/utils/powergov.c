@@ -0,0 +1,443 @@
+//*****************************************************************************
+//
+// powergov.c - Frequency and power mode governor.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "utils/clocktree.h"
+#include "utils/cpu_usage.h"
+#include "utils/powergov.h"
+#include "utils/scheduler.h"
+
+//*****************************************************************************
+//
+//! \addtogroup powergov_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The operating points, ordered from the slowest to the fastest, and the
+// operating point in use.
+//
+//*****************************************************************************
+static const tPowerGovPoint *g_psPowerGovPoints;
+static uint32_t g_ui32PowerGovNumPoints;
+static uint32_t g_ui32PowerGovPoint;
+
+//*****************************************************************************
+//
+// The scheduler tick rate, the processor clock frequency in deep sleep (or 0
+// if deep sleep is not used), and the shortest time until the next scheduler
+// deadline, in ticks, for which deep sleep is used.
+//
+//*****************************************************************************
+static uint32_t g_ui32PowerGovTickRate;
+static uint32_t g_ui32PowerGovDeepSleepClock;
+static uint32_t g_ui32PowerGovDeepSleepTicks;
+
+//*****************************************************************************
+//
+// The number of holds that prevent deep sleep.
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32PowerGovHolds;
+
+//*****************************************************************************
+//
+// The clock tree client used to retune the system tick when the clock
+// changes.
+//
+//*****************************************************************************
+static tClockTreeClient g_sPowerGovClient;
+
+//*****************************************************************************
+//
+// The transition log, and its read and write indices.
+//
+//*****************************************************************************
+static tPowerGovLogEntry g_psPowerGovLog[POWER_GOV_LOG_SIZE];
+static volatile uint32_t g_ui32PowerGovLogRead;
+static volatile uint32_t g_ui32PowerGovLogWrite;
+
+//*****************************************************************************
+//
+// Adds an entry to the transition log, discarding the oldest entry if the
+// log is full.
+//
+//*****************************************************************************
+static void
+PowerGovLog(uint32_t ui32Event, uint32_t ui32From, uint32_t ui32To,
+            uint32_t ui32Value)
+{
+    tPowerGovLogEntry *psEntry;
+
+    if((g_ui32PowerGovLogWrite - g_ui32PowerGovLogRead) == POWER_GOV_LOG_SIZE)
+    {
+        g_ui32PowerGovLogRead++;
+    }
+
+    psEntry = &g_psPowerGovLog[g_ui32PowerGovLogWrite &
+                               (POWER_GOV_LOG_SIZE - 1)];
+    psEntry->ui32Tick = SchedulerTickCountGet();
+    psEntry->ui8Event = ui32Event;
+    psEntry->ui8From = ui32From;
+    psEntry->ui8To = ui32To;
+    psEntry->ui8Value = (ui32Value > 255) ? 255 : ui32Value;
+
+    g_ui32PowerGovLogWrite++;
+}
+
+//*****************************************************************************
+//
+// Retunes the system tick to the scheduler tick rate when the clock changes,
+// and rescales the CPU usage measurement so that the usage passed to
+// PowerGovUpdate() is relative to the new clock.
+//
+//*****************************************************************************
+static void
+PowerGovClockChanged(void *pvCBData, uint32_t ui32SysClock)
+{
+    MAP_SysTickPeriodSet(ui32SysClock / g_ui32PowerGovTickRate);
+    CPUUsageClockSet(ui32SysClock);
+}
+
+//*****************************************************************************
+//
+// Moves to an operating point.
+//
+//*****************************************************************************
+static void
+PowerGovPointSet(uint32_t ui32Point)
+{
+    const tPowerGovPoint *psPoint;
+
+    psPoint = &g_psPowerGovPoints[ui32Point];
+
+    if(CLASS_IS_TM4C129)
+    {
+        ClockTreeFreqSet(psPoint->ui32Config, psPoint->ui32SysClock);
+    }
+    else
+    {
+        ClockTreeSet(psPoint->ui32Config);
+    }
+
+    g_ui32PowerGovPoint = ui32Point;
+}
+
+//*****************************************************************************
+//
+// Returns the number of scheduler ticks until the next task is due.
+//
+//*****************************************************************************
+static uint32_t
+PowerGovDeadlineGet(void)
+{
+    tSchedulerTask *psTask;
+    uint32_t ui32Idx, ui32Elapsed, ui32Ticks;
+
+    ui32Ticks = 0xffffffff;
+
+    for(ui32Idx = 0; ui32Idx < g_ui32SchedulerNumTasks; ui32Idx++)
+    {
+        psTask = &g_psSchedulerTable[ui32Idx];
+        if(!psTask->bActive)
+        {
+            continue;
+        }
+
+        ui32Elapsed = SchedulerElapsedTicksGet(psTask->ui32LastCall);
+        if(ui32Elapsed >= psTask->ui32FrequencyTicks)
+        {
+            return(0);
+        }
+        if((psTask->ui32FrequencyTicks - ui32Elapsed) < ui32Ticks)
+        {
+            ui32Ticks = psTask->ui32FrequencyTicks - ui32Elapsed;
+        }
+    }
+
+    return(ui32Ticks);
+}
+
+//*****************************************************************************
+//
+//! Initializes the power governor.
+//!
+//! \param psPoints is a pointer to the array of operating points, ordered
+//! from the slowest to the fastest.
+//! \param ui32NumPoints is the number of operating points.
+//! \param ui32Point is the index of the operating point to start with.
+//! \param ui32TicksPerSecond is the scheduler tick rate, as passed to
+//! SchedulerInit().
+//! \param ui32DeepSleepClock is the processor clock frequency in deep sleep,
+//! as configured by the application with SysCtlDeepSleepClockSet() or
+//! SysCtlDeepSleepClockConfigSet(), or 0 if deep sleep is not to be used.
+//! \param ui32DeepSleepTicks is the shortest time until the next scheduler
+//! deadline, in scheduler ticks, for which deep sleep is used.
+//!
+//! The governor changes the clock through the clock tree manager, so
+//! ClockTreeInit() must be called first, and clients of the clock tree
+//! manager are notified of every change of operating point.  The governor
+//! itself retunes the system tick so that the scheduler tick rate is kept.
+//!
+//! The application configures the peripherals that run in sleep and deep
+//! sleep with SysCtlPeripheralSleepEnable() and
+//! SysCtlPeripheralDeepSleepEnable(), and the power of the memories and the
+//! LDO voltage in deep sleep with SysCtlDeepSleepPowerSet() and
+//! SysCtlLDODeepSleepSet(), before calling PowerGovIdle().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PowerGovInit(const tPowerGovPoint *psPoints, uint32_t ui32NumPoints,
+             uint32_t ui32Point, uint32_t ui32TicksPerSecond,
+             uint32_t ui32DeepSleepClock, uint32_t ui32DeepSleepTicks)
+{
+    ASSERT(psPoints);
+    ASSERT(ui32NumPoints && (ui32NumPoints < 256));
+    ASSERT(ui32Point < ui32NumPoints);
+    ASSERT(ui32TicksPerSecond);
+
+    g_psPowerGovPoints = psPoints;
+    g_ui32PowerGovNumPoints = ui32NumPoints;
+    g_ui32PowerGovTickRate = ui32TicksPerSecond;
+    g_ui32PowerGovDeepSleepClock = ui32DeepSleepClock;
+    g_ui32PowerGovDeepSleepTicks = ui32DeepSleepTicks;
+    g_ui32PowerGovHolds = 0;
+    g_ui32PowerGovLogRead = 0;
+    g_ui32PowerGovLogWrite = 0;
+
+    ClockTreeRegister(&g_sPowerGovClient, PowerGovClockChanged, 0);
+
+    PowerGovPointSet(ui32Point);
+}
+
+//*****************************************************************************
+//
+//! Updates the operating point from the CPU usage.
+//!
+//! \param ui32Usage is the CPU usage as a 16.16 fixed-point percentage, as
+//! returned by CPUUsageTick().
+//!
+//! This function moves to the next faster operating point if the usage is
+//! above \b POWER_GOV_UP_LOAD, and to the next slower operating point if the
+//! usage is below \b POWER_GOV_DOWN_LOAD.  It should be called from the main
+//! loop, not from an interrupt handler, at the CPU usage measurement rate.
+//! Since the CPU usage module counts processor clocks, the governor passes
+//! each new clock frequency to CPUUsageClockSet(), so that a fully busy
+//! processor reports 100% at every operating point.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PowerGovUpdate(uint32_t ui32Usage)
+{
+    uint32_t ui32Point;
+
+    ui32Usage >>= 16;
+    ui32Point = g_ui32PowerGovPoint;
+
+    if((ui32Usage > POWER_GOV_UP_LOAD) &&
+       (ui32Point < (g_ui32PowerGovNumPoints - 1)))
+    {
+        ui32Point++;
+    }
+    else if((ui32Usage < POWER_GOV_DOWN_LOAD) && ui32Point)
+    {
+        ui32Point--;
+    }
+    else
+    {
+        return;
+    }
+
+    PowerGovLog(POWER_GOV_EVENT_POINT, g_ui32PowerGovPoint, ui32Point,
+                ui32Usage);
+    PowerGovPointSet(ui32Point);
+}
+
+//*****************************************************************************
+//
+//! Puts the processor to sleep until the next interrupt.
+//!
+//! This function is called from the main loop when there is no work to do.
+//! It uses deep sleep if deep sleep is enabled, no hold is in place, and the
+//! next scheduler deadline is at least the number of ticks given to
+//! PowerGovInit() away; otherwise it uses sleep.  During deep sleep, the
+//! system tick is retuned to the deep sleep clock so that the scheduler keeps
+//! time, to within a tick.
+//!
+//! The decision is made with interrupts disabled, so that an interrupt that
+//! makes work ready just before the processor sleeps still wakes it.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PowerGovIdle(void)
+{
+    uint32_t ui32Ticks;
+    bool bIntsOff;
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    ui32Ticks = PowerGovDeadlineGet();
+
+    if(ui32Ticks && g_ui32PowerGovDeepSleepClock && !g_ui32PowerGovHolds &&
+       (ui32Ticks >= g_ui32PowerGovDeepSleepTicks))
+    {
+        PowerGovLog(POWER_GOV_EVENT_DSLEEP, g_ui32PowerGovPoint,
+                    g_ui32PowerGovPoint, ui32Ticks);
+
+        MAP_SysTickPeriodSet(g_ui32PowerGovDeepSleepClock /
+                             g_ui32PowerGovTickRate);
+        MAP_SysCtlDeepSleep();
+        MAP_SysTickPeriodSet(ClockTreeSysClockGet() / g_ui32PowerGovTickRate);
+    }
+    else if(ui32Ticks)
+    {
+        MAP_SysCtlSleep();
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Prevents deep sleep.
+//!
+//! This function is called by a driver that needs a peripheral, or a clock,
+//! that stops in deep sleep, such as during a transfer.  Each call must be
+//! matched by a call to PowerGovDeepSleepRelease().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PowerGovDeepSleepHold(void)
+{
+    bool bIntsOff;
+
+    bIntsOff = MAP_IntMasterDisable();
+    g_ui32PowerGovHolds++;
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Releases a hold that prevents deep sleep.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PowerGovDeepSleepRelease(void)
+{
+    bool bIntsOff;
+
+    ASSERT(g_ui32PowerGovHolds);
+
+    bIntsOff = MAP_IntMasterDisable();
+    g_ui32PowerGovHolds--;
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the operating point in use.
+//!
+//! \return Returns the index of the operating point.
+//
+//*****************************************************************************
+uint32_t
+PowerGovPointGet(void)
+{
+    return(g_ui32PowerGovPoint);
+}
+
+//*****************************************************************************
+//
+//! Reads the oldest entry of the transition log.
+//!
+//! \param psEntry is a pointer to the structure that receives the entry.
+//!
+//! The log holds the most recent \b POWER_GOV_LOG_SIZE transitions; older
+//! transitions that have not been read are discarded.
+//!
+//! \return Returns \b true if an entry was read, or \b false if the log is
+//! empty.
+//
+//*****************************************************************************
+bool
+PowerGovLogRead(tPowerGovLogEntry *psEntry)
+{
+    bool bIntsOff, bRead;
+
+    ASSERT(psEntry);
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    bRead = (g_ui32PowerGovLogRead != g_ui32PowerGovLogWrite);
+    if(bRead)
+    {
+        *psEntry = g_psPowerGovLog[g_ui32PowerGovLogRead &
+                                   (POWER_GOV_LOG_SIZE - 1)];
+        g_ui32PowerGovLogRead++;
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+
+    return(bRead);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,176 @@
+//*****************************************************************************
+//
+// powergov.h - Prototypes for the frequency and power mode governor.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __POWERGOV_H__
+#define __POWERGOV_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup powergov_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The CPU usage, in percent, above which the governor moves to the next
+//! faster operating point.
+//
+//*****************************************************************************
+#ifndef POWER_GOV_UP_LOAD
+#define POWER_GOV_UP_LOAD       80
+#endif
+
+//*****************************************************************************
+//
+//! The CPU usage, in percent, below which the governor moves to the next
+//! slower operating point.
+//
+//*****************************************************************************
+#ifndef POWER_GOV_DOWN_LOAD
+#define POWER_GOV_DOWN_LOAD     30
+#endif
+
+//*****************************************************************************
+//
+//! The number of transitions kept in the transition log.  This must be a
+//! power of two.
+//
+//*****************************************************************************
+#ifndef POWER_GOV_LOG_SIZE
+#define POWER_GOV_LOG_SIZE      16
+#endif
+
+//*****************************************************************************
+//
+//! This structure describes an operating point of the governor.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The clock configuration, as passed to SysCtlClockSet() on TM4C123
+    //! devices or to SysCtlClockFreqSet() on TM4C129 devices.
+    //
+    uint32_t ui32Config;
+
+    //
+    //! The requested processor clock frequency on TM4C129 devices; this is
+    //! ignored on TM4C123 devices.
+    //
+    uint32_t ui32SysClock;
+}
+tPowerGovPoint;
+
+//*****************************************************************************
+//
+//! The transition log entry of a change of operating point.
+//
+//*****************************************************************************
+#define POWER_GOV_EVENT_POINT   0
+
+//*****************************************************************************
+//
+//! The transition log entry of a period of deep sleep.
+//
+//*****************************************************************************
+#define POWER_GOV_EVENT_DSLEEP  1
+
+//*****************************************************************************
+//
+//! This structure holds an entry of the transition log.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The scheduler tick count at which the transition was made.
+    //
+    uint32_t ui32Tick;
+
+    //
+    //! The type of transition, one of the \b POWER_GOV_EVENT_* values.
+    //
+    uint8_t ui8Event;
+
+    //
+    //! For a change of operating point, the old and the new operating
+    //! points.  For deep sleep, the operating point in use.
+    //
+    uint8_t ui8From;
+    uint8_t ui8To;
+
+    //
+    //! The CPU usage that caused a change of operating point, in percent,
+    //! or the number of ticks that the deep sleep was expected to last.
+    //
+    uint8_t ui8Value;
+}
+tPowerGovLogEntry;
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void PowerGovInit(const tPowerGovPoint *psPoints,
+                         uint32_t ui32NumPoints, uint32_t ui32Point,
+                         uint32_t ui32TicksPerSecond,
+                         uint32_t ui32DeepSleepClock,
+                         uint32_t ui32DeepSleepTicks);
+extern void PowerGovUpdate(uint32_t ui32Usage);
+extern void PowerGovIdle(void);
+extern void PowerGovDeepSleepHold(void);
+extern void PowerGovDeepSleepRelease(void);
+extern uint32_t PowerGovPointGet(void);
+extern bool PowerGovLogRead(tPowerGovLogEntry *psEntry);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __POWERGOV_H__
@@ -28,6 +28,8 @@
 //
 //*****************************************************************************
 #include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 //*****************************************************************************
 //
@@ -51,6 +53,713 @@
 //
 //*****************************************************************************
 #include "ptpd-1.1.0/src/dep-tiva/ptpd_timer.c"
-#include "ptpd-1.1.0/src/dep-tiva/ptpd_servo.c"
 #include "ptpd-1.1.0/src/dep-tiva/ptpd_msg.c"
 #include "ptpd-1.1.0/src/dep-tiva/ptpd_net.c"
+
+//*****************************************************************************
+//
+// The hardware clock servo below provides the ptpd servo entry points, so the
+// porting layer servo is only built when PTPD_LEGACY_SERVO is defined.  The
+// two cannot be used together since both program the IEEE 1588 addend.
+//
+//*****************************************************************************
+#ifdef PTPD_LEGACY_SERVO
+#include "ptpd-1.1.0/src/dep-tiva/ptpd_servo.c"
+#else
+
+//*****************************************************************************
+//
+// Driverlib headers needed for the hardware clock servo.
+//
+//*****************************************************************************
+#include "inc/hw_memmap.h"
+#include "driverlib/debug.h"
+#include "driverlib/emac.h"
+
+//*****************************************************************************
+//
+//! \addtogroup ptpdlib_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The frequency of the main oscillator that clocks the IEEE 1588 addend
+// accumulator, in Hz.
+//
+//*****************************************************************************
+#ifndef PTPD_OSC_HZ
+#define PTPD_OSC_HZ             25000000
+#endif
+
+//*****************************************************************************
+//
+// The IEEE 1588 subsecond increment, in nanoseconds, applied on each carry
+// from the addend accumulator.  This is the resolution of the hardware clock
+// and must be larger than the main oscillator period.
+//
+//*****************************************************************************
+#ifndef PTPD_SUBSEC_INC
+#define PTPD_SUBSEC_INC         50
+#endif
+
+//*****************************************************************************
+//
+// The nominal addend value, which produces a carry at 1000000000 /
+// PTPD_SUBSEC_INC Hz when the local oscillator is exactly on frequency.
+//
+//*****************************************************************************
+#define PTPD_ADDEND_NOMINAL                                                   \
+        ((uint32_t)((((uint64_t)(1000000000 / PTPD_SUBSEC_INC)) << 32) /      \
+                    PTPD_OSC_HZ))
+
+//*****************************************************************************
+//
+// The servo's proportional and integral divisors.  The frequency correction,
+// in ppb, is the offset from the master divided by PTPD_SERVO_AP plus a drift
+// term that accumulates the offset divided by PTPD_SERVO_AI on each Sync.  The
+// defaults are tuned for a one second Sync interval.
+//
+//*****************************************************************************
+#ifndef PTPD_SERVO_AP
+#define PTPD_SERVO_AP           2
+#endif
+#ifndef PTPD_SERVO_AI
+#define PTPD_SERVO_AI           4
+#endif
+
+//*****************************************************************************
+//
+// The largest frequency correction, in ppb, that the servo applies.
+//
+//*****************************************************************************
+#ifndef PTPD_SERVO_MAX_PPB
+#define PTPD_SERVO_MAX_PPB      512000
+#endif
+
+//*****************************************************************************
+//
+// Offsets larger than this, in nanoseconds, are corrected by stepping the
+// hardware clock rather than by slewing its frequency.
+//
+//*****************************************************************************
+#ifndef PTPD_SERVO_STEP_NS
+#define PTPD_SERVO_STEP_NS      1000000
+#endif
+
+//*****************************************************************************
+//
+// The servo is reported as locked once PTPD_SERVO_LOCK_COUNT consecutive
+// offsets are within PTPD_SERVO_LOCK_NS nanoseconds of the master.
+//
+//*****************************************************************************
+#ifndef PTPD_SERVO_LOCK_NS
+#define PTPD_SERVO_LOCK_NS      500
+#endif
+#ifndef PTPD_SERVO_LOCK_COUNT
+#define PTPD_SERVO_LOCK_COUNT   8
+#endif
+
+//*****************************************************************************
+//
+// The weight of each new sample in the mean path delay and jitter filters,
+// expressed as a divisor.
+//
+//*****************************************************************************
+#ifndef PTPD_SERVO_DELAY_FILTER
+#define PTPD_SERVO_DELAY_FILTER 16
+#endif
+#ifndef PTPD_SERVO_JITTER_FILTER
+#define PTPD_SERVO_JITTER_FILTER 16
+#endif
+
+//*****************************************************************************
+//
+// The servo state.
+//
+//*****************************************************************************
+static struct
+{
+    //
+    // The statistics returned by PTPDServoStatsGet().
+    //
+    tPTPDServoStats sStats;
+
+    //
+    // The most recent master-to-slave delay (t2 - t1), in nanoseconds.
+    //
+    int64_t i64MasterToSlave;
+
+    //
+    // The number of consecutive offsets within the lock threshold.
+    //
+    uint32_t ui32LockCount;
+
+    //
+    // Indicates that a mean path delay has been measured.
+    //
+    bool bDelayValid;
+
+    //
+    // Indicates that a master-to-slave delay has been measured.
+    //
+    bool bSyncValid;
+
+    //
+    // Indicates that the next delay measurement should be discarded because
+    // the clock was stepped while it was in progress.
+    //
+    bool bDiscardDelay;
+}
+g_sPTPDServo;
+
+//*****************************************************************************
+//
+// Returns the difference (psA - psB) between two timestamps in nanoseconds.
+//
+//*****************************************************************************
+static int64_t
+PTPDTimeDiff(const tPTPDTime *psA, const tPTPDTime *psB)
+{
+    return((((int64_t)psA->ui32Seconds - (int64_t)psB->ui32Seconds) *
+            1000000000) +
+           ((int64_t)psA->ui32Nanoseconds - (int64_t)psB->ui32Nanoseconds));
+}
+
+//*****************************************************************************
+//
+// Saturates a 64-bit nanosecond value to the range of a 32-bit signed value.
+//
+//*****************************************************************************
+static int32_t
+PTPDSaturate(int64_t i64Value)
+{
+    if(i64Value > INT32_MAX)
+    {
+        return(INT32_MAX);
+    }
+    if(i64Value < INT32_MIN)
+    {
+        return(INT32_MIN);
+    }
+    return((int32_t)i64Value);
+}
+
+//*****************************************************************************
+//
+// Steps the hardware clock backwards by the given offset (a negative offset
+// advances the clock).
+//
+//*****************************************************************************
+static void
+PTPDServoClockStep(int64_t i64Offset)
+{
+    uint64_t ui64Step;
+    uint32_t ui32Nanoseconds;
+    bool bInc;
+
+    bInc = (i64Offset < 0) ? true : false;
+    ui64Step = bInc ? (uint64_t)(-i64Offset) : (uint64_t)i64Offset;
+    ui32Nanoseconds = (uint32_t)(ui64Step % 1000000000);
+
+    //
+    // In digital rollover mode, the MAC subtracts a time by adding the
+    // complement of its nanoseconds field, so the field must hold
+    // 1000000000 less the nanoseconds to subtract.
+    //
+    if(!bInc && (ui32Nanoseconds != 0))
+    {
+        ui32Nanoseconds = 1000000000 - ui32Nanoseconds;
+    }
+
+    EMACTimestampSysTimeUpdate(EMAC0_BASE, (uint32_t)(ui64Step / 1000000000),
+                               ui32Nanoseconds, bInc);
+}
+
+//*****************************************************************************
+//
+// Applies a frequency correction, in ppb, to the hardware clock by scaling
+// the nominal addend.
+//
+//*****************************************************************************
+static void
+PTPDServoClockAdjust(int32_t i32PPB)
+{
+    int64_t i64Delta;
+
+    i64Delta = ((int64_t)PTPD_ADDEND_NOMINAL * i32PPB) / 1000000000;
+
+    EMACTimestampAddendSet(EMAC0_BASE, (uint32_t)((int64_t)PTPD_ADDEND_NOMINAL +
+                                                  i64Delta));
+}
+
+//*****************************************************************************
+//
+// Runs one iteration of the servo for a new offset from the master.
+//
+//*****************************************************************************
+static void
+PTPDServoClockUpdate(int64_t i64Offset)
+{
+    tPTPDServoStats *psStats;
+    int32_t i32Offset, i32Delta;
+    int64_t i64Adj;
+
+    psStats = &g_sPTPDServo.sStats;
+
+    //
+    // Large offsets are removed by stepping the clock.  The frequency
+    // correction is kept, since the oscillator has not changed.
+    //
+    if((i64Offset > PTPD_SERVO_STEP_NS) || (i64Offset < -PTPD_SERVO_STEP_NS))
+    {
+        PTPDServoClockStep(i64Offset);
+        psStats->ui32Steps++;
+        psStats->bLocked = false;
+        g_sPTPDServo.ui32LockCount = 0;
+        g_sPTPDServo.bSyncValid = false;
+        g_sPTPDServo.bDiscardDelay = true;
+        return;
+    }
+
+    i32Offset = (int32_t)i64Offset;
+
+    //
+    // Update the jitter estimate from the change in offset since the last
+    // sample.
+    //
+    if(psStats->ui32Syncs > 1)
+    {
+        i32Delta = i32Offset - psStats->i32Offset;
+        if(i32Delta < 0)
+        {
+            i32Delta = -i32Delta;
+        }
+        psStats->ui32Jitter = (uint32_t)((int32_t)psStats->ui32Jitter +
+                                         ((i32Delta -
+                                           (int32_t)psStats->ui32Jitter) /
+                                          PTPD_SERVO_JITTER_FILTER));
+    }
+    psStats->i32Offset = i32Offset;
+
+    //
+    // Track the offset range.
+    //
+    if(i32Offset < psStats->i32OffsetMin)
+    {
+        psStats->i32OffsetMin = i32Offset;
+    }
+    if(i32Offset > psStats->i32OffsetMax)
+    {
+        psStats->i32OffsetMax = i32Offset;
+    }
+
+    //
+    // Integrate the offset into the drift term, then form the proportional
+    // plus integral frequency correction.  A positive offset means that the
+    // local clock is ahead of the master, so the correction slows it down.
+    //
+    psStats->i32Drift += i32Offset / PTPD_SERVO_AI;
+    if(psStats->i32Drift > PTPD_SERVO_MAX_PPB)
+    {
+        psStats->i32Drift = PTPD_SERVO_MAX_PPB;
+    }
+    else if(psStats->i32Drift < -PTPD_SERVO_MAX_PPB)
+    {
+        psStats->i32Drift = -PTPD_SERVO_MAX_PPB;
+    }
+
+    i64Adj = -((int64_t)(i32Offset / PTPD_SERVO_AP) + psStats->i32Drift);
+    if(i64Adj > PTPD_SERVO_MAX_PPB)
+    {
+        i64Adj = PTPD_SERVO_MAX_PPB;
+    }
+    else if(i64Adj < -PTPD_SERVO_MAX_PPB)
+    {
+        i64Adj = -PTPD_SERVO_MAX_PPB;
+    }
+    psStats->i32FreqAdj = (int32_t)i64Adj;
+
+    PTPDServoClockAdjust(psStats->i32FreqAdj);
+
+    //
+    // Update the lock state.
+    //
+    if((i32Offset <= PTPD_SERVO_LOCK_NS) && (i32Offset >= -PTPD_SERVO_LOCK_NS))
+    {
+        if(g_sPTPDServo.ui32LockCount < PTPD_SERVO_LOCK_COUNT)
+        {
+            g_sPTPDServo.ui32LockCount++;
+        }
+        if(g_sPTPDServo.ui32LockCount == PTPD_SERVO_LOCK_COUNT)
+        {
+            psStats->bLocked = true;
+        }
+    }
+    else
+    {
+        g_sPTPDServo.ui32LockCount = 0;
+        psStats->bLocked = false;
+    }
+}
+
+//*****************************************************************************
+//
+// Resets the servo state and statistics.
+//
+//*****************************************************************************
+static void
+PTPDServoReset(void)
+{
+    tPTPDServoStats *psStats;
+
+    psStats = &g_sPTPDServo.sStats;
+    psStats->i32Offset = 0;
+    psStats->i32MeanPathDelay = 0;
+    psStats->i32FreqAdj = 0;
+    psStats->i32Drift = 0;
+    psStats->ui32Jitter = 0;
+    psStats->i32OffsetMin = INT32_MAX;
+    psStats->i32OffsetMax = INT32_MIN;
+    psStats->ui32Syncs = 0;
+    psStats->ui32DelayResps = 0;
+    psStats->ui32Steps = 0;
+    psStats->bLocked = false;
+    g_sPTPDServo.i64MasterToSlave = 0;
+    g_sPTPDServo.ui32LockCount = 0;
+    g_sPTPDServo.bDelayValid = false;
+    g_sPTPDServo.bSyncValid = false;
+    g_sPTPDServo.bDiscardDelay = false;
+}
+
+//*****************************************************************************
+//
+//! Initializes the IEEE 1588 hardware clock and the PTP slave servo.
+//!
+//! \param bPPSEnable is \b true if the Ethernet MAC's PPS output should be
+//! driven from the servoed clock.
+//!
+//! This function configures the Ethernet MAC's IEEE 1588 clock for fine
+//! update mode with digital (nanosecond) rollover, programs the nominal addend
+//! for the main oscillator, enables timestamping of the PTP version 1
+//! messages used by ptpd, carried in UDP over IPv4, and resets the servo
+//! state.  The MAC must have been enabled and initialized, for example by
+//! lwIPInit(), before this function is called, and ptpd must be started after
+//! it.
+//!
+//! Once ptpd is running, its Sync, Follow_Up and Delay_Resp handlers feed the
+//! servo, so PTPDServoSyncUpdate() and PTPDServoDelayUpdate() need only be
+//! called by applications that run their own protocol engine.
+//!
+//! If \e bPPSEnable is \b true, the PPS output is configured to pulse once
+//! each time the servoed clock's seconds count increments.  The application
+//! is responsible for configuring the EN0PPS pin.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PTPDServoInit(bool bPPSEnable)
+{
+    //
+    // Configure the hardware clock and start it at its nominal rate.
+    //
+    EMACTimestampConfigSet(EMAC0_BASE, (EMAC_TS_PTP_VERSION_1 |
+                                        EMAC_TS_DIGITAL_ROLLOVER |
+                                        EMAC_TS_UPDATE_FINE |
+                                        EMAC_TS_SYNC_FOLLOW_DREQ_DRESP |
+                                        EMAC_TS_PROCESS_IPV4_UDP),
+                           PTPD_SUBSEC_INC);
+    EMACTimestampAddendSet(EMAC0_BASE, PTPD_ADDEND_NOMINAL);
+    EMACTimestampEnable(EMAC0_BASE);
+
+    //
+    // Drive the PPS output from the second rollover of the clock.
+    //
+    if(bPPSEnable)
+    {
+        EMACTimestampPPSSimpleModeSet(EMAC0_BASE, EMAC_PPS_1HZ);
+    }
+
+    //
+    // Reset the servo state.
+    //
+    PTPDServoReset();
+}
+
+//*****************************************************************************
+//
+//! Feeds a Sync measurement to the PTP slave servo.
+//!
+//! \param psMasterTx is the time at which the master sent the Sync message
+//! (t1), taken from the Sync or Follow_Up message with the correction field
+//! applied.
+//! \param psSlaveRx is the hardware receive timestamp of the Sync message
+//! (t2), as captured by the Ethernet MAC.
+//!
+//! This function computes the offset of the local hardware clock from the
+//! master, using the most recent mean path delay, and updates the clock's
+//! frequency (or steps it if the offset exceeds \b PTPD_SERVO_STEP_NS).  It
+//! should be called once for each Sync message received from the selected
+//! master.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PTPDServoSyncUpdate(const tPTPDTime *psMasterTx, const tPTPDTime *psSlaveRx)
+{
+    int64_t i64Offset;
+
+    ASSERT(psMasterTx);
+    ASSERT(psSlaveRx);
+
+    g_sPTPDServo.sStats.ui32Syncs++;
+
+    //
+    // Save the master-to-slave delay for the next path delay calculation.
+    //
+    g_sPTPDServo.i64MasterToSlave = PTPDTimeDiff(psSlaveRx, psMasterTx);
+    g_sPTPDServo.bSyncValid = true;
+
+    //
+    // Remove the path delay, once known, to get the offset from the master.
+    //
+    i64Offset = g_sPTPDServo.i64MasterToSlave;
+    if(g_sPTPDServo.bDelayValid)
+    {
+        i64Offset -= g_sPTPDServo.sStats.i32MeanPathDelay;
+    }
+
+    PTPDServoClockUpdate(i64Offset);
+}
+
+//*****************************************************************************
+//
+//! Feeds a Delay_Req/Delay_Resp measurement to the PTP slave servo.
+//!
+//! \param psSlaveTx is the hardware transmit timestamp of the Delay_Req
+//! message (t3), as captured by the Ethernet MAC.
+//! \param psMasterRx is the time at which the master received the
+//! Delay_Req message (t4), taken from the Delay_Resp message with the
+//! correction field applied.
+//!
+//! This function combines the delay request measurement with the most recent
+//! Sync measurement to update the filtered mean path delay between the master
+//! and this slave.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PTPDServoDelayUpdate(const tPTPDTime *psSlaveTx, const tPTPDTime *psMasterRx)
+{
+    tPTPDServoStats *psStats;
+    int64_t i64Delay;
+
+    ASSERT(psSlaveTx);
+    ASSERT(psMasterRx);
+
+    psStats = &g_sPTPDServo.sStats;
+    psStats->ui32DelayResps++;
+
+    //
+    // Ignore a measurement that straddled a clock step, or that has no Sync
+    // measurement to pair with.
+    //
+    if(g_sPTPDServo.bDiscardDelay || !g_sPTPDServo.bSyncValid)
+    {
+        g_sPTPDServo.bDiscardDelay = false;
+        return;
+    }
+
+    //
+    // The mean path delay is half of the round trip.  Discard negative
+    // values, which can only result from a bad measurement.
+    //
+    i64Delay = (g_sPTPDServo.i64MasterToSlave +
+                PTPDTimeDiff(psMasterRx, psSlaveTx)) / 2;
+    if(i64Delay < 0)
+    {
+        return;
+    }
+
+    //
+    // Filter the mean path delay, seeding the filter with the first
+    // measurement.
+    //
+    if(g_sPTPDServo.bDelayValid)
+    {
+        psStats->i32MeanPathDelay +=
+            PTPDSaturate((i64Delay - psStats->i32MeanPathDelay) /
+                         PTPD_SERVO_DELAY_FILTER);
+    }
+    else
+    {
+        psStats->i32MeanPathDelay = PTPDSaturate(i64Delay);
+        g_sPTPDServo.bDelayValid = true;
+    }
+}
+
+//*****************************************************************************
+//
+//! Reads the current time of the IEEE 1588 hardware clock.
+//!
+//! \param psTime points to storage for the current time.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PTPDServoTimeGet(tPTPDTime *psTime)
+{
+    ASSERT(psTime);
+
+    EMACTimestampSysTimeGet(EMAC0_BASE, &psTime->ui32Seconds,
+                            &psTime->ui32Nanoseconds);
+}
+
+//*****************************************************************************
+//
+//! Returns the PTP slave servo statistics.
+//!
+//! \param psStats points to a structure that receives the current
+//! statistics.
+//! \param bClear is \b true if the offset range should be reset after it is
+//! read, starting a new measurement interval.
+//!
+//! The returned structure holds the most recent offset from the master, the
+//! filtered mean path delay, the current frequency correction and drift
+//! term, the filtered offset jitter, the offset range seen since the last
+//! reset, counts of Sync and Delay_Resp measurements and of clock steps, and
+//! whether the servo is locked to the master.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PTPDServoStatsGet(tPTPDServoStats *psStats, bool bClear)
+{
+    ASSERT(psStats);
+
+    *psStats = g_sPTPDServo.sStats;
+
+    if(bClear)
+    {
+        g_sPTPDServo.sStats.i32OffsetMin = INT32_MAX;
+        g_sPTPDServo.sStats.i32OffsetMax = INT32_MIN;
+    }
+}
+
+//*****************************************************************************
+//
+// Converts a ptpd internal time to a hardware clock time.
+//
+//*****************************************************************************
+static void
+PTPDTimeFromInternal(tPTPDTime *psTime, const TimeInternal *psInternal)
+{
+    psTime->ui32Seconds = (uint32_t)psInternal->seconds;
+    psTime->ui32Nanoseconds = (uint32_t)psInternal->nanoseconds;
+}
+
+//*****************************************************************************
+//
+// Converts a signed nanosecond value to a ptpd internal time, whose seconds
+// and nanoseconds share the sign of the value.
+//
+//*****************************************************************************
+static void
+PTPDTimeToInternal(TimeInternal *psInternal, int32_t i32Nanoseconds)
+{
+    psInternal->seconds = i32Nanoseconds / 1000000000;
+    psInternal->nanoseconds = i32Nanoseconds % 1000000000;
+}
+
+//*****************************************************************************
+//
+// Copies the servo results into the ptpd clock data set, where the protocol
+// engine and the application expect to find them.
+//
+//*****************************************************************************
+static void
+PTPDServoPublish(PtpClock *ptpClock)
+{
+    PTPDTimeToInternal(&ptpClock->offset_from_master,
+                       g_sPTPDServo.sStats.i32Offset);
+    PTPDTimeToInternal(&ptpClock->one_way_delay,
+                       g_sPTPDServo.sStats.i32MeanPathDelay);
+    ptpClock->observed_drift = g_sPTPDServo.sStats.i32Drift;
+}
+
+//*****************************************************************************
+//
+// The ptpd servo entry points.  The protocol engine calls these from its
+// state machine and its Sync, Follow_Up and Delay_Resp handlers, with the
+// hardware timestamps captured by the porting layer.
+//
+//*****************************************************************************
+void
+initClock(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+    //
+    // Start again from the nominal frequency, since the master may have
+    // changed.  The hardware clock was configured by PTPDServoInit().
+    //
+    PTPDServoReset();
+    EMACTimestampAddendSet(EMAC0_BASE, PTPD_ADDEND_NOMINAL);
+
+    PTPDServoPublish(ptpClock);
+}
+
+void
+updateOffset(TimeInternal *send_time, TimeInternal *recv_time,
+             offset_from_master_filter *ofm_filt, RunTimeOpts *rtOpts,
+             PtpClock *ptpClock)
+{
+    tPTPDTime sMasterTx, sSlaveRx;
+
+    PTPDTimeFromInternal(&sMasterTx, send_time);
+    PTPDTimeFromInternal(&sSlaveRx, recv_time);
+
+    PTPDServoSyncUpdate(&sMasterTx, &sSlaveRx);
+
+    PTPDTimeToInternal(&ptpClock->master_to_slave_delay,
+                       PTPDSaturate(g_sPTPDServo.i64MasterToSlave));
+    PTPDServoPublish(ptpClock);
+}
+
+void
+updateDelay(TimeInternal *send_time, TimeInternal *recv_time,
+            one_way_delay_filter *owd_filt, RunTimeOpts *rtOpts,
+            PtpClock *ptpClock)
+{
+    tPTPDTime sSlaveTx, sMasterRx;
+
+    PTPDTimeFromInternal(&sSlaveTx, send_time);
+    PTPDTimeFromInternal(&sMasterRx, recv_time);
+
+    PTPDServoDelayUpdate(&sSlaveTx, &sMasterRx);
+
+    PTPDServoPublish(ptpClock);
+}
+
+void
+updateClock(RunTimeOpts *rtOpts, PtpClock *ptpClock)
+{
+    //
+    // The clock was corrected when the offset was measured, so there is
+    // nothing left to do but report the result.
+    //
+    PTPDServoPublish(ptpClock);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+#endif // PTPD_LEGACY_SERVO
@@ -43,6 +43,101 @@ extern "C"
 //*****************************************************************************
 #include "ptpd-1.1.0/src/ptpd.h"
 
+//*****************************************************************************
+//
+// A time value from the IEEE 1588 hardware clock, or from a PTP message.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The seconds portion of the time.
+    //
+    uint32_t ui32Seconds;
+
+    //
+    // The nanoseconds portion of the time, from 0 to 999999999.
+    //
+    uint32_t ui32Nanoseconds;
+}
+tPTPDTime;
+
+//*****************************************************************************
+//
+// PTP slave servo statistics, as returned by PTPDServoStatsGet().
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The most recent offset of the local clock from the master, in
+    // nanoseconds.  Positive values mean that the local clock is ahead.
+    //
+    int32_t i32Offset;
+
+    //
+    // The filtered mean path delay between the master and this slave, in
+    // nanoseconds.
+    //
+    int32_t i32MeanPathDelay;
+
+    //
+    // The frequency correction currently applied to the local clock, in ppb.
+    //
+    int32_t i32FreqAdj;
+
+    //
+    // The integral (drift) term of the frequency correction, in ppb.
+    //
+    int32_t i32Drift;
+
+    //
+    // The filtered change in offset between consecutive Sync messages, in
+    // nanoseconds.
+    //
+    uint32_t ui32Jitter;
+
+    //
+    // The smallest and largest offsets seen since the statistics were last
+    // cleared, in nanoseconds.
+    //
+    int32_t i32OffsetMin;
+    int32_t i32OffsetMax;
+
+    //
+    // The number of Sync and Delay_Resp measurements fed to the servo.
+    //
+    uint32_t ui32Syncs;
+    uint32_t ui32DelayResps;
+
+    //
+    // The number of times the local clock has been stepped.
+    //
+    uint32_t ui32Steps;
+
+    //
+    // Indicates that the local clock is locked to the master.
+    //
+    bool bLocked;
+}
+tPTPDServoStats;
+
+//*****************************************************************************
+//
+// PTP slave servo API.  This is not available when ptpdlib is built with
+// PTPD_LEGACY_SERVO, which selects the ptpd porting layer servo instead.
+//
+//*****************************************************************************
+#ifndef PTPD_LEGACY_SERVO
+extern void PTPDServoInit(bool bPPSEnable);
+extern void PTPDServoSyncUpdate(const tPTPDTime *psMasterTx,
+                                const tPTPDTime *psSlaveRx);
+extern void PTPDServoDelayUpdate(const tPTPDTime *psSlaveTx,
+                                 const tPTPDTime *psMasterRx);
+extern void PTPDServoTimeGet(tPTPDTime *psTime);
+extern void PTPDServoStatsGet(tPTPDServoStats *psStats, bool bClear);
+#endif
+
 //*****************************************************************************
 //
 // Mark the end of the C bindings section for C++ compilers.
@@ -41,6 +41,14 @@
 
 static volatile uint32_t g_ui32SchedulerTickCount;
 
+//*****************************************************************************
+//
+// The rate of the SysTick interrupt, kept so that the SysTick period can be
+// recomputed when the system clock changes.
+//
+//*****************************************************************************
+static uint32_t g_ui32SchedulerTickRate;
+
 //*****************************************************************************
 //
 //! Handles the SysTick interrupt on behalf of the scheduler module.
@@ -85,6 +93,8 @@ SchedulerInit(uint32_t ui32TicksPerSecond)
 {
     ASSERT(ui32TicksPerSecond);
 
+    g_ui32SchedulerTickRate = ui32TicksPerSecond;
+
     //
     // Configure SysTick for a periodic interrupt.
     //
@@ -93,6 +103,31 @@ SchedulerInit(uint32_t ui32TicksPerSecond)
     SysTickIntEnable();
 }
 
+//*****************************************************************************
+//
+//! Informs the scheduler of a new system clock rate.
+//!
+//! \param pvCBData is not used.
+//! \param ui32SysClock is the new system clock rate, in Hz.
+//!
+//! This function recomputes the SysTick period so that the scheduler keeps
+//! the tick rate passed to SchedulerInit() when the system clock changes.  It
+//! has the form of a clock tree callback, so it may be passed to
+//! ClockTreeRegister(), or it may be called directly by an application that
+//! changes the system clock.  The tick in progress when the clock changes
+//! completes at the old period.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SchedulerClockChanged(void *pvCBData, uint32_t ui32SysClock)
+{
+    ASSERT(g_ui32SchedulerTickRate);
+
+    SysTickPeriodSet(ui32SysClock / g_ui32SchedulerTickRate);
+}
+
 //*****************************************************************************
 //
 //! Instructs the scheduler to update its task table and make calls to
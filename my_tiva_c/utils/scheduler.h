@@ -120,6 +120,7 @@ extern uint32_t g_ui32SchedulerNumTasks;
 //*****************************************************************************
 extern void SchedulerSysTickIntHandler(void);
 extern void SchedulerInit(uint32_t ui32TicksPerSecond);
+extern void SchedulerClockChanged(void *pvCBData, uint32_t ui32SysClock);
 extern void SchedulerRun(void);
 extern void SchedulerTaskEnable(uint32_t ui32Index, bool bRunNow);
 extern void SchedulerTaskDisable(uint32_t ui32Index);
@@ -0,0 +1,743 @@
+//*****************************************************************************
+//
+// spibus.c - Shared, queued SPI bus driver with uDMA transfers.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "driverlib/debug.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/rom.h"
+#include "driverlib/rom_map.h"
+#include "driverlib/ssi.h"
+#include "driverlib/udma.h"
+#include "utils/spibus.h"
+
+//*****************************************************************************
+//
+//! \addtogroup spibus_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The states of a transfer phase.
+//
+//*****************************************************************************
+#define STATE_IDLE              0
+#define STATE_DUPLEX            1
+#define STATE_WRITE             2
+#define STATE_DRAIN             3
+
+//*****************************************************************************
+//
+// The depth of the SSI FIFOs.
+//
+//*****************************************************************************
+#define SSI_FIFO_DEPTH          8
+
+//*****************************************************************************
+//
+// The largest number of items moved by one uDMA transfer.
+//
+//*****************************************************************************
+#define MAX_DMA_CHUNK           1024
+
+//*****************************************************************************
+//
+// The byte written when a transfer has no transmit data.
+//
+//*****************************************************************************
+static const uint8_t g_ui8SPIBusFill = 0xff;
+
+//*****************************************************************************
+//
+// Forward declarations.
+//
+//*****************************************************************************
+static void SPIBusPhaseStart(tSPIBus *psBus);
+static void SPIBusTransferStart(tSPIBus *psBus);
+
+//*****************************************************************************
+//
+// Determines whether the uDMA transfer of the current phase is complete.  A
+// full-duplex transfer is complete when the last byte has been received, and
+// a write-only one when the last byte has been written to the transmit FIFO.
+//
+//*****************************************************************************
+static bool
+SPIBusDMADone(tSPIBus *psBus, uint32_t ui32Status)
+{
+    uint32_t ui32Channel;
+
+    //
+    // TM4C129 parts report the completion in the masked interrupt status.
+    //
+    if(CLASS_IS_TM4C129)
+    {
+        if(psBus->ui8State == STATE_DUPLEX)
+        {
+            return((ui32Status & SSI_MIS_DMARXMIS) ? true : false);
+        }
+        return((ui32Status & SSI_MIS_DMATXMIS) ? true : false);
+    }
+
+    //
+    // Earlier parts raise the interrupt without a status bit when either
+    // channel completes, so the channel itself is checked.  A channel
+    // returns to the stop mode once its transfer is complete.
+    //
+    ui32Channel = ((psBus->ui8State == STATE_DUPLEX) ? psBus->ui32RxChannel :
+                   psBus->ui32TxChannel);
+
+    return((MAP_uDMAChannelModeGet(ui32Channel | UDMA_PRI_SELECT) ==
+            UDMA_MODE_STOP) ? true : false);
+}
+
+//*****************************************************************************
+//
+// Starts the next uDMA transfer of the current phase.
+//
+//*****************************************************************************
+static void
+SPIBusDMAChunk(tSPIBus *psBus)
+{
+    uint32_t ui32Chunk;
+
+    ui32Chunk = psBus->ui32Count - psBus->ui32Pos;
+    if(ui32Chunk > MAX_DMA_CHUNK)
+    {
+        ui32Chunk = MAX_DMA_CHUNK;
+    }
+    psBus->ui32Chunk = ui32Chunk;
+
+    //
+    // The receive channel is armed first so that no received byte can be
+    // missed.  Without a receive buffer, every byte goes to one discard
+    // location.
+    //
+    if(psBus->ui8State == STATE_DUPLEX)
+    {
+        MAP_uDMAChannelControlSet(psBus->ui32RxChannel | UDMA_PRI_SELECT,
+                                  (UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                                   (psBus->pui8Rx ? UDMA_DST_INC_8 :
+                                    UDMA_DST_INC_NONE) | UDMA_ARB_4));
+        MAP_uDMAChannelTransferSet(psBus->ui32RxChannel | UDMA_PRI_SELECT,
+                                   UDMA_MODE_BASIC,
+                                   (void *)(psBus->ui32Base + SSI_O_DR),
+                                   (psBus->pui8Rx ?
+                                    (psBus->pui8Rx + psBus->ui32Pos) :
+                                    &psBus->ui8Discard), ui32Chunk);
+        MAP_uDMAChannelEnable(psBus->ui32RxChannel);
+    }
+
+    //
+    // The transmit channel requests in smaller bursts than the receive
+    // channel so that it can not get far enough ahead to overrun the receive
+    // FIFO.
+    //
+    MAP_uDMAChannelControlSet(psBus->ui32TxChannel | UDMA_PRI_SELECT,
+                              (UDMA_SIZE_8 |
+                               (psBus->pui8Tx ? UDMA_SRC_INC_8 :
+                                UDMA_SRC_INC_NONE) | UDMA_DST_INC_NONE |
+                               UDMA_ARB_2));
+    MAP_uDMAChannelTransferSet(psBus->ui32TxChannel | UDMA_PRI_SELECT,
+                               UDMA_MODE_BASIC,
+                               (psBus->pui8Tx ?
+                                (void *)(psBus->pui8Tx + psBus->ui32Pos) :
+                                (void *)&g_ui8SPIBusFill),
+                               (void *)(psBus->ui32Base + SSI_O_DR),
+                               ui32Chunk);
+    MAP_uDMAChannelEnable(psBus->ui32TxChannel);
+}
+
+//*****************************************************************************
+//
+// Moves data through the FIFOs for a phase that does not use the uDMA
+// controller.
+//
+//*****************************************************************************
+static void
+SPIBusFIFOService(tSPIBus *psBus)
+{
+    uint32_t ui32Data;
+
+    //
+    // Collect the bytes that have been received.
+    //
+    if(psBus->ui8State == STATE_DUPLEX)
+    {
+        while((psBus->ui32Pos < psBus->ui32TxPos) &&
+              MAP_SSIDataGetNonBlocking(psBus->ui32Base, &ui32Data))
+        {
+            if(psBus->pui8Rx)
+            {
+                psBus->pui8Rx[psBus->ui32Pos] = ui32Data;
+            }
+            psBus->ui32Pos++;
+        }
+    }
+
+    //
+    // Write more bytes.  In full duplex, no more bytes are written than
+    // there is room for in the receive FIFO.
+    //
+    while((psBus->ui32TxPos < psBus->ui32Count) &&
+          ((psBus->ui8State != STATE_DUPLEX) ||
+           ((psBus->ui32TxPos - psBus->ui32Pos) < SSI_FIFO_DEPTH)) &&
+          MAP_SSIDataPutNonBlocking(psBus->ui32Base,
+                                    (psBus->pui8Tx ?
+                                     psBus->pui8Tx[psBus->ui32TxPos] :
+                                     g_ui8SPIBusFill)))
+    {
+        psBus->ui32TxPos++;
+    }
+}
+
+//*****************************************************************************
+//
+// Waits for the last bytes of a write-only phase to be shifted out.
+//
+//*****************************************************************************
+static void
+SPIBusDrain(tSPIBus *psBus)
+{
+    psBus->ui8State = STATE_DRAIN;
+    psBus->ui32Pos = psBus->ui32Count;
+
+    //
+    // Clear any end of transmission seen while the FIFO was being filled,
+    // then wait for the next one unless the transmitter is already idle.
+    //
+    HWREG(psBus->ui32Base + SSI_O_ICR) = SSI_ICR_EOTIC;
+    if(MAP_SSIBusy(psBus->ui32Base))
+    {
+        HWREG(psBus->ui32Base + SSI_O_IM) = SSI_IM_EOTIM;
+    }
+    else
+    {
+        HWREG(psBus->ui32Base + SSI_O_IM) = 0;
+        psBus->ui8State = STATE_IDLE;
+    }
+}
+
+//*****************************************************************************
+//
+// Finishes the current phase, starting the data phase after the header or
+// completing the transfer.
+//
+//*****************************************************************************
+static void
+SPIBusPhaseDone(tSPIBus *psBus)
+{
+    tSPIBusTransfer *psTransfer;
+
+    HWREG(psBus->ui32Base + SSI_O_IM) = 0;
+    if(psBus->bPhaseDMA)
+    {
+        MAP_SSIDMADisable(psBus->ui32Base, SSI_DMA_TX | SSI_DMA_RX);
+    }
+
+    psTransfer = psBus->psHead;
+
+    //
+    // Move from the header to the data.
+    //
+    if(psBus->bHeader)
+    {
+        psBus->bHeader = false;
+        psBus->pui8Tx = psTransfer->pui8Tx;
+        psBus->pui8Rx = psTransfer->pui8Rx;
+        psBus->ui32Count = psTransfer->ui32Count;
+        if(psBus->ui32Count)
+        {
+            SPIBusPhaseStart(psBus);
+            return;
+        }
+    }
+
+    //
+    // Release the chip select, then start the next transfer before calling
+    // back so that the bus is kept busy while the callback runs.
+    //
+    MAP_GPIOPinWrite(psTransfer->psDevice->ui32CSPort,
+                     psTransfer->psDevice->ui8CSPin,
+                     psTransfer->psDevice->ui8CSPin);
+
+    psBus->ui8State = STATE_IDLE;
+    psBus->ui32Transfers++;
+    psBus->psHead = psTransfer->psNext;
+    if(psBus->psHead)
+    {
+        SPIBusTransferStart(psBus);
+    }
+
+    psTransfer->ui32Status = SPI_BUS_DONE;
+    if(psTransfer->pfnCallback)
+    {
+        psTransfer->pfnCallback(psTransfer->pvCBData);
+    }
+}
+
+//*****************************************************************************
+//
+// Starts a phase of the current transfer with the data in pui8Tx, pui8Rx and
+// ui32Count.
+//
+//*****************************************************************************
+static void
+SPIBusPhaseStart(tSPIBus *psBus)
+{
+    uint32_t ui32Base;
+
+    ui32Base = psBus->ui32Base;
+    psBus->ui32Pos = 0;
+    psBus->ui32TxPos = 0;
+    psBus->bPhaseDMA = psBus->bDMA && (psBus->ui32Count >= SPI_BUS_DMA_MIN);
+
+    //
+    // When the received data is not needed and the module supports it, use
+    // the advanced write mode, in which the receive FIFO is not filled and
+    // the end of the phase is signalled by the end of transmission
+    // interrupt.
+    //
+    if(psBus->bAdvanced)
+    {
+        if(psBus->pui8Rx)
+        {
+            psBus->ui8State = STATE_DUPLEX;
+            MAP_SSIAdvModeSet(ui32Base, SSI_ADV_MODE_READ_WRITE);
+        }
+        else
+        {
+            psBus->ui8State = STATE_WRITE;
+            MAP_SSIAdvModeSet(ui32Base, SSI_ADV_MODE_WRITE);
+        }
+    }
+    else
+    {
+        psBus->ui8State = STATE_DUPLEX;
+    }
+
+    if(psBus->bPhaseDMA)
+    {
+        //
+        // The SSI modules of TM4C129 parts report the completion of a uDMA
+        // transfer through maskable status bits.  Earlier parts have no such
+        // bits and raise the SSI interrupt whenever a uDMA transfer
+        // completes, so nothing is unmasked for them.
+        //
+        SPIBusDMAChunk(psBus);
+        if(CLASS_IS_TM4C129)
+        {
+            HWREG(ui32Base + SSI_O_ICR) = SSI_ICR_DMATXIC | SSI_ICR_DMARXIC;
+        }
+        if(psBus->ui8State == STATE_DUPLEX)
+        {
+            HWREG(ui32Base + SSI_O_IM) = CLASS_IS_TM4C129 ? SSI_IM_DMARXIM : 0;
+            MAP_SSIDMAEnable(ui32Base, SSI_DMA_TX | SSI_DMA_RX);
+        }
+        else
+        {
+            HWREG(ui32Base + SSI_O_IM) = CLASS_IS_TM4C129 ? SSI_IM_DMATXIM : 0;
+            MAP_SSIDMAEnable(ui32Base, SSI_DMA_TX);
+        }
+    }
+    else
+    {
+        SPIBusFIFOService(psBus);
+        if(psBus->ui8State == STATE_DUPLEX)
+        {
+            HWREG(ui32Base + SSI_O_ICR) = SSI_ICR_RTIC;
+            HWREG(ui32Base + SSI_O_IM) = SSI_IM_RXIM | SSI_IM_RTIM;
+        }
+        else if(psBus->ui32TxPos < psBus->ui32Count)
+        {
+            HWREG(ui32Base + SSI_O_IM) = SSI_IM_TXIM;
+        }
+        else
+        {
+            SPIBusDrain(psBus);
+            if(psBus->ui8State == STATE_IDLE)
+            {
+                SPIBusPhaseDone(psBus);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the transfer at the head of the queue.
+//
+//*****************************************************************************
+static void
+SPIBusTransferStart(tSPIBus *psBus)
+{
+    tSPIBusTransfer *psTransfer;
+    tSPIBusDevice *psDevice;
+    uint32_t ui32Data;
+
+    psTransfer = psBus->psHead;
+    psDevice = psTransfer->psDevice;
+
+    //
+    // Reconfigure the SSI module if the device differs from the last one.
+    //
+    if(psBus->psConfigured != psDevice)
+    {
+        MAP_SSIDisable(psBus->ui32Base);
+        MAP_SSIConfigSetExpClk(psBus->ui32Base, psBus->ui32Clock,
+                               psDevice->ui32Protocol, SSI_MODE_MASTER,
+                               psDevice->ui32BitRate, 8);
+        MAP_SSIEnable(psBus->ui32Base);
+        psBus->psConfigured = psDevice;
+    }
+
+    //
+    // Discard anything left in the receive FIFO.
+    //
+    while(MAP_SSIDataGetNonBlocking(psBus->ui32Base, &ui32Data))
+    {
+    }
+
+    MAP_GPIOPinWrite(psDevice->ui32CSPort, psDevice->ui8CSPin, 0);
+
+    if(psTransfer->ui32HeaderLen)
+    {
+        psBus->bHeader = true;
+        psBus->pui8Tx = psTransfer->pui8Header;
+        psBus->pui8Rx = 0;
+        psBus->ui32Count = psTransfer->ui32HeaderLen;
+    }
+    else
+    {
+        psBus->bHeader = false;
+        psBus->pui8Tx = psTransfer->pui8Tx;
+        psBus->pui8Rx = psTransfer->pui8Rx;
+        psBus->ui32Count = psTransfer->ui32Count;
+    }
+
+    SPIBusPhaseStart(psBus);
+}
+
+//*****************************************************************************
+//
+//! Initializes a shared SPI bus.
+//!
+//! \param psBus is a pointer to the bus state.
+//! \param ui32Base is the base address of the SSI module.
+//! \param ui32Clock is the rate of the clock supplied to the SSI module.
+//! \param ui32TxMapping is the uDMA channel mapping for the transmit request
+//! of the SSI module, as passed to uDMAChannelAssign(), or
+//! \b SPI_BUS_NO_DMA.
+//! \param ui32RxMapping is the uDMA channel mapping for the receive request
+//! of the SSI module, or \b SPI_BUS_NO_DMA.
+//!
+//! This function prepares an SSI module to be shared by the devices on its
+//! bus.  The application must enable the SSI module, configure its clock,
+//! receive and transmit pins, and enable its interrupt, which must call
+//! SPIBusIntHandler().  If uDMA is used, the application must also enable
+//! the uDMA controller and set its control table.  On TM4C123 parts, which
+//! have no uDMA status bits in the SSI module, the end of each uDMA transfer
+//! is detected from the mode of its channel when the SSI interrupt is raised.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SPIBusInit(tSPIBus *psBus, uint32_t ui32Base, uint32_t ui32Clock,
+           uint32_t ui32TxMapping, uint32_t ui32RxMapping)
+{
+    ASSERT(psBus);
+
+    psBus->ui32Base = ui32Base;
+    psBus->ui32Clock = ui32Clock;
+    psBus->bAdvanced = CLASS_IS_TM4C129;
+    psBus->bDMA = ((ui32TxMapping != SPI_BUS_NO_DMA) &&
+                   (ui32RxMapping != SPI_BUS_NO_DMA));
+    psBus->psHead = 0;
+    psBus->psTail = 0;
+    psBus->psConfigured = 0;
+    psBus->ui8State = STATE_IDLE;
+    psBus->ui32Transfers = 0;
+
+    HWREG(ui32Base + SSI_O_IM) = 0;
+
+    //
+    // Route the SSI module to its uDMA channels.  The receive channel has
+    // the higher priority so that the receive FIFO can not overflow.
+    //
+    if(psBus->bDMA)
+    {
+        psBus->ui32TxChannel = ui32TxMapping & 0xff;
+        psBus->ui32RxChannel = ui32RxMapping & 0xff;
+
+        MAP_uDMAChannelAssign(ui32TxMapping);
+        MAP_uDMAChannelAssign(ui32RxMapping);
+        MAP_uDMAChannelAttributeDisable(psBus->ui32TxChannel, UDMA_ATTR_ALL);
+        MAP_uDMAChannelAttributeDisable(psBus->ui32RxChannel, UDMA_ATTR_ALL);
+        MAP_uDMAChannelAttributeEnable(psBus->ui32RxChannel,
+                                       UDMA_ATTR_HIGH_PRIORITY);
+    }
+}
+
+//*****************************************************************************
+//
+//! Initializes a device on a shared SPI bus.
+//!
+//! \param psDevice is a pointer to the device.
+//! \param ui32BitRate is the bit rate of the device.
+//! \param ui32Protocol is the frame format of the device, one of
+//! \b SSI_FRF_MOTO_MODE_0, \b SSI_FRF_MOTO_MODE_1, \b SSI_FRF_MOTO_MODE_2 or
+//! \b SSI_FRF_MOTO_MODE_3.
+//! \param ui32CSPort is the base address of the GPIO port of the chip select
+//! of the device.
+//! \param ui8CSPin is the pin of the chip select.
+//!
+//! This function configures the chip select pin as an output and drives it
+//! high.  The GPIO port must already be enabled.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SPIBusDeviceInit(tSPIBusDevice *psDevice, uint32_t ui32BitRate,
+                 uint32_t ui32Protocol, uint32_t ui32CSPort, uint8_t ui8CSPin)
+{
+    ASSERT(psDevice);
+    ASSERT((ui32Protocol == SSI_FRF_MOTO_MODE_0) ||
+           (ui32Protocol == SSI_FRF_MOTO_MODE_1) ||
+           (ui32Protocol == SSI_FRF_MOTO_MODE_2) ||
+           (ui32Protocol == SSI_FRF_MOTO_MODE_3));
+
+    psDevice->ui32BitRate = ui32BitRate;
+    psDevice->ui32Protocol = ui32Protocol;
+    psDevice->ui32CSPort = ui32CSPort;
+    psDevice->ui8CSPin = ui8CSPin;
+
+    MAP_GPIOPinTypeGPIOOutput(ui32CSPort, ui8CSPin);
+    MAP_GPIOPinWrite(ui32CSPort, ui8CSPin, ui8CSPin);
+}
+
+//*****************************************************************************
+//
+//! Queues a transfer.
+//!
+//! \param psBus is a pointer to the bus state.
+//! \param psTransfer is a pointer to the transfer.
+//!
+//! This function adds a transfer to the end of the queue and returns
+//! immediately; the transfer is started at once if the bus is idle.  The
+//! status of the transfer is \b SPI_BUS_PENDING until it completes, at which
+//! time its callback is called.  This function may be called from the
+//! callback of another transfer.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SPIBusSubmit(tSPIBus *psBus, tSPIBusTransfer *psTransfer)
+{
+    bool bIntsOff;
+
+    ASSERT(psBus);
+    ASSERT(psTransfer && psTransfer->psDevice);
+    ASSERT(psTransfer->ui32HeaderLen || psTransfer->ui32Count);
+
+    psTransfer->psNext = 0;
+    psTransfer->ui32Status = SPI_BUS_PENDING;
+
+    bIntsOff = MAP_IntMasterDisable();
+
+    if(psBus->psHead)
+    {
+        psBus->psTail->psNext = psTransfer;
+        psBus->psTail = psTransfer;
+    }
+    else
+    {
+        psBus->psHead = psTransfer;
+        psBus->psTail = psTransfer;
+        SPIBusTransferStart(psBus);
+    }
+
+    if(!bIntsOff)
+    {
+        MAP_IntMasterEnable();
+    }
+}
+
+//*****************************************************************************
+//
+//! Determines whether any transfers are queued.
+//!
+//! \param psBus is a pointer to the bus state.
+//!
+//! \return Returns \b true if a transfer is in progress or queued and
+//! \b false otherwise.
+//
+//*****************************************************************************
+bool
+SPIBusBusy(tSPIBus *psBus)
+{
+    ASSERT(psBus);
+
+    return(psBus->psHead != 0);
+}
+
+//*****************************************************************************
+//
+//! Informs a shared SPI bus of a new system clock rate.
+//!
+//! \param pvCBData is a pointer to the bus state.
+//! \param ui32SysClock is the new system clock rate, in Hz.
+//!
+//! This function records the new rate of the clock supplied to the SSI
+//! module, so that the bit rate of each device is recomputed before its next
+//! transfer.  It has the form of a clock tree callback, so it may be passed
+//! to ClockTreeRegister() with the bus state as the callback data, or it may
+//! be called directly by an application that changes the system clock.  A
+//! transfer in progress when the clock changes completes at a bit rate scaled
+//! by the change.  This function must not be used for an SSI module that is
+//! clocked from the PIOSC.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SPIBusClockChanged(void *pvCBData, uint32_t ui32SysClock)
+{
+    tSPIBus *psBus;
+
+    psBus = (tSPIBus *)pvCBData;
+    ASSERT(psBus);
+
+    //
+    // Forget the configured device so that the next transfer reprograms the
+    // SSI module from the new clock rate.
+    //
+    psBus->ui32Clock = ui32SysClock;
+    psBus->psConfigured = 0;
+}
+
+//*****************************************************************************
+//
+//! Handles the interrupt of a shared SPI bus.
+//!
+//! \param psBus is a pointer to the bus state.
+//!
+//! This function must be called from the interrupt handler of the SSI
+//! module.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SPIBusIntHandler(tSPIBus *psBus)
+{
+    uint32_t ui32Status;
+
+    ASSERT(psBus);
+
+    ui32Status = HWREG(psBus->ui32Base + SSI_O_MIS);
+    HWREG(psBus->ui32Base + SSI_O_ICR) = ui32Status;
+
+    if((psBus->psHead == 0) || (psBus->ui8State == STATE_IDLE))
+    {
+        return;
+    }
+
+    //
+    // The last byte of a write-only phase has been shifted out.
+    //
+    if(psBus->ui8State == STATE_DRAIN)
+    {
+        if(ui32Status & SSI_MIS_EOTMIS)
+        {
+            psBus->ui8State = STATE_IDLE;
+            SPIBusPhaseDone(psBus);
+        }
+        return;
+    }
+
+    if(psBus->bPhaseDMA)
+    {
+        if(SPIBusDMADone(psBus, ui32Status))
+        {
+            psBus->ui32Pos += psBus->ui32Chunk;
+            psBus->ui32TxPos = psBus->ui32Pos;
+        }
+        else
+        {
+            return;
+        }
+
+        if(psBus->ui32Pos < psBus->ui32Count)
+        {
+            SPIBusDMAChunk(psBus);
+            return;
+        }
+    }
+    else
+    {
+        SPIBusFIFOService(psBus);
+
+        if((psBus->ui8State == STATE_DUPLEX) &&
+           (psBus->ui32Pos < psBus->ui32Count))
+        {
+            return;
+        }
+        if((psBus->ui8State == STATE_WRITE) &&
+           (psBus->ui32TxPos < psBus->ui32Count))
+        {
+            return;
+        }
+    }
+
+    //
+    // Wait for a write-only phase to be shifted out before finishing it.
+    //
+    if(psBus->ui8State == STATE_WRITE)
+    {
+        SPIBusDrain(psBus);
+        if(psBus->ui8State != STATE_IDLE)
+        {
+            return;
+        }
+    }
+
+    SPIBusPhaseDone(psBus);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,289 @@
+//*****************************************************************************
+//
+// spibus.h - Prototypes for the shared, queued SPI bus driver.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __SPIBUS_H__
+#define __SPIBUS_H__
+
+//*****************************************************************************
+//
+// If building with a C++ compiler, make all of the definitions in this header
+// have a C binding.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//*****************************************************************************
+//
+//! \addtogroup spibus_api
+//! @{
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+//! The value passed to SPIBusInit() in place of a uDMA channel mapping when
+//! the bus should not use the uDMA controller.
+//
+//*****************************************************************************
+#define SPI_BUS_NO_DMA          0xffffffff
+
+//*****************************************************************************
+//
+//! The smallest transfer, in bytes, that is made with the uDMA controller.
+//! Shorter transfers are moved through the FIFOs by the interrupt handler,
+//! which avoids the cost of setting up the uDMA channels.
+//
+//*****************************************************************************
+#ifndef SPI_BUS_DMA_MIN
+#define SPI_BUS_DMA_MIN         16
+#endif
+
+//*****************************************************************************
+//
+//! The status of a transfer that has been queued but has not completed.
+//
+//*****************************************************************************
+#define SPI_BUS_PENDING         0
+
+//*****************************************************************************
+//
+//! The status of a transfer that has completed.
+//
+//*****************************************************************************
+#define SPI_BUS_DONE            1
+
+//*****************************************************************************
+//
+//! This structure describes a device on the bus.  The bus is reconfigured
+//! for the device before each of its transfers, unless the previous transfer
+//! was for the same device.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The bit rate of the device.
+    //
+    uint32_t ui32BitRate;
+
+    //
+    //! The frame format of the device, one of the \b SSI_FRF_MOTO_MODE_x
+    //! values.
+    //
+    uint32_t ui32Protocol;
+
+    //
+    //! The base address of the GPIO port and the pin used as the chip select
+    //! of the device, which is driven low for each transfer.
+    //
+    uint32_t ui32CSPort;
+    uint8_t ui8CSPin;
+}
+tSPIBusDevice;
+
+//*****************************************************************************
+//
+//! The prototype for the function that is called when a transfer completes.
+//! It is called from the SSI interrupt handler.
+//
+//*****************************************************************************
+typedef void (*tSPIBusCallback)(void *pvCBData);
+
+//*****************************************************************************
+//
+//! This structure describes a single transfer, made with the chip select of
+//! the device asserted.  An optional header, such as a command and address,
+//! is written first; then the data is transferred in full duplex.  The
+//! structure is owned by the driver from the time that it is passed to
+//! SPIBusSubmit() until it completes.
+//
+//*****************************************************************************
+typedef struct tSPIBusTransfer
+{
+    //
+    //! The next transfer in the queue.
+    //
+    struct tSPIBusTransfer *psNext;
+
+    //
+    //! The device to which the transfer is made.
+    //
+    tSPIBusDevice *psDevice;
+
+    //
+    //! The header bytes and the number of them.  The bytes received while
+    //! the header is written are discarded.
+    //
+    const uint8_t *pui8Header;
+    uint32_t ui32HeaderLen;
+
+    //
+    //! The data to write, or NULL to write 0xff bytes.
+    //
+    const uint8_t *pui8Tx;
+
+    //
+    //! The buffer for the data received, or NULL to discard it.
+    //
+    uint8_t *pui8Rx;
+
+    //
+    //! The number of data bytes to transfer.
+    //
+    uint32_t ui32Count;
+
+    //
+    //! The function called when the transfer completes, or NULL, and the
+    //! data pointer passed to it.
+    //
+    tSPIBusCallback pfnCallback;
+    void *pvCBData;
+
+    //
+    //! The status of the transfer, either \b SPI_BUS_PENDING or
+    //! \b SPI_BUS_DONE.
+    //
+    volatile uint32_t ui32Status;
+}
+tSPIBusTransfer;
+
+//*****************************************************************************
+//
+//! This structure contains the state of a shared SPI bus.  The members are
+//! set by SPIBusInit() and should not be accessed or modified by the
+//! application.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    //! The base address of the SSI module and the clock supplied to it.
+    //
+    uint32_t ui32Base;
+    uint32_t ui32Clock;
+
+    //
+    //! The uDMA channels used for transmit and receive, if bDMA is set.
+    //
+    uint32_t ui32TxChannel;
+    uint32_t ui32RxChannel;
+    bool bDMA;
+
+    //
+    //! Indicates that the SSI module supports the advanced modes, which
+    //! are used to make write-only transfers without filling the receive
+    //! FIFO.
+    //
+    bool bAdvanced;
+
+    //
+    //! The transfer in progress, which is the head of the queue, and the
+    //! last transfer in the queue.
+    //
+    tSPIBusTransfer * volatile psHead;
+    tSPIBusTransfer *psTail;
+
+    //
+    //! The device for which the SSI module is configured.
+    //
+    tSPIBusDevice *psConfigured;
+
+    //
+    //! The state of the current phase of the transfer.
+    //
+    uint8_t ui8State;
+
+    //
+    //! Indicates that the current phase is the header.
+    //
+    bool bHeader;
+
+    //
+    //! Indicates that the current phase uses the uDMA controller.
+    //
+    bool bPhaseDMA;
+
+    //
+    //! The data of the current phase.
+    //
+    const uint8_t *pui8Tx;
+    uint8_t *pui8Rx;
+    uint32_t ui32Count;
+
+    //
+    //! The number of bytes of the current phase that have been completed,
+    //! the number written to the transmit FIFO, and the number in the uDMA
+    //! transfer in progress.
+    //
+    uint32_t ui32Pos;
+    uint32_t ui32TxPos;
+    uint32_t ui32Chunk;
+
+    //
+    //! The destination for received bytes that are discarded.
+    //
+    uint8_t ui8Discard;
+
+    //
+    //! The number of transfers completed.
+    //
+    volatile uint32_t ui32Transfers;
+}
+tSPIBus;
+
+//*****************************************************************************
+//
+// Prototypes for the APIs.
+//
+//*****************************************************************************
+extern void SPIBusInit(tSPIBus *psBus, uint32_t ui32Base, uint32_t ui32Clock,
+                       uint32_t ui32TxMapping, uint32_t ui32RxMapping);
+extern void SPIBusDeviceInit(tSPIBusDevice *psDevice, uint32_t ui32BitRate,
+                             uint32_t ui32Protocol, uint32_t ui32CSPort,
+                             uint8_t ui8CSPin);
+extern void SPIBusSubmit(tSPIBus *psBus, tSPIBusTransfer *psTransfer);
+extern bool SPIBusBusy(tSPIBus *psBus);
+extern void SPIBusClockChanged(void *pvCBData, uint32_t ui32SysClock);
+extern void SPIBusIntHandler(tSPIBus *psBus);
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// Mark the end of the C bindings section for C++ compilers.
+//
+//*****************************************************************************
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SPIBUS_H__
@@ -0,0 +1,1101 @@
+//*****************************************************************************
+//
+// canqueue_test.c - Host tests for the queued CAN engine.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "inc/hw_types.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// The CAN engine and the driverlib CAN functions are built into this test
+// with every register access redirected to a model of the CAN controller.
+// The model sees each access when HWREG() is evaluated, and applies the side
+// effects of the access (an interface register transfer, or the clearing of
+// the status interrupt) when the next access is made or when CANModelSync()
+// is called.  A write is recognized by a change in the register's value.
+//
+//*****************************************************************************
+static volatile uint32_t *CANModelReg(uintptr_t uiAddr);
+
+#undef HWREG
+#define HWREG(x)                (*CANModelReg((uintptr_t)(x)))
+
+#include "driverlib/can.c"
+#include "utils/canqueue.c"
+
+//*****************************************************************************
+//
+// The number of 32-bit registers modeled, covering the register map up to
+// and including the message valid registers.
+//
+//*****************************************************************************
+#define MODEL_NUM_REGS          ((CAN_O_MSG2VAL / 4) + 1)
+
+//*****************************************************************************
+//
+// An access that has not yet been applied.
+//
+//*****************************************************************************
+#define MODEL_NO_ACCESS         0xffffffff
+
+//*****************************************************************************
+//
+// The largest number of frames recorded as transmitted on the bus.
+//
+//*****************************************************************************
+#define MODEL_MAX_SENT          32
+
+//*****************************************************************************
+//
+// The number of times that the interrupt register may be read during one
+// call of the interrupt handler before the interrupt is considered stuck.
+//
+//*****************************************************************************
+#define MODEL_MAX_INT_READS     64
+
+//*****************************************************************************
+//
+// A message object in the controller's message RAM.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Msk1;
+    uint32_t ui32Msk2;
+    uint32_t ui32Arb1;
+    uint32_t ui32Arb2;
+    uint32_t ui32MCtl;
+    uint32_t pui32Data[4];
+}
+tModelObj;
+
+//*****************************************************************************
+//
+// The state of the controller model.
+//
+//*****************************************************************************
+static struct
+{
+    //
+    // The register file as seen by the software.
+    //
+    uint32_t pui32Reg[MODEL_NUM_REGS];
+
+    //
+    // The message RAM.
+    //
+    tModelObj psObj[NUM_MSG_OBJS];
+
+    //
+    // The offset and prior value of the register accessed last, or
+    // MODEL_NO_ACCESS.
+    //
+    uint32_t ui32LastOffset;
+    uint32_t ui32LastValue;
+
+    //
+    // Indicates that a status interrupt is pending.
+    //
+    bool bStatusInt;
+
+    //
+    // The frames transmitted on the bus, in order.
+    //
+    tCANQueueMsg psSent[MODEL_MAX_SENT];
+    uint32_t ui32NumSent;
+
+    //
+    // The number of interface register transfers requested.
+    //
+    uint32_t ui32Transfers;
+
+    //
+    // The number of reads of the interrupt register since the interrupt
+    // handler was last called.
+    //
+    uint32_t ui32IntReads;
+}
+g_sModel;
+
+//*****************************************************************************
+//
+// Counts a failed ASSERT in the engine or in driverlib.
+//
+//*****************************************************************************
+void
+__error__(char *pcFilename, uint32_t ui32Line)
+{
+    CHECK(!"ASSERT");
+    printf("  from %s:%u\n", pcFilename, (unsigned)ui32Line);
+}
+
+//*****************************************************************************
+//
+// Interrupt controller functions used by the engine and by driverlib.  The
+// tests run in a single thread, so there is nothing to mask.
+//
+//*****************************************************************************
+bool
+IntMasterDisable(void)
+{
+    return(false);
+}
+
+bool
+IntMasterEnable(void)
+{
+    return(false);
+}
+
+void
+IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void))
+{
+}
+
+void
+IntUnregister(uint32_t ui32Interrupt)
+{
+}
+
+void
+IntEnable(uint32_t ui32Interrupt)
+{
+}
+
+void
+IntDisable(uint32_t ui32Interrupt)
+{
+}
+
+//*****************************************************************************
+//
+// Copies between an interface register set and a message object, as the
+// controller does when the command request register is written.
+//
+//*****************************************************************************
+static void
+CANModelTransfer(uint32_t ui32IF, uint32_t ui32Obj)
+{
+    uint32_t *pui32Reg, ui32Cmd;
+    tModelObj *psObj;
+
+    CHECK((ui32Obj >= 1) && (ui32Obj <= NUM_MSG_OBJS));
+    if((ui32Obj < 1) || (ui32Obj > NUM_MSG_OBJS))
+    {
+        return;
+    }
+
+    g_sModel.ui32Transfers++;
+
+    pui32Reg = &g_sModel.pui32Reg[ui32IF / 4];
+    psObj = &g_sModel.psObj[ui32Obj - 1];
+    ui32Cmd = pui32Reg[(CAN_O_IF1CMSK - CAN_O_IF1CRQ) / 4];
+
+#define IFREG(off)              pui32Reg[((off) - CAN_O_IF1CRQ) / 4]
+
+    if(ui32Cmd & CAN_IF1CMSK_WRNRD)
+    {
+        if(ui32Cmd & CAN_IF1CMSK_MASK)
+        {
+            psObj->ui32Msk1 = IFREG(CAN_O_IF1MSK1);
+            psObj->ui32Msk2 = IFREG(CAN_O_IF1MSK2);
+        }
+        if(ui32Cmd & CAN_IF1CMSK_ARB)
+        {
+            psObj->ui32Arb1 = IFREG(CAN_O_IF1ARB1);
+            psObj->ui32Arb2 = IFREG(CAN_O_IF1ARB2);
+        }
+        if(ui32Cmd & CAN_IF1CMSK_CONTROL)
+        {
+            psObj->ui32MCtl = IFREG(CAN_O_IF1MCTL);
+        }
+        else if(ui32Cmd & CAN_IF1CMSK_TXRQST)
+        {
+            psObj->ui32MCtl |= CAN_IF1MCTL_TXRQST;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_DATAA)
+        {
+            psObj->pui32Data[0] = IFREG(CAN_O_IF1DA1);
+            psObj->pui32Data[1] = IFREG(CAN_O_IF1DA2);
+        }
+        if(ui32Cmd & CAN_IF1CMSK_DATAB)
+        {
+            psObj->pui32Data[2] = IFREG(CAN_O_IF1DB1);
+            psObj->pui32Data[3] = IFREG(CAN_O_IF1DB2);
+        }
+    }
+    else
+    {
+        if(ui32Cmd & CAN_IF1CMSK_MASK)
+        {
+            IFREG(CAN_O_IF1MSK1) = psObj->ui32Msk1;
+            IFREG(CAN_O_IF1MSK2) = psObj->ui32Msk2;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_ARB)
+        {
+            IFREG(CAN_O_IF1ARB1) = psObj->ui32Arb1;
+            IFREG(CAN_O_IF1ARB2) = psObj->ui32Arb2;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_CONTROL)
+        {
+            IFREG(CAN_O_IF1MCTL) = psObj->ui32MCtl;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_DATAA)
+        {
+            IFREG(CAN_O_IF1DA1) = psObj->pui32Data[0];
+            IFREG(CAN_O_IF1DA2) = psObj->pui32Data[1];
+        }
+        if(ui32Cmd & CAN_IF1CMSK_DATAB)
+        {
+            IFREG(CAN_O_IF1DB1) = psObj->pui32Data[2];
+            IFREG(CAN_O_IF1DB2) = psObj->pui32Data[3];
+        }
+
+        //
+        // The new data and interrupt pending bits are cleared after they
+        // have been copied.
+        //
+        if(ui32Cmd & CAN_IF1CMSK_CLRINTPND)
+        {
+            psObj->ui32MCtl &= ~CAN_IF1MCTL_INTPND;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_NEWDAT)
+        {
+            psObj->ui32MCtl &= ~CAN_IF1MCTL_NEWDAT;
+        }
+    }
+
+#undef IFREG
+}
+
+//*****************************************************************************
+//
+// Applies the side effects of the previous register access.
+//
+//*****************************************************************************
+static void
+CANModelSync(void)
+{
+    uint32_t ui32Offset, ui32Value, *pui32Reg;
+    bool bWrite;
+
+    if(g_sModel.ui32LastOffset == MODEL_NO_ACCESS)
+    {
+        return;
+    }
+
+    ui32Offset = g_sModel.ui32LastOffset;
+    g_sModel.ui32LastOffset = MODEL_NO_ACCESS;
+    pui32Reg = &g_sModel.pui32Reg[ui32Offset / 4];
+    ui32Value = *pui32Reg;
+    bWrite = (ui32Value != g_sModel.ui32LastValue) ? true : false;
+
+    switch(ui32Offset)
+    {
+        //
+        // Writing a message number starts a transfer, which the model
+        // completes at once, so the busy bit always reads as clear.
+        //
+        case CAN_O_IF1CRQ:
+        case CAN_O_IF2CRQ:
+        {
+            if(bWrite)
+            {
+                CANModelTransfer(ui32Offset, ui32Value & CAN_IF1CRQ_MNUM_M);
+            }
+            *pui32Reg = 0;
+            break;
+        }
+
+        //
+        // Reading the status register clears the status interrupt.  Only the
+        // last error code and the transfer flags may be written.
+        //
+        case CAN_O_STS:
+        {
+            g_sModel.bStatusInt = false;
+            if(bWrite)
+            {
+                *pui32Reg = ((g_sModel.ui32LastValue &
+                              ~(CAN_STS_LEC_M | CAN_STS_TXOK |
+                                CAN_STS_RXOK)) |
+                             (ui32Value & (CAN_STS_LEC_M | CAN_STS_TXOK |
+                                           CAN_STS_RXOK)));
+            }
+            break;
+        }
+
+        //
+        // Leaving initialization mode after going bus-off starts recovery,
+        // which the model completes at once.
+        //
+        case CAN_O_CTL:
+        {
+            if(bWrite && !(ui32Value & CAN_CTL_INIT))
+            {
+                g_sModel.pui32Reg[CAN_O_STS / 4] &= ~CAN_STS_BOFF;
+            }
+            break;
+        }
+
+        //
+        // The interrupt registers are read-only.
+        //
+        case CAN_O_INT:
+        case CAN_O_MSG1INT:
+        case CAN_O_MSG2INT:
+        {
+            CHECK(!bWrite);
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the interrupt identifier: the status interrupt if it is pending,
+// otherwise the lowest-numbered message object with a pending interrupt.
+//
+//*****************************************************************************
+static uint32_t
+CANModelIntID(void)
+{
+    uint32_t ui32Obj;
+
+    if(g_sModel.bStatusInt)
+    {
+        return(CAN_INT_INTID_STATUS);
+    }
+
+    for(ui32Obj = 0; ui32Obj < NUM_MSG_OBJS; ui32Obj++)
+    {
+        if(g_sModel.psObj[ui32Obj].ui32MCtl & CAN_IF1MCTL_INTPND)
+        {
+            return(ui32Obj + 1);
+        }
+    }
+
+    return(CAN_INT_INTID_NONE);
+}
+
+//*****************************************************************************
+//
+// Returns the message objects with a pending interrupt, with bit 0 for
+// message object 1.
+//
+//*****************************************************************************
+static uint32_t
+CANModelIntPending(void)
+{
+    uint32_t ui32Obj, ui32Pending;
+
+    ui32Pending = 0;
+    for(ui32Obj = 0; ui32Obj < NUM_MSG_OBJS; ui32Obj++)
+    {
+        if(g_sModel.psObj[ui32Obj].ui32MCtl & CAN_IF1MCTL_INTPND)
+        {
+            ui32Pending |= 1 << ui32Obj;
+        }
+    }
+
+    return(ui32Pending);
+}
+
+//*****************************************************************************
+//
+// Returns the register at an address, after applying the previous access and
+// bringing the value of the read-only registers up to date.
+//
+//*****************************************************************************
+static volatile uint32_t *
+CANModelReg(uintptr_t uiAddr)
+{
+    uint32_t ui32Offset;
+
+    CANModelSync();
+
+    CHECK((uiAddr >= CAN0_BASE) &&
+          (uiAddr < (CAN0_BASE + (MODEL_NUM_REGS * 4))));
+    ui32Offset = (uiAddr - CAN0_BASE) & ~3;
+    if(ui32Offset >= (MODEL_NUM_REGS * 4))
+    {
+        ui32Offset = 0;
+    }
+
+    switch(ui32Offset)
+    {
+        case CAN_O_INT:
+        {
+            //
+            // Report an interrupt that the handler fails to clear, and
+            // release the handler from its loop.
+            //
+            if(++g_sModel.ui32IntReads == MODEL_MAX_INT_READS)
+            {
+                CHECK(!"interrupt not cleared");
+            }
+            g_sModel.pui32Reg[ui32Offset / 4] =
+                ((g_sModel.ui32IntReads < MODEL_MAX_INT_READS) ?
+                 CANModelIntID() : CAN_INT_INTID_NONE);
+            break;
+        }
+
+        case CAN_O_MSG1INT:
+        {
+            g_sModel.pui32Reg[ui32Offset / 4] = CANModelIntPending() & 0xffff;
+            break;
+        }
+
+        case CAN_O_MSG2INT:
+        {
+            g_sModel.pui32Reg[ui32Offset / 4] = CANModelIntPending() >> 16;
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    g_sModel.ui32LastOffset = ui32Offset;
+    g_sModel.ui32LastValue = g_sModel.pui32Reg[ui32Offset / 4];
+
+    return(&g_sModel.pui32Reg[ui32Offset / 4]);
+}
+
+//*****************************************************************************
+//
+// Returns the identifier held in the arbitration or mask fields of a message
+// object.
+//
+//*****************************************************************************
+static uint32_t
+CANModelID(uint32_t ui32Reg1, uint32_t ui32Reg2, bool bExtended)
+{
+    if(bExtended)
+    {
+        return(((ui32Reg2 & CAN_IF1ARB2_ID_M) << 16) | (ui32Reg1 & 0xffff));
+    }
+
+    return((ui32Reg2 & CAN_IF1ARB2_ID_M) >> 2);
+}
+
+//*****************************************************************************
+//
+// Receives a frame from the bus.  The frame is stored in the first matching
+// receive message object that does not hold new data.  If every matching
+// object of a FIFO holds new data, the frame overwrites the last one, whose
+// message lost bit is set.
+//
+//*****************************************************************************
+static bool
+CANModelReceive(uint32_t ui32ID, bool bExtended, const uint8_t *pui8Data,
+                uint32_t ui32Len)
+{
+    uint32_t ui32Obj, ui32Mask, ui32Idx;
+    tModelObj *psObj;
+    bool bObjExt;
+
+    CANModelSync();
+
+    for(ui32Obj = 0; ui32Obj < NUM_MSG_OBJS; ui32Obj++)
+    {
+        psObj = &g_sModel.psObj[ui32Obj];
+
+        if(!(psObj->ui32Arb2 & CAN_IF1ARB2_MSGVAL) ||
+           (psObj->ui32Arb2 & CAN_IF1ARB2_DIR))
+        {
+            continue;
+        }
+
+        bObjExt = (psObj->ui32Arb2 & CAN_IF1ARB2_XTD) ? true : false;
+        if(psObj->ui32MCtl & CAN_IF1MCTL_UMASK)
+        {
+            ui32Mask = CANModelID(psObj->ui32Msk1, psObj->ui32Msk2, bObjExt);
+            if((psObj->ui32Msk2 & CAN_IF1MSK2_MXTD) && (bObjExt != bExtended))
+            {
+                continue;
+            }
+        }
+        else
+        {
+            ui32Mask = 0x1fffffff;
+            if(bObjExt != bExtended)
+            {
+                continue;
+            }
+        }
+        if((ui32ID ^ CANModelID(psObj->ui32Arb1, psObj->ui32Arb2, bObjExt)) &
+           ui32Mask)
+        {
+            continue;
+        }
+
+        //
+        // Pass over a FIFO entry that already holds a message.
+        //
+        if((psObj->ui32MCtl & CAN_IF1MCTL_NEWDAT) &&
+           !(psObj->ui32MCtl & CAN_IF1MCTL_EOB))
+        {
+            continue;
+        }
+
+        if(psObj->ui32MCtl & CAN_IF1MCTL_NEWDAT)
+        {
+            psObj->ui32MCtl |= CAN_IF1MCTL_MSGLST;
+        }
+
+        if(bExtended)
+        {
+            psObj->ui32Arb1 = ui32ID & 0xffff;
+            psObj->ui32Arb2 = ((psObj->ui32Arb2 & ~CAN_IF1ARB2_ID_M) |
+                               ((ui32ID >> 16) & CAN_IF1ARB2_ID_M));
+        }
+        else
+        {
+            psObj->ui32Arb2 = ((psObj->ui32Arb2 & ~CAN_IF1ARB2_ID_M) |
+                               ((ui32ID << 2) & CAN_IF1ARB2_ID_M));
+        }
+
+        for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+        {
+            psObj->pui32Data[ui32Idx] =
+                ((((ui32Idx * 2) < ui32Len) ? pui8Data[ui32Idx * 2] : 0) |
+                 ((((ui32Idx * 2) + 1) < ui32Len) ?
+                  (pui8Data[(ui32Idx * 2) + 1] << 8) : 0));
+        }
+
+        psObj->ui32MCtl = ((psObj->ui32MCtl & ~CAN_IF1MCTL_DLC_M) | ui32Len |
+                           CAN_IF1MCTL_NEWDAT);
+        if(psObj->ui32MCtl & CAN_IF1MCTL_RXIE)
+        {
+            psObj->ui32MCtl |= CAN_IF1MCTL_INTPND;
+        }
+
+        return(true);
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Sends the pending transmit message object with the lowest number on the
+// bus.  Returns the message object number, or 0 if none are pending.
+//
+//*****************************************************************************
+static uint32_t
+CANModelTransmit(void)
+{
+    uint32_t ui32Obj, ui32Idx;
+    tCANQueueMsg *psMsg;
+    tModelObj *psObj;
+
+    CANModelSync();
+
+    for(ui32Obj = 0; ui32Obj < NUM_MSG_OBJS; ui32Obj++)
+    {
+        psObj = &g_sModel.psObj[ui32Obj];
+
+        if((psObj->ui32Arb2 & (CAN_IF1ARB2_MSGVAL | CAN_IF1ARB2_DIR)) !=
+           (CAN_IF1ARB2_MSGVAL | CAN_IF1ARB2_DIR))
+        {
+            continue;
+        }
+        if(!(psObj->ui32MCtl & CAN_IF1MCTL_TXRQST))
+        {
+            continue;
+        }
+
+        if(g_sModel.ui32NumSent < MODEL_MAX_SENT)
+        {
+            psMsg = &g_sModel.psSent[g_sModel.ui32NumSent++];
+            psMsg->ui8Flags = ((psObj->ui32Arb2 & CAN_IF1ARB2_XTD) ?
+                               CAN_QUEUE_EXTENDED : 0);
+            psMsg->ui32ID = CANModelID(psObj->ui32Arb1, psObj->ui32Arb2,
+                                       psMsg->ui8Flags ? true : false);
+            psMsg->ui8Len = psObj->ui32MCtl & CAN_IF1MCTL_DLC_M;
+            for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+            {
+                psMsg->pui8Data[ui32Idx] =
+                    psObj->pui32Data[ui32Idx / 2] >> ((ui32Idx & 1) * 8);
+            }
+        }
+
+        psObj->ui32MCtl &= ~CAN_IF1MCTL_TXRQST;
+        if(psObj->ui32MCtl & CAN_IF1MCTL_TXIE)
+        {
+            psObj->ui32MCtl |= CAN_IF1MCTL_INTPND;
+        }
+
+        return(ui32Obj + 1);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Signals an error on the bus, optionally taking the controller bus-off.
+//
+//*****************************************************************************
+static void
+CANModelError(uint32_t ui32LEC, bool bBusOff)
+{
+    uint32_t *pui32Sts;
+
+    CANModelSync();
+
+    pui32Sts = &g_sModel.pui32Reg[CAN_O_STS / 4];
+    *pui32Sts = (*pui32Sts & ~CAN_STS_LEC_M) | ui32LEC;
+    if(bBusOff)
+    {
+        *pui32Sts |= CAN_STS_BOFF;
+        g_sModel.pui32Reg[CAN_O_CTL / 4] |= CAN_CTL_INIT;
+    }
+    if(g_sModel.pui32Reg[CAN_O_CTL / 4] & CAN_CTL_EIE)
+    {
+        g_sModel.bStatusInt = true;
+    }
+}
+
+//*****************************************************************************
+//
+// Resets the model and initializes the controller as an application would.
+//
+//*****************************************************************************
+static void
+CANModelReset(void)
+{
+    memset(&g_sModel, 0, sizeof(g_sModel));
+    g_sModel.ui32LastOffset = MODEL_NO_ACCESS;
+
+    CANInit(CAN0_BASE);
+    CANModelSync();
+}
+
+//*****************************************************************************
+//
+// Calls the interrupt handler of a queue, as the controller's interrupt
+// would, and applies its last register access.
+//
+//*****************************************************************************
+static void
+CANModelInterrupt(tCANQueue *psQueue)
+{
+    g_sModel.ui32IntReads = 0;
+
+    CANQueueIntHandler(psQueue);
+    CANModelSync();
+}
+
+//*****************************************************************************
+//
+// The acceptance filters used by the tests: a four-deep FIFO for standard
+// identifiers 0x100 to 0x10f, and a two-deep FIFO for one group of extended
+// identifiers.
+//
+//*****************************************************************************
+static const tCANQueueFilter g_psFilters[2] =
+{
+    { 0x100, 0x7f0, 0, 4 },
+    { 0x18ff0000, 0x1fffff00, CAN_QUEUE_EXTENDED, 2 }
+};
+
+//*****************************************************************************
+//
+// The queue under test, its buffers and its statistics table.
+//
+//*****************************************************************************
+static tCANQueue g_sQueue;
+static tCANQueueMsg g_psRxBuf[8];
+static tCANQueueMsg g_psTxBuf[8];
+static tCANQueueIDStats g_psStats[3];
+
+//*****************************************************************************
+//
+// Sets up the model and the queue, with the given receive queue size.
+//
+//*****************************************************************************
+static void
+QueueSetup(uint32_t ui32RxSize)
+{
+    CANModelReset();
+
+    CHECK(CANQueueInit(&g_sQueue, CAN0_BASE, g_psFilters, 2, 4, g_psRxBuf,
+                       ui32RxSize, g_psTxBuf, 8));
+
+    g_psStats[0].ui32ID = 0x101;
+    g_psStats[1].ui32ID = 0x102;
+    g_psStats[2].ui32ID = 0x18ff0012;
+    CANQueueStatsSet(&g_sQueue, g_psStats, 3);
+
+    CANEnable(CAN0_BASE);
+    CANModelSync();
+}
+
+//*****************************************************************************
+//
+// Builds a standard-identifier message whose data encodes its identifier
+// and a sequence number.
+//
+//*****************************************************************************
+static void
+MsgFill(tCANQueueMsg *psMsg, uint32_t ui32ID, uint8_t ui8Flags,
+        uint32_t ui32Seq)
+{
+    uint32_t ui32Idx;
+
+    psMsg->ui32ID = ui32ID;
+    psMsg->ui8Flags = ui8Flags;
+    psMsg->ui8Len = (ui32Seq % 8) + 1;
+    for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+    {
+        psMsg->pui8Data[ui32Idx] = (ui32Idx < psMsg->ui8Len) ?
+                                   (uint8_t)(ui32Seq + ui32Idx) : 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns true if two messages have the same identifier, length and data.
+//
+//*****************************************************************************
+static bool
+MsgSame(const tCANQueueMsg *psA, const tCANQueueMsg *psB)
+{
+    return((psA->ui32ID == psB->ui32ID) && (psA->ui8Len == psB->ui8Len) &&
+           ((psA->ui8Flags & CAN_QUEUE_EXTENDED) ==
+            (psB->ui8Flags & CAN_QUEUE_EXTENDED)) &&
+           (memcmp(psA->pui8Data, psB->pui8Data, psA->ui8Len) == 0));
+}
+
+//*****************************************************************************
+//
+// Tests that the message objects are laid out as documented.
+//
+//*****************************************************************************
+static void
+TestInit(void)
+{
+    tCANQueue sQueue;
+    tCANQueueFilter psMany[2];
+    uint32_t ui32Obj;
+
+    QueueSetup(8);
+
+    //
+    // Objects 1-4 and 5-6 are the two receive FIFOs, each ending with the
+    // end of buffer bit, and objects 29-32 are used for transmission.
+    //
+    CHECK(g_sQueue.ui32RxObjs == 0x3f);
+    CHECK(g_sQueue.ui32TxFirst == 29);
+    for(ui32Obj = 1; ui32Obj <= 6; ui32Obj++)
+    {
+        CHECK(g_sModel.psObj[ui32Obj - 1].ui32Arb2 & CAN_IF1ARB2_MSGVAL);
+        CHECK(((g_sModel.psObj[ui32Obj - 1].ui32MCtl & CAN_IF1MCTL_EOB) !=
+               0) == ((ui32Obj == 4) || (ui32Obj == 6)));
+    }
+    CHECK(!(g_sModel.psObj[6].ui32Arb2 & CAN_IF1ARB2_MSGVAL));
+    CHECK(g_sModel.pui32Reg[CAN_O_CTL / 4] & CAN_CTL_IE);
+    CHECK(g_sModel.pui32Reg[CAN_O_CTL / 4] & CAN_CTL_EIE);
+
+    //
+    // Filters and transmit objects that need more than 32 message objects
+    // are refused, as is a transmit object count out of range.
+    //
+    psMany[0] = g_psFilters[0];
+    psMany[1] = g_psFilters[1];
+    psMany[1].ui32Depth = 25;
+    CHECK(!CANQueueInit(&sQueue, CAN0_BASE, psMany, 2, 4, g_psRxBuf, 8,
+                        g_psTxBuf, 8));
+    CHECK(!CANQueueInit(&sQueue, CAN0_BASE, g_psFilters, 2, 0, g_psRxBuf, 8,
+                        g_psTxBuf, 8));
+    CHECK(!CANQueueInit(&sQueue, CAN0_BASE, g_psFilters, 2,
+                        CAN_QUEUE_MAX_TX_OBJS + 1, g_psRxBuf, 8, g_psTxBuf,
+                        8));
+}
+
+//*****************************************************************************
+//
+// Tests that frames received into a FIFO and a second filter are returned in
+// order with their data, and that one interrupt drains them all.
+//
+//*****************************************************************************
+static void
+TestReceive(void)
+{
+    tCANQueueMsg psExpect[5], sMsg;
+    uint32_t ui32Idx;
+
+    QueueSetup(8);
+
+    MsgFill(&psExpect[0], 0x101, 0, 0);
+    MsgFill(&psExpect[1], 0x102, 0, 1);
+    MsgFill(&psExpect[2], 0x18ff0012, CAN_QUEUE_EXTENDED, 2);
+    MsgFill(&psExpect[3], 0x10f, 0, 3);
+    MsgFill(&psExpect[4], 0x101, 0, 7);
+    for(ui32Idx = 0; ui32Idx < 5; ui32Idx++)
+    {
+        CHECK(CANModelReceive(psExpect[ui32Idx].ui32ID,
+                              psExpect[ui32Idx].ui8Flags ? true : false,
+                              psExpect[ui32Idx].pui8Data,
+                              psExpect[ui32Idx].ui8Len));
+    }
+
+    //
+    // Frames outside of both filters are not accepted, including an
+    // extended frame with an identifier that the standard filter would
+    // accept.
+    //
+    CHECK(!CANModelReceive(0x200, false, psExpect[0].pui8Data, 1));
+    CHECK(!CANModelReceive(0x101, true, psExpect[0].pui8Data, 1));
+
+    CANModelInterrupt(&g_sQueue);
+
+    CHECK(CANQueueRxCount(&g_sQueue) == 5);
+    CHECK(CANModelIntID() == CAN_INT_INTID_NONE);
+    for(ui32Idx = 0; ui32Idx < NUM_MSG_OBJS; ui32Idx++)
+    {
+        CHECK(!(g_sModel.psObj[ui32Idx].ui32MCtl & CAN_IF1MCTL_NEWDAT));
+    }
+
+    //
+    // The standard identifiers come out in FIFO order, followed by the
+    // extended identifier from the higher-numbered FIFO.
+    //
+    CHECK(CANQueueReceive(&g_sQueue, &sMsg) && MsgSame(&sMsg, &psExpect[0]));
+    CHECK(CANQueueReceive(&g_sQueue, &sMsg) && MsgSame(&sMsg, &psExpect[1]));
+    CHECK(CANQueueReceive(&g_sQueue, &sMsg) && MsgSame(&sMsg, &psExpect[3]));
+    CHECK(CANQueueReceive(&g_sQueue, &sMsg) && MsgSame(&sMsg, &psExpect[4]));
+    CHECK(CANQueueReceive(&g_sQueue, &sMsg) && MsgSame(&sMsg, &psExpect[2]));
+    CHECK(sMsg.ui8Flags == CAN_QUEUE_EXTENDED);
+    CHECK(!CANQueueReceive(&g_sQueue, &sMsg));
+
+    CHECK(g_psStats[0].ui32RxFrames == 2);
+    CHECK(g_psStats[1].ui32RxFrames == 1);
+    CHECK(g_psStats[2].ui32RxFrames == 1);
+    CHECK(g_sQueue.ui32RxLost == 0);
+    CHECK(g_sQueue.ui32RxDropped == 0);
+}
+
+//*****************************************************************************
+//
+// Tests that a frame overwritten at the end of a full FIFO is flagged, and
+// that frames are dropped and counted when the receive queue is full.
+//
+//*****************************************************************************
+static void
+TestOverflow(void)
+{
+    tCANQueueMsg sMsg;
+    uint32_t ui32Idx;
+
+    QueueSetup(8);
+
+    //
+    // Five frames into the four-deep FIFO: the fifth overwrites the fourth.
+    //
+    for(ui32Idx = 0; ui32Idx < 5; ui32Idx++)
+    {
+        MsgFill(&sMsg, 0x101, 0, ui32Idx);
+        CHECK(CANModelReceive(0x101, false, sMsg.pui8Data, sMsg.ui8Len));
+    }
+    CHECK(g_sModel.psObj[3].ui32MCtl & CAN_IF1MCTL_MSGLST);
+
+    CANModelInterrupt(&g_sQueue);
+
+    CHECK(CANQueueRxCount(&g_sQueue) == 4);
+    CHECK(g_sQueue.ui32RxLost == 1);
+    CHECK(g_psStats[0].ui32Lost == 1);
+    CHECK(!(g_sModel.psObj[3].ui32MCtl & CAN_IF1MCTL_MSGLST));
+    for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+    {
+        CHECK(CANQueueReceive(&g_sQueue, &sMsg));
+        CHECK(sMsg.pui8Data[0] == ((ui32Idx < 3) ? ui32Idx : 4));
+        CHECK(((sMsg.ui8Flags & CAN_QUEUE_DATA_LOST) != 0) == (ui32Idx == 3));
+    }
+
+    //
+    // A receive queue of four entries holds three messages, so the fourth
+    // frame is dropped, but its message object is still emptied.
+    //
+    QueueSetup(4);
+    for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+    {
+        MsgFill(&sMsg, 0x102, 0, ui32Idx);
+        CHECK(CANModelReceive(0x102, false, sMsg.pui8Data, sMsg.ui8Len));
+    }
+
+    CANModelInterrupt(&g_sQueue);
+
+    CHECK(CANQueueRxCount(&g_sQueue) == 3);
+    CHECK(g_sQueue.ui32RxDropped == 1);
+    CHECK(g_psStats[1].ui32Lost == 1);
+    CHECK(g_psStats[1].ui32RxFrames == 3);
+    CHECK(CANModelIntID() == CAN_INT_INTID_NONE);
+    CHECK(!(g_sModel.psObj[3].ui32MCtl & CAN_IF1MCTL_NEWDAT));
+}
+
+//*****************************************************************************
+//
+// Tests that queued messages go out in order when there are more of them
+// than transmit message objects, and that completion interrupts are cleared
+// whether or not their message object is reloaded.
+//
+//*****************************************************************************
+static void
+TestTransmit(void)
+{
+    tCANQueueMsg psMsg[7];
+    uint32_t ui32Idx, ui32Sent, ui32Transfers;
+
+    QueueSetup(8);
+
+    MsgFill(&psMsg[0], 0x101, 0, 0);
+    MsgFill(&psMsg[1], 0x18ff0012, CAN_QUEUE_EXTENDED, 1);
+    for(ui32Idx = 2; ui32Idx < 7; ui32Idx++)
+    {
+        MsgFill(&psMsg[ui32Idx], 0x700 + ui32Idx, 0, ui32Idx);
+    }
+
+    //
+    // The first message is loaded at once; the rest wait in the queue until
+    // the transmit message objects are idle.
+    //
+    CHECK(CANQueueSend(&g_sQueue, &psMsg[0]));
+    CHECK(g_sQueue.ui32TxBusy == 0x1);
+    for(ui32Idx = 1; ui32Idx < 7; ui32Idx++)
+    {
+        CHECK(CANQueueSend(&g_sQueue, &psMsg[ui32Idx]));
+    }
+    CHECK(g_sQueue.ui32TxBusy == 0x1);
+
+    //
+    // The transmit queue holds seven of its eight entries, so one more
+    // message fills it, and the next is refused.
+    //
+    CHECK(CANQueueSend(&g_sQueue, &psMsg[0]));
+    CHECK(!CANQueueSend(&g_sQueue, &psMsg[0]));
+
+    CHECK(CANModelTransmit() == 29);
+    CANModelInterrupt(&g_sQueue);
+
+    //
+    // The next four messages are loaded together into objects 29-32.  Send
+    // two of them, and check that the others are not disturbed while the
+    // first two are acknowledged.
+    //
+    CHECK(g_sQueue.ui32TxBusy == 0xf);
+    CHECK(CANModelTransmit() == 29);
+    CHECK(CANModelTransmit() == 30);
+    ui32Transfers = g_sModel.ui32Transfers;
+    CANModelInterrupt(&g_sQueue);
+    CHECK(g_sQueue.ui32TxBusy == 0xc);
+    CHECK(CANModelIntID() == CAN_INT_INTID_NONE);
+    CHECK((g_sModel.ui32Transfers - ui32Transfers) == 2);
+
+    //
+    // Drain the rest, one interrupt per frame.
+    //
+    while(CANModelTransmit() != 0)
+    {
+        CANModelInterrupt(&g_sQueue);
+    }
+
+    CHECK(g_sModel.ui32NumSent == 8);
+    ui32Sent = (g_sModel.ui32NumSent < 7) ? g_sModel.ui32NumSent : 7;
+    for(ui32Idx = 0; ui32Idx < ui32Sent; ui32Idx++)
+    {
+        CHECK(MsgSame(&g_sModel.psSent[ui32Idx], &psMsg[ui32Idx]));
+    }
+    CHECK(MsgSame(&g_sModel.psSent[7], &psMsg[0]));
+    CHECK(g_sQueue.ui32TxBusy == 0);
+    CHECK(CANModelIntID() == CAN_INT_INTID_NONE);
+
+    CHECK(g_psStats[0].ui32TxFrames == 2);
+    CHECK(g_psStats[2].ui32TxFrames == 1);
+}
+
+//*****************************************************************************
+//
+// Tests the handling of bus errors, bus-off and a stray message object
+// interrupt.
+//
+//*****************************************************************************
+static void
+TestStatus(void)
+{
+    QueueSetup(8);
+
+    CANModelError(CAN_STS_LEC_STUFF, false);
+    CANModelInterrupt(&g_sQueue);
+    CHECK(g_sQueue.ui32BusErrors == 1);
+    CHECK(g_sQueue.ui32BusOff == 0);
+    CHECK((g_sModel.pui32Reg[CAN_O_STS / 4] & CAN_STS_LEC_M) ==
+          CAN_STS_LEC_NOEVENT);
+
+    //
+    // Going bus-off is counted and the controller is restarted.
+    //
+    CANModelError(CAN_STS_LEC_BIT0, true);
+    CANModelInterrupt(&g_sQueue);
+    CHECK(g_sQueue.ui32BusErrors == 2);
+    CHECK(g_sQueue.ui32BusOff == 1);
+    CHECK(!(g_sModel.pui32Reg[CAN_O_CTL / 4] & CAN_CTL_INIT));
+    CHECK(!(g_sModel.pui32Reg[CAN_O_STS / 4] & CAN_STS_BOFF));
+
+    //
+    // An interrupt from a message object that the engine does not use is
+    // cleared rather than left to hold the interrupt asserted.
+    //
+    g_sModel.psObj[9].ui32MCtl |= CAN_IF1MCTL_INTPND;
+    CANModelInterrupt(&g_sQueue);
+    CHECK(CANModelIntID() == CAN_INT_INTID_NONE);
+}
+
+//*****************************************************************************
+//
+// Runs the tests.
+//
+//*****************************************************************************
+int
+main(void)
+{
+    TestInit();
+    TestReceive();
+    TestOverflow();
+    TestTransmit();
+    TestStatus();
+
+    return(TestResult("canqueue"));
+}
@@ -0,0 +1,619 @@
+//*****************************************************************************
+//
+// dsplib_test.c - Host tests and timings for the block DSP functions.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "utils/dsplib.h"
+#include "test.h"
+
+//*****************************************************************************
+//
+// The FFT size used by the tests and timings.
+//
+//*****************************************************************************
+#define FFT_LOG2                8
+#define FFT_SIZE                (1 << FFT_LOG2)
+
+//*****************************************************************************
+//
+// The FIR filter length and pass size used by the tests and timings.
+//
+//*****************************************************************************
+#define FIR_TAPS                31
+#define FIR_BLOCK               64
+
+//*****************************************************************************
+//
+// The number of input samples filtered by the FIR and decimator tests.
+//
+//*****************************************************************************
+#define FIR_SAMPLES             1000
+
+//*****************************************************************************
+//
+// Buffers shared by the tests.  The FFT buffer must be word aligned.
+//
+//*****************************************************************************
+static int16_t g_pi16Input[FIR_SAMPLES];
+static int16_t g_pi16Output[FIR_SAMPLES];
+static int16_t g_pi16Coeffs[FIR_TAPS];
+static int16_t g_pi16State[FIR_TAPS - 1 + FIR_BLOCK];
+static int16_t g_pi16Twiddle[FFT_SIZE];
+static uint32_t g_pui32FFT[FFT_SIZE];
+
+//*****************************************************************************
+//
+// Converts a value in the range [-1, 1) to Q15, rounding to nearest.
+//
+//*****************************************************************************
+static int16_t
+ToQ15(double dValue)
+{
+    double dScaled;
+
+    dScaled = floor((dValue * 32768.0) + 0.5);
+    if(dScaled > 32767.0)
+    {
+        dScaled = 32767.0;
+    }
+    if(dScaled < -32768.0)
+    {
+        dScaled = -32768.0;
+    }
+
+    return((int16_t)dScaled);
+}
+
+//*****************************************************************************
+//
+// Fills the input buffer with repeatable pseudo-random Q15 samples of up to
+// half of full scale.
+//
+//*****************************************************************************
+static void
+NoiseFill(int16_t *pi16Buf, uint32_t ui32Count)
+{
+    uint32_t ui32Seed, ui32Idx;
+
+    ui32Seed = 12345;
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        ui32Seed = (ui32Seed * 1103515245) + 12345;
+        pi16Buf[ui32Idx] = (int16_t)((int32_t)(ui32Seed >> 16) - 32768) / 2;
+    }
+}
+
+//*****************************************************************************
+//
+// Builds a windowed-sinc low pass filter with a cutoff of a quarter of the
+// sample rate, in Q15.  The filter is symmetric, so its time-reversed order is
+// the same as its natural order.
+//
+//*****************************************************************************
+static void
+LowPassInit(int16_t *pi16Coeffs, uint32_t ui32Taps)
+{
+    double dX, dSum, pdCoeffs[FIR_TAPS];
+    uint32_t ui32Idx;
+
+    dSum = 0.0;
+    for(ui32Idx = 0; ui32Idx < ui32Taps; ui32Idx++)
+    {
+        dX = (double)ui32Idx - ((double)(ui32Taps - 1) / 2.0);
+        pdCoeffs[ui32Idx] = (dX == 0.0) ? 0.5 :
+                            (sin(M_PI * 0.5 * dX) / (M_PI * dX));
+        pdCoeffs[ui32Idx] *= 0.54 - (0.46 * cos((2.0 * M_PI * ui32Idx) /
+                                                (ui32Taps - 1)));
+        dSum += pdCoeffs[ui32Idx];
+    }
+
+    //
+    // Normalize for unity gain at DC, leaving a little headroom.
+    //
+    for(ui32Idx = 0; ui32Idx < ui32Taps; ui32Idx++)
+    {
+        pi16Coeffs[ui32Idx] = ToQ15((pdCoeffs[ui32Idx] / dSum) * 0.99);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the exact output of the Q15 FIR filter for input sample ui32Idx,
+// computed with the same coefficients and truncation as the filter.
+//
+//*****************************************************************************
+static int32_t
+FIRReference(const int16_t *pi16In, uint32_t ui32Idx)
+{
+    int64_t i64Acc;
+    uint32_t ui32Tap;
+
+    i64Acc = 0;
+    for(ui32Tap = 0; ui32Tap < FIR_TAPS; ui32Tap++)
+    {
+        //
+        // Coefficient 0 applies to the oldest sample in the window, and
+        // samples before the start of the input are zero.
+        //
+        if((ui32Idx + ui32Tap) >= (FIR_TAPS - 1))
+        {
+            i64Acc += (int64_t)g_pi16Coeffs[ui32Tap] *
+                      pi16In[ui32Idx + ui32Tap - (FIR_TAPS - 1)];
+        }
+    }
+
+    return((int32_t)(i64Acc >> 15));
+}
+
+//*****************************************************************************
+//
+// Tests the conversions and the saturating add.
+//
+//*****************************************************************************
+static void
+TestConvert(void)
+{
+    static const uint16_t pui16ADC[4] = { 0, 2048, 4095, 0xf800 };
+    static const int16_t pi16A[3] = { 30000, -30000, 100 };
+    static const int16_t pi16B[3] = { 10000, -10000, -300 };
+    int16_t pi16Out[4];
+    float pfOut[2];
+
+    DSPADCToQ15(pui16ADC, pi16Out, 4);
+    CHECK(pi16Out[0] == -32768);
+    CHECK(pi16Out[1] == 0);
+    CHECK(pi16Out[2] == 32752);
+
+    //
+    // Only the 12 data bits of a sample are used.
+    //
+    CHECK(pi16Out[3] == 0);
+
+    pi16Out[0] = -32768;
+    pi16Out[1] = 16384;
+    DSPQ15ToF32(pi16Out, pfOut, 2);
+    CHECK(pfOut[0] == -1.0f);
+    CHECK(pfOut[1] == 0.5f);
+
+    //
+    // Three values exercise both the paired and the single sample paths.
+    //
+    DSPAddQ15(pi16A, pi16B, pi16Out, 3);
+    CHECK(pi16Out[0] == 32767);
+    CHECK(pi16Out[1] == -32768);
+    CHECK(pi16Out[2] == -200);
+}
+
+//*****************************************************************************
+//
+// Tests the FIR filter against a direct convolution, feeding it blocks of
+// varying size so that passes and block boundaries fall at different places.
+//
+//*****************************************************************************
+static void
+TestFIR(void)
+{
+    static const uint32_t pui32Sizes[] = { 1, 7, 64, 65, 200, 13 };
+    tDSPFIRQ15 sFIR;
+    uint32_t ui32Idx, ui32Pos, ui32Size, ui32Errors;
+
+    NoiseFill(g_pi16Input, FIR_SAMPLES);
+
+    DSPFIRQ15Init(&sFIR, g_pi16Coeffs, FIR_TAPS, g_pi16State, FIR_BLOCK);
+
+    ui32Pos = 0;
+    ui32Idx = 0;
+    while(ui32Pos < FIR_SAMPLES)
+    {
+        ui32Size = pui32Sizes[ui32Idx++ % (sizeof(pui32Sizes) /
+                                          sizeof(pui32Sizes[0]))];
+        if(ui32Size > (FIR_SAMPLES - ui32Pos))
+        {
+            ui32Size = FIR_SAMPLES - ui32Pos;
+        }
+        DSPFIRQ15(&sFIR, g_pi16Input + ui32Pos, g_pi16Output + ui32Pos,
+                  ui32Size);
+        ui32Pos += ui32Size;
+    }
+
+    ui32Errors = 0;
+    for(ui32Idx = 0; ui32Idx < FIR_SAMPLES; ui32Idx++)
+    {
+        if(g_pi16Output[ui32Idx] != FIRReference(g_pi16Input, ui32Idx))
+        {
+            ui32Errors++;
+        }
+    }
+    CHECK(ui32Errors == 0);
+
+    //
+    // A full-scale DC input settles to the DC gain of the filter.
+    //
+    for(ui32Idx = 0; ui32Idx < FIR_BLOCK; ui32Idx++)
+    {
+        g_pi16Input[ui32Idx] = 32767;
+    }
+    DSPFIRQ15Init(&sFIR, g_pi16Coeffs, FIR_TAPS, g_pi16State, FIR_BLOCK);
+    DSPFIRQ15(&sFIR, g_pi16Input, g_pi16Output, FIR_BLOCK);
+    CHECK(abs(g_pi16Output[FIR_BLOCK - 1] - ToQ15(0.99)) <= FIR_TAPS);
+}
+
+//*****************************************************************************
+//
+// Tests that the decimator produces every ui16Factor'th output of the FIR
+// filter, including when blocks are not a multiple of the factor.
+//
+//*****************************************************************************
+static void
+TestDecimate(void)
+{
+    tDSPFIRQ15 sFIR;
+    uint32_t ui32Idx, ui32Pos, ui32Out, ui32Size, ui32Errors;
+
+    NoiseFill(g_pi16Input, FIR_SAMPLES);
+
+    DSPDecimateQ15Init(&sFIR, g_pi16Coeffs, FIR_TAPS, 4, g_pi16State,
+                       FIR_BLOCK);
+
+    ui32Pos = 0;
+    ui32Out = 0;
+    ui32Size = 1;
+    while(ui32Pos < FIR_SAMPLES)
+    {
+        if(ui32Size > (FIR_SAMPLES - ui32Pos))
+        {
+            ui32Size = FIR_SAMPLES - ui32Pos;
+        }
+        ui32Out += DSPDecimateQ15(&sFIR, g_pi16Input + ui32Pos,
+                                  g_pi16Output + ui32Out, ui32Size);
+        ui32Pos += ui32Size;
+        ui32Size = (ui32Size * 3) % 97 + 1;
+    }
+
+    CHECK(ui32Out == (FIR_SAMPLES / 4));
+
+    ui32Errors = 0;
+    for(ui32Idx = 0; ui32Idx < ui32Out; ui32Idx++)
+    {
+        if(g_pi16Output[ui32Idx] != FIRReference(g_pi16Input, ui32Idx * 4))
+        {
+            ui32Errors++;
+        }
+    }
+    CHECK(ui32Errors == 0);
+}
+
+//*****************************************************************************
+//
+// Tests the biquad cascade against a double-precision implementation of the
+// same stages.
+//
+//*****************************************************************************
+static void
+TestBiquad(void)
+{
+    //
+    // Two Butterworth low pass sections (fc = fs / 8).
+    //
+    static const float pfCoeffs[10] =
+    {
+        0.0976310729f, 0.1952621459f, 0.0976310729f,
+        -0.9428090416f, 0.3333333333f,
+        0.0976310729f, 0.1952621459f, 0.0976310729f,
+        -0.9428090416f, 0.3333333333f
+    };
+    tDSPBiquadF32 sBiquad;
+    float pfState[4], pfIn[256], pfOut[256];
+    double pdState[4], dX, dY, dMaxErr;
+    uint32_t ui32Idx, ui32Stage;
+    const float *pfC;
+
+    NoiseFill(g_pi16Input, 256);
+    DSPQ15ToF32(g_pi16Input, pfIn, 256);
+
+    DSPBiquadF32Init(&sBiquad, 2, pfCoeffs, pfState);
+    DSPBiquadF32(&sBiquad, pfIn, pfOut, 100);
+    DSPBiquadF32(&sBiquad, pfIn + 100, pfOut + 100, 156);
+
+    pdState[0] = pdState[1] = pdState[2] = pdState[3] = 0.0;
+    dMaxErr = 0.0;
+    for(ui32Idx = 0; ui32Idx < 256; ui32Idx++)
+    {
+        dX = pfIn[ui32Idx];
+        for(ui32Stage = 0; ui32Stage < 2; ui32Stage++)
+        {
+            pfC = pfCoeffs + (ui32Stage * 5);
+            dY = (pfC[0] * dX) + pdState[ui32Stage * 2];
+            pdState[ui32Stage * 2] = (pfC[1] * dX) - (pfC[3] * dY) +
+                                     pdState[(ui32Stage * 2) + 1];
+            pdState[(ui32Stage * 2) + 1] = (pfC[2] * dX) - (pfC[4] * dY);
+            dX = dY;
+        }
+        if(fabs(dX - pfOut[ui32Idx]) > dMaxErr)
+        {
+            dMaxErr = fabs(dX - pfOut[ui32Idx]);
+        }
+    }
+    CHECK(dMaxErr < 1e-5);
+}
+
+//*****************************************************************************
+//
+// Tests the RMS of a constant, a full-scale square wave and a sine wave.
+//
+//*****************************************************************************
+static void
+TestRMS(void)
+{
+    uint32_t ui32Idx;
+    double dExpected;
+
+    for(ui32Idx = 0; ui32Idx < 101; ui32Idx++)
+    {
+        g_pi16Input[ui32Idx] = -1000;
+    }
+    CHECK(DSPRMSQ15(g_pi16Input, 101) == 1000);
+
+    for(ui32Idx = 0; ui32Idx < 100; ui32Idx++)
+    {
+        g_pi16Input[ui32Idx] = (ui32Idx & 1) ? 32767 : -32768;
+    }
+    CHECK(abs(DSPRMSQ15(g_pi16Input, 100) - 32767) <= 1);
+
+    CHECK(DSPRMSQ15(g_pi16Input, 0) == 0);
+
+    //
+    // A whole number of cycles of a sine wave with a peak of 0.5 has an RMS
+    // of 0.5 / sqrt(2).
+    //
+    for(ui32Idx = 0; ui32Idx < 1000; ui32Idx++)
+    {
+        g_pi16Input[ui32Idx] = ToQ15(0.5 * sin((2.0 * M_PI * ui32Idx) /
+                                               50.0));
+    }
+    dExpected = (0.5 / sqrt(2.0)) * 32768.0;
+    CHECK(fabs(DSPRMSQ15(g_pi16Input, 1000) - dExpected) <= 2.0);
+}
+
+//*****************************************************************************
+//
+// Tests the Goertzel detector against a double-precision Goertzel recurrence,
+// and checks that it rejects a tone at another frequency.
+//
+//*****************************************************************************
+static void
+TestGoertzel(void)
+{
+    tDSPGoertzel sGoertzel;
+    double dCoeff, dS0, dS1, dS2, dPower;
+    float fPower, fOther;
+    uint32_t ui32Idx;
+
+    //
+    // 205 samples of a 1209 Hz DTMF tone at 8 kHz, at half of full scale,
+    // passed in two blocks.
+    //
+    for(ui32Idx = 0; ui32Idx < 205; ui32Idx++)
+    {
+        g_pi16Input[ui32Idx] = ToQ15(0.5 * sin((2.0 * M_PI * 1209.0 *
+                                                ui32Idx) / 8000.0));
+    }
+    DSPGoertzelInit(&sGoertzel, 1209, 8000);
+    DSPGoertzelQ15(&sGoertzel, g_pi16Input, 100);
+    DSPGoertzelQ15(&sGoertzel, g_pi16Input + 100, 105);
+    fPower = DSPGoertzelPowerGet(&sGoertzel);
+
+    dCoeff = 2.0 * cos((2.0 * M_PI * 1209.0) / 8000.0);
+    dS1 = dS2 = 0.0;
+    for(ui32Idx = 0; ui32Idx < 205; ui32Idx++)
+    {
+        dS0 = (g_pi16Input[ui32Idx] / 32768.0) + (dCoeff * dS1) - dS2;
+        dS2 = dS1;
+        dS1 = dS0;
+    }
+    dPower = (dS1 * dS1) + (dS2 * dS2) - (dCoeff * dS1 * dS2);
+
+    CHECK(fabs(fPower - dPower) <= (dPower * 0.01));
+
+    //
+    // The power of a tone at the detector frequency is about (N * A / 2)^2.
+    //
+    CHECK(fabs(fPower - ((205.0 * 0.25) * (205.0 * 0.25))) <=
+          ((205.0 * 0.25) * (205.0 * 0.25) * 0.05));
+
+    //
+    // The detector restarts after the power is read, and a 1477 Hz tone is at
+    // least 30 dB down.
+    //
+    for(ui32Idx = 0; ui32Idx < 205; ui32Idx++)
+    {
+        g_pi16Input[ui32Idx] = ToQ15(0.5 * sin((2.0 * M_PI * 1477.0 *
+                                                ui32Idx) / 8000.0));
+    }
+    DSPGoertzelQ15(&sGoertzel, g_pi16Input, 205);
+    fOther = DSPGoertzelPowerGet(&sGoertzel);
+    CHECK(fOther < (fPower / 1000.0f));
+}
+
+//*****************************************************************************
+//
+// Tests the FFT bin magnitudes against a double-precision DFT of the same
+// input, scaled by 1 / N as the FFT is.
+//
+//*****************************************************************************
+static void
+TestFFT(void)
+{
+    int16_t *pi16Data;
+    double dRe, dIm, dAngle, dErr, dMaxErr;
+    double pdRe[FFT_SIZE];
+    uint32_t ui32Bin, ui32Idx;
+
+    DSPFFTQ15TwiddleInit(g_pi16Twiddle, FFT_LOG2);
+
+    //
+    // A tone centered on bin 10 at half scale, a weaker tone on bin 37 and a
+    // DC offset.
+    //
+    pi16Data = (int16_t *)g_pui32FFT;
+    for(ui32Idx = 0; ui32Idx < FFT_SIZE; ui32Idx++)
+    {
+        pdRe[ui32Idx] = (0.5 * cos((2.0 * M_PI * 10.0 * ui32Idx) /
+                                   FFT_SIZE)) +
+                        (0.125 * sin((2.0 * M_PI * 37.0 * ui32Idx) /
+                                     FFT_SIZE)) + 0.0625;
+        pi16Data[ui32Idx * 2] = ToQ15(pdRe[ui32Idx]);
+        pi16Data[(ui32Idx * 2) + 1] = 0;
+    }
+
+    DSPFFTQ15(pi16Data, g_pi16Twiddle, FFT_LOG2);
+
+    dMaxErr = 0.0;
+    for(ui32Bin = 0; ui32Bin < FFT_SIZE; ui32Bin++)
+    {
+        dRe = dIm = 0.0;
+        for(ui32Idx = 0; ui32Idx < FFT_SIZE; ui32Idx++)
+        {
+            dAngle = (-2.0 * M_PI * ui32Bin * ui32Idx) / FFT_SIZE;
+            dRe += pdRe[ui32Idx] * cos(dAngle);
+            dIm += pdRe[ui32Idx] * sin(dAngle);
+        }
+        dRe = (dRe * 32768.0) / FFT_SIZE;
+        dIm = (dIm * 32768.0) / FFT_SIZE;
+
+        dErr = fabs(hypot(pi16Data[ui32Bin * 2], pi16Data[(ui32Bin * 2) + 1]) -
+                    hypot(dRe, dIm));
+        if(dErr > dMaxErr)
+        {
+            dMaxErr = dErr;
+        }
+    }
+
+    //
+    // Each stage truncates when it halves, so the error grows by about half
+    // an LSB per stage.
+    //
+    CHECK(dMaxErr <= FFT_LOG2);
+
+    //
+    // The tones and the DC offset land in the expected bins.  After scaling
+    // by 1 / N, a tone of amplitude A contributes A / 2 to each of its two
+    // bins.
+    //
+    CHECK(abs(pi16Data[10 * 2] - 8192) <= FFT_LOG2);
+    CHECK(abs(pi16Data[(FFT_SIZE - 10) * 2] - 8192) <= FFT_LOG2);
+    CHECK(abs(pi16Data[(37 * 2) + 1] + 2048) <= FFT_LOG2);
+    CHECK(abs(pi16Data[0] - 2048) <= FFT_LOG2);
+}
+
+//*****************************************************************************
+//
+// Reports the time taken by each block function on a typical block, per
+// sample processed.
+//
+//*****************************************************************************
+static void
+TimeFunctions(void)
+{
+    tDSPFIRQ15 sFIR;
+    tDSPGoertzel sGoertzel;
+    uint64_t ui64Start, ui64Time;
+    uint32_t ui32Pass;
+
+    TestTimerInit();
+    NoiseFill(g_pi16Input, FIR_SAMPLES);
+
+    printf("dsplib timings, in %s per sample, best of 16:\n",
+           TEST_TIME_UNITS);
+
+#define TIME(pcName, ui32Samples, stmt)                                       \
+    do                                                                        \
+    {                                                                         \
+        ui64Time = ~(uint64_t)0;                                              \
+        for(ui32Pass = 0; ui32Pass < 16; ui32Pass++)                          \
+        {                                                                     \
+            ui64Start = TestTimerGet();                                       \
+            stmt;                                                             \
+            ui64Start = TestTimerElapsed(ui64Start);                          \
+            if(ui64Start < ui64Time)                                          \
+            {                                                                 \
+                ui64Time = ui64Start;                                         \
+            }                                                                 \
+        }                                                                     \
+        printf("  %-28s %8.2f\n", pcName,                                     \
+               (double)ui64Time / (double)(ui32Samples));                     \
+    }                                                                         \
+    while(0)
+
+    TIME("DSPADCToQ15", FIR_BLOCK,
+         DSPADCToQ15((const uint16_t *)g_pi16Input, g_pi16Output, FIR_BLOCK));
+    TIME("DSPAddQ15", FIR_BLOCK,
+         DSPAddQ15(g_pi16Input, g_pi16Input, g_pi16Output, FIR_BLOCK));
+
+    DSPFIRQ15Init(&sFIR, g_pi16Coeffs, FIR_TAPS, g_pi16State, FIR_BLOCK);
+    TIME("DSPFIRQ15 (31 taps)", FIR_BLOCK,
+         DSPFIRQ15(&sFIR, g_pi16Input, g_pi16Output, FIR_BLOCK));
+
+    DSPDecimateQ15Init(&sFIR, g_pi16Coeffs, FIR_TAPS, 4, g_pi16State,
+                       FIR_BLOCK);
+    TIME("DSPDecimateQ15 (31 taps, /4)", FIR_BLOCK,
+         DSPDecimateQ15(&sFIR, g_pi16Input, g_pi16Output, FIR_BLOCK));
+
+    TIME("DSPRMSQ15", FIR_BLOCK, DSPRMSQ15(g_pi16Input, FIR_BLOCK));
+
+    DSPGoertzelInit(&sGoertzel, 1209, 8000);
+    TIME("DSPGoertzelQ15", FIR_BLOCK,
+         DSPGoertzelQ15(&sGoertzel, g_pi16Input, FIR_BLOCK));
+
+    DSPFFTQ15TwiddleInit(g_pi16Twiddle, FFT_LOG2);
+    TIME("DSPFFTQ15 (256 points)", FFT_SIZE,
+         DSPFFTQ15((int16_t *)g_pui32FFT, g_pi16Twiddle, FFT_LOG2));
+
+#undef TIME
+}
+
+//*****************************************************************************
+//
+// Runs the tests, then reports the timings.
+//
+//*****************************************************************************
+int
+main(void)
+{
+    LowPassInit(g_pi16Coeffs, FIR_TAPS);
+
+    TestConvert();
+    TestFIR();
+    TestDecimate();
+    TestBiquad();
+    TestRMS();
+    TestGoertzel();
+    TestFFT();
+
+    TimeFunctions();
+
+    return(TestResult("dsplib"));
+}
@@ -0,0 +1,133 @@
+//*****************************************************************************
+//
+// test.h - Checks and timing shared by the utility library host tests.
+//
+// Copyright (c) 2017 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.1.4.178 of the Tiva Utility Library.
+//
+//*****************************************************************************
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+//*****************************************************************************
+//
+// The number of checks made and failed by the test program.
+//
+//*****************************************************************************
+static uint32_t g_ui32TestChecks;
+static uint32_t g_ui32TestFailures;
+
+//*****************************************************************************
+//
+// Records a check, printing the failing expression and its location if it is
+// false.
+//
+//*****************************************************************************
+#define CHECK(expr)                                                           \
+        do                                                                    \
+        {                                                                     \
+            g_ui32TestChecks++;                                               \
+            if(!(expr))                                                       \
+            {                                                                 \
+                g_ui32TestFailures++;                                         \
+                printf("%s:%d: check failed: %s\n", __FILE__, __LINE__,       \
+                       #expr);                                                \
+            }                                                                 \
+        }                                                                     \
+        while(0)
+
+//*****************************************************************************
+//
+// Prints the check counts and returns the exit status of the test program.
+//
+//*****************************************************************************
+static int
+TestResult(const char *pcName)
+{
+    printf("%s: %u checks, %u failed\n", pcName, (unsigned)g_ui32TestChecks,
+           (unsigned)g_ui32TestFailures);
+
+    return(g_ui32TestFailures ? 1 : 0);
+}
+
+//*****************************************************************************
+//
+// A free-running timer for measuring the cost of a function.  On a Cortex-M4
+// target this is the DWT cycle counter, so the counts are processor cycles.
+// On a host it counts nanoseconds, which are only useful for comparing one
+// version of a function with another.
+//
+//*****************************************************************************
+#if defined(__ARM_ARCH_7EM__)
+#define TEST_TIME_UNITS         "cycles"
+
+#define DWT_CTRL                (*(volatile uint32_t *)0xe0001000)
+#define DWT_CYCCNT              (*(volatile uint32_t *)0xe0001004)
+#define DEMCR                   (*(volatile uint32_t *)0xe000edfc)
+
+static inline void
+TestTimerInit(void)
+{
+    DEMCR |= 0x01000000;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= 1;
+}
+
+static inline uint64_t
+TestTimerGet(void)
+{
+    return(DWT_CYCCNT);
+}
+
+static inline uint64_t
+TestTimerElapsed(uint64_t ui64Start)
+{
+    return((uint32_t)(DWT_CYCCNT - (uint32_t)ui64Start));
+}
+#else
+#include <time.h>
+
+#define TEST_TIME_UNITS         "ns"
+
+static inline void
+TestTimerInit(void)
+{
+}
+
+static inline uint64_t
+TestTimerGet(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+
+    return(((uint64_t)sNow.tv_sec * 1000000000) + sNow.tv_nsec);
+}
+
+static inline uint64_t
+TestTimerElapsed(uint64_t ui64Start)
+{
+    return(TestTimerGet() - ui64Start);
+}
+#endif
+
+#endif // __TEST_H__
@@ -125,6 +125,14 @@ static volatile uint32_t g_ui32UARTRxReadIndex = 0;
 //*****************************************************************************
 static uint32_t g_ui32Base = 0;
 
+//*****************************************************************************
+//
+// The bit rate of the chosen UART, kept so that it can be reprogrammed when
+// the clock supplied to the UART changes.
+//
+//*****************************************************************************
+static uint32_t g_ui32Baud = 0;
+
 //*****************************************************************************
 //
 // A mapping from an integer between 0 and 15 to its ASCII character
@@ -358,6 +366,7 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
     // Select the base address of the UART.
     //
     g_ui32Base = g_ui32UARTBase[ui32PortNum];
+    g_ui32Baud = ui32Baud;
 
     //
     // Enable the UART peripheral for use.
@@ -406,6 +415,46 @@ UARTStdioConfig(uint32_t ui32PortNum, uint32_t ui32Baud, uint32_t ui32SrcClock)
     MAP_UARTEnable(g_ui32Base);
 }
 
+//*****************************************************************************
+//
+//! Informs the UART console of a new system clock rate.
+//!
+//! \param pvCBData is not used.
+//! \param ui32SysClock is the new system clock rate, in Hz.
+//!
+//! This function reprograms the bit rate divisor of the UART console so that
+//! it keeps the bit rate passed to UARTStdioConfig() when the system clock
+//! changes.  It has the form of a clock tree callback, so it may be passed to
+//! ClockTreeRegister(), or it may be called directly by an application that
+//! changes the system clock.  The divisor is only reprogrammed once the
+//! characters already in the transmit FIFO have been sent.  A UART that is
+//! clocked from the PIOSC is left unchanged.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTStdioClockChanged(void *pvCBData, uint32_t ui32SysClock)
+{
+    //
+    // Nothing needs to be done if the console is not configured or does not
+    // run from the system clock.
+    //
+    if((g_ui32Base == 0) ||
+       (MAP_UARTClockSourceGet(g_ui32Base) == UART_CLOCK_PIOSC))
+    {
+        return;
+    }
+
+    //
+    // Reprogram the divisor.  The UART is disabled and then reenabled by
+    // this call, which waits for the transmitter to go idle first.
+    //
+    MAP_UARTConfigSetExpClk(g_ui32Base, ui32SysClock, g_ui32Baud,
+                            (UART_CONFIG_PAR_NONE | UART_CONFIG_STOP_ONE |
+                             UART_CONFIG_WLEN_8));
+}
+
 //*****************************************************************************
 //
 //! Writes a string of characters to the UART output.
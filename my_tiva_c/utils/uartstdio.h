@@ -60,6 +60,7 @@ extern "C"
 //*****************************************************************************
 extern void UARTStdioConfig(uint32_t ui32Port, uint32_t ui32Baud,
                             uint32_t ui32SrcClock);
+extern void UARTStdioClockChanged(void *pvCBData, uint32_t ui32SysClock);
 extern int UARTgets(char *pcBuf, uint32_t ui32Len);
 extern unsigned char UARTgetc(void);
 extern void UARTprintf(const char *pcString, ...);